@@ -25,6 +25,9 @@ if(DEFINED ENV{TEST_FILE})
   set(TEST_PATH "$ENV{TEST_FILE}")
 else()
   set(TEST_PATH "${TEST_DIR}/${TEST_TYPE}")
+  if(TEST_SUBDIR)
+    set(TEST_PATH "${TEST_PATH}/${TEST_SUBDIR}")
+  endif()
 endif()
 
 # Force $TEST_PATH to workdir-relative path ("test/…").
@@ -39,6 +42,10 @@ endif()
 set(BUSTED_ARGS $ENV{BUSTED_ARGS})
 separate_arguments(BUSTED_ARGS)
 
+if(TEST_PATTERN)
+  list(APPEND BUSTED_ARGS --pattern=${TEST_PATTERN})
+endif()
+
 if(DEFINED ENV{TEST_TAG} AND NOT "$ENV{TEST_TAG}" STREQUAL "")
   list(APPEND BUSTED_ARGS --tags $ENV{TEST_TAG})
 endif()
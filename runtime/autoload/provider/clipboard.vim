@@ -35,6 +35,60 @@ endfunction
 
 let s:selections = { '*': s:selection, '+': copy(s:selection) }
 
+" Without caching, the copy command still runs in the background.  While it
+" runs for a register, later copies to that register only remember their lines
+" and the last ones are written when it exits.
+let s:pending = { '*': { 'job': 0 }, '+': { 'job': 0 } }
+
+function! s:copy_async(reg, lines) abort
+  let pending = s:pending[a:reg]
+  if pending.job > 0
+    let pending.next = a:lines
+    return
+  endif
+  let job = { 'reg': a:reg, 'argv': s:copy[a:reg], 'stderr_buffered': v:true }
+  function! job.on_exit(jobid, data, event) abort
+    let pending = s:pending[self.reg]
+    let pending.job = 0
+    if a:data > 0 && a:data < 128 && !exists('s:did_error_try_cmd')
+      echohl WarningMsg
+      echomsg 'clipboard: error invoking '.get(self.argv, 0, '?').': '.join(self.stderr)
+      echohl None
+      let s:did_error_try_cmd = 1
+    endif
+    if has_key(pending, 'next')
+      call s:copy_async(self.reg, remove(pending, 'next'))
+    endif
+  endfunction
+  let jobid = jobstart(job.argv, job)
+  if jobid <= 0
+    echohl WarningMsg
+    echomsg 'clipboard: failed to execute: '.get(job.argv, 0, '?')
+    echohl None
+    return
+  endif
+  call jobsend(jobid, a:lines)
+  call jobclose(jobid, 'stdin')
+  let pending.job = jobid
+endfunction
+
+" Don't lose the last copy when Nvim exits right after it.
+function! s:finish_pending() abort
+  for reg in keys(s:pending)
+    while s:pending[reg].job > 0
+      let jobid = s:pending[reg].job
+      if jobwait([jobid], 2000)[0] == -1 || s:pending[reg].job == jobid
+        break
+      endif
+    endwhile
+  endfor
+endfunction
+
+augroup nvim_clipboard
+  autocmd!
+  autocmd VimLeavePre * call s:finish_pending()
+augroup END
+
 function! s:try_cmd(cmd, ...) abort
   let out = systemlist(a:cmd, (a:0 ? a:1 : ['']), 1)
   if v:shell_error
@@ -165,7 +219,8 @@ endfunction
 function! s:clipboard.get(reg) abort
   if type(s:paste[a:reg]) == v:t_func
     return s:paste[a:reg]()
-  elseif s:selections[a:reg].owner > 0
+  elseif s:selections[a:reg].owner > 0 || s:pending[a:reg].job > 0
+    " Our own copy still owns the selection or is about to: no need to ask.
     return s:selections[a:reg].data
   end
 
@@ -195,10 +250,10 @@ function! s:clipboard.set(lines, regtype, reg) abort
   end
 
   if s:cache_enabled == 0
-    call s:try_cmd(s:copy[a:reg], a:lines)
     "Cache it anyway we can compare it later to get regtype of the yank
     let s:selections[a:reg] = copy(s:selection)
     let s:selections[a:reg].data = [a:lines, a:regtype]
+    call s:copy_async(a:reg, a:lines)
     return 0
   end
 
@@ -178,6 +178,35 @@ local function check_performance()
   end
 end
 
+local function check_memory()
+  health.start('Memory')
+
+  health.info(string.format('Lua heap: %.1f KiB', collectgarbage('count')))
+
+  local alloc = vim.api.nvim__stats().alloc
+  if not alloc then
+    health.info('Allocation accounting is disabled.', {
+      'Enable it with `:lua vim.api.nvim__alloc_track(true)` or by starting Nvim with $NVIM_ALLOC_TRACK set.',
+    })
+    return
+  end
+
+  local names = vim.tbl_keys(alloc)
+  table.sort(names, function(a, b)
+    return alloc[a].bytes > alloc[b].bytes
+  end)
+  for _, name in ipairs(names) do
+    health.info(
+      string.format(
+        '%-8s %10.1f KiB in %d allocations',
+        name,
+        alloc[name].bytes / 1024,
+        alloc[name].count
+      )
+    )
+  end
+end
+
 -- Load the remote plugin manifest file and check for unregistered plugins
 local function check_rplugin_manifest()
   health.start('Remote Plugins')
@@ -402,6 +431,7 @@ function M.check()
   check_config()
   check_runtime()
   check_performance()
+  check_memory()
   check_rplugin_manifest()
   check_terminal()
   check_tmux()
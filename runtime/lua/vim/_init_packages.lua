@@ -17,7 +17,7 @@ function vim._load_package(name)
   local paths = { 'lua/' .. basename .. '.lua', 'lua/' .. basename .. '/init.lua' }
   local found = vim.api.nvim__get_runtime(paths, false, { is_lua = true })
   if #found > 0 then
-    local f, err = loadfile(found[1])
+    local f, err = (vim._loadfile or loadfile)(found[1])
     return f or error(err)
   end
 
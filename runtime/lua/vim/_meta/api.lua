@@ -5,6 +5,16 @@ error('Cannot require a meta file')
 
 vim.api = {}
 
+--- @private
+--- Enables or disables allocation accounting per category.
+---
+--- When enabled, `nvim__stats()` includes an "alloc" entry with the count
+--- and size of live allocations made by each subsystem. Disabling discards
+--- the collected data.
+---
+--- @param enable boolean
+function vim.api.nvim__alloc_track(enable) end
+
 --- @private
 --- @param buffer integer
 --- @param keys boolean
@@ -93,7 +103,16 @@ function vim.api.nvim__screenshot(path) end
 --- @private
 --- Gets internal stats.
 ---
---- @return table<string,any>
+--- Durations are histograms with "count", "total" and "max" (nanoseconds)
+--- and "buckets": the first counts durations below 1 usec, the next ones
+--- below 2, 4, 8, ... usec, the last one the rest.
+---
+--- @return table<string,any> # Map of various internal stats:
+---   • "input_latency": time typed keys wait before they are processed
+---   • "event_batch": time to process a batch of main loop events
+---   • "update_screen": time of a screen update
+---   • "alloc": live allocations ("count" and "bytes") per category, only
+---     when enabled with `nvim__alloc_track()`
 function vim.api.nvim__stats() end
 
 --- @private
@@ -596,6 +615,19 @@ function vim.api.nvim_buf_line_count(buffer) end
 --- @return integer
 function vim.api.nvim_buf_set_extmark(buffer, ns_id, line, col, opts) end
 
+--- Creates many `extmark`s at once.
+--- Like calling `nvim_buf_set_extmark()` for each item, but new marks are
+--- inserted together, which is much faster for large numbers of marks (such
+--- as diagnostics or semantic tokens of a whole buffer).
+--- Stops at the first invalid item, marks of earlier items are kept.
+---
+--- @param buffer integer Buffer handle, or 0 for current buffer
+--- @param ns_id integer Namespace id from `nvim_create_namespace()`
+--- @param marks any[] List of `[line, col, opts]` items, where `opts` is
+---              optional and takes the same keys as `nvim_buf_set_extmark()`.
+--- @return integer[]
+function vim.api.nvim_buf_set_extmarks(buffer, ns_id, marks) end
+
 --- Sets a buffer-local `mapping` for the given mode.
 ---
 --- @param buffer integer Buffer handle, or 0 for current buffer
@@ -869,6 +901,11 @@ function vim.api.nvim_create_augroup(name, opts) end
 ---                autocommand only once `autocmd-once`.
 ---              • nested (boolean) optional: defaults to false. Run nested
 ---                autocommands `autocmd-nested`.
+---              • debounce (integer) optional: delay in milliseconds.
+---                Instead of running right away, run once when the event
+---                was not triggered again for this long, with `<amatch>`
+---                and `<abuf>` of the last trigger. For frequent events
+---                like `CursorMoved`.
 --- @return integer
 function vim.api.nvim_create_autocmd(event, opts) end
 
@@ -1832,8 +1869,8 @@ function vim.api.nvim_set_current_win(window) end
 --- forbidden, but is likely to have unexpected consequences (such as 100% CPU
 --- consumption). doing `vim.rpcnotify` should be OK, but `vim.rpcrequest` is
 --- quite dubious for the moment.
---- Note: It is not allowed to remove or update extmarks in 'on_line'
---- callbacks.
+--- Note: It is not allowed to remove or update extmarks in 'on_range' and
+--- 'on_line' callbacks.
 ---
 --- @param ns_id integer Namespace id from `nvim_create_namespace()`
 --- @param opts vim.api.keyset.set_decoration_provider Table of callbacks:
@@ -1845,6 +1882,12 @@ function vim.api.nvim_set_current_win(window) end
 ---                botline_guess is an approximation that does not exceed the
 ---                last line number. ["win", winid, bufnr, topline,
 ---                botline_guess]
+---              • on_range: called after on_win with the range of rows
+---                (end-inclusive) which may be redrawn in the window. Set
+---                `ephemeral` extmarks for all of them here instead of in
+---                on_line, which is much cheaper than a call for each line.
+---                Return `false` to skip the on_line calls for the window.
+---                ["range", winid, bufnr, start_row, end_row]
 ---              • on_line: called for each buffer line being redrawn. (The
 ---                interaction with fold lines is subject to change) ["win",
 ---                winid, bufnr, row]
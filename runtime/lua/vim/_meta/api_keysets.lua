@@ -65,6 +65,7 @@ error('Cannot require a meta file')
 --- @field buffer? integer
 --- @field callback? any
 --- @field command? string
+--- @field debounce? integer
 --- @field desc? string
 --- @field group? any
 --- @field nested? boolean
@@ -210,6 +211,7 @@ error('Cannot require a meta file')
 --- @field on_start? function
 --- @field on_buf? function
 --- @field on_win? function
+--- @field on_range? function
 --- @field on_line? function
 --- @field on_end? function
 --- @field _on_hl_def? function
@@ -113,9 +113,13 @@ function vim.stricmp(a, b) end
 --- Invalid UTF-8 and NUL is treated like by |vim.str_byteindex()|.
 --- An {index} in the middle of a UTF-16 sequence is rounded upwards to
 --- the end of that sequence.
+---
+--- {index} can also be a list of indices, then a list of byte indices is
+--- returned. This is faster than converting the indices one by one.
 --- @param str string
---- @param index number
+--- @param index number|number[]
 --- @param use_utf16? any
+--- @return integer|integer[]
 function vim.str_byteindex(str, index, use_utf16) end
 
 --- Gets a list of the starting byte positions of each UTF-8 codepoint in the given string.
@@ -174,10 +178,14 @@ function vim.str_utf_end(str, index) end
 --- bytes, and embedded surrogates are counted as one code point each. An
 --- {index} in the middle of a UTF-8 sequence is rounded upwards to the end of
 --- that sequence.
+---
+--- {index} can also be a list of indices, then two lists of UTF-32 and UTF-16
+--- indices are returned. This is faster than converting the indices one by
+--- one.
 --- @param str string
---- @param index? number
---- @return integer UTF-32 index
---- @return integer UTF-16 index
+--- @param index? number|number[]
+--- @return integer|integer[] UTF-32 index
+--- @return integer|integer[] UTF-16 index
 function vim.str_utfindex(str, index) end
 
 --- The result is a String, which is the text {str} converted from
@@ -33,6 +33,14 @@
 ---       - `count_a` (integer): Hunk size in {a}.
 ---       - `start_b` (integer): Start line of hunk in {b}.
 ---       - `count_b` (integer): Hunk size in {b}.
+---     - `on_done` (callback):
+---       Run the diff on a worker thread and invoke `on_done(err, result)`
+---       from the main loop when it is done, with the result described in
+---       {opts.result_type}. {a} and {b} are not copied. Cannot be used with
+---       `on_hunk`.
+---     - `group` (string): With `on_done`, a newer diff in the same group
+---       cancels a running one, whose `on_done` is then not invoked. For
+---       example the buffer a diff is for.
 ---     - `result_type` (string): Form of the returned diff:
 ---       - "unified": (default) String in unified format.
 ---       - "indices": Array of hunk locations.
@@ -66,5 +74,6 @@
 ---       diff library.
 ---
 ---@return string|table|nil
----     See {opts.result_type}. `nil` if {opts.on_hunk} is given.
+---     See {opts.result_type}. `nil` if {opts.on_hunk} or {opts.on_done} is
+---     given.
 function vim.diff(a, b, opts) end
@@ -1661,6 +1661,13 @@ vim.go.dex = vim.go.diffexpr
 --- 			Use the indent heuristic for the internal
 --- 			diff library.
 ---
+--- 	async		When updating the diff after a change, compute
+--- 			it in the background with the internal diff
+--- 			library.  Until it is done the previous diff
+--- 			blocks are used, adjusted for inserted and
+--- 			deleted lines.  `:diffupdate` always updates
+--- 			right away.
+---
 --- 	linematch:{n}   Enable a second stage diff on each generated
 --- 			hunk in order to align lines. When the total
 --- 			number of lines in a hunk exceeds {n}, the
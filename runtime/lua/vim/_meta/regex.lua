@@ -34,3 +34,28 @@ function regex:match_str(str) end
 --- @param start? integer
 --- @param end_? integer
 function regex:match_line(bufnr, line_idx, start, end_) end
+
+--- Match lines {start} to {end_} (zero-based, end-exclusive, negative indices
+--- count from the end like |nvim_buf_get_lines()|) in buffer {bufnr}. All
+--- lines are matched in one call, which is faster than calling
+--- |regex:match_line()| for each line.
+---
+--- Returns a flat list with three items for each match: the zero-based line
+--- number, and the byte indices for the beginning and end of the match.
+--- Example:
+---
+--- ```lua
+--- local m = vim.regex('\\<\\w\\+(\\@='):match_lines(0, 0, -1, { all = true })
+--- for i = 1, #m, 3 do
+---   print(m[i], m[i + 1], m[i + 2])
+--- end
+--- ```
+---
+--- @param bufnr integer
+--- @param start? integer First line, default 0
+--- @param end_? integer Last line (exclusive), default -1
+--- @param opts? table Optional keyword arguments:
+---              - all: (boolean) Find all matches in each line, not only the
+---                first one.
+--- @return integer[]
+function regex:match_lines(bufnr, start, end_, opts) end
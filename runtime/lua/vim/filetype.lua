@@ -2220,6 +2220,70 @@ end
 --- @type table<string,boolean>
 local expand_env_lookup = {}
 
+--- Lookup table/cache for the literal text a string matching a pattern must end with.
+--- @type table<string,string>
+local literal_suffix_lookup = {}
+
+--- Get the literal text at the end of Lua pattern {pat}, e.g. "/config.toml" for
+--- ".*/%.cargo/config.toml".
+--- @param pat string
+--- @return string
+local function literal_suffix(pat)
+  local items = {} --- @type (string|false)[] literal character or false for anything else
+  local i = 1
+  while i <= #pat do
+    local c = pat:sub(i, i)
+    if c == '%' then
+      local d = pat:sub(i + 1, i + 1)
+      if d == 'b' then
+        items[#items + 1] = false
+        i = i + 4
+      else
+        items[#items + 1] = not d:find('^%w') and d
+        i = i + 2
+      end
+    elseif c == '[' then
+      local j = i + 1
+      if pat:sub(j, j) == '^' then
+        j = j + 1
+      end
+      if pat:sub(j, j) == ']' then
+        j = j + 1
+      end
+      while j <= #pat and pat:sub(j, j) ~= ']' do
+        if pat:sub(j, j) == '%' then
+          j = j + 1
+        end
+        j = j + 1
+      end
+      items[#items + 1] = false
+      i = j + 1
+    elseif c:find('^[*+?-]') and #items > 0 then
+      items[#items] = false
+      i = i + 1
+    else
+      items[#items + 1] = not c:find('^[().$]') and c
+      i = i + 1
+    end
+  end
+
+  local suffix = {} --- @type string[]
+  for k = #items, 1, -1 do
+    if not items[k] then
+      break
+    end
+    table.insert(suffix, 1, items[k])
+  end
+  return table.concat(suffix)
+end
+
+--- @param s string
+--- @param suffix string
+--- @return boolean
+local function ends_with(s, suffix)
+  return #s >= #suffix and s:find(suffix, #s - #suffix + 1, true) ~= nil
+end
+
 --- @param name string
 --- @param path string
 --- @param tail string
@@ -2229,7 +2293,22 @@ local function match_pattern(name, path, tail, pat)
   if expand_env_lookup[pat] == nil then
     expand_env_lookup[pat] = pat:find('%${') ~= nil
   end
-  if expand_env_lookup[pat] then
+  if not expand_env_lookup[pat] then
+    -- A match must end in the literal text the pattern ends with, checking that first avoids
+    -- running most patterns.
+    if literal_suffix_lookup[pat] == nil then
+      literal_suffix_lookup[pat] = literal_suffix(pat)
+    end
+    local suffix = literal_suffix_lookup[pat]
+    if
+      suffix ~= ''
+      and not ends_with(tail, suffix)
+      and not ends_with(name, suffix)
+      and not ends_with(path, suffix)
+    then
+      return false
+    end
+  else
     local return_early --- @type true?
     --- @type string
     pat = pat:gsub('%${(%S-)}', function(env)
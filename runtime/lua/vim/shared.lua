@@ -183,6 +183,18 @@ end
 ---@param opts (table|nil) Keyword arguments |kwargs| accepted by |vim.gsplit()|
 ---@return string[] List of split components
 function vim.split(s, sep, opts)
+  if vim._split_plain and type(s) == 'string' and type(sep) == 'string' and sep ~= '' then
+    local plain, trimempty = opts, false
+    if type(opts) ~= 'boolean' then
+      vim.validate({ opts = { opts, 't', true } })
+      plain, trimempty = opts and opts.plain, opts and opts.trimempty
+    end
+    -- A separator without magic characters matches itself as a pattern.
+    if plain or not sep:find('[%^%$%(%)%%%.%[%]%*%+%-%?]') then
+      return vim._split_plain(s, sep, trimempty)
+    end
+  end
+
   local t = {}
   for c in vim.gsplit(s, sep, opts) do
     table.insert(t, c)
@@ -200,6 +212,9 @@ end
 ---@return T[] (list) List of keys
 function vim.tbl_keys(t)
   assert(type(t) == 'table', string.format('Expected table, got %s', type(t)))
+  if vim._tbl_keys then
+    return vim._tbl_keys(t)
+  end
 
   local keys = {}
   for k, _ in pairs(t) do
@@ -518,6 +533,9 @@ end
 ---@param t table List-like table
 ---@return table Flattened copy of the given list-like table
 function vim.tbl_flatten(t)
+  if vim._tbl_flatten and type(t) == 'table' then
+    return vim._tbl_flatten(t)
+  end
   local result = {}
   local function _tbl_flatten(_t)
     local n = #_t
@@ -53,6 +53,7 @@ function TSNode:_rawquery(query, captures, start, end_, opts) end
 ---@class TSParser
 ---@field parse fun(self: TSParser, tree: TSTree?, source: integer|string, include_bytes: true): TSTree, Range6[]
 ---@field parse fun(self: TSParser, tree: TSTree?, source: integer|string, include_bytes: false|nil): TSTree, Range4[]
+---@field parse_async fun(self: TSParser, tree: TSTree?, source: integer, include_bytes: boolean, cb: fun(err: string?, tree: TSTree?, changes: (Range4|Range6)[]?))
 ---@field reset fun(self: TSParser)
 ---@field included_ranges fun(self: TSParser, include_bytes: boolean?): integer[]
 ---@field set_included_ranges fun(self: TSParser, ranges: (Range6|TSNode)[])
@@ -2,7 +2,7 @@ local api = vim.api
 local query = vim.treesitter.query
 local Range = require('vim.treesitter._range')
 
----@alias TSHlIter fun(end_line: integer|nil): integer, TSNode, TSMetadata
+---@alias TSHlIter fun(line: integer, is_spell_nav: boolean): integer?, TSNode?, table?
 
 ---@class TSHighlightState
 ---@field next_row integer
@@ -235,51 +235,74 @@ local function on_line_impl(self, buf, line, is_spell_nav)
       return
     end
 
+    local q = highlighter_query:query()
+
     if state.iter == nil or state.next_row < line then
-      state.iter =
-        highlighter_query:query():iter_captures(root_node, self.bufnr, line, root_end_row + 1)
+      -- Captures without predicates are turned into decorations directly in C.
+      -- Cached, redrawing the same lines of an unchanged tree replays the captures.
+      state.iter = root_node:_rawquery(q.query, true, line, root_end_row + 1, {
+        cache = true,
+        highlight = {
+          buf = buf,
+          ns = ns,
+          priority = vim.highlight.priorities.treesitter,
+          hl_ids = highlighter_query.hl_cache,
+        },
+      })
     end
 
     while line >= state.next_row do
-      local capture, node, metadata = state.iter(line)
-
-      local range = { root_end_row + 1, 0, root_end_row + 1, 0 }
-      if node then
-        range = vim.treesitter.get_range(node, buf, metadata and metadata[capture])
-      end
-      local start_row, start_col, end_row, end_col = Range.unpack4(range)
-
-      if capture then
-        local hl = highlighter_query.hl_cache[capture]
-
-        local capture_name = highlighter_query:query().captures[capture]
-        local spell = nil ---@type boolean?
-        if capture_name == 'spell' then
-          spell = true
-        elseif capture_name == 'nospell' then
-          spell = false
+      local capture, node, match = state.iter(line, is_spell_nav)
+
+      if not capture then
+        state.next_row = root_end_row + 1
+      elseif not node then
+        -- captures until the first one after {line} have been highlighted
+        state.next_row = capture
+      else
+        local active = q:match_preds(match, match.pattern, buf)
+        match.active = active
+
+        local metadata = {}
+        if active then
+          q:apply_directives(match, match.pattern, buf, metadata)
         end
 
-        -- Give nospell a higher priority so it always overrides spell captures.
-        local spell_pri_offset = capture_name == 'nospell' and 1 or 0
-
-        if hl and end_row >= line and (not is_spell_nav or spell ~= nil) then
-          local priority = (tonumber(metadata.priority) or vim.highlight.priorities.treesitter)
-            + spell_pri_offset
-          api.nvim_buf_set_extmark(buf, ns, start_row, start_col, {
-            end_line = end_row,
-            end_col = end_col,
-            hl_group = hl,
-            ephemeral = true,
-            priority = priority,
-            conceal = metadata.conceal,
-            spell = spell,
-          })
+        local range = vim.treesitter.get_range(node, buf, metadata[capture])
+        local start_row, start_col, end_row, end_col = Range.unpack4(range)
+
+        if active then
+          local hl = highlighter_query.hl_cache[capture]
+
+          local capture_name = q.captures[capture]
+          local spell = nil ---@type boolean?
+          if capture_name == 'spell' then
+            spell = true
+          elseif capture_name == 'nospell' then
+            spell = false
+          end
+
+          -- Give nospell a higher priority so it always overrides spell captures.
+          local spell_pri_offset = capture_name == 'nospell' and 1 or 0
+
+          if hl and end_row >= line and (not is_spell_nav or spell ~= nil) then
+            local priority = (tonumber(metadata.priority) or vim.highlight.priorities.treesitter)
+              + spell_pri_offset
+            api.nvim_buf_set_extmark(buf, ns, start_row, start_col, {
+              end_line = end_row,
+              end_col = end_col,
+              hl_group = hl,
+              ephemeral = true,
+              priority = priority,
+              conceal = metadata.conceal,
+              spell = spell,
+            })
+          end
         end
-      end
 
-      if start_row > line then
-        state.next_row = start_row
+        if start_row > line then
+          state.next_row = start_row
+        end
       end
     end
   end)
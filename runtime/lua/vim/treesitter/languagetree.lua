@@ -89,8 +89,14 @@ local TSCallbackNames = {
 ---@field private _valid boolean|table<integer,boolean> If the parsed tree is valid
 ---@field private _logger? fun(logtype: string, msg: string)
 ---@field private _logfile? file*
+---@field private _async? LanguageTreeAsyncParse Background parse in progress
 local LanguageTree = {}
 
+---@class LanguageTreeAsyncParse
+---@field callbacks fun(err: string?, trees: table<integer, TSTree>?)[]
+---@field edits integer[][] Arguments of edits made while parsing, replayed on the new tree
+---@field reloaded boolean Buffer was reloaded while parsing, discard the result
+
 ---@class LanguageTreeOpts
 ---@field queries table<string,string>  -- Deprecated
 ---@field injections table<string,string>
@@ -234,6 +240,9 @@ function LanguageTree:invalidate(reload)
 
   -- buffer was reloaded, reparse all trees
   if reload then
+    if self._async then
+      self._async.reloaded = true
+    end
     for _, t in pairs(self._trees) do
       self:_do_callback('changedtree', t:included_ranges(true), t)
     end
@@ -345,6 +354,11 @@ function LanguageTree:_parse_regions(range)
     self._valid = {}
   end
 
+  -- The parser is busy, keep using the current trees until parse_async() is done.
+  if self._async then
+    return changes, no_regions_parsed, total_parse_time
+  end
+
   -- If there are no ranges, set to an empty list
   -- so the included ranges in the parser are cleared.
   for i, ranges in pairs(self:included_regions()) do
@@ -456,6 +470,90 @@ function LanguageTree:parse(range)
   return self._trees
 end
 
+--- Like |LanguageTree:parse()|, but parses the root tree of a buffer on a
+--- background thread so that the editor stays responsive. Edits made to the
+--- buffer while parsing are applied to the new tree before it replaces the
+--- current one. Injections and child trees are then parsed like
+--- |LanguageTree:parse()| does.
+---
+--- Parses synchronously if the source is a string or the tree has several
+--- regions, {on_parse} is then invoked before this function returns.
+---
+--- @param range boolean|Range|nil: see |LanguageTree:parse()|
+--- @param on_parse fun(err: string?, trees: table<integer, TSTree>?):
+---     Invoked with the parsed trees, or an error message.
+function LanguageTree:parse_async(range, on_parse)
+  if self._async then
+    table.insert(self._async.callbacks, on_parse)
+    return
+  end
+
+  local regions = self:included_regions()
+  if
+    self:is_valid(true)
+    or type(self._source) ~= 'number'
+    or not regions[1]
+    or vim.tbl_count(regions) ~= 1
+  then
+    local ok, trees = pcall(self.parse, self, range)
+    if ok then
+      on_parse(nil, trees)
+    else
+      on_parse(trees)
+    end
+    return
+  end
+
+  self._async = { callbacks = { on_parse }, edits = {}, reloaded = false }
+  self._parser:set_included_ranges(regions[1])
+  local start = vim.uv.hrtime()
+
+  self._parser:parse_async(self._trees[1], self._source, true, function(err, tree, tree_changes)
+    local async = assert(self._async)
+    self._async = nil
+
+    if not err and not async.reloaded then
+      for _, edit in ipairs(async.edits) do
+        tree:edit(unpack(edit))
+      end
+
+      -- Pass ranges if this is an initial parse
+      local cb_changes = self._trees[1] and tree_changes or tree:included_ranges(true)
+
+      self:_do_callback('changedtree', cb_changes, tree)
+      self._trees[1] = tree
+      self._regions = nil
+      self._injections_processed = false
+      -- Otherwise the region needs another (incremental) parse below
+      if #async.edits == 0 then
+        if type(self._valid) ~= 'table' then
+          self._valid = {}
+        end
+        self._valid[1] = true
+      end
+
+      self:_log({
+        changes = #tree_changes > 0 and tree_changes or nil,
+        parse_time = (vim.uv.hrtime() - start) / 1000000,
+        edits = #async.edits,
+      })
+    end
+
+    for _, cb in ipairs(async.callbacks) do
+      if err then
+        cb(err)
+      else
+        local ok, trees = pcall(self.parse, self, range)
+        if ok then
+          cb(nil, trees)
+        else
+          cb(trees)
+        end
+      end
+    end
+  end)
+end
+
 ---@deprecated Misleading name. Use `LanguageTree:children()` (non-recursive) instead,
 ---            add recursion yourself if needed.
 --- Invokes the callback for each |LanguageTree| and its children recursively
@@ -895,6 +993,20 @@ function LanguageTree:_edit(
   end_row_new,
   end_col_new
 )
+  if self._async then
+    table.insert(self._async.edits, {
+      start_byte,
+      end_byte_old,
+      end_byte_new,
+      start_row,
+      start_col,
+      end_row_old,
+      end_col_old,
+      end_row_new,
+      end_col_new,
+    })
+  end
+
   for _, tree in pairs(self._trees) do
     tree:edit(
       start_byte,
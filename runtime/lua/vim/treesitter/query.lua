@@ -685,17 +685,21 @@ end
 ---@param source (integer|string) Source buffer or string to extract text from
 ---@param start integer Starting line for the search
 ---@param stop integer Stopping line for the search (end-exclusive)
+---@param opts table|nil Options:
+---   - cache (boolean) Remember the captures, so that another call with the
+---     same {node}, {start} and {stop} does not need to run the query again
+---     while the tree is unchanged.
 ---
 ---@return (fun(end_line: integer|nil): integer, TSNode, TSMetadata):
 ---        capture id, capture node, metadata
-function Query:iter_captures(node, source, start, stop)
+function Query:iter_captures(node, source, start, stop, opts)
   if type(source) == 'number' and source == 0 then
     source = api.nvim_get_current_buf()
   end
 
   start, stop = value_or_node_range(start, stop, node)
 
-  local raw_iter = node:_rawquery(self.query, true, start, stop)
+  local raw_iter = node:_rawquery(self.query, true, start, stop, opts)
   local function iter(end_line)
     local capture, captured_node, match = raw_iter()
     local metadata = {}
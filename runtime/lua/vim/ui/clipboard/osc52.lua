@@ -13,7 +13,8 @@ function M.copy(reg)
   local clipboard = reg == '+' and 'c' or 'p'
   return function(lines)
     local s = table.concat(lines, '\n')
-    io.stdout:write(osc52(clipboard, vim.base64.encode(s)))
+    -- Write the parts separately, a large clipboard is not copied once more
+    io.stdout:write('\027]52;', clipboard, ';', vim.base64.encode(s), '\027\\')
   end
 end
 
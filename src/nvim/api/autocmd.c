@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -388,6 +389,10 @@ cleanup:
 ///             only once |autocmd-once|.
 ///             - nested (boolean) optional: defaults to false. Run nested
 ///             autocommands |autocmd-nested|.
+///             - debounce (integer) optional: delay in milliseconds. Instead of
+///             running right away, run once when the event was not triggered
+///             again for this long, with |<amatch>| and |<abuf>| of the last
+///             trigger. For frequent events like |CursorMoved|.
 ///
 /// @return Autocommand id (number)
 /// @see |autocommand|
@@ -470,6 +475,10 @@ Integer nvim_create_autocmd(uint64_t channel_id, Object event, Dict(create_autoc
     desc = opts->desc.data;
   }
 
+  VALIDATE_RANGE((opts->debounce >= 0 && opts->debounce <= INT_MAX), "debounce", {
+    goto cleanup;
+  });
+
   if (patterns.size == 0) {
     ADD(patterns, STATIC_CSTR_TO_OBJ("*"));
   }
@@ -502,6 +511,7 @@ Integer nvim_create_autocmd(uint64_t channel_id, Object event, Dict(create_autoc
         api_set_error(err, kErrorTypeException, "Failed to set autocmd");
         goto cleanup;
       }
+      autocmd_set_debounce(event_nr, (int)opts->debounce);
     })
   });
 
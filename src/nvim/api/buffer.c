@@ -147,6 +147,10 @@ Integer nvim_buf_line_count(Buffer buffer, Error *err)
 ///               region, as args to `on_lines`.
 ///             - preview: also attach to command preview (i.e. 'inccommand')
 ///               events.
+///             - bytes: (RPC only) send `nvim_buf_bytes_event` with the
+///               changed byte range and the inserted text, instead of
+///               `nvim_buf_lines_event` with whole lines. See
+///               |api-buffer-updates|.
 /// @param[out] err Error details, if any
 /// @return False if attach failed (invalid parameter, or buffer isn't loaded);
 ///         otherwise True. TODO: LUA_API_NO_EVAL
@@ -161,6 +165,7 @@ Boolean nvim_buf_attach(uint64_t channel_id, Buffer buffer, Boolean send_buffer,
   }
 
   bool is_lua = (channel_id == LUA_INTERNAL_CALL);
+  bool send_bytes = false;
   BufUpdateCallbacks cb = BUF_UPDATE_CALLBACKS_INIT;
   struct {
     const char *name;
@@ -206,6 +211,12 @@ Boolean nvim_buf_attach(uint64_t channel_id, Buffer buffer, Boolean send_buffer,
         cb.preview = v->data.boolean;
         key_used = true;
       }
+    } else if (strequal("bytes", k.data)) {
+      VALIDATE_T("bytes", kObjectTypeBoolean, v->type, {
+        goto error;
+      });
+      send_bytes = v->data.boolean;
+      key_used = true;
     }
 
     VALIDATE_S(key_used, "'opts' key", k.data, {
@@ -213,7 +224,7 @@ Boolean nvim_buf_attach(uint64_t channel_id, Buffer buffer, Boolean send_buffer,
     });
   }
 
-  return buf_updates_register(buf, channel_id, cb, send_buffer);
+  return buf_updates_register(buf, channel_id, cb, send_buffer, send_bytes);
 
 error:
   buffer_update_callbacks_free(cb);
@@ -277,6 +288,7 @@ ArrayOf(String) nvim_buf_get_lines(uint64_t channel_id,
                                    Integer start,
                                    Integer end,
                                    Boolean strict_indexing,
+                                   Arena *arena,
                                    lua_State *lstate,
                                    Error *err)
   FUNC_API_SINCE(1)
@@ -308,17 +320,19 @@ ArrayOf(String) nvim_buf_get_lines(uint64_t channel_id,
 
   size_t size = (size_t)(end - start);
 
-  init_line_array(lstate, &rv, size);
+  init_line_array(lstate, &rv, size, arena);
 
   if (!buf_collect_lines(buf, size, (linenr_T)start, 0, (channel_id != VIML_INTERNAL_CALL), &rv,
-                         lstate, err)) {
+                         arena, lstate, err)) {
     goto end;
   }
 
 end:
   if (ERROR_SET(err)) {
-    api_free_array(rv);
-    rv.items = NULL;
+    if (arena == NULL) {
+      api_free_array(rv);
+    }
+    rv = (Array)ARRAY_DICT_INIT;
   }
 
   return rv;
@@ -447,24 +461,28 @@ void nvim_buf_set_lines(uint64_t channel_id, Buffer buffer, Integer start, Integ
   }
 
   // Now we may need to insert the remaining new old_len
-  for (size_t i = to_replace; i < new_len; i++) {
-    int64_t lnum = start + (int64_t)i - 1;
+  if (to_replace < new_len) {
+    int64_t lnum = start + (int64_t)to_replace - 1;
+    int64_t count = (int64_t)(new_len - to_replace);
 
-    VALIDATE(lnum < MAXLNUM, "%s", "Index out of bounds", {
+    VALIDATE(lnum + count - 1 < MAXLNUM, "%s", "Index out of bounds", {
       goto end;
     });
 
-    if (ml_append_buf(buf, (linenr_T)lnum, lines[i], 0, false) == FAIL) {
+    int appended = ml_append_buf_lines(buf, (linenr_T)lnum, lines + to_replace, (int)count,
+                                       false);
+    for (size_t i = to_replace; i < to_replace + (size_t)appended; i++) {
+      inserted_bytes += (bcount_t)strlen(lines[i]) + 1;
+
+      // Same as with replacing, but we also need to free lines
+      xfree(lines[i]);
+      lines[i] = NULL;
+      extra++;
+    }
+    if (appended < count) {
       api_set_error(err, kErrorTypeException, "Failed to insert line");
       goto end;
     }
-
-    inserted_bytes += (bcount_t)strlen(lines[i]) + 1;
-
-    // Same as with replacing, but we also need to free lines
-    xfree(lines[i]);
-    lines[i] = NULL;
-    extra++;
   }
 
   // Adjust marks. Invalidate any which lie in the
@@ -700,22 +718,26 @@ void nvim_buf_set_text(uint64_t channel_id, Buffer buffer, Integer start_row, In
   }
 
   // Now we may need to insert the remaining new old_len
-  for (size_t i = to_replace; i < new_len; i++) {
-    int64_t lnum = start_row + (int64_t)i - 1;
+  if (to_replace < new_len) {
+    int64_t lnum = start_row + (int64_t)to_replace - 1;
+    int64_t count = (int64_t)(new_len - to_replace);
 
-    VALIDATE((lnum < MAXLNUM), "%s", "Index out of bounds", {
+    VALIDATE((lnum + count - 1 < MAXLNUM), "%s", "Index out of bounds", {
       goto end;
     });
 
-    if (ml_append_buf(buf, (linenr_T)lnum, lines[i], 0, false) == FAIL) {
+    int appended = ml_append_buf_lines(buf, (linenr_T)lnum, lines + to_replace, (int)count,
+                                       false);
+    for (size_t i = to_replace; i < to_replace + (size_t)appended; i++) {
+      // Same as with replacing, but we also need to free lines
+      xfree(lines[i]);
+      lines[i] = NULL;
+      extra++;
+    }
+    if (appended < count) {
       api_set_error(err, kErrorTypeException, "Failed to insert line");
       goto end;
     }
-
-    // Same as with replacing, but we also need to free lines
-    xfree(lines[i]);
-    lines[i] = NULL;
-    extra++;
   }
 
   colnr_T col_extent = (colnr_T)(end_col
@@ -780,8 +802,8 @@ early_end:
 ArrayOf(String) nvim_buf_get_text(uint64_t channel_id, Buffer buffer,
                                   Integer start_row, Integer start_col,
                                   Integer end_row, Integer end_col,
-                                  Dictionary opts, lua_State *lstate,
-                                  Error *err)
+                                  Dictionary opts, Arena *arena,
+                                  lua_State *lstate, Error *err)
   FUNC_API_SINCE(9)
 {
   Array rv = ARRAY_DICT_INIT;
@@ -820,34 +842,34 @@ ArrayOf(String) nvim_buf_get_text(uint64_t channel_id, Buffer buffer,
 
   size_t size = (size_t)(end_row - start_row) + 1;
 
-  init_line_array(lstate, &rv, size);
+  init_line_array(lstate, &rv, size, arena);
 
   if (start_row == end_row) {
     String line = buf_get_text(buf, start_row, start_col, end_col, err);
     if (ERROR_SET(err)) {
       goto end;
     }
-    push_linestr(lstate, &rv, line.data, line.size, 0, replace_nl);
+    push_linestr(lstate, &rv, line.data, line.size, 0, replace_nl, arena);
     return rv;
   }
 
   String str = buf_get_text(buf, start_row, start_col, MAXCOL - 1, err);
 
-  push_linestr(lstate, &rv, str.data, str.size, 0, replace_nl);
+  push_linestr(lstate, &rv, str.data, str.size, 0, replace_nl, arena);
 
   if (ERROR_SET(err)) {
     goto end;
   }
 
   if (size > 2) {
-    if (!buf_collect_lines(buf, size - 2, (linenr_T)start_row + 1, 1, replace_nl, &rv, lstate,
-                           err)) {
+    if (!buf_collect_lines(buf, size - 2, (linenr_T)start_row + 1, 1, replace_nl, &rv, arena,
+                           lstate, err)) {
       goto end;
     }
   }
 
   str = buf_get_text(buf, end_row, 0, end_col, err);
-  push_linestr(lstate, &rv, str.data, str.size, (int)(size - 1), replace_nl);
+  push_linestr(lstate, &rv, str.data, str.size, (int)(size - 1), replace_nl, arena);
 
   if (ERROR_SET(err)) {
     goto end;
@@ -855,7 +877,9 @@ ArrayOf(String) nvim_buf_get_text(uint64_t channel_id, Buffer buffer,
 
 end:
   if (ERROR_SET(err)) {
-    api_free_array(rv);
+    if (arena == NULL) {
+      api_free_array(rv);
+    }
     rv.size = 0;
     rv.items = NULL;
   }
@@ -1225,7 +1249,7 @@ Boolean nvim_buf_set_mark(Buffer buffer, String name, Integer line, Integer col,
 /// uppercase/file mark set in another buffer.
 /// @see |nvim_buf_set_mark()|
 /// @see |nvim_buf_del_mark()|
-ArrayOf(Integer, 2) nvim_buf_get_mark(Buffer buffer, String name, Error *err)
+ArrayOf(Integer, 2) nvim_buf_get_mark(Buffer buffer, String name, Arena *arena, Error *err)
   FUNC_API_SINCE(1)
 {
   Array rv = ARRAY_DICT_INIT;
@@ -1255,8 +1279,9 @@ ArrayOf(Integer, 2) nvim_buf_get_mark(Buffer buffer, String name, Error *err)
     pos = fm->mark;
   }
 
-  ADD(rv, INTEGER_OBJ(pos.lnum));
-  ADD(rv, INTEGER_OBJ(pos.col));
+  rv = arena_array(arena, 2);
+  ADD_C(rv, INTEGER_OBJ(pos.lnum));
+  ADD_C(rv, INTEGER_OBJ(pos.col));
 
   return rv;
 }
@@ -1432,10 +1457,14 @@ static void fix_cursor_cols(win_T *win, linenr_T start_row, colnr_T start_col, l
 /// @param lstate  Lua state. When NULL the Array is initialized instead.
 /// @param a       Array to initialize
 /// @param size    Size of array
-static inline void init_line_array(lua_State *lstate, Array *a, size_t size)
+/// @param arena   Arena to allocate the Array in, or NULL
+static inline void init_line_array(lua_State *lstate, Array *a, size_t size, Arena *arena)
 {
   if (lstate) {
     lua_createtable(lstate, (int)size, 0);
+  } else if (arena) {
+    *a = arena_array(arena, size);
+    a->size = size;
   } else {
     a->size = size;
     a->items = xcalloc(a->size, sizeof(Object));
@@ -1453,8 +1482,9 @@ static inline void init_line_array(lua_State *lstate, Array *a, size_t size)
 /// @param len         Size of string
 /// @param idx         0-based index to place s
 /// @param replace_nl  Replace newlines ('\n') with null ('\0')
+/// @param arena       Arena to allocate the copy of s in, or NULL
 static void push_linestr(lua_State *lstate, Array *a, const char *s, size_t len, int idx,
-                         bool replace_nl)
+                         bool replace_nl, Arena *arena)
 {
   if (lstate) {
     // Vim represents NULs as NLs
@@ -1470,7 +1500,7 @@ static void push_linestr(lua_State *lstate, Array *a, const char *s, size_t len,
   } else {
     String str = STRING_INIT;
     if (s) {
-      str = cbuf_to_string(s, len);
+      str = cbuf_as_string(arena_memdupz(arena, s, len), len);
       if (replace_nl) {
         // Vim represents NULs as NLs, but this may confuse clients.
         strchrsub(str.data, '\n', '\0');
@@ -1490,11 +1520,12 @@ static void push_linestr(lua_State *lstate, Array *a, const char *s, size_t len,
 /// @param start Line number to start from
 /// @param start_idx First index to push to
 /// @param[out] l If not NULL, Lines are copied here
+/// @param arena Arena to allocate the copies in `l`, or NULL
 /// @param[out] lstate If not NULL, Lines are pushed into a table onto the stack
 /// @param err[out] Error, if any
 /// @return true unless `err` was set
 bool buf_collect_lines(buf_T *buf, size_t n, linenr_T start, int start_idx, bool replace_nl,
-                       Array *l, lua_State *lstate, Error *err)
+                       Array *l, Arena *arena, lua_State *lstate, Error *err)
 {
   for (size_t i = 0; i < n; i++) {
     linenr_T lnum = start + (linenr_T)i;
@@ -1507,7 +1538,7 @@ bool buf_collect_lines(buf_T *buf, size_t n, linenr_T start, int start_idx, bool
     }
 
     char *bufstr = ml_get_buf(buf, lnum);
-    push_linestr(lstate, l, bufstr, strlen(bufstr), start_idx + (int)i, replace_nl);
+    push_linestr(lstate, l, bufstr, strlen(bufstr), start_idx + (int)i, replace_nl, arena);
   }
 
   return true;
@@ -250,7 +250,7 @@ String buffer_get_line(Buffer buffer, Integer index, Error *err)
   String rv = { .size = 0 };
 
   index = convert_index(index);
-  Array slice = nvim_buf_get_lines(0, buffer, index, index + 1, true, NULL, err);
+  Array slice = nvim_buf_get_lines(0, buffer, index, index + 1, true, NULL, NULL, err);
 
   if (!ERROR_SET(err) && slice.size) {
     rv = slice.items[0].data.string;
@@ -323,7 +323,7 @@ ArrayOf(String) buffer_get_line_slice(Buffer buffer,
 {
   start = convert_index(start) + !include_start;
   end = convert_index(end) + include_end;
-  return nvim_buf_get_lines(0, buffer, start, end, false, NULL, err);
+  return nvim_buf_get_lines(0, buffer, start, end, false, NULL, NULL, err);
 }
 
 /// Replaces a line range on the buffer
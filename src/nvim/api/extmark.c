@@ -8,6 +8,7 @@
 #include "nvim/api/extmark.h"
 #include "nvim/api/keysets.h"
 #include "nvim/api/private/defs.h"
+#include "nvim/api/private/dispatch.h"
 #include "nvim/api/private/helpers.h"
 #include "nvim/api/private/validate.h"
 #include "nvim/buffer_defs.h"
@@ -581,18 +582,97 @@ Integer nvim_buf_set_extmark(Buffer buffer, Integer ns_id, Integer line, Integer
                              Dict(set_extmark) *opts, Error *err)
   FUNC_API_SINCE(7)
 {
-  Decoration decor = DECORATION_INIT;
-  bool has_decor = false;
+  buf_T *buf = find_buffer_by_handle(buffer, err);
+  if (!buf) {
+    return 0;
+  }
+
+  VALIDATE_INT(ns_initialized((uint32_t)ns_id), "ns_id", ns_id, {
+    return 0;
+  });
+
+  return buf_set_extmark(buf, ns_id, line, col, opts, NULL, err);
+}
 
+/// Creates many |extmark|s at once.
+///
+/// Like calling |nvim_buf_set_extmark()| for each item, but new marks are
+/// inserted together, which is much faster for large numbers of marks (such as
+/// diagnostics or semantic tokens of a whole buffer).
+///
+/// Stops at the first invalid item, marks of earlier items are kept.
+///
+/// @param buffer  Buffer handle, or 0 for current buffer
+/// @param ns_id  Namespace id from |nvim_create_namespace()|
+/// @param marks  List of `[line, col, opts]` items, where `opts` is optional
+///               and takes the same keys as |nvim_buf_set_extmark()|.
+/// @param[out]  err   Error details, if any
+/// @return List of ids of the created/updated extmarks
+ArrayOf(Integer) nvim_buf_set_extmarks(uint64_t channel_id, Buffer buffer, Integer ns_id,
+                                       Array marks, Arena *arena, Error *err)
+  FUNC_API_SINCE(12)
+{
   buf_T *buf = find_buffer_by_handle(buffer, err);
   if (!buf) {
-    goto error;
+    return (Array)ARRAY_DICT_INIT;
   }
 
   VALIDATE_INT(ns_initialized((uint32_t)ns_id), "ns_id", ns_id, {
-    goto error;
+    return (Array)ARRAY_DICT_INIT;
   });
 
+  Array rv = arena_array(arena, marks.size);
+  ExtmarkInfoArray batch = KV_INITIAL_VALUE;
+  for (size_t i = 0; i < marks.size; i++) {
+    Object item = marks.items[i];
+    VALIDATE_T("mark", kObjectTypeArray, item.type, {
+      goto done;
+    });
+    Array a = item.data.array;
+    VALIDATE((a.size == 2 || a.size == 3), "%s", "mark must be [line, col, opts]", {
+      goto done;
+    });
+    VALIDATE_T("line", kObjectTypeInteger, a.items[0].type, {
+      goto done;
+    });
+    VALIDATE_T("col", kObjectTypeInteger, a.items[1].type, {
+      goto done;
+    });
+
+    Dict(set_extmark) opts = { 0 };
+    if (a.size == 3) {
+      VALIDATE_T_DICT("opts", a.items[2], {
+        goto done;
+      });
+      if (a.items[2].type == kObjectTypeDictionary
+          && !api_dict_to_keydict(&opts, KeyDict_set_extmark_get_field,
+                                  a.items[2].data.dictionary, err)) {
+        goto done;
+      }
+    }
+
+    Integer id = buf_set_extmark(buf, ns_id, a.items[0].data.integer, a.items[1].data.integer,
+                                 &opts, &batch, err);
+    if (ERROR_SET(err)) {
+      goto done;
+    }
+    ADD_C(rv, INTEGER_OBJ(id));
+  }
+
+done:
+  extmark_put_batch(buf, &batch);
+  kv_destroy(batch);
+  return rv;
+}
+
+/// @param batch  if not NULL, new marks are queued in "batch" instead of being
+///               inserted directly, see extmark_queue().
+static Integer buf_set_extmark(buf_T *buf, Integer ns_id, Integer line, Integer col,
+                               Dict(set_extmark) *opts, ExtmarkInfoArray *batch, Error *err)
+{
+  Decoration decor = DECORATION_INIT;
+  bool has_decor = false;
+
   uint32_t id = 0;
   if (HAS_KEY(opts, set_extmark, id)) {
     VALIDATE_EXP((opts->id > 0), "id", "positive Integer", NULL, {
@@ -838,10 +918,20 @@ Integer nvim_buf_set_extmark(Buffer buffer, Integer ns_id, Integer line, Integer
       goto error;
     }
 
-    extmark_set(buf, (uint32_t)ns_id, &id, (int)line, (colnr_T)col, line2, col2,
-                has_decor ? &decor : NULL, right_gravity, opts->end_right_gravity,
-                !GET_BOOL_OR_TRUE(opts, set_extmark, undo_restore),
-                opts->invalidate, err);
+    bool no_undo = !GET_BOOL_OR_TRUE(opts, set_extmark, undo_restore);
+    if (batch && id == 0) {
+      id = extmark_queue(buf, batch, (uint32_t)ns_id, (int)line, (colnr_T)col, line2, col2,
+                         has_decor ? &decor : NULL, right_gravity, opts->end_right_gravity,
+                         no_undo, opts->invalidate);
+    } else {
+      if (batch) {
+        // an explicit id might refer to a queued mark
+        extmark_put_batch(buf, batch);
+      }
+      extmark_set(buf, (uint32_t)ns_id, &id, (int)line, (colnr_T)col, line2, col2,
+                  has_decor ? &decor : NULL, right_gravity, opts->end_right_gravity,
+                  no_undo, opts->invalidate, err);
+    }
     if (ERROR_SET(err)) {
       goto error;
     }
@@ -1036,7 +1126,8 @@ void nvim_buf_clear_namespace(Buffer buffer, Integer ns_id, Integer line_start,
 /// doing `vim.rpcnotify` should be OK, but `vim.rpcrequest` is quite dubious
 /// for the moment.
 ///
-/// Note: It is not allowed to remove or update extmarks in 'on_line' callbacks.
+/// Note: It is not allowed to remove or update extmarks in 'on_range' and
+/// 'on_line' callbacks.
 ///
 /// @param ns_id  Namespace id from |nvim_create_namespace()|
 /// @param opts  Table of callbacks:
@@ -1049,6 +1140,12 @@ void nvim_buf_clear_namespace(Buffer buffer, Integer ns_id, Integer line_start,
 ///                 specific window. botline_guess is an approximation
 ///                 that does not exceed the last line number.
 ///                 ["win", winid, bufnr, topline, botline_guess]
+///             - on_range: called after on_win with the range of rows
+///                 (end-inclusive) which may be redrawn in the window. Set
+///                 `ephemeral` extmarks for all of them here instead of in
+///                 on_line, which is much cheaper than a call for each line.
+///                 Return `false` to skip the on_line calls for the window.
+///                 ["range", winid, bufnr, start_row, end_row]
 ///             - on_line: called for each buffer line being redrawn.
 ///                 (The interaction with fold lines is subject to change)
 ///                 ["win", winid, bufnr, row]
@@ -1072,6 +1169,7 @@ void nvim_set_decoration_provider(Integer ns_id, Dict(set_decoration_provider) *
     { "on_start", &opts->on_start, &p->redraw_start },
     { "on_buf", &opts->on_buf, &p->redraw_buf },
     { "on_win", &opts->on_win, &p->redraw_win },
+    { "on_range", &opts->on_range, &p->redraw_range },
     { "on_line", &opts->on_line, &p->redraw_line },
     { "on_end", &opts->on_end, &p->redraw_end },
     { "_on_hl_def", &opts->_on_hl_def, &p->hl_def },
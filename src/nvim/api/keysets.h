@@ -12,6 +12,7 @@ typedef struct {
   LuaRef on_start;
   LuaRef on_buf;
   LuaRef on_win;
+  LuaRef on_range;
   LuaRef on_line;
   LuaRef on_end;
   LuaRef _on_hl_def;
@@ -223,6 +224,7 @@ typedef struct {
   Buffer buffer;
   Object callback;
   String command;
+  Integer debounce;
   String desc;
   Object group;
   Boolean nested;
@@ -10,6 +10,7 @@
 #include "nvim/assert.h"
 #include "nvim/eval/typval.h"
 #include "nvim/eval/typval_defs.h"
+#include "nvim/eval/typval_encode.h"
 #include "nvim/eval/userfunc.h"
 #include "nvim/lua/executor.h"
 #include "nvim/memory.h"
@@ -100,7 +101,47 @@ static inline void typval_encode_list_start(EncodedData *const edata, const size
 #define TYPVAL_ENCODE_CONV_LIST_START(tv, len) \
   typval_encode_list_start(edata, (size_t)(len))
 
-#define TYPVAL_ENCODE_CONV_REAL_LIST_AFTER_START(tv, mpsv)
+/// Convert all items of a list that only contains Numbers, Floats and
+/// Strings at once, without going through the generic encoder for each item.
+/// Lists of lines or numbers are common arguments of rpcnotify().
+static inline void typval_encode_flat_list(EncodedData *const edata, MPConvStackVal *const mpsv)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL
+{
+  const list_T *const l = mpsv->data.l.list;
+  TV_LIST_ITER_CONST(l, li, {
+    const VarType type = TV_LIST_ITEM_TV(li)->v_type;
+    if (type != VAR_NUMBER && type != VAR_FLOAT && type != VAR_STRING) {
+      return;
+    }
+  });
+
+  Array *const list = &kv_last(edata->stack).data.array;
+  TV_LIST_ITER_CONST(l, li, {
+    const typval_T *const tv = TV_LIST_ITEM_TV(li);
+    Object obj;
+    switch (tv->v_type) {
+    case VAR_NUMBER:
+      obj = INTEGER_OBJ((Integer)tv->vval.v_number);
+      break;
+    case VAR_FLOAT:
+      obj = FLOAT_OBJ((Float)tv->vval.v_float);
+      break;
+    default:
+      obj = STRING_OBJ(cstr_to_string(tv->vval.v_string != NULL ? tv->vval.v_string : ""));
+      break;
+    }
+    if (li == tv_list_last(l)) {
+      // The last item is added by TYPVAL_ENCODE_CONV_LIST_END().
+      kvi_push(edata->stack, obj);
+    } else {
+      list->items[list->size++] = obj;
+    }
+  });
+  mpsv->data.l.li = NULL;
+}
+
+#define TYPVAL_ENCODE_CONV_REAL_LIST_AFTER_START(tv, mpsv) \
+  typval_encode_flat_list(edata, &(mpsv))
 
 static inline void typval_encode_between_list_items(EncodedData *const edata)
   FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_NONNULL_ALL
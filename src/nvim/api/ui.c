@@ -16,6 +16,7 @@
 #include "nvim/channel.h"
 #include "nvim/eval.h"
 #include "nvim/event/loop.h"
+#include "nvim/event/multiqueue.h"
 #include "nvim/event/wstream.h"
 #include "nvim/globals.h"
 #include "nvim/grid.h"
@@ -42,6 +43,42 @@
 
 static PMap(uint64_t) connected_uis = MAP_INIT;
 
+// Buffers of UI_BUF_SIZE bytes which were written to a client and can be
+// packed into again, so that remote_ui_flush_buf() hands off the buffer
+// instead of copying it.
+#define UI_BUF_REUSE_MAX 4
+static char *ui_buf_reuse[UI_BUF_REUSE_MAX];
+static int ui_buf_reuse_len = 0;
+
+static char *ui_buf_alloc(void)
+{
+  return ui_buf_reuse_len > 0 ? ui_buf_reuse[--ui_buf_reuse_len] : xmalloc(UI_BUF_SIZE);
+}
+
+static void ui_buf_release(void *buf)
+{
+#ifdef EXITFREE
+  if (entered_free_all_mem) {
+    xfree(buf);
+    return;
+  }
+#endif
+  if (ui_buf_reuse_len < UI_BUF_REUSE_MAX) {
+    ui_buf_reuse[ui_buf_reuse_len++] = buf;
+  } else {
+    xfree(buf);
+  }
+}
+
+#ifdef EXITFREE
+void remote_ui_free_all_mem(void)
+{
+  while (ui_buf_reuse_len > 0) {
+    xfree(ui_buf_reuse[--ui_buf_reuse_len]);
+  }
+}
+#endif
+
 #define mpack_w(b, byte) *(*b)++ = (char)(byte);
 static void mpack_w2(char **b, uint32_t v)
 {
@@ -116,8 +153,13 @@ void remote_ui_disconnect(uint64_t channel_id)
   }
   UIData *data = ui->data;
   kv_destroy(data->call_buf);
+  ui_buf_release(data->buf);
   pmap_del(uint64_t)(&connected_uis, channel_id, NULL);
   ui_detach_impl(ui, channel_id);
+  Channel *chan = find_channel(channel_id);
+  if (chan) {
+    multiqueue_set_priority(chan->events, false);
+  }
 
   // Destroy `ui`.
   XFREE_CLEAR(ui->term_name);
@@ -212,6 +254,7 @@ void nvim_ui_attach(uint64_t channel_id, Integer width, Integer height, Dictiona
   data->ncalls_pos = NULL;
   data->ncalls = 0;
   data->ncells_pending = 0;
+  data->buf = ui_buf_alloc();
   data->buf_wptr = data->buf;
   data->temp_buf = NULL;
   data->wildmenu_active = false;
@@ -221,6 +264,12 @@ void nvim_ui_attach(uint64_t channel_id, Integer width, Integer height, Dictiona
   pmap_put(uint64_t)(&connected_uis, channel_id, ui);
   ui_attach_impl(ui, channel_id);
 
+  // Keep the UI responsive while jobs or other channels flood the main loop.
+  Channel *chan = find_channel(channel_id);
+  if (chan) {
+    multiqueue_set_priority(chan->events, true);
+  }
+
   may_trigger_vim_suspend_resume(false);
 }
 
@@ -881,9 +930,16 @@ void remote_ui_raw_line(UI *ui, Integer grid, Integer row, Integer startcol, Int
         uint32_t csize = (repeat > 1) ? 3 : ((attrs[i] != last_hl) ? 2 : 1);
         nelem++;
         mpack_array(buf, csize);
-        char sc_buf[MAX_SCHAR_SIZE];
-        schar_get(sc_buf, chunk[i]);
-        mpack_str(buf, sc_buf);
+        char ascii = schar_get_ascii(chunk[i]);
+        if (ascii != NUL) {
+          // Most cells are ASCII: skip the copy and strlen() of mpack_str().
+          mpack_w(buf, 0xa1);
+          mpack_w(buf, ascii);
+        } else {
+          char sc_buf[MAX_SCHAR_SIZE];
+          schar_get(sc_buf, chunk[i]);
+          mpack_str(buf, sc_buf);
+        }
         if (csize >= 2) {
           mpack_uint(buf, (uint32_t)attrs[i]);
           if (csize >= 3) {
@@ -958,10 +1014,10 @@ void remote_ui_flush_buf(UI *ui)
   data->nevents = 0;
   data->nevents_pos = NULL;
 
-  // TODO(bfredl): elide copy by a length one free-list like the arena
   size_t size = BUF_POS(data);
-  WBuffer *buf = wstream_new_buffer(xmemdup(data->buf, size), size, 1, xfree);
+  WBuffer *buf = wstream_new_buffer(data->buf, size, 1, ui_buf_release);
   rpc_write_raw(data->channel_id, buf);
+  data->buf = ui_buf_alloc();
   data->buf_wptr = data->buf;
   // we have sent events to the client, but possibly not yet the final "flush"
   // event.
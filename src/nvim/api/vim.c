@@ -800,20 +800,19 @@ void nvim_err_writeln(String str)
 /// Use |nvim_buf_is_loaded()| to check if a buffer is loaded.
 ///
 /// @return List of buffer handles
-ArrayOf(Buffer) nvim_list_bufs(void)
+ArrayOf(Buffer) nvim_list_bufs(Arena *arena)
   FUNC_API_SINCE(1)
 {
-  Array rv = ARRAY_DICT_INIT;
+  size_t n = 0;
 
   FOR_ALL_BUFFERS(b) {
-    rv.size++;
+    n++;
   }
 
-  rv.items = xmalloc(sizeof(Object) * rv.size);
-  size_t i = 0;
+  Array rv = arena_array(arena, n);
 
   FOR_ALL_BUFFERS(b) {
-    rv.items[i++] = BUFFER_OBJ(b->handle);
+    ADD_C(rv, BUFFER_OBJ(b->handle));
   }
 
   return rv;
@@ -855,20 +854,19 @@ void nvim_set_current_buf(Buffer buffer, Error *err)
 /// Gets the current list of window handles.
 ///
 /// @return List of window handles
-ArrayOf(Window) nvim_list_wins(void)
+ArrayOf(Window) nvim_list_wins(Arena *arena)
   FUNC_API_SINCE(1)
 {
-  Array rv = ARRAY_DICT_INIT;
+  size_t n = 0;
 
   FOR_ALL_TAB_WINDOWS(tp, wp) {
-    rv.size++;
+    n++;
   }
 
-  rv.items = xmalloc(sizeof(Object) * rv.size);
-  size_t i = 0;
+  Array rv = arena_array(arena, n);
 
   FOR_ALL_TAB_WINDOWS(tp, wp) {
-    rv.items[i++] = WINDOW_OBJ(wp->handle);
+    ADD_C(rv, WINDOW_OBJ(wp->handle));
   }
 
   return rv;
@@ -1099,20 +1097,19 @@ void nvim_chan_send(Integer chan, String data, Error *err)
 /// Gets the current list of tabpage handles.
 ///
 /// @return List of tabpage handles
-ArrayOf(Tabpage) nvim_list_tabpages(void)
+ArrayOf(Tabpage) nvim_list_tabpages(Arena *arena)
   FUNC_API_SINCE(1)
 {
-  Array rv = ARRAY_DICT_INIT;
+  size_t n = 0;
 
   FOR_ALL_TABS(tp) {
-    rv.size++;
+    n++;
   }
 
-  rv.items = xmalloc(sizeof(Object) * rv.size);
-  size_t i = 0;
+  Array rv = arena_array(arena, n);
 
   FOR_ALL_TABS(tp) {
-    rv.items[i++] = TABPAGE_OBJ(tp->handle);
+    ADD_C(rv, TABPAGE_OBJ(tp->handle));
   }
 
   return rv;
@@ -1422,16 +1419,16 @@ Object nvim_load_context(Dictionary dict, Error *err)
 /// "blocking" is true if Nvim is waiting for input.
 ///
 /// @returns Dictionary { "mode": String, "blocking": Boolean }
-Dictionary nvim_get_mode(void)
+Dictionary nvim_get_mode(Arena *arena)
   FUNC_API_SINCE(2) FUNC_API_FAST
 {
-  Dictionary rv = ARRAY_DICT_INIT;
-  char modestr[MODE_MAX_LENGTH];
+  Dictionary rv = arena_dict(arena, 2);
+  char *modestr = arena_alloc(arena, MODE_MAX_LENGTH, false);
   get_mode(modestr);
   bool blocked = input_blocking();
 
-  PUT(rv, "mode", CSTR_TO_OBJ(modestr));
-  PUT(rv, "blocking", BOOLEAN_OBJ(blocked));
+  PUT_C(rv, "mode", CSTR_AS_OBJ(modestr));
+  PUT_C(rv, "blocking", BOOLEAN_OBJ(blocked));
 
   return rv;
 }
@@ -1823,9 +1820,32 @@ Float nvim__id_float(Float flt)
   return flt;
 }
 
+static Dictionary stats_hist_dict(const stats_hist_T *hist)
+{
+  Dictionary rv = ARRAY_DICT_INIT;
+  PUT(rv, "count", INTEGER_OBJ(hist->count));
+  PUT(rv, "total", INTEGER_OBJ(hist->total));
+  PUT(rv, "max", INTEGER_OBJ(hist->max));
+  Array buckets = ARRAY_DICT_INIT;
+  for (int i = 0; i < STATS_HIST_BUCKETS; i++) {
+    ADD(buckets, INTEGER_OBJ(hist->buckets[i]));
+  }
+  PUT(rv, "buckets", ARRAY_OBJ(buckets));
+  return rv;
+}
+
 /// Gets internal stats.
 ///
-/// @return Map of various internal stats.
+/// Durations are histograms with "count", "total" and "max" (nanoseconds)
+/// and "buckets": the first counts durations below 1 usec, the next ones
+/// below 2, 4, 8, ... usec, the last one the rest.
+///
+/// @return Map of various internal stats:
+///   - "input_latency": time typed keys wait before they are processed
+///   - "event_batch": time to process a batch of main loop events
+///   - "update_screen": time of a screen update
+///   - "alloc": live allocations ("count" and "bytes") per category, only
+///     when enabled with |nvim__alloc_track()|
 Dictionary nvim__stats(void)
 {
   Dictionary rv = ARRAY_DICT_INIT;
@@ -1834,9 +1854,35 @@ Dictionary nvim__stats(void)
   PUT(rv, "lua_refcount", INTEGER_OBJ(nlua_get_global_ref_count()));
   PUT(rv, "redraw", INTEGER_OBJ(g_stats.redraw));
   PUT(rv, "arena_alloc_count", INTEGER_OBJ((Integer)arena_alloc_count));
+  PUT(rv, "input_latency", DICTIONARY_OBJ(stats_hist_dict(&g_stats.input_latency)));
+  PUT(rv, "event_batch", DICTIONARY_OBJ(stats_hist_dict(&g_stats.event_batch)));
+  PUT(rv, "update_screen", DICTIONARY_OBJ(stats_hist_dict(&g_stats.update_screen)));
+  if (alloc_track_enabled()) {
+    Dictionary alloc = ARRAY_DICT_INIT;
+    for (int i = 0; i < kAllocTagCount; i++) {
+      int64_t count, bytes;
+      const char *name = alloc_track_get((AllocTag)i, &count, &bytes);
+      Dictionary tag = ARRAY_DICT_INIT;
+      PUT(tag, "count", INTEGER_OBJ(count));
+      PUT(tag, "bytes", INTEGER_OBJ(bytes));
+      PUT(alloc, name, DICTIONARY_OBJ(tag));
+    }
+    PUT(rv, "alloc", DICTIONARY_OBJ(alloc));
+  }
   return rv;
 }
 
+/// Starts or stops counting live allocations per category (memline, undo,
+/// eval, lua, extmark, rpc, other), reported as "alloc" by |nvim__stats()|.
+/// Starting resets the counts; only allocations made afterwards are seen.
+/// Setting $NVIM_ALLOC_TRACK starts it at startup.
+///
+/// @param enable  Start (true) or stop (false).
+void nvim__alloc_track(Boolean enable)
+{
+  alloc_track_enable(enable);
+}
+
 /// Gets a list of dictionaries representing attached UIs.
 ///
 /// @return Array of UI dictionaries, each with these keys:
@@ -167,6 +167,7 @@ void alist_set(alist_T *al, int count, char **files, int use_curbuf, int *fnum_l
   alist_clear(al);
   ga_grow(&al->al_ga, count);
   {
+    buflist_index_start();
     for (int i = 0; i < count; i++) {
       if (got_int) {
         // When adding many buffers this can take a long time.  Allow
@@ -188,6 +189,7 @@ void alist_set(alist_T *al, int count, char **files, int use_curbuf, int *fnum_l
       alist_add(al, files[i], use_curbuf ? 2 : 1);
       os_breakcheck();
     }
+    buflist_index_end();
     xfree(files);
   }
 
@@ -353,11 +355,13 @@ static void alist_add_list(int count, char **files, int after, bool will_edit)
               (size_t)(ARGCOUNT - after) * sizeof(aentry_T));
     }
     arglist_locked = true;
+    buflist_index_start();
     for (int i = 0; i < count; i++) {
       const int flags = BLN_LISTED | (will_edit ? BLN_CURBUF : 0);
       ARGLIST[after + i].ae_fname = files[i];
       ARGLIST[after + i].ae_fnum = buflist_add(files[i], flags);
     }
+    buflist_index_end();
     arglist_locked = false;
     ALIST(curwin)->al_ga.ga_len += count;
     if (old_argcount > 0 && curwin->w_arg_idx >= after) {
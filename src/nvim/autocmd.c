@@ -16,6 +16,7 @@
 #include "nvim/eval/typval.h"
 #include "nvim/eval/userfunc.h"
 #include "nvim/eval/vars.h"
+#include "nvim/event/time.h"
 #include "nvim/ex_docmd.h"
 #include "nvim/ex_eval.h"
 #include "nvim/fileio.h"
@@ -27,6 +28,7 @@
 #include "nvim/highlight_defs.h"
 #include "nvim/insexpand.h"
 #include "nvim/lua/executor.h"
+#include "nvim/main.h"
 #include "nvim/map.h"
 #include "nvim/memline_defs.h"
 #include "nvim/memory.h"
@@ -98,6 +100,19 @@ static bool autocmd_include_groups = false;
 
 static char *old_termresponse = NULL;
 
+/// State of an autocommand with a "debounce" delay: it runs once when the
+/// event was not triggered again for "timeout" msec.
+struct AutoCmdDebounce_S {
+  TimeWatcher tw;
+  event_T event;      ///< event to trigger
+  int timeout;        ///< delay in msec
+  char *fname;        ///< file name or pattern of the last trigger
+  int bufnr;          ///< buffer of the last trigger
+};
+
+/// Set while triggering a delayed autocommand, only that autocommand runs.
+static AutoCmdDebounce *debounce_running = NULL;
+
 // Map of autocmd group names and ids.
 //  name -> ID
 //  ID -> name
@@ -292,6 +307,7 @@ static void aucmd_del(AutoCmd *ac)
   ac->pat = NULL;
   aucmd_exec_free(&ac->exec);
   XFREE_CLEAR(ac->desc);
+  aucmd_debounce_del(ac);
 
   au_need_clean = true;
 }
@@ -1031,6 +1047,20 @@ int autocmd_register(int64_t id, event_T event, const char *pat, int patlen, int
     ap->refcount = 0;
     ap->pat = xmemdupz(pat, (size_t)patlen);
     ap->patlen = patlen;
+    ap->match_kind = NUL;
+    if (!is_buflocal && patlen >= 1 && pat[0] == '*') {
+      int i;
+      for (i = 1; i < patlen; i++) {
+        if (!ASCII_ISALNUM(pat[i]) && vim_strchr("._-", (uint8_t)pat[i]) == NULL) {
+          break;
+        }
+      }
+      if (patlen == 1) {
+        ap->match_kind = '*';
+      } else if (i == patlen && pat[1] == '.') {
+        ap->match_kind = '.';
+      }
+    }
 
     // need to initialize last_mode for the first ModeChanged autocmd
     if (event == EVENT_MODECHANGED && !has_event(EVENT_MODECHANGED)) {
@@ -1075,10 +1105,86 @@ int autocmd_register(int64_t id, event_T event, const char *pat, int patlen, int
   ac->once = once;
   ac->nested = nested;
   ac->desc = desc == NULL ? NULL : xstrdup(desc);
+  ac->debounce = NULL;
 
   return OK;
 }
 
+/// Give the autocommand last added for "event" a "debounce" delay of
+/// "timeout" msec.
+void autocmd_set_debounce(event_T event, int timeout)
+{
+  AutoCmdVec *const acs = &autocmds[(int)event];
+  if (kv_size(*acs) == 0 || timeout <= 0) {
+    return;
+  }
+  AutoCmd *const ac = &kv_last(*acs);
+  assert(ac->debounce == NULL);
+  AutoCmdDebounce *ds = xmalloc(sizeof(*ds));
+  time_watcher_init(&main_loop, &ds->tw, ds);
+  // Run from the main loop like a timer, with the close event queued after
+  // any pending due event.
+  ds->tw.events = main_loop.events;
+  ds->tw.blockable = true;
+  ds->event = event;
+  ds->timeout = timeout;
+  ds->fname = NULL;
+  ds->bufnr = 0;
+  ac->debounce = ds;
+}
+
+/// (Re)start the delay of an autocommand that matched "apc".
+static void aucmd_debounce_start(AutoCmdDebounce *ds, AutoPatCmd *apc)
+{
+  xfree(ds->fname);
+  ds->fname = xstrdup(apc->fname != NULL ? apc->fname : "");
+  ds->bufnr = apc->arg_bufnr;
+  time_watcher_stop(&ds->tw);
+  time_watcher_start(&ds->tw, aucmd_debounce_cb, (uint64_t)ds->timeout, 0);
+}
+
+/// The delay of an autocommand passed: trigger its event again, running only
+/// that autocommand.
+static void aucmd_debounce_cb(TimeWatcher *tw, void *data)
+{
+  AutoCmdDebounce *ds = data;
+  buf_T *buf = ds->bufnr != 0 ? buflist_findnr(ds->bufnr) : curbuf;
+  if (buf == NULL) {
+    return;  // buffer was wiped out
+  }
+  debounce_running = ds;
+  apply_autocmds_group(ds->event, ds->fname, ds->fname, false, AUGROUP_ALL, buf, NULL, NULL);
+  debounce_running = NULL;
+}
+
+static void aucmd_debounce_close_cb(TimeWatcher *tw, void *data)
+{
+  AutoCmdDebounce *ds = data;
+  xfree(ds->fname);
+  xfree(ds);
+}
+
+static void aucmd_debounce_del(AutoCmd *ac)
+{
+  if (ac->debounce != NULL) {
+    time_watcher_stop(&ac->debounce->tw);
+    time_watcher_close(&ac->debounce->tw, aucmd_debounce_close_cb);
+    ac->debounce = NULL;
+  }
+}
+
+/// Stop the timers of autocommands with a "debounce" delay, before closing
+/// the main loop.  The autocommands then run right away.
+void au_debounce_teardown(void)
+{
+  FOR_ALL_AUEVENTS(event) {
+    AutoCmdVec *const acs = &autocmds[(int)event];
+    for (size_t i = 0; i < kv_size(*acs); i++) {
+      aucmd_debounce_del(&kv_A(*acs, i));
+    }
+  }
+}
+
 size_t aucmd_pattern_length(const char *pat)
   FUNC_ATTR_PURE
 {
@@ -1763,7 +1869,10 @@ bool apply_autocmds_group(event_T event, char *fname, char *fname_io, bool force
     .group = group,
     .event = event,
     .arg_bufnr = autocmd_bufnr,
+    .debounce = debounce_running,
   };
+  // Autocommands triggered from here run as usual.
+  debounce_running = NULL;
   aucmd_next(&patcmd);
 
   // Found first autocommand, start executing them
@@ -1797,9 +1906,22 @@ bool apply_autocmds_group(event_T event, char *fname, char *fname_io, bool force
     const int save_did_emsg = did_emsg;
     const bool save_ex_pressedreturn = get_pressedreturn();
 
+    proftime_T rel_time;
+    proftime_T start_time;
+    FILE *const l_time_fd = time_fd;
+    if (l_time_fd != NULL) {
+      time_push(&rel_time, &start_time);
+    }
+
     // Execute the autocmd. The `getnextac` callback handles iteration.
     do_cmdline(NULL, getnextac, &patcmd, DOCMD_NOWAIT | DOCMD_VERBOSE | DOCMD_REPEAT);
 
+    if (l_time_fd != NULL) {
+      vim_snprintf(IObuff, IOSIZE, "%s autocommands for \"%s\"", event_nr2name(event), tail);
+      time_msg(IObuff, &start_time);
+      time_pop(rel_time);
+    }
+
     did_emsg += save_did_emsg;
     set_pressedreturn(save_ex_pressedreturn);
 
@@ -1921,6 +2043,35 @@ bool is_autocmd_blocked(void)
 
 /// Find next matching autocommand.
 /// If next autocommand was not found, sets lastpat to NULL and cmdidx to SIZE_MAX on apc.
+/// Check whether file pattern "ap" matches the file name, without using the
+/// regexp for the common "*" and "*.ext" patterns.
+static bool aupat_match(AutoPat *ap, char *fname, char *sfname, char *tail)
+{
+  if (ap->match_kind == '*') {
+    return true;
+  }
+  if (ap->match_kind == '.') {
+    const size_t len = (size_t)ap->patlen - 1;
+    const size_t taillen = strlen(tail);
+    if (taillen < len) {
+      return false;
+    }
+    const char *const end = tail + taillen - len;
+    if (!p_fic) {
+      return strcmp(end, ap->pat + 1) == 0;
+    }
+    // Non-ASCII characters may fold to ASCII ones, leave those to the regexp.
+    bool ascii = true;
+    for (const char *p = tail; *p != NUL && ascii; p++) {
+      ascii = (uint8_t)(*p) < 0x80;
+    }
+    if (ascii) {
+      return STRICMP(end, ap->pat + 1) == 0;
+    }
+  }
+  return match_file_pat(NULL, &ap->reg_prog, fname, sfname, tail, ap->allow_dirs);
+}
+
 static void aucmd_next(AutoPatCmd *apc)
 {
   estack_T *const entry = ((estack_T *)exestack.ga_data) + exestack.ga_len - 1;
@@ -1943,7 +2094,7 @@ static void aucmd_next(AutoPatCmd *apc)
       }
       // Skip autocommands that don't match the pattern or buffer number.
       if (ap->buflocal_nr == 0
-          ? !match_file_pat(NULL, &ap->reg_prog, apc->fname, apc->sfname, apc->tail, ap->allow_dirs)
+          ? !aupat_match(ap, apc->fname, apc->sfname, apc->tail)
           : ap->buflocal_nr != apc->arg_bufnr) {
         continue;
       }
@@ -1966,6 +2117,14 @@ static void aucmd_next(AutoPatCmd *apc)
       entry->es_info.aucmd = apc;
     }
 
+    // An autocommand with a delay runs later, when triggered by its timer.
+    if (ac->debounce != apc->debounce) {
+      if (apc->debounce == NULL) {
+        aucmd_debounce_start(ac->debounce, apc);
+      }
+      continue;
+    }
+
     apc->lastpat = ap;
     apc->auidx = i;
 
@@ -2135,7 +2294,7 @@ bool has_autocmd(event_T event, char *sfname, buf_T *buf)
     AutoPat *const ap = kv_A(*acs, i).pat;
     if (ap != NULL
         && (ap->buflocal_nr == 0
-            ? match_file_pat(NULL, &ap->reg_prog, fname, sfname, tail, ap->allow_dirs)
+            ? aupat_match(ap, fname, sfname, tail)
             : buf != NULL && ap->buflocal_nr == buf->b_fnum)) {
       retval = true;
       break;
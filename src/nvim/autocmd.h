@@ -13,6 +13,7 @@
 #include "nvim/types.h"
 
 struct AutoPatCmd_S;
+typedef struct AutoCmdDebounce_S AutoCmdDebounce;
 
 // event_T definition
 #ifdef INCLUDE_GENERATED_DECLARATIONS
@@ -41,6 +42,8 @@ typedef struct {
   int patlen;               ///< strlen() of pat
   int buflocal_nr;          ///< !=0 for buffer-local AutoPat
   char allow_dirs;          ///< Pattern may match whole path
+  char match_kind;          ///< '*': pattern is "*", '.': pattern is "*.ext",
+                            ///< NUL: only "reg_prog" can tell
 } AutoPat;
 
 typedef struct {
@@ -51,6 +54,7 @@ typedef struct {
   sctx_T script_ctx;        ///< Script context where it is defined
   bool once;                ///< "One shot": removed after execution
   bool nested;              ///< If autocommands nest here
+  AutoCmdDebounce *debounce;  ///< Delay state, NULL if run right away
 } AutoCmd;
 
 /// Struct used to keep status while executing autocommands for an event.
@@ -67,6 +71,7 @@ struct AutoPatCmd_S {
   sctx_T script_ctx;        ///< Script context where it is defined
   int arg_bufnr;            ///< Initially equal to <abuf>, set to zero when buf is deleted
   Object *data;             ///< Arbitrary data
+  AutoCmdDebounce *debounce;  ///< Only run autocmds with this delay state
   AutoPatCmd *next;         ///< Chain of active apc-s for auto-invalidation
 };
 
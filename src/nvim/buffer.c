@@ -64,6 +64,7 @@
 #include "nvim/help.h"
 #include "nvim/indent.h"
 #include "nvim/indent_c.h"
+#include "nvim/insexpand.h"
 #include "nvim/main.h"
 #include "nvim/map.h"
 #include "nvim/mapping.h"
@@ -117,6 +118,14 @@ static int buf_free_count = 0;
 
 static int top_file_num = 1;            ///< highest file number
 
+// Index of buffer names and file IDs, used by buflist_findname_file_id()
+// between buflist_index_start() and buflist_index_end().  The values are
+// buffer numbers and may be stale, a found buffer is checked again.
+static int buflist_index_nest = 0;
+static bool buflist_index_valid = false;  ///< false: rebuild on next lookup
+static Map(cstr_t, int) buflist_index_names = MAP_INIT;
+static Map(uint64_t, uint64_t) buflist_index_ids = MAP_INIT;
+
 typedef enum {
   kBffClearWinInfo = 1,
   kBffInitChangedtick = 2,
@@ -835,6 +844,7 @@ void buf_freeall(buf_T *buf, int flags)
 
   ml_close(buf, true);              // close and delete the memline/memfile
   buf->b_ml.ml_line_count = 0;      // no lines in buffer
+  ins_compl_free_words(buf);
   if ((flags & BFA_KEEP_UNDO) == 0) {
     u_blockfree(buf);               // free the memory allocated for undo
     u_clearall(buf);                // reset all undo information
@@ -904,6 +914,7 @@ static void free_buffer_stuff(buf_T *buf, int free_flags)
     clear_wininfo(buf);                 // including window-local options
     free_buf_options(buf, true);
     ga_clear(&buf->b_s.b_langp);
+    spell_cache_free(&buf->b_s);
   }
   {
     // Avoid losing b:changedtick when deleting buffer: clearing variables
@@ -923,6 +934,8 @@ static void free_buffer_stuff(buf_T *buf, int free_flags)
   map_clear_mode(buf, MAP_ALL_MODES, true, false);  // clear local mappings
   map_clear_mode(buf, MAP_ALL_MODES, true, true);   // clear local abbrevs
   XFREE_CLEAR(buf->b_start_fenc);
+  search_stat_free(buf);
+  ins_compl_free_words(buf);
 
   buf_updates_unload(buf, false);
 }
@@ -1806,9 +1819,11 @@ buf_T *buflist_new(char *ffname_arg, char *sfname_arg, linenr_T lnum, int flags)
       bufref_T bufref;
       set_bufref(&bufref, buf);
       if (!(flags & BLN_DUMMY)) {
-        if (apply_autocmds(EVENT_BUFADD, NULL, NULL, false, buf)
-            && !bufref_valid(&bufref)) {
-          return NULL;
+        if (apply_autocmds(EVENT_BUFADD, NULL, NULL, false, buf)) {
+          buflist_index_invalidate();
+          if (!bufref_valid(&bufref)) {
+            return NULL;
+          }
         }
       }
     }
@@ -1828,6 +1843,7 @@ buf_T *buflist_new(char *ffname_arg, char *sfname_arg, linenr_T lnum, int flags)
     // It's like this buffer is deleted.  Watch out for autocommands that
     // change curbuf!  If that happens, allocate a new buffer anyway.
     buf_freeall(buf, BFA_WIPE | BFA_DEL);
+    buflist_index_invalidate();
     if (buf != curbuf) {  // autocommands deleted the buffer!
       return NULL;
     }
@@ -1908,12 +1924,15 @@ buf_T *buflist_new(char *ffname_arg, char *sfname_arg, linenr_T lnum, int flags)
   if (flags & BLN_DUMMY) {
     buf->b_flags |= BF_DUMMY;
   }
+  buflist_index_update(buf);
   buf_clear_file(buf);
   clrallmarks(buf, 0);                  // clear marks
   fmarks_check_names(buf);              // check file marks for this file
   buf->b_p_bl = (flags & BLN_LISTED) ? true : false;    // init 'buflisted'
   kv_destroy(buf->update_channels);
   kv_init(buf->update_channels);
+  kv_destroy(buf->update_byte_channels);
+  kv_init(buf->update_byte_channels);
   kv_destroy(buf->update_callbacks);
   kv_init(buf->update_callbacks);
   if (!(flags & BLN_DUMMY)) {
@@ -1922,14 +1941,18 @@ buf_T *buflist_new(char *ffname_arg, char *sfname_arg, linenr_T lnum, int flags)
     // unexpectedly losing the empty buffer.
     bufref_T bufref;
     set_bufref(&bufref, buf);
-    if (apply_autocmds(EVENT_BUFNEW, NULL, NULL, false, buf)
-        && !bufref_valid(&bufref)) {
-      return NULL;
+    if (apply_autocmds(EVENT_BUFNEW, NULL, NULL, false, buf)) {
+      buflist_index_invalidate();
+      if (!bufref_valid(&bufref)) {
+        return NULL;
+      }
     }
     if ((flags & BLN_LISTED)
-        && apply_autocmds(EVENT_BUFADD, NULL, NULL, false, buf)
-        && !bufref_valid(&bufref)) {
-      return NULL;
+        && apply_autocmds(EVENT_BUFADD, NULL, NULL, false, buf)) {
+      buflist_index_invalidate();
+      if (!bufref_valid(&bufref)) {
+        return NULL;
+      }
     }
     if (aborting()) {
       // Autocmds may abort script processing.
@@ -2172,8 +2195,12 @@ buf_T *buflist_findname(char *ffname)
 ///
 /// @return  buffer or NULL if not found
 static buf_T *buflist_findname_file_id(char *ffname, FileID *file_id, bool file_id_valid)
-  FUNC_ATTR_PURE
 {
+  buf_T *found;
+  if (buflist_index_find(ffname, file_id, file_id_valid, &found)) {
+    return found;
+  }
+
   // Start at the last buffer, expect to find a match sooner.
   FOR_ALL_BUFFERS_BACKWARDS(buf) {
     if ((buf->b_flags & BF_DUMMY) == 0
@@ -2184,6 +2211,151 @@ static buf_T *buflist_findname_file_id(char *ffname, FileID *file_id, bool file_
   return NULL;
 }
 
+/// Start adding many buffers at once, e.g. for a long argument list.
+/// Until the matching buflist_index_end() buffers are looked up by name and
+/// file ID with a hash table instead of going over the whole buffer list for
+/// each new buffer, which takes quadratic time.
+void buflist_index_start(void)
+{
+  if (buflist_index_nest++ == 0) {
+    buflist_index_valid = false;
+  }
+}
+
+/// End of adding many buffers, see buflist_index_start().
+void buflist_index_end(void)
+{
+  if (--buflist_index_nest > 0) {
+    return;
+  }
+  buflist_index_clear();
+  map_destroy(cstr_t, &buflist_index_names);
+  map_destroy(uint64_t, &buflist_index_ids);
+  buflist_index_names = (Map(cstr_t, int)) MAP_INIT;
+  buflist_index_ids = (Map(uint64_t, uint64_t)) MAP_INIT;
+}
+
+static void buflist_index_clear(void)
+{
+  const char *name;
+  map_foreach_key(&buflist_index_names, name, {
+    xfree((char *)name);
+  });
+  map_clear(cstr_t, &buflist_index_names);
+  map_clear(uint64_t, &buflist_index_ids);
+  buflist_index_valid = false;
+}
+
+/// Makes the index be rebuilt on the next lookup.  Used after autocommands
+/// were executed, they may have renamed buffers.
+static void buflist_index_invalidate(void)
+{
+  buflist_index_valid = false;
+}
+
+static uint64_t buflist_index_id_key(const FileID *file_id)
+{
+  return file_id->inode ^ (file_id->device_id << 32 | file_id->device_id >> 32);
+}
+
+/// Add "buf" to the index, under its current name and file ID.
+static void buflist_index_update(buf_T *buf)
+{
+  if (!buflist_index_valid || (buf->b_flags & BF_DUMMY)) {
+    return;
+  }
+  // Like the search, prefer the buffer that comes last in the list.
+  if (buf->b_ffname != NULL) {
+    const char **key;
+    bool new_item = false;
+    int *fnum = map_put_ref(cstr_t, int)(&buflist_index_names, buf->b_ffname, &key, &new_item);
+    if (new_item) {
+      *key = xstrdup(buf->b_ffname);
+      *fnum = buf->b_fnum;
+    } else if (*fnum < buf->b_fnum || !buflist_index_has_name(*fnum, buf->b_ffname)) {
+      *fnum = buf->b_fnum;
+    }
+  }
+  if (buf->file_id_valid) {
+    uint64_t *fnum = map_put_ref(uint64_t, uint64_t)(&buflist_index_ids,
+                                                     buflist_index_id_key(&buf->file_id),
+                                                     NULL, NULL);
+    if (*fnum < (uint64_t)buf->b_fnum || !buflist_index_has_id((int)(*fnum), &buf->file_id)) {
+      *fnum = (uint64_t)buf->b_fnum;
+    }
+  }
+}
+
+static bool buflist_index_has_name(int fnum, const char *ffname)
+{
+  buf_T *buf = handle_get_buffer(fnum);
+  return buf != NULL && buf->b_ffname != NULL && path_fnamecmp(ffname, buf->b_ffname) == 0;
+}
+
+static bool buflist_index_has_id(int fnum, FileID *file_id)
+{
+  buf_T *buf = handle_get_buffer(fnum);
+  return buf != NULL && buf_same_file_id(buf, file_id);
+}
+
+/// Look up a buffer like buflist_findname_file_id() does, using the index.
+///
+/// @param[out] bufp  the found buffer or NULL
+///
+/// @return  false when the buffer list has to be searched instead.
+static bool buflist_index_find(char *ffname, FileID *file_id, bool file_id_valid, buf_T **bufp)
+{
+#ifdef BACKSLASH_IN_FILENAME
+  return false;
+#else
+  // With 'fileignorecase' names that differ in case match.
+  if (buflist_index_nest == 0 || p_fic) {
+    return false;
+  }
+  if (!buflist_index_valid) {
+    buflist_index_clear();
+    buflist_index_valid = true;
+    FOR_ALL_BUFFERS(buf) {
+      buflist_index_update(buf);
+    }
+  }
+
+  // A stale entry means the index is not complete, search the buffer list.
+  buf_T *by_name = NULL;
+  int fnum = map_get(cstr_t, int)(&buflist_index_names, ffname);
+  if (fnum != 0) {
+    if (!buflist_index_has_name(fnum, ffname)) {
+      return false;
+    }
+    by_name = handle_get_buffer(fnum);
+  }
+  buf_T *by_id = NULL;
+  if (file_id_valid) {
+    fnum = (int)map_get(uint64_t, uint64_t)(&buflist_index_ids, buflist_index_id_key(file_id));
+    if (fnum != 0) {
+      if (!buflist_index_has_id(fnum, file_id)) {
+        return false;
+      }
+      by_id = handle_get_buffer(fnum);
+      // Get the dev/ino again, like otherfile_buf() does.
+      buf_set_file_id(by_id);
+      if (!buf_same_file_id(by_id, file_id)) {
+        return false;
+      }
+    }
+  }
+
+  // The buffer list is in order of buffer numbers, the search would find the
+  // last one.
+  if (by_name != NULL && by_id != NULL) {
+    *bufp = by_name->b_fnum > by_id->b_fnum ? by_name : by_id;
+  } else {
+    *bufp = by_name != NULL ? by_name : by_id;
+  }
+  return true;
+#endif
+}
+
 /// Find file in buffer list by a regexp pattern.
 ///
 /// @param pattern_end  pointer to first char after pattern
@@ -2936,6 +3108,7 @@ int setfname(buf_T *buf, char *ffname_arg, char *sfname_arg, bool message)
     buf->file_id_valid = true;
     buf->file_id = file_id;
   }
+  buflist_index_update(buf);
 
   buf_name_changed(buf);
   return OK;
@@ -2960,6 +3133,7 @@ void buf_set_name(int fnum, char *name)
   // files on Win32.
   fname_expand(buf, &buf->b_ffname, &buf->b_sfname);
   buf->b_fname = buf->b_sfname;
+  buflist_index_update(buf);
 }
 
 /// Take care of what needs to be done when the name of buffer "buf" has changed.
@@ -3117,6 +3291,7 @@ void buf_set_file_id(buf_T *buf)
   } else {
     buf->file_id_valid = false;
   }
+  buflist_index_update(buf);
 }
 
 /// Check that file_id in buffer "buf" matches with "file_id".
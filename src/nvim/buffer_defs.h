@@ -336,6 +336,8 @@ typedef struct {
 #define SPO_NPBUFFER 0x2
   unsigned b_p_spo_flags;      // 'spelloptions' flags
   int b_cjk;                  // all CJK letters as OK
+  struct spellcache_S *b_spell_cache;  // cached spell_check() results, see
+                                       // spell_check_cached()
   uint8_t b_syn_chartab[32];  // syntax iskeyword option
   char *b_syn_isk;            // iskeyword option
 } synblock_T;
@@ -357,6 +359,19 @@ typedef struct {
 #define BUF_UPDATE_CALLBACKS_INIT { LUA_NOREF, LUA_NOREF, LUA_NOREF, \
                                     LUA_NOREF, LUA_NOREF, false, false }
 
+typedef kvec_t(uint64_t) ChannelIds;
+
+/// Marks overlapping the top row of a redraw, shared by all windows showing
+/// the buffer. See decor_redraw_start().
+typedef struct {
+  int row;                ///< row the overlap was computed for
+  uint64_t tick;          ///< b_marktree->tick when it was computed
+  kvec_t(MTPair) pairs;   ///< visible marks overlapping (row, 0)
+  MarkTreeIter itr[1];    ///< iterator at (row, 0) after the overlap scan
+} DecorOverlapCache;
+
+#define DECOR_OVERLAP_CACHE_SIZE 4
+
 EXTERN int curbuf_splice_pending INIT( = 0);
 
 #define BUF_HAS_QF_ENTRY 1
@@ -432,6 +447,8 @@ struct file_buffer {
   linenr_T b_mod_xlines;        // number of extra buffer lines inserted;
                                 // negative when lines were deleted
   wininfo_T *b_wininfo;         // list of last used info for each window
+  struct searchstat_index *b_search_stat;  // matches of the last search
+                                           // pattern, see search.c
   disptick_T b_mod_tick_syn;    // last display tick syntax was updated
   disptick_T b_mod_tick_decor;  // last display tick decoration providers
                                 // where invoked
@@ -498,6 +515,7 @@ struct file_buffer {
   colnr_T b_u_line_colnr;       // optional column number
 
   bool b_scanned;               // ^N/^P have scanned this buffer
+  struct compl_words_S *b_compl_words;  // words for ^N/^P, see insexpand.c
 
   // flags for use of ":lmap" and IM control
   OptInt b_p_iminsert;          // input mode for insert
@@ -723,10 +741,14 @@ struct file_buffer {
   size_t b_virt_line_blocks;    // number of virt_line blocks
   size_t b_signs;               // number of sign extmarks
   size_t b_signs_with_text;     // number of sign extmarks with text
+  DecorOverlapCache b_decor_overlap[DECOR_OVERLAP_CACHE_SIZE];
+  int b_decor_overlap_next;     // next b_decor_overlap entry to replace
 
   // array of channel_id:s which have asked to receive updates for this
   // buffer.
-  kvec_t(uint64_t) update_channels;
+  ChannelIds update_channels;
+  // channel_id:s which receive byte-level `nvim_buf_bytes_event` instead.
+  ChannelIds update_byte_channels;
   // array of lua callbacks for buffer updates.
   kvec_t(BufUpdateCallbacks) update_callbacks;
 
@@ -798,6 +820,11 @@ struct tabpage_S {
   buf_T *(tp_diffbuf[DB_COUNT]);
   int tp_diff_invalid;              ///< list of diffs is outdated
   int tp_diff_update;               ///< update diffs before redrawing
+  struct diffjob_S *tp_diff_job;    ///< diff being computed, see diff.c
+  bool tp_diff_incr;                ///< diffs can be updated for changed lines only
+  linenr_T tp_diff_top[DB_COUNT];   ///< first line changed since the diffs were
+                                    ///< updated, zero when unchanged
+  linenr_T tp_diff_bot[DB_COUNT];   ///< line below the changed lines
   frame_T *(tp_snapshot[SNAP_COUNT]);    ///< window layout snapshots
   ScopeDictDictItem tp_winvar;      ///< Variable for "t:" Dictionary.
   dict_T *tp_vars;         ///< Internal variables, local to tab page.
@@ -1047,6 +1074,8 @@ struct window_S {
 
   win_T *w_prev;              ///< link to previous window
   win_T *w_next;              ///< link to next window
+  tabpage_T *w_tabpage;       ///< tab page whose window list contains this
+                              ///< window, NULL when not in any list
   bool w_closing;                   ///< window is being closed, don't let
                                     ///< autocommands close it too.
 
@@ -1198,6 +1227,9 @@ struct window_S {
   int w_lines_valid;                // number of valid entries
   wline_T *w_lines;
 
+  struct plines_cache *w_plines_cache;  // cached heights of lines, see plines.c
+  struct vcol_index *w_vcol_index;  // cached virtual columns of a long line, see plines.c
+
   garray_T w_folds;                 // array of nested folds
   bool w_fold_manual;               // when true: some folds are opened/closed
                                     // manually
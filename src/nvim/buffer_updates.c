@@ -1,12 +1,14 @@
 #include <inttypes.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "klib/kvec.h"
 #include "lauxlib.h"
 #include "nvim/api/buffer.h"
 #include "nvim/api/private/defs.h"
 #include "nvim/api/private/helpers.h"
+#include "nvim/ascii.h"
 #include "nvim/assert.h"
 #include "nvim/buffer.h"
 #include "nvim/buffer_defs.h"
@@ -19,6 +21,7 @@
 #include "nvim/memory.h"
 #include "nvim/msgpack_rpc/channel.h"
 #include "nvim/pos.h"
+#include "nvim/strings.h"
 #include "nvim/types.h"
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
@@ -27,8 +30,10 @@
 
 // Register a channel. Return True if the channel was added, or already added.
 // Return False if the channel couldn't be added because the buffer is
-// unloaded.
-bool buf_updates_register(buf_T *buf, uint64_t channel_id, BufUpdateCallbacks cb, bool send_buffer)
+// unloaded. When "send_bytes" is set the channel receives
+// `nvim_buf_bytes_event` instead of `nvim_buf_lines_event` for changes.
+bool buf_updates_register(buf_T *buf, uint64_t channel_id, BufUpdateCallbacks cb, bool send_buffer,
+                          bool send_bytes)
 {
   // must fail if the buffer isn't loaded
   if (buf->b_ml.ml_mfp == NULL) {
@@ -51,9 +56,18 @@ bool buf_updates_register(buf_T *buf, uint64_t channel_id, BufUpdateCallbacks cb
       return true;
     }
   }
+  for (size_t i = 0; i < kv_size(buf->update_byte_channels); i++) {
+    if (kv_A(buf->update_byte_channels, i) == channel_id) {
+      return true;
+    }
+  }
 
   // append the channelid to the list
-  kv_push(buf->update_channels, channel_id);
+  if (send_bytes) {
+    kv_push(buf->update_byte_channels, channel_id);
+  } else {
+    kv_push(buf->update_channels, channel_id);
+  }
 
   if (send_buffer) {
     Array args = ARRAY_DICT_INIT;
@@ -78,7 +92,7 @@ bool buf_updates_register(buf_T *buf, uint64_t channel_id, BufUpdateCallbacks cb
       linedata.size = line_count;
       linedata.items = xcalloc(line_count, sizeof(Object));
 
-      buf_collect_lines(buf, line_count, 1, 0, true, &linedata, NULL, NULL);
+      buf_collect_lines(buf, line_count, 1, 0, true, &linedata, NULL, NULL, NULL);
     }
 
     args.items[4] = ARRAY_OBJ(linedata);
@@ -96,7 +110,8 @@ bool buf_updates_register(buf_T *buf, uint64_t channel_id, BufUpdateCallbacks cb
 bool buf_updates_active(buf_T *buf)
   FUNC_ATTR_PURE
 {
-  return kv_size(buf->update_channels) || kv_size(buf->update_callbacks);
+  return kv_size(buf->update_channels) || kv_size(buf->update_byte_channels)
+         || kv_size(buf->update_callbacks);
 }
 
 void buf_updates_send_end(buf_T *buf, uint64_t channelid)
@@ -106,11 +121,14 @@ void buf_updates_send_end(buf_T *buf, uint64_t channelid)
   rpc_send_event(channelid, "nvim_buf_detach_event", args);
 }
 
-void buf_updates_unregister(buf_T *buf, uint64_t channelid)
+/// Remove "channelid" from "ids".
+///
+/// @return true if it was found.
+static bool updates_remove_channel(ChannelIds *ids, uint64_t channelid)
 {
-  size_t size = kv_size(buf->update_channels);
+  size_t size = kv_size(*ids);
   if (!size) {
-    return;
+    return false;
   }
 
   // go through list backwards and remove the channel id each time it appears
@@ -118,12 +136,12 @@ void buf_updates_unregister(buf_T *buf, uint64_t channelid)
   size_t j = 0;
   size_t found = 0;
   for (size_t i = 0; i < size; i++) {
-    if (kv_A(buf->update_channels, i) == channelid) {
+    if (kv_A(*ids, i) == channelid) {
       found++;
     } else {
       // copy item backwards into prior slot if needed
       if (i != j) {
-        kv_A(buf->update_channels, j) = kv_A(buf->update_channels, i);
+        kv_A(*ids, j) = kv_A(*ids, i);
       }
       j++;
     }
@@ -131,21 +149,29 @@ void buf_updates_unregister(buf_T *buf, uint64_t channelid)
 
   if (found) {
     // remove X items from the end of the array
-    buf->update_channels.size -= found;
-
-    // make a new copy of the active array without the channelid in it
-    buf_updates_send_end(buf, channelid);
+    ids->size -= found;
 
     if (found == size) {
-      kv_destroy(buf->update_channels);
-      kv_init(buf->update_channels);
+      kv_destroy(*ids);
+      kv_init(*ids);
     }
   }
+  return found > 0;
+}
+
+void buf_updates_unregister(buf_T *buf, uint64_t channelid)
+{
+  bool found = updates_remove_channel(&buf->update_channels, channelid);
+  found |= updates_remove_channel(&buf->update_byte_channels, channelid);
+  if (found) {
+    buf_updates_send_end(buf, channelid);
+  }
 }
 
 void buf_free_callbacks(buf_T *buf)
 {
   kv_destroy(buf->update_channels);
+  kv_destroy(buf->update_byte_channels);
   for (size_t i = 0; i < kv_size(buf->update_callbacks); i++) {
     buffer_update_callbacks_free(kv_A(buf->update_callbacks, i));
   }
@@ -162,6 +188,14 @@ void buf_updates_unload(buf_T *buf, bool can_reload)
     kv_destroy(buf->update_channels);
     kv_init(buf->update_channels);
   }
+  size = kv_size(buf->update_byte_channels);
+  if (size) {
+    for (size_t i = 0; i < size; i++) {
+      buf_updates_send_end(buf, kv_A(buf->update_byte_channels, i));
+    }
+    kv_destroy(buf->update_byte_channels);
+    kv_init(buf->update_byte_channels);
+  }
 
   size_t j = 0;
   for (size_t i = 0; i < kv_size(buf->update_callbacks); i++) {
@@ -220,10 +254,8 @@ void buf_updates_send_changes(buf_T *buf, linenr_T firstline, int64_t num_added,
   // if one the channels doesn't work, put its ID here so we can remove it later
   uint64_t badchannelid = 0;
 
-  // notify each of the active channels
-  for (size_t i = 0; i < kv_size(buf->update_channels); i++) {
-    uint64_t channelid = kv_A(buf->update_channels, i);
-
+  // notify all the active channels, with the event serialized only once
+  if (kv_size(buf->update_channels) > 0) {
     // send through the changes now channel contents now
     Array args = ARRAY_DICT_INIT;
     args.size = 6;
@@ -248,16 +280,13 @@ void buf_updates_send_changes(buf_T *buf, linenr_T firstline, int64_t num_added,
       linedata.size = (size_t)num_added;
       linedata.items = xcalloc((size_t)num_added, sizeof(Object));
       buf_collect_lines(buf, (size_t)num_added, firstline, 0, true, &linedata,
-                        NULL, NULL);
+                        NULL, NULL, NULL);
     }
     args.items[4] = ARRAY_OBJ(linedata);
     args.items[5] = BOOLEAN_OBJ(false);
-    if (!rpc_send_event(channelid, "nvim_buf_lines_event", args)) {
-      // We can't unregister the channel while we're iterating over the
-      // update_channels array, so we remember its ID to unregister it at
-      // the end.
-      badchannelid = channelid;
-    }
+    badchannelid = rpc_send_event_multi(buf->update_channels.items,
+                                        kv_size(buf->update_channels),
+                                        "nvim_buf_lines_event", args);
     api_free_array(args);  // TODO(bfredl): no
   }
 
@@ -320,6 +349,62 @@ void buf_updates_send_changes(buf_T *buf, linenr_T firstline, int64_t num_added,
   kv_size(buf->update_callbacks) = j;
 }
 
+/// Send a splice to the channels attached with "bytes". Only the inserted
+/// text is included, so a one character edit in a long line stays small.
+static void buf_updates_send_bytes(buf_T *buf, int start_row, colnr_T start_col,
+                                   bcount_t start_byte, int old_row, colnr_T old_col,
+                                   bcount_t old_byte, int new_row, colnr_T new_col,
+                                   bcount_t new_byte)
+{
+  Array text = ARRAY_DICT_INIT;
+  if (new_byte > 0) {
+    linenr_T lnum = start_row + 1;
+    if (lnum + new_row > buf->b_ml.ml_line_count) {
+      // The splice describes text that isn't in the buffer (yet): let the
+      // clients resync from a full update instead of sending garbage.
+      return;
+    }
+    for (int i = 0; i <= new_row; i++) {
+      char *line = ml_get_buf(buf, lnum + i);
+      size_t len = strlen(line);
+      size_t col = i == 0 ? (size_t)start_col : 0;
+      size_t end = i < new_row ? len : (size_t)new_col + (new_row == 0 ? col : 0);
+      col = MIN(col, len);
+      end = MIN(MAX(end, col), len);
+      String s = cbuf_to_string(line + col, end - col);
+      // NL in the buffer is NUL in the text
+      memchrsub(s.data, NUL, NL, s.size);
+      ADD(text, STRING_OBJ(s));
+    }
+  } else {
+    ADD(text, STRING_OBJ(STRING_INIT));
+  }
+
+  MAXSIZE_TEMP_ARRAY(args, 12);
+  ADD_C(args, BUFFER_OBJ(buf->handle));
+  ADD_C(args, INTEGER_OBJ(buf_get_changedtick(buf)));
+  ADD_C(args, INTEGER_OBJ(start_row));
+  ADD_C(args, INTEGER_OBJ(start_col));
+  ADD_C(args, INTEGER_OBJ(start_byte));
+  ADD_C(args, INTEGER_OBJ(old_row));
+  ADD_C(args, INTEGER_OBJ(old_col));
+  ADD_C(args, INTEGER_OBJ(old_byte));
+  ADD_C(args, INTEGER_OBJ(new_row));
+  ADD_C(args, INTEGER_OBJ(new_col));
+  ADD_C(args, INTEGER_OBJ(new_byte));
+  ADD_C(args, ARRAY_OBJ(text));
+
+  uint64_t badchannelid = rpc_send_event_multi(buf->update_byte_channels.items,
+                                               kv_size(buf->update_byte_channels),
+                                               "nvim_buf_bytes_event", args);
+  api_free_array(text);
+
+  if (badchannelid != 0) {
+    ELOG("Disabling buffer updates for dead channel %" PRIu64, badchannelid);
+    buf_updates_unregister(buf, badchannelid);
+  }
+}
+
 void buf_updates_send_splice(buf_T *buf, int start_row, colnr_T start_col, bcount_t start_byte,
                              int old_row, colnr_T old_col, bcount_t old_byte, int new_row,
                              colnr_T new_col, bcount_t new_byte)
@@ -329,6 +414,11 @@ void buf_updates_send_splice(buf_T *buf, int start_row, colnr_T start_col, bcoun
     return;
   }
 
+  if (kv_size(buf->update_byte_channels) > 0 && (!cmdpreview || buf != curbuf)) {
+    buf_updates_send_bytes(buf, start_row, start_col, start_byte, old_row, old_col, old_byte,
+                           new_row, new_col, new_byte);
+  }
+
   // notify each of the active callbacks
   size_t j = 0;
   for (size_t i = 0; i < kv_size(buf->update_callbacks); i++) {
@@ -376,6 +466,9 @@ void buf_updates_changedtick(buf_T *buf)
     uint64_t channel_id = kv_A(buf->update_channels, i);
     buf_updates_changedtick_single(buf, channel_id);
   }
+  for (size_t i = 0; i < kv_size(buf->update_byte_channels); i++) {
+    buf_updates_changedtick_single(buf, kv_A(buf->update_byte_channels, i));
+  }
   size_t j = 0;
   for (size_t i = 0; i < kv_size(buf->update_callbacks); i++) {
     BufUpdateCallbacks cb = kv_A(buf->update_callbacks, i);
@@ -1525,23 +1525,30 @@ restore_backup:
     char *s = buffer;
     int len = 0;
     for (lnum = start; lnum <= end; lnum++) {
-      // The next while loop is done once for each character written.
-      // Keep it fast!
-      char *ptr = ml_get_buf(buf, lnum) - 1;
+      char *ptr = ml_get_buf(buf, lnum);
+      size_t linelen = strlen(ptr);
       if (write_undo_file) {
-        sha256_update(&sha_ctx, (uint8_t *)ptr + 1, (uint32_t)(strlen(ptr + 1) + 1));
+        sha256_update(&sha_ctx, (uint8_t *)ptr, (uint32_t)(linelen + 1));
       }
-      char c;
-      while ((c = *++ptr) != NUL) {
-        if (c == NL) {
-          *s = NUL;                       // replace newlines with NULs
-        } else if (c == CAR && fileformat == EOL_MAC) {
-          *s = NL;                        // Mac: replace CRs with NLs
-        } else {
-          *s = c;
+      // Copy as much of the line as fits in the buffer at once, then fix up
+      // the copied part.  Keep it fast!
+      while (linelen > 0) {
+        const size_t n = MIN(linelen, (size_t)(bufsize - len));
+        memcpy(s, ptr, n);
+        char *const s_end = s + n;
+        for (char *p = s; (p = memchr(p, NL, (size_t)(s_end - p))) != NULL; p++) {
+          *p = NUL;                       // replace newlines with NULs
+        }
+        if (fileformat == EOL_MAC) {
+          for (char *p = s; (p = memchr(p, CAR, (size_t)(s_end - p))) != NULL; p++) {
+            *p = NL;                      // Mac: replace CRs with NLs
+          }
         }
-        s++;
-        if (++len != bufsize) {
+        s = s_end;
+        ptr += n;
+        linelen -= n;
+        len += (int)n;
+        if (len != bufsize) {
           continue;
         }
         if (buf_write_bytes(&write_info) == FAIL) {
@@ -162,12 +162,15 @@ static void changed_common(buf_T *buf, linenr_T lnum, colnr_T col, linenr_T lnum
 {
   // mark the buffer as modified
   changed(buf);
+  search_stat_changed(buf, lnum, lnume, xtra);
+  plines_cache_changed(buf, lnum, lnume, xtra);
 
   FOR_ALL_WINDOWS_IN_TAB(win, curtab) {
     if (win->w_buffer == buf && win->w_p_diff && diff_internal()) {
       curtab->tp_diff_update = true;
     }
   }
+  diff_lines_changed(buf, lnum, lnume, xtra);
 
   // set the '. mark
   if ((cmdmod.cmod_flags & CMOD_KEEPJUMPS) == 0) {
@@ -686,7 +689,6 @@ void ins_char_bytes(char *buf, size_t charlen)
   size_t col = (size_t)curwin->w_cursor.col;
   linenr_T lnum = curwin->w_cursor.lnum;
   char *oldp = ml_get(lnum);
-  size_t linelen = strlen(oldp) + 1;  // length of old line including NUL
 
   // The lengths default to the values for when not replacing.
   size_t oldlen = 0;        // nr of bytes inserted
@@ -737,17 +739,11 @@ void ins_char_bytes(char *buf, size_t charlen)
     }
   }
 
-  char *newp = xmalloc(linelen + newlen - oldlen);
-
-  // Copy bytes before the cursor.
-  if (col > 0) {
-    memmove(newp, oldp, col);
-  }
-
-  // Copy bytes after the changed character(s).
-  char *p = newp + col;
-  if (linelen > col + oldlen) {
-    memmove(p + newlen, oldp + col + oldlen, linelen - col - oldlen);
+  // Replace the line in the buffer, this moves the bytes after the changed
+  // character(s).
+  char *p = ml_replace_bytes(lnum, (colnr_T)col, oldlen, newlen);
+  if (p == NULL) {
+    return;
   }
 
   // Insert or overwrite the new character.
@@ -758,9 +754,6 @@ void ins_char_bytes(char *buf, size_t charlen)
     p[i] = ' ';
   }
 
-  // Replace the line in the buffer.
-  ml_replace(lnum, newp, false);
-
   // mark the buffer as changed and prepare for displaying
   inserted_bytes(lnum, (colnr_T)col, (int)oldlen, (int)newlen);
 
@@ -792,18 +785,11 @@ void ins_str(char *s)
   }
 
   colnr_T col = curwin->w_cursor.col;
-  char *oldp = ml_get(lnum);
-  int oldlen = (int)strlen(oldp);
-
-  char *newp = xmalloc((size_t)oldlen + (size_t)newlen + 1);
-  if (col > 0) {
-    memmove(newp, oldp, (size_t)col);
+  char *p = ml_replace_bytes(lnum, col, 0, (size_t)newlen);
+  if (p == NULL) {
+    return;
   }
-  memmove(newp + col, s, (size_t)newlen);
-  int bytes = oldlen - col + 1;
-  assert(bytes >= 0);
-  memmove(newp + col + newlen, oldp + col, (size_t)bytes);
-  ml_replace(lnum, newp, false);
+  memmove(p, s, (size_t)newlen);
   inserted_bytes(lnum, col, 0, newlen);
   curwin->w_cursor.col += newlen;
 }
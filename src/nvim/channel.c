@@ -6,10 +6,12 @@
 
 #include "klib/kvec.h"
 #include "lauxlib.h"
+#include "nvim/api/buffer.h"
 #include "nvim/api/private/converter.h"
 #include "nvim/api/private/defs.h"
 #include "nvim/api/private/helpers.h"
 #include "nvim/autocmd.h"
+#include "nvim/buffer.h"
 #include "nvim/buffer_defs.h"
 #include "nvim/channel.h"
 #include "nvim/eval.h"
@@ -690,7 +692,12 @@ static void on_channel_event(void **args)
 
 void channel_reader_callbacks(Channel *chan, CallbackReader *reader)
 {
-  if (reader->buffered) {
+  if (reader->bufnr != 0) {
+    if (!reader->buffered || reader->eof) {
+      channel_buffer_append(chan, reader);
+    }
+    reader->eof = false;
+  } else if (reader->buffered) {
     if (reader->eof) {
       if (reader->self) {
         if (tv_dict_find(reader->self, reader->type, -1) == NULL) {
@@ -719,6 +726,56 @@ void channel_reader_callbacks(Channel *chan, CallbackReader *reader)
   }
 }
 
+/// Append the lines read by "reader" to its buffer. An incomplete last line
+/// is kept until more data arrives or the stream is closed.
+static void channel_buffer_append(Channel *chan, CallbackReader *reader)
+{
+  char *data = reader->buffer.ga_data;
+  size_t len = (size_t)reader->buffer.ga_len;
+  if (!reader->eof) {
+    char *nl = len > 0 ? xmemrchr(data, NL, len) : NULL;
+    len = nl ? (size_t)(nl - data) + 1 : 0;
+  }
+  if (len == 0) {
+    return;
+  }
+
+  buf_T *buf = handle_get_buffer(reader->bufnr);
+  if (buf != NULL) {
+    Array lines = ARRAY_DICT_INIT;
+    for (char *p = data; p < data + len;) {
+      char *nl = memchr(p, NL, (size_t)(data + len - p));
+      char *line_end = nl ? nl : data + len;
+      ADD(lines, STRING_OBJ(cbuf_as_string(p, (size_t)(line_end - p))));
+      p = line_end + 1;
+    }
+
+    // An empty buffer gets the lines instead of its empty line.
+    buf_ensure_loaded(buf);
+    Integer start = (buf->b_ml.ml_flags & ML_EMPTY) ? 0 : -1;
+    Error err = ERROR_INIT;
+    nvim_buf_set_lines(chan->id, reader->bufnr, start, -1, false, lines, &err);
+    xfree(lines.items);
+    if (ERROR_SET(&err)) {
+      semsg(_("Error appending %s of channel %" PRIu64 " to buffer %d: %s"),
+            reader->type, chan->id, reader->bufnr, err.msg);
+      api_clear_error(&err);
+      buf = NULL;
+    }
+  }
+
+  if (buf == NULL) {
+    // Buffer is gone or can't be changed, drop the rest of the output.
+    reader->bufnr = 0;
+    ga_clear(&reader->buffer);
+    return;
+  }
+
+  size_t rest = (size_t)reader->buffer.ga_len - len;
+  memmove(data, data + len, rest);
+  reader->buffer.ga_len = (int)rest;
+}
+
 static void channel_process_exit_cb(Process *proc, int status, void *data)
 {
   Channel *chan = data;
@@ -60,6 +60,7 @@ typedef struct {
 typedef struct {
   Callback cb;
   dict_T *self;
+  handle_T bufnr;  ///< buffer to append the lines to instead, 0 for none
   garray_T buffer;
   bool eof;
   bool buffered;
@@ -69,13 +70,14 @@ typedef struct {
 
 #define CALLBACK_READER_INIT ((CallbackReader){ .cb = CALLBACK_NONE, \
                                                 .self = NULL, \
+                                                .bufnr = 0, \
                                                 .buffer = GA_EMPTY_INIT_VALUE, \
                                                 .buffered = false, \
                                                 .fwd_err = false, \
                                                 .type = NULL })
 static inline bool callback_reader_set(CallbackReader reader)
 {
-  return reader.cb.type != kCallbackNone || reader.self;
+  return reader.cb.type != kCallbackNone || reader.self || reader.bufnr != 0;
 }
 
 struct Channel {
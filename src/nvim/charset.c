@@ -685,6 +685,35 @@ int byte2cells(int b)
   return g_chartab[b] & CT_CELL_MASK;
 }
 
+/// Return the number of bytes at the start of "p", before "end", that are
+/// printable ASCII characters.  These always take one cell, 'isprint' and
+/// 'display' only change the other characters.  Looks at eight bytes at a
+/// time, for long lines.
+size_t ascii_printable_len(const char *p, const char *end)
+  FUNC_ATTR_PURE FUNC_ATTR_NONNULL_ALL
+{
+#define ONES 0x0101010101010101ULL
+#define HIGHS 0x8080808080808080ULL
+  const char *s = p;
+  while (end - s >= 8) {
+    uint64_t w;
+    memcpy(&w, s, sizeof(w));
+    // Without any byte >= 0x80 these find any byte below ' ' and any DEL.
+    uint64_t low = (w - ONES * ' ') & ~w & HIGHS;
+    uint64_t del = ((w ^ (ONES * 0x7f)) - ONES) & ~(w ^ (ONES * 0x7f)) & HIGHS;
+    if ((w & HIGHS) | low | del) {
+      break;
+    }
+    s += 8;
+  }
+#undef ONES
+#undef HIGHS
+  while (s < end && (uint8_t)(*s) >= ' ' && (uint8_t)(*s) < 0x7f) {
+    s++;
+  }
+  return (size_t)(s - p);
+}
+
 /// Return number of display cells occupied by character "c".
 ///
 /// "c" can be a special key (negative number) in which case 3 or 4 is returned.
@@ -81,6 +81,17 @@ static int compl_match_arraysize;
 static int compl_startcol;
 static int compl_selected;
 
+/// Last file name expansion while editing the command line.  When more
+/// characters are typed its matches are narrowed instead of expanding the
+/// pattern again, which may walk a large directory tree for "**".
+static struct {
+  int context;     ///< xp_context of the expansion
+  int flags;       ///< EW_ flags of the expansion
+  char *pat;       ///< expanded pattern, NULL when not set
+  int num_matches;
+  char **matches;
+} files_cache = { .pat = NULL };
+
 #define SHOW_MATCH(m) (showtail ? showmatches_gettail(matches[m], false) : matches[m])
 
 /// Returns true if fuzzy completion is supported for a given cmdline completion
@@ -2442,6 +2453,109 @@ int expand_cmdline(expand_T *xp, const char *str, int col, int *matchcount, char
 }
 
 /// Expand file or directory names.
+/// Return true for a character that has no special meaning in a file pattern.
+static bool files_cache_plain_char(int c)
+{
+  return ASCII_ISALNUM(c) || c == '_' || c == '-' || c == '.';
+}
+
+/// Remember the file name matches for "pat", to be narrowed by
+/// expand_files_narrow().
+static void expand_files_cache_set(const expand_T *xp, const char *pat, int flags, char **matches,
+                                   int num_matches)
+{
+  cmdexpand_cache_clear();
+  if (!(State & MODE_CMDLINE) || num_matches == 0 || (flags & EW_NOTFOUND)) {
+    return;
+  }
+  files_cache.context = xp->xp_context;
+  files_cache.flags = flags;
+  files_cache.pat = xstrdup(pat);
+  files_cache.num_matches = num_matches;
+  files_cache.matches = xmalloc(sizeof(char *) * (size_t)num_matches);
+  for (int i = 0; i < num_matches; i++) {
+    files_cache.matches[i] = xstrdup(matches[i]);
+  }
+}
+
+/// Forget the file name matches remembered for the command line.
+void cmdexpand_cache_clear(void)
+{
+  if (files_cache.pat != NULL) {
+    XFREE_CLEAR(files_cache.pat);
+    FreeWild(files_cache.num_matches, files_cache.matches);
+    files_cache.matches = NULL;
+    files_cache.num_matches = 0;
+  }
+}
+
+/// When "pat" is the pattern of the last file name expansion with more
+/// characters typed before the trailing "*", and the last path component is
+/// a plain name, get the matches from the last expansion whose name starts
+/// with that component.  The order of the matches is kept, thus they are
+/// still sorted and 'wildignore' and 'suffixes' still apply.
+///
+/// @return  true when "matches" and "numMatches" were set.
+static bool expand_files_narrow(const expand_T *xp, const char *pat, int flags,
+                                char ***matches, int *numMatches)
+{
+  if (files_cache.pat == NULL || !(State & MODE_CMDLINE)
+      || files_cache.context != xp->xp_context || files_cache.flags != flags
+      || (xp->xp_context != EXPAND_FILES && xp->xp_context != EXPAND_DIRECTORIES)) {
+    return false;
+  }
+
+  const size_t cache_len = strlen(files_cache.pat);
+  const size_t len = strlen(pat);
+  if (len <= cache_len || pat[len - 1] != '*' || files_cache.pat[cache_len - 1] != '*'
+      || strncmp(pat, files_cache.pat, cache_len - 1) != 0) {
+    return false;
+  }
+
+  // The last component must be a plain name, also for the last expansion.
+  const char *name = pat + len - 1;
+  while (name > pat && files_cache_plain_char((uint8_t)name[-1])) {
+    name--;
+  }
+  // A "*" doesn't match a leading dot, the name can't start with one.
+  if ((name > pat && !vim_ispathsep(name[-1])) || (size_t)(name - pat) >= cache_len - 1
+      || *name == '.') {
+    return false;
+  }
+  const size_t name_len = (size_t)(pat + len - 1 - name);
+  const bool ic = p_fic || (flags & EW_ICASE);
+
+  char **narrowed = xmalloc(sizeof(char *) * (size_t)files_cache.num_matches);
+  int count = 0;
+  for (int i = 0; i < files_cache.num_matches; i++) {
+    char *match = files_cache.matches[i];
+    size_t match_len = strlen(match);
+    if (match_len > 0 && after_pathsep(match, match + match_len)) {
+      match_len--;  // directory with a trailing slash
+    }
+    const char *tail = match;
+    for (const char *p = match; p < match + match_len; p += utfc_ptr2len(p)) {
+      if (vim_ispathsep(*p)) {
+        tail = p + 1;
+      }
+    }
+    if ((size_t)(match + match_len - tail) >= name_len
+        && (ic ? STRNICMP(tail, name, name_len) : strncmp(tail, name, name_len)) == 0) {
+      narrowed[count++] = xstrdup(match);
+    }
+  }
+  if (count == 0) {
+    // Expanding may give the pattern itself or an error.
+    xfree(narrowed);
+    return false;
+  }
+
+  *matches = narrowed;
+  *numMatches = count;
+  expand_files_cache_set(xp, pat, flags, narrowed, count);
+  return true;
+}
+
 static int expand_files_and_dirs(expand_T *xp, char *pat, char ***matches, int *numMatches,
                                  int flags, int options)
 {
@@ -2486,8 +2600,16 @@ static int expand_files_and_dirs(expand_T *xp, char *pat, char ***matches, int *
     flags |= EW_ICASE;
   }
 
-  // Expand wildcards, supporting %:h and the like.
-  int ret = expand_wildcards_eval(&pat, numMatches, matches, flags);
+  int ret;
+  if (expand_files_narrow(xp, pat, flags, matches, numMatches)) {
+    ret = OK;
+  } else {
+    // Expand wildcards, supporting %:h and the like.
+    ret = expand_wildcards_eval(&pat, numMatches, matches, flags);
+    if (ret == OK) {
+      expand_files_cache_set(xp, pat, flags, *matches, *numMatches);
+    }
+  }
   if (free_pat) {
     xfree(pat);
   }
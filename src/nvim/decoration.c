@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <limits.h>
+#include <string.h>
 
 #include "nvim/buffer.h"
 #include "nvim/decoration.h"
@@ -8,6 +9,7 @@
 #include "nvim/fold.h"
 #include "nvim/highlight.h"
 #include "nvim/highlight_group.h"
+#include "nvim/mbyte.h"
 #include "nvim/memory.h"
 #include "nvim/move.h"
 #include "nvim/pos.h"
@@ -251,6 +253,69 @@ bool decor_virt_pos(const Decoration *const decor)
   return kv_size(decor->virt_text) || decor->ui_watched;
 }
 
+/// Update the cached width of the virtual text of all marks, after the width
+/// of characters changed ('ambiwidth', 'emoji' or |setcellwidths()|).
+void decor_update_virt_text_width(void)
+{
+  FOR_ALL_BUFFERS(buf) {
+    if (!map_size(buf->b_extmark_ns)) {
+      continue;
+    }
+
+    MarkTreeIter itr[1];
+    marktree_itr_get(buf->b_marktree, 0, 0, itr);
+    while (true) {
+      MTKey mark = marktree_itr_current(itr);
+      if (mark.pos.row < 0) {
+        break;
+      }
+      Decoration *decor = mark.decor_full;
+      if (decor && !mt_end(mark) && kv_size(decor->virt_text)) {
+        int width = 0;
+        for (size_t i = 0; i < kv_size(decor->virt_text); i++) {
+          char *text = kv_A(decor->virt_text, i).text;
+          if (text) {
+            width += (int)mb_string2cells(text);
+          }
+        }
+        decor->virt_text_width = width;
+      }
+      marktree_itr_next(buf->b_marktree, itr);
+    }
+  }
+}
+
+/// Find the cached overlap of `row`, or an entry to compute it into.
+///
+/// Windows showing the same buffer at the same top row, and redraws where no
+/// mark changed, can then skip the overlap scan of the marktree.
+static DecorOverlapCache *decor_overlap_cache(buf_T *buf, int row, bool *hit)
+{
+  for (int i = 0; i < DECOR_OVERLAP_CACHE_SIZE; i++) {
+    DecorOverlapCache *cache = &buf->b_decor_overlap[i];
+    if (cache->row == row && cache->tick == buf->b_marktree->tick) {
+      *hit = true;
+      return cache;
+    }
+  }
+
+  DecorOverlapCache *cache = &buf->b_decor_overlap[buf->b_decor_overlap_next];
+  buf->b_decor_overlap_next = (buf->b_decor_overlap_next + 1) % DECOR_OVERLAP_CACHE_SIZE;
+  cache->row = row;
+  cache->tick = buf->b_marktree->tick;
+  kv_size(cache->pairs) = 0;
+  *hit = false;
+  return cache;
+}
+
+void decor_overlap_cache_free(buf_T *buf)
+{
+  for (int i = 0; i < DECOR_OVERLAP_CACHE_SIZE; i++) {
+    kv_destroy(buf->b_decor_overlap[i].pairs);
+  }
+  memset(buf->b_decor_overlap, 0, sizeof(buf->b_decor_overlap));
+}
+
 bool decor_redraw_start(win_T *wp, int top_row, DecorState *state)
 {
   buf_T *buf = wp->w_buffer;
@@ -258,13 +323,26 @@ bool decor_redraw_start(win_T *wp, int top_row, DecorState *state)
   if (!marktree_itr_get_overlap(buf->b_marktree, top_row, 0, state->itr)) {
     return false;
   }
-  MTPair pair;
 
-  while (marktree_itr_step_overlap(buf->b_marktree, state->itr, &pair)) {
-    if (mt_invalid(pair.start) || marktree_decor_level(pair.start) < kDecorLevelVisible) {
-      continue;
+  // The tree is not empty, thus its tick is never zero and a zeroed cache
+  // entry can't match.
+  bool hit;
+  DecorOverlapCache *cache = decor_overlap_cache(buf, top_row, &hit);
+  if (hit) {
+    *state->itr = *cache->itr;
+  } else {
+    MTPair pair;
+    while (marktree_itr_step_overlap(buf->b_marktree, state->itr, &pair)) {
+      if (mt_invalid(pair.start) || marktree_decor_level(pair.start) < kDecorLevelVisible) {
+        continue;
+      }
+      kv_push(cache->pairs, pair);
     }
+    *cache->itr = *state->itr;
+  }
 
+  for (size_t i = 0; i < kv_size(cache->pairs); i++) {
+    MTPair pair = kv_A(cache->pairs, i);
     Decoration decor = get_decor(pair.start);
 
     decor_push(state, pair.start.pos.row, pair.start.pos.col, pair.end_pos.row, pair.end_pos.col,
@@ -497,6 +575,10 @@ void decor_redraw_signs(win_T *wp, buf_T *buf, int row, SignTextAttrs sattrs[],
 
 // Get the maximum required amount of sign columns needed between row and
 // end_row.
+//
+// Only the marks in the region are visited, not every line of it, so this is
+// cheap for large buffers with few signs. The count of a line can only grow
+// at a mark start, thus lines without marks need not be checked.
 int decor_signcols(buf_T *buf, int row, int end_row, int max)
 {
   if (max <= 1 && buf->b_signs_with_text >= (size_t)max) {
@@ -507,43 +589,67 @@ int decor_signcols(buf_T *buf, int row, int end_row, int max)
     return 0;
   }
 
-  int signcols = 0;  // highest value of count
-  for (int currow = row; currow <= end_row; currow++) {
-    MarkTreeIter itr[1];
-    if (!marktree_itr_get_overlap(buf->b_marktree, currow, 0, itr)) {
-      continue;
+  MarkTreeIter itr[1];
+  if (!marktree_itr_get_overlap(buf->b_marktree, row, 0, itr)) {
+    return 0;
+  }
+
+  // end rows of the (ranged) signs covering currow
+  kvec_withinit_t(int, 16) ranges;
+  kvi_init(ranges);
+
+  MTPair pair;
+  while (marktree_itr_step_overlap(buf->b_marktree, itr, &pair)) {
+    if (!mt_invalid(pair.start) && pair.start.decor_full && pair.start.decor_full->sign_text) {
+      kvi_push(ranges, pair.end_pos.row);
     }
+  }
 
-    int count = 0;
-    MTPair pair;
-    while (marktree_itr_step_overlap(buf->b_marktree, itr, &pair)) {
-      if (!mt_invalid(pair.start) && pair.start.decor_full && pair.start.decor_full->sign_text) {
-        count++;
+  int signcols = 0;  // highest value of count
+  int currow = row;
+  int count = (int)kv_size(ranges);  // signs on currow
+  while (true) {
+    MTKey mark = marktree_itr_current(itr);
+    if (mark.pos.row < 0 || mark.pos.row > currow) {
+      if (count > signcols) {
+        if (row != end_row) {
+          buf->b_signcols.sentinel = currow + 1;
+        }
+        if (count >= max) {
+          signcols = max;
+          break;
+        }
+        signcols = count;
       }
-    }
 
-    while (itr->x) {
-      MTKey mark = marktree_itr_current(itr);
-      if (mark.pos.row != currow) {
+      if (mark.pos.row < 0 || mark.pos.row > end_row) {
         break;
       }
-      if (!mt_invalid(mark) && !mt_end(mark) && mark.decor_full && mark.decor_full->sign_text) {
-        count++;
+
+      currow = mark.pos.row;
+      size_t j = 0;
+      for (size_t i = 0; i < kv_size(ranges); i++) {
+        if (kv_A(ranges, i) >= currow) {
+          kv_A(ranges, j++) = kv_A(ranges, i);
+        }
       }
-      marktree_itr_next(buf->b_marktree, itr);
+      kv_size(ranges) = j;
+      count = (int)j;
     }
 
-    if (count > signcols) {
-      if (row != end_row) {
-        buf->b_signcols.sentinel = currow + 1;
-      }
-      if (count >= max) {
-        return max;
+    if (!mt_invalid(mark) && !mt_end(mark) && mark.decor_full && mark.decor_full->sign_text) {
+      count++;
+      if (mt_paired(mark)) {
+        MTPos endpos = marktree_get_altpos(buf->b_marktree, mark, NULL);
+        if (endpos.row > currow) {
+          kvi_push(ranges, endpos.row);
+        }
       }
-      signcols = count;
     }
+    marktree_itr_next(buf->b_marktree, itr);
   }
 
+  kvi_destroy(ranges);
   return signcols;
 }
 
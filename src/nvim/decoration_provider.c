@@ -21,7 +21,7 @@ static kvec_t(DecorProvider) decor_providers = KV_INITIAL_VALUE;
 #define DECORATION_PROVIDER_INIT(ns_id) (DecorProvider) \
   { ns_id, false, LUA_NOREF, LUA_NOREF, \
     LUA_NOREF, LUA_NOREF, LUA_NOREF, \
-    LUA_NOREF, -1, false, false, 0 }
+    LUA_NOREF, LUA_NOREF, -1, false, false, 0 }
 
 static void decor_provider_error(DecorProvider *provider, const char *name, const char *msg)
 {
@@ -111,8 +111,8 @@ void decor_providers_start(DecorProviders *providers)
   }
 }
 
-/// For each provider run 'win'. If result is not false, then collect the
-/// 'on_line' callback to call inside win_line
+/// For each provider run 'win' and then 'range' for the visible rows. If no
+/// result is false, then collect the 'on_line' callback to call inside win_line
 ///
 /// @param      wp             Window
 /// @param      providers      Decoration providers
@@ -130,17 +130,41 @@ void decor_providers_invoke_win(win_T *wp, DecorProviders *providers,
 
   for (size_t k = 0; k < kv_size(*providers); k++) {
     DecorProvider *p = kv_A(*providers, k);
-    if (p && p->redraw_win != LUA_NOREF) {
+    if (!p || (p->redraw_win == LUA_NOREF && p->redraw_range == LUA_NOREF)) {
+      continue;
+    }
+
+    if (p->redraw_win != LUA_NOREF) {
       MAXSIZE_TEMP_ARRAY(args, 4);
       ADD_C(args, WINDOW_OBJ(wp->handle));
       ADD_C(args, BUFFER_OBJ(wp->w_buffer->handle));
       // TODO(bfredl): we are not using this, but should be first drawn line?
       ADD_C(args, INTEGER_OBJ(wp->w_topline - 1));
       ADD_C(args, INTEGER_OBJ(knownmax - 1));
-      if (decor_provider_invoke(p, "win", p->redraw_win, args, true)) {
-        kvi_push(*line_providers, p);
+      if (!decor_provider_invoke(p, "win", p->redraw_win, args, true)) {
+        continue;
       }
     }
+
+    // emitting the ephemeral marks of all visible rows in one call is much
+    // cheaper than doing it in 'line', which is called for each row
+    if (p->redraw_range != LUA_NOREF) {
+      MAXSIZE_TEMP_ARRAY(args, 4);
+      ADD_C(args, WINDOW_OBJ(wp->handle));
+      ADD_C(args, BUFFER_OBJ(wp->w_buffer->handle));
+      ADD_C(args, INTEGER_OBJ(wp->w_topline - 1));
+      ADD_C(args, INTEGER_OBJ(knownmax - 1));
+      decor_state.running_on_lines = true;
+      bool active = decor_provider_invoke(p, "range", p->redraw_range, args, true);
+      decor_state.running_on_lines = false;
+      hl_check_ns();
+      if (!active) {
+        // return 'false' or error: skip the 'line' callbacks of this window
+        continue;
+      }
+    }
+
+    kvi_push(*line_providers, p);
   }
 }
 
@@ -269,6 +293,7 @@ void decor_provider_clear(DecorProvider *p)
   NLUA_CLEAR_REF(p->redraw_start);
   NLUA_CLEAR_REF(p->redraw_buf);
   NLUA_CLEAR_REF(p->redraw_win);
+  NLUA_CLEAR_REF(p->redraw_range);
   NLUA_CLEAR_REF(p->redraw_line);
   NLUA_CLEAR_REF(p->redraw_end);
   NLUA_CLEAR_REF(p->spell_nav);
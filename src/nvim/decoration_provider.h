@@ -16,6 +16,7 @@ typedef struct {
   LuaRef redraw_start;
   LuaRef redraw_buf;
   LuaRef redraw_win;
+  LuaRef redraw_range;
   LuaRef redraw_line;
   LuaRef redraw_end;
   LuaRef hl_def;
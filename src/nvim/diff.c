@@ -26,6 +26,7 @@
 #include "nvim/diff.h"
 #include "nvim/drawscreen.h"
 #include "nvim/eval.h"
+#include "nvim/event/loop.h"
 #include "nvim/ex_cmds.h"
 #include "nvim/ex_cmds_defs.h"
 #include "nvim/ex_docmd.h"
@@ -36,6 +37,7 @@
 #include "nvim/gettext.h"
 #include "nvim/globals.h"
 #include "nvim/linematch.h"
+#include "nvim/main.h"
 #include "nvim/mark.h"
 #include "nvim/mbyte.h"
 #include "nvim/memline.h"
@@ -76,6 +78,7 @@ static bool diff_need_update = false;  // ex_diffupdate needs to be called
 #define DIFF_CLOSE_OFF  0x400   // diffoff when closing window
 #define DIFF_FOLLOWWRAP 0x800   // follow the wrap option
 #define DIFF_LINEMATCH  0x1000  // match most similar lines within diff
+#define DIFF_ASYNC      0x2000  // update diffs on the thread pool
 #define ALL_WHITE_DIFF (DIFF_IWHITE | DIFF_IWHITEALL | DIFF_IWHITEEOL)
 static int diff_flags = DIFF_INTERNAL | DIFF_FILLER | DIFF_CLOSE_OFF;
 
@@ -116,6 +119,19 @@ typedef struct {
   int dio_internal;  // using internal diff
 } diffio_T;
 
+/// Diff computed on the thread pool, see diff_update_async().
+typedef struct diffjob_S {
+  tabpage_T *dj_tp;                     ///< tab page the diff is for
+  int dj_idx_orig;                      ///< index of the original buffer
+  buf_T *dj_buf[DB_COUNT];              ///< buffers, NULL when not diffed
+  varnumber_T dj_changedtick[DB_COUNT];  ///< b:changedtick of dj_buf[]
+  mmfile_t dj_text[DB_COUNT];           ///< text of dj_buf[]
+  garray_T dj_hunks[DB_COUNT];          ///< diffhunk_T with dj_idx_orig
+  unsigned long dj_flags;               ///< xdiff flags
+  bool dj_failed;                       ///< xdiff failed
+  bool dj_restart;                      ///< diff became outdated
+} diffjob_T;
+
 typedef enum {
   DIFF_ED,
   DIFF_UNIFIED,
@@ -137,6 +153,7 @@ void diff_buf_delete(buf_T *buf)
     if (i != DB_COUNT) {
       tp->tp_diffbuf[i] = NULL;
       tp->tp_diff_invalid = true;
+      tp->tp_diff_incr = false;
 
       if (tp == curtab) {
         // don't redraw right away, more might change or buffer state
@@ -169,6 +186,7 @@ void diff_buf_adjust(win_T *win)
       if (i != DB_COUNT) {
         curtab->tp_diffbuf[i] = NULL;
         curtab->tp_diff_invalid = true;
+        curtab->tp_diff_incr = false;
         diff_redraw(true);
       }
     }
@@ -197,6 +215,7 @@ void diff_buf_add(buf_T *buf)
     if (curtab->tp_diffbuf[i] == NULL) {
       curtab->tp_diffbuf[i] = buf;
       curtab->tp_diff_invalid = true;
+      curtab->tp_diff_incr = false;
       diff_redraw(true);
       return;
     }
@@ -214,6 +233,7 @@ static void diff_buf_clear(void)
     if (curtab->tp_diffbuf[i] != NULL) {
       curtab->tp_diffbuf[i] = NULL;
       curtab->tp_diff_invalid = true;
+      curtab->tp_diff_incr = false;
       diff_redraw(true);
     }
   }
@@ -256,6 +276,7 @@ void diff_invalidate(buf_T *buf)
     int i = diff_buf_idx_tp(buf, tp);
     if (i != DB_COUNT) {
       tp->tp_diff_invalid = true;
+      tp->tp_diff_incr = false;
       if (tp == curtab) {
         diff_redraw(true);
       }
@@ -263,6 +284,39 @@ void diff_invalidate(buf_T *buf)
   }
 }
 
+/// Called by changed_common(): remember which lines of "buf" changed since the
+/// diffs were updated, so that diff_update_incr() only needs to diff those.
+/// See changed_lines() for the arguments.
+void diff_lines_changed(buf_T *buf, linenr_T lnum, linenr_T lnume, linenr_T xtra)
+{
+  FOR_ALL_TABS(tp) {
+    int idx = diff_buf_idx_tp(buf, tp);
+    if (idx == DB_COUNT) {
+      continue;
+    }
+    linenr_T bot = lnume + xtra;
+    if (tp->tp_diff_top[idx] != 0) {
+      // Lines changed earlier below the change have moved.
+      linenr_T old_bot = tp->tp_diff_bot[idx];
+      if (old_bot >= lnume) {
+        old_bot += xtra;
+      }
+      lnum = MIN(lnum, tp->tp_diff_top[idx]);
+      bot = MAX(bot, old_bot);
+    }
+    tp->tp_diff_top[idx] = lnum;
+    tp->tp_diff_bot[idx] = bot;
+  }
+}
+
+/// Forget the changed lines, the diffs in "tp" are up-to-date.
+static void diff_lines_clear(tabpage_T *tp, bool incr)
+{
+  CLEAR_FIELD(tp->tp_diff_top);
+  CLEAR_FIELD(tp->tp_diff_bot);
+  tp->tp_diff_incr = incr;
+}
+
 /// Called by mark_adjust(): update line numbers in "buf".
 ///
 /// @param line1
@@ -927,6 +981,119 @@ static int diff_internal_failed(void)
   return false;
 }
 
+/// Update the diffs in the current tab page for the lines that changed since
+/// the last update, instead of diffing the whole buffers: the text from the
+/// last diff block above the changes until the first diff block below them is
+/// diffed again.  Only done for two buffers and the internal diff.
+///
+/// @return  OK when done, FAIL when the diffs need to be updated completely.
+static int diff_update_incr(void)
+{
+  tabpage_T *tp = curtab;
+
+  if (!tp->tp_diff_incr || !diff_internal() || diff_internal_failed()) {
+    return FAIL;
+  }
+
+  int idxs[2];
+  int count = 0;
+  for (int idx = 0; idx < DB_COUNT; idx++) {
+    buf_T *buf = tp->tp_diffbuf[idx];
+    if (buf == NULL) {
+      continue;
+    }
+    if (count == 2 || buf->b_ml.ml_mfp == NULL) {
+      return FAIL;
+    }
+    idxs[count++] = idx;
+  }
+  if (count != 2 || (tp->tp_diff_top[idxs[0]] == 0 && tp->tp_diff_top[idxs[1]] == 0)) {
+    return FAIL;
+  }
+
+  // Find the last block above the changed lines and the first one below
+  // them.  They were not affected by the changes, but are diffed again with
+  // the lines in between, since the changes may have made them bigger.
+  diff_T *dprev = NULL;   // block before "dabove"
+  diff_T *dabove = NULL;  // last block above the changes
+  diff_T *dbelow = NULL;  // first block below the changes
+  for (diff_T *dp = tp->tp_first_diff; dp != NULL; dp = dp->df_next) {
+    bool above = true;
+    bool below = true;
+    for (int i = 0; i < 2; i++) {
+      int idx = idxs[i];
+      if (tp->tp_diff_top[idx] != 0) {
+        above &= dp->df_lnum[idx] + dp->df_count[idx] <= tp->tp_diff_top[idx];
+        below &= dp->df_lnum[idx] >= tp->tp_diff_bot[idx];
+      }
+    }
+    if (below) {
+      dbelow = dp;
+      break;
+    }
+    if (above) {
+      dprev = dabove;
+      dabove = dp;
+    }
+  }
+
+  linenr_T start[2];
+  mmfile_t text[2];
+  CLEAR_FIELD(text);
+  for (int i = 0; i < 2; i++) {
+    int idx = idxs[i];
+    buf_T *buf = tp->tp_diffbuf[idx];
+    start[i] = dabove != NULL ? dabove->df_lnum[idx] : 1;
+    linenr_T end = dbelow != NULL ? dbelow->df_lnum[idx] + dbelow->df_count[idx] - 1
+                                  : buf->b_ml.ml_line_count;
+    if (end < start[i] - 1 || diff_write_buffer(buf, &text[i], start[i], end) == FAIL) {
+      xfree(text[0].ptr);
+      return FAIL;
+    }
+  }
+
+  garray_T hunks;
+  ga_init(&hunks, sizeof(diffhunk_T), 10);
+  int ret = diff_xdl(&text[0], &text[1], diff_xdl_flags(), &hunks);
+  xfree(text[0].ptr);
+  xfree(text[1].ptr);
+  if (ret == FAIL) {
+    ga_clear(&hunks);
+    return FAIL;
+  }
+
+  // Replace the blocks in the region with the new ones.
+  diff_T *dnext = dbelow != NULL ? dbelow->df_next : NULL;
+  for (diff_T *dp = dabove != NULL ? dabove : tp->tp_first_diff; dp != dnext;) {
+    diff_T *dn = dp->df_next;
+    xfree(dp);
+    dp = dn;
+  }
+  if (dprev == NULL) {
+    tp->tp_first_diff = dnext;
+  } else {
+    dprev->df_next = dnext;
+  }
+  for (int i = 0; i < hunks.ga_len; i++) {
+    diffhunk_T *hunk = &((diffhunk_T *)hunks.ga_data)[i];
+    dprev = diff_alloc_new(tp, dprev, dnext);
+    dprev->df_lnum[idxs[0]] = hunk->lnum_orig + start[0] - 1;
+    dprev->df_count[idxs[0]] = (linenr_T)hunk->count_orig;
+    dprev->df_lnum[idxs[1]] = hunk->lnum_new + start[1] - 1;
+    dprev->df_count[idxs[1]] = (linenr_T)hunk->count_new;
+  }
+  ga_clear(&hunks);
+
+  tp->tp_diff_invalid = false;
+  diff_lines_clear(tp, true);
+
+  // force updating cursor position on screen
+  curwin->w_valid_cursor.lnum = 0;
+  diff_redraw(true);
+  apply_autocmds(EVENT_DIFFUPDATED, NULL, NULL, false, curbuf);
+  return OK;
+}
+
 /// Completely update the diffs for the buffers involved.
 ///
 /// When using the external "diff" command the buffers are written to a file,
@@ -943,9 +1110,17 @@ void ex_diffupdate(exarg_T *eap)
 
   int had_diffs = curtab->tp_first_diff != NULL;
 
+  // A diff being computed in the background is outdated now.
+  curtab->tp_diff_job = NULL;
+
+  if (eap == NULL && diff_update_incr() == OK) {
+    return;
+  }
+
   // Delete all diffblocks.
   diff_clear(curtab);
   curtab->tp_diff_invalid = false;
+  diff_lines_clear(curtab, true);
 
   // Use the first buffer as the original text.
   int idx_orig;
@@ -995,6 +1170,150 @@ theend:
   }
 }
 
+/// Update the diffs for the buffers involved, like ex_diffupdate(NULL).  With
+/// "async" in 'diffopt' compute them on the thread pool instead, for a
+/// snapshot of the buffer text.  Until that is done the current diff blocks
+/// are used, as adjusted by diff_mark_adjust().
+void diff_update_async(void)
+{
+  tabpage_T *tp = curtab;
+
+  if (!(diff_flags & DIFF_ASYNC) || !diff_internal() || diff_internal_failed()
+      || diff_busy) {
+    ex_diffupdate(NULL);
+    return;
+  }
+
+  if (tp->tp_diff_job != NULL) {
+    // Diff again when the running one is done.  Text changes are noticed
+    // by the changed b:changedtick.
+    if (tp->tp_diff_invalid) {
+      tp->tp_diff_job->dj_restart = true;
+      tp->tp_diff_invalid = false;
+    }
+    return;
+  }
+
+  // Diffing only the changed lines is quick enough to do right away.
+  if (diff_update_incr() == OK) {
+    return;
+  }
+
+  int idx_orig;
+  for (idx_orig = 0; idx_orig < DB_COUNT; idx_orig++) {
+    if (tp->tp_diffbuf[idx_orig] != NULL) {
+      break;
+    }
+  }
+  if (idx_orig == DB_COUNT || tp->tp_diffbuf[idx_orig]->b_ml.ml_mfp == NULL) {
+    ex_diffupdate(NULL);
+    return;
+  }
+
+  diffjob_T *job = xcalloc(1, sizeof(*job));
+  job->dj_tp = tp;
+  job->dj_idx_orig = idx_orig;
+  job->dj_flags = diff_xdl_flags();
+  for (int idx = idx_orig; idx < DB_COUNT; idx++) {
+    buf_T *buf = tp->tp_diffbuf[idx];
+    if (buf == NULL || buf->b_ml.ml_mfp == NULL) {
+      continue;  // skip buffer that isn't loaded
+    }
+    if (diff_write_buffer(buf, &job->dj_text[idx], 1, -1) == FAIL) {
+      // Out of memory, the external diff will be used.
+      diff_job_free(job);
+      ex_diffupdate(NULL);
+      return;
+    }
+    job->dj_buf[idx] = buf;
+    job->dj_changedtick[idx] = buf_get_changedtick(buf);
+    ga_init(&job->dj_hunks[idx], sizeof(diffhunk_T), 100);
+  }
+
+  tp->tp_diff_job = job;
+  tp->tp_diff_invalid = false;
+  diff_lines_clear(tp, false);
+  loop_queue_work(&main_loop, diff_job_work, diff_job_done, job);
+}
+
+/// Compute the diffs for diff_update_async().  Runs on the thread pool.
+static void diff_job_work(void *data)
+{
+  diffjob_T *job = data;
+  mmfile_t *orig = &job->dj_text[job->dj_idx_orig];
+
+  for (int idx = job->dj_idx_orig + 1; idx < DB_COUNT; idx++) {
+    if (job->dj_buf[idx] != NULL
+        && diff_xdl(orig, &job->dj_text[idx], job->dj_flags,
+                    &job->dj_hunks[idx]) == FAIL) {
+      job->dj_failed = true;
+    }
+  }
+}
+
+/// Use the diffs computed by diff_job_work(), unless the buffers changed in
+/// the meantime.
+static void diff_job_done(void **argv)
+{
+  diffjob_T *job = argv[0];
+  tabpage_T *tp = job->dj_tp;
+
+  if (!valid_tabpage(tp) || tp->tp_diff_job != job) {
+    // Tab page was closed or the diff was updated otherwise.
+    diff_job_free(job);
+    return;
+  }
+  tp->tp_diff_job = NULL;
+
+  bool outdated = job->dj_restart || tp != curtab || diff_busy;
+  for (int idx = 0; idx < DB_COUNT && !outdated; idx++) {
+    buf_T *buf = tp->tp_diffbuf[idx];
+    if (buf != NULL && buf->b_ml.ml_mfp == NULL) {
+      buf = NULL;
+    }
+    outdated = buf != job->dj_buf[idx]
+               || (buf != NULL && buf_get_changedtick(buf) != job->dj_changedtick[idx]);
+  }
+
+  if (outdated || job->dj_failed) {
+    tp->tp_diff_invalid = true;
+    if (tp == curtab && !diff_busy) {
+      // Try again, when xdiff failed ex_diffupdate() gives the error.
+      if (job->dj_failed) {
+        ex_diffupdate(NULL);
+      } else {
+        diff_update_async();
+      }
+    }
+    diff_job_free(job);
+    return;
+  }
+
+  diff_clear(tp);
+  diff_lines_clear(tp, true);
+  for (int idx = job->dj_idx_orig + 1; idx < DB_COUNT; idx++) {
+    if (job->dj_buf[idx] != NULL) {
+      diffio_T dio = { .dio_internal = true, .dio_diff.dout_ga = job->dj_hunks[idx] };
+      diff_read(job->dj_idx_orig, idx, &dio);
+    }
+  }
+  diff_job_free(job);
+
+  // force updating cursor position on screen
+  curwin->w_valid_cursor.lnum = 0;
+  diff_redraw(true);
+  apply_autocmds(EVENT_DIFFUPDATED, NULL, NULL, false, curbuf);
+}
+
+static void diff_job_free(diffjob_T *job)
+{
+  for (int idx = 0; idx < DB_COUNT; idx++) {
+    xfree(job->dj_text[idx].ptr);
+    ga_clear(&job->dj_hunks[idx]);
+  }
+  xfree(job);
+}
+
 ///
 /// Do a quick test if "diff" really works.  Otherwise it looks like there
 /// are no differences.  Can't use the return value, it's non-zero when
@@ -1088,39 +1407,56 @@ static int check_external_diff(diffio_T *diffio)
 ///
 static int diff_file_internal(diffio_T *diffio)
 {
-  xpparam_t param;
-  xdemitconf_t emit_cfg;
-  xdemitcb_t emit_cb;
-
-  CLEAR_FIELD(param);
-  CLEAR_FIELD(emit_cfg);
-  CLEAR_FIELD(emit_cb);
+  if (diff_xdl(&diffio->dio_orig.din_mmfile, &diffio->dio_new.din_mmfile,
+               diff_xdl_flags(), &diffio->dio_diff.dout_ga) == FAIL) {
+    emsg(_("E960: Problem creating the internal diff"));
+    return FAIL;
+  }
+  return OK;
+}
 
-  param.flags = (unsigned long)diff_algorithm;
+/// Get the xdiff flags for the current 'diffopt'.
+static unsigned long diff_xdl_flags(void)
+{
+  unsigned long flags = (unsigned long)diff_algorithm;
 
   if (diff_flags & DIFF_IWHITE) {
-    param.flags |= XDF_IGNORE_WHITESPACE_CHANGE;
+    flags |= XDF_IGNORE_WHITESPACE_CHANGE;
   }
   if (diff_flags & DIFF_IWHITEALL) {
-    param.flags |= XDF_IGNORE_WHITESPACE;
+    flags |= XDF_IGNORE_WHITESPACE;
   }
   if (diff_flags & DIFF_IWHITEEOL) {
-    param.flags |= XDF_IGNORE_WHITESPACE_AT_EOL;
+    flags |= XDF_IGNORE_WHITESPACE_AT_EOL;
   }
   if (diff_flags & DIFF_IBLANK) {
-    param.flags |= XDF_IGNORE_BLANK_LINES;
+    flags |= XDF_IGNORE_BLANK_LINES;
   }
+  return flags;
+}
+
+/// Diff "orig" and "other" with xdiff and append the hunks to "hunks".
+/// Only uses its arguments, can be called from any thread.
+///
+/// @return FAIL for failure.
+static int diff_xdl(mmfile_t *orig, mmfile_t *other, unsigned long flags, garray_T *hunks)
+{
+  xpparam_t param;
+  xdemitconf_t emit_cfg;
+  xdemitcb_t emit_cb;
+  diffout_T dout = { .dout_ga = *hunks };
 
+  CLEAR_FIELD(param);
+  CLEAR_FIELD(emit_cfg);
+  CLEAR_FIELD(emit_cb);
+
+  param.flags = flags;
   emit_cfg.ctxlen = 0;  // don't need any diff_context here
-  emit_cb.priv = &diffio->dio_diff;
+  emit_cb.priv = &dout;
   emit_cfg.hunk_func = xdiff_out;
-  if (xdl_diff(&diffio->dio_orig.din_mmfile,
-               &diffio->dio_new.din_mmfile,
-               &param, &emit_cfg, &emit_cb) < 0) {
-    emsg(_("E960: Problem creating the internal diff"));
-    return FAIL;
-  }
-  return OK;
+  int r = xdl_diff(orig, other, &param, &emit_cfg, &emit_cb);
+  *hunks = dout.dout_ga;
+  return r < 0 ? FAIL : OK;
 }
 
 /// Make a diff between files "tmp_orig" and "tmp_new", results in "tmp_diff".
@@ -2109,7 +2445,7 @@ int diff_check_with_linestatus(win_T *wp, linenr_T lnum, int *linestatus)
 
   if (curtab->tp_diff_invalid) {
     // update after a big change
-    ex_diffupdate(NULL);
+    diff_update_async();
   }
 
   // no diffs at all
@@ -2508,6 +2844,9 @@ int diffopt_changed(void)
     } else if (strncmp(p, "internal", 8) == 0) {
       p += 8;
       diff_flags_new |= DIFF_INTERNAL;
+    } else if (strncmp(p, "async", 5) == 0) {
+      p += 5;
+      diff_flags_new |= DIFF_ASYNC;
     } else if (strncmp(p, "algorithm:", 10) == 0) {
       // Note: Keep this in sync with p_dip_algorithm_values.
       p += 10;
@@ -2553,6 +2892,7 @@ int diffopt_changed(void)
   if (diff_flags != diff_flags_new || diff_algorithm != diff_algorithm_new) {
     FOR_ALL_TABS(tp) {
       tp->tp_diff_invalid = true;
+      tp->tp_diff_incr = false;
     }
   }
 
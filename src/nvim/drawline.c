@@ -138,11 +138,46 @@ typedef struct {
                              ///< to be added to wlv.vcol later
 } winlinevars_T;
 
+/// Where win_line() stopped when skipping to 'leftcol' for a line, so that
+/// scrolling further to the right does not have to start over from the
+/// start of the line. Only used for 'nowrap' without inline virtual text,
+/// when the width of a character only depends on the options below.
+typedef struct {
+  int fnum;                  ///< buffer number
+  linenr_T lnum;             ///< line number
+  varnumber_T tick;          ///< changedtick of the buffer
+  OptInt ts;                 ///< 'tabstop'
+  colnr_T *vts;              ///< 'vartabstop'
+  int list;                  ///< 'list'
+  int lcs_tab1;              ///< "tab" item of 'listchars'
+  int *lcs_multispace;       ///< "multispace" item of 'listchars'
+  int *lcs_leadmultispace;   ///< "leadmultispace" item of 'listchars'
+  colnr_T start_vcol;        ///< vcol at the start of the line
+  ptrdiff_t leftcol;         ///< 'leftcol' that was skipped to
+
+  colnr_T vcol;              ///< vcol where skipping stopped
+  ptrdiff_t off;             ///< byte offset where skipping stopped
+  ptrdiff_t prev_off;        ///< byte offset of the character before it
+  int charsize;              ///< size of the character before it
+  bool in_multispace;
+  int multispace_pos;
+} leftcol_cache_T;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "drawline.c.generated.h"
 #endif
 
 static char *extra_buf = NULL;
+
+#define LEFTCOL_CACHE_SIZE 128  // must be a power of two
+static leftcol_cache_T leftcol_cache[LEFTCOL_CACHE_SIZE];
+
+/// Forget where skipping to 'leftcol' stopped, after a change that may affect
+/// the width of characters, e.g. 'isprint' or 'ambiwidth'.
+void leftcol_cache_clear(void)
+{
+  memset(leftcol_cache, 0, sizeof(leftcol_cache));
+}
 static size_t extra_buf_size = 0;
 
 static char *get_extra_buf(size_t size)
@@ -1027,6 +1062,7 @@ int win_line(win_T *wp, linenr_T lnum, int startrow, int endrow, bool number_onl
                                         // starts
   int spell_attr = 0;                   // attributes desired by spelling
   int word_end = 0;                     // last byte with same spell_attr
+  spellcache_T *spell_cache = NULL;     // cached spell_check() results
   int cur_checked_col = 0;              // checked column for current line
   int extra_check = 0;                  // has syntax or linebreak
   int multi_attr = 0;                   // attributes desired by multibyte
@@ -1338,6 +1374,7 @@ int win_line(win_T *wp, linenr_T lnum, int startrow, int endrow, bool number_onl
     }
     assert(!end_fill);
     line = ml_get_buf(wp->w_buffer, lnum);
+    spell_cache = spell_cache_find(wp, line, nextline + SPWORDLEN);
 
     // If current line is empty, check first word in next line for capital.
     ptr = skipwhite(line);
@@ -1409,7 +1446,66 @@ int win_line(win_T *wp, linenr_T lnum, int startrow, int endrow, bool number_onl
 
     init_chartabsize_arg(&cts, wp, lnum, wlv.vcol, line, ptr);
     cts.cts_max_head_vcol = (int)v;
+
+    leftcol_cache_T *lcc = NULL;
+    if (!wp->w_p_wrap && !wp->w_p_lbr && !wp->w_p_bri && *get_showbreak_value(wp) == NUL
+        && !cts.cts_has_virt_text) {
+      lcc = &leftcol_cache[lnum & (LEFTCOL_CACHE_SIZE - 1)];
+      leftcol_cache_T key = {
+        .fnum = wp->w_buffer->b_fnum,
+        .lnum = lnum,
+        .tick = buf_get_changedtick(wp->w_buffer),
+        .ts = wp->w_buffer->b_p_ts,
+        .vts = wp->w_buffer->b_p_vts_array,
+        .list = wp->w_p_list,
+        .lcs_tab1 = wp->w_p_lcs_chars.tab1,
+        .lcs_multispace = wp->w_p_lcs_chars.multispace,
+        .lcs_leadmultispace = wp->w_p_lcs_chars.leadmultispace,
+        .start_vcol = wlv.vcol,
+        .leftcol = v,
+      };
+      if (lcc->fnum == key.fnum && lcc->lnum == key.lnum && lcc->tick == key.tick
+          && lcc->ts == key.ts && lcc->vts == key.vts && lcc->list == key.list
+          && lcc->lcs_tab1 == key.lcs_tab1 && lcc->lcs_multispace == key.lcs_multispace
+          && lcc->lcs_leadmultispace == key.lcs_leadmultispace
+          && lcc->start_vcol == key.start_vcol && lcc->leftcol <= v
+          && ptr == line) {
+        // Skipping stops at the same place or continues from it.
+        cts.cts_vcol = lcc->vcol;
+        cts.cts_ptr = line + lcc->off;
+        prev_ptr = line + lcc->prev_off;
+        charsize = lcc->charsize;
+        in_multispace = lcc->in_multispace;
+        multispace_pos = lcc->multispace_pos;
+      }
+      *lcc = key;
+    }
+
+    // Without 'list' and anything that changes the size of a character
+    // printable ASCII takes one cell, skip it in bulk for long lines.  No
+    // more than "v" bytes are skipped, don't look further for the NUL.
+    char *ascii_end = NULL;
+    if (!wp->w_p_list && !wp->w_p_lbr && !wp->w_p_bri && *get_showbreak_value(wp) == NUL
+        && !cts.cts_has_virt_text && cts.cts_vcol < v) {
+      ascii_end = cts.cts_ptr + strnlen(cts.cts_ptr, (size_t)(v - cts.cts_vcol));
+    }
+
     while (cts.cts_vcol < v && *cts.cts_ptr != NUL) {
+      if (ascii_end != NULL) {
+        size_t n = MIN(ascii_printable_len(cts.cts_ptr, ascii_end), (size_t)(v - cts.cts_vcol));
+        // Leave the last one when a composing character may follow it.
+        if (n > 0 && (uint8_t)cts.cts_ptr[n] >= 0x80) {
+          n--;
+        }
+        if (n > 0) {
+          cts.cts_vcol += (colnr_T)n;
+          cts.cts_ptr += n;
+          prev_ptr = cts.cts_ptr - 1;
+          charsize = 1;
+          head = 0;
+          continue;
+        }
+      }
       head = 0;
       charsize = win_lbr_chartabsize(&cts, &head);
       cts.cts_vcol += charsize;
@@ -1435,6 +1531,14 @@ int win_line(win_T *wp, linenr_T lnum, int startrow, int endrow, bool number_onl
         }
       }
     }
+    if (lcc != NULL) {
+      lcc->vcol = cts.cts_vcol;
+      lcc->off = cts.cts_ptr - line;
+      lcc->prev_off = prev_ptr - line;
+      lcc->charsize = charsize;
+      lcc->in_multispace = in_multispace;
+      lcc->multispace_pos = multispace_pos;
+    }
     wlv.vcol = cts.cts_vcol;
     ptr = cts.cts_ptr;
     clear_chartabsize_arg(&cts);
@@ -2102,7 +2206,9 @@ int win_line(win_T *wp, linenr_T lnum, int startrow, int endrow, bool number_onl
               p = prev_ptr;
             }
             spv->spv_cap_col -= (int)(prev_ptr - line);
-            size_t tmplen = spell_check(wp, p, &spell_hlf, &spv->spv_cap_col, spv->spv_unchanged);
+            size_t tmplen = spell_check_cached(spell_cache, (int)(prev_ptr - line), wp, p,
+                                               &spell_hlf, &spv->spv_cap_col,
+                                               spv->spv_unchanged);
             assert(tmplen <= INT_MAX);
             int len = (int)tmplen;
             word_end = (int)v + len;
@@ -93,6 +93,7 @@
 #include "nvim/option.h"
 #include "nvim/option_vars.h"
 #include "nvim/os/os_defs.h"
+#include "nvim/os/time.h"
 #include "nvim/plines.h"
 #include "nvim/popupmenu.h"
 #include "nvim/pos.h"
@@ -423,6 +424,8 @@ int update_screen(void)
     return FAIL;
   }
 
+  const uint64_t start_time = os_hrtime();
+
   // May have postponed updating diffs.
   if (need_diff_redraw) {
     diff_redraw(true);
@@ -687,6 +690,7 @@ int update_screen(void)
 
   // either cmdline is cleared, not drawn or mode is last drawn
   cmdline_was_last_drawn = false;
+  stats_hist_add(&g_stats.update_screen, os_hrtime() - start_time);
   return OK;
 }
 
@@ -2032,6 +2036,12 @@ static void win_update(win_T *wp, DecorProviders *providers)
       wp->w_cursorline = cursorline_fi.fi_lnum;
     }
   }
+  // When 'cursorline' only highlights the number column, a cursorline that
+  // moved only needs the number column of the old and new line drawn.
+  const bool cul_nr_only = wp->w_p_cul
+                           && !(wp->w_p_culopt_flags & (CULOPT_LINE | CULOPT_SCRLINE))
+                           && !(wp->w_p_cole > 0 && !conceal_cursor_line(wp));
+  const bool cul_moved = wp->w_cursorline != wp->w_last_cursorline;
 
   win_check_ns_hl(wp);
 
@@ -2094,8 +2104,8 @@ static void win_update(win_T *wp, DecorProviders *providers)
                         // if lines were inserted or deleted
                         || (wp->w_match_head != NULL
                             && buf->b_mod_xlines != 0)))))
-        || lnum == wp->w_cursorline
-        || lnum == wp->w_last_cursorline) {
+        || (!cul_nr_only
+            && (lnum == wp->w_cursorline || lnum == wp->w_last_cursorline))) {
       if (lnum == mod_top) {
         top_to_mod = false;
       }
@@ -2309,8 +2319,11 @@ static void win_update(win_T *wp, DecorProviders *providers)
       idx++;
       lnum += foldinfo.fi_lines + 1;
     } else {
-      if (wp->w_p_rnu && wp->w_last_cursor_lnum_rnu != wp->w_cursor.lnum) {
-        // 'relativenumber' set and cursor moved vertically: The
+      if ((wp->w_p_rnu && wp->w_last_cursor_lnum_rnu != wp->w_cursor.lnum)
+          || (cul_nr_only && cul_moved
+              && (lnum == wp->w_cursorline || lnum == wp->w_last_cursorline))) {
+        // 'relativenumber' set and cursor moved vertically, or the
+        // cursorline moved while it only highlights the number column: The
         // text doesn't need to be drawn, but the number column does.
         foldinfo_T info = wp->w_p_cul && lnum == wp->w_cursor.lnum
                           ? cursorline_fi : fold_info(wp, lnum);
@@ -2662,6 +2675,10 @@ void redraw_later(win_T *wp, int type)
 /// Mark all windows to be redrawn later.
 void redraw_all_later(int type)
 {
+  if (type >= UPD_NOT_VALID) {
+    leftcol_cache_clear();
+    plines_cache_invalidate_all();
+  }
   FOR_ALL_WINDOWS_IN_TAB(wp, curtab) {
     redraw_later(wp, type);
   }
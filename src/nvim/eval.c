@@ -312,6 +312,12 @@ typedef enum {
 static uint64_t last_timer_id = 1;
 static PMap(uint64_t) timers = MAP_INIT;
 
+/// Stack items kept for reuse while setting references for garbage
+/// collection, marking a large list of dicts would otherwise allocate and free
+/// an item for every dict.
+static ht_stack_T *ht_stack_unused = NULL;
+static list_stack_T *list_stack_unused = NULL;
+
 static const char *const msgpack_type_names[] = {
   [kMPNil] = "nil",
   [kMPBoolean] = "boolean",
@@ -991,11 +997,63 @@ char *eval_to_string(char *arg, bool convert)
   return retval;
 }
 
+/// If "arg" is a simple function call without arguments, like "Func()",
+/// "s:Func()" or "v:lua.func()", call the function directly instead of
+/// parsing "arg".
+///
+/// @return  NOTDONE when "arg" is not a simple function call or the function
+///          is not defined yet, otherwise OK or FAIL.
+int may_call_simple_func(const char *arg, typval_T *rettv)
+  FUNC_ATTR_NONNULL_ALL
+{
+  arg = skipwhite(arg);
+  const char *parens = strstr(arg, "()");
+  if (parens == NULL || *skipwhite(parens + 2) != NUL) {
+    return NOTDONE;
+  }
+
+  const char *p = arg;
+  if (strncmp(p, "v:lua.", 6) == 0) {
+    // "v:lua.vim.treesitter.foldexpr()": call the Lua function.
+    p += 6;
+    const char *name = p;
+    while (eval_isnamec((uint8_t)(*p)) || *p == '.') {
+      p++;
+    }
+    if (p != parens || p == name) {
+      return NOTDONE;
+    }
+    typval_T argvars[1];
+    argvars[0].v_type = VAR_UNKNOWN;
+    rettv->v_type = VAR_NUMBER;
+    rettv->vval.v_number = 0;
+    nlua_typval_call(name, (size_t)(p - name), argvars, 0, rettv);
+    return OK;
+  }
+  if (strncmp(p, "<SNR>", 5) == 0) {
+    p = skipdigits(p + 5);
+  } else if (strncmp(p, "<SID>", 5) == 0) {
+    p += 5;
+  }
+  if (!eval_isnamec1((uint8_t)(*p))) {
+    return NOTDONE;
+  }
+  while (eval_isnamec((uint8_t)(*p))) {
+    p++;
+  }
+  if (p != parens) {
+    return NOTDONE;
+  }
+  return call_simple_func(arg, (size_t)(parens - arg), rettv);
+}
+
 /// Call eval_to_string() without using current local variables and using
 /// textlock.
 ///
 /// @param use_sandbox  when true, use the sandbox.
-char *eval_to_string_safe(char *arg, const bool use_sandbox)
+/// @param use_simple_function  when true, call a simple function directly,
+///                             see may_call_simple_func().
+char *eval_to_string_safe(char *arg, const bool use_sandbox, const bool use_simple_function)
 {
   char *retval;
   funccal_entry_T funccal_entry;
@@ -1005,7 +1063,17 @@ char *eval_to_string_safe(char *arg, const bool use_sandbox)
     sandbox++;
   }
   textlock++;
-  retval = eval_to_string(arg, false);
+  typval_T tv;
+  int r = use_simple_function ? may_call_simple_func(arg, &tv) : NOTDONE;
+  if (r == OK) {
+    retval = typval2string(&tv, false);
+    tv_clear(&tv);
+  } else if (r == FAIL) {
+    tv_clear(&tv);
+    retval = NULL;
+  } else {
+    retval = eval_to_string(arg, false);
+  }
   if (use_sandbox) {
     sandbox--;
   }
@@ -1017,16 +1085,26 @@ char *eval_to_string_safe(char *arg, const bool use_sandbox)
 /// Top level evaluation function, returning a number.
 /// Evaluates "expr" silently.
 ///
+/// @param use_simple_function  when true, call a simple function directly,
+///                             see may_call_simple_func().
+///
 /// @return  -1 for an error.
-varnumber_T eval_to_number(char *expr)
+varnumber_T eval_to_number(char *expr, const bool use_simple_function)
 {
   typval_T rettv;
   varnumber_T retval;
   char *p = skipwhite(expr);
+  int r = NOTDONE;
 
   emsg_off++;
 
-  if (eval1(&p, &rettv, &EVALARG_EVALUATE) == FAIL) {
+  if (use_simple_function) {
+    r = may_call_simple_func(expr, &rettv);
+  }
+  if (r == NOTDONE) {
+    r = eval1(&p, &rettv, &EVALARG_EVALUATE);
+  }
+  if (r == FAIL) {
     retval = -1;
   } else {
     retval = tv_get_number_chk(&rettv, NULL);
@@ -1285,7 +1363,11 @@ int eval_foldexpr(win_T *wp, int *cp)
 
   typval_T tv;
   varnumber_T retval;
-  if (eval0(arg, &tv, NULL, &EVALARG_EVALUATE) == FAIL) {
+  int r = may_call_simple_func(arg, &tv);
+  if (r == NOTDONE) {
+    r = eval0(arg, &tv, NULL, &EVALARG_EVALUATE);
+  }
+  if (r == FAIL) {
     retval = 0;
   } else {
     // If the result is a number, just return the number.
@@ -4575,6 +4657,8 @@ bool garbage_collect(bool testing)
 
   ABORTING(set_ref_in_quickfix)(copyID);
 
+  free_unused_ref_stacks();
+
   bool did_free = false;
   if (!abort) {
     // 2. Free lists and dictionaries that are not referenced.
@@ -4590,6 +4674,21 @@ bool garbage_collect(bool testing)
   return did_free;
 }
 
+/// Free the stack items kept for reuse while setting references.
+static void free_unused_ref_stacks(void)
+{
+  while (ht_stack_unused != NULL) {
+    ht_stack_T *const next = ht_stack_unused->prev;
+    xfree(ht_stack_unused);
+    ht_stack_unused = next;
+  }
+  while (list_stack_unused != NULL) {
+    list_stack_T *const next = list_stack_unused->prev;
+    xfree(list_stack_unused);
+    list_stack_unused = next;
+  }
+}
+
 /// Free lists and dictionaries that are no longer referenced.
 ///
 /// @note  This function may only be called from garbage_collect().
@@ -4691,7 +4790,8 @@ bool set_ref_in_ht(hashtab_T *ht, int copyID, list_stack_T **list_stack)
     cur_ht = ht_stack->ht;
     ht_stack_T *tempitem = ht_stack;
     ht_stack = ht_stack->prev;
-    xfree(tempitem);
+    tempitem->prev = ht_stack_unused;
+    ht_stack_unused = tempitem;
   }
 
   return abort;
@@ -4731,7 +4831,8 @@ bool set_ref_in_list(list_T *l, int copyID, ht_stack_T **ht_stack)
     cur_l = list_stack->list;
     list_stack_T *tempitem = list_stack;
     list_stack = list_stack->prev;
-    xfree(tempitem);
+    tempitem->prev = list_stack_unused;
+    list_stack_unused = tempitem;
   }
 
   return abort;
@@ -4759,7 +4860,12 @@ bool set_ref_in_item(typval_T *tv, int copyID, ht_stack_T **ht_stack, list_stack
       if (ht_stack == NULL) {
         abort = set_ref_in_ht(&dd->dv_hashtab, copyID, list_stack);
       } else {
-        ht_stack_T *const newitem = xmalloc(sizeof(ht_stack_T));
+        ht_stack_T *newitem = ht_stack_unused;
+        if (newitem != NULL) {
+          ht_stack_unused = newitem->prev;
+        } else {
+          newitem = xmalloc(sizeof(ht_stack_T));
+        }
         newitem->ht = &dd->dv_hashtab;
         newitem->prev = *ht_stack;
         *ht_stack = newitem;
@@ -4783,7 +4889,12 @@ bool set_ref_in_item(typval_T *tv, int copyID, ht_stack_T **ht_stack, list_stack
       if (list_stack == NULL) {
         abort = set_ref_in_list(ll, copyID, ht_stack);
       } else {
-        list_stack_T *const newitem = xmalloc(sizeof(list_stack_T));
+        list_stack_T *newitem = list_stack_unused;
+        if (newitem != NULL) {
+          list_stack_unused = newitem->prev;
+        } else {
+          newitem = xmalloc(sizeof(list_stack_T));
+        }
         newitem->list = ll;
         newitem->prev = *list_stack;
         *list_stack = newitem;
@@ -5880,16 +5991,6 @@ void get_xdg_var_list(const XDGVarType xdg, typval_T *rettv)
   xfree(dirs);
 }
 
-static list_T *string_to_list(const char *str, size_t len, const bool keepempty)
-{
-  if (!keepempty && str[len - 1] == NL) {
-    len--;
-  }
-  list_T *const list = tv_list_alloc(kListLenMayKnow);
-  encode_list_write(list, str, len);
-  return list;
-}
-
 /// os_system wrapper. Handles 'verbose', :profile, and v:shell_error.
 void get_system_output_as_rettv(typval_T *argvars, typval_T *rettv, bool retlist)
 {
@@ -5938,7 +6039,15 @@ void get_system_output_as_rettv(typval_T *argvars, typval_T *rettv, bool retlist
   // execute the command
   size_t nread = 0;
   char *res = NULL;
-  int status = os_system(argv, input, (size_t)input_len, &res, &nread);
+  list_T *list = NULL;
+  int status;
+  if (retlist) {
+    // Split the output into lines while it is read.
+    list = tv_list_alloc(kListLenMayKnow);
+    status = os_system_list(argv, input, (size_t)input_len, list, &nread);
+  } else {
+    status = os_system(argv, input, (size_t)input_len, &res, &nread);
+  }
 
   if (profiling) {
     prof_child_exit(&wait_time);
@@ -5948,45 +6057,46 @@ void get_system_output_as_rettv(typval_T *argvars, typval_T *rettv, bool retlist
 
   set_vim_var_nr(VV_SHELL_ERROR, status);
 
-  if (res == NULL) {
-    if (retlist) {
-      // return an empty list when there's no output
-      tv_list_alloc_ret(rettv, 0);
-    } else {
-      rettv->vval.v_string = xstrdup("");
-    }
-    return;
-  }
-
   if (retlist) {
     int keepempty = 0;
     if (argvars[1].v_type != VAR_UNKNOWN && argvars[2].v_type != VAR_UNKNOWN) {
       keepempty = (int)tv_get_number(&argvars[2]);
     }
-    rettv->vval.v_list = string_to_list(res, nread, (bool)keepempty);
-    tv_list_ref(rettv->vval.v_list);
-    rettv->v_type = VAR_LIST;
-
-    xfree(res);
-  } else {
-    // res may contain several NULs before the final terminating one.
-    // Replace them with SOH (1) like in get_cmd_output() to avoid truncation.
-    memchrsub(res, NUL, 1, nread);
-#ifdef USE_CRNL
-    // translate <CR><NL> into <NL>
-    char *d = res;
-    for (char *s = res; *s; s++) {
-      if (s[0] == CAR && s[1] == NL) {
-        s++;
+    listitem_T *const last = tv_list_last(list);
+    if (!keepempty && last != NULL && TV_LIST_ITEM_TV(last)->vval.v_string == NULL) {
+      // Output ends with NL: drop the empty line after it.
+      tv_list_item_remove(list, last);
+      if (nread == 1) {
+        // a single NL is no output at all
+        tv_list_item_remove(list, tv_list_first(list));
       }
+    }
+    tv_list_set_ret(rettv, list);
+    return;
+  }
+
+  if (res == NULL) {
+    rettv->vval.v_string = xstrdup("");
+    return;
+  }
 
-      *d++ = *s;
+  // res may contain several NULs before the final terminating one.
+  // Replace them with SOH (1) like in get_cmd_output() to avoid truncation.
+  memchrsub(res, NUL, 1, nread);
+#ifdef USE_CRNL
+  // translate <CR><NL> into <NL>
+  char *d = res;
+  for (char *s = res; *s; s++) {
+    if (s[0] == CAR && s[1] == NL) {
+      s++;
     }
 
-    *d = NUL;
-#endif
-    rettv->vval.v_string = res;
+    *d++ = *s;
   }
+
+  *d = NUL;
+#endif
+  rettv->vval.v_string = res;
 }
 
 /// Get a callback from "arg".  It can be a Funcref or a function name.
@@ -6248,7 +6358,9 @@ uint64_t timer_start(const int64_t timeout, const int repeat_count, const Callba
   timer->callback = *callback;
 
   time_watcher_init(&main_loop, &timer->tw, timer);
-  timer->tw.events = multiqueue_new_child(main_loop.events);
+  // No private queue: the close event is queued after any pending due event,
+  // so it is still the last one to run.
+  timer->tw.events = main_loop.events;
   // if main loop is blocked, don't queue up multiple events
   timer->tw.blockable = true;
   time_watcher_start(&timer->tw, timer_due_cb, (uint64_t)timeout, (uint64_t)timeout);
@@ -6273,7 +6385,6 @@ void timer_stop(timer_T *timer)
 static void timer_close_cb(TimeWatcher *tw, void *data)
 {
   timer_T *timer = (timer_T *)data;
-  multiqueue_free(timer->tw.events);
   callback_free(&timer->callback);
   pmap_del(uint64_t)(&timers, (uint64_t)timer->timer_id, NULL);
   timer_decref(timer);
@@ -6315,28 +6426,31 @@ bool write_list(FileDescriptor *const fp, const list_T *const list, const bool b
     if (s == NULL) {
       return false;
     }
+    // A NL in the string is written as a NUL.
     const char *hunk_start = s;
-    for (const char *p = hunk_start;; p++) {
-      if (*p == NUL || *p == NL) {
-        if (p != hunk_start) {
-          const ptrdiff_t written = file_write(fp, hunk_start,
-                                               (size_t)(p - hunk_start));
-          if (written < 0) {
-            error = (int)written;
-            goto write_list_error;
-          }
-        }
-        if (*p == NUL) {
-          break;
-        } else {
-          hunk_start = p + 1;
-          const ptrdiff_t written = file_write(fp, (char[]){ NUL }, 1);
-          if (written < 0) {
-            error = (int)written;
-            break;
-          }
+    const char *const end = s + strlen(s);
+    while (true) {
+      const char *p = memchr(hunk_start, NL, (size_t)(end - hunk_start));
+      if (p == NULL) {
+        p = end;
+      }
+      if (p != hunk_start) {
+        const ptrdiff_t written = file_write(fp, hunk_start,
+                                             (size_t)(p - hunk_start));
+        if (written < 0) {
+          error = (int)written;
+          goto write_list_error;
         }
       }
+      if (p == end) {
+        break;
+      }
+      hunk_start = p + 1;
+      const ptrdiff_t written = file_write(fp, (char[]){ NUL }, 1);
+      if (written < 0) {
+        error = (int)written;
+        break;
+      }
     }
     if (!binary || TV_LIST_ITEM_NEXT(list, li) != NULL) {
       const ptrdiff_t written = file_write(fp, "\n", 1);
@@ -8725,7 +8839,9 @@ bool common_job_callbacks(dict_T *vopts, CallbackReader *on_stdout, CallbackRead
 {
   if (tv_dict_get_callback(vopts, S_LEN("on_stdout"), &on_stdout->cb)
       && tv_dict_get_callback(vopts, S_LEN("on_stderr"), &on_stderr->cb)
-      && tv_dict_get_callback(vopts, S_LEN("on_exit"), on_exit)) {
+      && tv_dict_get_callback(vopts, S_LEN("on_exit"), on_exit)
+      && job_output_buffer(vopts, "stdout_buffer", "on_stdout", on_stdout)
+      && job_output_buffer(vopts, "stderr_buffer", "on_stderr", on_stderr)) {
     on_stdout->buffered = tv_dict_get_number(vopts, "stdout_buffered");
     on_stderr->buffered = tv_dict_get_number(vopts, "stderr_buffered");
     if (on_stdout->buffered && on_stdout->cb.type == kCallbackNone) {
@@ -8744,6 +8860,30 @@ bool common_job_callbacks(dict_T *vopts, CallbackReader *on_stdout, CallbackRead
   return false;
 }
 
+/// Get the "stdout_buffer" or "stderr_buffer" job option into "reader".
+///
+/// @return false for an invalid value, an error was given then.
+static bool job_output_buffer(dict_T *vopts, const char *key, const char *cb_key,
+                              CallbackReader *reader)
+{
+  dictitem_T *const di = tv_dict_find(vopts, key, -1);
+  if (di == NULL) {
+    return true;
+  }
+  if (reader->cb.type != kCallbackNone) {
+    semsg(_("E475: Invalid argument: %s cannot be used with %s"), key, cb_key);
+    return false;
+  }
+  const varnumber_T nr = tv_get_number(&di->di_tv);
+  buf_T *const buf = nr == 0 ? curbuf : buflist_findnr((int)nr);
+  if (buf == NULL) {
+    semsg(_(e_nobufnr), (int64_t)nr);
+    return false;
+  }
+  reader->bufnr = buf->handle;
+  return true;
+}
+
 Channel *find_job(uint64_t id, bool show_error)
 {
   Channel *data = find_channel(id);
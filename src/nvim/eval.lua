@@ -5642,8 +5642,13 @@ M.funcs = {
         rpc:	      (boolean) Use |msgpack-rpc| to communicate with
       	      the job over stdio. Then `on_stdout` is ignored,
       	      but `on_stderr` can still be used.
+        stderr_buffer: (number) Like `stdout_buffer`, for stderr.
         stderr_buffered: (boolean) Collect data until EOF (stream closed)
       	      before invoking `on_stderr`. |channel-buffered|
+        stdout_buffer: (number) Append the lines of stdout to this
+      	      buffer instead of invoking a callback. Lines
+      	      replace an empty buffer. Cannot be used with
+      	      `on_stdout`. 0 for the current buffer.
         stdout_buffered: (boolean) Collect data until EOF (stream
       	      closed) before invoking `on_stdout`. |channel-buffered|
         stdin:      (string) Either "pipe" (default) to connect the
@@ -329,7 +329,11 @@ static inline int parse_json_string(const char *const buf, const size_t buf_len,
   const char *const s = ++p;
   int ret = OK;
   while (p < e && *p != '"') {
-    if (*p == '\\') {
+    if ((uint8_t)(*p) >= 0x20 && (uint8_t)(*p) < 0x80 && *p != '\\') {
+      // Plain ASCII character, most strings consist of only these.
+      len++;
+      p++;
+    } else if (*p == '\\') {
       p++;
       if (p == e) {
         semsg(_("E474: Unfinished escape sequence: %.*s"),
@@ -422,7 +426,14 @@ static inline int parse_json_string(const char *const buf, const size_t buf_len,
       (fst_in_pair) = 0; \
     } \
   } while (0)
-  for (const char *t = s; t < p; t++) {
+  // Every escape sequence is longer than what it stands for, without them
+  // the string can be copied as is.
+  const bool has_escapes = len != (size_t)(p - s);
+  if (!has_escapes) {
+    memcpy(str, s, len);
+    str_end += len;
+  }
+  for (const char *t = s; has_escapes && t < p; t++) {
     if (t[0] != '\\' || t[1] != 'u') {
       PUT_FST_IN_PAIR(fst_in_pair, str_end);
     }
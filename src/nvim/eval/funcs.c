@@ -5586,6 +5586,26 @@ static void f_readdir(typval_T *argvars, typval_T *rettv, EvalFuncData fptr)
 }
 
 /// "readfile()" or "readblob()" function
+/// Find the first byte in "p[end - p]" that readfile() has to handle: a NL, a
+/// NUL or, when not "binary", the last byte of a BOM.
+///
+/// @return  pointer to that byte or "end" if there is none.
+static char *readfile_find_special(char *p, char *end, bool binary)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_PURE
+{
+  char *found = memchr(p, '\n', (size_t)(end - p));
+  if (found != NULL) {
+    end = found;
+  }
+  if ((found = memchr(p, NUL, (size_t)(end - p))) != NULL) {
+    end = found;
+  }
+  if (!binary && (found = memchr(p, 0xbf, (size_t)(end - p))) != NULL) {
+    end = found;
+  }
+  return end;
+}
+
 static void read_file_or_blob(typval_T *argvars, typval_T *rettv, bool always_blob)
 {
   bool binary = false;
@@ -5655,6 +5675,12 @@ static void read_file_or_blob(typval_T *argvars, typval_T *rettv, bool always_bl
     for (p = buf, start = buf;
          p < buf + readlen || (readlen <= 0 && (prevlen > 0 || binary));
          p++) {
+      if (readlen > 0) {
+        p = readfile_find_special(p, buf + readlen, binary);
+        if (p == buf + readlen) {
+          break;
+        }
+      }
       if (readlen <= 0 || *p == '\n') {
         char *s = NULL;
         size_t len = (size_t)(p - start);
@@ -45,12 +45,17 @@ typedef struct {
   partial_T *item_compare_partial;
   dict_T *item_compare_selfdict;
   bool item_compare_func_err;
+  bool item_compare_keys;  ///< Use ListSortItem.key.
 } sortinfo_T;
 
 /// Structure representing one list item, used for sort array.
 typedef struct {
   listitem_T *item;  ///< Sorted list item.
   int idx;  ///< Sorted list item index.
+  union {
+    double nr;  ///< Item value for a numeric sort.
+    char *str;  ///< Item as a string if it is not a String, else NULL.
+  } key;  ///< Computed once per item, used when item_compare_keys is set.
 } ListSortItem;
 
 typedef int (*ListSorter)(const void *, const void *);
@@ -59,6 +64,9 @@ typedef int (*ListSorter)(const void *, const void *);
 # include "eval/typval.c.generated.h"
 #endif
 
+/// List items are allocated from a pool, as lists are created and freed a lot.
+static Pool listitem_pool = POOL_INIT(listitem_T);
+
 static const char e_variable_nested_too_deep_for_unlock[]
   = N_("E743: Variable nested too deep for (un)lock");
 static const char e_using_invalid_value_as_string[]
@@ -100,6 +108,10 @@ bool tv_in_free_unref_items = false;
 
 #define DICT_MAXNEST 100
 
+/// When tv_list_find() has to walk over more items than this, an array with
+/// all items is made for the list.
+#define TV_LIST_WALK_LIMIT 100
+
 const char *const tv_empty_string = "";
 
 //{{{1 Lists
@@ -114,7 +126,7 @@ const char *const tv_empty_string = "";
 static listitem_T *tv_list_item_alloc(void)
   FUNC_ATTR_NONNULL_RET FUNC_ATTR_MALLOC
 {
-  return xmalloc(sizeof(listitem_T));
+  return pool_alloc(&listitem_pool);
 }
 
 /// Remove a list item from a List and free it
@@ -132,7 +144,7 @@ listitem_T *tv_list_item_remove(list_T *const l, listitem_T *const item)
   listitem_T *const next_item = TV_LIST_ITEM_NEXT(l, item);
   tv_list_drop_items(l, item, item);
   tv_clear(TV_LIST_ITEM_TV(item));
-  xfree(item);
+  pool_free(&listitem_pool, item);
   return next_item;
 }
 
@@ -262,10 +274,11 @@ void tv_list_free_contents(list_T *const l)
     // Remove the item before deleting it.
     l->lv_first = item->li_next;
     tv_clear(&item->li_tv);
-    xfree(item);
+    pool_free(&listitem_pool, item);
   }
   l->lv_len = 0;
   l->lv_idx_item = NULL;
+  XFREE_CLEAR(l->lv_items);
   l->lv_last = NULL;
   assert(l->lv_watch == NULL);
 }
@@ -289,6 +302,7 @@ void tv_list_free_list(list_T *const l)
   }
 
   NLUA_CLEAR_REF(l->lua_table_ref);
+  xfree(l->lv_items);
   xfree(l);
 }
 
@@ -350,6 +364,7 @@ void tv_list_drop_items(list_T *const l, listitem_T *const item, listitem_T *con
     item->li_prev->li_next = item2->li_next;
   }
   l->lv_idx_item = NULL;
+  XFREE_CLEAR(l->lv_items);
 }
 
 /// Like tv_list_drop_items, but also frees all removed items
@@ -360,7 +375,7 @@ void tv_list_remove_items(list_T *const l, listitem_T *const item, listitem_T *c
   for (listitem_T *li = item;;) {
     tv_clear(TV_LIST_ITEM_TV(li));
     listitem_T *const nli = li->li_next;
-    xfree(li);
+    pool_free(&listitem_pool, li);
     if (li == item2) {
       break;
     }
@@ -389,6 +404,7 @@ void tv_list_move_items(list_T *const l, listitem_T *const item, listitem_T *con
   }
   tgt_l->lv_last = item2;
   tgt_l->lv_len += cnt;
+  XFREE_CLEAR(tgt_l->lv_items);
 }
 
 /// Insert list item
@@ -416,6 +432,7 @@ void tv_list_insert(list_T *const l, listitem_T *const ni, listitem_T *const ite
     }
     item->li_prev = ni;
     l->lv_len++;
+    XFREE_CLEAR(l->lv_items);
   }
 }
 
@@ -453,6 +470,7 @@ void tv_list_append(list_T *const l, listitem_T *const item)
   }
   l->lv_len++;
   item->li_next = NULL;
+  XFREE_CLEAR(l->lv_items);
 }
 
 /// Append Vimscript value to the end of list
@@ -599,7 +617,7 @@ list_T *tv_list_copy(const vimconv_T *const conv, list_T *const orig, const bool
     if (deep) {
       if (var_item_copy(conv, TV_LIST_ITEM_TV(item), TV_LIST_ITEM_TV(ni),
                         deep, copyID) == FAIL) {
-        xfree(ni);
+        pool_free(&listitem_pool, ni);
         goto tv_list_copy_error;
       }
     } else {
@@ -769,7 +787,7 @@ void tv_list_flatten(list_T *list, listitem_T *first, int64_t maxitems, int64_t
                         itemlist->lv_len, maxdepth - 1);
       }
       tv_clear(&item->li_tv);
-      xfree(item);
+      pool_free(&listitem_pool, item);
     }
 
     done++;
@@ -1055,7 +1073,7 @@ void tv_list_remove(typval_T *argvars, typval_T *rettv, const char *arg_errmsg)
       // Remove one item, return its value.
       tv_list_drop_items(l, item, item);
       *rettv = *TV_LIST_ITEM_TV(item);
-      xfree(item);
+      pool_free(&listitem_pool, item);
     } else {
       listitem_T *item2;
       // Remove range of items, return list with values.
@@ -1116,6 +1134,14 @@ static int item_compare(const void *s1, const void *s2, bool keep_zero)
     goto item_compare_end;
   }
 
+  if (sortinfo->item_compare_numeric && sortinfo->item_compare_keys) {
+    const double n1 = si1->key.nr;
+    const double n2 = si2->key.nr;
+
+    res = n1 == n2 ? 0 : n1 > n2 ? 1 : -1;
+    goto item_compare_end;
+  }
+
   char *tofree1 = NULL;
   char *tofree2 = NULL;
   char *p1;
@@ -1130,6 +1156,8 @@ static int item_compare(const void *s1, const void *s2, bool keep_zero)
     } else {
       p1 = tv1->vval.v_string;
     }
+  } else if (sortinfo->item_compare_keys) {
+    p1 = si1->key.str;
   } else {
     tofree1 = p1 = encode_tv2string(tv1, NULL);
   }
@@ -1139,6 +1167,8 @@ static int item_compare(const void *s1, const void *s2, bool keep_zero)
     } else {
       p2 = tv2->vval.v_string;
     }
+  } else if (sortinfo->item_compare_keys) {
+    p2 = si2->key.str;
   } else {
     tofree2 = p2 = encode_tv2string(tv2, NULL);
   }
@@ -1265,11 +1295,29 @@ static void do_sort(list_T *l, sortinfo_T *info)
   // Make an array with each entry pointing to an item in the List.
   ListSortItem *ptrs = xmalloc((size_t)((unsigned)len * sizeof(ListSortItem)));
 
+  // Converting items to a string or number for every comparison is
+  // expensive, do it once for each item.
+  info->item_compare_keys = info->item_compare_func == NULL
+                            && info->item_compare_partial == NULL
+                            && !info->item_compare_numbers
+                            && !info->item_compare_float;
+
   // f_sort(): ptrs will be the list to sort
   int i = 0;
   TV_LIST_ITER(l, li, {
     ptrs[i].item = li;
     ptrs[i].idx = i;
+    if (info->item_compare_keys) {
+      typval_T *const tv = TV_LIST_ITEM_TV(li);
+      char *const str = tv->v_type == VAR_STRING ? NULL : encode_tv2string(tv, NULL);
+      if (info->item_compare_numeric) {
+        // A String is compared as zero, like "'" in item_compare().
+        ptrs[i].key.nr = str == NULL ? 0 : strtod(str, NULL);
+        xfree(str);
+      } else {
+        ptrs[i].key.str = str;
+      }
+    }
     i++;
   });
 
@@ -1286,6 +1334,7 @@ static void do_sort(list_T *l, sortinfo_T *info)
     l->lv_first = NULL;
     l->lv_last = NULL;
     l->lv_idx_item = NULL;
+    XFREE_CLEAR(l->lv_items);
     l->lv_len = 0;
     for (i = 0; i < len; i++) {
       tv_list_append(l, ptrs[i].item);
@@ -1295,6 +1344,11 @@ static void do_sort(list_T *l, sortinfo_T *info)
     emsg(_("E702: Sort compare function failed"));
   }
 
+  if (info->item_compare_keys && !info->item_compare_numeric) {
+    for (i = 0; i < len; i++) {
+      xfree(ptrs[i].key.str);
+    }
+  }
   xfree(ptrs);
 }
 
@@ -1341,6 +1395,7 @@ static int parse_sort_uniq_args(typval_T *argvars, sortinfo_T *info)
   info->item_compare_func = NULL;
   info->item_compare_partial = NULL;
   info->item_compare_selfdict = NULL;
+  info->item_compare_keys = false;
 
   if (argvars[1].v_type == VAR_UNKNOWN) {
     return OK;
@@ -1512,6 +1567,7 @@ void tv_list_reverse(list_T *const l)
 #undef SWAP
 
   l->lv_idx = l->lv_len - l->lv_idx - 1;
+  XFREE_CLEAR(l->lv_items);
 }
 
 //{{{2 Indexing/searching
@@ -1524,7 +1580,7 @@ void tv_list_reverse(list_T *const l)
 ///
 /// @return Item at the given index or NULL if `n` is out of range.
 listitem_T *tv_list_find(list_T *const l, int n)
-  FUNC_ATTR_PURE FUNC_ATTR_WARN_UNUSED_RESULT
+  FUNC_ATTR_WARN_UNUSED_RESULT
 {
   STATIC_ASSERT(sizeof(n) == sizeof(l->lv_idx),
                 "n and lv_idx sizes do not match");
@@ -1537,6 +1593,10 @@ listitem_T *tv_list_find(list_T *const l, int n)
     return NULL;
   }
 
+  if (l->lv_items != NULL) {
+    return l->lv_items[n];
+  }
+
   int idx;
   listitem_T *item;
 
@@ -1567,6 +1627,7 @@ listitem_T *tv_list_find(list_T *const l, int n)
     }
   }
 
+  const int start_idx = idx;
   while (n > idx) {
     // Search forward.
     item = item->li_next;
@@ -1583,6 +1644,16 @@ listitem_T *tv_list_find(list_T *const l, int n)
   l->lv_idx = idx;
   l->lv_idx_item = item;
 
+  // Walking far through the list means it is not accessed in order, keep
+  // an array with the items so that further lookups don't need to walk.
+  if (abs(n - start_idx) > TV_LIST_WALK_LIMIT) {
+    l->lv_items = xmalloc(sizeof(listitem_T *) * (size_t)l->lv_len);
+    int i = 0;
+    for (listitem_T *li = l->lv_first; li != NULL; li = li->li_next) {
+      l->lv_items[i++] = li;
+    }
+  }
+
   return item;
 }
 
@@ -2722,15 +2793,17 @@ dict_T *tv_dict_copy(const vimconv_T *const conv, dict_T *const orig, const bool
     orig->dv_copyID = copyID;
     orig->dv_copydict = copy;
   }
-  TV_DICT_ITER(orig, di, {
+  const bool convert = conv != NULL && conv->vc_type != CONV_NONE;
+  HASHTAB_ITER(&orig->dv_hashtab, hi, {
     if (got_int) {
       break;
     }
+    dictitem_T *const di = TV_DICT_HI2DI(hi);
     dictitem_T *new_di;
-    if (conv == NULL || conv->vc_type == CONV_NONE) {
-      new_di = tv_dict_item_alloc(di->di_key);
+    size_t len = strlen(di->di_key);
+    if (!convert) {
+      new_di = tv_dict_item_alloc_len(di->di_key, len);
     } else {
-      size_t len = strlen(di->di_key);
       char *const key = string_convert(conv, di->di_key, &len);
       if (key == NULL) {
         new_di = tv_dict_item_alloc_len(di->di_key, len);
@@ -2748,7 +2821,12 @@ dict_T *tv_dict_copy(const vimconv_T *const conv, dict_T *const orig, const bool
     } else {
       tv_copy(&di->di_tv, &new_di->di_tv);
     }
-    if (tv_dict_add(copy, new_di) == FAIL) {
+    if (!convert) {
+      // The key is unique and valid, and its hash is already known.
+      hashitem_T *const new_hi = hash_lookup(&copy->dv_hashtab, new_di->di_key, len,
+                                             hi->hi_hash);
+      hash_add_item(&copy->dv_hashtab, new_hi, new_di->di_key, hi->hi_hash);
+    } else if (tv_dict_add(copy, new_di) == FAIL) {
       tv_dict_item_free(new_di);
       break;
     }
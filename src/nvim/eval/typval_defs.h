@@ -182,6 +182,7 @@ struct listvar_S {
   listitem_T *lv_last;  ///< Last item, NULL if none.
   listwatch_T *lv_watch;  ///< First watcher, NULL if none.
   listitem_T *lv_idx_item;  ///< When not NULL item at index "lv_idx".
+  listitem_T **lv_items;  ///< When not NULL array with all "lv_len" items.
   list_T *lv_copylist;  ///< Copied list used by deepcopy().
   list_T *lv_used_next;  ///< next list in used lists list.
   list_T *lv_used_prev;  ///< Previous list in used lists list.
@@ -208,6 +209,7 @@ typedef struct {
   .lv_len = 0, \
   .lv_watch = NULL, \
   .lv_idx_item = NULL, \
+  .lv_items = NULL, \
   .lv_lock = VAR_FIXED, \
   .lv_used_next = NULL, \
   .lv_used_prev = NULL, \
@@ -334,6 +336,8 @@ struct ufunc {
   garray_T uf_args;          ///< arguments
   garray_T uf_def_args;      ///< default argument expressions
   garray_T uf_lines;         ///< function lines
+  bool *uf_comment_lines;    ///< for each line whether it is a comment or empty
+                             ///< and can be skipped, NULL if not known
   int uf_profiling;     ///< true when func is being profiled
   int uf_prof_initialized;
   LuaRef uf_luaref;      ///< lua callback, used if (uf_flags & FC_LUAREF)
@@ -834,6 +834,7 @@ static void func_clear_items(ufunc_T *fp)
   ga_clear_strings(&(fp->uf_args));
   ga_clear_strings(&(fp->uf_def_args));
   ga_clear_strings(&(fp->uf_lines));
+  XFREE_CLEAR(fp->uf_comment_lines);
   XFREE_CLEAR(fp->uf_name_exp);
 
   if (fp->uf_flags & FC_LUAREF) {
@@ -1343,8 +1344,10 @@ static int call_user_func_check(ufunc_T *fp, int argcount, typval_T *argvars, ty
     error = FCERR_DICT;
   } else {
     // Call the user function.
+    AllocTag prev_tag = alloc_tag_push(kAllocTagEval);
     call_user_func(fp, argcount, argvars, rettv, funcexe->fe_firstline, funcexe->fe_lastline,
                    (fp->uf_flags & FC_DICT) ? selfdict : NULL);
+    alloc_tag_pop(prev_tag);
     error = FCERR_NONE;
   }
   return error;
@@ -1744,6 +1747,68 @@ theend:
   return ret;
 }
 
+/// Call a user function without arguments, skipping most of what call_func()
+/// has to check for.  Used for "expr" options that are evaluated very often.
+///
+/// @param funcname  name of the function
+/// @param len  length of "funcname"
+/// @param rettv  [out] value goes here
+///
+/// @return NOTDONE if the function is not (yet) defined, so that the caller
+///         falls back to evaluating the expression, otherwise OK or FAIL.
+int call_simple_func(const char *funcname, size_t len, typval_T *rettv)
+  FUNC_ATTR_NONNULL_ALL
+{
+  int ret = FAIL;
+  int error = FCERR_NONE;
+  char fname_buf[FLEN_FIXED + 1];
+  char *tofree = NULL;
+
+  rettv->v_type = VAR_NUMBER;  // default rettv is number zero
+  rettv->vval.v_number = 0;
+
+  // Make a copy of the name, an option can be changed in the function.
+  char *name = xmemdupz(funcname, len);
+  char *fname = fname_trans_sid(name, fname_buf, &tofree, &error);
+
+  // Ignore "g:" before a function name.
+  char *rfname = fname;
+  if (fname[0] == 'g' && fname[1] == ':') {
+    rfname = fname + 2;
+  }
+
+  ufunc_T *fp = error == FCERR_NONE ? find_func(rfname) : NULL;
+  if (fp == NULL && error == FCERR_NONE) {
+    // Builtin function, or a function that still has to be loaded.
+    ret = NOTDONE;
+  } else {
+    funcexe_T funcexe = FUNCEXE_INIT;
+    funcexe.fe_firstline = curwin->w_cursor.lnum;
+    funcexe.fe_lastline = curwin->w_cursor.lnum;
+    funcexe.fe_evaluate = true;
+
+    if (fp != NULL && (fp->uf_flags & FC_DELETED)) {
+      error = FCERR_DELETED;
+    } else if (fp != NULL) {
+      typval_T argvars[1];
+      argvars[0].v_type = VAR_UNKNOWN;
+      error = call_user_func_check(fp, 0, argvars, rettv, &funcexe, NULL);
+      update_force_abort();
+    }
+    if (error == FCERR_NONE) {
+      ret = OK;
+    }
+    if (!aborting()) {
+      user_func_error(error, name, &funcexe);
+    }
+  }
+
+  xfree(tofree);
+  xfree(name);
+
+  return ret;
+}
+
 char *printable_func_name(ufunc_T *fp)
 {
   return fp->uf_name_exp != NULL ? fp->uf_name_exp : fp->uf_name;
@@ -2134,6 +2199,7 @@ void ex_function(exarg_T *eap)
   garray_T newargs;
   garray_T default_args;
   garray_T newlines;
+  garray_T comment_lines = GA_EMPTY_INIT_VALUE;
   int varargs = false;
   int flags = 0;
   ufunc_T *fp;
@@ -2288,6 +2354,7 @@ void ex_function(exarg_T *eap)
 
   ga_init(&newargs, (int)sizeof(char *), 3);
   ga_init(&newlines, (int)sizeof(char *), 3);
+  ga_init(&comment_lines, (int)sizeof(bool), 3);
 
   if (!eap->skip) {
     // Check the name of the function.  Unless it's a dictionary function
@@ -2433,6 +2500,7 @@ void ex_function(exarg_T *eap)
       sourcing_lnum_off = 0;
     }
 
+    bool is_comment = false;
     if (skip_until != NULL) {
       // Don't check for ":endfunc" between
       // * ":append" and "."
@@ -2461,6 +2529,9 @@ void ex_function(exarg_T *eap)
       // skip ':' and blanks
       for (p = theline; ascii_iswhite(*p) || *p == ':'; p++) {}
 
+      // Lines of nested functions are read when defining them.
+      is_comment = nesting == 0 && (*p == '"' || *p == NUL);
+
       // Check for "endfunction".
       if (checkforcmd(&p, "endfunction", 4) && nesting-- == 0) {
         if (*p == '!') {
@@ -2604,11 +2675,14 @@ void ex_function(exarg_T *eap)
     // is an extra alloc/free.
     p = xstrdup(theline);
     ((char **)(newlines.ga_data))[newlines.ga_len++] = p;
+    ga_grow(&comment_lines, 1 + (int)sourcing_lnum_off);
+    ((bool *)(comment_lines.ga_data))[comment_lines.ga_len++] = is_comment;
 
     // Add NULL lines for continuation lines, so that the line count is
     // equal to the index in the growarray.
     while (sourcing_lnum_off-- > 0) {
       ((char **)(newlines.ga_data))[newlines.ga_len++] = NULL;
+      ((bool *)(comment_lines.ga_data))[comment_lines.ga_len++] = false;
     }
 
     // Check for end of eap->arg.
@@ -2745,6 +2819,8 @@ void ex_function(exarg_T *eap)
   fp->uf_args = newargs;
   fp->uf_def_args = default_args;
   fp->uf_lines = newlines;
+  fp->uf_comment_lines = comment_lines.ga_data;
+  ga_init(&comment_lines, (int)sizeof(bool), 1);
   if ((flags & FC_CLOSURE) != 0) {
     register_closure(fp);
   } else {
@@ -2771,6 +2847,7 @@ erret:
 errret_2:
   ga_clear_strings(&newlines);
 ret_free:
+  ga_clear(&comment_lines);
   xfree(skip_until);
   xfree(heredoc_trimmed);
   xfree(line_to_free);
@@ -3515,9 +3592,14 @@ char *get_func_line(int c, void *cookie, int indent, bool do_concat)
       || fcp->fc_returned) {
     retval = NULL;
   } else {
-    // Skip NULL lines (continuation lines).
+    // Skip NULL lines (continuation lines).  Also skip comments and empty
+    // lines, which do nothing, unless profiling or debugging may show them.
+    const bool *comments = (do_profiling != PROF_YES && debug_break_level < 0
+                            && fcp->fc_breakpoint == 0)
+                           ? fp->uf_comment_lines : NULL;
     while (fcp->fc_linenr < gap->ga_len
-           && ((char **)(gap->ga_data))[fcp->fc_linenr] == NULL) {
+           && (((char **)(gap->ga_data))[fcp->fc_linenr] == NULL
+               || (comments != NULL && comments[fcp->fc_linenr]))) {
       fcp->fc_linenr++;
     }
     if (fcp->fc_linenr >= gap->ga_len) {
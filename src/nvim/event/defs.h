@@ -11,6 +11,7 @@ typedef struct message {
   void *argv[EVENT_HANDLER_MAX_ARGC];
 } Event;
 typedef void (*event_scheduler)(Event event, void *data);
+typedef void (*work_cb)(void *data);
 
 #define VA_EVENT_INIT(event, h, a) \
   do { \
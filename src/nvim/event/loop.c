@@ -9,6 +9,14 @@
 #include "nvim/memory.h"
 #include "nvim/os/time.h"
 
+typedef struct {
+  uv_work_t req;
+  Loop *loop;
+  work_cb work;
+  argv_callback done;
+  void *data;
+} LoopWork;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "event/loop.c.generated.h"
 #endif
@@ -121,6 +129,47 @@ static void loop_deferred_event(void **argv)
   xfree(eventp);
 }
 
+/// Runs `work(data)` on the libuv thread pool, then `done` with `data` as
+/// argv[0] on `Loop.events`.
+///
+/// `work` runs concurrently with the editor: it must only touch `data`,
+/// which should be a private snapshot of whatever editor state it needs (no
+/// buffers, windows, options or Lua). `done` runs on the main thread and
+/// owns `data` afterwards. `done` is not called if the loop is closed before
+/// the work finished.
+void loop_queue_work(Loop *loop, work_cb work, argv_callback done, void *data)
+{
+  LoopWork *w = xmalloc(sizeof(*w));
+  w->loop = loop;
+  w->work = work;
+  w->done = done;
+  w->data = data;
+  w->req.data = w;
+  int status = uv_queue_work(&loop->uv, &w->req, loop_work_cb, loop_after_work_cb);
+  if (status != 0) {
+    // Can only fail for invalid arguments, do the work synchronously.
+    ELOG("uv_queue_work failed: %s", uv_strerror(status));
+    work(data);
+    multiqueue_put(loop->events, done, 1, data);
+    xfree(w);
+  }
+}
+
+static void loop_work_cb(uv_work_t *req)
+{
+  LoopWork *w = req->data;
+  w->work(w->data);
+}
+
+static void loop_after_work_cb(uv_work_t *req, int status)
+{
+  LoopWork *w = req->data;
+  if (!w->loop->closing) {
+    multiqueue_put(w->loop->events, w->done, 1, w->data);
+  }
+  xfree(w);
+}
+
 void loop_on_put(MultiQueue *queue, void *data)
 {
   Loop *loop = data;
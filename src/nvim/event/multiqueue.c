@@ -41,6 +41,13 @@
 // the event loop queue and poll job1 queue instead. Same with channels, when
 // calling `rpcrequest` we want to temporarily stop processing events from
 // other sources and focus on a specific channel.
+//
+// A child queue can be marked as high priority with multiqueue_set_priority().
+// Its link nodes go to a separate lane of the parent queue, which is drained
+// first, so events from e.g. an attached UI are not stuck behind a flood of
+// job output. After MULTIQUEUE_MAX_STREAK high priority events in a row one
+// normal event is processed, so that the normal lane can't starve. Ordering
+// within a child queue is never changed.
 
 #include <assert.h>
 #include <stdbool.h>
@@ -68,11 +75,16 @@ struct multiqueue_item {
 struct multiqueue {
   MultiQueue *parent;
   QUEUE headtail;  // circularly-linked
+  QUEUE priority;  // parent only: link nodes of high priority children
   PutCallback put_cb;
   void *data;
   size_t size;
+  int streak;  // parent only: high priority events removed in a row
+  bool high_priority;  // child only: link nodes go to parent->priority
 };
 
+#define MULTIQUEUE_MAX_STREAK 8
+
 typedef struct {
   Event event;
   bool fired;
@@ -102,7 +114,10 @@ static MultiQueue *multiqueue_new(MultiQueue *parent, PutCallback put_cb, void *
 {
   MultiQueue *rv = xmalloc(sizeof(MultiQueue));
   QUEUE_INIT(&rv->headtail);
+  QUEUE_INIT(&rv->priority);
   rv->size = 0;
+  rv->streak = 0;
+  rv->high_priority = false;
   rv->parent = parent;
   rv->put_cb = put_cb;
   rv->data = data;
@@ -122,6 +137,10 @@ void multiqueue_free(MultiQueue *self)
     QUEUE_REMOVE(q);
     xfree(item);
   })
+  QUEUE_FOREACH(q, &self->priority, {
+    QUEUE_REMOVE(q);
+    xfree(multiqueue_node_data(q));
+  })
 
   xfree(self);
 }
@@ -164,7 +183,28 @@ void multiqueue_purge_events(MultiQueue *self)
 bool multiqueue_empty(MultiQueue *self)
 {
   assert(self);
-  return QUEUE_EMPTY(&self->headtail);
+  return QUEUE_EMPTY(&self->headtail) && QUEUE_EMPTY(&self->priority);
+}
+
+/// Sets whether events of child queue `self` are processed before the normal
+/// events of its parent. Can be changed while `self` holds events.
+void multiqueue_set_priority(MultiQueue *self, bool high)
+{
+  assert(self->parent);
+  if (self->high_priority == high) {
+    return;
+  }
+  self->high_priority = high;
+  // The link nodes in the parent don't point to a specific event, only to
+  // "the next event in `self`", so moving them keeps the order of `self`.
+  QUEUE *lane = high ? &self->parent->priority : &self->parent->headtail;
+  QUEUE *q;
+  QUEUE_FOREACH(q, &self->headtail, {
+    MultiQueueItem *item = multiqueue_node_data(q);
+    QUEUE *link = &item->data.item.parent_item->node;
+    QUEUE_REMOVE(link);
+    QUEUE_INSERT_TAIL(lane, link);
+  })
 }
 
 void multiqueue_replace_parent(MultiQueue *self, MultiQueue *new_parent)
@@ -213,7 +253,15 @@ static Event multiqueueitem_get_event(MultiQueueItem *item, bool remove)
 static Event multiqueue_remove(MultiQueue *self)
 {
   assert(!multiqueue_empty(self));
-  QUEUE *h = QUEUE_HEAD(&self->headtail);
+  QUEUE *h;
+  if (!QUEUE_EMPTY(&self->priority)
+      && (self->streak < MULTIQUEUE_MAX_STREAK || QUEUE_EMPTY(&self->headtail))) {
+    h = QUEUE_HEAD(&self->priority);
+    self->streak++;
+  } else {
+    h = QUEUE_HEAD(&self->headtail);
+    self->streak = 0;
+  }
   QUEUE_REMOVE(h);
   MultiQueueItem *item = multiqueue_node_data(h);
   assert(!item->link || !self->parent);  // Only a parent queue has link-nodes
@@ -235,7 +283,7 @@ static void multiqueue_push(MultiQueue *self, Event event)
     item->data.item.parent_item = xmalloc(sizeof(MultiQueueItem));
     item->data.item.parent_item->link = true;
     item->data.item.parent_item->data.queue = self;
-    QUEUE_INSERT_TAIL(&self->parent->headtail,
+    QUEUE_INSERT_TAIL(self->high_priority ? &self->parent->priority : &self->parent->headtail,
                       &item->data.item.parent_item->node);
   }
   self->size++;
@@ -82,13 +82,24 @@ static void on_rbuffer_nonfull(RBuffer *buf, void *data)
 
 // Callbacks used by libuv
 
+/// Gets the space to read into. When all data was consumed, the buffer is
+/// rewound first, so that the read gets the whole capacity instead of the
+/// tail fragment before the wraparound point.
+static char *rstream_write_ptr(Stream *stream, size_t *write_count)
+{
+  if (rbuffer_size(stream->buffer) == 0) {
+    rbuffer_reset(stream->buffer);  // no data to move, only resets pointers
+  }
+  return rbuffer_write_ptr(stream->buffer, write_count);
+}
+
 /// Called by libuv to allocate memory for reading.
 static void alloc_cb(uv_handle_t *handle, size_t suggested, uv_buf_t *buf)
 {
   Stream *stream = handle->data;
   // `uv_buf_t.len` happens to have different size on Windows.
   size_t write_count;
-  buf->base = rbuffer_write_ptr(stream->buffer, &write_count);
+  buf->base = rstream_write_ptr(stream, &write_count);
   buf->len = UV_BUF_LEN(write_count);
 }
 
@@ -143,7 +154,7 @@ static void fread_idle_cb(uv_idle_t *handle)
 
   // `uv_buf_t.len` happens to have different size on Windows.
   size_t write_count;
-  stream->uvbuf.base = rbuffer_write_ptr(stream->buffer, &write_count);
+  stream->uvbuf.base = rstream_write_ptr(stream, &write_count);
   stream->uvbuf.len = UV_BUF_LEN(write_count);
 
   // the offset argument to uv_fs_read is int64_t, could someone really try
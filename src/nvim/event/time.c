@@ -16,6 +16,7 @@ void time_watcher_init(Loop *loop, TimeWatcher *watcher, void *data)
   watcher->data = data;
   watcher->events = loop->fast_events;
   watcher->blockable = false;
+  watcher->pending = false;
 }
 
 void time_watcher_start(TimeWatcher *watcher, time_cb cb, uint64_t timeout, uint64_t repeat)
@@ -41,6 +42,7 @@ void time_watcher_close(TimeWatcher *watcher, time_cb cb)
 static void time_event(void **argv)
 {
   TimeWatcher *watcher = argv[0];
+  watcher->pending = false;
   watcher->cb(watcher, watcher->data);
 }
 
@@ -48,9 +50,12 @@ static void time_watcher_cb(uv_timer_t *handle)
   FUNC_ATTR_NONNULL_ALL
 {
   TimeWatcher *watcher = handle->data;
-  if (watcher->blockable && !multiqueue_empty(watcher->events)) {
-    // the timer blocked and there already is an unprocessed event waiting
-    return;
+  if (watcher->blockable) {
+    if (watcher->pending) {
+      // the timer blocked and there already is an unprocessed event waiting
+      return;
+    }
+    watcher->pending = watcher->events != NULL;
   }
   CREATE_EVENT(watcher->events, time_event, 1, watcher);
 }
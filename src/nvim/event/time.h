@@ -16,7 +16,8 @@ struct time_watcher {
   void *data;
   time_cb cb, close_cb;
   MultiQueue *events;
-  bool blockable;
+  bool blockable;  ///< don't queue another event while one is pending
+  bool pending;  ///< a time event for this watcher is queued
 };
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
@@ -336,11 +336,6 @@ static int linelen(int *has_tab)
   return len;
 }
 
-// Buffer for two lines used during sorting.  They are allocated to
-// contain the longest line being sorted.
-static char *sortbuf1;
-static char *sortbuf2;
-
 static int sort_lc;       ///< sort using locale
 static int sort_ic;       ///< ignore case
 static int sort_nr;       ///< sort on number
@@ -353,10 +348,7 @@ static int sort_abort;    ///< flag to indicate if sorting has been interrupted
 typedef struct {
   linenr_T lnum;          ///< line number
   union {
-    struct {
-      varnumber_T start_col_nr;  ///< starting column number
-      varnumber_T end_col_nr;    ///< ending column number
-    } line;
+    char *key;            ///< text to sort on, if sorting by string
     struct {
       varnumber_T value;         ///< value if sorting by integer
       bool is_number;            ///< true when line contains a number
@@ -407,17 +399,7 @@ static int sort_compare(const void *s1, const void *s2)
              ? 0 : l1.st_u.value_flt > l2.st_u.value_flt
              ? 1 : -1;
   } else {
-    // We need to copy one line into "sortbuf1", because there is no
-    // guarantee that the first pointer becomes invalid when obtaining the
-    // second one.
-    memcpy(sortbuf1, ml_get(l1.lnum) + l1.st_u.line.start_col_nr,
-           (size_t)(l1.st_u.line.end_col_nr - l1.st_u.line.start_col_nr + 1));
-    sortbuf1[l1.st_u.line.end_col_nr - l1.st_u.line.start_col_nr] = NUL;
-    memcpy(sortbuf2, ml_get(l2.lnum) + l2.st_u.line.start_col_nr,
-           (size_t)(l2.st_u.line.end_col_nr - l2.st_u.line.start_col_nr + 1));
-    sortbuf2[l2.st_u.line.end_col_nr - l2.st_u.line.start_col_nr] = NUL;
-
-    result = string_compare(sortbuf1, sortbuf2);
+    result = string_compare(l1.st_u.key, l2.st_u.key);
   }
 
   // If two lines have the same value, preserve the original line order.
@@ -431,7 +413,6 @@ static int sort_compare(const void *s1, const void *s2)
 void ex_sort(exarg_T *eap)
 {
   regmatch_T regmatch;
-  int maxlen = 0;
   size_t count = (size_t)(eap->line2 - eap->line1) + 1;
   size_t i;
   bool unique = false;
@@ -445,10 +426,12 @@ void ex_sort(exarg_T *eap)
   if (u_save((linenr_T)(eap->line1 - 1), (linenr_T)(eap->line2 + 1)) == FAIL) {
     return;
   }
-  sortbuf1 = NULL;
-  sortbuf2 = NULL;
   regmatch.regprog = NULL;
   sorti_T *nrs = xmalloc(count * sizeof(sorti_T));
+  // Copies of the lines, in the original order.  They are put back with a
+  // single ml_append_buf_lines() call after sorting.
+  char **lines = xmalloc(count * sizeof(char *));
+  Arena arena = ARENA_EMPTY;
 
   sort_abort = sort_ic = sort_lc = sort_rx = sort_nr = sort_flt = 0;
   size_t format_found = 0;
@@ -523,18 +506,15 @@ void ex_sort(exarg_T *eap)
   // sorting.
   sort_nr += sort_what;
 
-  // Make an array with all line numbers.  This avoids having to copy all
-  // the lines into allocated memory.
-  // When sorting on strings "start_col_nr" is the offset in the line, for
-  // numbers sorting it's the number to sort on.  This means the pattern
-  // matching and number conversion only has to be done once per line.
-  // Also get the longest line length for allocating "sortbuf".
+  // Make an array with all line numbers and the key to sort on: the text
+  // for sorting on strings, or the number.  This means the pattern matching,
+  // number conversion and memline access only has to be done once per line,
+  // not for every comparison.
   for (linenr_T lnum = eap->line1; lnum <= eap->line2; lnum++) {
-    char *s = ml_get(lnum);
-    int len = (int)strlen(s);
-    if (maxlen < len) {
-      maxlen = len;
-    }
+    char *line = ml_get(lnum);
+    int len = (int)strlen(line);
+    char *s = arena_memdupz(&arena, line, (size_t)len);
+    lines[lnum - eap->line1] = s;
 
     colnr_T start_col = 0;
     colnr_T end_col = len;
@@ -592,9 +572,11 @@ void ex_sort(exarg_T *eap)
       }
       *s2 = c;
     } else {
-      // Store the column to sort at.
-      nrs[lnum - eap->line1].st_u.line.start_col_nr = start_col;
-      nrs[lnum - eap->line1].st_u.line.end_col_nr = end_col;
+      // Store the text to sort on.
+      nrs[lnum - eap->line1].st_u.key
+        = end_col == len ? s + start_col
+                         : arena_memdupz(&arena, s + start_col,
+                                         (size_t)MAX(end_col - start_col, 0));
     }
 
     nrs[lnum - eap->line1].lnum = lnum;
@@ -607,10 +589,6 @@ void ex_sort(exarg_T *eap)
     }
   }
 
-  // Allocate a buffer that can hold the longest line.
-  sortbuf1 = xmalloc((size_t)maxlen + 1);
-  sortbuf2 = xmalloc((size_t)maxlen + 1);
-
   // Sort the array of line numbers.  Note: can't be interrupted!
   qsort((void *)nrs, count, sizeof(sorti_T), sort_compare);
 
@@ -620,37 +598,33 @@ void ex_sort(exarg_T *eap)
 
   bcount_t old_count = 0, new_count = 0;
 
-  // Insert the lines in the sorted order below the last one.
-  linenr_T lnum = eap->line2;
+  // Collect the lines in the sorted order, then insert them below the last
+  // one at once.
+  char **sorted = xmalloc(count * sizeof(char *));
+  size_t n_sorted = 0;
   for (i = 0; i < count; i++) {
     const linenr_T get_lnum = nrs[eap->forceit ? count - i - 1 : i].lnum;
 
     // If the original line number of the line being placed is not the same
-    // as "lnum" (accounting for offset), we know that the buffer changed.
-    if (get_lnum + ((linenr_T)count - 1) != lnum) {
+    // as its new line number, we know that the buffer changed.
+    if (get_lnum != eap->line1 + (linenr_T)n_sorted) {
       change_occurred = true;
     }
 
-    char *s = ml_get(get_lnum);
+    char *s = lines[get_lnum - eap->line1];
     size_t bytelen = strlen(s) + 1;  // include EOL in bytelen
     old_count += (bcount_t)bytelen;
-    if (!unique || i == 0 || string_compare(s, sortbuf1) != 0) {
-      // Copy the line into a buffer, it may become invalid in
-      // ml_append(). And it's needed for "unique".
-      STRCPY(sortbuf1, s);
-      if (ml_append(lnum++, sortbuf1, 0, false) == FAIL) {
-        break;
-      }
+    if (!unique || i == 0 || string_compare(s, sorted[n_sorted - 1]) != 0) {
+      sorted[n_sorted++] = s;
       new_count += (bcount_t)bytelen;
     }
-    fast_breakcheck();
-    if (got_int) {
-      goto sortend;
-    }
   }
+  int appended = ml_append_buf_lines(curbuf, eap->line2, sorted, (int)n_sorted, false);
+  xfree(sorted);
+  linenr_T lnum = eap->line2 + appended;
 
   // delete the original lines if appending worked
-  if (i == count) {
+  if (appended == (int)n_sorted) {
     for (i = 0; i < count; i++) {
       ml_delete(eap->line1, false);
     }
@@ -680,8 +654,8 @@ void ex_sort(exarg_T *eap)
 
 sortend:
   xfree(nrs);
-  xfree(sortbuf1);
-  xfree(sortbuf2);
+  xfree(lines);
+  arena_mem_free(arena_finish(&arena));
   vim_regfree(regmatch.regprog);
   if (got_int) {
     emsg(_(e_interr));
@@ -3469,12 +3443,18 @@ static int do_sub(exarg_T *eap, const proftime_T timeout, const int cmdpreview_n
   }
 
   // Check for a match on each line.
-  // If preview: limit to max('cmdwinheight', viewport).
+  // If preview: limit to max('cmdwinheight', viewport). Without a preview
+  // window only the viewport is needed, and the window height after the
+  // first match below the cursor, which show_sub() moves the cursor to.
   linenr_T line2 = eap->line2;
+  linenr_T preview_botline = 0;
 
   for (linenr_T lnum = eap->line1;
        lnum <= line2 && !got_quit && !aborting()
-       && (cmdpreview_ns <= 0 || preview_lines.lines_needed <= (linenr_T)p_cwh
+       && (cmdpreview_ns <= 0
+           || (cmdpreview_bufnr != 0
+               ? preview_lines.lines_needed <= (linenr_T)p_cwh
+               : preview_botline == 0 || lnum <= preview_botline)
            || lnum <= curwin->w_botline);
        lnum++) {
     int nmatch = vim_regexec_multi(&regmatch, curwin, curbuf, lnum,
@@ -4160,6 +4140,11 @@ skip:
       XFREE_CLEAR(sub_firstline);    // free the copy of the original line
     }
 
+    if (cmdpreview_ns > 0 && preview_botline == 0 && preview_lines.subresults.size > 0
+        && kv_last(preview_lines.subresults).start.lnum >= old_cursor.lnum) {
+      preview_botline = kv_last(preview_lines.subresults).start.lnum + curwin->w_height_inner;
+    }
+
     line_breakcheck();
 
     if (profile_passed_limit(timeout)) {
@@ -4460,7 +4445,7 @@ void global_exe(char *cmd)
 
   while (!got_int && (lnum = ml_firstmarked()) != 0 && global_busy == 1) {
     global_exe_one(cmd, lnum);
-    os_breakcheck();
+    timed_breakcheck();
   }
 
   global_busy = 0;
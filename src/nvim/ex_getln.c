@@ -856,6 +856,7 @@ static uint8_t *command_line_enter(int firstc, int count, int indent, bool clear
   s->wim_index = 0;
 
   ExpandCleanup(&s->xpc);
+  cmdexpand_cache_clear();
   ccline.xpc = NULL;
 
   finish_incsearch_highlighting(s->gotesc, &s->is_state, false);
@@ -46,6 +46,48 @@
 # include "extmark.c.generated.h"
 #endif
 
+/// Computes the marktree flags of a new extmark.
+///
+/// @param[in,out] decor  replaced by an allocated copy if it must be stored
+///                       in the mark, which is then indicated by "decor_full".
+static uint16_t extmark_flags(Decoration **decor, bool *decor_full, uint8_t *decor_level,
+                              bool right_gravity, bool no_undo, bool invalidate)
+{
+  bool hl_eol = false;
+  *decor_level = kDecorLevelNone;  // no decor
+  if (*decor) {
+    Decoration *d = *decor;
+    if (kv_size(d->virt_text)
+        || kv_size(d->virt_lines)
+        || d->conceal
+        || decor_has_sign(d)
+        || d->ui_watched
+        || d->spell != kNone) {
+      *decor_full = true;
+      *decor = xmemdup(d, sizeof *d);
+    }
+    *decor_level = kDecorLevelVisible;  // decor affects redraw
+    hl_eol = d->hl_eol;
+    if (kv_size(d->virt_lines)) {
+      *decor_level = kDecorLevelVirtLine;  // decor affects horizontal size
+    }
+  }
+  return mt_flags(right_gravity, hl_eol, no_undo, invalidate, *decor_level);
+}
+
+static MTKey extmark_key(uint32_t ns_id, uint32_t id, int row, colnr_T col, uint16_t flags,
+                         Decoration *decor, bool decor_full)
+{
+  MTKey mark = { { row, col }, ns_id, id, 0, flags, 0, NULL };
+  if (decor_full) {
+    mark.decor_full = decor;
+  } else if (decor) {
+    mark.hl_id = decor->hl_id;
+    mark.priority = decor->priority;
+  }
+  return mark;
+}
+
 /// Create or update an extmark
 ///
 /// must not be used during iteration!
@@ -56,26 +98,9 @@ void extmark_set(buf_T *buf, uint32_t ns_id, uint32_t *idp, int row, colnr_T col
   uint32_t *ns = map_put_ref(uint32_t, uint32_t)(buf->b_extmark_ns, ns_id, NULL, NULL);
   uint32_t id = idp ? *idp : 0;
   bool decor_full = false;
-  bool hl_eol = false;
-
-  uint8_t decor_level = kDecorLevelNone;  // no decor
-  if (decor) {
-    if (kv_size(decor->virt_text)
-        || kv_size(decor->virt_lines)
-        || decor->conceal
-        || decor_has_sign(decor)
-        || decor->ui_watched
-        || decor->spell != kNone) {
-      decor_full = true;
-      decor = xmemdup(decor, sizeof *decor);
-    }
-    decor_level = kDecorLevelVisible;  // decor affects redraw
-    hl_eol = decor->hl_eol;
-    if (kv_size(decor->virt_lines)) {
-      decor_level = kDecorLevelVirtLine;  // decor affects horizontal size
-    }
-  }
-  uint16_t flags = mt_flags(right_gravity, hl_eol, no_undo, invalidate, decor_level);
+  uint8_t decor_level;
+  uint16_t flags = extmark_flags(&decor, &decor_full, &decor_level, right_gravity, no_undo,
+                                 invalidate);
 
   if (id == 0) {
     id = ++*ns;
@@ -118,14 +143,7 @@ void extmark_set(buf_T *buf, uint32_t ns_id, uint32_t *idp, int row, colnr_T col
     }
   }
 
-  MTKey mark = { { row, col }, ns_id, id, 0, flags, 0, NULL };
-  if (decor_full) {
-    mark.decor_full = decor;
-  } else if (decor) {
-    mark.hl_id = decor->hl_id;
-    mark.priority = decor->priority;
-  }
-
+  MTKey mark = extmark_key(ns_id, id, row, col, flags, decor, decor_full);
   marktree_put(buf->b_marktree, mark, end_row, end_col, end_right_gravity);
 
 revised:
@@ -143,6 +161,38 @@ error:
   }
 }
 
+/// Create a new extmark, but only queue it for insertion into the marktree.
+///
+/// Like extmark_set() with a zero id. The queued marks are inserted at once with
+/// extmark_put_batch(), which must be called before the marks are used.
+///
+/// @return the id of the new mark
+uint32_t extmark_queue(buf_T *buf, ExtmarkInfoArray *batch, uint32_t ns_id, int row,
+                       colnr_T col, int end_row, colnr_T end_col, Decoration *decor,
+                       bool right_gravity, bool end_right_gravity, bool no_undo,
+                       bool invalidate)
+{
+  uint32_t *ns = map_put_ref(uint32_t, uint32_t)(buf->b_extmark_ns, ns_id, NULL, NULL);
+  uint32_t id = ++*ns;
+  bool decor_full = false;
+  uint8_t decor_level;
+  uint16_t flags = extmark_flags(&decor, &decor_full, &decor_level, right_gravity, no_undo,
+                                 invalidate);
+
+  MTKey mark = extmark_key(ns_id, id, row, col, flags, decor, decor_full);
+  kv_push(*batch, ((MTPair){ .start = mark, .end_pos = { end_row, end_col },
+                             .end_right_gravity = end_right_gravity }));
+  decor_add(buf, row, end_row, decor, decor && decor->hl_id);
+  return id;
+}
+
+/// Insert the marks queued by extmark_queue() and clear "batch".
+void extmark_put_batch(buf_T *buf, ExtmarkInfoArray *batch)
+{
+  marktree_put_batch(buf->b_marktree, batch->items, kv_size(*batch));
+  kv_size(*batch) = 0;
+}
+
 static bool extmark_setraw(buf_T *buf, uint64_t mark, int row, colnr_T col)
 {
   MarkTreeIter itr[1] = { 0 };
@@ -228,7 +278,7 @@ bool extmark_clear(buf_T *buf, uint32_t ns_id, int l_row, colnr_T l_col, int u_r
       marks_cleared = true;
       extmark_del(buf, itr, mark, true);
     } else {
-      marktree_itr_next(buf->b_marktree, itr);
+      marktree_itr_next_ns(buf->b_marktree, itr, ns_id);
     }
   }
 
@@ -282,6 +332,8 @@ ExtmarkInfoArray extmark_get(buf_T *buf, uint32_t ns_id, int l_row, colnr_T l_co
 next_mark:
     if (reverse) {
       marktree_itr_prev(buf->b_marktree, itr);
+    } else if (ns_id != UINT32_MAX) {
+      marktree_itr_next_ns(buf->b_marktree, itr, ns_id);
     } else {
       marktree_itr_next(buf->b_marktree, itr);
     }
@@ -337,6 +389,8 @@ MTPair extmark_from_id(buf_T *buf, uint32_t ns_id, uint32_t id)
 /// free extmarks from the buffer
 void extmark_free_all(buf_T *buf)
 {
+  decor_overlap_cache_free(buf);
+
   if (!map_size(buf->b_extmark_ns)) {
     return;
   }
@@ -537,7 +591,18 @@ void extmark_splice(buf_T *buf, int start_row, colnr_T start_col, int old_row, c
                     bcount_t old_byte, int new_row, colnr_T new_col, bcount_t new_byte,
                     ExtmarkOp undo)
 {
-  int offset = ml_find_line_or_offset(buf, start_row + 1, NULL, true);
+  extmark_splice_impl(buf, start_row, start_col, extmark_row_byte(buf, start_row) + start_col,
+                      old_row, old_col, old_byte, new_row, new_col, new_byte,
+                      undo);
+}
+
+/// Byte offset of the start of row "row", as passed to on_bytes callbacks.
+///
+/// Callers that splice many consecutive rows (block mode operations) use this
+/// once and then advance the offset themselves, see extmark_splice_cols_at().
+bcount_t extmark_row_byte(buf_T *buf, int row)
+{
+  int offset = ml_find_line_or_offset(buf, row + 1, NULL, true);
 
   // On empty buffers, when editing the first line, the line is buffered,
   // causing offset to be < 0. While the buffer is not actually empty, the
@@ -548,9 +613,7 @@ void extmark_splice(buf_T *buf, int start_row, colnr_T start_col, int old_row, c
   if (offset < 0 && buf->b_ml.ml_chunksize == NULL) {
     offset = 0;
   }
-  extmark_splice_impl(buf, start_row, start_col, offset + start_col,
-                      old_row, old_col, old_byte, new_row, new_col, new_byte,
-                      undo);
+  return offset;
 }
 
 void extmark_splice_impl(buf_T *buf, int start_row, colnr_T start_col, bcount_t start_byte,
@@ -657,6 +720,16 @@ void extmark_splice_cols(buf_T *buf, int start_row, colnr_T start_col, colnr_T o
                  0, new_col, new_col, undo);
 }
 
+/// Like extmark_splice_cols(), but with the byte offset "row_byte" of the start
+/// of "start_row" already known, see extmark_row_byte().
+void extmark_splice_cols_at(buf_T *buf, int start_row, bcount_t row_byte, colnr_T start_col,
+                            colnr_T old_col, colnr_T new_col, ExtmarkOp undo)
+{
+  extmark_splice_impl(buf, start_row, start_col, row_byte + start_col,
+                      0, old_col, old_col,
+                      0, new_col, new_col, undo);
+}
+
 void extmark_move_region(buf_T *buf, int start_row, colnr_T start_col, bcount_t start_byte,
                          int extent_row, colnr_T extent_col, bcount_t extent_byte, int new_row,
                          colnr_T new_col, bcount_t new_byte, ExtmarkOp undo)
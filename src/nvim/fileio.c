@@ -79,10 +79,22 @@
 # define UV_FS_COPYFILE_FICLONE 0
 #endif
 
+/// File info of a buffer, see prefetch_fileinfo().
+typedef struct {
+  uv_fs_t req;
+  int fnum;             ///< buffer number, 0 if stat() could not be started
+  char *fname;
+  bool ok;              ///< stat() succeeded
+  FileInfo file_info;
+} PrefetchedFileInfo;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "fileio.c.generated.h"
 #endif
 
+static PrefetchedFileInfo *prefetched = NULL;
+static size_t prefetched_count = 0;
+
 static const char *e_auchangedbuf = N_("E812: Autocommands changed buffer or buffer name");
 
 void filemess(buf_T *buf, char *name, char *s, int attr)
@@ -166,6 +178,7 @@ int readfile(char *fname, char *sfname, linenr_T from, linenr_T lines_to_skip,
   linenr_T lnum = from;
   char *ptr = NULL;              // pointer into read buffer
   char *buffer = NULL;           // read buffer
+  size_t buffer_size = 0;        // allocated size of "buffer"
   char *new_buffer = NULL;       // init to shut up gcc
   char *line_start = NULL;       // init to shut up gcc
   int wasempty;                         // buffer was empty before reading
@@ -889,21 +902,33 @@ retry:
         *ptr = NL;  // split line by inserting a NL
         size = 1;
       } else if (!skip_read) {
-        for (; size >= 10; size /= 2) {
-          new_buffer = verbose_try_malloc((size_t)size + (size_t)linerest + 1);
-          if (new_buffer) {
+        if ((size_t)size + (size_t)linerest + 1 <= buffer_size) {
+          // The previous buffer is big enough: only move the incomplete
+          // last line to the front instead of allocating a new buffer for
+          // every chunk.  Matters for huge files, which are read in
+          // thousands of chunks.
+          if (linerest) {
+            memmove(buffer, ptr - linerest, (size_t)linerest);
+          }
+        } else {
+          for (; size >= 10; size /= 2) {
+            new_buffer = verbose_try_malloc((size_t)size + (size_t)linerest + 1);
+            if (new_buffer) {
+              break;
+            }
+          }
+          if (new_buffer == NULL) {
+            error = true;
             break;
           }
+          if (linerest) {         // copy characters from the previous buffer
+            memmove(new_buffer, ptr - linerest, (size_t)linerest);
+          }
+          xfree(buffer);
+          buffer = new_buffer;
+          buffer_size = (size_t)size + (size_t)linerest + 1;
+          new_buffer = NULL;
         }
-        if (new_buffer == NULL) {
-          error = true;
-          break;
-        }
-        if (linerest) {         // copy characters from the previous buffer
-          memmove(new_buffer, ptr - linerest, (size_t)linerest);
-        }
-        xfree(buffer);
-        buffer = new_buffer;
         ptr = buffer + linerest;
         line_start = buffer;
 
@@ -1306,8 +1331,12 @@ retry:
               }
             }
           }
+          // produce UTF-8, ASCII is by far the most common
+          if (u8c < 0x80) {
+            *--dest = (char)u8c;
+            continue;
+          }
           assert(u8c <= INT_MAX);
-          // produce UTF-8
           dest -= utf_char2len((int)u8c);
           (void)utf_char2bytes((int)u8c, dest);
         }
@@ -1327,6 +1356,15 @@ retry:
           if (todo <= 0) {
             break;
           }
+          // Skip over ASCII text eight bytes at a time.
+          if (todo >= 8) {
+            uint64_t word;
+            memcpy(&word, p, sizeof(word));
+            if ((word & 0x8080808080808080ULL) == 0) {
+              p += sizeof(word) - 1;
+              continue;
+            }
+          }
           if (*p >= 0x80) {
             // A length of 1 means it's an illegal byte.  Accept
             // an incomplete character at the end though, the next
@@ -1410,7 +1448,14 @@ rewind_retry:
             try_mac = 1;
           }
 
-          for (p = (uint8_t *)ptr; p < (uint8_t *)ptr + size; p++) {
+          // Without "mac" in 'fileformats' CRs don't need to be counted,
+          // let memchr() find the first NL.
+          p = (uint8_t *)ptr;
+          if (!try_mac) {
+            uint8_t *nl = memchr(ptr, NL, (size_t)size);
+            p = nl != NULL ? nl : (uint8_t *)ptr + size;
+          }
+          for (; p < (uint8_t *)ptr + size; p++) {
             if (*p == NL) {
               if (!try_unix
                   || (try_dos && p > (uint8_t *)ptr && p[-1] == CAR)) {
@@ -1506,7 +1551,16 @@ rewind_retry:
       ptr--;
       while (++ptr, --size >= 0) {
         if ((c = *ptr) != NUL && c != NL) {        // catch most common case
-          continue;
+          // Jump to the next NUL or NL, or to the end of the buffer.
+          char *eol = find_nl_or_nul(ptr, (size_t)size + 1);
+          if (eol == NULL) {
+            ptr += size;
+            size = 0;
+            continue;
+          }
+          size -= eol - ptr;
+          ptr = eol;
+          c = *ptr;
         }
         if (c == NUL) {
           *ptr = NL;            // NULs are replaced by newlines!
@@ -1895,6 +1949,19 @@ bool is_dev_fd_file(char *fname)
 }
 #endif
 
+/// Find the first NL or NUL in "len" bytes at "p".
+///
+/// Uses memchr(), which is much faster than looking at each byte, as most
+/// files have no NULs at all.
+///
+/// @return  pointer to the character or NULL when there is none.
+static char *find_nl_or_nul(char *p, size_t len)
+{
+  char *nl = memchr(p, NL, len);
+  char *nul = memchr(p, NUL, nl == NULL ? len : (size_t)(nl - p));
+  return nul != NULL ? nul : nl;
+}
+
 /// From the current line count and characters read after that, estimate the
 /// line number where we are now.
 /// Used for error messages that include a line number.
@@ -2785,6 +2852,7 @@ int check_timestamps(int focus)
     no_wait_return++;
     did_check_timestamps = true;
     already_warned = false;
+    prefetch_fileinfo();
     FOR_ALL_BUFFERS(buf) {
       // Only check buffers in a window.
       if (buf->b_nwindows > 0) {
@@ -2794,6 +2862,10 @@ int check_timestamps(int focus)
         if (didit < n) {
           didit = n;
         }
+        if (n > 0) {
+          // Autocommands may have changed files, get fresh file info.
+          prefetch_fileinfo_free();
+        }
         if (n > 0 && !bufref_valid(&bufref)) {
           // Autocommands have removed the buffer, start at the first one again.
           buf = firstbuf;
@@ -2801,6 +2873,7 @@ int check_timestamps(int focus)
         }
       }
     }
+    prefetch_fileinfo_free();
     no_wait_return--;
     need_check_timestamps = false;
     if (need_wait_return && didit == 2) {
@@ -2812,6 +2885,87 @@ int check_timestamps(int focus)
   return didit;
 }
 
+/// @return  whether buf_check_timestamp() needs the file info of "buf".
+static bool buf_needs_fileinfo(buf_T *buf)
+{
+  return !buf->terminal
+         && buf->b_ffname != NULL
+         && buf->b_ml.ml_mfp != NULL
+         && bt_normal(buf)
+         && !buf->b_saving
+         && !(buf->b_flags & BF_NOTEDITED)
+         && buf->b_mtime != 0;
+}
+
+/// Get the file info of all buffers that check_timestamps() is going to check
+/// at once.  On a network file system each stat() can take a long time, doing
+/// them concurrently on the libuv thread pool makes that time overlap.
+///
+/// Uses a private loop, so that no other events are processed meanwhile.
+static void prefetch_fileinfo(void)
+{
+  if (prefetched != NULL) {
+    return;
+  }
+  size_t count = 0;
+  FOR_ALL_BUFFERS(buf) {
+    if (buf->b_nwindows > 0 && buf_needs_fileinfo(buf)) {
+      count++;
+    }
+  }
+  uv_loop_t loop;
+  if (count < 2 || uv_loop_init(&loop) != 0) {
+    return;
+  }
+
+  prefetched = xcalloc(count, sizeof(*prefetched));
+  FOR_ALL_BUFFERS(buf) {
+    if (prefetched_count < count && buf->b_nwindows > 0 && buf_needs_fileinfo(buf)) {
+      PrefetchedFileInfo *pf = &prefetched[prefetched_count++];
+      pf->fname = xstrdup(buf->b_ffname);
+      pf->req.data = pf;
+      if (uv_fs_stat(&loop, &pf->req, pf->fname, prefetch_fileinfo_cb) == 0) {
+        pf->fnum = buf->handle;
+      }
+    }
+  }
+  uv_run(&loop, UV_RUN_DEFAULT);
+  uv_loop_close(&loop);
+}
+
+static void prefetch_fileinfo_cb(uv_fs_t *req)
+{
+  PrefetchedFileInfo *pf = req->data;
+  pf->ok = req->result == 0;
+  if (pf->ok) {
+    pf->file_info.stat = req->statbuf;
+  }
+  uv_fs_req_cleanup(req);
+}
+
+static void prefetch_fileinfo_free(void)
+{
+  for (size_t i = 0; i < prefetched_count; i++) {
+    xfree(prefetched[i].fname);
+  }
+  XFREE_CLEAR(prefetched);
+  prefetched_count = 0;
+}
+
+/// Get the file info of the file of "buf", from prefetch_fileinfo() if
+/// possible.
+static bool buf_fileinfo(buf_T *buf, FileInfo *file_info)
+{
+  for (size_t i = 0; i < prefetched_count; i++) {
+    PrefetchedFileInfo *pf = &prefetched[i];
+    if (pf->fnum == buf->handle && strcmp(pf->fname, buf->b_ffname) == 0) {
+      *file_info = pf->file_info;
+      return pf->ok;
+    }
+  }
+  return os_fileinfo(buf->b_ffname, file_info);
+}
+
 /// Move all the lines from buffer "frombuf" to buffer "tobuf".
 ///
 /// @return  OK or FAIL.
@@ -2894,7 +3048,7 @@ int buf_check_timestamp(buf_T *buf)
   bool file_info_ok;
   if (!(buf->b_flags & BF_NOTEDITED)
       && buf->b_mtime != 0
-      && (!(file_info_ok = os_fileinfo(buf->b_ffname, &file_info))
+      && (!(file_info_ok = buf_fileinfo(buf, &file_info))
           || time_differs(&file_info, buf->b_mtime, buf->b_mtime_ns)
           || (int)file_info.stat.st_mode != buf->b_orig_mode)) {
     const int64_t prev_b_mtime = buf->b_mtime;
@@ -37,7 +37,7 @@ enum {
 // for the next call.  The value is guessed...
 #define CONV_RESTLEN 30
 
-#define WRITEBUFSIZE         8192    // size of normal write buffer
+#define WRITEBUFSIZE         65536   // size of normal write buffer
 
 // We have to guess how much a sequence of bytes may expand when converting
 // with iconv() to be able to allocate a buffer.
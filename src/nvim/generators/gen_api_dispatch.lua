@@ -51,15 +51,15 @@ local function add_function(fn)
       -- for specifying errors
       fn.parameters[#fn.parameters] = nil
     end
+    if #fn.parameters ~= 0 and fn.parameters[#fn.parameters][1] == 'lstate' then
+      fn.has_lua_imp = true
+      fn.parameters[#fn.parameters] = nil
+    end
     if #fn.parameters ~= 0 and fn.parameters[#fn.parameters][1] == 'arena' then
       -- return value is allocated in an arena
       fn.arena_return = true
       fn.parameters[#fn.parameters] = nil
     end
-    if #fn.parameters ~= 0 and fn.parameters[#fn.parameters][1] == 'lstate' then
-      fn.has_lua_imp = true
-      fn.parameters[#fn.parameters] = nil
-    end
   end
 end
 
@@ -300,6 +300,7 @@ KeySetLink *KeyDict_]]..k.name..[[_get_field(const char *str, size_t len)
 
 ]])
   keysets_defs:write("#define api_free_keydict_"..k.name.."(x) api_free_keydict(x, "..k.name.."_table)\n")
+  keysets_defs:write("#define api_luarefs_free_keydict_"..k.name.."(x) api_luarefs_free_keydict(x, "..k.name.."_table)\n")
 end
 
 local function real_type(type)
@@ -577,6 +578,7 @@ local function process_function(fn)
   static int %s(lua_State *lstate)
   {
     Error err = ERROR_INIT;
+    Arena arena = ARENA_EMPTY;
     char *err_param = 0;
     if (lua_gettop(lstate) != %i) {
       api_set_error(&err, kErrorTypeValidation, "Expected %i argument%s");
@@ -621,16 +623,28 @@ local function process_function(fn)
     local param_type = real_type(param[1])
     local lc_param_type = real_type(param[1]):lower()
     local extra = param_type == "Dictionary" and "false, " or ""
+    local ref = false
     if param[1] == "Object" or param[1] == "DictionaryOf(LuaRef)" then
       extra = "true, "
+      ref = true
+    end
+    -- strings and containers are converted into the arena, only the Lua
+    -- references they might hold need to be released separately.
+    local free_fn = ('api_free_%s'):format(lc_param_type)
+    if param_type == 'String' or param_type == 'Array'
+       or param_type == 'Dictionary' or param_type == 'Object' then
+      extra = extra .. "&arena, "
+      free_fn = ref and ('api_luarefs_free_%s'):format(
+        param_type == 'Object' and 'object' or 'dict') or nil
     end
     local errshift = 0
     local seterr = ''
     if string.match(param_type, '^KeyDict_') then
       write_shifted_output(output, string.format([[
-      %s %s = { 0 }; nlua_pop_keydict(lstate, &%s, %s_get_field, &err_param, &err);]], param_type, cparam, cparam, param_type))
+      %s %s = { 0 }; nlua_pop_keydict(lstate, &%s, %s_get_field, &err_param, &arena, &err);]], param_type, cparam, cparam, param_type))
       cparam = '&'..cparam
       errshift = 1 -- free incomplete dict on error
+      free_fn = 'api_luarefs_free_'..lc_param_type
     else
       write_shifted_output(output, string.format([[
       const %s %s = nlua_pop_%s(lstate, %s&err);]], param[1], cparam, param_type, extra))
@@ -645,8 +659,7 @@ local function process_function(fn)
     }
 
     ]], #fn.parameters - j + errshift))
-    free_code[#free_code + 1] = ('api_free_%s(%s);'):format(
-      lc_param_type, cparam)
+    free_code[#free_code + 1] = free_fn and ('%s(%s);'):format(free_fn, cparam) or ''
     cparams = cparam .. ', ' .. cparams
   end
   if fn.receives_channel_id then
@@ -654,9 +667,6 @@ local function process_function(fn)
   end
   if fn.arena_return then
     cparams = cparams .. '&arena, '
-    write_shifted_output(output, [[
-    Arena arena = ARENA_EMPTY;
-    ]])
   end
 
   if fn.has_lua_imp then
@@ -672,7 +682,11 @@ local function process_function(fn)
   for i = 1, #free_code do
     local rev_i = #free_code - i + 1
     local code = free_code[rev_i]
-    if i == 1 and not string.match(real_type(fn.parameters[1][1]), '^KeyDict_') then
+    if code == '' then
+      if not (i == 1 and not string.match(real_type(fn.parameters[1][1]), '^KeyDict_')) then
+        free_at_exit_code = free_at_exit_code .. ('\n  exit_%u:'):format(rev_i)
+      end
+    elseif i == 1 and not string.match(real_type(fn.parameters[1][1]), '^KeyDict_') then
       free_at_exit_code = free_at_exit_code .. ('\n    %s'):format(code)
     else
       free_at_exit_code = free_at_exit_code .. ('\n  exit_%u:\n    %s'):format(
@@ -682,6 +696,7 @@ local function process_function(fn)
   local err_throw_code = [[
 
   exit_0:
+    arena_mem_free(arena_finish(&arena));
     if (ERROR_SET(&err)) {
       luaL_where(lstate, 1);
       if (err_param) {
@@ -702,10 +717,9 @@ local function process_function(fn)
     else
       return_type = fn.return_type
     end
-    local free_retval
-    if fn.arena_return then
-      free_retval = "arena_mem_free(arena_finish(&arena));"
-    else
+    -- an arena allocated return value is freed together with the arguments
+    local free_retval = ''
+    if not fn.arena_return then
       free_retval = "api_free_"..return_type:lower().."(ret);"
     end
     write_shifted_output(output, string.format([[
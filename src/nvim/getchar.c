@@ -53,6 +53,7 @@
 #include "nvim/pos.h"
 #include "nvim/state.h"
 #include "nvim/strings.h"
+#include "nvim/syntax.h"
 #include "nvim/types.h"
 #include "nvim/ui.h"
 #include "nvim/undo.h"
@@ -1378,6 +1379,7 @@ void before_blocking(void)
   updatescript(0);
   if (may_garbage_collect) {
     garbage_collect(false);
+    syntax_prefetch();
   }
 }
 
@@ -1399,6 +1401,9 @@ static void updatescript(int c)
                 (!!p_fs || idle));  // Always fsync at idle (CursorHold).
     count = 0;
   }
+  if (idle) {
+    ml_shrink_hidden();
+  }
 }
 
 /// Merge "modifiers" into "c_arg".
@@ -2007,37 +2012,49 @@ static int handle_mapping(int *keylenp, const bool *timedout, int *mapdepth)
     // and "aaa" can both be mapped.
     mp_match = NULL;
     mp_match_len = 0;
+
+    // The typeahead to compare the mappings with does not depend on the
+    // mapping, get it once.  A mapping is at most MAXMAPLEN bytes, one more
+    // byte is enough to find out it doesn't match.
+    int tb_keys[MAXMAPLEN + 2];
+    const int tb_keys_len = MIN(typebuf.tb_len, MAXMAPLEN + 2);
+    {
+      int nomap = nolmaplen;
+      int modifiers = 0;
+      for (mlen = 1; mlen < tb_keys_len; mlen++) {
+        int c2 = typebuf.tb_buf[typebuf.tb_off + mlen];
+        if (nomap > 0) {
+          if (nomap == 2 && c2 == KS_MODIFIER) {
+            modifiers = 1;
+          } else if (nomap == 1 && modifiers == 1) {
+            modifiers = c2;
+          }
+          nomap--;
+        } else {
+          if (c2 == K_SPECIAL) {
+            nomap = 2;
+          } else if (merge_modifiers(c2, &modifiers) == c2) {
+            // Only apply 'langmap' if merging modifiers into
+            // the key will not result in another character,
+            // so that 'langmap' behaves consistently in
+            // different terminals and GUIs.
+            LANGMAP_ADJUST(c2, true);
+          }
+          modifiers = 0;
+        }
+        tb_keys[mlen] = c2;
+      }
+    }
+
     for (; mp != NULL; mp->m_next == NULL ? (mp = mp2, mp2 = NULL) : (mp = mp->m_next)) {
       // Only consider an entry if the first character matches and it is
       // for the current state.
       // Skip ":lmap" mappings if keys were mapped.
       if ((uint8_t)mp->m_keys[0] == tb_c1 && (mp->m_mode & local_State)
           && ((mp->m_mode & MODE_LANGMAP) == 0 || typebuf.tb_maplen == 0)) {
-        int nomap = nolmaplen;
-        int modifiers = 0;
         // find the match length of this mapping
-        for (mlen = 1; mlen < typebuf.tb_len; mlen++) {
-          int c2 = typebuf.tb_buf[typebuf.tb_off + mlen];
-          if (nomap > 0) {
-            if (nomap == 2 && c2 == KS_MODIFIER) {
-              modifiers = 1;
-            } else if (nomap == 1 && modifiers == 1) {
-              modifiers = c2;
-            }
-            nomap--;
-          } else {
-            if (c2 == K_SPECIAL) {
-              nomap = 2;
-            } else if (merge_modifiers(c2, &modifiers) == c2) {
-              // Only apply 'langmap' if merging modifiers into
-              // the key will not result in another character,
-              // so that 'langmap' behaves consistently in
-              // different terminals and GUIs.
-              LANGMAP_ADJUST(c2, true);
-            }
-            modifiers = 0;
-          }
-          if ((uint8_t)mp->m_keys[mlen] != c2) {
+        for (mlen = 1; mlen < tb_keys_len; mlen++) {
+          if ((uint8_t)mp->m_keys[mlen] != tb_keys[mlen]) {
             break;
           }
         }
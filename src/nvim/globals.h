@@ -81,11 +81,27 @@
 # define VIMRC_LUA_FILE ".nvim.lua"
 #endif
 
+/// Number of buckets in a stats_hist_T.
+#define STATS_HIST_BUCKETS 20
+
+/// Histogram of durations, see stats_hist_add().
+typedef struct {
+  int64_t count;
+  int64_t total;  ///< nanoseconds
+  int64_t max;    ///< nanoseconds
+  /// Bucket 0 counts durations below 1 usec, bucket "i" durations below
+  /// 2^i usec, the last bucket the rest.
+  int64_t buckets[STATS_HIST_BUCKETS];
+} stats_hist_T;
+
 EXTERN struct nvim_stats_s {
   int64_t fsync;
   int64_t redraw;
   int16_t log_skip;  // How many logs were tried and skipped before log_init.
-} g_stats INIT( = { 0, 0, 0 });
+  stats_hist_T input_latency;  ///< time keys wait in the input buffer
+  stats_hist_T event_batch;    ///< time to process a batch of main loop events
+  stats_hist_T update_screen;  ///< time of an update_screen() call
+} g_stats INIT( = { 0, 0, 0, { 0 }, { 0 }, { 0 } });
 
 // Values for "starting".
 #define NO_SCREEN       2       // no screen updating yet
@@ -49,6 +49,15 @@ static size_t linebuf_size = 0;
 // The maximum byte size of a glyph is MAX_SCHAR_SIZE (including the final NUL).
 static Set(glyph) glyph_cache = SET_INIT;
 
+// Windows by the handle of their allocated grid.
+static PMap(int) grid_windows = MAP_INIT;
+
+// Cell arrays of recently freed grids. grid_alloc() takes them for a grid of
+// the same size, floats are often closed and opened again with the same size.
+#define GRID_POOL_SIZE 4
+static ScreenGrid grid_pool[GRID_POOL_SIZE];
+static int grid_pool_len = 0;
+
 /// Determine if dedicated window grid should be used or the default_grid
 ///
 /// If UI did not request multigrid support, draw all windows on the
@@ -622,6 +631,51 @@ static int grid_char_needs_redraw(ScreenGrid *grid, int col, size_t off_to, int
               || rdb_flags & RDB_NODELTA));
 }
 
+/// Number of cells compared at once by linebuf_diff_start() and
+/// linebuf_diff_end().
+#define LINEBUF_CMP_CELLS 16
+
+/// @return  the first column from "col" to "endcol" where the line buffer
+///          differs from the cells in "grid" at "off_to", or "endcol".
+///
+/// Compares blocks of cells with memcmp(), which libc does with wide
+/// compares, before looking at single cells.
+static int linebuf_diff_start(ScreenGrid *grid, size_t off_to, int col, int endcol)
+{
+  const schar_T *chars = grid->chars + off_to;
+  const sattr_T *attrs = grid->attrs + off_to;
+  while (endcol - col >= LINEBUF_CMP_CELLS
+         && memcmp(linebuf_char + col, chars + col, LINEBUF_CMP_CELLS * sizeof(schar_T)) == 0
+         && memcmp(linebuf_attr + col, attrs + col, LINEBUF_CMP_CELLS * sizeof(sattr_T)) == 0) {
+    col += LINEBUF_CMP_CELLS;
+  }
+  while (col < endcol && linebuf_char[col] == chars[col] && linebuf_attr[col] == attrs[col]) {
+    col++;
+  }
+  return col;
+}
+
+/// @return  the column after the last one from "col" to "endcol" where the
+///          line buffer differs from the cells in "grid" at "off_to", or
+///          "col".
+static int linebuf_diff_end(ScreenGrid *grid, size_t off_to, int col, int endcol)
+{
+  const schar_T *chars = grid->chars + off_to;
+  const sattr_T *attrs = grid->attrs + off_to;
+  while (endcol - col >= LINEBUF_CMP_CELLS
+         && memcmp(linebuf_char + endcol - LINEBUF_CMP_CELLS, chars + endcol - LINEBUF_CMP_CELLS,
+                   LINEBUF_CMP_CELLS * sizeof(schar_T)) == 0
+         && memcmp(linebuf_attr + endcol - LINEBUF_CMP_CELLS, attrs + endcol - LINEBUF_CMP_CELLS,
+                   LINEBUF_CMP_CELLS * sizeof(sattr_T)) == 0) {
+    endcol -= LINEBUF_CMP_CELLS;
+  }
+  while (endcol > col && linebuf_char[endcol - 1] == chars[endcol - 1]
+         && linebuf_attr[endcol - 1] == attrs[endcol - 1]) {
+    endcol--;
+  }
+  return endcol;
+}
+
 /// Move one buffered line to the window grid, but only the characters that
 /// have actually changed.  Handle insert/delete character.
 /// "coloff" gives the first column on the grid for this line.
@@ -689,11 +743,31 @@ void grid_put_linebuf(ScreenGrid *grid, int row, int coloff, int col, int endcol
     }
   }
 
+  if (endcol > col) {
+    memcpy(grid->vcols + off_to + (size_t)col, linebuf_vcol + col,
+           (size_t)(endcol - col) * sizeof(*linebuf_vcol));
+  }
+
+  // Cells at the start and the end of the text that didn't change don't
+  // need to be looked at one by one.  Keep double-width characters whole.
+  int diff_end = endcol;
+  if (!exmode_active && !(rdb_flags & RDB_NODELTA)) {
+    int diff_start = linebuf_diff_start(grid, off_to, col, endcol);
+    diff_end = linebuf_diff_end(grid, off_to, diff_start, endcol);
+    if (diff_start > col && diff_start < endcol && linebuf_char[diff_start] == 0) {
+      diff_start--;
+    }
+    if (diff_end < endcol && diff_end > diff_start && linebuf_char[diff_end] == 0) {
+      diff_end++;
+    }
+    col = diff_start;
+  }
+
   redraw_next = grid_char_needs_redraw(grid, col, (size_t)col + off_to, endcol - col);
 
   int start_dirty = -1, end_dirty = 0;
 
-  while (col < endcol) {
+  while (col < diff_end) {
     char_cells = 1;
     if (col + 1 < endcol && linebuf_char[col + 1] == 0) {
       char_cells = 2;
@@ -732,13 +806,9 @@ void grid_put_linebuf(ScreenGrid *grid, int row, int coloff, int col, int endcol
       }
     }
 
-    grid->vcols[off] = linebuf_vcol[col];
-    if (char_cells == 2) {
-      grid->vcols[off + 1] = linebuf_vcol[col + 1];
-    }
-
     col += char_cells;
   }
+  col = MAX(col, endcol);
 
   if (clear_next) {
     // Clear the second half of a double-wide character of which the left
@@ -803,11 +873,13 @@ void grid_alloc(ScreenGrid *grid, int rows, int columns, bool copy, bool valid)
   ScreenGrid ngrid = *grid;
   assert(rows >= 0 && columns >= 0);
   size_t ncells = (size_t)rows * (size_t)columns;
-  ngrid.chars = xmalloc(ncells * sizeof(schar_T));
-  ngrid.attrs = xmalloc(ncells * sizeof(sattr_T));
-  ngrid.vcols = xmalloc(ncells * sizeof(colnr_T));
+  if (!grid_pool_take(&ngrid, rows, columns)) {
+    ngrid.chars = xmalloc(ncells * sizeof(schar_T));
+    ngrid.attrs = xmalloc(ncells * sizeof(sattr_T));
+    ngrid.vcols = xmalloc(ncells * sizeof(colnr_T));
+    ngrid.line_offset = xmalloc((size_t)rows * sizeof(*ngrid.line_offset));
+  }
   memset(ngrid.vcols, -1, ncells * sizeof(colnr_T));
-  ngrid.line_offset = xmalloc((size_t)rows * sizeof(*ngrid.line_offset));
 
   ngrid.rows = rows;
   ngrid.cols = columns;
@@ -854,12 +926,46 @@ void grid_alloc(ScreenGrid *grid, int rows, int columns, bool copy, bool valid)
   }
 }
 
-void grid_free(ScreenGrid *grid)
+/// Take the cell arrays of a pooled grid of size "rows" x "cols" for "grid".
+///
+/// @return  false if there is none.
+static bool grid_pool_take(ScreenGrid *grid, int rows, int cols)
+{
+  for (int i = grid_pool_len - 1; i >= 0; i--) {
+    ScreenGrid *pg = &grid_pool[i];
+    if (pg->rows == rows && pg->cols == cols) {
+      grid->chars = pg->chars;
+      grid->attrs = pg->attrs;
+      grid->vcols = pg->vcols;
+      grid->line_offset = pg->line_offset;
+      grid_pool[i] = grid_pool[--grid_pool_len];
+      return true;
+    }
+  }
+  return false;
+}
+
+static void grid_free_mem(ScreenGrid *grid)
 {
   xfree(grid->chars);
   xfree(grid->attrs);
   xfree(grid->vcols);
   xfree(grid->line_offset);
+}
+
+void grid_free(ScreenGrid *grid)
+{
+  if (grid->chars == NULL) {
+    // nothing allocated
+  } else if (grid_pool_len < GRID_POOL_SIZE) {
+    grid_pool[grid_pool_len++] = *grid;
+  } else {
+    // Drop the oldest pooled grid, recently freed sizes are more likely to
+    // be allocated again.
+    grid_free_mem(&grid_pool[0]);
+    memmove(grid_pool, grid_pool + 1, (GRID_POOL_SIZE - 1) * sizeof(*grid_pool));
+    grid_pool[GRID_POOL_SIZE - 1] = *grid;
+  }
 
   grid->chars = NULL;
   grid->attrs = NULL;
@@ -871,6 +977,10 @@ void grid_free(ScreenGrid *grid)
 void grid_free_all_mem(void)
 {
   grid_free(&default_grid);
+  for (int i = 0; i < grid_pool_len; i++) {
+    grid_free_mem(&grid_pool[i]);
+  }
+  grid_pool_len = 0;
   xfree(linebuf_char);
   xfree(linebuf_attr);
   xfree(linebuf_vcol);
@@ -1061,12 +1171,24 @@ static void linecopy(ScreenGrid *grid, int to, int from, int col, int width)
   memmove(grid->vcols + off_to, grid->vcols + off_from, (size_t)width * sizeof(colnr_T));
 }
 
-win_T *get_win_by_grid_handle(handle_T handle)
+/// Remember "wp" as the window of its grid handle, for get_win_by_grid_handle().
+void grid_win_register(win_T *wp)
 {
-  FOR_ALL_WINDOWS_IN_TAB(wp, curtab) {
-    if (wp->w_grid_alloc.handle == handle) {
-      return wp;
-    }
+  if (wp->w_grid_alloc.handle != 0) {
+    pmap_put(int)(&grid_windows, wp->w_grid_alloc.handle, wp);
+  }
+}
+
+void grid_win_unregister(win_T *wp)
+{
+  if (wp->w_grid_alloc.handle != 0) {
+    pmap_del(int)(&grid_windows, wp->w_grid_alloc.handle, NULL);
   }
-  return NULL;
+}
+
+/// @return  the window in the current tab page using grid "handle", or NULL.
+win_T *get_win_by_grid_handle(handle_T handle)
+{
+  win_T *wp = pmap_get(int)(&grid_windows, handle);
+  return wp != NULL && wp->w_tabpage == curtab ? wp : NULL;
 }
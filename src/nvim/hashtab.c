@@ -105,6 +105,19 @@ hashitem_T *hash_find_len(const hashtab_T *const ht, const char *const key, cons
   return hash_lookup(ht, key, len, hash_hash_len(key, len));
 }
 
+/// @return  true if the key of "hi" is "key[key_len]".
+static inline bool hash_key_equal(const hashitem_T *const hi, const char *const key,
+                                  const size_t key_len)
+  FUNC_ATTR_ALWAYS_INLINE FUNC_ATTR_PURE FUNC_ATTR_NONNULL_ALL
+{
+  // Items are often looked up with their own key, e.g. when removing a
+  // dictionary item, then the strings don't need to be compared.
+  if (hi->hi_key == key) {
+    return hi->hi_key[key_len] == NUL;
+  }
+  return strncmp(hi->hi_key, key, key_len) == 0 && hi->hi_key[key_len] == NUL;
+}
+
 /// Like hash_find(), but caller computes "hash".
 ///
 /// @param[in]  key  The key of the looked-for item. Must not be NULL.
@@ -137,9 +150,7 @@ hashitem_T *hash_lookup(const hashtab_T *const ht, const char *const key, const
   hashitem_T *freeitem = NULL;
   if (hi->hi_key == HI_KEY_REMOVED) {
     freeitem = hi;
-  } else if ((hi->hi_hash == hash)
-             && (strncmp(hi->hi_key, key, key_len) == 0)
-             && hi->hi_key[key_len] == NUL) {
+  } else if (hi->hi_hash == hash && hash_key_equal(hi, key, key_len)) {
     return hi;
   }
 
@@ -164,8 +175,7 @@ hashitem_T *hash_lookup(const hashtab_T *const ht, const char *const key, const
 
     if ((hi->hi_hash == hash)
         && (hi->hi_key != HI_KEY_REMOVED)
-        && (strncmp(hi->hi_key, key, key_len) == 0)
-        && hi->hi_key[key_len] == NUL) {
+        && hash_key_equal(hi, key, key_len)) {
       return hi;
     }
 
@@ -1195,4 +1195,6 @@ void ex_helptags(exarg_T *eap)
     }
     xfree(dirname);
   }
+  // New tags files may have been written.
+  tag_fnames_invalidate();
 }
@@ -29,6 +29,15 @@
 #include "nvim/ui.h"
 #include "nvim/vim.h"
 
+/// Entry of the combine and blend caches, see HL_CACHE_SIZE.
+typedef struct {
+  uint32_t gen;
+  int key1;
+  int key2;
+  int id;
+  bool through;  ///< resulting "*through" of hl_blend_attrs()
+} hl_cache_T;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "highlight.c.generated.h"
 #endif
@@ -42,6 +51,19 @@ static Map(int, int) blendthrough_attr_entries = MAP_INIT;
 
 #define attr_entry(i) attr_entries.keys[i]
 
+/// Direct-mapped cache in front of the combine and blend maps above, as these
+/// are looked up for every cell drawn or composed.  An entry is only valid if
+/// its "gen" matches the current generation of the cache, so invalidating is
+/// just a matter of bumping the generation.
+#define HL_CACHE_SIZE 256  // must be a power of two
+
+static hl_cache_T combine_cache[HL_CACHE_SIZE];
+static hl_cache_T blend_cache[2][HL_CACHE_SIZE];  // indexed by "*through"
+static uint32_t combine_cache_gen = 1;
+static uint32_t blend_cache_gen = 1;
+
+#define HL_CACHE_IDX(a, b) (((uint32_t)(a) * 31 + (uint32_t)(b)) & (HL_CACHE_SIZE - 1))
+
 /// highlight entries private to a namespace
 static Map(ColorKey, ColorItem) ns_hls;
 typedef int NSHlAttr[HLF_COUNT + 1];
@@ -486,9 +508,21 @@ int hl_get_term_attr(HlAttrs *aep)
                                    .id1 = 0, .id2 = 0 });
 }
 
+/// Invalidate all entries of "cache" by going to the next generation.
+static void hl_cache_invalidate(hl_cache_T *cache, size_t size, uint32_t *gen)
+{
+  if (++*gen == 0) {
+    // wrapped around: entries with any generation could be seen as valid now
+    memset(cache, 0, size);
+    *gen = 1;
+  }
+}
+
 /// Clear all highlight tables.
 void clear_hl_tables(bool reinit)
 {
+  hl_cache_invalidate(combine_cache, sizeof(combine_cache), &combine_cache_gen);
+  hl_cache_invalidate(&blend_cache[0][0], sizeof(blend_cache), &blend_cache_gen);
   if (reinit) {
     set_clear(HlEntry, &attr_entries);
     highlight_init();
@@ -510,6 +544,7 @@ void clear_hl_tables(bool reinit)
 
 void hl_invalidate_blends(void)
 {
+  hl_cache_invalidate(&blend_cache[0][0], sizeof(blend_cache), &blend_cache_gen);
   map_clear(int, &blend_attr_entries);
   map_clear(int, &blendthrough_attr_entries);
   highlight_changed();
@@ -540,10 +575,16 @@ int hl_combine_attr(int char_attr, int prim_attr)
     return char_attr;
   }
 
+  hl_cache_T *ce = &combine_cache[HL_CACHE_IDX(char_attr, prim_attr)];
+  if (ce->gen == combine_cache_gen && ce->key1 == char_attr && ce->key2 == prim_attr) {
+    return ce->id;
+  }
+
   // TODO(bfredl): could use a struct for clearer intent.
   int combine_tag = (char_attr << 16) + prim_attr;
   int id = map_get(int, int)(&combine_attr_entries, combine_tag);
   if (id > 0) {
+    *ce = (hl_cache_T){ .gen = combine_cache_gen, .key1 = char_attr, .key2 = prim_attr, .id = id };
     return id;
   }
 
@@ -600,6 +641,7 @@ int hl_combine_attr(int char_attr, int prim_attr)
                                  .id1 = char_attr, .id2 = prim_attr });
   if (id > 0) {
     map_put(int, int)(&combine_attr_entries, combine_tag, id);
+    *ce = (hl_cache_T){ .gen = combine_cache_gen, .key1 = char_attr, .key2 = prim_attr, .id = id };
   }
 
   return id;
@@ -646,9 +688,17 @@ int hl_blend_attrs(int back_attr, int front_attr, bool *through)
     return -1;
   }
 
+  hl_cache_T *ce = &blend_cache[*through][HL_CACHE_IDX(back_attr, front_attr)];
+  if (ce->gen == blend_cache_gen && ce->key1 == back_attr && ce->key2 == front_attr) {
+    *through = ce->through;
+    return ce->id;
+  }
+
   HlAttrs fattrs = get_colors_force(front_attr);
   int ratio = fattrs.hl_blend;
   if (ratio <= 0) {
+    *ce = (hl_cache_T){ .gen = blend_cache_gen, .key1 = back_attr, .key2 = front_attr,
+                        .id = front_attr, .through = false };
     *through = false;
     return front_attr;
   }
@@ -659,6 +709,8 @@ int hl_blend_attrs(int back_attr, int front_attr, bool *through)
                         : &blend_attr_entries);
   int id = map_get(int, int)(map, combine_tag);
   if (id > 0) {
+    *ce = (hl_cache_T){ .gen = blend_cache_gen, .key1 = back_attr, .key2 = front_attr,
+                        .id = id, .through = *through };
     return id;
   }
 
@@ -706,6 +758,8 @@ int hl_blend_attrs(int back_attr, int front_attr, bool *through)
                                  .id1 = back_attr, .id2 = front_attr });
   if (id > 0) {
     map_put(int, int)(map, combine_tag, id);
+    *ce = (hl_cache_T){ .gen = blend_cache_gen, .key1 = back_attr, .key2 = front_attr,
+                        .id = id, .through = *through };
   }
   return id;
 }
@@ -61,6 +61,11 @@ Arena highlight_arena = ARENA_EMPTY;
 
 Map(cstr_t, int) highlight_unames = MAP_INIT;
 
+// While init_highlight() loads the compiled-in groups, the redraw they need is
+// collected here and done once afterwards, instead of once per group.
+static bool hl_init_batch = false;
+static int hl_init_redraw = 0;
+
 /// The "term", "cterm" and "gui" arguments can be any combination of the
 /// following names, separated by commas (but no spaces!).
 static char *(hl_name_table[]) =
@@ -641,17 +646,20 @@ void init_highlight(bool both, bool reset)
   }
 
   // Didn't use a color file, use the compiled-in colors.
+  if (!both && !had_both) {
+    // Don't do anything before the call with both == true from main().
+    // Not everything has been setup then, and that call will overrule
+    // everything anyway.
+    return;
+  }
+
+  hl_init_batch = true;
   if (both) {
     had_both = true;
     const char *const *const pp = highlight_init_both;
     for (size_t i = 0; pp[i] != NULL; i++) {
       do_highlight(pp[i], reset, true);
     }
-  } else if (!had_both) {
-    // Don't do anything before the call with both == true from main().
-    // Not everything has been setup then, and that call will overrule
-    // everything anyway.
-    return;
   }
 
   const char *const *const pp = ((*p_bg == 'l')
@@ -678,6 +686,22 @@ void init_highlight(bool both, bool reset)
   }
 
   syn_init_cmdline_highlight(false, false);
+
+  hl_init_batch = false;
+  if (hl_init_redraw != 0) {
+    redraw_all_later(hl_init_redraw);
+    hl_init_redraw = 0;
+  }
+}
+
+/// Mark all windows to be redrawn for a change of a highlight group.
+static void hl_redraw_all_later(int type)
+{
+  if (hl_init_batch) {
+    hl_init_redraw = MAX(hl_init_redraw, type);
+  } else {
+    redraw_all_later(type);
+  }
 }
 
 /// Load color file "name".
@@ -1007,7 +1031,7 @@ void do_highlight(const char *line, const bool forceit, const bool init)
         hlgroup->sg_script_ctx.sc_lnum += SOURCING_LNUM;
         nlua_set_sctx(&hlgroup->sg_script_ctx);
         hlgroup->sg_cleared = false;
-        redraw_all_later(UPD_SOME_VALID);
+        hl_redraw_all_later(UPD_SOME_VALID);
 
         // Only call highlight changed() once after multiple changes
         need_highlight_changed = true;
@@ -1400,7 +1424,7 @@ void do_highlight(const char *line, const bool forceit, const bool init)
       ui_default_colors_set();
     }
     did_highlight_changed = true;
-    redraw_all_later(UPD_NOT_VALID);
+    hl_redraw_all_later(UPD_NOT_VALID);
   } else {
     set_hl_attr(idx);
   }
@@ -1417,7 +1441,7 @@ void do_highlight(const char *line, const bool forceit, const bool init)
     // redrawing.  This may happen when evaluating 'statusline' changes the
     // StatusLine group.
     if (!updating_screen) {
-      redraw_all_later(UPD_NOT_VALID);
+      hl_redraw_all_later(UPD_NOT_VALID);
     }
     need_highlight_changed = true;
   }
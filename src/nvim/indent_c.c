@@ -30,6 +30,20 @@ typedef struct {
   lpos_T lpos;
 } cpp_baseclass_cache_T;
 
+// Result of find_start_brace() with the cursor at the start of "lnum"
+typedef struct {
+  linenr_T lnum;  ///< 0 for an unused entry
+  bool found;
+  pos_T pos;
+} brace_cache_T;
+
+#define BRACE_CACHE_SIZE 64
+
+/// find_start_brace() results, only used while reindenting a range of lines
+/// of "brace_cache_buf" with get_c_indent(), see c_indent_cache_start().
+static brace_cache_T brace_cache[BRACE_CACHE_SIZE];
+static buf_T *brace_cache_buf = NULL;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "indent_c.c.generated.h"
 #endif
@@ -1410,6 +1424,24 @@ static pos_T *find_start_brace(void)  // XXX
   pos_T *trypos;
   pos_T *pos;
   static pos_T pos_copy;
+  brace_cache_T *entry = NULL;
+
+  if (brace_cache_buf == curbuf && curwin->w_cursor.col == 0) {
+    linenr_T lnum = curwin->w_cursor.lnum;
+    entry = &brace_cache[lnum % BRACE_CACHE_SIZE];
+    brace_cache_T *prev = &brace_cache[(lnum - 1) % BRACE_CACHE_SIZE];
+    if (entry->lnum != lnum && lnum > 1 && prev->lnum == lnum - 1
+        && brace_cache_skip_line(lnum - 1)) {
+      // The search from "lnum" passes line "lnum - 1" without a match and
+      // then continues like the one from "lnum - 1".
+      *entry = *prev;
+      entry->lnum = lnum;
+    }
+    if (entry->lnum == lnum) {
+      pos_copy = entry->pos;
+      return entry->found ? &pos_copy : NULL;
+    }
+  }
 
   cursor_save = curwin->w_cursor;
   while ((trypos = findmatchlimit(NULL, '{', FM_BLOCKSTOP, 0)) != NULL) {
@@ -1427,9 +1459,54 @@ static pos_T *find_start_brace(void)  // XXX
     }
   }
   curwin->w_cursor = cursor_save;
+  if (entry != NULL && !got_int) {
+    entry->lnum = cursor_save.lnum;
+    entry->found = trypos != NULL;
+    if (trypos != NULL) {
+      entry->pos = *trypos;
+    }
+  }
   return trypos;
 }
 
+/// @return  true if a backward search for a '{' from the start of the line
+///          after "lnum" can't stop in "lnum" and leaves it in the same state
+///          as a search starting at the start of "lnum": it contains no
+///          braces, and neither it nor the line above continues in the next
+///          line with a backslash.
+static bool brace_cache_skip_line(linenr_T lnum)
+{
+  const char *line = ml_get(lnum);
+  size_t len = strlen(line);
+  if (strpbrk(line, "{}") != NULL || (len > 0 && line[len - 1] == '\\')) {
+    return false;
+  }
+  if (lnum > 1) {
+    line = ml_get(lnum - 1);
+    len = strlen(line);
+    if (len > 0 && line[len - 1] == '\\') {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Start caching find_start_brace() results for reindenting lines of the
+/// current buffer from top to bottom with get_c_indent().
+///
+/// Only the indent of the line being reindented and the lines below it may
+/// change until c_indent_cache_end() is called.
+void c_indent_cache_start(void)
+{
+  CLEAR_FIELD(brace_cache);
+  brace_cache_buf = curbuf->b_p_lisp ? NULL : curbuf;
+}
+
+void c_indent_cache_end(void)
+{
+  brace_cache_buf = NULL;
+}
+
 /// Find the matching '(', ignoring it if it is in a comment.
 /// @returns NULL or the found match.
 static pos_T *find_match_paren(int ind_maxparen)
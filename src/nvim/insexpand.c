@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "klib/kvec.h"
 #include "nvim/ascii.h"
 #include "nvim/autocmd.h"
 #include "nvim/buffer.h"
@@ -28,6 +29,7 @@
 #include "nvim/getchar.h"
 #include "nvim/gettext.h"
 #include "nvim/globals.h"
+#include "nvim/hashtab.h"
 #include "nvim/highlight_defs.h"
 #include "nvim/indent.h"
 #include "nvim/indent_c.h"
@@ -172,6 +174,41 @@ typedef struct {
   int dict_f;             ///< "dict" is an exact file name or not
 } ins_compl_next_state_T;
 
+/// A word in a buffer, for the index of its words.
+typedef struct {
+  pos_T cw_first;  ///< position of the first occurrence
+  pos_T cw_last;   ///< position of the last occurrence
+  int cw_len;      ///< length of the word in bytes
+  char cw_word[];  ///< the word, NUL terminated
+} complword_T;
+
+/// Index of the words in a buffer other than the current one, used instead of
+/// searching the buffer text for every ^N/^P.  Built again when the text or
+/// 'iskeyword' changed.
+struct compl_words_S {
+  varnumber_T cws_changedtick;  ///< b:changedtick of the indexed text
+  uint64_t cws_chartab[4];      ///< b_chartab of the indexed text
+  hashtab_T cws_ht;             ///< words, for finding duplicates
+  kvec_t(complword_T *) cws_words;    ///< words in order of first occurrence
+  kvec_t(complword_T *) cws_by_last;  ///< words in order of last occurrence
+};
+
+/// Text of a 'dictionary' or 'thesaurus' file, kept to avoid reading it again
+/// for every completion.  Used while the file size and modification time
+/// don't change.
+typedef struct {
+  FileID dc_id;          ///< identifies the file
+  int64_t dc_mtime;      ///< modification time of the file
+  int64_t dc_mtime_ns;   ///< nanoseconds of the modification time
+  uint64_t dc_filesize;  ///< size of the file
+  char *dc_text;         ///< file contents, NULL when entry is not used
+  size_t dc_len;         ///< number of bytes in "dc_text"
+} dictcache_T;
+
+#define DICT_CACHE_SIZE 8
+static dictcache_T dict_cache[DICT_CACHE_SIZE];
+static int dict_cache_next = 0;  ///< entry to use for the next file
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "insexpand.c.generated.h"
 #endif
@@ -1429,6 +1466,97 @@ static int thesaurus_add_words_in_line(char *fname, char **buf_arg, int dir, con
   return status;
 }
 
+/// Get the text of dictionary/thesaurus file "fname", reading it if it was
+/// not read before or has changed.  The text is owned by the cache.
+///
+/// @return  NULL when the file can't be read.
+static char *dict_cache_get(const char *fname, size_t *len)
+{
+  FileInfo file_info;
+  if (!os_fileinfo(fname, &file_info)) {
+    return NULL;
+  }
+  FileID file_id;
+  os_fileinfo_id(&file_info, &file_id);
+  const uint64_t filesize = os_fileinfo_size(&file_info);
+
+  dictcache_T *dc = NULL;
+  for (int i = 0; i < DICT_CACHE_SIZE; i++) {
+    if (dict_cache[i].dc_text != NULL && os_fileid_equal(&dict_cache[i].dc_id, &file_id)) {
+      dc = &dict_cache[i];
+      if (dc->dc_filesize == filesize
+          && dc->dc_mtime == (int64_t)file_info.stat.st_mtim.tv_sec
+          && dc->dc_mtime_ns == (int64_t)file_info.stat.st_mtim.tv_nsec) {
+        *len = dc->dc_len;
+        return dc->dc_text;
+      }
+      break;
+    }
+  }
+  if (dc == NULL) {
+    dc = &dict_cache[dict_cache_next];
+    dict_cache_next = (dict_cache_next + 1) % DICT_CACHE_SIZE;
+  }
+  XFREE_CLEAR(dc->dc_text);
+
+  if (filesize >= SIZE_MAX) {
+    return NULL;
+  }
+  FILE *fp = os_fopen(fname, "r");
+  if (fp == NULL) {
+    return NULL;
+  }
+  // Reading in text mode may return fewer bytes than the file size.
+  char *text = try_malloc((size_t)filesize + 1);
+  if (text != NULL) {
+    dc->dc_len = fread(text, 1, (size_t)filesize, fp);
+    text[dc->dc_len] = NUL;
+    dc->dc_id = file_id;
+    dc->dc_filesize = filesize;
+    dc->dc_mtime = (int64_t)file_info.stat.st_mtim.tv_sec;
+    dc->dc_mtime_ns = (int64_t)file_info.stat.st_mtim.tv_nsec;
+    dc->dc_text = text;
+    *len = dc->dc_len;
+  }
+  fclose(fp);
+  return text;
+}
+
+/// Add the text in line "buf" of dictionary/thesaurus file "fname" that
+/// matches "regmatch".
+static void ins_compl_dict_line(char *buf, char *fname, int thesaurus, regmatch_T *regmatch,
+                                Direction *dir)
+{
+  char *ptr = buf;
+  while (vim_regexec(regmatch, buf, (colnr_T)(ptr - buf))) {
+    ptr = regmatch->startp[0];
+    if (ctrl_x_mode_line_or_eval()) {
+      ptr = find_line_end(ptr);
+    } else {
+      ptr = find_word_end(ptr);
+    }
+    int add_r = ins_compl_add_infercase(regmatch->startp[0],
+                                        (int)(ptr - regmatch->startp[0]),
+                                        p_ic, fname, *dir, false);
+    if (thesaurus) {
+      // For a thesaurus, add all the words in the line
+      ptr = buf;
+      add_r = thesaurus_add_words_in_line(fname, &ptr, *dir, regmatch->startp[0]);
+    }
+    if (add_r == OK) {
+      // if dir was BACKWARD then honor it just once
+      *dir = FORWARD;
+    } else if (add_r == FAIL) {
+      break;
+    }
+    // avoid expensive call to vim_regexec() when at end
+    // of line
+    if (*ptr == '\n' || got_int) {
+      break;
+    }
+  }
+}
+
 /// Process "count" dictionary/thesaurus "files" and add the text matching
 /// "regmatch".
 static void ins_compl_files(int count, char **files, int thesaurus, int flags, regmatch_T *regmatch,
@@ -1436,7 +1564,8 @@ static void ins_compl_files(int count, char **files, int thesaurus, int flags, r
   FUNC_ATTR_NONNULL_ARG(2, 7)
 {
   for (int i = 0; i < count && !got_int && !compl_interrupted; i++) {
-    FILE *fp = os_fopen(files[i], "r");  // open dictionary file
+    size_t len = 0;
+    char *text = dict_cache_get(files[i], &len);  // dictionary file contents
     if (flags != DICT_EXACT && !shortmess(SHM_COMPLETIONSCAN)) {
       msg_hist_off = true;  // reset in msg_trunc()
       vim_snprintf(IObuff, IOSIZE,
@@ -1444,45 +1573,25 @@ static void ins_compl_files(int count, char **files, int thesaurus, int flags, r
       (void)msg_trunc(IObuff, true, HL_ATTR(HLF_R));
     }
 
-    if (fp == NULL) {
+    if (text == NULL) {
       continue;
     }
 
-    // Read dictionary file line by line.
-    // Check each line for a match.
-    while (!got_int && !compl_interrupted && !vim_fgets(buf, LSIZE, fp)) {
-      char *ptr = buf;
-      while (vim_regexec(regmatch, buf, (colnr_T)(ptr - buf))) {
-        ptr = regmatch->startp[0];
-        if (ctrl_x_mode_line_or_eval()) {
-          ptr = find_line_end(ptr);
-        } else {
-          ptr = find_word_end(ptr);
-        }
-        int add_r = ins_compl_add_infercase(regmatch->startp[0],
-                                            (int)(ptr - regmatch->startp[0]),
-                                            p_ic, files[i], *dir, false);
-        if (thesaurus) {
-          // For a thesaurus, add all the words in the line
-          ptr = buf;
-          add_r = thesaurus_add_words_in_line(files[i], &ptr, *dir, regmatch->startp[0]);
-        }
-        if (add_r == OK) {
-          // if dir was BACKWARD then honor it just once
-          *dir = FORWARD;
-        } else if (add_r == FAIL) {
-          break;
-        }
-        // avoid expensive call to vim_regexec() when at end
-        // of line
-        if (*ptr == '\n' || got_int) {
-          break;
-        }
-      }
+    // Go over the dictionary text line by line, like vim_fgets() with
+    // LSIZE would read it.  Check each line for a match.
+    char *end = text + len;
+    for (char *line = text; line < end && !got_int && !compl_interrupted;) {
+      char *next = memchr(line, '\n', (size_t)(end - line));
+      next = next == NULL ? end : next + 1;
+      size_t linelen = MIN((size_t)(next - line), LSIZE - 1);
+      memcpy(buf, line, linelen);
+      buf[linelen] = NUL;
+      line = next;
+
+      ins_compl_dict_line(buf, files[i], thesaurus, regmatch, dir);
       line_breakcheck();
       ins_compl_check_keys(50, false);
     }
-    fclose(fp);
   }
 }
 
@@ -3139,6 +3248,148 @@ static char *ins_compl_get_next_word_or_line(buf_T *ins_buf, pos_T *cur_match_po
   return ptr;
 }
 
+static int compl_word_cmp_last(const void *a, const void *b)
+{
+  const complword_T *const cw1 = *(const complword_T **)a;
+  const complword_T *const cw2 = *(const complword_T **)b;
+  return lt(cw1->cw_last, cw2->cw_last) ? -1 : equalpos(cw1->cw_last, cw2->cw_last) ? 0 : 1;
+}
+
+/// Get the index of the words in "buf", which must be loaded.  A word starts
+/// where "\<" matches and ends where find_word_end() stops.
+static struct compl_words_S *ins_compl_words_get(buf_T *buf)
+{
+  struct compl_words_S *cws = buf->b_compl_words;
+  if (cws != NULL && cws->cws_changedtick == buf_get_changedtick(buf)
+      && memcmp(cws->cws_chartab, buf->b_chartab, sizeof(cws->cws_chartab)) == 0) {
+    return cws;
+  }
+
+  ins_compl_free_words(buf);
+  cws = xcalloc(1, sizeof(*cws));
+  cws->cws_changedtick = buf_get_changedtick(buf);
+  memcpy(cws->cws_chartab, buf->b_chartab, sizeof(cws->cws_chartab));
+  hash_init(&cws->cws_ht);
+
+  for (linenr_T lnum = 1; lnum <= buf->b_ml.ml_line_count; lnum++) {
+    char *line = ml_get_buf(buf, lnum);
+    int prev_class = -1;
+    for (char *p = line; *p != NUL;) {
+      int class = mb_get_class_tab(p, buf->b_chartab);
+      if (class < 2 || class == prev_class) {
+        prev_class = class;
+        p += utfc_ptr2len(p);
+        continue;
+      }
+
+      char *end = find_word_end(p);
+      const size_t len = (size_t)(end - p);
+      const pos_T pos = { lnum, (colnr_T)(p - line), 0 };
+      const hash_T hash = hash_hash_len(p, len);
+      hashitem_T *hi = hash_lookup(&cws->cws_ht, p, len, hash);
+      if (HASHITEM_EMPTY(hi)) {
+        complword_T *cw = xmalloc(offsetof(complword_T, cw_word) + len + 1);
+        cw->cw_first = cw->cw_last = pos;
+        cw->cw_len = (int)len;
+        memcpy(cw->cw_word, p, len);
+        cw->cw_word[len] = NUL;
+        hash_add_item(&cws->cws_ht, hi, cw->cw_word, hash);
+        kv_push(cws->cws_words, cw);
+      } else {
+        ((complword_T *)(hi->hi_key - offsetof(complword_T, cw_word)))->cw_last = pos;
+      }
+      prev_class = class;
+      p = end;
+    }
+  }
+
+  kv_resize(cws->cws_by_last, kv_size(cws->cws_words));
+  for (size_t i = 0; i < kv_size(cws->cws_words); i++) {
+    kv_push(cws->cws_by_last, kv_A(cws->cws_words, i));
+  }
+  qsort(cws->cws_by_last.items, kv_size(cws->cws_by_last), sizeof(complword_T *),
+        compl_word_cmp_last);
+
+  buf->b_compl_words = cws;
+  return cws;
+}
+
+/// Free the index of the words in "buf".
+void ins_compl_free_words(buf_T *buf)
+{
+  struct compl_words_S *cws = buf->b_compl_words;
+  if (cws == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < kv_size(cws->cws_words); i++) {
+    xfree(kv_A(cws->cws_words, i));
+  }
+  kv_destroy(cws->cws_words);
+  kv_destroy(cws->cws_by_last);
+  hash_clear(&cws->cws_ht);
+  XFREE_CLEAR(buf->b_compl_words);
+}
+
+/// Like get_next_default_completion(), but use the index of the words in
+/// "st->ins_buf" instead of searching the text.  Only for keyword completion
+/// in another buffer, which is scanned from the start or the end.  Adding the
+/// words in order of their first or last occurrence gives the same matches.
+///
+/// @return  OK if a new next match is found, otherwise FAIL.
+static int get_next_indexed_completion(ins_compl_next_state_T *st)
+{
+  buf_T *buf = st->ins_buf;
+  struct compl_words_S *cws = ins_compl_words_get(buf);
+  const bool forward = compl_dir_forward();
+  const size_t count = kv_size(cws->cws_words);
+
+  // Find the first word after the previous match.
+  size_t lo = 0;
+  size_t hi = count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (forward ? ltoreq(kv_A(cws->cws_words, mid)->cw_first, *st->cur_match_pos)
+                : !lt(kv_A(cws->cws_by_last, count - 1 - mid)->cw_last, *st->cur_match_pos)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  regmatch_T regmatch;
+  regmatch.regprog = vim_regcomp(compl_pattern, magic_isset() ? RE_MAGIC : 0);
+  if (regmatch.regprog == NULL) {
+    return FAIL;
+  }
+  regmatch.rm_ic = ignorecase(compl_pattern);
+
+  int found_new_match = FAIL;
+  for (size_t i = lo; i < count && !got_int; i++) {
+    complword_T *cw = forward ? kv_A(cws->cws_words, i)
+                              : kv_A(cws->cws_by_last, count - 1 - i);
+    *st->cur_match_pos = forward ? cw->cw_first : cw->cw_last;
+    if (vim_regexec(&regmatch, cw->cw_word, 0)
+        && regmatch.startp[0] == cw->cw_word
+        && ins_compl_add_infercase(cw->cw_word, cw->cw_len, p_ic, buf->b_sfname,
+                                   0, false) != NOTDONE) {
+      found_new_match = OK;
+      break;
+    }
+  }
+  vim_regfree(regmatch.regprog);
+
+  if (found_new_match == FAIL) {
+    // Also fail for the next call.
+    if (forward) {
+      st->cur_match_pos->lnum = buf->b_ml.ml_line_count + 1;
+    } else {
+      st->cur_match_pos->lnum = 0;
+    }
+    st->cur_match_pos->col = 0;
+  }
+  return found_new_match;
+}
+
 /// Get the next set of words matching "compl_pattern" for default completion(s)
 /// (normal ^P/^N and ^X^L).
 /// Search for "compl_pattern" in the buffer "st->ins_buf" starting from the
@@ -3156,6 +3407,17 @@ static int get_next_default_completion(ins_compl_next_state_T *st, pos_T *start_
     p_scs = false;
   }
 
+  // Keyword completion in another buffer can use the index of its words,
+  // unless 'iskeyword' differs from the current buffer, which regexp and
+  // find_word_end() use.
+  if (st->ins_buf != curbuf && !ctrl_x_mode_line_or_eval() && !compl_status_adding()
+      && !(compl_cont_status & CONT_SOL) && strncmp(compl_pattern, "\\<", 2) == 0
+      && memcmp(st->ins_buf->b_chartab, curbuf->b_chartab, sizeof(curbuf->b_chartab)) == 0) {
+    int found_new_match = get_next_indexed_completion(st);
+    p_scs = save_p_scs;
+    return found_new_match;
+  }
+
   // Buffers other than curbuf are scanned from the beginning or the
   // end but never from the middle, thus setting nowrapscan in this
   // buffers is a good idea, on the other hand, we always set
@@ -4507,6 +4769,9 @@ static unsigned quote_meta(char *dest, char *src, int len)
 void free_insexpand_stuff(void)
 {
   XFREE_CLEAR(compl_orig_text);
+  for (int i = 0; i < DICT_CACHE_SIZE; i++) {
+    XFREE_CLEAR(dict_cache[i].dc_text);
+  }
   callback_free(&cfu_cb);
   callback_free(&ofu_cb);
   callback_free(&tsrfu_cb);
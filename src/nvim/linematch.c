@@ -1,5 +1,4 @@
 #include <assert.h>
-#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -11,16 +10,17 @@
 #include "nvim/pos.h"
 
 #define LN_MAX_BUFS 8
-#define LN_DECISION_MAX 255  // pow(2, LN_MAX_BUFS(8)) - 1 = 255
 
 // struct for running the diff linematch algorithm
+// The arrays have (1 << ndiffs) items, one for each possible decision, they
+// are allocated together for all the nodes of the tensor.
 typedef struct diffcmppath_S diffcmppath_T;
 struct diffcmppath_S {
   int df_lev_score;  // to keep track of the total score of this path
   size_t df_path_n;   // current index of this path
-  int df_choice_mem[LN_DECISION_MAX + 1];
-  int df_choice[LN_DECISION_MAX];
-  diffcmppath_T *df_decision[LN_DECISION_MAX];  // to keep track of this path traveled
+  int *df_choice_mem;
+  int *df_choice;
+  diffcmppath_T **df_decision;  // to keep track of this path traveled
   size_t df_optimal_choice;
 };
 
@@ -88,7 +88,11 @@ static int matching_chars(const char *s1, const char *s2)
 {
   size_t s1len = MIN(MATCH_CHAR_MAX_LEN - 1, line_len(s1));
   size_t s2len = MIN(MATCH_CHAR_MAX_LEN - 1, line_len(s2));
-  int matrix[2][MATCH_CHAR_MAX_LEN] = { 0 };
+  int matrix[2][MATCH_CHAR_MAX_LEN];
+  // Only the first "s2len + 1" items of each row are used, don't clear the
+  // whole matrix for every pair of short lines.
+  memset(matrix[0], 0, (s2len + 1) * sizeof(int));
+  memset(matrix[1], 0, (s2len + 1) * sizeof(int));
   bool icur = 1;  // save space by storing only two rows for i axis
   for (size_t i = 0; i < s1len; i++) {
     icur = !icur;
@@ -340,12 +344,21 @@ size_t linematch_nbuffers(const char **diff_blk, const int *diff_len, const size
   }
 
   // create the flattened path matrix
+  // Each node only needs room for the decisions possible with "ndiffs"
+  // buffers, instead of the 256 for LN_MAX_BUFS.  This keeps the memory used
+  // for two or three buffers small.
+  const size_t nchoices = (size_t)1 << ndiffs;
   diffcmppath_T *diffcmppath = xmalloc(sizeof(diffcmppath_T) * memsize);
-  // allocate memory here
+  int *choice_mem = xmalloc(sizeof(int) * memsize * nchoices);
+  int *choice = xmalloc(sizeof(int) * memsize * nchoices);
+  diffcmppath_T **decision = xmalloc(sizeof(diffcmppath_T *) * memsize * nchoices);
   for (size_t i = 0; i < memsize; i++) {
     diffcmppath[i].df_lev_score = 0;
     diffcmppath[i].df_path_n = 0;
-    for (size_t j = 0; j < (size_t)pow(2, (double)ndiffs); j++) {
+    diffcmppath[i].df_choice_mem = choice_mem + i * nchoices;
+    diffcmppath[i].df_choice = choice + i * nchoices;
+    diffcmppath[i].df_decision = decision + i * nchoices;
+    for (size_t j = 0; j < nchoices; j++) {
       diffcmppath[i].df_choice_mem[j] = -1;
     }
   }
@@ -373,6 +386,9 @@ size_t linematch_nbuffers(const char **diff_blk, const int *diff_len, const size
   }
 
   xfree(diffcmppath);
+  xfree(choice_mem);
+  xfree(choice);
+  xfree(decision);
 
   return n_optimal;
 }
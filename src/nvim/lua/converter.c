@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <lauxlib.h>
+#include <limits.h>
 #include <lua.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -170,6 +171,54 @@ static LuaTableProps nlua_traverse_table(lua_State *const lstate)
   return ret;
 }
 
+/// Convert a Lua number to a Number typval, or a Float if it doesn't fit.
+static typval_T nlua_number_to_tv(const lua_Number n)
+{
+  if (n > (lua_Number)VARNUMBER_MAX || n < (lua_Number)VARNUMBER_MIN
+      || ((lua_Number)((varnumber_T)n)) != n) {
+    return (typval_T) {
+      .v_type = VAR_FLOAT,
+      .v_lock = VAR_UNLOCKED,
+      .vval = { .v_float = (float_T)n },
+    };
+  }
+  return (typval_T) {
+    .v_type = VAR_NUMBER,
+    .v_lock = VAR_UNLOCKED,
+    .vval = { .v_number = (varnumber_T)n },
+  };
+}
+
+/// Append the string and number items of the sequence at the top of the Lua
+/// stack to `l`, starting after the items already in `l`, without going
+/// through the generic conversion stack.
+///
+/// Stops at the first item of another type, which is left for the generic
+/// conversion in nlua_pop_typval() to continue from.
+static void nlua_pop_simple_items(lua_State *const lstate, list_T *const l, const size_t maxidx)
+{
+  for (size_t i = (size_t)tv_list_len(l) + 1; i <= maxidx && i <= INT_MAX; i++) {
+    lua_rawgeti(lstate, -1, (int)i);
+    typval_T tv;
+    switch (lua_type(lstate, -1)) {
+    case LUA_TSTRING: {
+      size_t len;
+      const char *s = lua_tolstring(lstate, -1, &len);
+      tv = decode_string(s, len, kNone, true, false);
+      break;
+    }
+    case LUA_TNUMBER:
+      tv = nlua_number_to_tv(lua_tonumber(lstate, -1));
+      break;
+    default:
+      lua_pop(lstate, 1);
+      return;
+    }
+    lua_pop(lstate, 1);
+    tv_list_append_owned_tv(l, tv);
+  }
+}
+
 /// Helper structure for nlua_pop_typval
 typedef struct {
   typval_T *tv;  ///< Location where conversion result is saved.
@@ -296,18 +345,9 @@ bool nlua_pop_typval(lua_State *lstate, typval_T *ret_tv)
       }
       break;
     }
-    case LUA_TNUMBER: {
-      const lua_Number n = lua_tonumber(lstate, -1);
-      if (n > (lua_Number)VARNUMBER_MAX || n < (lua_Number)VARNUMBER_MIN
-          || ((lua_Number)((varnumber_T)n)) != n) {
-        cur.tv->v_type = VAR_FLOAT;
-        cur.tv->vval.v_float = (float_T)n;
-      } else {
-        cur.tv->v_type = VAR_NUMBER;
-        cur.tv->vval.v_number = (varnumber_T)n;
-      }
+    case LUA_TNUMBER:
+      *cur.tv = nlua_number_to_tv(lua_tonumber(lstate, -1));
       break;
-    }
     case LUA_TTABLE: {
       // Only need to track table refs if we have a metatable associated.
       LuaRef table_ref = LUA_NOREF;
@@ -333,7 +373,8 @@ bool nlua_pop_typval(lua_State *lstate, typval_T *ret_tv)
         cur.tv->vval.v_list = tv_list_alloc((ptrdiff_t)table_props.maxidx);
         cur.tv->vval.v_list->lua_table_ref = table_ref;
         tv_list_ref(cur.tv->vval.v_list);
-        if (table_props.maxidx != 0) {
+        nlua_pop_simple_items(lstate, cur.tv->vval.v_list, table_props.maxidx);
+        if ((size_t)tv_list_len(cur.tv->vval.v_list) < table_props.maxidx) {
           cur.container = true;
           cur.idx = lua_gettop(lstate);
           kvi_push(stack, cur);
@@ -597,6 +638,36 @@ static bool typval_conv_special = false;
 #undef TYPVAL_ENCODE_CONV_RECURSE
 #undef TYPVAL_ENCODE_ALLOW_SPECIALS
 
+/// Push a non-empty list containing only Strings and Numbers (such as the
+/// result of getline()) in a single pass.
+///
+/// @return false if `l` has other items, nothing was pushed then.
+static bool nlua_push_simple_list(lua_State *lstate, list_T *const l)
+{
+  if (tv_list_len(l) == 0 || tv_list_len(l) > INT_MAX) {
+    return false;
+  }
+  TV_LIST_ITER_CONST(l, li, {
+    const VarType type = TV_LIST_ITEM_TV(li)->v_type;
+    if (type != VAR_STRING && type != VAR_NUMBER) {
+      return false;
+    }
+  });
+  lua_createtable(lstate, tv_list_len(l), 0);
+  int idx = 1;
+  TV_LIST_ITER_CONST(l, li, {
+    const typval_T *const item = TV_LIST_ITEM_TV(li);
+    if (item->v_type == VAR_NUMBER) {
+      lua_pushnumber(lstate, (lua_Number)item->vval.v_number);
+    } else {
+      const char *const str = item->vval.v_string;
+      lua_pushlstring(lstate, str != NULL ? str : "", str != NULL ? strlen(str) : 0);
+    }
+    lua_rawseti(lstate, -2, idx++);
+  });
+  return true;
+}
+
 /// Convert Vimscript typval_T to lua value
 ///
 /// Should leave single value in lua stack. May only fail if lua failed to grow
@@ -615,6 +686,9 @@ bool nlua_push_typval(lua_State *lstate, typval_T *const tv, bool special)
     semsg(_("E1502: Lua failed to grow stack to %i"), initial_size + 4);
     return false;
   }
+  if (tv->v_type == VAR_LIST && nlua_push_simple_list(lstate, tv->vval.v_list)) {
+    return true;
+  }
   if (encode_vim_to_lua(lstate, tv, "nlua_push_typval argument") == FAIL) {
     return false;
   }
@@ -801,11 +875,27 @@ void nlua_push_Object(lua_State *lstate, const Object obj, bool special)
   }
 }
 
+/// Allocate zeroed memory for `count` container items
+///
+/// With a NULL arena this is plain xcalloc(), otherwise the memory is owned by
+/// the arena and must not be freed with api_free_*().
+static void *nlua_alloc_items(Arena *arena, size_t count, size_t size)
+{
+  if (!arena) {
+    return xcalloc(count, size);
+  }
+  void *mem = arena_alloc(arena, count * size, true);
+  memset(mem, 0, count * size);
+  return mem;
+}
+
 /// Convert lua value to string
 ///
 /// Always pops one value from the stack.
-String nlua_pop_String(lua_State *lstate, Error *err)
-  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_WARN_UNUSED_RESULT
+///
+/// @param  arena  Arena to allocate the string in, NULL to use xmalloc().
+String nlua_pop_String(lua_State *lstate, Arena *arena, Error *err)
+  FUNC_ATTR_NONNULL_ARG(1, 3) FUNC_ATTR_WARN_UNUSED_RESULT
 {
   if (lua_type(lstate, -1) != LUA_TSTRING) {
     lua_pop(lstate, 1);
@@ -816,7 +906,7 @@ String nlua_pop_String(lua_State *lstate, Error *err)
 
   ret.data = (char *)lua_tolstring(lstate, -1, &(ret.size));
   assert(ret.data != NULL);
-  ret.data = xmemdupz(ret.data, ret.size);
+  ret.data = arena_memdupz(arena, ret.data, ret.size);
   lua_pop(lstate, 1);
 
   return ret;
@@ -946,9 +1036,10 @@ Float nlua_pop_Float(lua_State *lstate, Error *err)
 ///
 /// @param  lstate  Lua state.
 /// @param[in]  table_props  nlua_traverse_table() output.
+/// @param  arena  Arena to allocate in, NULL to use xmalloc().
 /// @param[out]  err  Location where error will be saved.
 static Array nlua_pop_Array_unchecked(lua_State *const lstate, const LuaTableProps table_props,
-                                      Error *const err)
+                                      Arena *arena, Error *const err)
 {
   Array ret = { .size = table_props.maxidx, .items = NULL };
 
@@ -957,17 +1048,19 @@ static Array nlua_pop_Array_unchecked(lua_State *const lstate, const LuaTablePro
     return ret;
   }
 
-  ret.items = xcalloc(ret.size, sizeof(*ret.items));
+  ret.items = nlua_alloc_items(arena, ret.size, sizeof(*ret.items));
   for (size_t i = 1; i <= ret.size; i++) {
     Object val;
 
     lua_rawgeti(lstate, -1, (int)i);
 
-    val = nlua_pop_Object(lstate, false, err);
+    val = nlua_pop_Object(lstate, false, arena, err);
     if (ERROR_SET(err)) {
       ret.size = i - 1;
       lua_pop(lstate, 1);
-      api_free_array(ret);
+      if (!arena) {
+        api_free_array(ret);
+      }
       return (Array) { .size = 0, .items = NULL };
     }
     ret.items[i - 1] = val;
@@ -980,15 +1073,17 @@ static Array nlua_pop_Array_unchecked(lua_State *const lstate, const LuaTablePro
 /// Convert lua table to array
 ///
 /// Always pops one value from the stack.
-Array nlua_pop_Array(lua_State *lstate, Error *err)
-  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_WARN_UNUSED_RESULT
+///
+/// @param  arena  Arena to allocate the result in, NULL to use xmalloc().
+Array nlua_pop_Array(lua_State *lstate, Arena *arena, Error *err)
+  FUNC_ATTR_NONNULL_ARG(1, 3) FUNC_ATTR_WARN_UNUSED_RESULT
 {
   const LuaTableProps table_props = nlua_check_type(lstate, err,
                                                     kObjectTypeArray);
   if (table_props.type != kObjectTypeArray) {
     return (Array) { .size = 0, .items = NULL };
   }
-  return nlua_pop_Array_unchecked(lstate, table_props, err);
+  return nlua_pop_Array_unchecked(lstate, table_props, arena, err);
 }
 
 /// Convert lua table to dictionary
@@ -998,10 +1093,11 @@ Array nlua_pop_Array(lua_State *lstate, Error *err)
 ///
 /// @param  lstate  Lua interpreter state.
 /// @param[in]  table_props  nlua_traverse_table() output.
+/// @param  arena  Arena to allocate in, NULL to use xmalloc().
 /// @param[out]  err  Location where error will be saved.
 static Dictionary nlua_pop_Dictionary_unchecked(lua_State *lstate, const LuaTableProps table_props,
-                                                bool ref, Error *err)
-  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_WARN_UNUSED_RESULT
+                                                bool ref, Arena *arena, Error *err)
+  FUNC_ATTR_NONNULL_ARG(1, 5) FUNC_ATTR_WARN_UNUSED_RESULT
 {
   Dictionary ret = { .size = table_props.string_keys_num, .items = NULL };
 
@@ -1009,7 +1105,7 @@ static Dictionary nlua_pop_Dictionary_unchecked(lua_State *lstate, const LuaTabl
     lua_pop(lstate, 1);
     return ret;
   }
-  ret.items = xcalloc(ret.size, sizeof(*ret.items));
+  ret.items = nlua_alloc_items(arena, ret.size, sizeof(*ret.items));
 
   lua_pushnil(lstate);
   for (size_t i = 0; lua_next(lstate, -2) && i < ret.size;) {
@@ -1019,11 +1115,11 @@ static Dictionary nlua_pop_Dictionary_unchecked(lua_State *lstate, const LuaTabl
       lua_pushvalue(lstate, -2);
       // stack: dict, key, value, key
 
-      ret.items[i].key = nlua_pop_String(lstate, err);
+      ret.items[i].key = nlua_pop_String(lstate, arena, err);
       // stack: dict, key, value
 
       if (!ERROR_SET(err)) {
-        ret.items[i].value = nlua_pop_Object(lstate, ref, err);
+        ret.items[i].value = nlua_pop_Object(lstate, ref, arena, err);
         // stack: dict, key
       } else {
         lua_pop(lstate, 1);
@@ -1032,7 +1128,11 @@ static Dictionary nlua_pop_Dictionary_unchecked(lua_State *lstate, const LuaTabl
 
       if (ERROR_SET(err)) {
         ret.size = i;
-        api_free_dictionary(ret);
+        if (arena) {
+          api_luarefs_free_dict(ret);
+        } else {
+          api_free_dictionary(ret);
+        }
         lua_pop(lstate, 2);
         // stack:
         return (Dictionary) { .size = 0, .items = NULL };
@@ -1051,8 +1151,10 @@ static Dictionary nlua_pop_Dictionary_unchecked(lua_State *lstate, const LuaTabl
 /// Convert lua table to dictionary
 ///
 /// Always pops one value from the stack.
-Dictionary nlua_pop_Dictionary(lua_State *lstate, bool ref, Error *err)
-  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_WARN_UNUSED_RESULT
+///
+/// @param  arena  Arena to allocate the result in, NULL to use xmalloc().
+Dictionary nlua_pop_Dictionary(lua_State *lstate, bool ref, Arena *arena, Error *err)
+  FUNC_ATTR_NONNULL_ARG(1, 4) FUNC_ATTR_WARN_UNUSED_RESULT
 {
   const LuaTableProps table_props = nlua_check_type(lstate, err,
                                                     kObjectTypeDictionary);
@@ -1061,7 +1163,7 @@ Dictionary nlua_pop_Dictionary(lua_State *lstate, bool ref, Error *err)
     return (Dictionary) { .size = 0, .items = NULL };
   }
 
-  return nlua_pop_Dictionary_unchecked(lstate, table_props, ref, err);
+  return nlua_pop_Dictionary_unchecked(lstate, table_props, ref, arena, err);
 }
 
 /// Helper structure for nlua_pop_Object
@@ -1073,7 +1175,11 @@ typedef struct {
 /// Convert lua table to object
 ///
 /// Always pops one value from the stack.
-Object nlua_pop_Object(lua_State *const lstate, bool ref, Error *const err)
+///
+/// @param  arena  Arena to allocate the result in, NULL to use xmalloc().
+///                Lua references in the result are never owned by the arena,
+///                see api_luarefs_free_object().
+Object nlua_pop_Object(lua_State *const lstate, bool ref, Arena *arena, Error *const err)
 {
   Object ret = NIL;
   const int initial_size = lua_gettop(lstate);
@@ -1110,7 +1216,7 @@ Object nlua_pop_Object(lua_State *const lstate, bool ref, Error *const err)
           const char *s = lua_tolstring(lstate, -2, &len);
           const size_t idx = cur.obj->data.dictionary.size++;
           cur.obj->data.dictionary.items[idx].key = (String) {
-            .data = xmemdupz(s, len),
+            .data = arena_memdupz(arena, s, len),
             .size = len,
           };
           kvi_push(stack, cur);
@@ -1153,7 +1259,7 @@ Object nlua_pop_Object(lua_State *const lstate, bool ref, Error *const err)
     case LUA_TSTRING: {
       size_t len;
       const char *s = lua_tolstring(lstate, -1, &len);
-      *cur.obj = STRING_OBJ(((String) { .data = xmemdupz(s, len), .size = len }));
+      *cur.obj = STRING_OBJ(((String) { .data = arena_memdupz(arena, s, len), .size = len }));
       break;
     }
     case LUA_TNUMBER: {
@@ -1174,8 +1280,8 @@ Object nlua_pop_Object(lua_State *const lstate, bool ref, Error *const err)
         *cur.obj = ARRAY_OBJ(((Array) { .items = NULL, .size = 0, .capacity = 0 }));
         if (table_props.maxidx != 0) {
           cur.obj->data.array.items =
-            xcalloc(table_props.maxidx,
-                    sizeof(cur.obj->data.array.items[0]));
+            nlua_alloc_items(arena, table_props.maxidx,
+                             sizeof(cur.obj->data.array.items[0]));
           cur.obj->data.array.capacity = table_props.maxidx;
           cur.container = true;
           kvi_push(stack, cur);
@@ -1185,8 +1291,8 @@ Object nlua_pop_Object(lua_State *const lstate, bool ref, Error *const err)
         *cur.obj = DICTIONARY_OBJ(((Dictionary) { .items = NULL, .size = 0, .capacity = 0 }));
         if (table_props.string_keys_num != 0) {
           cur.obj->data.dictionary.items =
-            xcalloc(table_props.string_keys_num,
-                    sizeof(cur.obj->data.dictionary.items[0]));
+            nlua_alloc_items(arena, table_props.string_keys_num,
+                             sizeof(cur.obj->data.dictionary.items[0]));
           cur.obj->data.dictionary.capacity = table_props.string_keys_num;
           cur.container = true;
           kvi_push(stack, cur);
@@ -1239,7 +1345,11 @@ type_error:
   }
   kvi_destroy(stack);
   if (ERROR_SET(err)) {
-    api_free_object(ret);
+    if (arena) {
+      api_luarefs_free_object(ret);
+    } else {
+      api_free_object(ret);
+    }
     ret = NIL;
     lua_pop(lstate, lua_gettop(lstate) - initial_size + 1);
   }
@@ -1316,7 +1426,8 @@ void nlua_init_types(lua_State *const lstate)
 }
 
 // lua specific variant of api_dict_to_keydict
-void nlua_pop_keydict(lua_State *L, void *retval, FieldHashfn hashy, char **err_opt, Error *err)
+void nlua_pop_keydict(lua_State *L, void *retval, FieldHashfn hashy, char **err_opt, Arena *arena,
+                      Error *err)
 {
   if (!lua_istable(L, -1)) {
     api_set_error(err, kErrorTypeValidation, "Expected Lua table");
@@ -1343,22 +1454,22 @@ void nlua_pop_keydict(lua_State *L, void *retval, FieldHashfn hashy, char **err_
     char *mem = ((char *)retval + field->ptr_off);
 
     if (field->type == kObjectTypeNil) {
-      *(Object *)mem = nlua_pop_Object(L, true, err);
+      *(Object *)mem = nlua_pop_Object(L, true, arena, err);
     } else if (field->type == kObjectTypeInteger) {
       *(Integer *)mem = nlua_pop_Integer(L, err);
     } else if (field->type == kObjectTypeBoolean) {
       *(Boolean *)mem = nlua_pop_Boolean_strict(L, err);
     } else if (field->type == kObjectTypeString) {
-      *(String *)mem = nlua_pop_String(L, err);
+      *(String *)mem = nlua_pop_String(L, arena, err);
     } else if (field->type == kObjectTypeFloat) {
       *(Float *)mem = nlua_pop_Float(L, err);
     } else if (field->type == kObjectTypeBuffer || field->type == kObjectTypeWindow
                || field->type == kObjectTypeTabpage) {
       *(handle_T *)mem = nlua_pop_handle(L, err);
     } else if (field->type == kObjectTypeArray) {
-      *(Array *)mem = nlua_pop_Array(L, err);
+      *(Array *)mem = nlua_pop_Array(L, arena, err);
     } else if (field->type == kObjectTypeDictionary) {
-      *(Dictionary *)mem = nlua_pop_Dictionary(L, false, err);
+      *(Dictionary *)mem = nlua_pop_Dictionary(L, false, arena, err);
     } else if (field->type == kObjectTypeLuaRef) {
       *(LuaRef *)mem = nlua_pop_LuaRef(L, err);
     } else {
@@ -36,6 +36,7 @@
 #include "nvim/getchar.h"
 #include "nvim/gettext.h"
 #include "nvim/globals.h"
+#include "nvim/hashtab.h"
 #include "nvim/keycodes.h"
 #include "nvim/lua/converter.h"
 #include "nvim/lua/executor.h"
@@ -50,6 +51,7 @@
 #include "nvim/option_vars.h"
 #include "nvim/os/fileio.h"
 #include "nvim/os/os.h"
+#include "nvim/os/time.h"
 #include "nvim/path.h"
 #include "nvim/pos.h"
 #include "nvim/profile.h"
@@ -71,6 +73,9 @@ static LuaRef require_ref = LUA_REFNIL;
 
 static uv_thread_t main_thread;
 
+/// Nesting of nlua_pcall(), read by the sampling profiler.
+static volatile int nlua_pcall_depth = 0;
+
 typedef struct {
   Error err;
   String lua_err_str;
@@ -82,6 +87,21 @@ typedef struct {
   size_t size;
 } ModuleDef;
 
+/// Chunk compiled by nlua_exec(), kept for when the same source is sent again.
+typedef struct {
+  char *src;  ///< copy of the source, NULL for an unused entry
+  size_t len;
+  hash_T hash;
+  LuaRef ref;  ///< the compiled function
+  uint64_t last_used;
+} ExecCacheEntry;
+
+#define EXEC_CACHE_SIZE 32
+#define EXEC_CACHE_MAX_LEN (64 * 1024)  ///< longer sources are not cached
+
+static ExecCacheEntry exec_cache[EXEC_CACHE_SIZE];
+static uint64_t exec_cache_tick = 0;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "lua/executor.c.generated.h"
 # include "lua/vim_module.generated.h"
@@ -159,7 +179,11 @@ int nlua_pcall(lua_State *lstate, int nargs, int nresults)
   lua_getfield(lstate, -1, "traceback");
   lua_remove(lstate, -2);
   lua_insert(lstate, -2 - nargs);
+  nlua_pcall_depth++;
+  AllocTag prev_tag = alloc_tag_push(kAllocTagLua);
   int status = lua_pcall(lstate, nargs, nresults, -2 - nargs);
+  alloc_tag_pop(prev_tag);
+  nlua_pcall_depth--;
   if (status) {
     lua_remove(lstate, -2);
   } else {
@@ -168,6 +192,51 @@ int nlua_pcall(lua_State *lstate, int nargs, int nresults)
   return status;
 }
 
+/// Count hook set by nlua_sample_request(): add the Lua stack to the current
+/// sample of the sampling profiler.
+static void nlua_sample_hook(lua_State *lstate, lua_Debug *ar)
+{
+  lua_sethook(lstate, NULL, 0, 0);
+
+  lua_Debug info;
+  int depth = 0;
+  while (depth < 16 && lua_getstack(lstate, depth, &info)) {
+    depth++;
+  }
+  for (int level = depth - 1; level >= 0; level--) {
+    if (!lua_getstack(lstate, level, &info) || !lua_getinfo(lstate, "Sn", &info)
+        || *info.what == 'C') {
+      continue;
+    }
+    char frame[256];
+    if (info.name != NULL) {
+      snprintf(frame, sizeof(frame), "%s (%s:%d)", info.name, info.short_src, info.linedefined);
+    } else {
+      snprintf(frame, sizeof(frame), "%s:%d", info.short_src, info.linedefined);
+    }
+    profile_sample_push_lua(frame);
+  }
+  profile_sample_lua_done();
+}
+
+/// Called from the signal handler of the sampling profiler.  When Lua code is
+/// running, sets a hook that adds the Lua stack to the sample at the next
+/// instruction, as taking it in the signal handler is not safe.
+///
+/// @return  false if no Lua code is running or another hook is set.
+bool nlua_sample_request(void)
+{
+  if (nlua_pcall_depth == 0 || global_lstate == NULL) {
+    return false;
+  }
+  lua_Hook hook = lua_gethook(global_lstate);
+  if (hook != NULL && hook != nlua_sample_hook) {
+    return false;
+  }
+  lua_sethook(global_lstate, nlua_sample_hook, LUA_MASKCOUNT, 1);
+  return true;
+}
+
 static void nlua_luv_error_event(void **argv)
 {
   char *error = (char *)argv[0];
@@ -302,7 +371,7 @@ static int nlua_thr_api_nvim__get_runtime(lua_State *lstate)
   lua_pop(lstate, 1);
 
   Error err = ERROR_INIT;
-  const Array pat = nlua_pop_Array(lstate, &err);
+  const Array pat = nlua_pop_Array(lstate, NULL, &err);
   if (ERROR_SET(&err)) {
     luaL_where(lstate, 1);
     lua_pushstring(lstate, err.msg);
@@ -713,6 +782,170 @@ static int nlua_ui_detach(lua_State *lstate)
   return 0;
 }
 
+/// Version of the bytecode cache format, shared with vim.loader.
+#define LUAC_VERSION 4
+
+/// Directory of the bytecode cache, or NULL if not yet initialized.
+static char *luac_dir = NULL;
+
+/// Gets the path of the bytecode cache file for a Lua source file.
+///
+/// Uses the same naming as vim.loader, so that both share cache entries.
+///
+/// @return [allocated] cache path
+static char *luac_cache_file(const char *path)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_NONNULL_RET
+{
+  if (luac_dir == NULL) {
+    luac_dir = stdpaths_user_cache_subpath("luac");
+  }
+  StringBuilder sb = KV_INITIAL_VALUE;
+  kv_concat(sb, luac_dir);
+  kv_push(sb, PATHSEP);
+  for (const char *p = path; *p != NUL; p++) {
+    if (ASCII_ISALNUM(*p) || vim_strchr("-_.!~*'()", (uint8_t)(*p)) != NULL) {
+      kv_push(sb, *p);
+    } else {
+      kv_printf(sb, "%%%02X", (uint8_t)(*p));
+    }
+  }
+  const char *ext = (sb.size >= 4 && strncmp(sb.items + sb.size - 4, ".lua", 4) == 0)
+                    ? "c" : ".luac";
+  kv_concat(sb, ext);
+  kv_push(sb, NUL);
+  return sb.items;
+}
+
+/// Formats the header of a cache entry, which identifies the source file by
+/// its size and modification time.
+static size_t luac_header(char *buf, size_t bufsize, const FileInfo *info)
+  FUNC_ATTR_NONNULL_ALL
+{
+  int len = snprintf(buf, bufsize, "%d,%" PRIu64 ",%" PRId64 ",%" PRId64, LUAC_VERSION,
+                     (uint64_t)info->stat.st_size, (int64_t)info->stat.st_mtim.tv_sec,
+                     (int64_t)info->stat.st_mtim.tv_nsec);
+  // include the NUL separating the header from the chunk
+  return (size_t)len + 1;
+}
+
+static int luac_writer(lua_State *lstate, const void *p, size_t sz, void *ud)
+{
+  StringBuilder *sb = (StringBuilder *)ud;
+  kv_concat_len(*sb, p, sz);
+  return 0;
+}
+
+/// Loads the bytecode of "path" from the cache, if it is up to date.
+///
+/// @return true if a chunk was pushed onto the stack.
+static bool luac_read(lua_State *lstate, const char *path, const char *cname,
+                      const FileInfo *info)
+  FUNC_ATTR_NONNULL_ALL
+{
+  FileInfo cinfo;
+  if (!os_fileinfo(cname, &cinfo)) {
+    return false;
+  }
+  char header[128];
+  size_t header_len = luac_header(header, sizeof(header), info);
+  size_t size = (size_t)cinfo.stat.st_size;
+  if (size <= header_len) {
+    return false;
+  }
+
+  FileDescriptor fp;
+  if (file_open(&fp, cname, kFileReadOnly, 0) != 0) {
+    return false;
+  }
+  char *data = xmalloc(size);
+  ptrdiff_t read_size = file_read(&fp, data, size);
+  file_close(&fp, false);
+
+  bool ok = false;
+  if (read_size == (ptrdiff_t)size && memcmp(data, header, header_len) == 0) {
+    size_t namelen = strlen(path) + 2;
+    char *chunkname = xmalloc(namelen);
+    snprintf(chunkname, namelen, "@%s", path);
+    // A chunk written by a different LuaJIT build fails to load here, and is
+    // then simply replaced.
+    if (luaL_loadbuffer(lstate, data + header_len, size - header_len, chunkname) == 0) {
+      ok = true;
+    } else {
+      lua_pop(lstate, 1);
+    }
+    xfree(chunkname);
+  }
+  xfree(data);
+  return ok;
+}
+
+/// Writes the bytecode of the chunk on top of the stack to the cache.
+static void luac_write(lua_State *lstate, const char *cname, const FileInfo *info)
+  FUNC_ATTR_NONNULL_ALL
+{
+  // A file modified within the last second could be modified again without
+  // changing its size and timestamp. Don't cache it yet, or a stale entry
+  // might be used later.
+  if ((int64_t)info->stat.st_mtim.tv_sec + 1 >= (int64_t)os_time()) {
+    return;
+  }
+
+  StringBuilder sb = KV_INITIAL_VALUE;
+  kv_resize(sb, 128);
+  sb.size = luac_header(sb.items, sb.capacity, info);
+  if (lua_dump(lstate, luac_writer, &sb) != 0) {
+    kv_destroy(sb);
+    return;
+  }
+
+  // Write to a temporary file first, so that a concurrent Nvim never reads a
+  // partially written entry.
+  size_t tmplen = strlen(cname) + 5;
+  char *tmpname = xmalloc(tmplen);
+  snprintf(tmpname, tmplen, "%s.tmp", cname);
+  FileDescriptor fp;
+  if (file_open(&fp, tmpname, kFileCreate|kFileTruncate|kFileMkDir, 0644) == 0) {
+    bool ok = file_write(&fp, sb.items, sb.size) == (ptrdiff_t)sb.size;
+    ok = file_close(&fp, false) == 0 && ok;
+    if (!ok || os_rename(tmpname, cname) != OK) {
+      os_remove(tmpname);
+    }
+  }
+  xfree(tmpname);
+  kv_destroy(sb);
+}
+
+/// "vim._loadfile(path)" function
+///
+/// Like loadfile(), but uses the bytecode cache in `stdpath('cache')/luac`.
+/// Cache entries are validated by the size and modification time of "path".
+static int nlua_loadfile(lua_State *lstate)
+{
+  const char *path = luaL_checkstring(lstate, 1);
+  FileInfo info;
+  // For a missing file, let luaL_loadfile() produce the error.
+  char *cname = NULL;
+  if (os_fileinfo(path, &info) && !S_ISDIR(info.stat.st_mode)) {
+    cname = luac_cache_file(path);
+    if (luac_read(lstate, path, cname, &info)) {
+      xfree(cname);
+      return 1;
+    }
+  }
+
+  if (luaL_loadfile(lstate, path) != 0) {
+    xfree(cname);
+    lua_pushnil(lstate);
+    lua_insert(lstate, -2);
+    return 2;
+  }
+  if (cname != NULL) {
+    luac_write(lstate, cname, &info);
+    xfree(cname);
+  }
+  return 1;
+}
+
 /// Initialize lua interpreter state
 ///
 /// Called by lua interpreter itself to initialize state.
@@ -777,6 +1010,10 @@ static bool nlua_state_init(lua_State *const lstate) FUNC_ATTR_NONNULL_ALL
   lua_pushcfunction(lstate, &nlua_ui_detach);
   lua_setfield(lstate, -2, "ui_detach");
 
+  // _loadfile
+  lua_pushcfunction(lstate, &nlua_loadfile);
+  lua_setfield(lstate, -2, "_loadfile");
+
   nlua_common_vim_init(lstate, false, false);
 
   // patch require() (only for --startuptime)
@@ -789,6 +1026,10 @@ static bool nlua_state_init(lua_State *const lstate) FUNC_ATTR_NONNULL_ALL
     lua_setglobal(lstate, "require");
   }
 
+  // compiled v:lua calls, see nlua_typval_call()
+  lua_createtable(lstate, 0, 0);
+  lua_setfield(lstate, LUA_REGISTRYINDEX, "nlua.v_lua_calls");
+
   // internal vim._treesitter... API
   nlua_add_treesitter(lstate);
 
@@ -908,6 +1149,9 @@ void nlua_free_all_mem(void)
   }
   lua_State *lstate = global_lstate;
   nlua_unref_global(lstate, require_ref);
+  XFREE_CLEAR(luac_dir);
+  nlua_str_utf_cache_free(lstate);
+  nlua_exec_cache_free(lstate);
   nlua_common_free_all_mem(lstate);
 }
 
@@ -1237,7 +1481,7 @@ static int nlua_rpc(lua_State *lstate, bool request)
 
   for (int i = 0; i < nargs; i++) {
     lua_pushvalue(lstate, i + 3);
-    ADD(args, nlua_pop_Object(lstate, false, &err));
+    ADD(args, nlua_pop_Object(lstate, false, NULL, &err));
     if (ERROR_SET(&err)) {
       api_free_array(args);
       goto check_err;
@@ -1403,27 +1647,61 @@ void nlua_typval_call(const char *str, size_t len, typval_T *const args, int arg
                       typval_T *ret_tv)
   FUNC_ATTR_NONNULL_ALL
 {
+  if (check_secure()) {
+    ret_tv->v_type = VAR_NUMBER;
+    ret_tv->vval.v_number = 0;
+    return;
+  }
+
+  lua_State *const lstate = global_lstate;
+
+  // Compiling the call costs more than the call itself for a function that
+  // is invoked for every line, like a 'foldexpr'.  Keep the compiled chunk,
+  // the function is still looked up by name on every call.
+  lua_getfield(lstate, LUA_REGISTRYINDEX, "nlua.v_lua_calls");
+  lua_pushlstring(lstate, str, len);
+  lua_rawget(lstate, -2);
+  if (lua_isnil(lstate, -1)) {
+    lua_pop(lstate, 1);
 #define CALLHEADER "return "
 #define CALLSUFFIX "(...)"
-  const size_t lcmd_len = sizeof(CALLHEADER) - 1 + len + sizeof(CALLSUFFIX) - 1;
-  char *lcmd;
-  if (lcmd_len < IOSIZE) {
-    lcmd = IObuff;
-  } else {
-    lcmd = xmalloc(lcmd_len);
-  }
-  memcpy(lcmd, CALLHEADER, sizeof(CALLHEADER) - 1);
-  memcpy(lcmd + sizeof(CALLHEADER) - 1, str, len);
-  memcpy(lcmd + sizeof(CALLHEADER) - 1 + len, CALLSUFFIX,
-         sizeof(CALLSUFFIX) - 1);
+    const size_t lcmd_len = sizeof(CALLHEADER) - 1 + len + sizeof(CALLSUFFIX) - 1;
+    char *lcmd;
+    if (lcmd_len < IOSIZE) {
+      lcmd = IObuff;
+    } else {
+      lcmd = xmalloc(lcmd_len);
+    }
+    memcpy(lcmd, CALLHEADER, sizeof(CALLHEADER) - 1);
+    memcpy(lcmd + sizeof(CALLHEADER) - 1, str, len);
+    memcpy(lcmd + sizeof(CALLHEADER) - 1 + len, CALLSUFFIX,
+           sizeof(CALLSUFFIX) - 1);
 #undef CALLHEADER
 #undef CALLSUFFIX
 
-  nlua_typval_exec(lcmd, lcmd_len, "v:lua", args, argcount, false, ret_tv);
+    const int status = luaL_loadbuffer(lstate, lcmd, lcmd_len, "v:lua");
+    if (lcmd != IObuff) {
+      xfree(lcmd);
+    }
+    if (status) {
+      lua_remove(lstate, -2);
+      nlua_error(lstate, _("E5107: Error loading lua %.*s"));
+      return;
+    }
+    lua_pushlstring(lstate, str, len);
+    lua_pushvalue(lstate, -2);
+    lua_rawset(lstate, -4);
+  }
+  lua_remove(lstate, -2);
 
-  if (lcmd != IObuff) {
-    xfree(lcmd);
+  PUSH_ALL_TYPVALS(lstate, args, argcount, false);
+
+  if (nlua_pcall(lstate, argcount, 1)) {
+    nlua_error(lstate, _("E5108: Error executing lua %.*s"));
+    return;
   }
+
+  nlua_pop_typval(lstate, ret_tv);
 }
 
 void nlua_call_user_expand_func(expand_T *xp, typval_T *ret_tv)
@@ -1535,11 +1813,68 @@ int typval_exec_lua_callable(LuaRef lua_cb, int argcount, typval_T *argvars, typ
 /// @param[out]  err  Location where error will be saved.
 ///
 /// @return Return value of the execution.
+/// Push the compiled chunk for "str", using the chunk compiled by an earlier
+/// call with the same source when there is one.
+///
+/// Chunks are not cached when loading fails, so that the error is reported
+/// every time.
+///
+/// @return  false with the error message on the stack when loading failed
+static bool nlua_exec_load(lua_State *const lstate, const String str)
+{
+  if (str.size > EXEC_CACHE_MAX_LEN) {
+    return luaL_loadbuffer(lstate, str.data, str.size, "<nvim>") == 0;
+  }
+
+  const hash_T hash = hash_hash_len(str.data, str.size);
+  ExecCacheEntry *e = &exec_cache[0];
+  for (int i = 0; i < EXEC_CACHE_SIZE; i++) {
+    ExecCacheEntry *const c = &exec_cache[i];
+    if (c->src != NULL && c->hash == hash && c->len == str.size
+        && memcmp(c->src, str.data, str.size) == 0) {
+      c->last_used = ++exec_cache_tick;
+      nlua_pushref(lstate, c->ref);
+      return true;
+    }
+    // reuse an unused entry or else the least recently used one
+    if (e->src != NULL && (c->src == NULL || c->last_used < e->last_used)) {
+      e = c;
+    }
+  }
+
+  if (luaL_loadbuffer(lstate, str.data, str.size, "<nvim>")) {
+    return false;
+  }
+  if (e->src != NULL) {
+    luaL_unref(lstate, LUA_REGISTRYINDEX, e->ref);
+    xfree(e->src);
+  }
+  e->src = xmemdupz(str.data, str.size);
+  e->len = str.size;
+  e->hash = hash;
+  e->last_used = ++exec_cache_tick;
+  lua_pushvalue(lstate, -1);
+  e->ref = luaL_ref(lstate, LUA_REGISTRYINDEX);
+  return true;
+}
+
+/// Free the chunks cached by nlua_exec().
+static void nlua_exec_cache_free(lua_State *const lstate)
+{
+  for (int i = 0; i < EXEC_CACHE_SIZE; i++) {
+    ExecCacheEntry *const e = &exec_cache[i];
+    if (e->src != NULL) {
+      luaL_unref(lstate, LUA_REGISTRYINDEX, e->ref);
+      XFREE_CLEAR(e->src);
+    }
+  }
+}
+
 Object nlua_exec(const String str, const Array args, Error *err)
 {
   lua_State *const lstate = global_lstate;
 
-  if (luaL_loadbuffer(lstate, str.data, str.size, "<nvim>")) {
+  if (!nlua_exec_load(lstate, str)) {
     size_t len;
     const char *errstr = lua_tolstring(lstate, -1, &len);
     api_set_error(err, kErrorTypeValidation,
@@ -1559,7 +1894,7 @@ Object nlua_exec(const String str, const Array args, Error *err)
     return NIL;
   }
 
-  return nlua_pop_Object(lstate, false, err);
+  return nlua_pop_Object(lstate, false, NULL, err);
 }
 
 bool nlua_ref_is_function(LuaRef ref)
@@ -1616,7 +1951,7 @@ Object nlua_call_ref(LuaRef ref, const char *name, Array args, bool retval, Erro
     if (err == NULL) {
       err = &dummy;
     }
-    return nlua_pop_Object(lstate, false, err);
+    return nlua_pop_Object(lstate, false, NULL, err);
   } else {
     bool value = lua_toboolean(lstate, -1);
     lua_pop(lstate, 1);
@@ -1770,7 +2105,7 @@ bool nlua_exec_file(const char *path)
 {
   lua_State *const lstate = global_lstate;
   if (!strequal(path, "-")) {
-    lua_getglobal(lstate, "loadfile");
+    lua_pushcfunction(lstate, &nlua_loadfile);
     lua_pushstring(lstate, path);
   } else {
     FileDescriptor *stdin_dup = file_open_stdin();
@@ -1903,7 +2238,7 @@ int nlua_expand_pat(expand_T *xp, char *pat, int *num_results, char ***results)
     goto cleanup;
   }
 
-  Array completions = nlua_pop_Array(lstate, &err);
+  Array completions = nlua_pop_Array(lstate, NULL, &err);
   if (ERROR_SET(&err)) {
     ret = FAIL;
     goto cleanup_array;
@@ -38,6 +38,18 @@
 #include "nvim/types.h"
 #include "nvim/vim.h"
 
+/// Character boundaries of a string, for vim.str_utfindex() and
+/// vim.str_byteindex().  LSP clients convert many positions on the same line,
+/// this avoids decoding the line from the start for each of them.
+typedef struct {
+  const char *str;  ///< the string, kept alive by "ref".  NULL when unused
+  size_t len;
+  LuaRef ref;
+  size_t nchars;
+  size_t *starts;   ///< byte offset of each character, starts[nchars] is the end
+  size_t *units;    ///< UTF-16 code units before each character
+} UtfCache;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "lua/stdlib.c.generated.h"
 #endif
@@ -131,6 +143,80 @@ static int regex_match_line(lua_State *lstate)
   return nret;
 }
 
+static int regex_match_lines(lua_State *lstate)
+{
+  regprog_T **prog = regex_check(lstate);
+
+  handle_T bufnr = (handle_T)luaL_checkinteger(lstate, 2);
+  linenr_T start = (linenr_T)luaL_optinteger(lstate, 3, 0);
+  linenr_T end = (linenr_T)luaL_optinteger(lstate, 4, -1);
+  bool all = false;
+  if (!lua_isnoneornil(lstate, 5)) {
+    luaL_checktype(lstate, 5, LUA_TTABLE);
+    lua_getfield(lstate, 5, "all");
+    all = lua_toboolean(lstate, -1);
+    lua_pop(lstate, 1);
+  }
+
+  buf_T *buf = bufnr ? handle_get_buffer(bufnr) : curbuf;
+  if (!buf || buf->b_ml.ml_mfp == NULL) {
+    return luaL_error(lstate, "invalid buffer");
+  }
+
+  // Like nvim_buf_get_lines(): negative means counted from the end.
+  linenr_T line_count = buf->b_ml.ml_line_count;
+  if (start < 0) {
+    start += line_count + 1;
+  }
+  if (end < 0) {
+    end += line_count + 1;
+  }
+  if (start < 0 || start > line_count) {
+    return luaL_error(lstate, "invalid start");
+  }
+  if (end < start || end > line_count) {
+    return luaL_error(lstate, "invalid end");
+  }
+
+  lua_createtable(lstate, 0, 0);
+  int n = 0;
+
+  regmatch_T rm;
+  rm.regprog = *prog;
+  rm.rm_ic = false;
+  for (linenr_T lnum = start; lnum < end && rm.regprog != NULL; lnum++) {
+    char *line = ml_get_buf(buf, lnum + 1);
+    colnr_T col = 0;
+    while (vim_regexec(&rm, line, col)) {
+      lua_pushinteger(lstate, lnum);
+      lua_rawseti(lstate, -2, ++n);
+      lua_pushinteger(lstate, (lua_Integer)(rm.startp[0] - line));
+      lua_rawseti(lstate, -2, ++n);
+      lua_pushinteger(lstate, (lua_Integer)(rm.endp[0] - line));
+      lua_rawseti(lstate, -2, ++n);
+
+      if (!all) {
+        break;
+      }
+      col = (colnr_T)(rm.endp[0] - line);
+      if (rm.endp[0] == rm.startp[0]) {
+        // Empty match: continue after the next character.
+        if (line[col] == NUL) {
+          break;
+        }
+        col += utfc_ptr2len(line + col);
+      }
+    }
+  }
+  *prog = rm.regprog;
+
+  if (!*prog) {
+    return luaL_error(lstate, "regex: internal error");
+  }
+
+  return 1;
+}
+
 static regprog_T **regex_check(lua_State *L)
 {
   return luaL_checkudata(L, 1, "nvim_regex");
@@ -154,19 +240,187 @@ static struct luaL_Reg regex_meta[] = {
   { "__tostring", regex_tostring },
   { "match_str", regex_match_str },
   { "match_line", regex_match_line },
+  { "match_lines", regex_match_lines },
   { NULL, NULL }
 };
 
+#define UTF_CACHE_SIZE 4
+#define UTF_CACHE_MIN_LEN 64  ///< shorter strings are decoded every time
+
+static UtfCache utf_cache[UTF_CACHE_SIZE];
+static int utf_cache_next = 0;
+// last string that was not cached, it is cached when used again
+static const char *utf_cache_last = NULL;
+static size_t utf_cache_last_len = 0;
+
+static void utf_cache_clear(lua_State *lstate, UtfCache *e)
+{
+  if (e->str == NULL) {
+    return;
+  }
+  luaL_unref(lstate, LUA_REGISTRYINDEX, e->ref);
+  XFREE_CLEAR(e->starts);
+  XFREE_CLEAR(e->units);
+  e->str = NULL;
+}
+
+/// Get the cached boundaries of string "s", which is at stack index 1.
+///
+/// @param now  cache "s" now, otherwise only when it is used a second time
+///
+/// @return  NULL when "s" is not cached
+static UtfCache *utf_cache_get(lua_State *lstate, const char *s, size_t len, bool now)
+{
+  for (int i = 0; i < UTF_CACHE_SIZE; i++) {
+    if (utf_cache[i].str == s && utf_cache[i].len == len) {
+      return &utf_cache[i];
+    }
+  }
+  if (len < UTF_CACHE_MIN_LEN) {
+    return NULL;
+  }
+  if (!now && (s != utf_cache_last || len != utf_cache_last_len)) {
+    utf_cache_last = s;
+    utf_cache_last_len = len;
+    return NULL;
+  }
+
+  UtfCache *e = &utf_cache[utf_cache_next];
+  utf_cache_next = (utf_cache_next + 1) % UTF_CACHE_SIZE;
+  utf_cache_clear(lstate, e);
+
+  size_t nchars = 0;
+  for (size_t i = 0; i < len; i += (size_t)utf_ptr2len_len(s + i, (int)(len - i))) {
+    nchars++;
+  }
+  e->starts = xmalloc((nchars + 1) * sizeof(size_t));
+  e->units = xmalloc((nchars + 1) * sizeof(size_t));
+  size_t units = 0;
+  size_t clen;
+  size_t n = 0;
+  size_t i;
+  for (i = 0; i < len; i += clen, n++) {
+    clen = (size_t)utf_ptr2len_len(s + i, (int)(len - i));
+    // same as mb_utflen()
+    int c = (clen > 1) ? utf_ptr2char(s + i) : (uint8_t)s[i];
+    e->starts[n] = i;
+    e->units[n] = units;
+    units += c > 0xFFFF ? 2 : 1;
+  }
+  // beyond "len" for an incomplete sequence at the end, like
+  // mb_utf_index_to_bytes() returns
+  e->starts[nchars] = i;
+  e->units[nchars] = units;
+  e->nchars = nchars;
+  e->str = s;
+  e->len = len;
+  lua_pushvalue(lstate, 1);
+  e->ref = luaL_ref(lstate, LUA_REGISTRYINDEX);
+  return e;
+}
+
+/// Free the cached string boundaries.
+void nlua_str_utf_cache_free(lua_State *lstate)
+{
+  for (int i = 0; i < UTF_CACHE_SIZE; i++) {
+    utf_cache_clear(lstate, &utf_cache[i]);
+  }
+}
+
+/// Like mb_utflen() for the first "idx" bytes of the string, using cache "e"
+/// when it is not NULL.
+static void str_utfindex(UtfCache *e, const char *s, size_t idx, size_t *codepoints,
+                         size_t *codeunits)
+{
+  if (e != NULL) {
+    // find the number of characters starting before "idx"
+    size_t lo = 0;
+    size_t hi = e->nchars;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (e->starts[mid] < idx) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    // mb_utflen() decodes the character at the end as if the string stops at
+    // "idx".  That only differs for invalid bytes, which are single byte
+    // characters here.
+    if (lo == 0 || e->starts[lo] - e->starts[lo - 1] > 1
+        || ((uint8_t)s[e->starts[lo - 1]] & 0xc0) != 0x80) {
+      *codepoints = lo;
+      *codeunits = e->units[lo];
+      return;
+    }
+  }
+  *codepoints = 0;
+  *codeunits = 0;
+  mb_utflen(s, idx, codepoints, codeunits);
+}
+
+/// Like mb_utf_index_to_bytes(), using cache "e" when it is not NULL.
+static ssize_t str_byteindex(UtfCache *e, const char *s, size_t len, size_t index,
+                             bool use_utf16)
+{
+  if (e == NULL) {
+    return mb_utf_index_to_bytes(s, len, index, use_utf16);
+  }
+  if (index == 0) {
+    return 0;
+  }
+  if (!use_utf16) {
+    return index > e->nchars ? -1 : (ssize_t)e->starts[index];
+  }
+  // find the first character that ends at or after "index" code units
+  size_t lo = 1;
+  size_t hi = e->nchars + 1;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (e->units[mid] < index) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo > e->nchars ? -1 : (ssize_t)e->starts[lo];
+}
+
 /// convert byte index to UTF-32 and UTF-16 indices
 ///
 /// Expects a string and an optional index. If no index is supplied, the length
-/// of the string is returned.
+/// of the string is returned.  The index can also be a list of indices.
 ///
-/// Returns two values: the UTF-32 and UTF-16 indices.
+/// Returns two values: the UTF-32 and UTF-16 indices, or two lists of them.
 int nlua_str_utfindex(lua_State *const lstate) FUNC_ATTR_NONNULL_ALL
 {
   size_t s1_len;
   const char *s1 = luaL_checklstring(lstate, 1, &s1_len);
+  if (lua_istable(lstate, 2)) {
+    int n = (int)lua_objlen(lstate, 2);
+    UtfCache *e = utf_cache_get(lstate, s1, s1_len, n > 1);
+    lua_createtable(lstate, n, 0);
+    lua_createtable(lstate, n, 0);
+    for (int i = 1; i <= n; i++) {
+      lua_rawgeti(lstate, 2, i);
+      if (!lua_isnumber(lstate, -1)) {
+        return luaL_error(lstate, "index list must contain integers");
+      }
+      intptr_t idx = lua_tointeger(lstate, -1);
+      lua_pop(lstate, 1);
+      if (idx < 0 || idx > (intptr_t)s1_len) {
+        return luaL_error(lstate, "index out of range");
+      }
+      size_t codepoints, codeunits;
+      str_utfindex(e, s1, (size_t)idx, &codepoints, &codeunits);
+      lua_pushinteger(lstate, (lua_Integer)codepoints);
+      lua_rawseti(lstate, -3, i);
+      lua_pushinteger(lstate, (lua_Integer)codeunits);
+      lua_rawseti(lstate, -2, i);
+    }
+    return 2;
+  }
+
   intptr_t idx;
   if (lua_isnoneornil(lstate, 2)) {
     idx = (intptr_t)s1_len;
@@ -177,8 +431,9 @@ int nlua_str_utfindex(lua_State *const lstate) FUNC_ATTR_NONNULL_ALL
     }
   }
 
-  size_t codepoints = 0, codeunits = 0;
-  mb_utflen(s1, (size_t)idx, &codepoints, &codeunits);
+  size_t codepoints, codeunits;
+  str_utfindex(utf_cache_get(lstate, s1, s1_len, false), s1, (size_t)idx,
+               &codepoints, &codeunits);
 
   lua_pushinteger(lstate, (lua_Integer)codepoints);
   lua_pushinteger(lstate, (lua_Integer)codeunits);
@@ -249,26 +504,161 @@ static int nlua_str_utf_end(lua_State *const lstate) FUNC_ATTR_NONNULL_ALL
   return 1;
 }
 
+/// Splits a string at each instance of a plain separator.
+///
+/// Expects three args: string, separator (not empty) and trimempty.
+/// Used by vim.split(), see there for details.
+///
+/// Returns a list of the segments.
+static int nlua_split_plain(lua_State *const lstate) FUNC_ATTR_NONNULL_ALL
+{
+  size_t s_len;
+  size_t sep_len;
+  const char *s = luaL_checklstring(lstate, 1, &s_len);
+  const char *sep = luaL_checklstring(lstate, 2, &sep_len);
+  const bool trimempty = lua_toboolean(lstate, 3);
+  if (sep_len == 0) {
+    return luaL_argerror(lstate, 2, "empty separator");
+  }
+
+  lua_createtable(lstate, 0, 0);
+  const char *const end = s + s_len;
+  int n = 0;
+  // With trimempty: empty segments not added yet, or -1 before the first
+  // non-empty segment.
+  int empty = trimempty ? -1 : 0;
+  while (true) {
+    const char *p = s;
+    const char *seg_end = end;
+    while ((size_t)(end - p) >= sep_len
+           && (p = memchr(p, (uint8_t)sep[0], (size_t)(end - p) - sep_len + 1)) != NULL) {
+      if (memcmp(p, sep, sep_len) == 0) {
+        seg_end = p;
+        break;
+      }
+      p++;
+    }
+
+    if (s == seg_end && trimempty) {
+      if (empty >= 0) {
+        empty++;
+      }
+    } else {
+      for (; empty > 0; empty--) {
+        lua_pushliteral(lstate, "");
+        lua_rawseti(lstate, -2, ++n);
+      }
+      empty = 0;
+      lua_pushlstring(lstate, s, (size_t)(seg_end - s));
+      lua_rawseti(lstate, -2, ++n);
+    }
+
+    if (seg_end == end) {
+      break;
+    }
+    s = seg_end + sep_len;
+  }
+  return 1;
+}
+
+/// Appends the items of list "idx" to the list on top of the stack, flattening
+/// nested lists.
+static void nlua_tbl_flatten_into(lua_State *const lstate, int idx, int *n)
+  FUNC_ATTR_NONNULL_ALL
+{
+  luaL_checkstack(lstate, 2, "nested too deeply");
+  const int len = (int)lua_objlen(lstate, idx);
+  for (int i = 1; i <= len; i++) {
+    lua_pushinteger(lstate, i);
+    lua_gettable(lstate, idx);
+    if (lua_istable(lstate, -1)) {
+      lua_insert(lstate, -2);  // [item, result]
+      nlua_tbl_flatten_into(lstate, lua_gettop(lstate) - 1, n);
+      lua_insert(lstate, -2);  // [result, item]
+      lua_pop(lstate, 1);
+    } else if (lua_toboolean(lstate, -1)) {
+      lua_rawseti(lstate, -2, ++*n);
+    } else {
+      lua_pop(lstate, 1);
+    }
+  }
+}
+
+/// Flattens a list-like table, used by vim.tbl_flatten().
+///
+/// Returns the flattened copy.
+static int nlua_tbl_flatten(lua_State *const lstate) FUNC_ATTR_NONNULL_ALL
+{
+  luaL_checktype(lstate, 1, LUA_TTABLE);
+  lua_settop(lstate, 1);
+  lua_createtable(lstate, 0, 0);
+  int n = 0;
+  nlua_tbl_flatten_into(lstate, 1, &n);
+  return 1;
+}
+
+/// Lists the keys of a table, used by vim.tbl_keys().
+///
+/// Returns the list of keys.
+static int nlua_tbl_keys(lua_State *const lstate) FUNC_ATTR_NONNULL_ALL
+{
+  luaL_checktype(lstate, 1, LUA_TTABLE);
+  lua_settop(lstate, 1);
+  lua_createtable(lstate, 0, 0);
+  int n = 0;
+  lua_pushnil(lstate);
+  while (lua_next(lstate, 1)) {
+    lua_pop(lstate, 1);
+    lua_pushvalue(lstate, -1);
+    lua_rawseti(lstate, 2, ++n);
+  }
+  return 1;
+}
+
 /// convert UTF-32 or UTF-16 indices to byte index.
 ///
 /// Expects up to three args: string, index and use_utf16.
 /// If use_utf16 is not supplied it defaults to false (use UTF-32)
+/// The index can also be a list of indices.
 ///
-/// Returns the byte index.
+/// Returns the byte index, or a list of them.
 int nlua_str_byteindex(lua_State *const lstate) FUNC_ATTR_NONNULL_ALL
 {
   size_t s1_len;
   const char *s1 = luaL_checklstring(lstate, 1, &s1_len);
-  intptr_t idx = luaL_checkinteger(lstate, 2);
-  if (idx < 0) {
-    return luaL_error(lstate, "index out of range");
-  }
   bool use_utf16 = false;
   if (lua_gettop(lstate) >= 3) {
     use_utf16 = lua_toboolean(lstate, 3);
   }
 
-  ssize_t byteidx = mb_utf_index_to_bytes(s1, s1_len, (size_t)idx, use_utf16);
+  if (lua_istable(lstate, 2)) {
+    int n = (int)lua_objlen(lstate, 2);
+    UtfCache *e = utf_cache_get(lstate, s1, s1_len, n > 1);
+    lua_createtable(lstate, n, 0);
+    for (int i = 1; i <= n; i++) {
+      lua_rawgeti(lstate, 2, i);
+      if (!lua_isnumber(lstate, -1)) {
+        return luaL_error(lstate, "index list must contain integers");
+      }
+      intptr_t idx = lua_tointeger(lstate, -1);
+      lua_pop(lstate, 1);
+      ssize_t byteidx = idx < 0 ? -1 : str_byteindex(e, s1, s1_len, (size_t)idx, use_utf16);
+      if (byteidx == -1) {
+        return luaL_error(lstate, "index out of range");
+      }
+      lua_pushinteger(lstate, (lua_Integer)byteidx);
+      lua_rawseti(lstate, -2, i);
+    }
+    return 1;
+  }
+
+  intptr_t idx = luaL_checkinteger(lstate, 2);
+  if (idx < 0) {
+    return luaL_error(lstate, "index out of range");
+  }
+
+  ssize_t byteidx = str_byteindex(utf_cache_get(lstate, s1, s1_len, false), s1, s1_len,
+                                  (size_t)idx, use_utf16);
   if (byteidx == -1) {
     return luaL_error(lstate, "index out of range");
   }
@@ -611,6 +1001,14 @@ void nlua_state_add_stdlib(lua_State *const lstate, bool is_thread)
     nlua_state_add_internal(lstate);
   }
 
+  // _split_plain, _tbl_flatten, _tbl_keys: used by vim.shared
+  lua_pushcfunction(lstate, &nlua_split_plain);
+  lua_setfield(lstate, -2, "_split_plain");
+  lua_pushcfunction(lstate, &nlua_tbl_flatten);
+  lua_setfield(lstate, -2, "_tbl_flatten");
+  lua_pushcfunction(lstate, &nlua_tbl_keys);
+  lua_setfield(lstate, -2, "_tbl_keys");
+
   // vim.mpack
   luaopen_mpack(lstate);
   lua_pushvalue(lstate, -1);
@@ -17,9 +17,14 @@
 #include "klib/kvec.h"
 #include "nvim/api/private/helpers.h"
 #include "nvim/buffer_defs.h"
+#include "nvim/decoration.h"
+#include "nvim/event/loop.h"
+#include "nvim/gettext.h"
 #include "nvim/globals.h"
+#include "nvim/lua/executor.h"
 #include "nvim/lua/treesitter.h"
 #include "nvim/macros.h"
+#include "nvim/main.h"
 #include "nvim/map.h"
 #include "nvim/memline.h"
 #include "nvim/memory.h"
@@ -35,10 +40,42 @@
 #define TS_META_QUERYCURSOR "treesitter_querycursor"
 #define TS_META_TREECURSOR "treesitter_treecursor"
 
+/// A capture recorded by the capture cache
+typedef struct {
+  TSNode node;
+  uint32_t capture_index;
+  uint32_t match_id;
+  uint16_t pattern_index;
+  uint16_t capture_count;
+  TSQueryCapture *captures;  ///< Captures of the match if predicates must run, else NULL.
+} TSLuaCachedCapture;
+
+/// Captures of a query over a node and row range, recorded as they are
+/// iterated so a later _rawquery() with the same arguments can replay them.
+typedef struct {
+  const TSTree *tree;
+  const void *node_id;
+  const TSQuery *query;
+  uint32_t start_row;
+  uint32_t end_row;
+  kvec_t(TSLuaCachedCapture) captures;
+  TSQueryCursor *cursor;  ///< Produces the captures not recorded yet, NULL when done.
+  int pending_match;  ///< Match whose "active" state decides if the rest is removed.
+  int max_match_id;
+  int refcount;  ///< Number of iterators using the entry.
+  bool dead;  ///< Not in capture_cache anymore, freed when refcount drops to 0.
+} TSLuaCaptureEntry;
+
 typedef struct {
   TSQueryCursor *cursor;
   int predicated_match;
   int max_match_id;
+  TSLuaCaptureEntry *entry;  ///< Set if captures are read from the capture cache.
+  size_t pos;  ///< Next capture of entry to return.
+  // Used by query_next_highlight()
+  handle_T hl_buf;
+  uint64_t hl_ns;
+  DecorPriority hl_priority;
 } TSLua_cursor;
 
 typedef struct {
@@ -52,6 +89,19 @@ typedef struct {
   TSTree *tree;
 } TSLuaTree;
 
+/// State of a parser:parse_async() call
+typedef struct {
+  TSParser *parser;
+  TSTree *old_tree;  ///< Copy of the previous tree, or NULL.
+  TSTree *new_tree;  ///< Result, NULL if parsing failed.
+  TSLogger logger;  ///< Logger of the parser, disabled while parsing.
+  char *text;  ///< Snapshot of the buffer text.
+  uint32_t len;
+  LuaRef parser_ref;  ///< Keeps the parser userdata alive.
+  LuaRef cb;
+  bool include_bytes;
+} TSLuaParseJob;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "lua/treesitter.c.generated.h"
 #endif
@@ -60,6 +110,7 @@ static struct luaL_Reg parser_meta[] = {
   { "__gc", parser_gc },
   { "__tostring", parser_tostring },
   { "parse", parser_parse },
+  { "parse_async", parser_parse_async },
   { "reset", parser_reset },
   { "set_included_ranges", parser_set_ranges },
   { "included_ranges", parser_get_ranges },
@@ -138,7 +189,13 @@ static struct luaL_Reg treecursor_meta[] = {
 };
 
 static kvec_t(TSQueryCursor *) cursors = KV_INITIAL_VALUE;
+// Most recently used entry last. Small, as the highlighter only needs a few
+// entries per visible tree.
+#define CAPTURE_CACHE_SIZE 16
+static kvec_t(TSLuaCaptureEntry *) capture_cache = KV_INITIAL_VALUE;
 static PMap(cstr_t) langs = MAP_INIT;
+// parsers used by a parse_async() job which must not be touched until it is done
+static Set(ptr_t) busy_parsers = SET_INIT;
 
 static void build_meta(lua_State *L, const char *tname, const luaL_Reg *meta)
 {
@@ -326,6 +383,16 @@ static TSParser **parser_check(lua_State *L, uint16_t index)
   return luaL_checkudata(L, index, TS_META_PARSER);
 }
 
+/// Like parser_check(), but raises an error if a background parse is using the parser.
+static TSParser **parser_check_idle(lua_State *L, uint16_t index)
+{
+  TSParser **p = parser_check(L, index);
+  if (p && *p && set_has(ptr_t, &busy_parsers, *p)) {
+    luaL_error(L, "parser is busy with parse_async()");
+  }
+  return p;
+}
+
 static void logger_gc(TSLogger logger)
 {
   if (!logger.log) {
@@ -343,6 +410,10 @@ static int parser_gc(lua_State *L)
   if (!p) {
     return 0;
   }
+  // Only possible when exiting, the worker thread might still use the parser.
+  if (set_has(ptr_t, &busy_parsers, *p)) {
+    return 0;
+  }
 
   logger_gc(ts_parser_logger(*p));
   ts_parser_delete(*p);
@@ -355,36 +426,44 @@ static int parser_tostring(lua_State *L)
   return 1;
 }
 
+/// Provide tree-sitter with buffer text starting at `position`
+///
+/// Fills the buffer with as many lines as fit, instead of a single one, so a
+/// full parse needs far fewer calls. Consecutive lines are usually in the same
+/// memline data block, which ml_get_buf() keeps locked.
 static const char *input_cb(void *payload, uint32_t byte_index, TSPoint position,
                             uint32_t *bytes_read)
 {
   buf_T *bp = payload;
-#define BUFSIZE 256
+#define BUFSIZE 4096
   static char buf[BUFSIZE];
 
-  if ((linenr_T)position.row >= bp->b_ml.ml_line_count) {
-    *bytes_read = 0;
-    return "";
-  }
-  char *line = ml_get_buf(bp, (linenr_T)position.row + 1);
-  size_t len = strlen(line);
-  if (position.column > len) {
-    *bytes_read = 0;
-    return "";
-  }
-  size_t tocopy = MIN(len - position.column, BUFSIZE);
-
-  memcpy(buf, line + position.column, tocopy);
-  // Translate embedded \n to NUL
-  memchrsub(buf, '\n', '\0', tocopy);
-  *bytes_read = (uint32_t)tocopy;
-  if (tocopy < BUFSIZE) {
-    // now add the final \n. If it didn't fit, input_cb will be called again
-    // on the same line with advanced column.
-    buf[tocopy] = '\n';
-    (*bytes_read)++;
-  }
-  return buf;
+  linenr_T lnum = (linenr_T)position.row + 1;
+  size_t col = position.column;
+  size_t filled = 0;
+  while (lnum <= bp->b_ml.ml_line_count) {
+    char *line = ml_get_buf(bp, lnum);
+    size_t len = strlen(line);
+    if (col > len) {
+      break;
+    }
+    size_t tocopy = MIN(len - col, BUFSIZE - filled);
+
+    memcpy(buf + filled, line + col, tocopy);
+    // Translate embedded \n to NUL
+    memchrsub(buf + filled, '\n', '\0', tocopy);
+    filled += tocopy;
+    if (filled == BUFSIZE) {
+      // The rest of the line, and its final \n, is provided by the next call
+      // on the same line with advanced column.
+      break;
+    }
+    buf[filled++] = '\n';
+    lnum++;
+    col = 0;
+  }
+  *bytes_read = (uint32_t)filled;
+  return filled ? buf : "";
 #undef BUFSIZE
 }
 
@@ -418,7 +497,7 @@ static void push_ranges(lua_State *L, const TSRange *ranges, const size_t length
 
 static int parser_parse(lua_State *L)
 {
-  TSParser **p = parser_check(L, 1);
+  TSParser **p = parser_check_idle(L, 1);
   if (!p || !(*p)) {
     return 0;
   }
@@ -486,9 +565,122 @@ static int parser_parse(lua_State *L)
   return 2;
 }
 
+static void parse_async_work(void *data)
+{
+  TSLuaParseJob *job = data;
+  job->new_tree = ts_parser_parse_string(job->parser, job->old_tree, job->text, job->len);
+}
+
+static void parse_async_done(void **argv)
+{
+  TSLuaParseJob *job = argv[0];
+  lua_State *const L = get_global_lstate();
+
+  ts_parser_set_logger(job->parser, job->logger);
+  set_del(ptr_t, &busy_parsers, job->parser);
+  xfree(job->text);
+
+  nlua_pushref(L, job->cb);  // [cb]
+  int nargs = 1;
+  if (job->new_tree) {
+    uint32_t n_ranges = 0;
+    TSRange *changed = job->old_tree
+                       ? ts_tree_get_changed_ranges(job->old_tree, job->new_tree, &n_ranges)
+                       : NULL;
+    lua_pushnil(L);  // [cb, nil]
+    push_tree(L, job->new_tree);  // [cb, nil, tree]
+    push_ranges(L, changed, n_ranges, job->include_bytes);  // [cb, nil, tree, ranges]
+    xfree(changed);
+    nargs = 3;
+  } else {
+    lua_pushstring(L, "An error occurred when parsing.");  // [cb, err]
+  }
+
+  if (job->old_tree) {
+    ts_tree_delete(job->old_tree);
+  }
+  nlua_unref_global(L, job->cb);
+  nlua_unref_global(L, job->parser_ref);
+  xfree(job);
+
+  if (nlua_pcall(L, nargs, 0)) {
+    nlua_error(L, _("Error executing treesitter parse callback: %.*s"));
+  }
+}
+
+/// parser:parse_async(old_tree, bufnr, include_bytes, callback)
+///
+/// Like parser:parse() for a buffer, but parses a snapshot of the buffer text
+/// on a worker thread. `callback(err, tree, changed_ranges)` is invoked from
+/// the main loop when done. Edits of the buffer made in the meantime are not
+/// reflected in the new tree, the caller needs to apply them with tree:edit().
+/// The parser cannot be used until the callback was invoked.
+static int parser_parse_async(lua_State *L)
+{
+  TSParser **p = parser_check_idle(L, 1);
+  if (!p || !(*p)) {
+    return 0;
+  }
+
+  TSTree *old_tree = NULL;
+  if (!lua_isnil(L, 2)) {
+    TSLuaTree *ud = tree_check(L, 2);
+    old_tree = ud ? ud->tree : NULL;
+  }
+
+  handle_T bufnr = (handle_T)luaL_checkinteger(L, 3);
+  buf_T *buf = handle_get_buffer(bufnr);
+  if (!buf) {
+#define BUFSIZE 256
+    char ebuf[BUFSIZE] = { 0 };
+    vim_snprintf(ebuf, BUFSIZE, "invalid buffer handle: %d", bufnr);
+    return luaL_argerror(L, 3, ebuf);
+#undef BUFSIZE
+  }
+  bool include_bytes = lua_toboolean(L, 4);
+  luaL_checktype(L, 5, LUA_TFUNCTION);
+
+  // Same text as input_cb() would provide: NL for every line and NUL for
+  // embedded newlines.
+  StringBuilder text = KV_INITIAL_VALUE;
+  for (linenr_T lnum = 1; lnum <= buf->b_ml.ml_line_count; lnum++) {
+    char *line = ml_get_buf(buf, lnum);
+    size_t len = strlen(line);
+    size_t needed = len + 1;
+    kv_ensure_space(text, needed);
+    memcpy(text.items + text.size, line, len);
+    memchrsub(text.items + text.size, '\n', '\0', len);
+    text.size += len;
+    kv_push(text, '\n');
+  }
+  if (text.size > UINT32_MAX) {
+    kv_destroy(text);
+    return luaL_error(L, "buffer too large to parse");
+  }
+
+  TSLuaParseJob *job = xmalloc(sizeof(*job));
+  *job = (TSLuaParseJob) {
+    .parser = *p,
+    .old_tree = old_tree ? ts_tree_copy(old_tree) : NULL,
+    .logger = ts_parser_logger(*p),
+    .text = text.items,
+    .len = (uint32_t)text.size,
+    .parser_ref = nlua_ref_global(L, 1),
+    .cb = nlua_ref_global(L, 5),
+    .include_bytes = include_bytes,
+  };
+
+  // The logger calls into Lua, which is only possible on the main thread.
+  ts_parser_set_logger(*p, (TSLogger) { 0 });
+  set_put(ptr_t, &busy_parsers, *p);
+
+  loop_queue_work(&main_loop, parse_async_work, parse_async_done, job);
+  return 0;
+}
+
 static int parser_reset(lua_State *L)
 {
-  TSParser **p = parser_check(L, 1);
+  TSParser **p = parser_check_idle(L, 1);
   if (p && *p) {
     ts_parser_reset(*p);
   }
@@ -531,6 +723,9 @@ static int tree_edit(lua_State *L)
   TSInputEdit edit = { start_byte, old_end_byte, new_end_byte,
                        start_point, old_end_point, new_end_point };
 
+  // Cached nodes keep their old positions, so even captures before the edit
+  // would need ts_node_edit(). Just drop them.
+  capture_cache_invalidate(ud->tree, NULL);
   ts_tree_edit(ud->tree, &edit);
 
   return 0;
@@ -625,7 +820,7 @@ static int parser_set_ranges(lua_State *L)
                       "not enough args to parser:set_included_ranges()");
   }
 
-  TSParser **p = parser_check(L, 1);
+  TSParser **p = parser_check_idle(L, 1);
   if (!p) {
     return 0;
   }
@@ -670,7 +865,7 @@ static int parser_get_ranges(lua_State *L)
 
 static int parser_set_timeout(lua_State *L)
 {
-  TSParser **p = parser_check(L, 1);
+  TSParser **p = parser_check_idle(L, 1);
   if (!p) {
     return 0;
   }
@@ -715,7 +910,7 @@ static void logger_cb(void *payload, TSLogType logtype, const char *s)
 
 static int parser_set_logger(lua_State *L)
 {
-  TSParser **p = parser_check(L, 1);
+  TSParser **p = parser_check_idle(L, 1);
   if (!p) {
     return 0;
   }
@@ -810,6 +1005,7 @@ static int tree_gc(lua_State *L)
 {
   TSLuaTree *ud = tree_check(L, 1);
   if (ud) {
+    capture_cache_invalidate(ud->tree, NULL);
     ts_tree_delete(ud->tree);
   }
   return 0;
@@ -1382,66 +1578,301 @@ static int query_next_match(lua_State *L)
   return 0;
 }
 
-static int query_next_capture(lua_State *L)
+// Capture cache
+
+static void capture_entry_free(TSLuaCaptureEntry *entry)
 {
-  // Upvalues are:
-  // [ cursor, node, query, current_match ]
-  TSLua_cursor *ud = lua_touserdata(L, lua_upvalueindex(1));
-  TSQueryCursor *cursor = ud->cursor;
+  for (size_t i = 0; i < kv_size(entry->captures); i++) {
+    xfree(kv_A(entry->captures, i).captures);
+  }
+  kv_destroy(entry->captures);
+  if (entry->cursor) {
+    kv_push(cursors, entry->cursor);
+  }
+  xfree(entry);
+}
 
-  TSQuery *query = query_check(L, lua_upvalueindex(3));
+static void capture_entry_unref(TSLuaCaptureEntry *entry)
+{
+  if (--entry->refcount == 0 && entry->dead) {
+    capture_entry_free(entry);
+  }
+}
 
-  if (ud->predicated_match > -1) {
-    lua_getfield(L, lua_upvalueindex(4), "active");
-    bool active = lua_toboolean(L, -1);
-    lua_pop(L, 1);
-    if (!active) {
-      ts_query_cursor_remove_match(cursor, (uint32_t)ud->predicated_match);
+static void capture_cache_remove(size_t idx)
+{
+  TSLuaCaptureEntry *entry = kv_A(capture_cache, idx);
+  memmove(&kv_A(capture_cache, idx), &kv_A(capture_cache, idx + 1),
+          (kv_size(capture_cache) - idx - 1) * sizeof(entry));
+  kv_size(capture_cache)--;
+  entry->dead = true;
+  if (entry->refcount == 0) {
+    capture_entry_free(entry);
+  }
+}
+
+/// Drop the cached captures of `tree` or `query`
+static void capture_cache_invalidate(const TSTree *tree, const TSQuery *query)
+{
+  for (size_t i = kv_size(capture_cache); i > 0; i--) {
+    TSLuaCaptureEntry *entry = kv_A(capture_cache, i - 1);
+    if ((tree && entry->tree == tree) || (query && entry->query == query)) {
+      capture_cache_remove(i - 1);
     }
-    ud->predicated_match = -1;
   }
+}
+
+static TSLuaCaptureEntry *capture_cache_get(TSNode node, const TSQuery *query, uint32_t start_row,
+                                            uint32_t end_row)
+{
+  for (size_t i = 0; i < kv_size(capture_cache); i++) {
+    TSLuaCaptureEntry *entry = kv_A(capture_cache, i);
+    if (entry->tree == node.tree && entry->node_id == node.id && entry->query == query
+        && entry->start_row == start_row && entry->end_row == end_row) {
+      memmove(&kv_A(capture_cache, i), &kv_A(capture_cache, i + 1),
+              (kv_size(capture_cache) - i - 1) * sizeof(entry));
+      kv_A(capture_cache, kv_size(capture_cache) - 1) = entry;
+      return entry;
+    }
+  }
+  return NULL;
+}
 
+static TSLuaCaptureEntry *capture_cache_put(TSNode node, const TSQuery *query, uint32_t start_row,
+                                            uint32_t end_row, TSQueryCursor *cursor)
+{
+  if (kv_size(capture_cache) == CAPTURE_CACHE_SIZE) {
+    capture_cache_remove(0);
+  }
+  TSLuaCaptureEntry *entry = xmalloc(sizeof(*entry));
+  *entry = (TSLuaCaptureEntry) {
+    .tree = node.tree,
+    .node_id = node.id,
+    .query = query,
+    .start_row = start_row,
+    .end_row = end_row,
+    .captures = KV_INITIAL_VALUE,
+    .cursor = cursor,
+    .pending_match = -1,
+    .max_match_id = -1,
+  };
+  kv_push(capture_cache, entry);
+  return entry;
+}
+
+/// Record the next capture of the cursor of `entry`
+///
+/// @return false if there are no more captures
+static bool capture_entry_advance(TSLuaCaptureEntry *entry, TSQuery *query)
+{
   TSQueryMatch match;
   uint32_t capture_index;
-  if (ts_query_cursor_next_capture(cursor, &match, &capture_index)) {
-    TSQueryCapture capture = match.captures[capture_index];
+  if (!ts_query_cursor_next_capture(entry->cursor, &match, &capture_index)) {
+    kv_push(cursors, entry->cursor);
+    entry->cursor = NULL;
+    return false;
+  }
+
+  TSLuaCachedCapture rec = {
+    .node = match.captures[capture_index].node,
+    .capture_index = match.captures[capture_index].index,
+    .match_id = match.id,
+    .pattern_index = match.pattern_index,
+  };
 
+  uint32_t n_pred;
+  ts_query_predicates_for_pattern(query, match.pattern_index, &n_pred);
+  if (n_pred > 0 && (entry->max_match_id < (int)match.id)) {
+    entry->max_match_id = (int)match.id;
+    rec.capture_count = match.capture_count;
+    rec.captures = xmemdup(match.captures, match.capture_count * sizeof(*match.captures));
+    if (match.capture_count > 1) {
+      entry->pending_match = (int)match.id;
+    }
+  }
+  kv_push(entry->captures, rec);
+  return true;
+}
+
+/// Get the next capture of a _rawquery() iterator
+///
+/// Shared by the Lua iterator and the highlighter. Captures come from the
+/// cursor, or from the capture cache entry of the iterator.
+///
+/// @param match_idx  Stack index of the match table, whose "active" field
+///                   tells whether the rest of the last predicated match is
+///                   removed.
+/// @param[out] cap  The capture. `captures` is only set for the first capture
+///                  of a match with predicates and is valid until the next call.
+///
+/// @return false if there are no more captures
+static bool rawquery_next_capture(lua_State *L, TSLua_cursor *ud, TSQuery *query, int match_idx,
+                                  TSLuaCachedCapture *cap)
+{
+  TSLuaCaptureEntry *entry = ud->entry;
+  TSQueryCursor *cursor = entry ? entry->cursor : ud->cursor;
+
+  if (ud->predicated_match > -1) {
+    // With the cache, only the match of the last recorded capture can still
+    // affect the cursor.
+    if (!entry || (ud->predicated_match == entry->pending_match
+                   && ud->pos == kv_size(entry->captures))) {
+      lua_getfield(L, match_idx, "active");
+      bool active = lua_toboolean(L, -1);
+      lua_pop(L, 1);
+      if (!active && cursor) {
+        ts_query_cursor_remove_match(cursor, (uint32_t)ud->predicated_match);
+      }
+      if (entry) {
+        entry->pending_match = -1;
+      }
+    }
+    ud->predicated_match = -1;
+  }
+
+  if (entry) {
+    if (ud->pos == kv_size(entry->captures)
+        && (!entry->cursor || !capture_entry_advance(entry, query))) {
+      return false;
+    }
+    *cap = kv_A(entry->captures, ud->pos++);
+  } else {
+    TSQueryMatch match;
+    uint32_t capture_index;
+    if (!ts_query_cursor_next_capture(cursor, &match, &capture_index)) {
+      return false;
+    }
     // TODO(vigoux): handle capture quantifiers here
-    lua_pushinteger(L, capture.index + 1);  // [index]
-    push_node(L, capture.node, lua_upvalueindex(2));  // [index, node]
+    *cap = (TSLuaCachedCapture) {
+      .node = match.captures[capture_index].node,
+      .capture_index = match.captures[capture_index].index,
+      .match_id = match.id,
+      .pattern_index = match.pattern_index,
+    };
 
     // Now check if we need to run the predicates
     uint32_t n_pred;
     ts_query_predicates_for_pattern(query, match.pattern_index, &n_pred);
-
     if (n_pred > 0 && (ud->max_match_id < (int)match.id)) {
       ud->max_match_id = (int)match.id;
+      cap->capture_count = match.capture_count;
+      cap->captures = (TSQueryCapture *)match.captures;
+    }
+  }
+
+  if (cap->captures && cap->capture_count > 1) {
+    ud->predicated_match = (int)cap->match_id;
+  }
+  return true;
+}
+
+/// Fill the match table on top of the stack with the captures of `cap`
+static void push_capture_match(lua_State *L, TSLuaCachedCapture *cap, int nodeidx)
+{
+  for (int i = 0; i < cap->capture_count; i++) {
+    push_node(L, cap->captures[i].node, nodeidx);
+    lua_rawseti(L, -2, (int)cap->captures[i].index + 1);
+  }
+  lua_pushinteger(L, cap->pattern_index + 1);
+  lua_setfield(L, -2, "pattern");
+
+  if (cap->capture_count > 1) {
+    lua_pushboolean(L, false);
+    lua_setfield(L, -2, "active");
+  }
+}
+
+static int query_next_capture(lua_State *L)
+{
+  // Upvalues are:
+  // [ cursor, node, query, current_match ]
+  TSLua_cursor *ud = lua_touserdata(L, lua_upvalueindex(1));
+  TSQuery *query = query_check(L, lua_upvalueindex(3));
+
+  TSLuaCachedCapture cap;
+  if (!rawquery_next_capture(L, ud, query, lua_upvalueindex(4), &cap)) {
+    return 0;
+  }
+
+  lua_pushinteger(L, cap.capture_index + 1);  // [index]
+  push_node(L, cap.node, lua_upvalueindex(2));  // [index, node]
+  if (!cap.captures) {
+    return 2;
+  }
+
+  lua_pushvalue(L, lua_upvalueindex(4));  // [index, node, match]
+  push_capture_match(L, &cap, lua_upvalueindex(2));
+  return 3;
+}
+
+/// Highlighter iterator: `iter(line, is_spell_nav)`
+///
+/// Adds an ephemeral decoration for every capture up to and including the
+/// first one that starts after `line`, and returns the start row of that
+/// capture. The first capture of a match with predicates is returned as
+/// `capture, node, match` instead, as query_next_capture() would, so that Lua
+/// can evaluate the predicates and directives. Returns nothing when there are
+/// no captures left.
+static int query_next_highlight(lua_State *L)
+{
+  // Upvalues are:
+  // [ cursor, node, query, current_match, hl_ids ]
+  TSLua_cursor *ud = lua_touserdata(L, lua_upvalueindex(1));
+  TSQuery *query = query_check(L, lua_upvalueindex(3));
+  int line = (int)luaL_checkinteger(L, 1);
+  bool spell_nav = lua_toboolean(L, 2);
 
+  win_T *wp = decor_state.win;
+  bool can_decor = wp && wp->w_buffer->handle == ud->hl_buf;
+
+  TSLuaCachedCapture cap;
+  while (rawquery_next_capture(L, ud, query, lua_upvalueindex(4), &cap)) {
+    if (cap.captures) {
+      lua_pushinteger(L, cap.capture_index + 1);  // [index]
+      push_node(L, cap.node, lua_upvalueindex(2));  // [index, node]
       lua_pushvalue(L, lua_upvalueindex(4));  // [index, node, match]
-      set_match(L, &match, lua_upvalueindex(2));
-      lua_pushinteger(L, match.pattern_index + 1);
-      lua_setfield(L, -2, "pattern");
-
-      if (match.capture_count > 1) {
-        ud->predicated_match = (int)match.id;
-        lua_pushboolean(L, false);
-        lua_setfield(L, -2, "active");
-      }
+      push_capture_match(L, &cap, lua_upvalueindex(2));
       return 3;
     }
-    return 2;
+
+    TSPoint start = ts_node_start_point(cap.node);
+    TSPoint end = ts_node_end_point(cap.node);
+    if (can_decor && (int)end.row >= line) {
+      uint32_t len;
+      const char *name = ts_query_capture_name_for_id(query, cap.capture_index, &len);
+      TriState spell = kNone;
+      if (len == 5 && strncmp(name, "spell", 5) == 0) {
+        spell = kTrue;
+      } else if (len == 7 && strncmp(name, "nospell", 7) == 0) {
+        spell = kFalse;
+      }
+
+      if (!spell_nav || spell != kNone) {
+        lua_pushinteger(L, cap.capture_index + 1);
+        lua_gettable(L, lua_upvalueindex(5));  // may compute the id in a metamethod
+        Decoration decor = DECORATION_INIT;
+        decor.hl_id = (int)lua_tointeger(L, -1);
+        lua_pop(L, 1);
+        // Give nospell a higher priority so it always overrides spell captures.
+        decor.priority = (DecorPriority)(ud->hl_priority + (spell == kFalse ? 1 : 0));
+        decor.spell = spell;
+        decor_push_ephemeral((int)start.row, (int)start.column, (int)end.row, (int)end.column,
+                             &decor, ud->hl_ns, 0);
+      }
+    }
+
+    if ((int)start.row > line) {
+      lua_pushinteger(L, start.row);
+      return 1;
+    }
   }
   return 0;
 }
 
-static int node_rawquery(lua_State *L)
+/// Execute `query` on `node` with a pooled cursor, using the range and options
+/// arguments of _rawquery()
+static TSQueryCursor *rawquery_cursor(lua_State *L, TSNode node, TSQuery *query)
 {
-  TSNode node;
-  if (!node_check(L, 1, &node)) {
-    return 0;
-  }
-  TSQuery *query = query_check(L, 2);
-
   TSQueryCursor *cursor;
   if (kv_size(cursors) > 0) {
     cursor = kv_pop(cursors);
@@ -1456,18 +1887,13 @@ static int node_rawquery(lua_State *L)
   ts_query_cursor_set_match_limit(cursor, 256);
   ts_query_cursor_exec(cursor, query, node);
 
-  bool captures = lua_toboolean(L, 3);
-
   if (lua_gettop(L) >= 4) {
     uint32_t start = (uint32_t)luaL_checkinteger(L, 4);
     uint32_t end = lua_gettop(L) >= 5 ? (uint32_t)luaL_checkinteger(L, 5) : MAXLNUM;
     ts_query_cursor_set_point_range(cursor, (TSPoint){ start, 0 }, (TSPoint){ end, 0 });
   }
 
-  if (lua_gettop(L) >= 6 && !lua_isnil(L, 6)) {
-    if (!lua_istable(L, 6)) {
-      return luaL_error(L, "table expected");
-    }
+  if (lua_gettop(L) >= 6 && lua_istable(L, 6)) {
     lua_pushnil(L);
     // stack: [dict, ..., nil]
     while (lua_next(L, 6)) {
@@ -1487,10 +1913,75 @@ static int node_rawquery(lua_State *L)
     }
   }
 
+  return cursor;
+}
+
+static int node_rawquery(lua_State *L)
+{
+  TSNode node;
+  if (!node_check(L, 1, &node)) {
+    return 0;
+  }
+  TSQuery *query = query_check(L, 2);
+
+  bool captures = lua_toboolean(L, 3);
+
+  if (lua_gettop(L) >= 6 && !lua_isnil(L, 6) && !lua_istable(L, 6)) {
+    return luaL_error(L, "table expected");
+  }
+
+  // opts.highlight = { buf, ns, priority, hl_ids } makes this a highlighter
+  // iterator, see query_next_highlight().
+  bool highlight = false;
+  if (captures && lua_gettop(L) >= 6 && lua_istable(L, 6)) {
+    lua_getfield(L, 6, "highlight");
+    highlight = lua_istable(L, -1);
+    lua_pop(L, 1);
+  }
+
+  // With opts.cache, captures are recorded so that a later call with the same
+  // node, query and rows can replay them without running the query again.
+  bool cache = false;
+  if (captures && lua_gettop(L) >= 6 && lua_istable(L, 6)) {
+    lua_getfield(L, 6, "cache");
+    cache = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+  }
+
+  TSLuaCaptureEntry *entry = NULL;
+  TSQueryCursor *cursor = NULL;
+  if (cache) {
+    uint32_t start_row = lua_gettop(L) >= 4 ? (uint32_t)luaL_checkinteger(L, 4) : 0;
+    uint32_t end_row = lua_gettop(L) >= 5 ? (uint32_t)luaL_checkinteger(L, 5) : MAXLNUM;
+    entry = capture_cache_get(node, query, start_row, end_row);
+    if (!entry) {
+      entry = capture_cache_put(node, query, start_row, end_row,
+                                rawquery_cursor(L, node, query));
+    }
+    entry->refcount++;
+  } else {
+    cursor = rawquery_cursor(L, node, query);
+  }
+
   TSLua_cursor *ud = lua_newuserdata(L, sizeof(*ud));  // [udata]
   ud->cursor = cursor;
   ud->predicated_match = -1;
   ud->max_match_id = -1;
+  ud->entry = entry;
+  ud->pos = 0;
+  ud->hl_buf = 0;
+  ud->hl_ns = 0;
+  ud->hl_priority = 0;
+  if (highlight) {
+    lua_getfield(L, 6, "highlight");  // [udata, hl]
+    lua_getfield(L, -1, "buf");
+    ud->hl_buf = (handle_T)lua_tointeger(L, -1);
+    lua_getfield(L, -2, "ns");
+    ud->hl_ns = (uint64_t)lua_tointeger(L, -1);
+    lua_getfield(L, -3, "priority");
+    ud->hl_priority = (DecorPriority)lua_tointeger(L, -1);
+    lua_pop(L, 4);  // [udata]
+  }
 
   lua_getfield(L, LUA_REGISTRYINDEX, TS_META_QUERYCURSOR);
   lua_setmetatable(L, -2);  // [udata]
@@ -1499,7 +1990,13 @@ static int node_rawquery(lua_State *L)
   // include query separately, as to keep a ref to it for gc
   lua_pushvalue(L, 2);  // [udata, node, query]
 
-  if (captures) {
+  if (highlight) {
+    lua_createtable(L, (int)ts_query_capture_count(query), 2);  // [u, n, q, match]
+    lua_getfield(L, 6, "highlight");
+    lua_getfield(L, -1, "hl_ids");  // [u, n, q, match, hl, hl_ids]
+    lua_remove(L, -2);  // [u, n, q, match, hl_ids]
+    lua_pushcclosure(L, query_next_highlight, 5);  // [closure]
+  } else if (captures) {
     // placeholder for match state
     lua_createtable(L, (int)ts_query_capture_count(query), 2);  // [u, n, q, match]
     lua_pushcclosure(L, query_next_capture, 4);  // [closure]
@@ -1513,8 +2010,13 @@ static int node_rawquery(lua_State *L)
 static int querycursor_gc(lua_State *L)
 {
   TSLua_cursor *ud = luaL_checkudata(L, 1, TS_META_QUERYCURSOR);
-  kv_push(cursors, ud->cursor);
-  ud->cursor = NULL;
+  if (ud->entry) {
+    capture_entry_unref(ud->entry);
+    ud->entry = NULL;
+  } else {
+    kv_push(cursors, ud->cursor);
+    ud->cursor = NULL;
+  }
   return 0;
 }
 
@@ -1638,6 +2140,7 @@ static int query_gc(lua_State *L)
     return 0;
   }
 
+  capture_cache_invalidate(NULL, query);
   ts_query_delete(query);
   return 0;
 }
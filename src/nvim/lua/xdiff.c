@@ -4,16 +4,22 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "klib/kvec.h"
 #include "luaconf.h"
 #include "nvim/api/private/defs.h"
 #include "nvim/api/private/helpers.h"
+#include "nvim/event/loop.h"
+#include "nvim/gettext.h"
 #include "nvim/linematch.h"
 #include "nvim/lua/converter.h"
 #include "nvim/lua/executor.h"
 #include "nvim/lua/xdiff.h"
 #include "nvim/macros.h"
+#include "nvim/main.h"
+#include "nvim/map.h"
 #include "nvim/memory.h"
 #include "nvim/pos.h"
+#include "nvim/strings.h"
 #include "nvim/vim.h"
 #include "xdiff/xdiff.h"
 
@@ -26,8 +32,11 @@ typedef enum {
   kNluaXdiffModeLocations,
 } NluaXdiffMode;
 
+typedef kvec_t(long) HunkList;
+
 typedef struct {
   lua_State *lstate;
+  HunkList *hunks;  ///< if not NULL, hunks are added here instead of to a Lua table
   Error *err;
   mmfile_t *ma;
   mmfile_t *mb;
@@ -35,10 +44,31 @@ typedef struct {
   bool iwhite;
 } hunkpriv_t;
 
+/// State of a vim.diff() call with "on_done"
+typedef struct {
+  mmfile_t ma;
+  mmfile_t mb;
+  LuaRef a_ref;  ///< Keeps the strings alive, the worker reads them.
+  LuaRef b_ref;
+  xdemitconf_t cfg;
+  xpparam_t params;
+  int64_t linematch;
+  NluaXdiffMode mode;
+  LuaRef on_done;
+  char *group;  ///< NULL when not given
+  bool cancelled;  ///< a newer diff in the same group was started
+  bool failed;
+  StringBuilder unified;  ///< result for kNluaXdiffModeUnified
+  HunkList hunks;  ///< result for kNluaXdiffModeLocations, 4 numbers per hunk
+} XdiffJob;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "lua/xdiff.c.generated.h"
 #endif
 
+// running diffs with "on_done" by their group
+static PMap(cstr_t) xdiff_groups = MAP_INIT;
+
 static void lua_pushhunk(lua_State *lstate, long start_a, long count_a, long start_b, long count_b)
 {
   // Mimic extra offsets done by xdiff, see:
@@ -62,9 +92,24 @@ static void lua_pushhunk(lua_State *lstate, long start_a, long count_a, long sta
   lua_rawseti(lstate, -2, (signed)lua_objlen(lstate, -2) + 1);
 }
 
-static void get_linematch_results(lua_State *lstate, mmfile_t *ma, mmfile_t *mb, int start_a,
-                                  int count_a, int start_b, int count_b, bool iwhite)
+static void add_hunk(hunkpriv_t *priv, long start_a, long count_a, long start_b, long count_b)
+{
+  if (priv->hunks) {
+    kv_push(*priv->hunks, start_a);
+    kv_push(*priv->hunks, count_a);
+    kv_push(*priv->hunks, start_b);
+    kv_push(*priv->hunks, count_b);
+  } else {
+    lua_pushhunk(priv->lstate, start_a, count_a, start_b, count_b);
+  }
+}
+
+static void get_linematch_results(hunkpriv_t *priv, int start_a, int count_a, int start_b,
+                                  int count_b)
 {
+  mmfile_t *ma = priv->ma;
+  mmfile_t *mb = priv->mb;
+
   // get the pointer to char of the start of the diff to pass it to linematch algorithm
   const char *diff_begin[2] = { ma->ptr, mb->ptr };
   int diff_length[2] = { count_a, count_b };
@@ -73,7 +118,8 @@ static void get_linematch_results(lua_State *lstate, mmfile_t *ma, mmfile_t *mb,
   fastforward_buf_to_lnum(&diff_begin[1], (linenr_T)start_b + 1);
 
   int *decisions = NULL;
-  size_t decisions_length = linematch_nbuffers(diff_begin, diff_length, 2, &decisions, iwhite);
+  size_t decisions_length = linematch_nbuffers(diff_begin, diff_length, 2, &decisions,
+                                               priv->iwhite);
 
   int lnuma = start_a, lnumb = start_b;
 
@@ -83,7 +129,7 @@ static void get_linematch_results(lua_State *lstate, mmfile_t *ma, mmfile_t *mb,
   int hunkcountb = 0;
   for (size_t i = 0; i < decisions_length; i++) {
     if (i && (decisions[i - 1] != decisions[i])) {
-      lua_pushhunk(lstate, hunkstarta, hunkcounta, hunkstartb, hunkcountb);
+      add_hunk(priv, hunkstarta, hunkcounta, hunkstartb, hunkcountb);
 
       hunkstarta = lnuma;
       hunkstartb = lnumb;
@@ -100,7 +146,7 @@ static void get_linematch_results(lua_State *lstate, mmfile_t *ma, mmfile_t *mb,
       hunkcountb++;
     }
   }
-  lua_pushhunk(lstate, hunkstarta, hunkcounta, hunkstartb, hunkcountb);
+  add_hunk(priv, hunkstarta, hunkcounta, hunkstartb, hunkcountb);
   xfree(decisions);
 }
 
@@ -122,16 +168,23 @@ static int write_string(void *priv, mmbuffer_t *mb, int nbuf)
   return 0;
 }
 
+static int write_builder(void *priv, mmbuffer_t *mb, int nbuf)
+{
+  StringBuilder *sb = (StringBuilder *)priv;
+  for (int i = 0; i < nbuf; i++) {
+    kv_concat_len(*sb, mb[i].ptr, (size_t)mb[i].size);
+  }
+  return 0;
+}
+
 // hunk_func callback used when opts.hunk_lines = true
 static int hunk_locations_cb(int start_a, int count_a, int start_b, int count_b, void *cb_data)
 {
   hunkpriv_t *priv = (hunkpriv_t *)cb_data;
-  lua_State *lstate = priv->lstate;
   if (priv->linematch > 0 && count_a + count_b <= priv->linematch) {
-    get_linematch_results(lstate, priv->ma, priv->mb, start_a, count_a, start_b, count_b,
-                          priv->iwhite);
+    get_linematch_results(priv, start_a, count_a, start_b, count_b);
   } else {
-    lua_pushhunk(lstate, start_a, count_a, start_b, count_b);
+    add_hunk(priv, start_a, count_a, start_b, count_b);
   }
 
   return 0;
@@ -207,9 +260,10 @@ static bool check_xdiff_opt(ObjectType actType, ObjectType expType, const char *
 }
 
 static NluaXdiffMode process_xdl_diff_opts(lua_State *lstate, xdemitconf_t *cfg, xpparam_t *params,
-                                           int64_t *linematch, Error *err)
+                                           int64_t *linematch, LuaRef *on_done, char **group,
+                                           Error *err)
 {
-  const DictionaryOf(LuaRef) opts = nlua_pop_Dictionary(lstate, true, err);
+  const DictionaryOf(LuaRef) opts = nlua_pop_Dictionary(lstate, true, NULL, err);
 
   NluaXdiffMode mode = kNluaXdiffModeUnified;
 
@@ -224,6 +278,17 @@ static NluaXdiffMode process_xdl_diff_opts(lua_State *lstate, xdemitconf_t *cfg,
       }
       had_on_hunk = true;
       nlua_pushref(lstate, v->data.luaref);
+    } else if (strequal("on_done", k.data)) {
+      if (check_xdiff_opt(v->type, kObjectTypeLuaRef, "on_done", err)) {
+        goto exit_1;
+      }
+      *on_done = api_new_luaref(v->data.luaref);
+    } else if (strequal("group", k.data)) {
+      if (check_xdiff_opt(v->type, kObjectTypeString, "group", err)) {
+        goto exit_1;
+      }
+      XFREE_CLEAR(*group);
+      *group = xstrdup(v->data.string.data);
     } else if (strequal("result_type", k.data)) {
       if (check_xdiff_opt(v->type, kObjectTypeString, "result_type", err)) {
         goto exit_1;
@@ -309,6 +374,11 @@ static NluaXdiffMode process_xdl_diff_opts(lua_State *lstate, xdemitconf_t *cfg,
     }
   }
 
+  if (had_on_hunk && *on_done != LUA_NOREF) {
+    api_set_error(err, kErrorTypeValidation, "on_hunk cannot be used with on_done");
+    goto exit_1;
+  }
+
   if (had_on_hunk) {
     mode = kNluaXdiffModeOnHunkCB;
   } else if (had_result_type_indices) {
@@ -340,19 +410,39 @@ int nlua_xdl_diff(lua_State *lstate)
   CLEAR_FIELD(ecb);
 
   NluaXdiffMode mode = kNluaXdiffModeUnified;
+  LuaRef on_done = LUA_NOREF;
+  char *group = NULL;
 
   if (lua_gettop(lstate) == 3) {
     if (lua_type(lstate, 3) != LUA_TTABLE) {
       return luaL_argerror(lstate, 3, "expected table");
     }
 
-    mode = process_xdl_diff_opts(lstate, &cfg, &params, &linematch, &err);
+    mode = process_xdl_diff_opts(lstate, &cfg, &params, &linematch, &on_done, &group, &err);
 
     if (ERROR_SET(&err)) {
+      api_free_luaref(on_done);
+      xfree(group);
       goto exit_0;
     }
   }
 
+  if (on_done != LUA_NOREF) {
+    xdiff_async_start(lstate, (XdiffJob) {
+      .ma = ma,
+      .mb = mb,
+      .a_ref = nlua_ref_global(lstate, 1),
+      .b_ref = nlua_ref_global(lstate, 2),
+      .cfg = cfg,
+      .params = params,
+      .linematch = linematch,
+      .mode = mode,
+      .on_done = on_done,
+      .group = group,
+    });
+    return 0;
+  }
+
   luaL_Buffer buf;
   hunkpriv_t priv;
   switch (mode) {
@@ -405,3 +495,96 @@ exit_0:
   }
   return 0;
 }
+
+static void xdiff_async_start(lua_State *lstate, XdiffJob job)
+{
+  XdiffJob *jobp = xmalloc(sizeof(*jobp));
+  *jobp = job;
+
+  if (jobp->group) {
+    cstr_t *key = NULL;
+    bool new_item = false;
+    XdiffJob **ref = (XdiffJob **)pmap_put_ref(cstr_t)(&xdiff_groups, jobp->group, &key,
+                                                       &new_item);
+    if (new_item) {
+      *key = xstrdup(jobp->group);
+    } else {
+      (*ref)->cancelled = true;
+    }
+    *ref = jobp;
+  }
+
+  loop_queue_work(&main_loop, xdiff_async_work, xdiff_async_done, jobp);
+}
+
+static void xdiff_async_work(void *data)
+{
+  XdiffJob *job = data;
+  xdemitcb_t ecb;
+  CLEAR_FIELD(ecb);
+  hunkpriv_t priv;
+
+  if (job->mode == kNluaXdiffModeUnified) {
+    ecb.priv = &job->unified;
+    ecb.out_line = write_builder;
+  } else {
+    job->cfg.hunk_func = hunk_locations_cb;
+    priv = (hunkpriv_t) {
+      .hunks = &job->hunks,
+      .ma = &job->ma,
+      .mb = &job->mb,
+      .linematch = job->linematch,
+      .iwhite = (job->params.flags & XDF_IGNORE_WHITESPACE) > 0
+    };
+    ecb.priv = &priv;
+  }
+
+  job->failed = xdl_diff(&job->ma, &job->mb, &job->params, &job->cfg, &ecb) == -1;
+}
+
+static void xdiff_async_done(void **argv)
+{
+  XdiffJob *job = argv[0];
+  lua_State *const lstate = get_global_lstate();
+
+  if (job->group && pmap_get(cstr_t)(&xdiff_groups, job->group) == job) {
+    cstr_t key;
+    pmap_del(cstr_t)(&xdiff_groups, job->group, &key);
+    xfree((void *)key);
+  }
+
+  int nargs = 0;
+  if (!job->cancelled) {
+    nlua_pushref(lstate, job->on_done);  // [cb]
+    if (job->failed) {
+      lua_pushstring(lstate, "Error while performing diff operation");  // [cb, err]
+      nargs = 1;
+    } else {
+      lua_pushnil(lstate);  // [cb, nil]
+      if (job->mode == kNluaXdiffModeUnified) {
+        lua_pushlstring(lstate, job->unified.items ? job->unified.items : "",
+                        job->unified.size);  // [cb, nil, diff]
+      } else {
+        lua_createtable(lstate, (int)(job->hunks.size / 4), 0);  // [cb, nil, hunks]
+        for (size_t i = 0; i + 3 < job->hunks.size; i += 4) {
+          long *h = &job->hunks.items[i];
+          lua_pushhunk(lstate, h[0], h[1], h[2], h[3]);
+        }
+      }
+      nargs = 2;
+    }
+  }
+
+  nlua_unref_global(lstate, job->a_ref);
+  nlua_unref_global(lstate, job->b_ref);
+  api_free_luaref(job->on_done);
+  xfree(job->group);
+  kv_destroy(job->unified);
+  kv_destroy(job->hunks);
+  bool cancelled = job->cancelled;
+  xfree(job);
+
+  if (!cancelled && nlua_pcall(lstate, nargs, 0)) {
+    nlua_error(lstate, _("Error executing vim.diff on_done callback: %.*s"));
+  }
+}
@@ -130,6 +130,7 @@ void event_init(void)
 {
   loop_init(&main_loop, NULL);
   resize_events = multiqueue_new_child(main_loop.events);
+  multiqueue_set_priority(resize_events, true);
 
   // early msgpack-rpc initialization
   msgpack_rpc_helpers_init();
@@ -156,6 +157,7 @@ bool event_teardown(void)
   channel_teardown();
   process_teardown(&main_loop);
   timer_teardown();
+  au_debounce_teardown();
   server_teardown();
   signal_teardown();
   terminal_teardown();
@@ -239,6 +241,11 @@ int main(int argc, char **argv)
 
   argv0 = argv[0];
 
+  // Count allocations per category from the start, see nvim__stats().
+  if (os_env_exists("NVIM_ALLOC_TRACK")) {
+    alloc_track_enable(true);
+  }
+
   if (!appname_is_valid()) {
     os_errmsg("$NVIM_APPNAME must be a name or relative path.\n");
     exit(1);
@@ -282,7 +289,9 @@ int main(int argc, char **argv)
 
   // Process the command line arguments.  File names are put in the global
   // argument list "global_alist".
+  buflist_index_start();
   command_line_scan(&params);
+  buflist_index_end();
 
   nlua_init(argv, argc, params.lua_arg0);
   TIME_MSG("init lua interpreter");
@@ -762,6 +771,7 @@ void getout(int exitval)
   }
 
   profile_dump();
+  profile_sample_exit();
 
   if (did_emsg) {
     // give the user a chance to read the (error) message
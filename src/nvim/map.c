@@ -85,7 +85,8 @@ void mh_realloc(MapHash *h, uint32_t n_min_buckets)
   uint32_t n_buckets = n_min_buckets < 16 ? 16 : n_min_buckets;
   roundup32(n_buckets);
   // sets all buckets to EMPTY
-  h->hash = xcalloc(n_buckets, sizeof *h->hash);
+  h->hash = xcalloc(n_buckets, sizeof *h->hash + sizeof *h->tags);
+  h->tags = (uint8_t *)(h->hash + n_buckets);
   h->n_occupied = h->size = 0;
   h->n_buckets = n_buckets;
   h->upper_bound = (uint32_t)(h->n_buckets * UPPER_FILL + 0.5);
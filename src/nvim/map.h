@@ -59,9 +59,10 @@ typedef struct {
   uint32_t n_keys;  // this is almost always "size", but keys[] could contain ded items..
   uint32_t keys_capacity;
   uint32_t *hash;
+  uint8_t *tags;  ///< a byte of the hash of each used bucket, shares allocation with "hash"
 } MapHash;
 
-#define MAPHASH_INIT { 0, 0, 0, 0, 0, 0, NULL }
+#define MAPHASH_INIT { 0, 0, 0, 0, 0, 0, NULL, NULL }
 #define SET_INIT { MAPHASH_INIT, NULL }
 #define MAP_INIT { SET_INIT, NULL }
 
@@ -71,6 +72,12 @@ typedef struct {
 #define mh_is_del(h, i) ((h)->hash[i] == MH_TOMBSTONE)
 #define mh_is_either(h, i) ((uint32_t)((h)->hash[i] + 1U) <= 1U)
 
+// The tag of a key is a byte of its hash, saved for each used bucket (like the
+// control bytes of a SwissTable). Probing only compares keys of buckets where
+// the tag matches, which saves loading keys[] for most collisions. Taken from
+// the high bits of a multiplicative hash, as the low bits select the bucket.
+#define mh_tag(k) ((uint8_t)(((uint32_t)(k) * 0x9E3779B1U) >> 24))
+
 typedef enum {
   kMHExisting = 0,
   kMHNewKeyDidFit,
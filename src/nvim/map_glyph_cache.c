@@ -25,6 +25,7 @@ uint32_t mh_find_bucket_glyph(Set(glyph) *set, String key, bool put)
   uint32_t mask = h->n_buckets - 1;
   uint32_t k = hash_String(key);
   uint32_t i = k & mask;
+  uint8_t tag = mh_tag(k);
   uint32_t last = i;
   uint32_t site = put ? last : MH_TOMBSTONE;
   while (!mh_is_empty(h, i)) {
@@ -32,7 +33,7 @@ uint32_t mh_find_bucket_glyph(Set(glyph) *set, String key, bool put)
       if (site == last) {
         site = i;
       }
-    } else if (equal_String(cstr_as_string(&set->keys[h->hash[i] - 1]), key)) {
+    } else if (h->tags[i] == tag && equal_String(cstr_as_string(&set->keys[h->hash[i] - 1]), key)) {
       return i;
     }
     i = (i + (++step)) & mask;
@@ -43,6 +44,10 @@ uint32_t mh_find_bucket_glyph(Set(glyph) *set, String key, bool put)
   if (site == last) {
     site = i;
   }
+  if (put) {
+    // the caller will put the key here
+    h->tags[site] = tag;
+  }
   return site;
 }
 
@@ -25,6 +25,7 @@ uint32_t KEY_NAME(mh_find_bucket_)(SET_TYPE *set, KEY_TYPE key, bool put)
   uint32_t mask = h->n_buckets - 1;
   uint32_t k = KEY_NAME(hash_)(key);
   uint32_t i = k & mask;
+  uint8_t tag = mh_tag(k);
   uint32_t last = i;
   uint32_t site = put ? last : MH_TOMBSTONE;
   while (!mh_is_empty(h, i)) {
@@ -32,7 +33,7 @@ uint32_t KEY_NAME(mh_find_bucket_)(SET_TYPE *set, KEY_TYPE key, bool put)
       if (site == last) {
         site = i;
       }
-    } else if (KEY_NAME(equal_)(set->keys[h->hash[i] - 1], key)) {
+    } else if (h->tags[i] == tag && KEY_NAME(equal_)(set->keys[h->hash[i] - 1], key)) {
       return i;
     }
     i = (i + (++step)) & mask;
@@ -43,6 +44,10 @@ uint32_t KEY_NAME(mh_find_bucket_)(SET_TYPE *set, KEY_TYPE key, bool put)
   if (site == last) {
     site = i;
   }
+  if (put) {
+    // the caller will put the key here
+    h->tags[site] = tag;
+  }
   return site;
 }
 
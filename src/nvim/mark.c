@@ -1373,6 +1373,102 @@ void mark_col_adjust(linenr_T lnum, colnr_T mincol, linenr_T lnum_amount, colnr_
   }
 }
 
+/// Adjust "posp" for joining "count" lines starting at "lnum", like
+/// mark_col_adjust() for the line it is in.
+static void join_adjust_pos(pos_T *posp, linenr_T lnum, linenr_T count,
+                            const colnr_T *col_amount, const int *spaces_removed)
+{
+  if (posp->lnum <= lnum || posp->lnum >= lnum + count) {
+    return;
+  }
+  linenr_T t = posp->lnum - lnum;
+  posp->lnum = lnum;
+  if (col_amount[t] < 0 && posp->col <= -col_amount[t]) {
+    posp->col = 0;
+  } else if (posp->col < spaces_removed[t]) {
+    posp->col = col_amount[t] + spaces_removed[t];
+  } else {
+    posp->col += col_amount[t];
+  }
+}
+
+/// Adjust marks for joining "count" lines starting at "lnum" into one.
+///
+/// Same as calling mark_col_adjust() for every joined line "lnum + t", with
+/// "lnum_amount" -t and "col_amount[t]" and "spaces_removed[t]", but visits
+/// every mark only once.
+void mark_join_adjust(linenr_T lnum, linenr_T count, const colnr_T *col_amount,
+                      const int *spaces_removed)
+{
+  int fnum = curbuf->b_fnum;
+
+  if (count <= 1 || (cmdmod.cmod_flags & CMOD_LOCKMARKS)) {
+    return;     // nothing to do
+  }
+#define JOIN_ADJUST(pp) join_adjust_pos(pp, lnum, count, col_amount, spaces_removed)
+  // named marks, lower case and upper case
+  for (int i = 0; i < NMARKS; i++) {
+    JOIN_ADJUST(&(curbuf->b_namedm[i].mark));
+    if (namedfm[i].fmark.fnum == fnum) {
+      JOIN_ADJUST(&(namedfm[i].fmark.mark));
+    }
+  }
+  for (int i = NMARKS; i < NGLOBALMARKS; i++) {
+    if (namedfm[i].fmark.fnum == fnum) {
+      JOIN_ADJUST(&(namedfm[i].fmark.mark));
+    }
+  }
+
+  // last Insert position
+  JOIN_ADJUST(&(curbuf->b_last_insert.mark));
+
+  // last change position
+  JOIN_ADJUST(&(curbuf->b_last_change.mark));
+
+  // list of change positions
+  for (int i = 0; i < curbuf->b_changelistlen; i++) {
+    JOIN_ADJUST(&(curbuf->b_changelist[i].mark));
+  }
+
+  // Visual area
+  JOIN_ADJUST(&(curbuf->b_visual.vi_start));
+  JOIN_ADJUST(&(curbuf->b_visual.vi_end));
+
+  // previous context mark
+  JOIN_ADJUST(&(curwin->w_pcmark));
+
+  // previous pcmark
+  JOIN_ADJUST(&(curwin->w_prev_pcmark));
+
+  // saved cursor for formatting
+  JOIN_ADJUST(&saved_cursor);
+
+  // Adjust items in all windows related to the current buffer.
+  FOR_ALL_WINDOWS_IN_TAB(win, curtab) {
+    // marks in the jumplist
+    for (int i = 0; i < win->w_jumplistlen; i++) {
+      if (win->w_jumplist[i].fmark.fnum == fnum) {
+        JOIN_ADJUST(&(win->w_jumplist[i].fmark.mark));
+      }
+    }
+
+    if (win->w_buffer == curbuf) {
+      // marks in the tag stack
+      for (int i = 0; i < win->w_tagstacklen; i++) {
+        if (win->w_tagstack[i].fmark.fnum == fnum) {
+          JOIN_ADJUST(&(win->w_tagstack[i].fmark.mark));
+        }
+      }
+
+      // cursor position for other windows with the same buffer
+      if (win != curwin) {
+        JOIN_ADJUST(&win->w_cursor);
+      }
+    }
+  }
+#undef JOIN_ADJUST
+}
+
 // When deleting lines, this may create duplicate marks in the
 // jumplist. They will be removed here for the specified window.
 // When "loadfiles" is true first ensure entries have the "fnum" field set
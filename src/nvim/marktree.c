@@ -59,6 +59,9 @@
 #include "nvim/macros.h"
 
 #define T MT_BRANCH_FACTOR
+#if MT_BRANCH_FACTOR < 2 || MT_BRANCH_FACTOR > 63
+# error "MT_BRANCH_FACTOR must be between 2 and 63"
+#endif
 #define ILEN (sizeof(MTNode) + (2 * T) * sizeof(void *))
 
 #define ID_INCR (((uint64_t)1) << 2)
@@ -195,6 +198,7 @@ static inline void split_node(MarkTree *b, MTNode *x, const int i, MTKey next)
 
   // no alloc in the common case (less than 4 intersects)
   kvi_copy(z->intersect, y->intersect);
+  z->ns_mask = y->ns_mask;
 
   if (!y->level) {
     uint64_t pi = pseudo_index(y, 0);  // note: sloppy pseudo-index
@@ -263,6 +267,7 @@ static inline void marktree_putp_aux(MarkTree *b, MTNode *x, MTKey k)
   // TODO(bfredl): ugh, make sure this is the _last_ valid (pos, gravity) position,
   // to minimize movement
   int i = marktree_getp_aux(x, k, NULL) + 1;
+  x->ns_mask |= mt_ns_bit(k.ns);
   if (x->level == 0) {
     if (i != x->n) {
       memmove(&x->key[i + 1], &x->key[i],
@@ -288,6 +293,7 @@ static inline void marktree_putp_aux(MarkTree *b, MTNode *x, MTKey k)
 void marktree_put(MarkTree *b, MTKey key, int end_row, int end_col, bool end_right)
 {
   assert(!(key.flags & ~MT_FLAG_EXTERNAL_MASK));
+  AllocTag prev_tag = alloc_tag_push(kAllocTagExtmark);
   if (end_row >= 0) {
     key.flags |= MT_FLAG_PAIRED;
   }
@@ -307,6 +313,184 @@ void marktree_put(MarkTree *b, MTKey key, int end_row, int end_col, bool end_rig
 
     marktree_intersect_pair(b, mt_lookup_key(key), itr, end_itr, false);
   }
+  alloc_tag_pop(prev_tag);
+}
+
+static int key_cmp_qsort(const void *a, const void *b)
+{
+  return key_cmp(*(const MTKey *)a, *(const MTKey *)b);
+}
+
+/// Inserts many marks at once.
+///
+/// A pair with a negative end row is an unpaired mark. When the batch is large
+/// compared to the existing tree, all keys are merged and the tree is rebuilt
+/// bottom-up, instead of splitting nodes for every single insert.
+void marktree_put_batch(MarkTree *b, MTPair *pairs, size_t n)
+{
+  if (n == 0) {
+    return;
+  } else if (n < b->n_keys / 16) {
+    for (size_t i = 0; i < n; i++) {
+      marktree_put(b, pairs[i].start, pairs[i].end_pos.row, pairs[i].end_pos.col,
+                   pairs[i].end_right_gravity);
+    }
+    return;
+  }
+
+  kvec_t(MTKey) new_keys = KV_INITIAL_VALUE;
+  kv_resize(new_keys, 2 * n);
+  for (size_t i = 0; i < n; i++) {
+    MTKey key = pairs[i].start;
+    assert(!(key.flags & ~MT_FLAG_EXTERNAL_MASK));
+    key.flags |= MT_FLAG_REAL;
+    if (pairs[i].end_pos.row >= 0) {
+      key.flags |= MT_FLAG_PAIRED;
+      MTKey end_key = key;
+      end_key.flags = (uint16_t)((uint16_t)(key.flags & ~MT_FLAG_RIGHT_GRAVITY)
+                                 |(uint16_t)MT_FLAG_END
+                                 |(uint16_t)(pairs[i].end_right_gravity
+                                             ? MT_FLAG_RIGHT_GRAVITY : 0));
+      end_key.pos = pairs[i].end_pos;
+      kv_push(new_keys, end_key);
+    }
+    kv_push(new_keys, key);
+  }
+  qsort(new_keys.items, kv_size(new_keys), sizeof(MTKey), key_cmp_qsort);
+
+  size_t n_old = b->n_keys;
+  size_t n_all = n_old + kv_size(new_keys);
+  MTKey *keys = xmalloc(n_all * sizeof(MTKey));
+  size_t n_collected = 0;
+  if (b->root) {
+    marktree_collect_keys(b->root, (MTPos){ 0, 0 }, keys, &n_collected);
+  }
+  assert(n_collected == n_old);
+
+  // merge in place from the back, old keys first among equal ones.
+  size_t i_old = n_old, i_new = kv_size(new_keys), i_all = n_all;
+  while (i_new > 0) {
+    if (i_old > 0 && key_cmp(keys[i_old - 1], kv_A(new_keys, i_new - 1)) > 0) {
+      keys[--i_all] = keys[--i_old];
+    } else {
+      keys[--i_all] = kv_A(new_keys, --i_new);
+    }
+  }
+  kv_destroy(new_keys);
+
+  marktree_clear(b);
+  int height = 0;
+  while (mt_max_keys(height) < n_all) {
+    height++;
+  }
+  b->root = marktree_build_node(b, keys, n_all, height, (MTPos){ 0, 0 }, true);
+  b->n_keys = n_all;
+
+  for (size_t i = 0; i < n_all; i++) {
+    if (mt_start(keys[i])) {
+      MarkTreeIter itr[1] = { 0 }, end_itr[1] = { 0 };
+      uint64_t id = mt_lookup_key(keys[i]);
+      marktree_lookup(b, id, itr);
+      marktree_lookup(b, id | MARKTREE_END_FLAG, end_itr);
+      if (end_itr->x) {
+        marktree_intersect_pair(b, id, itr, end_itr, false);
+      }
+    }
+  }
+  xfree(keys);
+}
+
+/// Appends the keys of the subtree "x" to "keys", with absolute positions.
+static void marktree_collect_keys(MTNode *x, MTPos base, MTKey *keys, size_t *n)
+{
+  for (int i = 0; i < x->n + 1; i++) {
+    if (x->level) {
+      MTPos child_base = base;
+      if (i > 0) {
+        child_base = x->key[i - 1].pos;
+        unrelative(base, &child_base);
+      }
+      marktree_collect_keys(x->ptr[i], child_base, keys, n);
+    }
+    if (i < x->n) {
+      MTKey k = x->key[i];
+      unrelative(base, &k.pos);
+      keys[(*n)++] = k;
+    }
+  }
+}
+
+/// @return the maximum number of keys in a subtree of height "level".
+static size_t mt_max_keys(int level)
+{
+  size_t max = 2 * T - 1;
+  for (int l = 0; l < level; l++) {
+    max = max * 2 * T + 2 * T - 1;
+  }
+  return max;
+}
+
+/// @return the minimum number of keys in a non-root subtree of height "level".
+static size_t mt_min_keys(int level)
+{
+  size_t min = T - 1;
+  for (int l = 0; l < level; l++) {
+    min = min * T + T - 1;
+  }
+  return min;
+}
+
+/// Builds a subtree of height "level" from "n" sorted keys with absolute
+/// positions. "base" is the position the keys are stored relative to.
+static MTNode *marktree_build_node(MarkTree *b, MTKey *keys, size_t n, int level, MTPos base,
+                                   bool root)
+{
+  // like in marktree_put_key(), the root is always allocated as internal node
+  MTNode *x = marktree_alloc_node(b, root || level > 0);
+  x->level = (int16_t)level;
+  if (level == 0) {
+    assert(n <= 2 * T - 1);
+    x->n = (int32_t)n;
+    for (int i = 0; i < x->n; i++) {
+      x->key[i] = keys[i];
+      relative(base, &x->key[i].pos);
+      refkey(b, x, i);
+      x->ns_mask |= mt_ns_bit(keys[i].ns);
+    }
+    return x;
+  }
+
+  // The fewest children that can hold all keys. This never exceeds 2*T, and
+  // with at least T children (2 for the root) each child keeps enough keys.
+  size_t child_max = mt_max_keys(level - 1) + 1;
+  size_t children = MAX((n + child_max) / child_max, root ? 2 : T);
+  assert(children <= 2 * T);
+  size_t child_keys = (n - (children - 1)) / children;
+  size_t extra = (n - (children - 1)) % children;
+
+  x->n = (int32_t)children - 1;
+  size_t pos = 0;
+  MTPos child_base = base;
+  for (size_t c = 0; c < children; c++) {
+    size_t len = child_keys + (c < extra ? 1 : 0);
+    assert(len >= mt_min_keys(level - 1) && len <= mt_max_keys(level - 1));
+    MTNode *child = marktree_build_node(b, keys + pos, len, level - 1, child_base, false);
+    child->parent = x;
+    child->p_idx = (int16_t)c;
+    x->ptr[c] = child;
+    x->ns_mask |= child->ns_mask;
+    pos += len;
+    if (c < children - 1) {
+      x->key[c] = keys[pos];
+      x->ns_mask |= mt_ns_bit(keys[pos].ns);
+      relative(base, &x->key[c].pos);
+      refkey(b, x, (int)c);
+      child_base = keys[pos].pos;
+      pos++;
+    }
+  }
+  assert(pos == n);
+  return x;
 }
 
 // this is currently not used very often, but if it was it should use binary search
@@ -427,6 +611,7 @@ static MTNode *marktree_alloc_node(MarkTree *b, bool internal)
 void marktree_put_key(MarkTree *b, MTKey k)
 {
   k.flags |= MT_FLAG_REAL;  // let's be real.
+  b->tick++;
   if (!b->root) {
     b->root = marktree_alloc_node(b, true);
   }
@@ -435,6 +620,7 @@ void marktree_put_key(MarkTree *b, MTKey k)
   if (r->n == 2 * T - 1) {
     MTNode *s = marktree_alloc_node(b, true);
     b->root = s; s->level = r->level + 1; s->n = 0;
+    s->ns_mask = r->ns_mask;
     s->ptr[0] = r;
     r->parent = s;
     r->p_idx = 0;
@@ -471,6 +657,7 @@ void marktree_put_key(MarkTree *b, MTKey k)
 uint64_t marktree_del_itr(MarkTree *b, MarkTreeIter *itr, bool rev)
 {
   int adjustment = 0;
+  b->tick++;
 
   MTNode *cur = itr->x;
   int curi = itr->i;
@@ -902,6 +1089,7 @@ static MTNode *merge_node(MarkTree *b, MTNode *p, int i)
 
   intersect_merge(&m, &x->intersect, &y->intersect);
 
+  x->ns_mask |= y->ns_mask | mt_ns_bit(p->key[i].ns);
   x->key[x->n] = p->key[i];
   refkey(b, x, x->n);
   if (i > 0) {
@@ -982,11 +1170,13 @@ static void pivot_right(MarkTree *b, MTPos p_pos, MTNode *p, const int i)
     }
   }
   y->key[0] = p->key[i];
+  y->ns_mask |= mt_ns_bit(y->key[0].ns);
   refkey(b, y, 0);
   p->key[i] = x->key[x->n - 1];
   refkey(b, p, i);
   if (x->level) {
     y->ptr[0] = x->ptr[x->n];
+    y->ns_mask |= y->ptr[0]->ns_mask;
     y->ptr[0]->parent = y;
     y->ptr[0]->p_idx = 0;
   }
@@ -1051,11 +1241,13 @@ static void pivot_left(MarkTree *b, MTPos p_pos, MTNode *p, int i)
   }
 
   x->key[x->n] = p->key[i];
+  x->ns_mask |= mt_ns_bit(x->key[x->n].ns);
   refkey(b, x, x->n);
   p->key[i] = y->key[0];
   refkey(b, p, i);
   if (x->level) {
     x->ptr[x->n + 1] = y->ptr[0];
+    x->ns_mask |= x->ptr[x->n + 1]->ns_mask;
     x->ptr[x->n + 1]->parent = x;
     x->ptr[x->n + 1]->p_idx = (int16_t)(x->n + 1);
   }
@@ -1117,6 +1309,8 @@ void marktree_clear(MarkTree *b)
   map_destroy(uint64_t, b->id2node);
   *b->id2node = (PMap(uint64_t)) MAP_INIT;
   b->n_keys = 0;
+  // not reset: cached data computed before the clear must stay invalid
+  b->tick++;
   assert(b->n_nodes == 0);
 }
 
@@ -1142,6 +1336,7 @@ void marktree_revise(MarkTree *b, MarkTreeIter *itr, uint8_t decor_level, MTKey
 {
   // TODO(bfredl): clean up this mess and re-instantiate &= and |= forms
   // once we upgrade to a non-broken version of gcc in functionaltest-lua CI
+  b->tick++;
   rawkey(itr).flags = (uint16_t)(rawkey(itr).flags & (uint16_t) ~MT_FLAG_DECOR_MASK);
   rawkey(itr).flags = (uint16_t)(rawkey(itr).flags & (uint16_t) ~MT_FLAG_INVALID);
   rawkey(itr).flags = (uint16_t)(rawkey(itr).flags
@@ -1161,6 +1356,7 @@ void marktree_move(MarkTree *b, MarkTreeIter *itr, int row, int col)
 {
   MTKey key = rawkey(itr);
   MTNode *x = itr->x;
+  b->tick++;
   if (!x->level) {
     bool internal = false;
     MTPos newpos = MTPos(row, col);
@@ -1341,6 +1537,24 @@ bool marktree_itr_next(MarkTree *b, MarkTreeIter *itr)
   return marktree_itr_next_skip(b, itr, false, false, NULL);
 }
 
+/// Moves the iterator to the next mark in namespace "ns".
+///
+/// Subtrees without marks in "ns" are skipped.
+bool marktree_itr_next_ns(MarkTree *b, MarkTreeIter *itr, uint32_t ns)
+{
+  uint64_t bit = mt_ns_bit(ns);
+  while (true) {
+    // at an internal key, the subtree after it is visited next
+    bool skip = itr->x && itr->x->level && !(itr->x->ptr[itr->i + 1]->ns_mask & bit);
+    if (!marktree_itr_next_skip(b, itr, skip, false, NULL)) {
+      return false;
+    }
+    if (rawkey(itr).ns == ns) {
+      return true;
+    }
+  }
+}
+
 static bool marktree_itr_next_skip(MarkTree *b, MarkTreeIter *itr, bool skip, bool preload,
                                    MTPos oldbase[])
 {
@@ -1617,6 +1831,18 @@ static void swap_keys(MarkTree *b, MarkTreeIter *itr1, MarkTreeIter *itr2, Damag
   rawkey(itr2).pos = key2.pos;
   refkey(b, itr1->x, itr1->i);
   refkey(b, itr2->x, itr2->i);
+  mt_add_ns_mask(itr1->x, mt_ns_bit(key2.ns));
+  mt_add_ns_mask(itr2->x, mt_ns_bit(key1.ns));
+}
+
+/// Adds "mask" to the namespaces of "x" and its parents.
+static void mt_add_ns_mask(MTNode *x, uint64_t mask)
+{
+  // a parent always has all the bits of its children
+  while (x && (x->ns_mask & mask) != mask) {
+    x->ns_mask |= mask;
+    x = x->parent;
+  }
 }
 
 static int damage_cmp(const void *s1, const void *s2)
@@ -1646,6 +1872,7 @@ bool marktree_splice(MarkTree *b, int32_t start_line, int start_col, int old_ext
     // den e FÄRDIG
     return false;
   }
+  b->tick++;
   MTPos delta = { new_extent.row - old_extent.row,
                   new_extent.col - old_extent.col };
 
@@ -1754,6 +1981,11 @@ past_continue_same_node:
     }
   }
 
+  // Move the keys after the changed region. Keys are stored relative to the
+  // key before their node, so only the keys following the iterator in the
+  // current node and its parents need adjustment: the subtrees in between are
+  // skipped and move along with their parent key. This makes even a huge
+  // insert O(T * depth), independent of the number of marks after it.
   while (itr->x) {
     unrelative(oldbase[itr->lvl], &rawkey(itr).pos);
     int realrow = rawkey(itr).pos.row;
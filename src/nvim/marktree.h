@@ -17,11 +17,17 @@
 struct mtnode_s;
 
 #define MT_MAX_DEPTH 20
-#define MT_BRANCH_FACTOR 10
+// Non-root nodes hold between MT_BRANCH_FACTOR - 1 and 2 * MT_BRANCH_FACTOR - 1
+// keys. Can be overridden at build time (-DMT_BRANCH_FACTOR=n) for tuning, see
+// test/benchmark/extmark_spec.lua.
+#ifndef MT_BRANCH_FACTOR
+# define MT_BRANCH_FACTOR 10
+#endif
 // note max branch is actually 2*MT_BRANCH_FACTOR
 // and strictly this is ceil(log2(2*MT_BRANCH_FACTOR + 1))
 // as we need a pseudo-index for "right before this node"
-#define MT_LOG2_BRANCH 5
+#define MT_LOG2_BRANCH (MT_BRANCH_FACTOR <= 7 ? 4 : MT_BRANCH_FACTOR <= 15 ? 5 \
+                        : MT_BRANCH_FACTOR <= 31 ? 6 : 7)
 
 typedef struct {
   int32_t row;
@@ -159,6 +165,13 @@ static inline uint16_t mt_flags(bool right_gravity, bool hl_eol, bool no_undo, b
                     | (decor_level << MT_FLAG_DECOR_OFFSET));
 }
 
+/// @return bit of namespace "ns" in MTNode.ns_mask. Namespaces beyond 64
+///         share bits with earlier ones.
+static inline uint64_t mt_ns_bit(uint32_t ns)
+{
+  return (uint64_t)1 << (ns % 64);
+}
+
 static inline MTPair mtpair_from(MTKey start, MTKey end)
 {
   return (MTPair){ .start = start, .end_pos = end.pos, .end_right_gravity = mt_right(end) };
@@ -171,6 +184,9 @@ struct mtnode_s {
   int16_t level;
   int16_t p_idx;  // index in parent
   Intersection intersect;
+  // namespaces of the marks in this subtree, see mt_ns_bit(). Can have stale
+  // bits after marks were deleted.
+  uint64_t ns_mask;
   // TODO(bfredl): we could consider having a only-sometimes-valid
   // index into parent for faster "cached" lookup.
   MTNode *parent;
@@ -189,6 +205,7 @@ typedef struct {
   // TODO(bfredl): the pointer to node could be part of the larger
   // Map(uint64_t, ExtmarkItem) essentially;
   PMap(uint64_t) id2node[1];
+  uint64_t tick;  ///< incremented on every change to the tree
 } MarkTree;
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
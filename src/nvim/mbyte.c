@@ -42,6 +42,7 @@
 #include "nvim/charset.h"
 #include "nvim/cmdexpand_defs.h"
 #include "nvim/cursor.h"
+#include "nvim/decoration.h"
 #include "nvim/drawscreen.h"
 #include "nvim/eval/typval.h"
 #include "nvim/eval/typval_defs.h"
@@ -560,8 +561,20 @@ int utf_ptr2cells_len(const char *p, int size)
 size_t mb_string2cells(const char *str)
 {
   size_t clen = 0;
+  const char *end = str + strlen(str);
 
   for (const char *p = str; *p != NUL; p += utfc_ptr2len(p)) {
+    // Count printable ASCII in one go, except for the last one when a
+    // composing character may follow.
+    size_t n = ascii_printable_len(p, end);
+    if (n > 0 && (uint8_t)p[n] >= 0x80) {
+      n--;
+    }
+    clen += n;
+    p += n;
+    if (*p == NUL) {
+      break;
+    }
     clen += (size_t)utf_ptr2cells(p);
   }
 
@@ -2767,6 +2780,7 @@ void f_setcellwidths(typval_T *argvars, typval_T *rettv, EvalFuncData fptr)
   }
 
   xfree(cw_table_save);
+  decor_update_virt_text_width();
   redraw_all_later(UPD_NOT_VALID);
 }
 
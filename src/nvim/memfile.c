@@ -30,6 +30,7 @@
 /// mf_get()          get an existing block and lock it
 /// mf_put()          unlock a block, may be marked for writing
 /// mf_free()         remove a block
+/// mf_shrink()       drop the unused middle part of an unlocked block
 /// mf_sync()         sync changed parts of memfile to disk
 /// mf_release_all()  release as much memory as possible
 /// mf_trans_del()    may translate negative to positive block number
@@ -47,8 +48,10 @@
 #include "nvim/assert.h"
 #include "nvim/buffer_defs.h"
 #include "nvim/fileio.h"
+#include "nvim/event/loop.h"
 #include "nvim/gettext.h"
 #include "nvim/globals.h"
+#include "nvim/main.h"
 #include "nvim/map.h"
 #include "nvim/memfile.h"
 #include "nvim/memfile_defs.h"
@@ -64,6 +67,15 @@
 
 #define MEMFILE_PAGE_SIZE 4096       /// default page size
 
+/// fsync() of a memfile done on the libuv thread pool.  Uses its own copy of
+/// the file descriptor, so that the memfile can be closed in the meantime.
+typedef struct mf_fsync {
+  uv_fs_t req;
+  int fd;
+  memfile_T *mfp;   ///< memfile, NULL after it was closed
+  bool again;       ///< blocks were written meanwhile, fsync once more
+} mf_fsync_T;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "memfile.c.generated.h"
 #endif
@@ -100,6 +112,7 @@ memfile_T *mf_open(char *fname, int flags)
 
   mfp->mf_free_first = NULL;         // free list is empty
   mfp->mf_dirty = MF_DIRTY_NO;
+  mfp->mf_fsync = NULL;
   mfp->mf_hash = (PMap(int64_t)) MAP_INIT;
   mfp->mf_trans = (Map(int64_t, int64_t)) MAP_INIT;
   mfp->mf_page_size = MEMFILE_PAGE_SIZE;
@@ -170,6 +183,7 @@ void mf_close(memfile_T *mfp, bool del_file)
   if (mfp == NULL) {                    // safety check
     return;
   }
+  mf_fsync_detach(mfp);
   if (mfp->mf_fd >= 0 && close(mfp->mf_fd) < 0) {
     emsg(_(e_swapclose));
   }
@@ -208,6 +222,7 @@ void mf_close_file(buf_T *buf, bool getlines)
     }
   }
 
+  mf_fsync_detach(mfp);
   if (close(mfp->mf_fd) < 0) {           // close the file
     emsg(_(e_swapclose));
   }
@@ -313,6 +328,7 @@ bhdr_T *mf_get(memfile_T *mfp, blocknr_T nr, unsigned page_count)
     }
   } else {
     pmap_del(int64_t)(&mfp->mf_hash, hp->bh_bnum, NULL);
+    mf_unshrink(mfp, hp);
   }
 
   hp->bh_flags |= BH_LOCKED;
@@ -367,6 +383,10 @@ void mf_free(memfile_T *mfp, bhdr_T *hp)
 ///               MFS_FLUSH  Make sure buffers are flushed to disk, so they will
 ///                          survive a system crash.
 ///               MFS_ZERO   Only write block 0.
+///               MFS_ASYNC  With MFS_FLUSH: don't wait for the flush, it is
+///                          done on the libuv thread pool.  Writing the blocks
+///                          is still done here, so that they are in the file
+///                          (and ml_recover() can find them) if Nvim crashes.
 ///
 /// @return FAIL  If failure. Possible causes:
 ///               - No file (nothing to do).
@@ -426,7 +446,9 @@ int mf_sync(memfile_T *mfp, int flags)
   }
 
   if (flags & MFS_FLUSH) {
-    if (os_fsync(mfp->mf_fd)) {
+    if (flags & MFS_ASYNC) {
+      mf_fsync_async(mfp);
+    } else if (os_fsync(mfp->mf_fd)) {
       status = FAIL;
     }
   }
@@ -436,6 +458,62 @@ int mf_sync(memfile_T *mfp, int flags)
   return status;
 }
 
+/// Start flushing the file of memfile "mfp" to disk in the background.
+/// When a flush is already in progress another one is done after it.
+static void mf_fsync_async(memfile_T *mfp)
+{
+  if (mfp->mf_fsync != NULL) {
+    mfp->mf_fsync->again = true;
+    return;
+  }
+
+  int fd = os_dup(mfp->mf_fd);
+  if (fd < 0) {
+    (void)os_fsync(mfp->mf_fd);
+    return;
+  }
+  mf_fsync_T *fs = xcalloc(1, sizeof(mf_fsync_T));
+  fs->fd = fd;
+  fs->mfp = mfp;
+  fs->req.data = fs;
+  if (uv_fs_fsync(&main_loop.uv, &fs->req, fd, mf_fsync_cb) != 0) {
+    (void)os_fsync(fd);
+    close(fd);
+    xfree(fs);
+    return;
+  }
+  g_stats.fsync++;
+  mfp->mf_fsync = fs;
+}
+
+static void mf_fsync_cb(uv_fs_t *req)
+{
+  mf_fsync_T *fs = req->data;
+  uv_fs_req_cleanup(req);
+
+  if (fs->mfp != NULL && fs->again) {
+    fs->again = false;
+    if (uv_fs_fsync(&main_loop.uv, &fs->req, fs->fd, mf_fsync_cb) == 0) {
+      g_stats.fsync++;
+      return;
+    }
+  }
+  if (fs->mfp != NULL) {
+    fs->mfp->mf_fsync = NULL;
+  }
+  close(fs->fd);
+  xfree(fs);
+}
+
+/// Forget about a background flush of "mfp", it finishes on its own.
+static void mf_fsync_detach(memfile_T *mfp)
+{
+  if (mfp->mf_fsync != NULL) {
+    mfp->mf_fsync->mfp = NULL;
+    mfp->mf_fsync = NULL;
+  }
+}
+
 /// Set dirty flag for all blocks in memory file with a positive block number.
 /// These are blocks that need to be written to a newly created swapfile.
 void mf_set_dirty(memfile_T *mfp)
@@ -449,6 +527,47 @@ void mf_set_dirty(memfile_T *mfp)
   mfp->mf_dirty = MF_DIRTY_YES;
 }
 
+/// Keep only the first "head" and the last "tail" bytes of block "hp" in
+/// memory, the caller knows the bytes in between are not used.  The block
+/// must not be locked.  It gets its full size back when it is locked again
+/// or written.
+void mf_shrink(memfile_T *mfp, bhdr_T *hp, unsigned head, unsigned tail)
+{
+  unsigned size = mfp->mf_page_size * hp->bh_page_count;
+  if ((hp->bh_flags & (BH_LOCKED | BH_SHRUNK)) || head + tail >= size) {
+    return;
+  }
+
+  char *p = xmalloc(head + tail);
+  memcpy(p, hp->bh_data, head);
+  memcpy(p + head, (char *)hp->bh_data + size - tail, tail);
+  xfree(hp->bh_data);
+  hp->bh_data = p;
+  hp->bh_shrunk_head = head;
+  hp->bh_shrunk_tail = tail;
+  hp->bh_flags |= BH_SHRUNK;
+}
+
+/// Give block "hp" its full size again after mf_shrink().
+/// The unused part is cleared.
+static void mf_unshrink(memfile_T *mfp, bhdr_T *hp)
+{
+  if (!(hp->bh_flags & BH_SHRUNK)) {
+    return;
+  }
+
+  unsigned size = mfp->mf_page_size * hp->bh_page_count;
+  unsigned head = hp->bh_shrunk_head;
+  unsigned tail = hp->bh_shrunk_tail;
+  char *p = xmalloc(size);
+  memcpy(p, hp->bh_data, head);
+  memset(p + head, 0, size - head - tail);
+  memcpy(p + size - tail, (char *)hp->bh_data + head, tail);
+  xfree(hp->bh_data);
+  hp->bh_data = p;
+  hp->bh_flags &= ~BH_SHRUNK;
+}
+
 /// Release as many blocks as possible.
 ///
 /// Used in case of out of memory
@@ -490,9 +609,11 @@ bool mf_release_all(void)
 /// Allocate a block header and a block of memory for it.
 static bhdr_T *mf_alloc_bhdr(memfile_T *mfp, unsigned page_count)
 {
+  AllocTag prev_tag = alloc_tag_push(kAllocTagMemline);
   bhdr_T *hp = xmalloc(sizeof(bhdr_T));
   hp->bh_data = xmalloc((size_t)mfp->mf_page_size * page_count);
   hp->bh_page_count = page_count;
+  alloc_tag_pop(prev_tag);
   return hp;
 }
 
@@ -567,6 +688,8 @@ static int mf_write(memfile_T *mfp, bhdr_T *hp)
     return FAIL;
   }
 
+  mf_unshrink(mfp, hp);
+
   if (hp->bh_bnum < 0) {    // must assign file block number
     if (mf_trans_add(mfp, hp) == FAIL) {
       return FAIL;
@@ -598,6 +721,7 @@ static int mf_write(memfile_T *mfp, bhdr_T *hp)
       page_count = 1;
     } else {
       page_count = hp2->bh_page_count;
+      mf_unshrink(mfp, hp2);
     }
     unsigned size = page_size * page_count;  // number of bytes written
     void *data = (hp2 == NULL) ? hp->bh_data : hp2->bh_data;
@@ -34,7 +34,13 @@ typedef struct bhdr {
 
 #define BH_DIRTY    1U
 #define BH_LOCKED   2U
-  unsigned bh_flags;                 ///< BH_DIRTY or BH_LOCKED
+#define BH_SHRUNK   4U
+  unsigned bh_flags;                 ///< BH_DIRTY, BH_LOCKED or BH_SHRUNK
+
+  /// With BH_SHRUNK only the first "bh_shrunk_head" and the last
+  /// "bh_shrunk_tail" bytes of the block are kept, see mf_shrink().
+  unsigned bh_shrunk_head;
+  unsigned bh_shrunk_tail;
 } bhdr_T;
 
 typedef enum {
@@ -65,4 +71,5 @@ typedef struct memfile {
   blocknr_T mf_infile_count;         ///< number of pages in the file
   unsigned mf_page_size;             ///< number of bytes in a page
   mfdirty_T mf_dirty;
+  struct mf_fsync *mf_fsync;         ///< background fsync in progress or NULL
 } memfile_T;
@@ -229,6 +229,11 @@ enum {
 };
 #define ML_SIMPLE(x)    ((x) & 0x10)  // DEL, INS or FIND
 
+// flags for ml_append_int()
+#define ML_APPEND_NEW   1     // starting to edit a new file
+#define ML_APPEND_MARK  2     // mark the new line
+#define ML_APPEND_BULK  4     // more lines will be appended after this one
+
 // argument for ml_upd_block0()
 typedef enum {
   UB_FNAME = 0,         // update timestamp and filename
@@ -276,6 +281,12 @@ int ml_open(buf_T *buf)
   buf->b_ml.ml_line_offset = 0;
   buf->b_ml.ml_chunksize = NULL;
   buf->b_ml.ml_usedchunks = 0;
+  buf->b_ml.ml_chunkfen = NULL;
+  buf->b_ml.ml_chunkfen_len = 0;
+  buf->b_ml.ml_chunkfen_size = 0;
+  buf->b_ml.ml_blockidx = NULL;
+  buf->b_ml.ml_blockidx_len = 0;
+  buf->b_ml.ml_blockidx_size = 0;
 
   if (cmdmod.cmod_flags & CMOD_NOSWAPFILE) {
     buf->b_p_swf = false;
@@ -558,6 +569,12 @@ void ml_close(buf_T *buf, int del_file)
   }
   xfree(buf->b_ml.ml_stack);
   XFREE_CLEAR(buf->b_ml.ml_chunksize);
+  XFREE_CLEAR(buf->b_ml.ml_chunkfen);
+  buf->b_ml.ml_chunkfen_len = 0;
+  buf->b_ml.ml_chunkfen_size = 0;
+  XFREE_CLEAR(buf->b_ml.ml_blockidx);
+  buf->b_ml.ml_blockidx_len = 0;
+  buf->b_ml.ml_blockidx_size = 0;
   buf->b_ml.ml_mfp = NULL;
 
   // Reset the "recovered" flag, give the ATTENTION prompt the next time
@@ -813,6 +830,9 @@ void ml_recover(bool checkext)
   buf->b_ml.ml_line_lnum = 0;           // no cached line
   buf->b_ml.ml_line_offset = 0;
   buf->b_ml.ml_locked = NULL;           // no locked block
+  buf->b_ml.ml_blockidx = NULL;         // no data block index
+  buf->b_ml.ml_blockidx_len = 0;
+  buf->b_ml.ml_blockidx_size = 0;
   buf->b_ml.ml_flags = 0;
 
   // open the memfile from the old swapfile
@@ -1670,7 +1690,8 @@ static int recov_file_names(char **names, char *path, int prepend_dot)
 /// @param check_file  if true, check if original file exists and was not changed.
 /// @param check_char  if true, stop syncing when character becomes available, but
 ///
-/// always sync at least one block.
+/// always sync at least one block.  The fsync is then done in the background,
+/// so that a slow file system doesn't block typing.
 void ml_sync_all(int check_file, int check_char, bool do_fsync)
 {
   FOR_ALL_BUFFERS(buf) {
@@ -1695,7 +1716,7 @@ void ml_sync_all(int check_file, int check_char, bool do_fsync)
       }
     }
     if (buf->b_ml.ml_mfp->mf_dirty == MF_DIRTY_YES) {
-      (void)mf_sync(buf->b_ml.ml_mfp, (check_char ? MFS_STOP : 0)
+      (void)mf_sync(buf->b_ml.ml_mfp, (check_char ? MFS_STOP | MFS_ASYNC : 0)
                     | (do_fsync && bufIsChanged(buf) ? MFS_FLUSH : 0));
       if (check_char && os_char_avail()) {      // character available now
         break;
@@ -1734,6 +1755,9 @@ void ml_preserve(buf_T *buf, int message, bool do_fsync)
 
   // stack is invalid after mf_sync(.., MFS_ALL)
   buf->b_ml.ml_stack_top = 0;
+  // The data block index would skip the pointer blocks below, which must
+  // be visited to translate the negative block numbers.
+  buf->b_ml.ml_blockidx_len = 0;
 
   // Some of the data blocks may have been changed from negative to
   // positive block number. In that case the pointer blocks need to be
@@ -1775,6 +1799,36 @@ theend:
   }
 }
 
+/// Shrink the data blocks of buffers not displayed in any window: the free
+/// space between the index and the text of a block is not kept in memory
+/// until the block is used again.  Used when waiting for a character.
+void ml_shrink_hidden(void)
+{
+  FOR_ALL_BUFFERS(buf) {
+    memfile_T *mfp = buf->b_ml.ml_mfp;
+    if (mfp == NULL || buf->b_nwindows > 0) {
+      continue;
+    }
+    ml_flush_line(buf);                     // flush buffered line
+    (void)ml_find_line(buf, 0, ML_FLUSH);   // unlock the locked block
+
+    bhdr_T *hp;
+    map_foreach_value(&mfp->mf_hash, hp, {
+      DataBlock *dp = hp->bh_data;
+      if ((hp->bh_flags & (BH_LOCKED | BH_SHRUNK)) || dp->db_id != DATA_ID) {
+        continue;
+      }
+      unsigned size = mfp->mf_page_size * hp->bh_page_count;
+      // not worth it when the block is almost full
+      if (dp->db_free < size / 4) {
+        continue;
+      }
+      unsigned head = (unsigned)HEADER_SIZE + (unsigned)dp->db_line_count * (unsigned)INDEX_SIZE;
+      mf_shrink(mfp, hp, head, size - dp->db_txt_start);
+    })
+  }
+}
+
 // NOTE: The pointer returned by the ml_get_*() functions only remains valid
 // until the next call!
 //  line1 = ml_get(1);
@@ -1888,6 +1942,7 @@ errorret:
 
     char *ptr = (char *)dp + (dp->db_index[lnum - buf->b_ml.ml_locked_low] & DB_INDEX_MASK);
     buf->b_ml.ml_line_ptr = ptr;
+    buf->b_ml.ml_line_size = 0;
     buf->b_ml.ml_line_lnum = lnum;
     buf->b_ml.ml_flags &= ~(ML_LINE_DIRTY | ML_ALLOCATED);
   }
@@ -1906,6 +1961,7 @@ errorret:
   if ((buf->b_ml.ml_flags & (ML_LINE_DIRTY | ML_ALLOCATED)) == 0) {
     // make sure the text is in allocated memory
     buf->b_ml.ml_line_ptr = xstrdup(buf->b_ml.ml_line_ptr);
+    buf->b_ml.ml_line_size = 0;
     buf->b_ml.ml_flags |= ML_ALLOCATED;
     if (will_change) {
       // can't make the change in the data block
@@ -1949,7 +2005,7 @@ int ml_append(linenr_T lnum, char *line, colnr_T len, bool newfile)
   if (curbuf->b_ml.ml_line_lnum != 0) {
     ml_flush_line(curbuf);
   }
-  return ml_append_int(curbuf, lnum, line, len, newfile, false);
+  return ml_append_int(curbuf, lnum, line, len, newfile ? ML_APPEND_NEW : 0);
 }
 
 /// Like ml_append() but for an arbitrary buffer.  The buffer must already have
@@ -1969,16 +2025,51 @@ int ml_append_buf(buf_T *buf, linenr_T lnum, char *line, colnr_T len, bool newfi
   if (buf->b_ml.ml_line_lnum != 0) {
     ml_flush_line(buf);
   }
-  return ml_append_int(buf, lnum, line, len, newfile, false);
+  return ml_append_int(buf, lnum, line, len, newfile ? ML_APPEND_NEW : 0);
+}
+
+/// Append "count" lines after "lnum" in buffer "buf".  The buffer must already
+/// have a memline.
+///
+/// Faster than calling ml_append_buf() for each line: lines that don't fit in
+/// the current data block go into fresh data blocks, instead of being inserted
+/// one by one in front of the next block.
+///
+/// @param lnum  append after this line (can be 0)
+/// @param lines  text of the new lines, NUL terminated
+/// @param count  number of lines in "lines"
+/// @param newfile  flag, see ml_append()
+///
+/// @return  number of lines appended, less than "count" on failure.
+int ml_append_buf_lines(buf_T *buf, linenr_T lnum, char **lines, int count, bool newfile)
+  FUNC_ATTR_NONNULL_ALL
+{
+  if (buf->b_ml.ml_mfp == NULL) {
+    return 0;
+  }
+
+  if (buf->b_ml.ml_line_lnum != 0) {
+    ml_flush_line(buf);
+  }
+  int i;
+  for (i = 0; i < count; i++) {
+    int flags = (newfile ? ML_APPEND_NEW : 0) | (i < count - 1 ? ML_APPEND_BULK : 0);
+    if (ml_append_int(buf, lnum + i, lines[i], 0, flags) == FAIL) {
+      break;
+    }
+  }
+  return i;
 }
 
 /// @param lnum  append after this line (can be 0)
 /// @param line  text of the new line
 /// @param len  length of line, including NUL, or 0
-/// @param newfile  flag, see above
-/// @param mark  mark the new line
-static int ml_append_int(buf_T *buf, linenr_T lnum, char *line, colnr_T len, bool newfile, int mark)
+/// @param flags  ML_APPEND_ flags
+static int ml_append_int(buf_T *buf, linenr_T lnum, char *line, colnr_T len, int flags)
 {
+  bool newfile = flags & ML_APPEND_NEW;
+  bool mark = flags & ML_APPEND_MARK;
+
   // lnum out of range
   if (lnum > buf->b_ml.ml_line_count || buf->b_ml.ml_mfp == NULL) {
     return FAIL;
@@ -2022,9 +2113,11 @@ static int ml_append_int(buf_T *buf, linenr_T lnum, char *line, colnr_T len, boo
   // - there is not enough room in the current block
   // - appending to the last line in the block
   // - not appending to the last line in the file
+  // - not appending more lines, they would all be moved in front of the
+  //   block, better start a new block
   // insert in front of the next block.
   if ((int)dp->db_free < space_needed && db_idx == line_count - 1
-      && lnum < buf->b_ml.ml_line_count) {
+      && lnum < buf->b_ml.ml_line_count && !(flags & ML_APPEND_BULK)) {
     // Now that the line is not going to be inserted in the block that we
     // expected, the line count has to be adjusted in the pointer blocks
     // by using ml_locked_lineadd.
@@ -2450,12 +2543,54 @@ int ml_replace_buf(buf_T *buf, linenr_T lnum, char *line, bool copy)
   }
 
   buf->b_ml.ml_line_ptr = line;
+  buf->b_ml.ml_line_size = 0;
   buf->b_ml.ml_line_lnum = lnum;
   buf->b_ml.ml_flags = (buf->b_ml.ml_flags | ML_LINE_DIRTY) & ~ML_EMPTY;
 
   return OK;
 }
 
+/// Replace "oldlen" bytes at byte "col" of line "lnum" in the current buffer
+/// with "newlen" bytes, which the caller fills in.  Like ml_replace(), but
+/// when "lnum" is the cached line and it was changed already, it is resized
+/// in place.  Typing in a long line then doesn't allocate a new line and copy
+/// all of it for every character.
+///
+/// Like after ml_replace(), a pointer obtained with ml_get() is invalid.
+///
+/// @return  where the new bytes go, NULL for failure.
+char *ml_replace_bytes(linenr_T lnum, colnr_T col, size_t oldlen, size_t newlen)
+{
+  memline_T *ml = &curbuf->b_ml;
+
+  if (ml->ml_mfp != NULL && ml->ml_line_lnum == lnum && (ml->ml_flags & ML_LINE_DIRTY)
+      && kv_size(curbuf->update_callbacks) == 0) {
+    char *line = ml->ml_line_ptr;
+    size_t len = strlen(line) + 1;
+    size_t size = len + newlen - oldlen;
+    if (size > MAX(ml->ml_line_size, len)) {
+      // grow with some room for the following characters
+      ml->ml_line_size = size + size / 2;
+      line = ml->ml_line_ptr = xrealloc(line, ml->ml_line_size);
+    }
+    memmove(line + col + newlen, line + col + oldlen, len - (size_t)col - oldlen);
+    ml->ml_flags &= ~ML_EMPTY;
+    return line + col;
+  }
+
+  char *oldp = ml_get(lnum);
+  size_t len = strlen(oldp) + 1;
+  size_t size = len + newlen - oldlen;
+  char *newp = xmalloc(size);
+  memmove(newp, oldp, (size_t)col);
+  memmove(newp + col + newlen, oldp + col + oldlen, len - (size_t)col - oldlen);
+  if (ml_replace(lnum, newp, false) == FAIL) {
+    return NULL;
+  }
+  ml->ml_line_size = size;
+  return newp + col;
+}
+
 /// Delete line `lnum` in the current buffer.
 ///
 /// @note The caller of this function should probably also call
@@ -2776,8 +2911,8 @@ static void ml_flush_line(buf_T *buf)
         // that has only one line.
         // Don't forget to copy the mark!
         // How about handling errors???
-        (void)ml_append_int(buf, lnum, new_line, new_len, false,
-                            (int)(dp->db_index[idx] & DB_MARKED));
+        (void)ml_append_int(buf, lnum, new_line, new_len,
+                            (dp->db_index[idx] & DB_MARKED) ? ML_APPEND_MARK : 0);
         (void)ml_delete_int(buf, lnum, false);
       }
     }
@@ -2790,6 +2925,7 @@ static void ml_flush_line(buf_T *buf)
 
   buf->b_ml.ml_flags &= ~(ML_LINE_DIRTY | ML_ALLOCATED);
   buf->b_ml.ml_line_lnum = 0;
+  buf->b_ml.ml_line_size = 0;
   buf->b_ml.ml_line_offset = 0;
 }
 
@@ -2839,6 +2975,11 @@ static bhdr_T *ml_find_line(buf_T *buf, linenr_T lnum, int action)
 
   memfile_T *mfp = buf->b_ml.ml_mfp;
 
+  // Line numbers of the block with "lnum" and the blocks after it change.
+  if (action == ML_INSERT || action == ML_DELETE) {
+    ml_blockidx_truncate(buf, lnum);
+  }
+
   // If there is a locked block check if the wanted line is in it.
   // If not, flush and release the locked block.
   // Don't do this for ML_INSERT_SAME, because the stack need to be updated.
@@ -2893,6 +3034,10 @@ static bhdr_T *ml_find_line(buf_T *buf, linenr_T lnum, int action)
     }
     if (top < 0) {
       buf->b_ml.ml_stack_top = 0;               // not found, start at the root
+      // Rather than walking down from the root, try the data block index.
+      if ((hp = ml_blockidx_find(buf, lnum)) != NULL) {
+        return hp;
+      }
     }
   } else {  // ML_DELETE or ML_INSERT
     buf->b_ml.ml_stack_top = 0;         // start at the root
@@ -2992,6 +3137,167 @@ error_noblock:
   return NULL;
 }
 
+/// @return  the last line covered by the data block index, zero when empty.
+static linenr_T ml_blockidx_end(buf_T *buf)
+{
+  if (buf->b_ml.ml_blockidx_len == 0) {
+    return 0;
+  }
+  blockidx_T *last = &buf->b_ml.ml_blockidx[buf->b_ml.ml_blockidx_len - 1];
+  return last->mlbi_low + last->mlbi_count - 1;
+}
+
+/// Drop the entries of the data block index for the block holding line
+/// "lnum" and the blocks after it.
+static void ml_blockidx_truncate(buf_T *buf, linenr_T lnum)
+{
+  blockidx_T *bi = buf->b_ml.ml_blockidx;
+  int lo = 0;
+  int hi = buf->b_ml.ml_blockidx_len;
+
+  // find the first entry that does not end before "lnum"
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (bi[mid].mlbi_low + bi[mid].mlbi_count <= lnum) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  buf->b_ml.ml_blockidx_len = lo;
+}
+
+/// Append the data blocks in the tree below block "bnum", which starts at
+/// line "low", to the data block index.  Blocks already in the index are
+/// skipped, stops once the block holding "lnum" has been added.
+///
+/// Like ml_find_line() negative block numbers are translated on the way.
+///
+/// @return  false when a block is missing or the tree does not match the index.
+static bool ml_blockidx_fill(buf_T *buf, blocknr_T bnum, int page_count, linenr_T low,
+                             linenr_T lnum)
+{
+  memfile_T *mfp = buf->b_ml.ml_mfp;
+  bhdr_T *hp = mf_get(mfp, bnum, (unsigned)page_count);
+  if (hp == NULL) {
+    return false;
+  }
+
+  DataBlock *dp = hp->bh_data;
+  if (dp->db_id == DATA_ID) {
+    memline_T *ml = &buf->b_ml;
+    bool ok = low == ml_blockidx_end(buf) + 1;
+    if (ok) {
+      if (ml->ml_blockidx_len == ml->ml_blockidx_size) {
+        ml->ml_blockidx_size = ml->ml_blockidx_size == 0 ? 64 : ml->ml_blockidx_size * 2;
+        ml->ml_blockidx = xrealloc(ml->ml_blockidx,
+                                   sizeof(blockidx_T) * (size_t)ml->ml_blockidx_size);
+      }
+      ml->ml_blockidx[ml->ml_blockidx_len++] = (blockidx_T){
+        .mlbi_low = low,
+        .mlbi_count = (linenr_T)dp->db_line_count,
+        .mlbi_bnum = bnum,
+        .mlbi_page_count = page_count,
+      };
+    }
+    mf_put(mfp, hp, false, false);
+    return ok;
+  }
+
+  PointerBlock *pp = (PointerBlock *)dp;
+  if (pp->pb_id != PTR_ID) {
+    iemsg(_(e_pointer_block_id_wrong));
+    mf_put(mfp, hp, false, false);
+    return false;
+  }
+
+  bool ok = true;
+  bool dirty = false;
+  for (int idx = 0; idx < (int)pp->pb_count && ml_blockidx_end(buf) < lnum; idx++) {
+    PointerEntry *pe = &pp->pb_pointer[idx];
+    linenr_T next = low + pe->pe_line_count;
+    if (next - 1 > ml_blockidx_end(buf)) {
+      // a negative block number may have been changed
+      if (pe->pe_bnum < 0) {
+        blocknr_T bnum2 = mf_trans_del(mfp, pe->pe_bnum);
+        if (pe->pe_bnum != bnum2) {
+          pe->pe_bnum = bnum2;
+          dirty = true;
+        }
+      }
+      if (!ml_blockidx_fill(buf, pe->pe_bnum, pe->pe_page_count, low, lnum)) {
+        ok = false;
+        break;
+      }
+    }
+    low = next;
+  }
+  mf_put(mfp, hp, dirty, false);
+  return ok;
+}
+
+/// Find the data block holding line "lnum" through the data block index,
+/// extending the index when needed.  The block is locked like ml_find_line()
+/// does, but the stack is left empty.
+///
+/// @return  NULL when the index can't be used, the tree must be walked then.
+static bhdr_T *ml_blockidx_find(buf_T *buf, linenr_T lnum)
+{
+  memline_T *ml = &buf->b_ml;
+
+  if (lnum < 1 || lnum > ml->ml_line_count) {
+    return NULL;
+  }
+  if (ml_blockidx_end(buf) < lnum && !ml_blockidx_fill(buf, 1, 1, 1, lnum)) {
+    ml->ml_blockidx_len = 0;
+    return NULL;
+  }
+
+  int lo = 0;
+  int hi = ml->ml_blockidx_len;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (ml->ml_blockidx[mid].mlbi_low + ml->ml_blockidx[mid].mlbi_count <= lnum) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == ml->ml_blockidx_len || ml->ml_blockidx[lo].mlbi_low > lnum) {
+    ml->ml_blockidx_len = 0;
+    return NULL;
+  }
+
+  blockidx_T *bi = &ml->ml_blockidx[lo];
+  if (bi->mlbi_bnum < 0) {
+    // The block may have been given a positive number since it was added.
+    // Don't remove the translation, the pointer block still needs it.
+    blocknr_T *trans = map_ref(int64_t, int64_t)(&ml->ml_mfp->mf_trans, bi->mlbi_bnum, false);
+    if (trans != NULL) {
+      bi->mlbi_bnum = *trans;
+    }
+  }
+
+  bhdr_T *hp = mf_get(ml->ml_mfp, bi->mlbi_bnum, (unsigned)bi->mlbi_page_count);
+  if (hp == NULL) {
+    ml_blockidx_truncate(buf, bi->mlbi_low);
+    return NULL;
+  }
+  DataBlock *dp = hp->bh_data;
+  if (dp->db_id != DATA_ID || dp->db_line_count != bi->mlbi_count) {
+    mf_put(ml->ml_mfp, hp, false, false);
+    ml_blockidx_truncate(buf, bi->mlbi_low);
+    return NULL;
+  }
+
+  ml->ml_locked = hp;
+  ml->ml_locked_low = bi->mlbi_low;
+  ml->ml_locked_high = bi->mlbi_low + bi->mlbi_count - 1;
+  ml->ml_locked_lineadd = 0;
+  ml->ml_flags &= ~(ML_LOCKED_DIRTY | ML_LOCKED_POS);
+  return hp;
+}
+
 /// add an entry to the info pointer stack
 ///
 /// @return  number of the new entry
@@ -3674,6 +3980,91 @@ enum {
   MLCS_MINL = 400,  // should be half of MLCS_MAXL
 };
 
+/// Rebuild the Fenwick tree over the chunks of "buf" from ml_chunksize.
+static void ml_chunkfen_build(buf_T *buf)
+{
+  memline_T *ml = &buf->b_ml;
+  int n = ml->ml_usedchunks;
+
+  if (n + 1 > ml->ml_chunkfen_size) {
+    ml->ml_chunkfen_size = MAX(ml->ml_numchunks, n) + 1;
+    xfree(ml->ml_chunkfen);
+    ml->ml_chunkfen = xmalloc(sizeof(chunksize_T) * (size_t)ml->ml_chunkfen_size);
+  }
+  chunksize_T *fen = ml->ml_chunkfen;
+  memcpy(fen + 1, ml->ml_chunksize, sizeof(chunksize_T) * (size_t)n);
+  for (int i = 1; i <= n; i++) {
+    int parent = i + (i & -i);
+    if (parent <= n) {
+      fen[parent].mlcs_numlines += fen[i].mlcs_numlines;
+      fen[parent].mlcs_totalsize += fen[i].mlcs_totalsize;
+    }
+  }
+  ml->ml_chunkfen_len = n;
+}
+
+/// Add "lines" and "size" to chunk "ix" in the Fenwick tree, if it is valid.
+static void ml_chunkfen_add(buf_T *buf, int ix, int lines, int size)
+{
+  memline_T *ml = &buf->b_ml;
+
+  if (ml->ml_chunkfen_len != ml->ml_usedchunks) {
+    ml->ml_chunkfen_len = 0;
+    return;
+  }
+  for (int i = ix + 1; i <= ml->ml_chunkfen_len; i += i & -i) {
+    ml->ml_chunkfen[i].mlcs_numlines += lines;
+    ml->ml_chunkfen[i].mlcs_totalsize += size;
+  }
+}
+
+/// Find the last chunk before the one containing line "lnum" or byte
+/// "offset", like walking ml_chunksize from the start.  The last chunk never
+/// qualifies.
+///
+/// @param[out] curlinep  first line of the returned chunk
+/// @param[out] sizep  size of the chunks before it, including a CR for each
+///                    line when "offset" and "ffdos" are set
+///
+/// @return  index of the chunk
+static int ml_chunkfen_find(buf_T *buf, linenr_T lnum, int offset, int ffdos,
+                            linenr_T *curlinep, int *sizep)
+{
+  memline_T *ml = &buf->b_ml;
+
+  if (ml->ml_chunkfen_len != ml->ml_usedchunks) {
+    ml_chunkfen_build(buf);
+  }
+  int n = ml->ml_usedchunks - 1;
+  int step = 1;
+  while (step * 2 <= n) {
+    step *= 2;
+  }
+
+  int pos = 0;
+  linenr_T curline = 1;
+  int size = 0;
+  for (; n > 0 && step > 0; step >>= 1) {
+    if (pos + step > n) {
+      continue;
+    }
+    chunksize_T *node = &ml->ml_chunkfen[pos + step];
+    if ((lnum != 0 && lnum >= curline + node->mlcs_numlines)
+        || (offset != 0
+            && offset > size + node->mlcs_totalsize + ffdos * node->mlcs_numlines)) {
+      pos += step;
+      curline += node->mlcs_numlines;
+      size += node->mlcs_totalsize;
+      if (offset && ffdos) {
+        size += node->mlcs_numlines;
+      }
+    }
+  }
+  *curlinep = curline;
+  *sizep = size;
+  return pos;
+}
+
 /// Keep information for finding byte offset of a line
 ///
 /// @param updtype  may be one of:
@@ -3705,6 +4096,7 @@ static void ml_updatechunk(buf_T *buf, linenr_T line, int len, int updtype)
 
   if (updtype == ML_CHNK_UPDLINE && buf->b_ml.ml_line_count == 1) {
     // First line in empty buffer from ml_flush_line() -- reset
+    buf->b_ml.ml_chunkfen_len = 0;
     buf->b_ml.ml_usedchunks = 1;
     buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
     buf->b_ml.ml_chunksize[0].mlcs_totalsize = (int)strlen(buf->b_ml.ml_line_ptr) + 1;
@@ -3715,13 +4107,8 @@ static void ml_updatechunk(buf_T *buf, linenr_T line, int len, int updtype)
   // chunk.
   if (buf != ml_upd_lastbuf || line != ml_upd_lastline + 1
       || updtype != ML_CHNK_ADDLINE) {
-    for (curline = 1, curix = 0;
-         curix < buf->b_ml.ml_usedchunks - 1
-         && line >= curline +
-         buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-         curix++) {
-      curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-    }
+    int size;
+    curix = ml_chunkfen_find(buf, line, 0, 0, &curline, &size);
   } else if (curix < buf->b_ml.ml_usedchunks - 1
              && line >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines) {
     // Adjust cached curix & curline
@@ -3734,6 +4121,8 @@ static void ml_updatechunk(buf_T *buf, linenr_T line, int len, int updtype)
     len = -len;
   }
   curchnk->mlcs_totalsize += len;
+  ml_chunkfen_add(buf, curix,
+                  updtype == ML_CHNK_ADDLINE ? 1 : updtype == ML_CHNK_DELLINE ? -1 : 0, len);
   if (updtype == ML_CHNK_ADDLINE) {
     int rest;
     DataBlock *dp;
@@ -3749,6 +4138,8 @@ static void ml_updatechunk(buf_T *buf, linenr_T line, int len, int updtype)
     if (buf->b_ml.ml_chunksize[curix].mlcs_numlines >= MLCS_MAXL) {
       int text_end;
 
+      buf->b_ml.ml_chunkfen_len = 0;
+
       memmove(buf->b_ml.ml_chunksize + curix + 1,
               buf->b_ml.ml_chunksize + curix,
               (size_t)(buf->b_ml.ml_usedchunks - curix) * sizeof(chunksize_T));
@@ -3794,6 +4185,7 @@ static void ml_updatechunk(buf_T *buf, linenr_T line, int len, int updtype)
                && buf->b_ml.ml_line_count - line <= 1) {
       // We are in the last chunk and it is cheap to create a new one
       // after this. Do it now to avoid the loop above later on
+      buf->b_ml.ml_chunkfen_len = 0;
       curchnk = buf->b_ml.ml_chunksize + curix + 1;
       buf->b_ml.ml_usedchunks++;
       if (line == buf->b_ml.ml_line_count) {
@@ -3829,6 +4221,7 @@ static void ml_updatechunk(buf_T *buf, linenr_T line, int len, int updtype)
       curix++;
       curchnk = buf->b_ml.ml_chunksize + curix;
     } else if (curix == 0 && curchnk->mlcs_numlines <= 0) {
+      buf->b_ml.ml_chunkfen_len = 0;
       buf->b_ml.ml_usedchunks--;
       memmove(buf->b_ml.ml_chunksize, buf->b_ml.ml_chunksize + 1,
               (size_t)buf->b_ml.ml_usedchunks * sizeof(chunksize_T));
@@ -3841,6 +4234,7 @@ static void ml_updatechunk(buf_T *buf, linenr_T line, int len, int updtype)
     }
 
     // Collapse chunks
+    buf->b_ml.ml_chunkfen_len = 0;
     curchnk[-1].mlcs_numlines += curchnk->mlcs_numlines;
     curchnk[-1].mlcs_totalsize += curchnk->mlcs_totalsize;
     buf->b_ml.ml_usedchunks--;
@@ -3913,23 +4307,9 @@ int ml_find_line_or_offset(buf_T *buf, linenr_T lnum, int *offp, bool no_ff)
   }
   // Find the last chunk before the one containing our line. Last chunk is
   // special because it will never qualify
-  linenr_T curline = 1;
-  int curix = 0;
-  int size = 0;
-  while (curix < buf->b_ml.ml_usedchunks - 1
-         && ((lnum != 0
-              && lnum >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines)
-             || (offset != 0
-                 && offset > size +
-                 buf->b_ml.ml_chunksize[curix].mlcs_totalsize
-                 + ffdos * buf->b_ml.ml_chunksize[curix].mlcs_numlines))) {
-    curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-    size += buf->b_ml.ml_chunksize[curix].mlcs_totalsize;
-    if (offset && ffdos) {
-      size += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-    }
-    curix++;
-  }
+  linenr_T curline;
+  int size;
+  ml_chunkfen_find(buf, lnum, offset, ffdos, &curline, &size);
 
   while ((lnum != 0 && curline < lnum) || (offset != 0 && size < offset)) {
     if (curline > buf->b_ml.ml_line_count
@@ -19,6 +19,14 @@ typedef struct ml_chunksize {
   int mlcs_totalsize;
 } chunksize_T;
 
+/// Entry in the data block index, see ml_find_line().
+typedef struct ml_blockidx {
+  linenr_T mlbi_low;            // first line in the data block
+  linenr_T mlbi_count;          // number of lines in the data block
+  blocknr_T mlbi_bnum;          // block number of the data block
+  int mlbi_page_count;          // number of pages in the data block
+} blockidx_T;
+
 // Flags when calling ml_updatechunk()
 #define ML_CHNK_ADDLINE 1
 #define ML_CHNK_DELLINE 2
@@ -32,7 +40,13 @@ typedef struct ml_chunksize {
 ///   data_block: leaf nodes
 ///
 /// Memline also has "chunks" of 800 lines that are separate from the 128-tree
-/// structure, primarily used to speed up line2byte() and byte2line().
+/// structure, primarily used to speed up line2byte() and byte2line().  A
+/// Fenwick tree over the chunks finds the chunk for a line or offset in
+/// O(log n).
+///
+/// The data blocks are also listed in line order in ml_blockidx, so that a
+/// random lookup can binary search for the block instead of walking down the
+/// tree from the root.
 ///
 /// Motivation: If you have a file that is 10000 lines long, and you insert
 ///             a line at linenr 1000, you don't want to move 9000 lines in
@@ -57,6 +71,8 @@ typedef struct memline {
 
   linenr_T ml_line_lnum;        // line number of cached line, 0 if not valid
   char *ml_line_ptr;            // pointer to cached line
+  size_t ml_line_size;          // allocated size of ml_line_ptr, zero when
+                                // not known, see ml_replace_bytes()
   size_t ml_line_offset;        // cached byte offset of ml_line_lnum
   int ml_line_offset_ff;        // fileformat of cached line
 
@@ -67,4 +83,20 @@ typedef struct memline {
   chunksize_T *ml_chunksize;
   int ml_numchunks;
   int ml_usedchunks;
+
+  // Fenwick tree over ml_chunksize, to find the chunk holding a line or byte
+  // offset without walking all chunks.  Entry i (1-based) holds the sums of
+  // the chunks in a range ending at chunk i - 1.  Only valid when
+  // ml_chunkfen_len equals ml_usedchunks, reset to zero when chunks are
+  // split, merged or removed.
+  chunksize_T *ml_chunkfen;
+  int ml_chunkfen_len;          // number of chunks covered by ml_chunkfen
+  int ml_chunkfen_size;         // number of allocated entries in ml_chunkfen
+
+  // Data blocks in line number order, for lookups that miss ml_stack.  Only
+  // the first ml_blockidx_len entries are valid, inserting or deleting a line
+  // drops the entries from the changed block onwards.
+  blockidx_T *ml_blockidx;
+  int ml_blockidx_len;          // number of valid entries in ml_blockidx
+  int ml_blockidx_size;         // number of allocated entries in ml_blockidx
 } memline_T;
@@ -7,10 +7,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <uv.h>
 
 #include "nvim/api/extmark.h"
+#include "nvim/api/ui.h"
 #include "nvim/arglist.h"
 #include "nvim/ascii.h"
+#include "nvim/assert.h"
 #include "nvim/buffer_updates.h"
 #include "nvim/context.h"
 #include "nvim/decoration_provider.h"
@@ -23,6 +26,7 @@
 #include "nvim/insexpand.h"
 #include "nvim/lua/executor.h"
 #include "nvim/main.h"
+#include "nvim/map.h"
 #include "nvim/mapping.h"
 #include "nvim/memfile.h"
 #include "nvim/memory.h"
@@ -44,6 +48,30 @@ MemCalloc mem_calloc = &calloc;
 MemRealloc mem_realloc = &realloc;
 #endif
 
+/// Live allocations per AllocTag, see alloc_track_enable().
+typedef struct {
+  int64_t count;
+  int64_t bytes;
+} alloc_track_T;
+
+static bool alloc_track = false;
+static bool alloc_track_busy = false;  ///< avoid recursion from the map
+static uv_thread_t alloc_track_thread;
+static AllocTag alloc_tag = kAllocTagOther;
+/// Pointer to its size and tag (shifted by 3 bits and in the low 3 bits).
+static Map(uint64_t, uint64_t) alloc_track_map = MAP_INIT;
+static alloc_track_T alloc_track_stats[kAllocTagCount];
+
+static const char *const alloc_tag_names[kAllocTagCount] = {
+  [kAllocTagOther] = "other",
+  [kAllocTagMemline] = "memline",
+  [kAllocTagUndo] = "undo",
+  [kAllocTagEval] = "eval",
+  [kAllocTagLua] = "lua",
+  [kAllocTagExtmark] = "extmark",
+  [kAllocTagRpc] = "rpc",
+};
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "memory.c.generated.h"
 #endif
@@ -52,6 +80,95 @@ MemRealloc mem_realloc = &realloc;
 bool entered_free_all_mem = false;
 #endif
 
+/// Starts or stops counting live allocations per AllocTag.  Only allocations
+/// done on the main thread while tracking is enabled are counted.  This is off
+/// by default, since it costs a hash table update for every allocation.
+void alloc_track_enable(bool enable)
+{
+  if (enable == alloc_track) {
+    return;
+  }
+  alloc_track = false;
+  alloc_track_busy = true;
+  map_destroy(uint64_t, &alloc_track_map);
+  alloc_track_map = (Map(uint64_t, uint64_t)) MAP_INIT;
+  alloc_track_busy = false;
+  memset(alloc_track_stats, 0, sizeof(alloc_track_stats));
+  alloc_track_thread = uv_thread_self();
+  alloc_track = enable;
+}
+
+bool alloc_track_enabled(void)
+{
+  return alloc_track;
+}
+
+/// Gets the name of AllocTag "tag" and the live allocations counted for it.
+const char *alloc_track_get(AllocTag tag, int64_t *count, int64_t *bytes)
+{
+  *count = alloc_track_stats[tag].count;
+  *bytes = alloc_track_stats[tag].bytes;
+  return alloc_tag_names[tag];
+}
+
+/// Sets the AllocTag for allocations until the matching alloc_tag_pop().
+///
+/// @return  the previous tag, to be passed to alloc_tag_pop().
+AllocTag alloc_tag_push(AllocTag tag)
+{
+  AllocTag prev = alloc_tag;
+  alloc_tag = tag;
+  return prev;
+}
+
+void alloc_tag_pop(AllocTag prev)
+{
+  alloc_tag = prev;
+}
+
+static bool alloc_track_active(void)
+{
+  if (!alloc_track || alloc_track_busy) {
+    return false;
+  }
+  uv_thread_t self = uv_thread_self();
+  return uv_thread_equal(&alloc_track_thread, &self);
+}
+
+static void alloc_track_forget(void *ptr)
+{
+  uint64_t val = map_del(uint64_t, uint64_t)(&alloc_track_map, (uint64_t)(uintptr_t)ptr, NULL);
+  if (val != 0) {
+    alloc_track_stats[val & 7].count--;
+    alloc_track_stats[val & 7].bytes -= (int64_t)(val >> 3);
+  }
+}
+
+static void alloc_track_add(void *ptr, size_t size)
+{
+  if (!alloc_track_active()) {
+    return;
+  }
+  alloc_track_busy = true;
+  // An address freed with plain free() may come back.
+  alloc_track_forget(ptr);
+  map_put(uint64_t, uint64_t)(&alloc_track_map, (uint64_t)(uintptr_t)ptr,
+                              ((uint64_t)size << 3) | (uint64_t)alloc_tag);
+  alloc_track_stats[alloc_tag].count++;
+  alloc_track_stats[alloc_tag].bytes += (int64_t)size;
+  alloc_track_busy = false;
+}
+
+static void alloc_track_del(void *ptr)
+{
+  if (ptr == NULL || !alloc_track_active()) {
+    return;
+  }
+  alloc_track_busy = true;
+  alloc_track_forget(ptr);
+  alloc_track_busy = false;
+}
+
 /// Try to free memory. Used when trying to recover from out of memory errors.
 /// @see {xmalloc}
 void try_to_free_memory(void)
@@ -89,6 +206,9 @@ void *try_malloc(size_t size) FUNC_ATTR_MALLOC FUNC_ATTR_ALLOC_SIZE(1)
     try_to_free_memory();
     ret = malloc(allocated_size);
   }
+  if (ret && alloc_track) {
+    alloc_track_add(ret, allocated_size);
+  }
   return ret;
 }
 
@@ -130,6 +250,9 @@ void *xmalloc(size_t size)
 /// @note Use XFREE_CLEAR() instead, if possible.
 void xfree(void *ptr)
 {
+  if (alloc_track) {
+    alloc_track_del(ptr);
+  }
   free(ptr);
 }
 
@@ -152,6 +275,9 @@ void *xcalloc(size_t count, size_t size)
       preserve_exit(e_outofmem);
     }
   }
+  if (alloc_track) {
+    alloc_track_add(ret, allocated_count * allocated_size);
+  }
   return ret;
 }
 
@@ -172,6 +298,18 @@ void *xrealloc(void *ptr, size_t size)
       preserve_exit(e_outofmem);
     }
   }
+  if (alloc_track && alloc_track_active()) {
+    // Keep the tag of the original allocation, unless it was not tracked.
+    AllocTag tag = alloc_tag;
+    uint64_t val = ptr ? map_get(uint64_t, uint64_t)(&alloc_track_map, (uint64_t)(uintptr_t)ptr)
+                       : 0;
+    if (val != 0) {
+      alloc_tag = (AllocTag)(val & 7);
+    }
+    alloc_track_del(ptr);
+    alloc_track_add(ret, allocated_size);
+    alloc_tag = tag;
+  }
   return ret;
 }
 
@@ -648,6 +786,44 @@ char *arena_memdupz(Arena *arena, const char *buf, size_t size)
   return mem;
 }
 
+// Let ASAN and the unit tests see every object as a separate allocation.
+#if defined(UNIT_TESTING) || __has_feature(address_sanitizer)
+# define POOL_PASSTHROUGH
+#endif
+
+/// Allocates an object from "pool".  Like xmalloc(), the memory is not
+/// initialized and the return value is never NULL.
+void *pool_alloc(Pool *pool)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_NONNULL_RET
+{
+#ifdef POOL_PASSTHROUGH
+  return xmalloc(pool->item_size);
+#else
+  void *item = pool->free_list;
+  if (item != NULL) {
+    pool->free_list = *(void **)item;
+    return item;
+  }
+  return arena_alloc(&pool->arena, pool->item_size, true);
+#endif
+}
+
+/// Returns an object allocated with pool_alloc() to "pool".
+///
+/// @param item  object to free, may be NULL
+void pool_free(Pool *pool, void *item)
+  FUNC_ATTR_NONNULL_ARG(1)
+{
+#ifdef POOL_PASSTHROUGH
+  xfree(item);
+#else
+  if (item != NULL) {
+    *(void **)item = pool->free_list;
+    pool->free_list = item;
+  }
+#endif
+}
+
 #if defined(EXITFREE)
 
 # include "nvim/autocmd.h"
@@ -668,6 +844,7 @@ char *arena_memdupz(Arena *arena, const char *buf, size_t size)
 # include "nvim/quickfix.h"
 # include "nvim/regexp.h"
 # include "nvim/search.h"
+# include "nvim/shada.h"
 # include "nvim/spell.h"
 # include "nvim/tag.h"
 # include "nvim/window.h"
@@ -687,6 +864,7 @@ void free_all_mem(void)
     return;
   }
   entered_free_all_mem = true;
+  alloc_track_enable(false);
   // Don't want to trigger autocommands from here on.
   block_autocmds();
 
@@ -816,8 +994,10 @@ void free_all_mem(void)
 
   decor_free_all_mem();
   drawline_free_all_mem();
+  shada_free_all_mem();
 
   ui_free_all_mem();
+  remote_ui_free_all_mem();
   nlua_free_all_mem();
   rpc_free_all_mem();
 
@@ -40,6 +40,19 @@ extern bool entered_free_all_mem;
 
 EXTERN size_t arena_alloc_count INIT( = 0);
 
+/// Category of allocations for the allocation tracking of nvim__stats().
+/// Set for a scope with alloc_tag_push() and alloc_tag_pop().
+typedef enum {
+  kAllocTagOther = 0,
+  kAllocTagMemline,
+  kAllocTagUndo,
+  kAllocTagEval,
+  kAllocTagLua,
+  kAllocTagExtmark,
+  kAllocTagRpc,
+  kAllocTagCount,
+} AllocTag;
+
 typedef struct consumed_blk {
   struct consumed_blk *prev;
 } *ArenaMem;
@@ -54,6 +67,20 @@ typedef struct {
 // inits an empty arena.
 #define ARENA_EMPTY { .cur_blk = NULL, .pos = 0, .size = 0 }
 
+/// Allocator for objects of a single size.  Freed objects are kept on a free
+/// list for reuse, new ones are carved out of arena blocks.  Memory is never
+/// returned to the system, so use this only for small objects that are
+/// frequently allocated and freed, and only on the main thread.
+typedef struct {
+  size_t item_size;
+  void *free_list;
+  Arena arena;
+} Pool;
+
+/// Inits an empty pool for objects of type "type".
+#define POOL_INIT(type) { .item_size = MAX(sizeof(type), sizeof(void *)), \
+                          .free_list = NULL, .arena = ARENA_EMPTY }
+
 #define kv_fixsize_arena(a, v, s) \
   ((v).capacity = (s), \
    (v).items = (void *)arena_alloc(a, sizeof((v).items[0]) * (v).capacity, true))
@@ -124,6 +124,14 @@ bool keep_msg_more = false;    // keep_msg was set by msgmore()
 static const char *msg_ext_kind = NULL;
 static Array msg_ext_chunks = ARRAY_DICT_INIT;
 static garray_T msg_ext_last_chunk = GA_INIT(sizeof(char), 40);
+/// The chunks of "msg_ext_chunks" are allocated from this arena.  The
+/// "msg_ext_chunks" items array itself is reused for the next message.
+static Arena msg_ext_arena = ARENA_EMPTY;
+/// Last message sent with msg_show, kept to skip replacing it with an
+/// identical one.  Its chunks are in "msg_ext_shown_mem".
+static Array msg_ext_shown = ARRAY_DICT_INIT;
+static const char *msg_ext_shown_kind = NULL;
+static ArenaMem msg_ext_shown_mem = NULL;
 static sattr_T msg_ext_last_attr = -1;
 static size_t msg_ext_cur_len = 0;
 
@@ -2072,14 +2080,44 @@ static void msg_ext_emit_chunk(void)
   if (msg_ext_last_attr == -1) {
     return;  // no chunk
   }
-  Array chunk = ARRAY_DICT_INIT;
-  ADD(chunk, INTEGER_OBJ(msg_ext_last_attr));
+  Array chunk = arena_array(&msg_ext_arena, 2);
+  ADD_C(chunk, INTEGER_OBJ(msg_ext_last_attr));
   msg_ext_last_attr = -1;
-  String text = ga_take_string(&msg_ext_last_chunk);
-  ADD(chunk, STRING_OBJ(text));
+  size_t len = (size_t)msg_ext_last_chunk.ga_len;
+  char *text = arena_memdupz(&msg_ext_arena, len ? msg_ext_last_chunk.ga_data : "", len);
+  msg_ext_last_chunk.ga_len = 0;  // keep the buffer for the next chunk
+  ADD_C(chunk, STRING_OBJ(cbuf_as_string(text, len)));
   ADD(msg_ext_chunks, ARRAY_OBJ(chunk));
 }
 
+/// @return  true if "msg_ext_chunks" is the same message as "msg_ext_shown".
+static bool msg_ext_same_as_shown(void)
+{
+  if (msg_ext_shown_mem == NULL || !strequal(msg_ext_kind, msg_ext_shown_kind)
+      || msg_ext_chunks.size != msg_ext_shown.size) {
+    return false;
+  }
+  for (size_t i = 0; i < msg_ext_chunks.size; i++) {
+    Array a = msg_ext_chunks.items[i].data.array;
+    Array b = msg_ext_shown.items[i].data.array;
+    String a_text = a.items[1].data.string;
+    String b_text = b.items[1].data.string;
+    if (a.items[0].data.integer != b.items[0].data.integer
+        || a_text.size != b_text.size || memcmp(a_text.data, b_text.data, a_text.size) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Forget the message kept for msg_ext_same_as_shown().
+static void msg_ext_forget_shown(void)
+{
+  arena_mem_free(msg_ext_shown_mem);
+  msg_ext_shown_mem = NULL;
+  msg_ext_shown.size = 0;
+}
+
 /// The display part of msg_puts_len().
 /// May be called recursively to display scroll-back text.
 static void msg_puts_display(const char *str, int maxlen, int attr, int recurse)
@@ -3044,14 +3082,26 @@ void msg_ext_ui_flush(void)
 
   msg_ext_emit_chunk();
   if (msg_ext_chunks.size > 0) {
-    ui_call_msg_show(cstr_as_string((char *)msg_ext_kind),
-                     msg_ext_chunks, msg_ext_overwrite);
-    if (!msg_ext_overwrite) {
-      msg_ext_visible++;
+    if (msg_ext_overwrite && msg_ext_same_as_shown()) {
+      // Replacing a message with the same one changes nothing, which is
+      // common for progress messages.
+      arena_mem_free(arena_finish(&msg_ext_arena));
+    } else {
+      ui_call_msg_show(cstr_as_string((char *)msg_ext_kind),
+                       msg_ext_chunks, msg_ext_overwrite);
+      if (!msg_ext_overwrite) {
+        msg_ext_visible++;
+      }
+      // Keep this message, the items array of the previous one is reused.
+      msg_ext_forget_shown();
+      msg_ext_shown_mem = arena_finish(&msg_ext_arena);
+      msg_ext_shown_kind = msg_ext_kind;
+      Array shown = msg_ext_shown;
+      msg_ext_shown = msg_ext_chunks;
+      msg_ext_chunks = shown;
     }
     msg_ext_kind = NULL;
-    api_free_array(msg_ext_chunks);
-    msg_ext_chunks = (Array)ARRAY_DICT_INIT;
+    msg_ext_chunks.size = 0;
     msg_ext_cur_len = 0;
     msg_ext_overwrite = false;
   }
@@ -3064,8 +3114,8 @@ void msg_ext_flush_showmode(void)
   if (ui_has(kUIMessages)) {
     msg_ext_emit_chunk();
     ui_call_msg_showmode(msg_ext_chunks);
-    api_free_array(msg_ext_chunks);
-    msg_ext_chunks = (Array)ARRAY_DICT_INIT;
+    arena_mem_free(arena_finish(&msg_ext_arena));
+    msg_ext_chunks.size = 0;
     msg_ext_cur_len = 0;
   }
 }
@@ -3076,6 +3126,7 @@ void msg_ext_clear(bool force)
     ui_call_msg_clear();
     msg_ext_visible = 0;
     msg_ext_overwrite = false;  // nothing to overwrite
+    msg_ext_forget_shown();
   }
   if (msg_ext_history_visible) {
     ui_call_msg_history_clear();
@@ -111,6 +111,11 @@ static void log_client_msg(uint64_t channel_id, bool is_request, const char *nam
 static Set(cstr_t) event_strings = SET_INIT;
 static msgpack_sbuffer out_buffer;
 
+// A subscriber that stopped reading gets no more broadcast events once this
+// many bytes are waiting to be written to it. Other messages are still
+// queued, up to the limit of the stream, where the channel is closed.
+#define BROADCAST_MAXMEM (64 * 1024 * 1024)
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "msgpack_rpc/channel.c.generated.h"
 #endif
@@ -132,6 +137,8 @@ void rpc_start(Channel *channel)
   rpc->next_request_id = 1;
   rpc->info = (Dictionary)ARRAY_DICT_INIT;
   kv_init(rpc->call_stack);
+  kv_init(rpc->pending_out);
+  rpc->pending_flush = false;
 
   if (channel->streamtype != kChannelStreamInternal) {
     Stream *out = channel_outstream(channel);
@@ -177,6 +184,39 @@ bool rpc_send_event(uint64_t id, const char *name, Array args)
   return true;
 }
 
+/// Sends the same event to several channels, serializing it only once.
+///
+/// @param ids The channel ids
+/// @param n_ids Number of channel ids
+/// @param name The event name, an arbitrary string
+/// @param args Array with event arguments
+/// @return 0, or the last channel id in `ids` that doesn't exist
+uint64_t rpc_send_event_multi(const uint64_t *ids, size_t n_ids, const char *name, Array args)
+{
+  kvec_t(Channel *) targets = KV_INITIAL_VALUE;
+  uint64_t badid = 0;
+
+  for (size_t i = 0; i < n_ids; i++) {
+    Channel *channel = find_rpc_channel(ids[i]);
+    if (channel) {
+      kv_push(targets, channel);
+    } else {
+      badid = ids[i];
+    }
+  }
+
+  if (kv_size(targets)) {
+    WBuffer *buffer = serialize_request(0, 0, cstr_as_string((char *)name), args,
+                                        &out_buffer, kv_size(targets));
+    for (size_t i = 0; i < kv_size(targets); i++) {
+      channel_write(kv_A(targets, i), buffer);
+    }
+  }
+
+  kv_destroy(targets);
+  return badid;
+}
+
 /// Sends a method call to a channel
 ///
 /// @param id The channel id
@@ -302,7 +342,9 @@ static void receive_msgpack(Stream *stream, RBuffer *rbuf, size_t c, void *data,
   size_t size = 0;
   p->read_ptr = rbuffer_read_ptr(rbuf, &size);
   p->read_size = size;
+  AllocTag prev_tag = alloc_tag_push(kAllocTagRpc);
   parse_msgpack(channel);
+  alloc_tag_pop(prev_tag);
   size_t consumed = size - p->read_size;
   rbuffer_consumed_compact(rbuf, consumed);
 
@@ -438,18 +480,30 @@ static void request_event(void **argv)
     goto free_ret;
   }
 
+  // When a client pipelines many requests, write the responses together
+  // once the queued requests have been handled, instead of doing a write for
+  // each of them. Fast requests are answered right away, as the queued
+  // requests may have to wait until nvim stops blocking.
+  bool batch = !handler.fast && channel->streamtype != kChannelStreamInternal
+               && !multiqueue_empty(channel->events);
+  if (!batch) {
+    // Before a handler that might not return (e.g. :quit) or block for a
+    // long time, send what was held back.
+    channel_flush_pending(channel);
+  }
+
   Object result = handler.fn(channel->id, e->args, &e->used_mem, &error);
   if (e->type == kMessageTypeRequest || ERROR_SET(&error)) {
     // Send the response.
     msgpack_packer response;
     msgpack_packer_init(&response, &out_buffer, msgpack_sbuffer_write);
-    channel_write(channel, serialize_response(channel->id,
-                                              e->handler,
-                                              e->type,
-                                              e->request_id,
-                                              &error,
-                                              result,
-                                              &out_buffer));
+    WBuffer *buffer = serialize_response(channel->id, e->handler, e->type, e->request_id,
+                                         &error, result, &out_buffer);
+    if (batch && !channel->rpc.closed) {
+      channel_hold_response(channel, buffer);
+    } else {
+      channel_write(channel, buffer);
+    }
   }
   if (!handler.arena_return) {
     api_free_object(result);
@@ -474,7 +528,48 @@ bool rpc_write_raw(uint64_t id, WBuffer *buffer)
   return channel_write(channel, buffer);
 }
 
+/// Keep the response in "buffer" for writing later, together with other
+/// responses. Something written to the channel in the meantime goes after it.
+static void channel_hold_response(Channel *channel, WBuffer *buffer)
+{
+  kv_concat_len(channel->rpc.pending_out, buffer->data, buffer->size);
+  wstream_release_wbuffer(buffer);
+  if (!channel->rpc.pending_flush) {
+    // Also flush when the loop is polled next. This covers the case where
+    // the queued requests are not handled soon, as nvim is blocking.
+    channel->rpc.pending_flush = true;
+    channel_incref(channel);
+    multiqueue_put(main_loop.fast_events, pending_flush_event, 1, channel);
+  }
+}
+
+static void pending_flush_event(void **argv)
+{
+  Channel *channel = argv[0];
+  channel->rpc.pending_flush = false;
+  channel_flush_pending(channel);
+  channel_decref(channel);
+}
+
+/// Write responses held back by channel_hold_response().
+static void channel_flush_pending(Channel *channel)
+{
+  if (kv_size(channel->rpc.pending_out) == 0) {
+    return;
+  }
+  WBuffer *buffer = wstream_new_buffer(channel->rpc.pending_out.items,
+                                       kv_size(channel->rpc.pending_out), 1, xfree);
+  kv_init(channel->rpc.pending_out);
+  channel_write_now(channel, buffer);
+}
+
 static bool channel_write(Channel *channel, WBuffer *buffer)
+{
+  channel_flush_pending(channel);
+  return channel_write_now(channel, buffer);
+}
+
+static bool channel_write_now(Channel *channel, WBuffer *buffer)
 {
   bool success;
 
@@ -514,7 +609,9 @@ static void internal_read_event(void **argv)
 
   p->read_ptr = buffer->data;
   p->read_size = buffer->size;
+  AllocTag prev_tag = alloc_tag_push(kAllocTagRpc);
   parse_msgpack(channel);
+  alloc_tag_pop(prev_tag);
 
   if (p->read_size) {
     // This should not happen, as WBuffer is one single serialized message.
@@ -564,6 +661,17 @@ static void send_event(Channel *channel, const char *name, Array args)
                                            1));
 }
 
+/// Whether the peer of "channel" has not read so much that broadcasts to it
+/// should be dropped, see BROADCAST_MAXMEM.
+static bool channel_write_stalled(Channel *channel)
+{
+  if (channel->streamtype == kChannelStreamInternal) {
+    return false;
+  }
+  size_t queued = channel_instream(channel)->curmem + kv_size(channel->rpc.pending_out);
+  return queued > BROADCAST_MAXMEM;
+}
+
 static void broadcast_event(const char *name, Array args)
 {
   kvec_t(Channel *) subscribed = KV_INITIAL_VALUE;
@@ -572,6 +680,11 @@ static void broadcast_event(const char *name, Array args)
   map_foreach_value(&channels, channel, {
     if (channel->is_rpc
         && set_has(cstr_t, channel->rpc.subscribed_events, name)) {
+      if (channel_write_stalled(channel)) {
+        WLOG("RPC: ch %" PRIu64 ": not reading, dropped broadcast event '%s'",
+             channel->id, name);
+        continue;
+      }
       kv_push(subscribed, channel);
     }
   });
@@ -636,6 +749,7 @@ void rpc_free(Channel *channel)
 
   set_destroy(cstr_t, channel->rpc.subscribed_events);
   kv_destroy(channel->rpc.call_stack);
+  kv_destroy(channel->rpc.pending_out);
   api_free_dictionary(channel->rpc.info);
 }
 
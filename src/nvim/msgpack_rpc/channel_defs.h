@@ -47,4 +47,6 @@ typedef struct {
   kvec_t(ChannelCallFrame *) call_stack;
   Dictionary info;
   ClientType client_type;
+  kvec_t(char) pending_out;  ///< responses held back while more requests are queued
+  bool pending_flush;        ///< an event to write "pending_out" is scheduled
 } RpcState;
@@ -459,6 +459,23 @@ bool unpacker_parse_redraw(Unpacker *p)
     for (; g->icell != g->ncells; g->icell++) {
       assert(g->icell < g->ncells);
 
+      // Fast path for the most common cell: a single byte without highlight
+      // or repeat, i.e. a fixarray of one fixstr of length one.
+      if (size >= 3 && (uint8_t)data[0] == 0x91 && (uint8_t)data[1] == 0xa1) {
+        if (g->coloff >= (int)grid_line_buf_size) {
+          p->state = -1;
+          return false;
+        }
+        g->clear_width = 0;
+        grid_line_buf_char[g->coloff] = schar_from_buf(data + 2, 1);
+        grid_line_buf_attr[g->coloff++] = g->cur_attr;
+        data += 3;
+        size -= 3;
+        p->read_ptr = data;
+        p->read_size = size;
+        continue;
+      }
+
       NEXT_TYPE(tok, MPACK_TOKEN_ARRAY);
       int cellarrsize = (int)tok.length;
       if (cellarrsize < 1 || cellarrsize > 3) {
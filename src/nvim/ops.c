@@ -517,6 +517,15 @@ static void shift_block(oparg_T *oap, int amount)
   p_ri = old_p_ri;
 }
 
+/// Advance "row_byte", the byte offset of a line from extmark_row_byte(), to
+/// the start of the next line.  "len" is the length of the line.
+static void next_row_byte(bcount_t *row_byte, size_t len)
+{
+  if (*row_byte >= 0) {
+    *row_byte += (bcount_t)len + 1;
+  }
+}
+
 /// Insert string "s" (b_insert ? before : after) block :AKelly
 /// Caller must prepare for undo.
 static void block_insert(oparg_T *oap, char *s, int b_insert, struct block_def *bdp)
@@ -530,9 +539,11 @@ static void block_insert(oparg_T *oap, char *s, int b_insert, struct block_def *
   int oldstate = State;
   State = MODE_INSERT;          // don't want MODE_REPLACE for State
 
+  bcount_t row_byte = extmark_row_byte(curbuf, (int)oap->start.lnum);
   for (linenr_T lnum = oap->start.lnum + 1; lnum <= oap->end.lnum; lnum++) {
     block_prep(oap, bdp, lnum, true);
     if (bdp->is_short && b_insert) {
+      next_row_byte(&row_byte, strlen(ml_get(lnum)));
       continue;  // OP_INSERT, line ends before block start
     }
 
@@ -610,9 +621,11 @@ static void block_insert(oparg_T *oap, char *s, int b_insert, struct block_def *
     }
     STRMOVE(newp + offset, oldp);
 
+    size_t newlen = strlen(newp);
     ml_replace(lnum, newp, false);
-    extmark_splice_cols(curbuf, (int)lnum - 1, startcol,
-                        skipped, offset - startcol, kExtmarkUndo);
+    extmark_splice_cols_at(curbuf, (int)lnum - 1, row_byte, startcol,
+                           skipped, offset - startcol, kExtmarkUndo);
+    next_row_byte(&row_byte, newlen);
 
     if (lnum == oap->end.lnum) {
       // Set "']" mark to the end of the block instead of the end of
@@ -646,6 +659,9 @@ void op_reindent(oparg_T *oap, Indenter how)
   if (u_savecommon(curbuf, start_lnum - 1, start_lnum + oap->line_count,
                    start_lnum + oap->line_count, false) == OK) {
     int amount;
+    if (how == get_c_indent) {
+      c_indent_cache_start();
+    }
     for (i = oap->line_count - 1; i >= 0 && !got_int; i--) {
       // it's a slow thing to do, so give feedback so there's no worry
       // that the computer's just hung.
@@ -677,6 +693,7 @@ void op_reindent(oparg_T *oap, Indenter how)
       curwin->w_cursor.lnum++;
       curwin->w_cursor.col = 0;      // make sure it's valid
     }
+    c_indent_cache_end();
   }
 
   // put cursor on first non-blank of indented line
@@ -1123,19 +1140,20 @@ int do_execreg(int regname, int colon, int addcr, int silent)
     // Disallow remapping for ":@r".
     int remap = colon ? REMAP_NONE : REMAP_YES;
 
-    // Insert lines into typeahead buffer, from last one to first one.
+    // Collect the lines from last one to first one, so that line
+    // continuation can be handled, then insert them into the typeahead
+    // buffer with a single call.  Inserting each line separately at the
+    // start of the typeahead buffer takes quadratic time for a large
+    // register.
     put_reedit_in_typebuf(silent);
+    garray_T lines;
+    ga_init(&lines, (int)sizeof(char *), 32);
+    size_t total = 0;
     for (size_t i = reg->y_size; i-- > 0;) {  // from y_size - 1 to 0 included
-      // insert NL between lines and after last line if type is kMTLineWise
-      if (reg->y_type == kMTLineWise || i < reg->y_size - 1 || addcr) {
-        if (ins_typebuf("\n", remap, 0, true, silent) == FAIL) {
-          return FAIL;
-        }
-      }
-
       // Handle line-continuation for :@<register>
       char *str = reg->y_array[i];
       bool free_str = false;
+      const bool add_nl = reg->y_type == kMTLineWise || i < reg->y_size - 1 || addcr;
       if (colon && i > 0) {
         char *p = skipwhite(str);
         if (*p == '\\' || (p[0] == '"' && p[1] == '\\' && p[2] == ' ')) {
@@ -1147,15 +1165,27 @@ int do_execreg(int regname, int colon, int addcr, int silent)
       if (free_str) {
         xfree(str);
       }
-      retval = ins_typebuf(escaped, remap, 0, true, silent);
+      // insert NL between lines and after last line if type is kMTLineWise
+      char *line = xmalloc(strlen(escaped) + 3);
+      snprintf(line, strlen(escaped) + 3, "%s%s%s", colon ? ":" : "", escaped, add_nl ? "\n" : "");
       xfree(escaped);
-      if (retval == FAIL) {
-        return FAIL;
-      }
-      if (colon
-          && ins_typebuf(":", remap, 0, true, silent) == FAIL) {
-        return FAIL;
-      }
+      total += strlen(line);
+      GA_APPEND(char *, &lines, line);
+    }
+
+    char *all = xmallocz(total);
+    char *d = all;
+    for (int i = lines.ga_len; i-- > 0;) {
+      char *line = ((char **)lines.ga_data)[i];
+      size_t len = strlen(line);
+      memcpy(d, line, len);
+      d += len;
+    }
+    ga_clear_strings(&lines);
+    retval = ins_typebuf(all, remap, 0, true, silent);
+    xfree(all);
+    if (retval == FAIL) {
+      return FAIL;
     }
     reg_executing = regname == 0 ? '"' : regname;  // disable the 'q' command
   }
@@ -1542,9 +1572,11 @@ int op_delete(oparg_T *oap)
       return FAIL;
     }
 
+    bcount_t row_byte = extmark_row_byte(curbuf, (int)curwin->w_cursor.lnum - 1);
     for (lnum = curwin->w_cursor.lnum; lnum <= oap->end.lnum; lnum++) {
       block_prep(oap, &bd, lnum, true);
       if (bd.textlen == 0) {            // nothing to delete
+        next_row_byte(&row_byte, strlen(ml_get(lnum)));
         continue;
       }
 
@@ -1568,12 +1600,14 @@ int op_delete(oparg_T *oap)
       // copy the part after the deleted part
       oldp += bd.textcol + bd.textlen;
       STRMOVE(newp + bd.textcol + bd.startspaces + bd.endspaces, oldp);
+      size_t newlen = strlen(newp);
       // replace the line
       ml_replace(lnum, newp, false);
 
-      extmark_splice_cols(curbuf, (int)lnum - 1, bd.textcol,
-                          bd.textlen, bd.startspaces + bd.endspaces,
-                          kExtmarkUndo);
+      extmark_splice_cols_at(curbuf, (int)lnum - 1, row_byte, bd.textcol,
+                             bd.textlen, bd.startspaces + bd.endspaces,
+                             kExtmarkUndo);
+      next_row_byte(&row_byte, newlen);
     }
 
     check_cursor_col();
@@ -2478,6 +2512,7 @@ int op_change(oparg_T *oap)
       // copy of the inserted text.
       char *ins_text = xmalloc((size_t)ins_len + 1);
       xstrlcpy(ins_text, firstline + bd.textcol, (size_t)ins_len + 1);
+      bcount_t row_byte = extmark_row_byte(curbuf, (int)oap->start.lnum);
       for (linenr_T linenr = oap->start.lnum + 1; linenr <= oap->end.lnum;
            linenr++) {
         block_prep(oap, &bd, linenr, true);
@@ -2504,9 +2539,13 @@ int op_change(oparg_T *oap)
           offset += ins_len;
           oldp += bd.textcol;
           STRMOVE(newp + offset, oldp);
+          size_t newlen = strlen(newp);
           ml_replace(linenr, newp, false);
-          extmark_splice_cols(curbuf, (int)linenr - 1, bd.textcol,
-                              0, vpos.coladd + ins_len, kExtmarkUndo);
+          extmark_splice_cols_at(curbuf, (int)linenr - 1, row_byte, bd.textcol,
+                                 0, vpos.coladd + ins_len, kExtmarkUndo);
+          next_row_byte(&row_byte, newlen);
+        } else {
+          next_row_byte(&row_byte, strlen(ml_get(linenr)));
         }
       }
       check_cursor();
@@ -3505,6 +3544,22 @@ void do_put(int regname, yankreg_T *reg, int dir, int count, int flags)
           i = 1;
         }
 
+        if (!(flags & PUT_FIXINDENT) && i < y_size && curbuf->b_ml.ml_mfp != NULL) {
+          // Nothing needs to look at the lines one by one: append them all
+          // at once.  With kMTCharWise the last line was already inserted.
+          int n = (int)(y_size - i) - (y_type == kMTCharWise);
+          int appended = n > 0 ? ml_append_buf_lines(curbuf, lnum, y_array + i, n, false) : 0;
+          new_lnum += appended;
+          if (appended < n) {
+            lnum += appended;
+            nr_lines += appended;
+            goto error;
+          }
+          lnum += (linenr_T)(y_size - i);
+          nr_lines += (linenr_T)(y_size - i);
+          i = y_size;
+        }
+
         for (; i < y_size; i++) {
           if ((y_type != kMTCharWise || i < y_size - 1)) {
             if (ml_append(lnum, y_array[i], 0, false) == FAIL) {
@@ -3982,6 +4037,9 @@ int do_join(size_t count, int insert_space, int save_undo, int use_formatoptions
   if (remove_comments) {
     comments = xcalloc(count, sizeof(*comments));
   }
+  // The joined lines all end up in the cursor line, its start doesn't move.
+  const bcount_t row_byte = curbuf_splice_pending == 0
+                            ? extmark_row_byte(curbuf, (int)curwin->w_cursor.lnum - 1) : 0;
 
   // Don't move anything yet, just compute the final line length
   // and setup the array of space strings lengths
@@ -4033,10 +4091,10 @@ int do_join(size_t count, int insert_space, int save_undo, int use_formatoptions
 
     if (t > 0 && curbuf_splice_pending == 0) {
       colnr_T removed = (int)(curr - curr_start);
-      extmark_splice(curbuf, (int)curwin->w_cursor.lnum - 1, sumsize,
-                     1, removed, removed + 1,
-                     0, spaces[t], spaces[t],
-                     kExtmarkUndo);
+      extmark_splice_impl(curbuf, (int)curwin->w_cursor.lnum - 1, sumsize, row_byte + sumsize,
+                          1, removed, removed + 1,
+                          0, spaces[t], spaces[t],
+                          kExtmarkUndo);
     }
     currsize = (int)strlen(curr);
     sumsize += currsize + spaces[t];
@@ -4074,6 +4132,8 @@ int do_join(size_t count, int insert_space, int save_undo, int use_formatoptions
 
   curbuf_splice_pending++;
 
+  colnr_T *col_amounts = xmalloc(count * sizeof(*col_amounts));
+  int *spaces_removed = xmalloc(count * sizeof(*spaces_removed));
   for (linenr_T t = (linenr_T)count - 1;; t--) {
     cend -= currsize;
     memmove(cend, curr, (size_t)currsize);
@@ -4084,13 +4144,8 @@ int do_join(size_t count, int insert_space, int save_undo, int use_formatoptions
 
     // If deleting more spaces than adding, the cursor moves no more than
     // what is added if it is inside these spaces.
-    const int spaces_removed = (int)((curr - curr_start) - spaces[t]);
-    linenr_T lnum = curwin->w_cursor.lnum + t;
-    colnr_T mincol = 0;
-    linenr_T lnum_amount = -t;
-    colnr_T col_amount = (colnr_T)(cend - newp - spaces_removed);
-
-    mark_col_adjust(lnum, mincol, lnum_amount, col_amount, spaces_removed);
+    spaces_removed[t] = (int)((curr - curr_start) - spaces[t]);
+    col_amounts[t] = (colnr_T)(cend - newp - spaces_removed[t]);
 
     if (t == 0) {
       break;
@@ -4106,6 +4161,9 @@ int do_join(size_t count, int insert_space, int save_undo, int use_formatoptions
     }
     currsize = (int)strlen(curr);
   }
+  mark_join_adjust(curwin->w_cursor.lnum, (linenr_T)count, col_amounts, spaces_removed);
+  xfree(col_amounts);
+  xfree(spaces_removed);
 
   ml_replace(curwin->w_cursor.lnum, newp, false);
 
@@ -62,6 +62,7 @@
 #include "nvim/log.h"
 #include "nvim/lua/executor.h"
 #include "nvim/macros.h"
+#include "nvim/map.h"
 #include "nvim/mapping.h"
 #include "nvim/mbyte.h"
 #include "nvim/memfile.h"
@@ -132,6 +133,9 @@ static OptInt p_tw_nopaste;
 static OptInt p_wm_nopaste;
 static char *p_vsts_nopaste;
 
+/// Option name (full and short) to option index plus one, see findoption_len().
+static Map(String, int) option_name_idx = MAP_INIT;
+
 #define OPTION_COUNT ARRAY_SIZE(options)
 
 /// :set boolean option prefix
@@ -583,6 +587,7 @@ void free_all_options(void)
   }
   free_operatorfunc_option();
   free_tagfunc_option();
+  map_destroy(String, &option_name_idx);
 }
 #endif
 
@@ -3048,23 +3053,18 @@ void check_redraw(uint32_t flags)
 /// @return Index of the option or -1 if option was not found.
 int findoption_len(const char *const arg, const size_t len)
 {
-  const char *s;
-  static int quick_tab[27] = { 0, 0 };  // quick access table
-
-  // For first call: Initialize the quick-access table.
-  // It contains the index for the first option that starts with a certain
-  // letter.  There are 26 letters, plus the first "t_" option.
-  if (quick_tab[1] == 0) {
-    const char *p = options[0].fullname;
-    for (uint16_t i = 1; (s = options[i].fullname) != NULL; i++) {
-      if (s[0] != p[0]) {
-        if (s[0] == 't' && s[1] == '_') {
-          quick_tab[26] = i;
-        } else {
-          quick_tab[CHAR_ORD_LOW(s[0])] = i;
-        }
+  // For first call: Initialize the name table.  It maps both the full name
+  // and the short name of each option to its index plus one, so that a
+  // missing entry (zero) means "not an option".  Full names take precedence.
+  if (map_size(&option_name_idx) == 0) {
+    for (int i = 0; options[i].fullname != NULL; i++) {
+      map_put(String, int)(&option_name_idx, cstr_as_string(options[i].fullname), i + 1);
+    }
+    for (int i = 0; options[i].fullname != NULL; i++) {
+      char *const sn = options[i].shortname;
+      if (sn != NULL && !map_has(String, &option_name_idx, cstr_as_string(sn))) {
+        map_put(String, int)(&option_name_idx, cstr_as_string(sn), i + 1);
       }
-      p = s;
     }
   }
 
@@ -3073,33 +3073,9 @@ int findoption_len(const char *const arg, const size_t len)
     return -1;
   }
 
-  int opt_idx;
-  const bool is_term_opt = (len > 2 && arg[0] == 't' && arg[1] == '_');
-  if (is_term_opt) {
-    opt_idx = quick_tab[26];
-  } else {
-    opt_idx = quick_tab[CHAR_ORD_LOW(arg[0])];
-  }
-  // Match full name
-  for (; (s = options[opt_idx].fullname) != NULL; opt_idx++) {
-    if (strncmp(arg, s, len) == 0 && s[len] == NUL) {
-      break;
-    }
-  }
-  if (s == NULL && !is_term_opt) {
-    opt_idx = quick_tab[CHAR_ORD_LOW(arg[0])];
-    // Match short name
-    for (; options[opt_idx].fullname != NULL; opt_idx++) {
-      s = options[opt_idx].shortname;
-      if (s != NULL && strncmp(arg, s, len) == 0 && s[len] == NUL) {
-        break;
-      }
-      s = NULL;
-    }
-  }
-  if (s == NULL) {
-    opt_idx = -1;
-  } else {
+  int opt_idx = map_get(String, int)(&option_name_idx,
+                                     ((String){ .data = (char *)arg, .size = len })) - 1;
+  if (opt_idx >= 0) {
     // Nvim: handle option aliases.
     if (strncmp(options[opt_idx].fullname, "viminfo", 7) == 0) {
       if (strlen(options[opt_idx].fullname) == 7) {
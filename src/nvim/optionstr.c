@@ -11,6 +11,7 @@
 #include "nvim/cmdexpand_defs.h"
 #include "nvim/cursor.h"
 #include "nvim/cursor_shape.h"
+#include "nvim/decoration.h"
 #include "nvim/diff.h"
 #include "nvim/digraph.h"
 #include "nvim/drawscreen.h"
@@ -73,7 +74,7 @@ static char *(p_briopt_values[]) = { "shift:", "min:", "sbr", "list:", "column:"
 static char *(p_dip_values[]) = { "filler", "context:", "iblank", "icase",
                                   "iwhite", "iwhiteall", "iwhiteeol", "horizontal", "vertical",
                                   "closeoff", "hiddenoff", "foldcolumn:", "followwrap", "internal",
-                                  "indent-heuristic", "linematch:", "algorithm:", NULL };
+                                  "indent-heuristic", "linematch:", "algorithm:", "async", NULL };
 static char *(p_dip_algorithm_values[]) = { "myers", "minimal", "patience", "histogram", NULL };
 static char *(p_nf_values[]) = { "bin", "octal", "hex", "alpha", "unsigned", NULL };
 static char *(p_ff_values[]) = { FF_UNIX, FF_DOS, FF_MAC, NULL };
@@ -644,7 +645,11 @@ const char *did_set_ambiwidth(optset_T *args FUNC_ATTR_UNUSED)
   if (check_opt_strings(p_ambw, p_ambw_values, false) != OK) {
     return e_invarg;
   }
-  return check_chars_options();
+  const char *errmsg = check_chars_options();
+  if (errmsg == NULL) {
+    decor_update_virt_text_width();
+  }
+  return errmsg;
 }
 
 int expand_set_ambiwidth(optexpand_T *args, int *numMatches, char ***matches)
@@ -2138,6 +2143,7 @@ const char *did_set_spelloptions(optset_T *args)
                         true) != OK) {
     return e_invarg;
   }
+  spell_cache_invalidate();
   return NULL;
 }
 
@@ -1119,6 +1119,17 @@ const char *os_scandir_next(Directory *dir)
   return err != UV_EOF ? dir->ent.name : NULL;
 }
 
+/// Check whether the entry last returned by `os_scandir_next()` may be a
+/// directory, using the type read with the directory, without a stat() call.
+/// @param dir  The Directory object.
+/// @returns false if the entry is known not to be a directory.
+bool os_scandir_may_be_dir(const Directory *dir)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_PURE
+{
+  return dir->ent.type == UV_DIRENT_DIR || dir->ent.type == UV_DIRENT_LINK
+         || dir->ent.type == UV_DIRENT_UNKNOWN;
+}
+
 /// Frees memory associated with `os_scandir()`.
 /// @param dir  The directory.
 void os_closedir(Directory *dir)
@@ -44,6 +44,8 @@ static bool input_eof = false;
 static bool blocking = false;
 static int cursorhold_time = 0;  ///< time waiting for CursorHold event
 static int cursorhold_tb_change_cnt = 0;  ///< tb_change_cnt when waiting started
+/// When the oldest unread input was added to "input_buffer", zero when empty.
+static uint64_t input_enqueued_time = 0;
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "os/input.c.generated.h"
@@ -111,7 +113,7 @@ int os_inchar(uint8_t *buf, int maxlen, int ms, int tb_change_cnt, MultiQueue *e
 
   if (maxlen && rbuffer_size(input_buffer)) {
     restart_cursorhold_wait(tb_change_cnt);
-    return (int)rbuffer_read(input_buffer, (char *)buf, (size_t)maxlen);
+    return input_read(buf, maxlen);
   }
 
   // No risk of a UI flood, so disable CTRL-C "interrupt" behavior if it's mapped.
@@ -153,9 +155,7 @@ int os_inchar(uint8_t *buf, int maxlen, int ms, int tb_change_cnt, MultiQueue *e
 
   if (maxlen && rbuffer_size(input_buffer)) {
     restart_cursorhold_wait(tb_change_cnt);
-    // Safe to convert rbuffer_read to int, it will never overflow since we use
-    // relatively small buffers.
-    return (int)rbuffer_read(input_buffer, (char *)buf, (size_t)maxlen);
+    return input_read(buf, maxlen);
   }
 
   // If there are events, return the keys directly
@@ -170,6 +170,32 @@ int os_inchar(uint8_t *buf, int maxlen, int ms, int tb_change_cnt, MultiQueue *e
   return 0;
 }
 
+/// Reads from "input_buffer" and records how long the input has waited there
+/// in g_stats.
+static int input_read(uint8_t *buf, int maxlen)
+{
+  // Safe to convert rbuffer_read to int, it will never overflow since we use
+  // relatively small buffers.
+  int len = (int)rbuffer_read(input_buffer, (char *)buf, (size_t)maxlen);
+  if (input_enqueued_time != 0) {
+    stats_hist_add(&g_stats.input_latency, os_hrtime() - input_enqueued_time);
+  }
+  // Remaining input is counted from the same time, it was added at the same
+  // time or later.
+  input_enqueued_time = rbuffer_size(input_buffer) ? input_enqueued_time : 0;
+  return len;
+}
+
+/// Remembers when input was added to an empty "input_buffer".
+static void input_note_enqueued(void)
+{
+  if (rbuffer_size(input_buffer) == 0) {
+    input_enqueued_time = 0;
+  } else if (input_enqueued_time == 0) {
+    input_enqueued_time = os_hrtime();
+  }
+}
+
 // Check if a character is available for reading
 bool os_char_avail(void)
 {
@@ -228,6 +254,22 @@ void veryfast_breakcheck(void)
   }
 }
 
+#define BREAKCHECK_INTERVAL_NS (10 * 1000000)
+
+/// Like os_breakcheck() but at most once every 10 msec.
+///
+/// For loops where a single iteration may be very cheap or take a long time,
+/// so that counting iterations like line_breakcheck() does is not suitable.
+void timed_breakcheck(void)
+{
+  static uint64_t last_check = 0;
+  uint64_t now = os_hrtime();
+  if (now - last_check >= BREAKCHECK_INTERVAL_NS) {
+    last_check = now;
+    os_breakcheck();
+  }
+}
+
 /// Test whether a file descriptor refers to a terminal.
 ///
 /// @param fd File descriptor.
@@ -287,6 +329,7 @@ size_t input_enqueue(String keys)
 
   size_t rv = (size_t)(ptr - keys.data);
   process_ctrl_c();
+  input_note_enqueued();
   return rv;
 }
 
@@ -425,6 +468,7 @@ size_t input_enqueue_mouse(int code, uint8_t modifier, int grid, int row, int co
 
   size_t written = 3 + (size_t)(p - buf);
   rbuffer_write(input_buffer, (char *)buf, written);
+  input_note_enqueued();
   return written;
 }
 
@@ -482,6 +526,7 @@ static void input_read_cb(Stream *stream, RBuffer *buf, size_t c, void *data, bo
     (void)rbuffer_write(input_buffer, ptr, len);
     rbuffer_consumed(buf, len);
   }
+  input_note_enqueued();
 }
 
 static void process_ctrl_c(void)
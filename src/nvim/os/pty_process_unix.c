@@ -8,6 +8,7 @@
 #include <string.h>
 #include <sys/ioctl.h>
 #include <sys/wait.h>
+#include <unistd.h>
 #include <uv.h>
 
 // forkpty is not in POSIX, so headers are platform-specific
@@ -29,6 +30,11 @@
 # include <crt_externs.h>
 #endif
 
+#ifdef __linux__
+# include <pthread.h>
+# define PTY_USE_VFORK
+#endif
+
 #include "auto/config.h"
 #include "klib/klist.h"
 #include "nvim/eval/typval.h"
@@ -172,16 +178,56 @@ int pty_process_spawn(PtyProcess *ptyproc)
   uv_signal_start(&proc->loop->children_watcher, chld_handler, SIGCHLD);
   ptyproc->winsize = (struct winsize){ ptyproc->height, ptyproc->width, 0, 0 };
   uv_disable_stdio_inheritance();
+
+  // Prepare everything the child needs before forking: other threads may
+  // hold the malloc or log locks, and with vfork() the child shares our memory.
+  const char *prog = process_get_exepath(proc);
+  assert(proc->env);
+  char **env = tv_dict_to_env(proc->env);
+
   int master;
+#ifdef PTY_USE_VFORK
+  // vfork() doesn't copy the page tables, which is what makes spawning slow
+  // for a large Nvim process. Block signals so that none of our handlers run
+  // in the child before init_child() reset them.
+  int slave;
+  if (openpty(&master, &slave, NULL, &termios_default, &ptyproc->winsize) == -1) {
+    status = -errno;
+    ELOG("openpty failed: %s", strerror(errno));
+    os_free_fullenv(env);
+    return status;
+  }
+  sigset_t all_signals, old_mask;
+  sigfillset(&all_signals);
+  pthread_sigmask(SIG_SETMASK, &all_signals, &old_mask);
+  int pid = vfork();
+  if (pid == 0) {
+    close(master);
+    init_child(ptyproc, slave, prog, env, &old_mask);  // never returns
+  }
+  int saved_errno = errno;
+  pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+  close(slave);
+  os_free_fullenv(env);
+  if (pid < 0) {
+    close(master);
+    status = -saved_errno;
+    ELOG("vfork failed: %s", strerror(saved_errno));
+    return status;
+  }
+#else
   int pid = forkpty(&master, NULL, &termios_default, &ptyproc->winsize);
 
   if (pid < 0) {
     status = -errno;
     ELOG("forkpty failed: %s", strerror(errno));
+    os_free_fullenv(env);
     return status;
   } else if (pid == 0) {
-    init_child(ptyproc);  // never returns
+    init_child(ptyproc, -1, prog, env, NULL);  // never returns
   }
+  os_free_fullenv(env);
+#endif
 
   // make sure the master file descriptor is non blocking
   int master_status_flags = fcntl(master, F_GETFL);
@@ -258,16 +304,41 @@ void pty_process_teardown(Loop *loop)
   uv_signal_stop(&loop->children_watcher);
 }
 
-static void init_child(PtyProcess *ptyproc)
-  FUNC_ATTR_NONNULL_ALL
+/// Sets up the child after fork() or vfork() and executes the program.
+/// Only async-signal-safe functions may be used here.
+///
+/// @param slave  pty slave to make the controlling terminal, or -1 if
+///               forkpty() already did that.
+/// @param mask   signal mask to restore, or NULL.
+static void init_child(PtyProcess *ptyproc, int slave, const char *prog, char **env,
+                       const sigset_t *mask)
+  FUNC_ATTR_NONNULL_ARG(1, 3, 4)
 {
-#if defined(HAVE__NSGETENVIRON)
-# define environ (*_NSGetEnviron())
-#else
-  extern char **environ;
-#endif
+  if (mask) {
+    // Reset all handlers before unblocking signals, they would run in our
+    // (shared) memory.
+    struct sigaction sa = { .sa_handler = SIG_DFL };
+    sigemptyset(&sa.sa_mask);
+    for (int sig = 1; sig < NSIG; sig++) {
+      struct sigaction old;
+      if (sigaction(sig, NULL, &old) == 0 && old.sa_handler != SIG_IGN
+          && old.sa_handler != SIG_DFL) {
+        sigaction(sig, &sa, NULL);
+      }
+    }
+  }
+
   // New session/process-group. #6530
   setsid();
+  if (slave >= 0) {
+    ioctl(slave, TIOCSCTTY, 0);
+    dup2(slave, STDIN_FILENO);
+    dup2(slave, STDOUT_FILENO);
+    dup2(slave, STDERR_FILENO);
+    if (slave > STDERR_FILENO) {
+      close(slave);
+    }
+  }
 
   signal(SIGCHLD, SIG_DFL);
   signal(SIGHUP, SIG_DFL);
@@ -275,19 +346,26 @@ static void init_child(PtyProcess *ptyproc)
   signal(SIGQUIT, SIG_DFL);
   signal(SIGTERM, SIG_DFL);
   signal(SIGALRM, SIG_DFL);
+  if (mask) {
+    pthread_sigmask(SIG_SETMASK, mask, NULL);
+  }
 
   Process *proc = (Process *)ptyproc;
-  if (proc->cwd && os_chdir(proc->cwd) != 0) {
-    ELOG("chdir(%s) failed: %s", proc->cwd, strerror(errno));
-    return;
+  if (proc->cwd && chdir(proc->cwd) != 0) {
+    _exit(122);
   }
 
-  const char *prog = process_get_exepath(proc);
-
-  assert(proc->env);
-  environ = tv_dict_to_env(proc->env);
+#ifdef PTY_USE_VFORK
+  execvpe(prog, proc->argv, env);
+#else
+# if defined(HAVE__NSGETENVIRON)
+#  define environ (*_NSGetEnviron())
+# else
+  extern char **environ;
+# endif
+  environ = env;
   execvp(prog, proc->argv);
-  ELOG("execvp(%s) failed: %s", prog, strerror(errno));
+#endif
 
   _exit(122);  // 122 is EXEC_FAILED in the Vim source.
 }
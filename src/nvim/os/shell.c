@@ -10,6 +10,7 @@
 #include "nvim/ascii.h"
 #include "nvim/charset.h"
 #include "nvim/eval.h"
+#include "nvim/eval/encode.h"
 #include "nvim/eval/typval_defs.h"
 #include "nvim/event/libuv_process.h"
 #include "nvim/event/loop.h"
@@ -696,7 +697,7 @@ int os_call_shell(char *cmd, ShellOpts opts, char *extra_args)
 
   size_t nread;
   int exitcode = do_os_system(shell_build_argv(cmd, extra_args),
-                              input.data, input.len, output_ptr, &nread,
+                              input.data, input.len, output_ptr, NULL, &nread,
                               emsg_silent, forward_output);
   xfree(input.data);
 
@@ -851,11 +852,25 @@ done:
 int os_system(char **argv, const char *input, size_t len, char **output,
               size_t *nread) FUNC_ATTR_NONNULL_ARG(1)
 {
-  return do_os_system(argv, input, len, output, nread, true, false);
+  return do_os_system(argv, input, len, output, NULL, nread, true, false);
 }
 
-static int do_os_system(char **argv, const char *input, size_t len, char **output, size_t *nread,
-                        bool silent, bool forward_output)
+/// Like os_system(), but splits the output into lines appended to `list`
+/// while it is read, like |systemlist()|. Avoids keeping the whole output in
+/// memory as a single buffer before splitting it.
+///
+/// @param[out] list List to append output lines to. NUL bytes become NL. The
+///                  last item has the text after the last NL (NULL if the
+///                  output ends with NL).
+/// @param[out] nread the number of bytes read
+int os_system_list(char **argv, const char *input, size_t len, list_T *list, size_t *nread)
+  FUNC_ATTR_NONNULL_ARG(1, 4)
+{
+  return do_os_system(argv, input, len, NULL, list, nread, true, false);
+}
+
+static int do_os_system(char **argv, const char *input, size_t len, char **output,
+                        list_T *list_output, size_t *nread, bool silent, bool forward_output)
 {
   out_data_decide_throttle(0);  // Initialize throttle decider.
   out_data_ring(NULL, 0);       // Initialize output ring-buffer.
@@ -868,8 +883,12 @@ static int do_os_system(char **argv, const char *input, size_t len, char **outpu
     *nread = 0;
   }
 
+  void *data = &buf;
   if (forward_output) {
     data_cb = out_data_cb;
+  } else if (list_output) {
+    data_cb = system_list_data_cb;
+    data = list_output;
   } else if (!output) {
     data_cb = NULL;
   }
@@ -906,9 +925,9 @@ static int do_os_system(char **argv, const char *input, size_t len, char **outpu
     wstream_init(&proc->in, 0);
   }
   rstream_init(&proc->out, 0);
-  rstream_start(&proc->out, data_cb, &buf);
+  rstream_start(&proc->out, data_cb, data);
   rstream_init(&proc->err, 0);
-  rstream_start(&proc->err, data_cb, &buf);
+  rstream_start(&proc->err, data_cb, data);
 
   // write the input, if any
   if (has_input) {
@@ -963,6 +982,8 @@ static int do_os_system(char **argv, const char *input, size_t len, char **outpu
     if (nread) {
       *nread = buf.len;
     }
+  } else if (list_output && nread) {
+    *nread = proc->out.num_bytes + proc->err.num_bytes;
   }
 
   assert(multiqueue_empty(events));
@@ -996,6 +1017,16 @@ static void system_data_cb(Stream *stream, RBuffer *buf, size_t count, void *dat
   dbuf->len += nread;
 }
 
+static void system_list_data_cb(Stream *stream, RBuffer *buf, size_t count, void *data, bool eof)
+{
+  list_T *list = data;
+
+  RBUFFER_UNTIL_EMPTY(buf, ptr, len) {
+    encode_list_write(list, ptr, len);
+    rbuffer_consumed(buf, len);
+  }
+}
+
 /// Tracks output received for the current executing shell command, and displays
 /// a pulsing "..." when output should be skipped. Tracking depends on the
 /// synchronous/blocking nature of ":!".
@@ -1127,6 +1158,9 @@ static void out_data_append_to_screen(char *output, size_t *count, bool eof)
       msg_putchar_attr((uint8_t)(*p), 0);
       p++;
     } else {
+      // Output the characters up to the next special one at once, going
+      // through the message code for every single character is slow.
+      //
       // Note: this is not 100% precise:
       // 1. we don't check if received continuation bytes are already invalid
       //    and we thus do some buffering that could be avoided
@@ -1134,14 +1168,24 @@ static void out_data_append_to_screen(char *output, size_t *count, bool eof)
       //    incomplete UTF-8 sequence that could be composing with the last
       //    complete sequence.
       // This will be corrected when we switch to vterm based implementation
-      int i = *p ? utfc_ptr2len_len(p, (int)(end - p)) : 1;
-      if (!eof && i == 1 && utf8len_tab_zero[*(uint8_t *)p] > (end - p)) {
+      char *run = p;
+      bool incomplete = false;
+      while (p < end && *p != '\n' && *p != '\r' && *p != TAB && *p != BELL) {
+        int i = *p ? utfc_ptr2len_len(p, (int)(end - p)) : 1;
+        if (!eof && i == 1 && utf8len_tab_zero[*(uint8_t *)p] > (end - p)) {
+          incomplete = true;
+          break;
+        }
+        p += i;
+      }
+
+      if (p > run) {
+        (void)msg_outtrans_len(run, (int)(p - run), 0);
+      }
+      if (incomplete) {
         *count = (size_t)(p - output);
         goto end;
       }
-
-      (void)msg_outtrans_len(p, i, 0);
-      p += i;
     }
   }
 
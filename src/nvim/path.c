@@ -19,6 +19,7 @@
 #include "nvim/gettext.h"
 #include "nvim/globals.h"
 #include "nvim/macros.h"
+#include "nvim/map.h"
 #include "nvim/mbyte.h"
 #include "nvim/memory.h"
 #include "nvim/message.h"
@@ -43,6 +44,13 @@ enum {
 # undef gen_expand_wildcards
 #endif
 
+/// Files found by find_file_name_in_path() between
+/// find_file_name_cache_start() and find_file_name_cache_end().  Maps the
+/// options, the directory searched relative to and the name to the found file
+/// name, NULL when not found.
+static PMap(cstr_t) find_file_name_cache = MAP_INIT;
+static int find_file_name_cache_active = 0;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "path.c.generated.h"
 #endif
@@ -739,7 +747,12 @@ static size_t do_path_expand(garray_T *gap, const char *path, size_t wildoff, in
         STRCPY(s, name);
         len = strlen(buf);
 
-        if (starstar && stardepth < 100) {
+        // "." and ".." don't come from os_scandir_next().  Entries that
+        // are not a directory can be skipped for "**", avoids trying to read
+        // every file in the tree as a directory.
+        if (starstar && stardepth < 100
+            && (strcmp(name, ".") == 0 || strcmp(name, "..") == 0
+                || os_scandir_may_be_dir(&dir))) {
           // For "**" in the pattern first go deeper in the tree to
           // find matches.
           STRCPY(buf + len, "/**");  // NOLINT
@@ -1666,13 +1679,38 @@ static char *eval_includeexpr(const char *const ptr, const size_t len)
   current_sctx = curbuf->b_p_script_ctx[BV_INEX].script_ctx;
 
   char *res = eval_to_string_safe(curbuf->b_p_inex,
-                                  was_set_insecurely(curwin, "includeexpr", OPT_LOCAL));
+                                  was_set_insecurely(curwin, "includeexpr", OPT_LOCAL), true);
 
   set_vim_var_string(VV_FNAME, NULL, 0);
   current_sctx = save_sctx;
   return res;
 }
 
+/// Start remembering the files found by find_file_name_in_path(), for an
+/// operation that looks up the same names many times, such as searching
+/// included files.  The file system is assumed not to change until
+/// find_file_name_cache_end() is called.
+void find_file_name_cache_start(void)
+{
+  find_file_name_cache_active++;
+}
+
+/// Forget the files remembered since find_file_name_cache_start().
+void find_file_name_cache_end(void)
+{
+  if (--find_file_name_cache_active > 0) {
+    return;
+  }
+  const char *key;
+  char *file_name;
+  map_foreach(&find_file_name_cache, key, file_name, {
+    xfree((char *)key);
+    xfree(file_name);
+  });
+  map_destroy(cstr_t, &find_file_name_cache);
+  find_file_name_cache = (PMap(cstr_t)) MAP_INIT;
+}
+
 /// Return the name of the file ptr[len] in 'path'.
 /// Otherwise like file_name_at_cursor().
 ///
@@ -1694,6 +1732,29 @@ char *find_file_name_in_path(char *ptr, size_t len, int options, long count, cha
     }
   }
 
+  char *cache_key = NULL;
+  if ((options & FNAME_EXP) && count == 1 && find_file_name_cache_active > 0) {
+    // The search depends on the directory of "rel_fname", for "." in
+    // 'path', and on the options.
+    const int dir_len = rel_fname == NULL ? 0 : (int)(path_tail(rel_fname) - rel_fname);
+    const size_t key_len = (size_t)dir_len + len + NUMBUFLEN + 3;
+    cache_key = xmalloc(key_len);
+    snprintf(cache_key, key_len, "%d\n%.*s\n%.*s", options,
+             dir_len, rel_fname == NULL ? "" : rel_fname, (int)len, ptr);
+    if (map_has(cstr_t, &find_file_name_cache, cache_key)) {
+      file_name = pmap_get(cstr_t)(&find_file_name_cache, cache_key);
+      xfree(cache_key);
+      if (file_name == NULL && (options & FNAME_MESS)) {
+        char c = ptr[len];
+        ptr[len] = NUL;
+        semsg(_("E447: Can't find file \"%s\" in path"), ptr);
+        ptr[len] = c;
+      }
+      xfree(tofree);
+      return file_name == NULL ? NULL : xstrdup(file_name);
+    }
+  }
+
   if (options & FNAME_EXP) {
     char *file_to_find = NULL;
     char *search_ctx = NULL;
@@ -1730,6 +1791,11 @@ char *find_file_name_in_path(char *ptr, size_t len, int options, long count, cha
 
     xfree(file_to_find);
     vim_findfile_cleanup(search_ctx);
+
+    if (cache_key != NULL) {
+      pmap_put(cstr_t)(&find_file_name_cache, cache_key,
+                       file_name == NULL ? NULL : xstrdup(file_name));
+    }
   } else {
     file_name = xstrnsave(ptr, len);
   }
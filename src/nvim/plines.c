@@ -5,7 +5,9 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "klib/kvec.h"
 #include "nvim/ascii.h"
+#include "nvim/buffer.h"
 #include "nvim/charset.h"
 #include "nvim/decoration.h"
 #include "nvim/diff.h"
@@ -25,10 +27,70 @@
 #include "nvim/types.h"
 #include "nvim/vim.h"
 
+/// Everything the height of a line depends on, except for its text.
+typedef struct {
+  int fnum;                  ///< buffer number
+  int epoch;                 ///< see plines_cache_invalidate_all()
+  int width;                 ///< text width of the first screen line
+  int width2;                ///< win_col_off2() for the following lines
+  OptInt ts;                 ///< 'tabstop'
+  colnr_T *vts;              ///< 'vartabstop'
+  char *sbr;                 ///< 'showbreak'
+  int lcs_eol;               ///< "eol" item of 'listchars'
+  int lcs_tab1;              ///< "tab" item of 'listchars'
+  int briopt_min;
+  int briopt_shift;
+  int briopt_vcol;
+  bool briopt_sbr;
+  bool list;                 ///< 'list'
+  bool lbr;                  ///< 'linebreak'
+  bool bri;                  ///< 'breakindent'
+} plines_key_T;
+
+typedef struct {
+  linenr_T lnum;             ///< line number, zero for an unused entry
+  colnr_T len;               ///< length of the line, as a sanity check
+  int lines;                 ///< result of plines_win_nofold()
+} plines_entry_T;
+
+#define PLINES_CACHE_SIZE 256  // must be a power of two
+
+/// Heights of wrapped lines in a window, as computed by plines_win_nofold().
+/// Scrolling through long wrapped lines asks for the height of the same lines
+/// many times, each time going over all their characters.
+///
+/// The entries are valid for the buffer text at "tick" and the window state
+/// in "key". Changes made through changed_lines() only drop the entries of
+/// the lines that changed, see plines_cache_changed().
+struct plines_cache {
+  plines_key_T key;
+  varnumber_T tick;          ///< changedtick of the buffer
+  plines_entry_T entries[PLINES_CACHE_SIZE];
+};
+
+#define VCOL_INDEX_STEP 4096
+
+/// Virtual columns in one long line, as computed by getvcol(), at every
+/// VCOL_INDEX_STEP bytes up to the first character that is not printable
+/// ASCII or a tab.  Moving the cursor around in a long line asks for the
+/// virtual column of a position far from the start every time.
+///
+/// Valid for the buffer text at "tick", like struct plines_cache.
+struct vcol_index {
+  int fnum;                  ///< buffer number
+  linenr_T lnum;
+  varnumber_T tick;          ///< changedtick of the buffer
+  OptInt ts;                 ///< 'tabstop'
+  colnr_T *vts;              ///< 'vartabstop'
+  kvec_t(colnr_T) vcols;     ///< vcols[k] is the virtual column of byte k * VCOL_INDEX_STEP
+};
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "plines.c.generated.h"
 #endif
 
+static int plines_epoch = 0;
+
 /// Functions calculating horizontal size of text, when displayed in a window.
 
 /// Return the number of characters 'c' will take on the screen, taking
@@ -69,7 +131,14 @@ int linetabsize_col(int startcol, char *s)
 {
   chartabsize_T cts;
   init_chartabsize_arg(&cts, curwin, 0, startcol, s, s);
+  char *end = cts_ascii_one_cell(&cts) ? s + strlen(s) : NULL;
   while (*cts.cts_ptr != NUL) {
+    if (end != NULL) {
+      cts_skip_ascii(&cts, end);
+      if (*cts.cts_ptr == NUL) {
+        break;
+      }
+    }
     cts.cts_vcol += lbr_chartabsize_adv(&cts);
   }
   clear_chartabsize_arg(&cts);
@@ -101,9 +170,23 @@ int linetabsize(win_T *wp, linenr_T lnum)
 
 void win_linetabsize_cts(chartabsize_T *cts, colnr_T len)
 {
-  for (; *cts->cts_ptr != NUL && (len == MAXCOL || cts->cts_ptr < cts->cts_line + len);
-       MB_PTR_ADV(cts->cts_ptr)) {
+  char *end = NULL;
+  if (cts_ascii_one_cell(cts)) {
+    if (len == MAXCOL) {
+      end = cts->cts_ptr + strlen(cts->cts_ptr);
+    } else if (cts->cts_ptr < cts->cts_line + len) {
+      end = cts->cts_ptr + strnlen(cts->cts_ptr, (size_t)(cts->cts_line + len - cts->cts_ptr));
+    }
+  }
+  while (*cts->cts_ptr != NUL && (len == MAXCOL || cts->cts_ptr < cts->cts_line + len)) {
+    if (end != NULL) {
+      cts_skip_ascii(cts, end);
+      if (cts->cts_ptr == end) {
+        break;
+      }
+    }
     cts->cts_vcol += win_lbr_chartabsize(cts, NULL);
+    MB_PTR_ADV(cts->cts_ptr);
   }
   // check for inline virtual text after the end of the line
   if (len == MAXCOL && cts->cts_has_virt_text && *cts->cts_ptr == NUL) {
@@ -143,6 +226,27 @@ void clear_chartabsize_arg(chartabsize_T *cts)
 {
 }
 
+/// Whether printable ASCII characters take one cell each for "cts", because
+/// there is no 'linebreak', 'showbreak', 'breakindent' or inline virtual text.
+static bool cts_ascii_one_cell(chartabsize_T *cts)
+{
+  win_T *wp = cts->cts_win;
+  return !wp->w_p_lbr && !wp->w_p_bri && *get_showbreak_value(wp) == NUL
+         && !cts->cts_has_virt_text;
+}
+
+/// Skip over the printable ASCII characters at "cts->cts_ptr", before "end".
+/// The last one is left when a composing character may follow it.
+static void cts_skip_ascii(chartabsize_T *cts, const char *end)
+{
+  size_t n = ascii_printable_len(cts->cts_ptr, end);
+  if (n > 0 && (uint8_t)cts->cts_ptr[n] >= 0x80) {
+    n--;
+  }
+  cts->cts_ptr += n;
+  cts->cts_vcol += (colnr_T)n;
+}
+
 /// like win_chartabsize(), but also check for line breaks on the screen
 ///
 /// @param cts
@@ -514,7 +618,36 @@ void getvcol(win_T *wp, pos_T *pos, colnr_T *start, colnr_T *cursor, colnr_T *en
       && *get_showbreak_value(wp) == NUL
       && !wp->w_p_bri
       && !cts.cts_has_virt_text) {
+    // Printable ASCII is skipped up to the character at "posptr" or the NUL.
+    char *text_end = posptr != NULL ? posptr : ptr + strlen(ptr);
+    struct vcol_index *vi = vcol_index_get(wp, pos->lnum, line, text_end);
+    // byte offset of the next entry for "vi", while all characters before
+    // "ptr" are printable ASCII or a tab
+    size_t next = SIZE_MAX;
+    if (vi != NULL) {
+      size_t k = MIN(kv_size(vi->vcols) - 1, (size_t)(text_end - line) / VCOL_INDEX_STEP);
+      ptr = line + k * VCOL_INDEX_STEP;
+      vcol = kv_A(vi->vcols, k);
+      next = kv_size(vi->vcols) * VCOL_INDEX_STEP;
+    }
+
     while (true) {
+      size_t off = (size_t)(ptr - line);
+      if (off == next) {
+        kv_push(vi->vcols, vcol);
+        next += VCOL_INDEX_STEP;
+      }
+      // Leave the last one when a composing character may follow it.
+      size_t n = ascii_printable_len(ptr, text_end);
+      if (n > 0 && (uint8_t)ptr[n] >= 0x80) {
+        n--;
+      }
+      for (; next <= off + n; next += VCOL_INDEX_STEP) {
+        kv_push(vi->vcols, vcol + (colnr_T)(next - off));
+      }
+      vcol += (colnr_T)n;
+      ptr += n;
+
       head = 0;
       int c = (uint8_t)(*ptr);
 
@@ -524,6 +657,9 @@ void getvcol(win_T *wp, pos_T *pos, colnr_T *start, colnr_T *cursor, colnr_T *en
         incr = 1;
         break;
       }
+      if (c != TAB && (c < ' ' || c >= 0x7f)) {
+        next = SIZE_MAX;  // "vi" can't go beyond this character
+      }
 
       // A tab gets expanded, depending on the current column
       if (c == TAB) {
@@ -786,6 +922,120 @@ int plines_win_nofill(win_T *wp, linenr_T lnum, bool limit_winheight)
   return lines;
 }
 
+/// Get the index of virtual columns for line "lnum" in window "wp", dropping
+/// one for a different line or buffer text.
+///
+/// @param line  the text of the line
+/// @param end  how far getvcol() looks into the line
+///
+/// @return  NULL when the line is too short to need one.
+static struct vcol_index *vcol_index_get(win_T *wp, linenr_T lnum, char *line, char *end)
+{
+  buf_T *buf = wp->w_buffer;
+  struct vcol_index *vi = wp->w_vcol_index;
+  varnumber_T tick = buf_get_changedtick(buf);
+  if (vi != NULL && vi->fnum == buf->b_fnum && vi->lnum == lnum && vi->tick == tick
+      && vi->ts == buf->b_p_ts && vi->vts == buf->b_p_vts_array) {
+    return vi;
+  }
+  if (end - line < VCOL_INDEX_STEP) {
+    return NULL;
+  }
+  if (vi == NULL) {
+    vi = wp->w_vcol_index = xcalloc(1, sizeof(*vi));
+  }
+  vi->fnum = buf->b_fnum;
+  vi->lnum = lnum;
+  vi->tick = tick;
+  vi->ts = buf->b_p_ts;
+  vi->vts = buf->b_p_vts_array;
+  kv_size(vi->vcols) = 0;
+  kv_push(vi->vcols, 0);
+  return vi;
+}
+
+/// Forget the cached heights of lines in all windows, after a change in
+/// a global option that affects how lines wrap.
+void plines_cache_invalidate_all(void)
+{
+  plines_epoch++;
+}
+
+/// Free the cached heights and virtual columns of lines in window "wp".
+void plines_cache_free(win_T *wp)
+{
+  XFREE_CLEAR(wp->w_plines_cache);
+  if (wp->w_vcol_index != NULL) {
+    kv_destroy(wp->w_vcol_index->vcols);
+    XFREE_CLEAR(wp->w_vcol_index);
+  }
+}
+
+/// Drop the cached heights of lines that were changed in buffer "buf".
+/// Must be called after changedtick was incremented for the change.
+/// See changed_lines() for the arguments.
+void plines_cache_changed(buf_T *buf, linenr_T lnum, linenr_T lnume, linenr_T xtra)
+{
+  varnumber_T tick = buf_get_changedtick(buf);
+  FOR_ALL_TAB_WINDOWS(tp, wp) {
+    struct vcol_index *vi = wp->w_vcol_index;
+    if (vi != NULL && vi->fnum == buf->b_fnum && vi->tick == tick - 1
+        && vi->lnum < lnum) {
+      vi->tick = tick;  // changed below the indexed line
+    }
+    struct plines_cache *pc = wp->w_plines_cache;
+    if (pc == NULL || pc->key.fnum != buf->b_fnum || pc->tick != tick - 1) {
+      // Not this buffer, or the cache is already out of date.
+      continue;
+    }
+    pc->tick = tick;
+    for (int i = 0; i < PLINES_CACHE_SIZE; i++) {
+      linenr_T l = pc->entries[i].lnum;
+      // When lines were inserted or deleted, all lines below moved.
+      if (l >= lnum && (xtra != 0 || l < lnume)) {
+        pc->entries[i].lnum = 0;
+      }
+    }
+  }
+}
+
+/// Get the entry for the height of line "lnum" in window "wp", after
+/// dropping everything cached with a different buffer text or window state.
+static plines_entry_T *plines_cache_entry(win_T *wp, linenr_T lnum)
+{
+  buf_T *buf = wp->w_buffer;
+  plines_key_T key;
+  memset(&key, 0, sizeof(key));  // the struct is compared with memcmp()
+  key.fnum = buf->b_fnum;
+  key.epoch = plines_epoch;
+  key.width = wp->w_width_inner - win_col_off(wp);
+  key.width2 = win_col_off2(wp);
+  key.ts = buf->b_p_ts;
+  key.vts = buf->b_p_vts_array;
+  key.sbr = get_showbreak_value(wp);
+  key.lcs_eol = wp->w_p_lcs_chars.eol;
+  key.lcs_tab1 = wp->w_p_lcs_chars.tab1;
+  key.briopt_min = wp->w_briopt_min;
+  key.briopt_shift = wp->w_briopt_shift;
+  key.briopt_vcol = wp->w_briopt_vcol;
+  key.briopt_sbr = wp->w_briopt_sbr;
+  key.list = wp->w_p_list;
+  key.lbr = wp->w_p_lbr;
+  key.bri = wp->w_p_bri;
+
+  struct plines_cache *pc = wp->w_plines_cache;
+  if (pc == NULL) {
+    pc = wp->w_plines_cache = xcalloc(1, sizeof(*pc));
+  }
+  varnumber_T tick = buf_get_changedtick(buf);
+  if (pc->tick != tick || memcmp(&pc->key, &key, sizeof(key)) != 0) {
+    memset(pc->entries, 0, sizeof(pc->entries));
+    pc->key = key;
+    pc->tick = tick;
+  }
+  return &pc->entries[lnum & (PLINES_CACHE_SIZE - 1)];
+}
+
 /// Get number of window lines physical line "lnum" will occupy in window "wp".
 /// Does not care about folding, 'wrap' or filler lines.
 int plines_win_nofold(win_T *wp, linenr_T lnum)
@@ -796,9 +1046,32 @@ int plines_win_nofold(win_T *wp, linenr_T lnum)
   if (*s == NUL && !cts.cts_has_virt_text) {
     return 1;  // be quick for an empty line
   }
-  win_linetabsize_cts(&cts, (colnr_T)MAXCOL);
-  clear_chartabsize_arg(&cts);
-  int64_t col = cts.cts_vcol;
+
+  // Inline virtual text can change without changing the text, and with
+  // "list" in 'breakindentopt' the indent depends on 'formatlistpat'.
+  if (cts.cts_has_virt_text || wp->w_briopt_list != 0) {
+    return plines_win_nofold_cts(wp, &cts);
+  }
+
+  colnr_T len = (colnr_T)strlen(s);
+  plines_entry_T *entry = plines_cache_entry(wp, lnum);
+  if (entry->lnum != lnum || entry->len != len) {
+    *entry = (plines_entry_T){
+      .lnum = lnum,
+      .len = len,
+      .lines = plines_win_nofold_cts(wp, &cts),
+    };
+  }
+  return entry->lines;
+}
+
+/// Compute the number of window lines for the line that "cts" was initialized
+/// with, see plines_win_nofold().
+static int plines_win_nofold_cts(win_T *wp, chartabsize_T *cts)
+{
+  win_linetabsize_cts(cts, (colnr_T)MAXCOL);
+  clear_chartabsize_arg(cts);
+  int64_t col = cts->cts_vcol;
 
   // If list mode is on, then the '$' at the end of the line may take up one
   // extra column.
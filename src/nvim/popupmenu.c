@@ -47,6 +47,8 @@ static int pum_width;               // width of displayed pum items
 static int pum_base_width;          // width of pum items base
 static int pum_kind_width;          // width of pum items kind column
 static int pum_extra_width;         // width of extra stuff
+static pumitem_T *pum_sized_array = NULL;  // items the widths above are for
+static int pum_sized_count;         // nr of items in "pum_sized_array"
 static int pum_scrollbar;           // one when scrollbar present, else zero
 static bool pum_rl;                 // true when popupmenu is drawn 'rightleft'
 
@@ -68,6 +70,7 @@ static bool pum_invalid = false;  // the screen was just cleared
 static void pum_compute_size(void)
 {
   // Compute the width of the widest match and the widest extra.
+  pum_sized_array = NULL;
   pum_base_width = 0;
   pum_kind_width = 0;
   pum_extra_width = 0;
@@ -299,7 +302,13 @@ void pum_display(pumitem_T *array, int size, int selected, bool array_changed, i
       return;
     }
 
-    pum_compute_size();
+    // Measuring all items is expensive with many of them, only do it when
+    // they changed, not when just another item is selected.
+    if (array_changed || array != pum_sized_array || size != pum_sized_count) {
+      pum_compute_size();
+      pum_sized_array = array;
+      pum_sized_count = size;
+    }
     int max_width = pum_base_width;
 
     // if there are more items than room we need a scrollbar
@@ -868,6 +877,7 @@ void pum_undisplay(bool immediate)
 {
   pum_is_visible = false;
   pum_array = NULL;
+  pum_sized_array = NULL;
   must_redraw_pum = false;
 
   if (immediate) {
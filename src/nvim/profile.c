@@ -6,10 +6,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef MSWIN
+# include <pthread.h>
+# include <signal.h>
+# include <sys/time.h>
+#endif
+
 #include "nvim/ascii.h"
 #include "nvim/charset.h"
 #include "nvim/cmdexpand_defs.h"
 #include "nvim/debugger.h"
+#include "nvim/drawscreen.h"
 #include "nvim/eval.h"
 #include "nvim/eval/typval_defs.h"
 #include "nvim/eval/userfunc.h"
@@ -20,6 +27,8 @@
 #include "nvim/globals.h"
 #include "nvim/hashtab.h"
 #include "nvim/keycodes.h"
+#include "nvim/lua/executor.h"
+#include "nvim/map.h"
 #include "nvim/memory.h"
 #include "nvim/message.h"
 #include "nvim/os/os.h"
@@ -28,6 +37,26 @@
 #include "nvim/profile.h"
 #include "nvim/runtime.h"
 #include "nvim/types.h"
+#include "nvim/vim.h"
+
+/// One sample of the sampling profiler: the frames from outermost to
+/// innermost, separated by ';' (the "folded" format of flamegraph.pl).
+typedef struct {
+  char stack[512];
+} prof_sample_T;
+
+#define SAMPLE_INTERVAL_USEC 1000  ///< CPU time between two samples
+#define SAMPLE_MAX (32 * 1024)     ///< samples kept until ":profile sample stop"
+
+static prof_sample_T *samples = NULL;
+static volatile sig_atomic_t sample_count = 0;
+static volatile sig_atomic_t sample_dropped = 0;
+/// Index of the sample that Lua frames are added to, or -1.
+static volatile sig_atomic_t sample_lua_idx = -1;
+static char *sample_fname = NULL;
+#ifndef MSWIN
+static pthread_t sample_thread;
+#endif
 
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "profile.c.generated.h"
@@ -60,6 +89,19 @@ proftime_T profile_end(proftime_T tm) FUNC_ATTR_WARN_UNUSED_RESULT
   return profile_sub(os_hrtime(), tm);
 }
 
+/// Adds a duration of `ns` nanoseconds to histogram `hist`.
+void stats_hist_add(stats_hist_T *hist, uint64_t ns)
+{
+  hist->count++;
+  hist->total += (int64_t)ns;
+  hist->max = MAX(hist->max, (int64_t)ns);
+  int i = 0;
+  for (uint64_t us = ns / 1000; us > 0 && i < STATS_HIST_BUCKETS - 1; us >>= 1) {
+    i++;
+  }
+  hist->buckets[i]++;
+}
+
 /// Gets a string representing time `tm`.
 ///
 /// @warning Do not modify or free this string, not multithread-safe.
@@ -290,7 +332,9 @@ void ex_profile(exarg_T *eap)
   int len = (int)(e - eap->arg);
   e = skipwhite(e);
 
-  if (len == 5 && strncmp(eap->arg, "start", 5) == 0 && *e != NUL) {
+  if (len == 6 && strncmp(eap->arg, "sample", 6) == 0) {
+    ex_profile_sample(e);
+  } else if (len == 5 && strncmp(eap->arg, "start", 5) == 0 && *e != NUL) {
     xfree(profile_fname);
     profile_fname = expand_env_save_opt(e, true);
     do_profiling = PROF_YES;
@@ -322,6 +366,178 @@ void ex_profile(exarg_T *eap)
   }
 }
 
+/// ":profile sample {subcmd}"
+static void ex_profile_sample(char *arg)
+{
+  char *e = skiptowhite(arg);
+  int len = (int)(e - arg);
+  e = skipwhite(e);
+
+  if (len == 5 && strncmp(arg, "start", 5) == 0 && *e != NUL) {
+    if (samples != NULL) {
+      emsg(_("E5800: Sampling profiler is already running"));
+      return;
+    }
+    sample_fname = expand_env_save_opt(e, true);
+    profile_sample_start();
+  } else if (strcmp(arg, "stop") == 0) {
+    if (samples == NULL) {
+      emsg(_("E5801: Sampling profiler is not running"));
+      return;
+    }
+    profile_sample_stop();
+  } else {
+    semsg(_(e_invarg2), arg);
+  }
+}
+
+#ifndef MSWIN
+/// Append "frame" to the stack of sample "idx".  Characters that have a meaning
+/// in the folded format are replaced.  Only async-signal-safe code here.
+static void sample_push(int idx, const char *frame)
+{
+  char *stack = samples[idx].stack;
+  size_t len = 0;
+  while (len < sizeof(samples[idx].stack) - 1 && stack[len] != NUL) {
+    len++;
+  }
+  if (len > 0 && len < sizeof(samples[idx].stack) - 1) {
+    stack[len++] = ';';
+  }
+  for (const char *p = frame; *p != NUL && len < sizeof(samples[idx].stack) - 1; p++) {
+    stack[len++] = (*p == ';' || *p == ' ' || *p == '\n') ? '_' : *p;
+  }
+  stack[len] = NUL;
+}
+
+/// SIGPROF handler: record the current mode, the Vimscript execution stack and
+/// a placeholder for Lua code, which is filled in from a Lua hook.
+static void sample_signal_handler(int signum)
+{
+  if (!pthread_equal(pthread_self(), sample_thread)) {
+    // The timer signal can be delivered to any thread, only the main thread
+    // has a stack worth sampling.
+    pthread_kill(sample_thread, SIGPROF);
+    return;
+  }
+  if (samples == NULL) {
+    return;
+  }
+  if (sample_count >= SAMPLE_MAX) {
+    sample_dropped++;
+    return;
+  }
+
+  int idx = sample_count;
+  samples[idx].stack[0] = NUL;
+  sample_push(idx, (State & MODE_CMDLINE) ? "cmdline"
+              : (State & MODE_TERMINAL) ? "terminal"
+              : (State & MODE_INSERT) ? "insert"
+              : (State & MODE_NORMAL) ? "normal" : "other");
+  for (int i = 1; i < exestack.ga_len; i++) {
+    const estack_T *entry = ((estack_T *)exestack.ga_data) + i;
+    if (entry->es_name != NULL) {
+      sample_push(idx, entry->es_name);
+    }
+  }
+  if (updating_screen) {
+    sample_push(idx, "[redraw]");
+  }
+  if (nlua_sample_request()) {
+    sample_push(idx, "[lua]");
+    sample_lua_idx = idx;
+  }
+  sample_count = idx + 1;
+}
+#endif
+
+/// Called from the Lua hook set by nlua_sample_request() to add a Lua frame to
+/// the sample taken last.  Frames are passed from outermost to innermost.
+void profile_sample_push_lua(const char *frame)
+{
+#ifndef MSWIN
+  int idx = sample_lua_idx;
+  if (samples != NULL && idx >= 0) {
+    sample_push(idx, frame);
+  }
+#endif
+}
+
+/// Called after the last Lua frame of a sample was pushed.
+void profile_sample_lua_done(void)
+{
+  sample_lua_idx = -1;
+}
+
+static void profile_sample_start(void)
+{
+#ifdef MSWIN
+  emsg(_("E5802: Sampling profiler is not supported on this system"));
+  XFREE_CLEAR(sample_fname);
+#else
+  samples = xcalloc(SAMPLE_MAX, sizeof(*samples));
+  sample_count = 0;
+  sample_dropped = 0;
+  sample_lua_idx = -1;
+  sample_thread = pthread_self();
+
+  struct sigaction sa = { .sa_handler = sample_signal_handler, .sa_flags = SA_RESTART };
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGPROF, &sa, NULL);
+  struct itimerval timer = {
+    .it_interval = { .tv_sec = 0, .tv_usec = SAMPLE_INTERVAL_USEC },
+    .it_value = { .tv_sec = 0, .tv_usec = SAMPLE_INTERVAL_USEC },
+  };
+  setitimer(ITIMER_PROF, &timer, NULL);
+#endif
+}
+
+/// Stop the sampling profiler and write the samples to "sample_fname", with
+/// identical stacks merged: one line per stack, followed by the sample count.
+static void profile_sample_stop(void)
+{
+#ifndef MSWIN
+  struct itimerval timer = { 0 };
+  setitimer(ITIMER_PROF, &timer, NULL);
+  struct sigaction sa = { .sa_handler = SIG_IGN };
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGPROF, &sa, NULL);
+
+  FILE *fd = os_fopen(sample_fname, "w");
+  if (fd == NULL) {
+    semsg(_(e_notopen), sample_fname);
+  } else {
+    Map(String, int) stacks = MAP_INIT;
+    for (int i = 0; i < sample_count; i++) {
+      int *count = map_put_ref(String, int)(&stacks, cstr_as_string(samples[i].stack), NULL,
+                                            NULL);
+      (*count)++;
+    }
+    String stack;
+    int count;
+    map_foreach(&stacks, stack, count, {
+      fprintf(fd, "%s %d\n", stack.data, count);
+    });
+    map_destroy(String, &stacks);
+    fclose(fd);
+    if (sample_dropped > 0) {
+      smsg(0, _("Sampling profiler: %d samples dropped"), (int)sample_dropped);
+    }
+  }
+
+  XFREE_CLEAR(samples);
+  XFREE_CLEAR(sample_fname);
+#endif
+}
+
+/// Stop the sampling profiler and write its file when exiting.
+void profile_sample_exit(void)
+{
+  if (samples != NULL) {
+    profile_sample_stop();
+  }
+}
+
 /// Command line expansion for :profile.
 static enum {
   PEXP_SUBCMD,          ///< expand :profile sub-commands
@@ -334,6 +550,7 @@ static char *pexpand_cmds[] = {
   "file",
   "func",
   "pause",
+  "sample",
   "start",
   "stop",
   NULL
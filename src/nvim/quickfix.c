@@ -47,6 +47,7 @@
 #include "nvim/option_defs.h"
 #include "nvim/option_vars.h"
 #include "nvim/optionstr.h"
+#include "nvim/os/fileio.h"
 #include "nvim/os/fs_defs.h"
 #include "nvim/os/input.h"
 #include "nvim/os/os.h"
@@ -148,6 +149,7 @@ struct qf_info_S {
 
 static qf_info_T ql_info;         // global quickfix list
 static unsigned last_qf_id = 0;   // Last Used quickfix list id
+static Pool qfline_pool = POOL_INIT(qfline_T);  // for the entries of all lists
 
 #define FMT_PATTERNS 14           // maximum number of % recognized
 
@@ -175,6 +177,8 @@ struct efm_S {
                               // '-' do not include this line
                               // '+' include whole line in message
   int conthere;                 // %> used
+  char lead;                  // ASCII character a matching line must start
+                              // with (lowercase), NUL if not known
 };
 
 /// List of location lists to be deleted.
@@ -522,7 +526,14 @@ static int efm_to_regpat(const char *efm, int len, efm_T *fmt_ptr, char *regpat)
   char *ptr = regpat;
   *ptr++ = '^';
   int round = 0;
+  bool at_start = true;   // nothing that matches text added yet
+  bool after_lead = false;  // previous item set fmt_ptr->lead
   for (const char *efmp = efm; efmp < efm + len; efmp++) {
+    if (after_lead && efmp[0] == '%' && (efmp[1] == '#' || efmp[1] == '\\')) {
+      // "%#" or "%\\=" may make the first character optional.
+      fmt_ptr->lead = NUL;
+    }
+    after_lead = false;
     if (*efmp == '%') {
       efmp++;
       int idx;
@@ -532,20 +543,24 @@ static int efm_to_regpat(const char *efm, int len, efm_T *fmt_ptr, char *regpat)
         }
       }
       if (idx < FMT_PATTERNS) {
+        at_start = false;
         ptr = efmpat_to_regpat(efmp, ptr, fmt_ptr, idx, round);
         if (ptr == NULL) {
           return FAIL;
         }
         round++;
       } else if (*efmp == '*') {
+        at_start = false;
         efmp++;
         ptr = scanf_fmt_to_regpat(&efmp, efm, len, ptr);
         if (ptr == NULL) {
           return FAIL;
         }
       } else if (vim_strchr("%\\.^$~[", (uint8_t)(*efmp)) != NULL) {
+        at_start = false;
         *ptr++ = *efmp;  // regexp magic characters
       } else if (*efmp == '#') {
+        at_start = false;
         *ptr++ = '*';
       } else if (*efmp == '>') {
         fmt_ptr->conthere = true;
@@ -566,6 +581,15 @@ static int efm_to_regpat(const char *efm, int len, efm_T *fmt_ptr, char *regpat)
       } else if (vim_strchr(".*^$~[", (uint8_t)(*efmp)) != NULL) {
         *ptr++ = '\\';  // escape regexp atoms
       }
+      if (at_start) {
+        // Remember the first character, lines that start with another one
+        // can be skipped without trying the pattern.
+        if ((uint8_t)(*efmp) < 0x80) {
+          fmt_ptr->lead = (char)TOLOWER_ASC(*efmp);
+          after_lead = true;
+        }
+        at_start = false;
+      }
       if (*efmp) {
         *ptr++ = *efmp;
       }
@@ -1596,6 +1620,13 @@ static int qf_parse_get_fields(char *linebuf, size_t linelen, efm_T *fmt_ptr, qf
   fields->type = 0;
   *tail = NULL;
 
+  // A line starting with an ASCII character can't match a format that starts
+  // with another one, also when ignoring case.
+  if (fmt_ptr->lead != NUL && (uint8_t)(*linebuf) < 0x80
+      && (char)TOLOWER_ASC(*linebuf) != fmt_ptr->lead) {
+    return QF_FAIL;
+  }
+
   regmatch_T regmatch;
   // Always ignore case when looking for a matching error.
   regmatch.rm_ic = true;
@@ -1864,7 +1895,7 @@ static int qf_add_entry(qf_list_T *qfl, char *dir, char *fname, char *module, in
                         char vis_col, char *pattern, int nr, char type, typval_T *user_data,
                         char valid)
 {
-  qfline_T *qfp = xmalloc(sizeof(qfline_T));
+  qfline_T *qfp = pool_alloc(&qfline_pool);
 
   if (bufnum != 0) {
     buf_T *buf = buflist_findnr(bufnum);
@@ -2450,6 +2481,19 @@ static qfline_T *get_nth_entry(qf_list_T *qfl, int errornr, int *new_qfidx)
   qfline_T *qf_ptr = qfl->qf_ptr;
   int qf_idx = qfl->qf_index;
 
+  // Start from the first or last entry when that is closer, so that jumping
+  // around in a long list doesn't walk over most of it.
+  if (qfl->qf_count > 0) {
+    if (errornr <= 1 || (errornr < qf_idx && errornr - 1 < qf_idx - errornr)) {
+      qf_ptr = qfl->qf_start;
+      qf_idx = 1;
+    } else if (errornr >= qfl->qf_count
+               || (errornr > qf_idx && qfl->qf_count - errornr < errornr - qf_idx)) {
+      qf_ptr = qfl->qf_last;
+      qf_idx = qfl->qf_count;
+    }
+  }
+
   // New error number is less than the current error number
   while (errornr < qf_idx && qf_idx > 1 && qf_ptr->qf_prev != NULL) {
     qf_idx--;
@@ -3405,7 +3449,7 @@ static void qf_free_items(qf_list_T *qfl)
       xfree(qfp->qf_pattern);
       tv_clear(&qfp->qf_user_data);
       stop = (qfp == qfpnext);
-      xfree(qfp);
+      pool_free(&qfline_pool, qfp);
       if (stop) {
         // Somehow qf_count may have an incorrect value, set it to 1
         // to avoid crashing when it's wrong.
@@ -5198,6 +5242,94 @@ static void vgr_display_fname(char *fname)
   ui_flush();
 }
 
+/// Return true when "pat" only matches itself: printable ASCII without
+/// characters that are special with 'magic'.
+static bool vgr_pat_is_literal(const char *pat)
+{
+  if (pat == NULL || *pat == NUL) {
+    return false;
+  }
+  for (const char *p = pat; *p != NUL; p++) {
+    if ((uint8_t)(*p) < ' ' || (uint8_t)(*p) > '~'
+        || vim_strchr(".*[]^$~\\", (uint8_t)(*p)) != NULL) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Check whether the file "fname" that isn't loaded may contain a match for
+/// the literal pattern "pat", by looking at the bytes in the file.  This
+/// avoids loading the file into a dummy buffer when it can't match.
+/// Returns true when the file needs to be loaded to find out.
+static bool vgr_file_may_match(char *fname, const char *pat, bool ic)
+{
+  // Autocommands may change what is read, a 'fileencodings' entry may
+  // convert the ASCII text.
+  if (has_autocmd(EVENT_BUFREADCMD, fname, NULL)
+      || has_autocmd(EVENT_FILEREADCMD, fname, NULL)
+      || has_autocmd(EVENT_BUFREADPRE, fname, NULL)
+      || has_autocmd(EVENT_FILEREADPRE, fname, NULL)
+      || strstr(p_fencs, "16") != NULL || strstr(p_fencs, "32") != NULL
+      || strstr(p_fencs, "ucs-2") != NULL || strstr(p_fencs, "ucs2") != NULL
+      || strstr(p_fencs, "ucs-4") != NULL || strstr(p_fencs, "ucs4") != NULL) {
+    return true;
+  }
+
+  int error;
+  FileDescriptor *fp = file_open_new(&error, fname, kFileReadOnly, 0);
+  if (fp == NULL) {
+    return true;
+  }
+
+  const size_t patlen = strlen(pat);
+  const size_t bufsize = 64 * 1024;
+  char *buf = xmalloc(bufsize + patlen);
+  size_t keep = 0;  // bytes kept from the previous read
+  bool first = true;
+  bool may_match = false;
+  while (!may_match && !got_int) {
+    ptrdiff_t n = file_read(fp, buf + keep, bufsize);
+    if (n <= 0) {
+      may_match = n < 0;
+      break;
+    }
+    size_t len = keep + (size_t)n;
+    uint8_t *u = (uint8_t *)buf;
+    if (first && len >= 2
+        && ((u[0] == 0xfe && u[1] == 0xff) || (u[0] == 0xff && u[1] == 0xfe)
+            || (u[0] == 0 && u[1] == 0))) {
+      // Looks like UTF-16 or UTF-32 with a BOM.
+      may_match = true;
+      break;
+    }
+    first = false;
+    for (size_t i = 0; i + patlen <= len && !may_match; i++) {
+      if (ic && u[i] >= 0x80) {
+        // Case folding may turn a non-ASCII character into an ASCII one.
+        may_match = true;
+      } else if (ic ? STRNICMP(buf + i, pat, patlen) == 0
+                 : memcmp(buf + i, pat, patlen) == 0) {
+        may_match = true;
+      }
+    }
+    if (ic && !may_match) {
+      for (size_t i = len - MIN(len, patlen - 1); i < len; i++) {
+        if (u[i] >= 0x80) {
+          may_match = true;
+        }
+      }
+    }
+    // A match may continue in the next block.
+    keep = MIN(len, patlen - 1);
+    memmove(buf, buf + len - keep, keep);
+  }
+
+  xfree(buf);
+  file_free(fp, false);
+  return may_match;
+}
+
 /// Load a dummy buffer to search for a pattern using vimgrep.
 static buf_T *vgr_load_dummy_buf(char *fname, char *dirname_start, char *dirname_now)
 {
@@ -5443,6 +5575,10 @@ static int vgr_process_files(win_T *wp, qf_info_T *qi, vgr_args_T *cmd_args, boo
   // ":lcd %:p:h" changes the meaning of short path names.
   os_dirname(dirname_start, MAXPATHL);
 
+  // For a plain text pattern the files can be checked without loading them.
+  const bool literal = !(cmd_args->flags & VGR_FUZZY)
+                       && vgr_pat_is_literal(cmd_args->spat);
+
   time_t seconds = 0;
   for (int fi = 0; fi < cmd_args->fcount && !got_int && cmd_args->tomatch > 0; fi++) {
     char *fname = path_try_shorten_fname(cmd_args->fnames[fi]);
@@ -5455,6 +5591,12 @@ static int vgr_process_files(win_T *wp, qf_info_T *qi, vgr_args_T *cmd_args, boo
 
     buf_T *buf = buflist_findname_exp(cmd_args->fnames[fi]);
     bool using_dummy;
+    if ((buf == NULL || buf->b_ml.ml_mfp == NULL) && literal
+        && !vgr_file_may_match(cmd_args->fnames[fi], cmd_args->spat,
+                               cmd_args->regmatch.rmm_ic)) {
+      // The file can't contain a match, no need to load it.
+      continue;
+    }
     if (buf == NULL || buf->b_ml.ml_mfp == NULL) {
       // Remember that a buffer with this name already exists.
       duplicate_name = (buf != NULL);
@@ -172,6 +172,42 @@ typedef struct {
   int has_pim;                  ///< true when any state has a PIM
 } nfa_list_T;
 
+// For patterns that only consist of characters, character classes,
+// collections, alternatives and repeats, a DFA is built while executing,
+// one state for each set of NFA states seen.  It only tells whether there
+// can be a match in the line, nfa_regtry() is still used to find the match
+// and submatches.  Everything that depends on the position, buffer or
+// options, like "\<" or "\k", is treated as always matching.  This way the
+// DFA can be kept with the program and never claims there is no match when
+// there is one.
+
+#define NFA_DFA_MAX_STATES 128
+
+typedef struct {
+  int *ids;                     ///< sorted ids of the consuming NFA states
+  int nids;
+  uint32_t hash;                ///< hash of "ids"
+  bool accept;                  ///< NFA_MATCH was reached
+  bool accept_eol;              ///< NFA_MATCH is reached at the end of the line
+  int16_t next[128];            ///< next state for ASCII, -1 when not known yet
+  int last_c;                   ///< last non-ASCII character
+  int last_next;                ///< next state for "last_c"
+} nfa_dfa_state_T;
+
+typedef struct nfa_dfa {
+  bool failed;                  ///< pattern not supported or too many states
+  bool ic;                      ///< value of rex.reg_ic the states are for
+  int start;                    ///< start state at column zero
+  int start_nobol;              ///< start state at other columns
+  int *mark;                    ///< for each NFA state: "gen" when in "list"
+  int gen;
+  int *list;                    ///< NFA states collected by nfa_dfa_closure()
+  int nlist;
+  nfa_dfa_state_T *states;
+  int nstates;
+  int states_size;              ///< allocated number of "states"
+} nfa_dfa_T;
+
 #ifdef REGEXP_DEBUG
 // show/save debugging data when BT engine is used
 # define BT_REGEXP_DUMP
@@ -8243,6 +8279,22 @@ static save_se_T *nfa_endp = NULL;
 // 0 for first call to nfa_regmatch(), 1 for recursive call.
 static int nfa_ll_index = 0;
 
+// Compiled programs given to vim_regfree(), vim_regcomp() takes them out
+// again when the same pattern is compiled.  Least recently freed first.
+#define REGPROG_CACHE_SIZE 32
+typedef struct {
+  regprog_T *prog;
+  int re_flags;      ///< "re_flags" argument of vim_regcomp()
+  int cpo_lit;       ///< "reg_cpo_lit" when compiling
+  int extmatch;      ///< "reg_do_extmatch" when compiling
+} regprog_cache_T;
+static regprog_cache_T regprog_cache[REGPROG_CACHE_SIZE];
+static int regprog_cache_len = 0;
+
+// Thread lists of a finished nfa_regmatch() call, kept for the next call to
+// avoid allocating them again for every line that is matched.
+static nfa_list_T nfa_list_cache[2];
+
 // Helper functions used when doing re2post() ... regatom() parsing
 #define EMIT(c) \
   do { \
@@ -13700,6 +13752,41 @@ static int find_match_text(colnr_T *startcol, int regstart, uint8_t *match_text)
   colnr_T col = *startcol;
   int regstart_len = PTR2LEN((char *)rex.line + col);
 
+  // Without ignoring case the text can be found with strstr(), which is
+  // much faster than checking every occurrence of regstart.
+  size_t text_len = strlen((char *)match_text);
+  char needle[MB_MAXBYTES + 1 + 80];
+  if (!rex.reg_ic && text_len < 80) {
+    int needle_start_len = utf_char2bytes(regstart, needle);
+    memcpy(needle + needle_start_len, match_text, text_len + 1);
+    while (true) {
+      char *s = strstr((char *)rex.line + col, needle);
+      if (s == NULL) {
+        break;
+      }
+      col = (colnr_T)(s - (char *)rex.line);
+      uint8_t *end = (uint8_t *)s + needle_start_len + text_len;
+      // check that no composing char follows
+      if (!utf_iscomposing(utf_ptr2char((char *)end))) {
+        cleanup_subexpr();
+        if (REG_MULTI) {
+          rex.reg_startpos[0].lnum = rex.lnum;
+          rex.reg_startpos[0].col = col;
+          rex.reg_endpos[0].lnum = rex.lnum;
+          rex.reg_endpos[0].col = (colnr_T)(end - rex.line);
+        } else {
+          rex.reg_startp[0] = rex.line + col;
+          rex.reg_endp[0] = end;
+        }
+        *startcol = col;
+        return 1L;
+      }
+      col += needle_start_len;
+    }
+    *startcol = col;
+    return 0L;
+  }
+
   while (true) {
     bool match = true;
     uint8_t *s1 = match_text;
@@ -13809,12 +13896,23 @@ static int nfa_regmatch(nfa_regprog_T *prog, nfa_state_T *start, regsubs_T *subm
 #endif
   nfa_match = false;
 
-  // Allocate memory for the lists of nodes.
+  // Allocate memory for the lists of nodes, reuse the cached lists if
+  // possible.  A recursive call finds them in use and allocates its own.
   size_t size = (size_t)(prog->nstate + 1) * sizeof(nfa_thread_T);
-  list[0].t = xmalloc(size);
-  list[0].len = prog->nstate + 1;
-  list[1].t = xmalloc(size);
-  list[1].len = prog->nstate + 1;
+  for (int i = 0; i < 2; i++) {
+    if (nfa_list_cache[i].t != NULL) {
+      list[i].t = nfa_list_cache[i].t;
+      list[i].len = nfa_list_cache[i].len;
+      nfa_list_cache[i].t = NULL;
+      if (list[i].len < prog->nstate + 1) {
+        list[i].t = xrealloc(list[i].t, size);
+        list[i].len = prog->nstate + 1;
+      }
+    } else {
+      list[i].t = xmalloc(size);
+      list[i].len = prog->nstate + 1;
+    }
+  }
 
 #ifdef REGEXP_DEBUG
   log_fd = fopen(NFA_REGEXP_RUN_LOG, "a");
@@ -15090,9 +15188,15 @@ nextchar:
 #endif
 
 theend:
-  // Free memory
-  xfree(list[0].t);
-  xfree(list[1].t);
+  // Free memory, or keep the lists for the next call.
+  for (int i = 0; i < 2; i++) {
+    if (nfa_list_cache[i].t == NULL) {
+      nfa_list_cache[i].t = list[i].t;
+      nfa_list_cache[i].len = list[i].len;
+    } else {
+      xfree(list[i].t);
+    }
+  }
   xfree(listids);
 #undef ADD_STATE_IF_MATCH
 #ifdef NFA_REGEXP_DEBUG_LOG
@@ -15235,6 +15339,385 @@ static int nfa_regtry(nfa_regprog_T *prog, colnr_T col, proftime_T *tm, int *tim
 ///
 /// @return <= 0 if there is no match and number of lines contained in the
 /// match otherwise.
+static void nfa_dfa_free(nfa_dfa_T *dfa)
+{
+  if (dfa == NULL) {
+    return;
+  }
+  for (int i = 0; i < dfa->nstates; i++) {
+    xfree(dfa->states[i].ids);
+  }
+  xfree(dfa->states);
+  xfree(dfa->mark);
+  xfree(dfa->list);
+  xfree(dfa);
+}
+
+/// @return  true if the NFA state types of "prog" can be handled by the DFA.
+static bool nfa_dfa_supported(nfa_regprog_T *prog)
+{
+  if (prog->has_backref || (prog->regflags & RF_HASNL)) {
+    return false;
+  }
+  for (int i = 0; i < prog->nstate; i++) {
+    int c = prog->state[i].c;
+    if (c > 0
+        || (c >= NFA_ANY && c <= NFA_NUPPER_IC)
+        || (c >= NFA_CURSOR && c <= NFA_CLASS_FNAME)
+        || (c >= NFA_MOPEN && c <= NFA_ZCLOSE9)) {
+      continue;
+    }
+    switch (c) {
+    case NFA_SPLIT:
+    case NFA_MATCH:
+    case NFA_EMPTY:
+    case NFA_START_COLL:
+    case NFA_END_COLL:
+    case NFA_START_NEG_COLL:
+    case NFA_END_NEG_COLL:
+    case NFA_RANGE_MIN:
+    case NFA_RANGE_MAX:
+    case NFA_BOL:
+    case NFA_EOL:
+    case NFA_BOW:
+    case NFA_EOW:
+    case NFA_BOF:
+    case NFA_EOF:
+    case NFA_ZSTART:
+    case NFA_ZEND:
+    case NFA_NOPEN:
+    case NFA_NCLOSE:
+    case NFA_ANY_COMPOSING:
+      continue;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Add the consuming states reachable from "state" without consuming a
+/// character to dfa->list.
+///
+/// @param at_bol  at the start of the line, "^" matches
+/// @param at_eol  at the end of the line, "$" matches
+/// @param[out] accept  set when NFA_MATCH is reached
+static void nfa_dfa_closure(nfa_regprog_T *prog, nfa_dfa_T *dfa, nfa_state_T *state, bool at_bol,
+                            bool at_eol, bool *accept)
+{
+  while (state != NULL) {
+    int c = state->c;
+    int idx = (int)(state - prog->state);
+    if (dfa->mark[idx] == dfa->gen) {
+      return;
+    }
+    dfa->mark[idx] = dfa->gen;
+
+    if ((c >= NFA_MOPEN && c <= NFA_ZCLOSE9) || (c >= NFA_CURSOR && c <= NFA_VISUAL)) {
+      state = state->out;
+      continue;
+    }
+    switch (c) {
+    case NFA_MATCH:
+      *accept = true;
+      return;
+    case NFA_SPLIT:
+      nfa_dfa_closure(prog, dfa, state->out, at_bol, at_eol, accept);
+      state = state->out1;
+      continue;
+    case NFA_BOL:
+      if (!at_bol && !at_eol) {
+        return;
+      }
+      state = state->out;
+      continue;
+    case NFA_EOL:
+      if (!at_eol) {
+        dfa->list[dfa->nlist++] = idx;
+        return;
+      }
+      state = state->out;
+      continue;
+    case NFA_EMPTY:
+    case NFA_BOW:
+    case NFA_EOW:
+    case NFA_BOF:
+    case NFA_EOF:
+    case NFA_ZSTART:
+    case NFA_ZEND:
+    case NFA_NOPEN:
+    case NFA_NCLOSE:
+    case NFA_ANY_COMPOSING:
+      state = state->out;
+      continue;
+    default:
+      if (!at_eol) {
+        dfa->list[dfa->nlist++] = idx;
+      }
+      return;
+    }
+  }
+}
+
+/// @return  true if NFA state "state" can consume character "c".  Returns true
+///          when it depends on the buffer or an option.
+static bool nfa_dfa_char_match(nfa_state_T *state, int c, bool ic)
+{
+  switch (state->c) {
+  case NFA_ANY:
+  case NFA_IDENT:
+  case NFA_SIDENT:
+  case NFA_KWORD:
+  case NFA_SKWORD:
+  case NFA_FNAME:
+  case NFA_SFNAME:
+  case NFA_PRINT:
+  case NFA_SPRINT:
+    return true;
+  case NFA_WHITE:
+    return ascii_iswhite(c);
+  case NFA_NWHITE:
+    return !ascii_iswhite(c);
+  case NFA_DIGIT:
+    return ri_digit(c);
+  case NFA_NDIGIT:
+    return !ri_digit(c);
+  case NFA_HEX:
+    return ri_hex(c);
+  case NFA_NHEX:
+    return !ri_hex(c);
+  case NFA_OCTAL:
+    return ri_octal(c);
+  case NFA_NOCTAL:
+    return !ri_octal(c);
+  case NFA_WORD:
+    return ri_word(c);
+  case NFA_NWORD:
+    return !ri_word(c);
+  case NFA_HEAD:
+    return ri_head(c);
+  case NFA_NHEAD:
+    return !ri_head(c);
+  case NFA_ALPHA:
+    return ri_alpha(c);
+  case NFA_NALPHA:
+    return !ri_alpha(c);
+  case NFA_LOWER:
+    return ri_lower(c);
+  case NFA_NLOWER:
+    return !ri_lower(c);
+  case NFA_UPPER:
+    return ri_upper(c);
+  case NFA_NUPPER:
+    return !ri_upper(c);
+  case NFA_LOWER_IC:
+    return ri_lower(c) || (ic && ri_upper(c));
+  case NFA_NLOWER_IC:
+    return !(ri_lower(c) || (ic && ri_upper(c)));
+  case NFA_UPPER_IC:
+    return ri_upper(c) || (ic && ri_lower(c));
+  case NFA_NUPPER_IC:
+    return !(ri_upper(c) || (ic && ri_lower(c)));
+  case NFA_START_COLL:
+  case NFA_START_NEG_COLL: {
+    // Same as in nfa_regmatch().
+    bool result_if_matched = (state->c == NFA_START_COLL);
+    for (nfa_state_T *s = state->out; s->c != NFA_END_COLL; s = s->out) {
+      if (s->c == NFA_RANGE_MIN) {
+        int c1 = s->val;
+        s = s->out;                 // advance to NFA_RANGE_MAX
+        int c2 = s->val;
+        if (c >= c1 && c <= c2) {
+          return result_if_matched;
+        }
+        if (ic) {
+          int c_low = utf_fold(c);
+          for (; c1 <= c2; c1++) {
+            if (utf_fold(c1) == c_low) {
+              return result_if_matched;
+            }
+          }
+        }
+      } else if (s->c == NFA_CLASS_PRINT || s->c == NFA_CLASS_IDENT
+                 || s->c == NFA_CLASS_KEYWORD || s->c == NFA_CLASS_FNAME) {
+        return true;
+      } else if (s->c < 0 ? check_char_class(s->c, c)
+                          : (c == s->c || (ic && utf_fold(c) == utf_fold(s->c)))) {
+        return result_if_matched;
+      }
+    }
+    return !result_if_matched;
+  }
+  default:
+    if (state->c < 0) {
+      return true;
+    }
+    return c == state->c || (ic && utf_fold(c) == utf_fold(state->c));
+  }
+}
+
+/// Find or add the DFA state for the NFA states in dfa->list.
+///
+/// @return  index of the state, -1 when there are too many states.
+static int nfa_dfa_add_state(nfa_regprog_T *prog, nfa_dfa_T *dfa, bool accept)
+{
+  // sort the ids, insertion sort since lists are short
+  int *ids = dfa->list;
+  int n = dfa->nlist;
+  for (int i = 1; i < n; i++) {
+    int id = ids[i];
+    int j = i;
+    for (; j > 0 && ids[j - 1] > id; j--) {
+      ids[j] = ids[j - 1];
+    }
+    ids[j] = id;
+  }
+  uint32_t hash = accept ? 1 : 0;
+  for (int i = 0; i < n; i++) {
+    hash = hash * 31 + (uint32_t)ids[i];
+  }
+
+  for (int i = 0; i < dfa->nstates; i++) {
+    nfa_dfa_state_T *ds = &dfa->states[i];
+    if (ds->hash == hash && ds->nids == n && ds->accept == accept
+        && memcmp(ds->ids, ids, (size_t)n * sizeof(int)) == 0) {
+      return i;
+    }
+  }
+  if (dfa->nstates == NFA_DFA_MAX_STATES) {
+    return -1;
+  }
+  if (dfa->nstates == dfa->states_size) {
+    dfa->states_size *= 2;
+    dfa->states = xrealloc(dfa->states, (size_t)dfa->states_size * sizeof(nfa_dfa_state_T));
+  }
+
+  nfa_dfa_state_T *ds = &dfa->states[dfa->nstates];
+  ds->ids = xmemdup(ids, (size_t)n * sizeof(int));
+  ds->nids = n;
+  ds->hash = hash;
+  ds->accept = accept;
+  memset(ds->next, -1, sizeof(ds->next));
+  ds->last_c = -1;
+  ds->last_next = -1;
+
+  // Is NFA_MATCH reached at the end of the line?
+  ds->accept_eol = accept;
+  for (int i = 0; i < n && !ds->accept_eol; i++) {
+    nfa_state_T *state = &prog->state[ids[i]];
+    if (state->c == NFA_EOL) {
+      dfa->gen++;
+      nfa_dfa_closure(prog, dfa, state->out, false, true, &ds->accept_eol);
+    }
+  }
+  return dfa->nstates++;
+}
+
+/// Compute the DFA state after state "from" consumes character "c".
+///
+/// @return  index of the state, -1 when there are too many states.
+static int nfa_dfa_step(nfa_regprog_T *prog, nfa_dfa_T *dfa, int from, int c)
+{
+  nfa_dfa_state_T *ds = &dfa->states[from];
+  bool accept = false;
+
+  dfa->nlist = 0;
+  dfa->gen++;
+  // A composing character may also be skipped together with the character
+  // before it.
+  if (utf_iscomposing(c)) {
+    for (int i = 0; i < ds->nids; i++) {
+      dfa->mark[ds->ids[i]] = dfa->gen;
+      dfa->list[dfa->nlist++] = ds->ids[i];
+    }
+  }
+  for (int i = 0; i < ds->nids; i++) {
+    nfa_state_T *state = &prog->state[ds->ids[i]];
+    if (state->c != NFA_EOL && nfa_dfa_char_match(state, c, dfa->ic)) {
+      nfa_state_T *next = (state->c == NFA_START_COLL || state->c == NFA_START_NEG_COLL)
+                          ? state->out1->out : state->out;
+      nfa_dfa_closure(prog, dfa, next, false, false, &accept);
+    }
+  }
+  // a match may also start at the next character
+  nfa_dfa_closure(prog, dfa, prog->start, false, false, &accept);
+  return nfa_dfa_add_state(prog, dfa, accept);
+}
+
+/// Check if there can be a match in rex.line, starting at column "col".
+///
+/// @return  false when there is no match for sure.
+static bool nfa_dfa_may_match(nfa_regprog_T *prog, colnr_T col)
+{
+  nfa_dfa_T *dfa = prog->dfa;
+
+  if (dfa == NULL) {
+    dfa = prog->dfa = xcalloc(1, sizeof(nfa_dfa_T));
+    dfa->failed = !nfa_dfa_supported(prog);
+    dfa->ic = !rex.reg_ic;  // force building the start states
+  }
+  if (dfa->failed || rex.reg_icombine) {
+    return true;
+  }
+
+  if (dfa->ic != rex.reg_ic || dfa->states == NULL) {
+    for (int i = 0; i < dfa->nstates; i++) {
+      xfree(dfa->states[i].ids);
+    }
+    dfa->nstates = 0;
+    dfa->ic = rex.reg_ic;
+    if (dfa->states == NULL) {
+      dfa->states_size = 8;
+      dfa->states = xmalloc((size_t)dfa->states_size * sizeof(nfa_dfa_state_T));
+      dfa->mark = xcalloc((size_t)prog->nstate, sizeof(int));
+      dfa->list = xmalloc((size_t)prog->nstate * sizeof(int));
+    }
+    for (int i = 0; i < 2; i++) {
+      bool accept = false;
+      dfa->nlist = 0;
+      dfa->gen++;
+      nfa_dfa_closure(prog, dfa, prog->start, i == 0, false, &accept);
+      *(i == 0 ? &dfa->start : &dfa->start_nobol) = nfa_dfa_add_state(prog, dfa, accept);
+    }
+  }
+
+  int cur = col == 0 ? dfa->start : dfa->start_nobol;
+  const char *p = (char *)rex.line + col;
+  while (true) {
+    nfa_dfa_state_T *ds = &dfa->states[cur];
+    if (ds->accept) {
+      return true;
+    }
+    int c = utf_ptr2char(p);
+    if (c == NUL) {
+      return ds->accept_eol;
+    }
+
+    // Note: nfa_dfa_step() may move the states.
+    int next;
+    if (c < 128) {
+      next = ds->next[c];
+      if (next < 0) {
+        next = nfa_dfa_step(prog, dfa, cur, c);
+        dfa->states[cur].next[c] = (int16_t)next;
+      }
+    } else if (c == ds->last_c) {
+      next = ds->last_next;
+    } else {
+      next = nfa_dfa_step(prog, dfa, cur, c);
+      dfa->states[cur].last_c = c;
+      dfa->states[cur].last_next = next;
+    }
+    if (next < 0) {
+      // Too many states, don't use the DFA for this pattern.
+      dfa->failed = true;
+      return true;
+    }
+    cur = next;
+    p += utf_ptr2len(p);
+  }
+}
+
 static int nfa_regexec_both(uint8_t *line, colnr_T startcol, proftime_T *tm, int *timed_out)
 {
   nfa_regprog_T *prog;
@@ -15321,6 +15804,11 @@ static int nfa_regexec_both(uint8_t *line, colnr_T startcol, proftime_T *tm, int
     goto theend;
   }
 
+  // Quickly skip lines that can't match.
+  if (!nfa_dfa_may_match(prog, col)) {
+    goto theend;
+  }
+
   // Set the "nstate" used by nfa_regcomp() to zero to trigger an error when
   // it's accidentally used during execution.
   nstate = 0;
@@ -15425,6 +15913,7 @@ static regprog_T *nfa_regcomp(uint8_t *expr, int re_flags)
   prog->regflags = regflags;
   prog->engine = &nfa_regengine;
   prog->nstate = nstate;
+  prog->dfa = NULL;
   prog->has_zend = rex.nfa_has_zend;
   prog->has_backref = rex.nfa_has_backref;
   prog->nsubexp = regnpar;
@@ -15468,6 +15957,7 @@ static void nfa_regfree(regprog_T *prog)
     return;
   }
 
+  nfa_dfa_free(((nfa_regprog_T *)prog)->dfa);
   xfree(((nfa_regprog_T *)prog)->match_text);
   xfree(((nfa_regprog_T *)prog)->pattern);
   xfree(prog);
@@ -15603,6 +16093,10 @@ regprog_T *vim_regcomp(const char *expr_arg, int re_flags)
   // reg_iswordc() uses rex.reg_buf
   rex.reg_buf = curbuf;
 
+  if ((prog = regprog_cache_take(expr, re_flags)) != NULL) {
+    return prog;
+  }
+
   //
   // First try the NFA engine, unless backtracking was requested.
   //
@@ -15653,11 +16147,71 @@ regprog_T *vim_regcomp(const char *expr_arg, int re_flags)
 // Free a compiled regexp program, returned by vim_regcomp().
 void vim_regfree(regprog_T *prog)
 {
-  if (prog != NULL) {
+  if (prog != NULL && !regprog_cache_put(prog)) {
     prog->engine->regfree(prog);
   }
 }
 
+/// Whether a program compiled from "expr" can be reused for the same
+/// pattern.  Programs of the backtracking engine are not kept, compiling
+/// [[:keyword:]] and friends depends on the options of the current buffer.
+/// "~" depends on the previous substitute string.
+static bool regprog_cache_ok(const char *expr, int engine)
+{
+  return engine != BACKTRACKING_ENGINE && strchr(expr, '~') == NULL;
+}
+
+/// Take a program compiled from "expr" with "re_flags" out of the cache.
+/// Must be called after "regexp_engine" was set.
+///
+/// @return  NULL when there is none.
+static regprog_T *regprog_cache_take(const char *expr, int re_flags)
+{
+  get_cpo_flags();
+  // most recently freed first
+  for (int i = regprog_cache_len - 1; i >= 0; i--) {
+    regprog_cache_T *rc = &regprog_cache[i];
+    if (rc->re_flags == re_flags
+        && (int)rc->prog->re_engine == regexp_engine
+        && rc->cpo_lit == reg_cpo_lit
+        && rc->extmatch == reg_do_extmatch
+        && strcmp(((nfa_regprog_T *)rc->prog)->pattern, expr) == 0) {
+      regprog_T *prog = rc->prog;
+      regprog_cache_len--;
+      memmove(rc, rc + 1, (size_t)(regprog_cache_len - i) * sizeof(regprog_cache_T));
+      return prog;
+    }
+  }
+  return NULL;
+}
+
+/// Keep "prog", given to vim_regfree(), for when the same pattern is compiled
+/// again.  The least recently freed program is dropped when the cache is
+/// full.
+///
+/// @return  false when "prog" must be freed.
+static bool regprog_cache_put(regprog_T *prog)
+{
+  if (prog->engine != &nfa_regengine || prog->re_in_use
+      || !regprog_cache_ok(((nfa_regprog_T *)prog)->pattern, (int)prog->re_engine)) {
+    return false;
+  }
+  if (regprog_cache_len == REGPROG_CACHE_SIZE) {
+    regprog_T *old = regprog_cache[0].prog;
+    old->engine->regfree(old);
+    regprog_cache_len--;
+    memmove(regprog_cache, regprog_cache + 1, (size_t)regprog_cache_len * sizeof(regprog_cache_T));
+  }
+  get_cpo_flags();
+  regprog_cache[regprog_cache_len++] = (regprog_cache_T){
+    .prog = prog,
+    .re_flags = (int)prog->re_flags,
+    .cpo_lit = reg_cpo_lit,
+    .extmatch = reg_do_extmatch,
+  };
+  return true;
+}
+
 #if defined(EXITFREE)
 void free_regexp_stuff(void)
 {
@@ -15665,6 +16219,12 @@ void free_regexp_stuff(void)
   ga_clear(&backpos);
   xfree(reg_tofree);
   xfree(reg_prev_sub);
+  XFREE_CLEAR(nfa_list_cache[0].t);
+  XFREE_CLEAR(nfa_list_cache[1].t);
+  while (regprog_cache_len > 0) {
+    regprog_T *prog = regprog_cache[--regprog_cache_len].prog;
+    prog->engine->regfree(prog);
+  }
 }
 
 #endif
@@ -136,6 +136,7 @@ typedef struct {
   int reghasz;
   char *pattern;
   int nsubexp;                          // number of ()
+  struct nfa_dfa *dfa;                  // built when executing, see regexp.c
   int nstate;
   nfa_state_T state[];
 } nfa_regprog_T;
@@ -22,6 +22,7 @@
 #include "nvim/eval.h"
 #include "nvim/eval/typval.h"
 #include "nvim/eval/userfunc.h"
+#include "nvim/event/loop.h"
 #include "nvim/ex_cmds_defs.h"
 #include "nvim/ex_docmd.h"
 #include "nvim/ex_eval.h"
@@ -32,6 +33,7 @@
 #include "nvim/hashtab.h"
 #include "nvim/lua/executor.h"
 #include "nvim/macros.h"
+#include "nvim/main.h"
 #include "nvim/map.h"
 #include "nvim/mbyte.h"
 #include "nvim/memline.h"
@@ -43,6 +45,7 @@
 #include "nvim/os/input.h"
 #include "nvim/os/os.h"
 #include "nvim/os/stdpaths_defs.h"
+#include "nvim/os/time.h"
 #include "nvim/path.h"
 #include "nvim/profile.h"
 #include "nvim/regexp.h"
@@ -207,6 +210,7 @@ char *estack_sfile(estack_arg_T which)
 }
 
 static bool runtime_search_path_valid = false;
+static int runtime_search_path_gen = 0;
 static int *runtime_search_path_ref = NULL;
 static RuntimeSearchPath runtime_search_path;
 static RuntimeSearchPath runtime_search_path_thread;
@@ -279,11 +283,65 @@ void set_context_in_runtime_cmd(expand_T *xp, const char *arg)
   xp->xp_pattern = (char *)arg;
 }
 
+/// File names to read on the thread pool.
+typedef struct {
+  int num_fnames;
+  char **fnames;
+} prefetch_T;
+
+/// Read the files in the thread pool.  The text is thrown away, this only
+/// makes the system cache it.
+static void runtime_prefetch_work(void *data)
+{
+  prefetch_T *pf = data;
+  char buf[16 * 1024];
+
+  for (int i = 0; i < pf->num_fnames; i++) {
+    int fd = os_open(pf->fnames[i], O_RDONLY, 0);
+    if (fd < 0) {
+      continue;
+    }
+    bool eof = false;
+    while (!eof && os_read(fd, &eof, buf, sizeof(buf), false) > 0) {}
+    os_close(fd);
+  }
+}
+
+static void runtime_prefetch_done(void **argv)
+{
+  prefetch_T *pf = argv[0];
+  for (int i = 0; i < pf->num_fnames; i++) {
+    xfree(pf->fnames[i]);
+  }
+  xfree(pf->fnames);
+  xfree(pf);
+}
+
+/// Start reading all but the first of "fnames" in the background, so that
+/// sourcing them one after the other doesn't wait for the disk each time.
+static void runtime_prefetch(int num_fnames, char **fnames)
+{
+  if (num_fnames < 2) {
+    return;
+  }
+  prefetch_T *pf = xmalloc(sizeof(*pf));
+  pf->num_fnames = num_fnames - 1;
+  pf->fnames = xmalloc(sizeof(char *) * (size_t)pf->num_fnames);
+  for (int i = 0; i < pf->num_fnames; i++) {
+    pf->fnames[i] = xstrdup(fnames[i + 1]);
+  }
+  loop_queue_work(&main_loop, runtime_prefetch_work, runtime_prefetch_done, pf);
+}
+
 /// Source all .vim and .lua files in "fnames" with .vim files being sourced first.
 static bool source_callback_vim_lua(int num_fnames, char **fnames, bool all, void *cookie)
 {
   bool did_one = false;
 
+  if (all) {
+    runtime_prefetch(num_fnames, fnames);
+  }
+
   for (int i = 0; i < num_fnames; i++) {
     if (path_with_extension(fnames[i], "vim")) {
       (void)do_source(fnames[i], false, DOSO_NONE, cookie);
@@ -447,7 +505,8 @@ RuntimeSearchPath copy_runtime_search_path(const RuntimeSearchPath src)
   RuntimeSearchPath dst = KV_INITIAL_VALUE;
   for (size_t j = 0; j < kv_size(src); j++) {
     SearchPathItem src_item = kv_A(src, j);
-    kv_push(dst, ((SearchPathItem){ xstrdup(src_item.path), src_item.after, src_item.has_lua }));
+    kv_push(dst, ((SearchPathItem){ xstrdup(src_item.path), src_item.after, src_item.has_lua,
+                                    NULL, 0, 0 }));
   }
 
   return dst;
@@ -473,6 +532,63 @@ void runtime_search_path_unref(RuntimeSearchPath path, const int *ref)
 /// When "flags" has DIP_ERR: give an error message if there is no match.
 ///
 /// return FAIL when no file could be sourced, OK otherwise.
+/// Check whether "name" may exist in the directory of "item", using the
+/// names read from the directory when it was last looked at.  When "*checked"
+/// is false the modification time of the directory is checked first and
+/// "*checked" is set.
+///
+/// @return  false when "name" certainly doesn't exist.
+static bool search_path_item_may_have(SearchPathItem *item, const char *name, size_t len,
+                                      bool *checked)
+{
+  if (!*checked) {
+    *checked = true;
+    FileInfo file_info;
+    if (!os_fileinfo(item->path, &file_info)) {
+      XFREE_CLEAR(item->entries);
+      return true;
+    }
+    if (item->entries == NULL
+        || item->entries_sec != (int64_t)file_info.stat.st_mtim.tv_sec
+        || item->entries_nsec != (int64_t)file_info.stat.st_mtim.tv_nsec) {
+      XFREE_CLEAR(item->entries);
+      Directory dir;
+      if (!os_scandir(&dir, item->path)) {
+        return true;
+      }
+      garray_T ga;
+      ga_init(&ga, 1, 256);
+      ga_append(&ga, '\n');
+      const char *entry;
+      while ((entry = os_scandir_next(&dir)) != NULL) {
+        ga_concat(&ga, entry);
+        ga_append(&ga, '\n');
+      }
+      ga_append(&ga, NUL);
+      os_closedir(&dir);
+      if ((int64_t)file_info.stat.st_mtim.tv_sec >= (int64_t)os_time() - 1) {
+        // Just changed, the timestamp may not show another change soon.
+        ga_clear(&ga);
+        return true;
+      }
+      item->entries = ga.ga_data;
+      item->entries_sec = (int64_t)file_info.stat.st_mtim.tv_sec;
+      item->entries_nsec = (int64_t)file_info.stat.st_mtim.tv_nsec;
+    }
+  }
+  if (item->entries == NULL) {
+    return true;
+  }
+
+  for (const char *p = item->entries; (p = strstr(p, "\n")) != NULL;) {
+    p++;
+    if (path_fnamencmp(p, name, len) == 0 && p[len] == '\n') {
+      return true;
+    }
+  }
+  return false;
+}
+
 int do_in_cached_path(char *name, int flags, DoInRuntimepathCB callback, void *cookie)
 {
   char *tail;
@@ -495,6 +611,7 @@ int do_in_cached_path(char *name, int flags, DoInRuntimepathCB callback, void *c
   for (size_t j = 0; j < kv_size(path); j++) {
     SearchPathItem item = kv_A(path, j);
     size_t buflen = strlen(item.path);
+    bool checked = false;
 
     // Skip after or non-after directories.
     if (flags & (DIP_NOAFTER | DIP_AFTER)) {
@@ -519,6 +636,20 @@ int do_in_cached_path(char *name, int flags, DoInRuntimepathCB callback, void *c
         assert(MAXPATHL >= (tail - buf));
         copy_option_part(&np, tail, (size_t)(MAXPATHL - (tail - buf)), "\t ");
 
+        // Skip the pattern when its first directory isn't there, saves
+        // looking in it for every pattern.
+        char *sep = vim_strchr(tail, '/');
+        if (sep != NULL && sep > tail) {
+          char save = *sep;
+          *sep = NUL;
+          bool wild = path_has_wildcard(tail);
+          *sep = save;
+          if (!wild && !search_path_item_may_have(&kv_A(path, j), tail,
+                                                  (size_t)(sep - tail), &checked)) {
+            continue;
+          }
+        }
+
         if (p_verbose > 10) {
           verbose_enter();
           smsg(0, _("Searching for \"%s\""), buf);
@@ -809,6 +940,7 @@ void runtime_search_path_free(RuntimeSearchPath path)
   for (size_t j = 0; j < kv_size(path); j++) {
     SearchPathItem item = kv_A(path, j);
     xfree(item.path);
+    xfree(item.entries);
   }
   kv_destroy(path);
 }
@@ -828,6 +960,7 @@ void runtime_search_path_validate(void)
     }
     runtime_search_path = runtime_search_path_build();
     runtime_search_path_valid = true;
+    runtime_search_path_gen++;
     runtime_search_path_ref = NULL;  // initially unowned
     uv_mutex_lock(&runtime_search_path_mutex);
     runtime_search_path_free(runtime_search_path_thread);
@@ -836,6 +969,13 @@ void runtime_search_path_validate(void)
   }
 }
 
+/// @return  a number that changes whenever the runtime search path is rebuilt.
+int runtime_search_path_generation(void)
+{
+  runtime_search_path_validate();
+  return runtime_search_path_gen;
+}
+
 /// Just like do_in_path_and_pp(), using 'runtimepath' for "path".
 int do_in_runtimepath(char *name, int flags, DoInRuntimepathCB callback, void *cookie)
 {
@@ -1075,7 +1215,7 @@ static int load_pack_plugin(bool opt, char *fname)
 
   // If runtime/filetype.lua wasn't loaded yet, the scripts will be
   // found when it loads.
-  if (opt && eval_to_number(cmd) > 0) {
+  if (opt && eval_to_number(cmd, false) > 0) {
     do_cmdline_cmd("augroup filetypedetect");
     vim_snprintf(pat, len, ftpat, ffname);
     gen_expand_wildcards_and_cb(1, &pat, EW_FILE, true, source_callback_vim_lua, NULL);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "klib/kvec.h"
 #include "nvim/autocmd.h"
@@ -96,6 +97,9 @@ typedef struct {
   char *path;
   bool after;
   TriState has_lua;
+  char *entries;          ///< "\n"-separated names in "path", NULL if not read
+  int64_t entries_sec;    ///< mtime of "path" when "entries" was read
+  int64_t entries_nsec;
 } SearchPathItem;
 
 typedef kvec_t(SearchPathItem) RuntimeSearchPath;
@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "klib/kvec.h"
 #include "nvim/ascii.h"
 #include "nvim/autocmd.h"
 #include "nvim/buffer.h"
@@ -54,6 +55,33 @@
 #include "nvim/vim.h"
 #include "nvim/window.h"
 
+/// A match of the last search pattern, as counted for the search statistics.
+typedef struct {
+  pos_T start;
+  pos_T end;
+} searchstat_match_T;
+
+/// Matches of the last used search pattern in a buffer, for "[3/19]" and
+/// searchcount(), so that not every "n" has to search from the top.
+///
+/// Contains all matches that start at or before "scan_pos", in order.  When
+/// "complete" is true those are all matches in the buffer.  The matches are
+/// kept up-to-date by search_stat_changed(), lines "dirty_top" to "dirty_bot"
+/// (exclusive) have changed and must be searched again before use.
+typedef struct searchstat_index {
+  char *pat;                       ///< the pattern
+  bool ic;                         ///< 'ignorecase' when the matches were found
+  bool scs;                        ///< idem, 'smartcase'
+  bool magic;                      ///< idem, 'magic'
+  bool incremental;                ///< matches only depend on their own line
+  varnumber_T tick;                ///< b:changedtick the matches are for
+  bool complete;                   ///< found all matches in the buffer
+  pos_T scan_pos;                  ///< when not complete: continue after this
+  linenr_T dirty_top;              ///< first changed line or zero
+  linenr_T dirty_bot;              ///< line below the last changed line
+  kvec_t(searchstat_match_T) matches;
+} searchstat_index_T;
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "search.c.generated.h"
 #endif
@@ -1377,8 +1405,7 @@ int do_search(oparg_T *oap, int dirc, int search_delim, char *pat, int count, in
         && c != FAIL
         && !shortmess(SHM_SEARCHCOUNT)
         && msgbuf != NULL) {
-      cmdline_search_stat(dirc, &pos, &curwin->w_cursor,
-                          show_top_bot_msg, msgbuf,
+      cmdline_search_stat(dirc, &pos, show_top_bot_msg, msgbuf,
                           (count != 1 || has_offset
                            || (!(fdo_flags & FDO_SEARCH)
                                && hasFolding(curwin->w_cursor.lnum, NULL,
@@ -2582,13 +2609,12 @@ int linewhite(linenr_T lnum)
 
 /// Add the search count "[3/19]" to "msgbuf".
 /// See update_search_stat() for other arguments.
-static void cmdline_search_stat(int dirc, pos_T *pos, pos_T *cursor_pos, bool show_top_bot_msg,
-                                char *msgbuf, bool recompute, int maxcount, int timeout)
+static void cmdline_search_stat(int dirc, pos_T *pos, bool show_top_bot_msg, char *msgbuf,
+                                bool recompute, int maxcount, int timeout)
 {
   searchstat_T stat;
 
-  update_search_stat(dirc, pos, cursor_pos, &stat, recompute, maxcount,
-                     timeout);
+  update_search_stat(dirc, pos, &stat, recompute, maxcount, timeout);
   if (stat.cur <= 0) {
     return;
   }
@@ -2648,17 +2674,275 @@ static void cmdline_search_stat(int dirc, pos_T *pos, pos_T *cursor_pos, bool sh
   msg_hist_off = false;
 }
 
+/// Free the search statistics of buffer "buf".
+void search_stat_free(buf_T *buf)
+{
+  searchstat_index_T *idx = buf->b_search_stat;
+  if (idx == NULL) {
+    return;
+  }
+  kv_destroy(idx->matches);
+  xfree(idx->pat);
+  XFREE_CLEAR(buf->b_search_stat);
+}
+
+/// Whether matches of "pat" only depend on the text of the line where they
+/// start.  Then after a change only the changed lines need to be searched.
+/// Newlines, position items like "\%23l", look-behind and "\v" make the
+/// pattern look at other lines or are not recognized here.
+static bool search_stat_incremental(const char *pat)
+{
+  for (const char *p = pat; *p != NUL; p++) {
+    if (*p == '\\') {
+      p++;
+      if (*p == NUL) {
+        break;
+      }
+      if (vim_strchr("n_%@v", (uint8_t)(*p)) != NULL) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/// @return  index of the first match that starts in or after line "lnum".
+static size_t search_stat_find_line(searchstat_index_T *idx, linenr_T lnum)
+{
+  size_t lo = 0;
+  size_t hi = kv_size(idx->matches);
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (kv_A(idx->matches, mid).start.lnum < lnum) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/// @return  the number of matches, among the first "limit", that start at or
+///          before "pos".
+static size_t search_stat_find_pos(searchstat_index_T *idx, pos_T pos, size_t limit)
+{
+  size_t lo = 0;
+  size_t hi = limit;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (ltoreq(kv_A(idx->matches, mid).start, pos)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/// Update the search statistics of "buf" for a change: lines "lnum" to
+/// "lnume" (exclusive) were replaced with "lnume - lnum + xtra" lines.
+/// Must be called for every change, right after changed() incremented
+/// b:changedtick, otherwise the matches are found again from the top.
+void search_stat_changed(buf_T *buf, linenr_T lnum, linenr_T lnume, linenr_T xtra)
+{
+  searchstat_index_T *idx = buf->b_search_stat;
+  if (idx == NULL) {
+    return;
+  }
+  if (!idx->incremental || idx->tick + 1 != buf_get_changedtick(buf)) {
+    search_stat_free(buf);
+    return;
+  }
+  idx->tick = buf_get_changedtick(buf);
+
+  if (!idx->complete) {
+    // Only the matches before the changed lines are known to be valid,
+    // continue searching from there.
+    if (idx->scan_pos.lnum >= lnum) {
+      kv_size(idx->matches) = search_stat_find_line(idx, lnum);
+      idx->scan_pos = lnum > 1 ? (pos_T){ lnum - 1, MAXCOL, 0 } : (pos_T){ 0, 0, 0 };
+    }
+    return;
+  }
+
+  // Drop the matches in the changed lines and move the ones below.
+  size_t first = search_stat_find_line(idx, lnum);
+  size_t last = search_stat_find_line(idx, lnume);
+  if (last > first) {
+    memmove(&kv_A(idx->matches, first), &kv_A(idx->matches, last),
+            (kv_size(idx->matches) - last) * sizeof(searchstat_match_T));
+    kv_size(idx->matches) -= last - first;
+  }
+  if (xtra != 0) {
+    for (size_t i = first; i < kv_size(idx->matches); i++) {
+      kv_A(idx->matches, i).start.lnum += xtra;
+      kv_A(idx->matches, i).end.lnum += xtra;
+    }
+  }
+
+  // Remember the changed lines, together with previous changes.
+  linenr_T top = lnum;
+  linenr_T bot = lnume + xtra;
+  if (idx->dirty_top > 0) {
+#define ADJUST_LNUM(l) ((l) < lnum ? (l) : (l) >= lnume ? (l) + xtra : lnum)
+    linenr_T dtop = ADJUST_LNUM(idx->dirty_top);
+    linenr_T dbot = ADJUST_LNUM(idx->dirty_bot);
+#undef ADJUST_LNUM
+    if (dbot > dtop) {
+      if (top == bot) {
+        top = dtop;
+        bot = dbot;
+      } else {
+        top = MIN(top, dtop);
+        bot = MAX(bot, dbot);
+      }
+    }
+  }
+  if (bot > top) {
+    idx->dirty_top = top;
+    idx->dirty_bot = bot;
+  } else {
+    idx->dirty_top = idx->dirty_bot = 0;
+  }
+}
+
+/// Get the search statistics for the last search pattern in "buf".  Starts
+/// over when the pattern, the options or the text changed.
+static searchstat_index_T *search_stat_get(buf_T *buf)
+{
+  const char *pat = spats[last_idx].pat;
+  searchstat_index_T *idx = buf->b_search_stat;
+  if (idx != NULL
+      && (idx->tick != buf_get_changedtick(buf)
+          || strcmp(idx->pat, pat) != 0
+          || idx->ic != p_ic || idx->scs != p_scs || idx->magic != p_magic)) {
+    search_stat_free(buf);
+    idx = NULL;
+  }
+  if (idx == NULL) {
+    idx = xcalloc(1, sizeof(*idx));
+    idx->pat = xstrdup(pat);
+    idx->ic = p_ic;
+    idx->scs = p_scs;
+    idx->magic = p_magic;
+    idx->incremental = search_stat_incremental(pat);
+    idx->tick = buf_get_changedtick(buf);
+    buf->b_search_stat = idx;
+  }
+  return idx;
+}
+
+/// Find the next match of the last search pattern in the current buffer after
+/// "pos".  'wrapscan' must be off.
+static bool search_stat_next(pos_T *pos, pos_T *endpos)
+{
+  return searchit(curwin, curbuf, pos, endpos, FORWARD, NULL, 1, SEARCH_KEEP, RE_LAST,
+                  NULL) != FAIL;
+}
+
+/// Search the changed lines of "idx" again.
+///
+/// @param tm  time limit or NULL
+///
+/// @return  false when interrupted or out of time, the matches below the
+///          changed lines are dropped then.
+static bool search_stat_rescan(searchstat_index_T *idx, proftime_T *tm)
+{
+  linenr_T top = idx->dirty_top;
+  linenr_T bot = idx->dirty_bot;
+  idx->dirty_top = idx->dirty_bot = 0;
+
+  // Matches between two changes may still be there.
+  size_t at = search_stat_find_line(idx, top);
+  size_t end = search_stat_find_line(idx, bot);
+  if (end > at) {
+    memmove(&kv_A(idx->matches, at), &kv_A(idx->matches, end),
+            (kv_size(idx->matches) - end) * sizeof(searchstat_match_T));
+    kv_size(idx->matches) -= end - at;
+  }
+
+  kvec_t(searchstat_match_T) found = KV_INITIAL_VALUE;
+  pos_T pos = top > 1 ? (pos_T){ top - 1, MAXCOL, 0 } : (pos_T){ 0, 0, 0 };
+  bool ok = true;
+  while (true) {
+    pos_T p = pos;
+    pos_T endpos = { 0, 0, 0 };
+    if (!search_stat_next(&p, &endpos)) {
+      ok = !got_int;
+      break;
+    }
+    if (p.lnum >= bot) {
+      break;
+    }
+    kv_push(found, ((searchstat_match_T){ p, endpos }));
+    pos = p;
+    if (got_int || (tm != NULL && profile_passed_limit(*tm))) {
+      ok = false;
+      break;
+    }
+    fast_breakcheck();
+  }
+
+  if (!ok) {
+    // Keep what was found, continue searching from there next time.
+    kv_size(idx->matches) = at;
+    idx->complete = false;
+    idx->scan_pos = pos;
+  }
+  size_t nfound = kv_size(found);
+  if (nfound > 0) {
+    kv_ensure_space(idx->matches, nfound);
+    memmove(&kv_A(idx->matches, at + nfound), &kv_A(idx->matches, at),
+            (kv_size(idx->matches) - at) * sizeof(searchstat_match_T));
+    memcpy(&kv_A(idx->matches, at), found.items, nfound * sizeof(searchstat_match_T));
+    kv_size(idx->matches) += nfound;
+  }
+  kv_destroy(found);
+  return ok;
+}
+
+/// Continue searching for matches of "idx" until all are found or there are
+/// more than "maxcount".
+///
+/// @param tm  time limit or NULL
+///
+/// @return  false when interrupted or out of time.
+static bool search_stat_extend(searchstat_index_T *idx, int maxcount, proftime_T *tm)
+{
+  while (!idx->complete
+         && (maxcount <= 0 || kv_size(idx->matches) <= (size_t)maxcount)) {
+    pos_T p = idx->scan_pos;
+    pos_T endpos = { 0, 0, 0 };
+    if (!search_stat_next(&p, &endpos)) {
+      if (got_int) {
+        return false;
+      }
+      idx->complete = true;
+      break;
+    }
+    kv_push(idx->matches, ((searchstat_match_T){ p, endpos }));
+    idx->scan_pos = p;
+    if (got_int || (tm != NULL && profile_passed_limit(*tm))) {
+      return false;
+    }
+    fast_breakcheck();
+  }
+  return true;
+}
+
 // Add the search count information to "stat".
 // "stat" must not be NULL.
 // When "recompute" is true always recompute the numbers.
 // dirc == 0: don't find the next/previous match (only set the result to "stat")
 // dirc == '/': find the next match
 // dirc == '?': find the previous match
-static void update_search_stat(int dirc, pos_T *pos, pos_T *cursor_pos, searchstat_T *stat,
-                               bool recompute, int maxcount, int timeout)
+//
+// The matches are remembered per buffer and updated on changes, see
+// searchstat_index_T.
+static void update_search_stat(int dirc, pos_T *pos, searchstat_T *stat, bool recompute,
+                               int maxcount, int timeout)
 {
   int save_ws = p_ws;
-  bool wraparound = false;
   pos_T p = (*pos);
   static pos_T lastpos = { 0, 0, 0 };
   static int cur = 0;
@@ -2666,9 +2950,6 @@ static void update_search_stat(int dirc, pos_T *pos, pos_T *cursor_pos, searchst
   static bool exact_match = false;
   static int incomplete = 0;
   static int last_maxcount = SEARCH_STAT_DEF_MAX_COUNT;
-  static int chgtick = 0;
-  static char *lastpat = NULL;
-  static buf_T *lbuf = NULL;
 
   CLEAR_POINTER(stat);
 
@@ -2681,81 +2962,45 @@ static void update_search_stat(int dirc, pos_T *pos, pos_T *cursor_pos, searchst
     return;
   }
   last_maxcount = maxcount;
-  wraparound = ((dirc == '?' && lt(lastpos, p))
-                || (dirc == '/' && lt(p, lastpos)));
-
-  // If anything relevant changed the count has to be recomputed.
-  // STRNICMP ignores case, but we should not ignore case.
-  // Unfortunately, there is no STRNICMP function.
-  // XXX: above comment should be "no MB_STRCMP function" ?
-  if (!(chgtick == buf_get_changedtick(curbuf)
-        && lastpat != NULL  // suppress clang/NULL passed as nonnull parameter
-        && STRNICMP(lastpat, spats[last_idx].pat, strlen(lastpat)) == 0
-        && strlen(lastpat) == strlen(spats[last_idx].pat)
-        && equalpos(lastpos, *cursor_pos)
-        && lbuf == curbuf)
-      || wraparound || cur < 0 || (maxcount > 0 && cur > maxcount)
-      || recompute) {
-    cur = 0;
-    cnt = 0;
-    exact_match = false;
-    incomplete = 0;
-    clearpos(&lastpos);
-    lbuf = curbuf;
+
+  searchstat_index_T *idx = search_stat_get(curbuf);
+  proftime_T start;
+  proftime_T *tm = NULL;
+  if (timeout > 0) {
+    start = profile_setlimit(timeout);
+    tm = &start;
+  }
+  p_ws = false;
+  bool done = true;
+  if (idx->dirty_top > 0) {
+    done = search_stat_rescan(idx, tm);
   }
+  if (done) {
+    done = search_stat_extend(idx, maxcount, tm);
+  }
+  p_ws = save_ws;
 
-  // when searching backwards and having jumped to the first occurrence,
-  // cur must remain greater than 1
-  if (equalpos(lastpos, *cursor_pos) && !wraparound
-      && (dirc == 0 || dirc == '/' ? cur < cnt : cur > 1)) {
-    cur += dirc == 0 ? 0 : dirc == '/' ? 1 : -1;
+  size_t n = kv_size(idx->matches);
+  size_t limit = maxcount > 0 ? MIN(n, (size_t)maxcount + 1) : n;
+  size_t found = search_stat_find_pos(idx, p, limit);
+  cur = (int)found;
+  cnt = (int)limit;
+  exact_match = found > 0 && lt(p, kv_A(idx->matches, found - 1).end);
+  incomplete = !done ? 1 : (maxcount > 0 && n > (size_t)maxcount) ? 2 : 0;
+  if (got_int) {
+    cur = -1;  // abort
+  }
+  if (cnt > 0) {
+    lastpos = p;
   } else {
-    proftime_T start;
-    bool done_search = false;
-    pos_T endpos = { 0, 0, 0 };
-    p_ws = false;
-    if (timeout > 0) {
-      start = profile_setlimit(timeout);
-    }
-    while (!got_int && searchit(curwin, curbuf, &lastpos, &endpos,
-                                FORWARD, NULL, 1, SEARCH_KEEP, RE_LAST,
-                                NULL) != FAIL) {
-      done_search = true;
-      // Stop after passing the time limit.
-      if (timeout > 0 && profile_passed_limit(start)) {
-        incomplete = 1;
-        break;
-      }
-      cnt++;
-      if (ltoreq(lastpos, p)) {
-        cur = cnt;
-        if (lt(p, endpos)) {
-          exact_match = true;
-        }
-      }
-      fast_breakcheck();
-      if (maxcount > 0 && cnt > maxcount) {
-        incomplete = 2;    // max count exceeded
-        break;
-      }
-    }
-    if (got_int) {
-      cur = -1;  // abort
-    }
-    if (done_search) {
-      xfree(lastpat);
-      lastpat = xstrdup(spats[last_idx].pat);
-      chgtick = (int)buf_get_changedtick(curbuf);
-      lbuf = curbuf;
-      lastpos = p;
-    }
+    clearpos(&lastpos);
   }
+
   stat->cur = cur;
   stat->cnt = cnt;
   stat->exact_match = exact_match;
   stat->incomplete = incomplete;
   stat->last_maxcount = last_maxcount;
-  p_ws = save_ws;
 }
 
 // "searchcount()" function
@@ -2858,7 +3103,7 @@ void f_searchcount(typval_T *argvars, typval_T *rettv, EvalFuncData fptr)
     goto the_end;  // the previous pattern was never defined
   }
 
-  update_search_stat(0, &pos, &pos, &stat, recompute, maxcount, timeout);
+  update_search_stat(0, &pos, &stat, recompute, maxcount, timeout);
 
   tv_dict_add_nr(rettv->vval.v_dict, S_LEN("current"), stat.cur);
   tv_dict_add_nr(rettv->vval.v_dict, S_LEN("total"), stat.cnt);
@@ -2970,7 +3215,11 @@ static int fuzzy_match_compute_score(const char *const str, const int strSz,
   const int unmatched = strSz - numMatches;
   score += UNMATCHED_LETTER_PENALTY * unmatched;
 
-  // Apply ordering bonuses
+  // Apply ordering bonuses.  The matches are in increasing order, "p" is
+  // moved forward to the next match.
+  const char *p = str;
+  uint32_t sidx = 0;
+  int neighbor = ' ';
   for (int i = 0; i < numMatches; i++) {
     const uint32_t currIdx = matches[i];
 
@@ -2988,10 +3237,7 @@ static int fuzzy_match_compute_score(const char *const str, const int strSz,
     // Check for bonuses based on neighbor character value
     if (currIdx > 0) {
       // Camel case
-      const char *p = str;
-      int neighbor = ' ';
-
-      for (uint32_t sidx = 0; sidx < currIdx; sidx++) {
+      for (; sidx < currIdx; sidx++) {
         neighbor = utf_ptr2char(p);
         MB_PTR_ADV(p);
       }
@@ -3106,6 +3352,26 @@ static int fuzzy_match_recursive(const char *fuzpat, const char *str, uint32_t s
   return 0;  // no match
 }
 
+/// Quick check if all the characters of "fuzpat" appear in "str" in the
+/// same order, ignoring case.  Otherwise fuzzy_match_recursive() can't find a
+/// match, but it would try all the ways of matching a prefix first.
+static bool fuzzy_match_possible(const char *fuzpat, const char *str)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_WARN_UNUSED_RESULT FUNC_ATTR_PURE
+{
+  int c1 = mb_tolower(utf_ptr2char(fuzpat));
+  while (*str != NUL) {
+    if (mb_tolower(utf_ptr2char(str)) == c1) {
+      MB_PTR_ADV(fuzpat);
+      if (*fuzpat == NUL) {
+        return true;
+      }
+      c1 = mb_tolower(utf_ptr2char(fuzpat));
+    }
+    MB_PTR_ADV(str);
+  }
+  return *fuzpat == NUL;
+}
+
 /// fuzzy_match()
 ///
 /// Performs exhaustive search via recursion to find all possible matches and
@@ -3122,7 +3388,7 @@ bool fuzzy_match(char *const str, const char *const pat_arg, const bool matchseq
                  int *const outScore, uint32_t *const matches, const int maxMatches)
   FUNC_ATTR_NONNULL_ALL
 {
-  const int len = mb_charlen(str);
+  int len = -1;
   bool complete = false;
   int numMatches = 0;
 
@@ -3152,6 +3418,14 @@ bool fuzzy_match(char *const str, const char *const pat_arg, const bool matchseq
       *p = NUL;
     }
 
+    if (!fuzzy_match_possible(pat, str)) {
+      numMatches = 0;
+      break;
+    }
+    if (len < 0) {
+      len = mb_charlen(str);
+    }
+
     int score = 0;
     int recursionCount = 0;
     const int matchCount
@@ -3576,6 +3850,8 @@ void find_pattern_in_path(char *ptr, Direction dir, size_t len, bool whole, bool
   def_regmatch.regprog = NULL;
 
   char *file_line = xmalloc(LSIZE);
+  // Included files are often included from several files.
+  find_file_name_cache_start();
 
   if (type != CHECK_PATH && type != FIND_DEFINE
       // when CONT_SOL is set compare "ptr" with the beginning of the
@@ -4127,6 +4403,7 @@ exit_matched:
   }
 
 fpip_end:
+  find_file_name_cache_end();
   xfree(file_line);
   vim_regfree(regmatch.regprog);
   vim_regfree(incl_regmatch.regprog);
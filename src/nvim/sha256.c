@@ -18,6 +18,13 @@
 #include "nvim/sha256.h"
 #include "nvim/vim.h"
 
+// The SHA extensions of x86 CPUs are used when the CPU has them.
+#if defined(__x86_64__) && defined(__GNUC__)
+# define HAVE_SHA256_NI
+# include <cpuid.h>
+# include <immintrin.h>
+#endif
+
 #ifdef INCLUDE_GENERATED_DECLARATIONS
 # include "sha256.c.generated.h"
 #endif
@@ -177,6 +184,96 @@ static void sha256_process(context_sha256_T *ctx, const uint8_t data[SHA256_BUFF
   ctx->state[7] += H;
 }
 
+#ifdef HAVE_SHA256_NI
+static const uint32_t sha256_k[64] = {
+  0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+  0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+  0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+  0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+  0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+  0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+  0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+  0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+/// @return  true when the CPU has the SHA extensions (and SSSE3 and SSE4.1,
+///          which sha256_process_ni() also uses).
+static bool sha256_have_ni(void)
+{
+  static int have_ni = -1;
+  if (have_ni < 0) {
+    unsigned a, b, c, d;
+    have_ni = __get_cpuid(1, &a, &b, &c, &d)
+              && (c & bit_SSSE3) && (c & bit_SSE4_1)
+              && __get_cpuid_count(7, 0, &a, &b, &c, &d)
+              && (b & bit_SHA);
+  }
+  return have_ni;
+}
+
+/// Same as calling sha256_process() for "nblocks" blocks at "data", using the
+/// SHA extensions.
+__attribute__((target("sha,ssse3,sse4.1")))
+static void sha256_process_ni(context_sha256_T *ctx, const uint8_t *data, size_t nblocks)
+{
+  const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  // the instructions want the state as ABEF and CDGH
+  __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&ctx->state[0]), 0xB1);
+  __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&ctx->state[4]), 0x1B);
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+  for (; nblocks > 0; nblocks--, data += SHA256_BUFFER_SIZE) {
+    const __m128i abef = state0;
+    const __m128i cdgh = state1;
+    __m128i w[4];
+
+    // 16 groups of 4 rounds, w[i % 4] has the message words of group i
+    for (int i = 0; i < 16; i++) {
+      if (i < 4) {
+        w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * i)), bswap);
+      }
+      __m128i msg = _mm_add_epi32(w[i % 4], _mm_loadu_si128((const __m128i *)&sha256_k[4 * i]));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+      if (i >= 3 && i < 15) {
+        __m128i *next = &w[(i + 1) % 4];
+        *next = _mm_add_epi32(*next, _mm_alignr_epi8(w[i % 4], w[(i + 3) % 4], 4));
+        *next = _mm_sha256msg2_epu32(*next, w[i % 4]);
+      }
+      msg = _mm_shuffle_epi32(msg, 0x0E);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+      if (i >= 1 && i < 13) {
+        w[(i + 3) % 4] = _mm_sha256msg1_epu32(w[(i + 3) % 4], w[i % 4]);
+      }
+    }
+
+    state0 = _mm_add_epi32(state0, abef);
+    state1 = _mm_add_epi32(state1, cdgh);
+  }
+
+  // back to ABCD and EFGH
+  tmp = _mm_shuffle_epi32(state0, 0x1B);
+  state1 = _mm_shuffle_epi32(state1, 0xB1);
+  _mm_storeu_si128((__m128i *)&ctx->state[0], _mm_blend_epi16(tmp, state1, 0xF0));
+  _mm_storeu_si128((__m128i *)&ctx->state[4], _mm_alignr_epi8(state1, tmp, 8));
+}
+#endif
+
+/// Process "nblocks" blocks of SHA256_BUFFER_SIZE bytes at "data".
+static void sha256_process_blocks(context_sha256_T *ctx, const uint8_t *data, size_t nblocks)
+{
+#ifdef HAVE_SHA256_NI
+  if (sha256_have_ni()) {
+    sha256_process_ni(ctx, data, nblocks);
+    return;
+  }
+#endif
+  for (; nblocks > 0; nblocks--, data += SHA256_BUFFER_SIZE) {
+    sha256_process(ctx, data);
+  }
+}
+
 void sha256_update(context_sha256_T *ctx, const uint8_t *input, size_t length)
 {
   if (length == 0) {
@@ -196,16 +293,17 @@ void sha256_update(context_sha256_T *ctx, const uint8_t *input, size_t length)
 
   if (left && (length >= fill)) {
     memcpy(ctx->buffer + left, input, fill);
-    sha256_process(ctx, ctx->buffer);
+    sha256_process_blocks(ctx, ctx->buffer, 1);
     length -= fill;
     input += fill;
     left = 0;
   }
 
-  while (length >= SHA256_BUFFER_SIZE) {
-    sha256_process(ctx, input);
-    length -= SHA256_BUFFER_SIZE;
-    input += SHA256_BUFFER_SIZE;
+  if (length >= SHA256_BUFFER_SIZE) {
+    size_t nblocks = length / SHA256_BUFFER_SIZE;
+    sha256_process_blocks(ctx, input, nblocks);
+    length -= nblocks * SHA256_BUFFER_SIZE;
+    input += nblocks * SHA256_BUFFER_SIZE;
   }
 
   if (length) {
@@ -399,6 +399,16 @@ typedef struct sd_write_def {
 # include "shada.c.generated.h"
 #endif
 
+/// Buffers bigger than this are not kept for parsing the next item.
+#define ITEM_BUF_KEEP_SIZE (64 * 1024)
+
+/// Buffer and msgpack zone reused by shada_parse_msgpack() for the items that
+/// are not kept after parsing, so that reading a file with thousands of items
+/// does not allocate both each time.
+static char *item_buf = NULL;
+static size_t item_buf_size = 0;
+static msgpack_zone *item_zone = NULL;
+
 #define DEF_SDE(name, attr, ...) \
   [kSDItem##name] = { \
     .timestamp = 0, \
@@ -1836,6 +1846,10 @@ static int compare_file_marks(const void *a, const void *b)
 ///                            NULL if `ret_buf` is NULL.
 /// @param[out]  ret_buf       Buffer containing parsed string.
 ///
+/// If both `ret_unpacked` and `ret_buf` are not NULL, the results are only
+/// valid until shada_parse_msgpack_release() is called, which must be done
+/// before the next call.  Otherwise `ret_buf` is allocated.
+///
 /// @return kSDReadStatusNotShaDa, kSDReadStatusReadError or
 ///         kSDReadStatusSuccess.
 static inline ShaDaReadResult shada_parse_msgpack(ShaDaReadDef *const sd_reader,
@@ -1845,20 +1859,37 @@ static inline ShaDaReadResult shada_parse_msgpack(ShaDaReadDef *const sd_reader,
   FUNC_ATTR_WARN_UNUSED_RESULT FUNC_ATTR_NONNULL_ARG(1)
 {
   const uintmax_t initial_fpos = sd_reader->fpos;
-  char *const buf = xmalloc(length);
+  const bool keep_buf = ret_buf != NULL && ret_unpacked == NULL;
+  char *buf;
+  if (keep_buf) {
+    buf = xmalloc(length);
+  } else {
+    if (length > item_buf_size) {
+      xfree(item_buf);
+      item_buf_size = MAX(length, IOSIZE);
+      item_buf = xmalloc(item_buf_size);
+    }
+    buf = item_buf;
+  }
 
   const ShaDaReadResult fl_ret = fread_len(sd_reader, buf, length);
   if (fl_ret != kSDReadStatusSuccess) {
-    xfree(buf);
+    if (keep_buf) {
+      xfree(buf);
+    }
     return fl_ret;
   }
   bool did_try_to_free = false;
 shada_parse_msgpack_read_next: {}
   size_t off = 0;
-  msgpack_unpacked unpacked;
-  msgpack_unpacked_init(&unpacked);
-  const msgpack_unpack_return result =
-    msgpack_unpack_next(&unpacked, buf, length, &off);
+  msgpack_unpacked unpacked = { .zone = NULL };
+  if (item_zone == NULL) {
+    item_zone = msgpack_zone_new(MSGPACK_ZONE_CHUNK_SIZE);
+  }
+  const msgpack_unpack_return result = (item_zone == NULL
+                                        ? MSGPACK_UNPACK_NOMEM_ERROR
+                                        : msgpack_unpack(buf, length, &off, item_zone,
+                                                         &unpacked.data));
   ShaDaReadResult ret = kSDReadStatusSuccess;
   switch (result) {
   case MSGPACK_UNPACK_SUCCESS:
@@ -1875,6 +1906,7 @@ shada_parse_msgpack_read_next: {}
   case MSGPACK_UNPACK_NOMEM_ERROR:
     if (!did_try_to_free) {
       did_try_to_free = true;
+      shada_parse_msgpack_release();
       try_to_free_memory();
       goto shada_parse_msgpack_read_next;
     }
@@ -1897,19 +1929,48 @@ shada_parse_msgpack_extra_bytes:
   }
   if (ret_buf != NULL && ret == kSDReadStatusSuccess) {
     if (ret_unpacked == NULL) {
-      msgpack_unpacked_destroy(&unpacked);
+      shada_parse_msgpack_release();
     } else {
       *ret_unpacked = unpacked;
     }
     *ret_buf = buf;
   } else {
     assert(ret_buf == NULL || ret != kSDReadStatusSuccess);
-    msgpack_unpacked_destroy(&unpacked);
-    xfree(buf);
+    shada_parse_msgpack_release();
+    if (keep_buf) {
+      xfree(buf);
+    }
   }
   return ret;
 }
 
+/// Release the buffer and objects of the last item parsed with
+/// shada_parse_msgpack().
+static void shada_parse_msgpack_release(void)
+{
+  if (item_buf_size > ITEM_BUF_KEEP_SIZE) {
+    // The zone has grown as well.
+    XFREE_CLEAR(item_buf);
+    item_buf_size = 0;
+    if (item_zone != NULL) {
+      msgpack_zone_free(item_zone);
+      item_zone = NULL;
+    }
+  } else if (item_zone != NULL) {
+    msgpack_zone_clear(item_zone);
+  }
+}
+
+#ifdef EXITFREE
+void shada_free_all_mem(void)
+{
+  xfree(item_buf);
+  if (item_zone != NULL) {
+    msgpack_zone_free(item_zone);
+  }
+}
+#endif
+
 /// Format shada entry for debugging purposes
 ///
 /// @param[in]  entry  ShaDa entry to format.
@@ -2020,6 +2081,8 @@ static inline ShaDaWriteResult shada_read_when_writing(ShaDaReadDef *const sd_re
   ShaDaWriteResult ret = kSDWriteSuccessful;
   ShadaEntry entry;
   ShaDaReadResult srni_ret;
+  // Files usually have many marks, don't look up their buffer for each one.
+  PMap(cstr_t) fname_bufs = MAP_INIT;
 
 #define COMPARE_WITH_ENTRY(wms_entry_, entry) \
   do { \
@@ -2059,7 +2122,7 @@ static inline ShaDaWriteResult shada_read_when_writing(ShaDaReadDef *const sd_re
       ret = kSDWriteReadNotShada;
       FALLTHROUGH;
     case kSDReadStatusReadError:
-      return ret;
+      goto shada_read_when_writing_end;
     case kSDReadStatusMalformed:
       continue;
     }
@@ -2167,11 +2230,12 @@ static inline ShaDaWriteResult shada_read_when_writing(ShaDaReadDef *const sd_re
       break;
     case kSDItemChange:
     case kSDItemLocalMark: {
-      if (shada_removable(entry.data.filemark.fname)) {
+      const char *const fname = entry.data.filemark.fname;
+      // Only files that are not removable are in "wms->file_marks".
+      if (!map_has(cstr_t, &wms->file_marks, fname) && shada_removable(fname)) {
         shada_free_shada_entry(&entry);
         break;
       }
-      const char *const fname = entry.data.filemark.fname;
       cstr_t *key = NULL;
       ptr_t *val = pmap_put_ref(cstr_t)(&wms->file_marks, fname, &key, NULL);
       if (*val == NULL) {
@@ -2204,16 +2268,13 @@ static inline ShaDaWriteResult shada_read_when_writing(ShaDaReadDef *const sd_re
               shada_free_shada_entry(&wms_entry->data);
             }
           } else {
-            FOR_ALL_BUFFERS(buf) {
-              if (buf->b_ffname != NULL
-                  && path_fnamecmp(entry.data.filemark.fname, buf->b_ffname) == 0) {
-                fmark_T fm;
-                mark_get(buf, curwin, &fm, kMarkBufLocal, (int)entry.data.filemark.name);
-                if (fm.timestamp >= entry.timestamp) {
-                  set_wms = false;
-                  shada_free_shada_entry(&entry);
-                  break;
-                }
+            buf_T *buf = find_buffer(&fname_bufs, fname);
+            if (buf != NULL) {
+              fmark_T fm;
+              mark_get(buf, curwin, &fm, kMarkBufLocal, (int)entry.data.filemark.name);
+              if (fm.timestamp >= entry.timestamp) {
+                set_wms = false;
+                shada_free_shada_entry(&entry);
               }
             }
           }
@@ -2246,7 +2307,13 @@ static inline ShaDaWriteResult shada_read_when_writing(ShaDaReadDef *const sd_re
       break;
     }
   }
+shada_read_when_writing_end: {}
 #undef COMPARE_WITH_ENTRY
+  const char *key;
+  map_foreach_key(&fname_bufs, key, {
+    xfree((char *)key);
+  })
+  map_destroy(cstr_t, &fname_bufs);
   return ret;
 }
 
@@ -3138,8 +3205,19 @@ int shada_read_marks(void)
 /// @return OK in case of success, FAIL otherwise.
 int shada_read_everything(const char *const fname, const bool forceit, const bool missing_ok)
 {
+  // A buffer that did not read its marks yet reads them when it is loaded,
+  // see check_marks_read().  When this is true for all buffers, like at
+  // startup, skip the local marks and changes of all files.
+  bool want_marks = forceit;
+  FOR_ALL_BUFFERS(buf) {
+    if (buf->b_marks_read) {
+      want_marks = true;
+      break;
+    }
+  }
   return shada_read_file(fname,
-                         kShaDaWantInfo|kShaDaWantMarks|kShaDaGetOldfiles
+                         kShaDaWantInfo|kShaDaGetOldfiles
+                         |(want_marks ? kShaDaWantMarks : 0)
                          |(forceit ? kShaDaForceit : 0)
                          |(missing_ok ? 0 : kShaDaMissingError));
 }
@@ -3940,8 +4018,7 @@ shada_read_next_item_start:
   ret = kSDReadStatusSuccess;
 shada_read_next_item_end:
   if (buf != NULL) {
-    msgpack_unpacked_destroy(&unpacked);
-    xfree(buf);
+    shada_parse_msgpack_release();
   }
   return ret;
 shada_read_next_item_error:
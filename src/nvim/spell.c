@@ -204,6 +204,9 @@ char *e_format = N_("E759: Format error in spell file");
 char *repl_from = NULL;
 char *repl_to = NULL;
 
+// Incremented when cached spell_check() results become invalid.
+static int spell_cache_tick = 0;
+
 /// Main spell-checking function.
 /// "ptr" points to a character that could be the start of a word.
 /// "*attrp" is set to the highlight index for a badly spelled word.  For a
@@ -421,6 +424,99 @@ size_t spell_check(win_T *wp, char *ptr, hlf_T *attrp, int *capcol, bool docount
   return (size_t)(mi.mi_end - ptr);
 }
 
+/// Like spell_check(), but use the result cached in "sc" when the text at
+/// byte index "col" of the line was checked before with the same "capcol".
+/// When "sc" is NULL just call spell_check().
+/// Good words found in the cache are not counted again for "docount".
+size_t spell_check_cached(spellcache_T *sc, int col, win_T *wp, char *ptr, hlf_T *attrp,
+                          int *capcol, bool docount)
+{
+  if (sc == NULL) {
+    return spell_check(wp, ptr, attrp, capcol, docount);
+  }
+
+  const int capcol_in = capcol == NULL ? INT_MIN : *capcol;
+  const size_t n = kv_size(sc->sc_words);
+  for (size_t i = 0; i < n; i++) {
+    size_t idx = (sc->sc_idx + i) % n;
+    spellcache_word_T *scw = &kv_A(sc->sc_words, idx);
+    if (scw->scw_col == col && scw->scw_capcol_in == capcol_in) {
+      sc->sc_idx = idx + 1;
+      if (scw->scw_attr != HLF_COUNT) {
+        *attrp = scw->scw_attr;
+      }
+      if (capcol != NULL) {
+        *capcol = scw->scw_capcol;
+      }
+      return (size_t)scw->scw_len;
+    }
+  }
+
+  hlf_T attr = HLF_COUNT;
+  size_t len = spell_check(wp, ptr, &attr, capcol, docount);
+  if (attr != HLF_COUNT) {
+    *attrp = attr;
+  }
+  kv_push(sc->sc_words, ((spellcache_word_T) {
+    .scw_col = col,
+    .scw_capcol_in = capcol_in,
+    .scw_capcol = capcol == NULL ? 0 : *capcol,
+    .scw_len = (int)len,
+    .scw_attr = attr,
+  }));
+  sc->sc_idx = n + 1;
+  return len;
+}
+
+/// Find the cache entry for spell_check_cached() for the text "line", followed
+/// by "next", the start of the next line as concatenated by spell_cat_line().
+/// Clears the entry when it was used for other text or spell settings.
+spellcache_T *spell_cache_find(win_T *wp, const char *line, const char *next)
+  FUNC_ATTR_NONNULL_ALL FUNC_ATTR_NONNULL_RET
+{
+  synblock_T *synblock = wp->w_s;
+  if (synblock->b_spell_cache == NULL) {
+    synblock->b_spell_cache = xcalloc(SPELL_CACHE_SIZE, sizeof(spellcache_T));
+  }
+
+  const hash_T hash = hash_hash(line) * 31 + hash_hash(next);
+  spellcache_T *sc = &synblock->b_spell_cache[hash % SPELL_CACHE_SIZE];
+  if (sc->sc_line == NULL || sc->sc_tick != spell_cache_tick || sc->sc_hash != hash
+      || strcmp(sc->sc_line, line) != 0 || strcmp(sc->sc_next, next) != 0) {
+    xfree(sc->sc_line);
+    xfree(sc->sc_next);
+    sc->sc_line = xstrdup(line);
+    sc->sc_next = xstrdup(next);
+    sc->sc_hash = hash;
+    sc->sc_tick = spell_cache_tick;
+    kv_size(sc->sc_words) = 0;
+  }
+  sc->sc_idx = 0;
+  return sc;
+}
+
+/// Invalidate all spell_check_cached() results, after the spell settings or
+/// the word lists changed.
+void spell_cache_invalidate(void)
+{
+  spell_cache_tick++;
+}
+
+/// Free the spell_check_cached() results of "synblock".
+void spell_cache_free(synblock_T *synblock)
+{
+  if (synblock->b_spell_cache == NULL) {
+    return;
+  }
+  for (int i = 0; i < SPELL_CACHE_SIZE; i++) {
+    spellcache_T *sc = &synblock->b_spell_cache[i];
+    xfree(sc->sc_line);
+    xfree(sc->sc_next);
+    kv_destroy(sc->sc_words);
+  }
+  XFREE_CLEAR(synblock->b_spell_cache);
+}
+
 /// Determine the type of character "c".
 static int get_char_type(int c)
 {
@@ -1692,6 +1788,8 @@ void slang_clear(slang_T *lp)
 {
   garray_T *gap;
 
+  spell_cache_invalidate();
+
   XFREE_CLEAR(lp->sl_fbyts);
   XFREE_CLEAR(lp->sl_kbyts);
   XFREE_CLEAR(lp->sl_pbyts);
@@ -1940,6 +2038,8 @@ char *parse_spelllang(win_T *wp)
   char *ret_msg = NULL;
   char *spl_copy;
 
+  spell_cache_invalidate();
+
   bufref_T bufref;
   set_bufref(&bufref, wp->w_buffer);
 
@@ -2344,6 +2444,7 @@ void spell_free_all(void)
   // Go through all buffers and handle 'spelllang'. <VN>
   FOR_ALL_BUFFERS(buf) {
     ga_clear(&buf->b_s.b_langp);
+    spell_cache_free(&buf->b_s);
   }
 
   while (first_lang != NULL) {
@@ -3714,6 +3815,7 @@ const char *compile_cap_prog(synblock_T *synblock)
 {
   regprog_T *rp = synblock->b_cap_prog;
 
+  spell_cache_invalidate();
   if (synblock->b_p_spc == NULL || *synblock->b_p_spc == NUL) {
     synblock->b_cap_prog = NULL;
   } else {
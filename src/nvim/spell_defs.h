@@ -3,8 +3,11 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "klib/kvec.h"
 #include "nvim/buffer_defs.h"
 #include "nvim/garray.h"
+#include "nvim/hashtab.h"
+#include "nvim/highlight_defs.h"
 #include "nvim/regexp_defs.h"
 #include "nvim/types.h"
 
@@ -249,6 +252,28 @@ typedef struct wordcount_S {
 #define HI2WC(hi)    ((wordcount_T *)((hi)->hi_key - WC_KEY_OFF))
 #define MAXWORDCOUNT 0xffff
 
+// Number of lines for which spell_check() results are cached in a synblock_T.
+#define SPELL_CACHE_SIZE 256
+
+/// Result of one spell_check() call, see spell_check_cached().
+typedef struct {
+  int scw_col;                      ///< byte index of the checked text
+  int scw_capcol_in;                ///< "capcol" passed to spell_check()
+  int scw_capcol;                   ///< "capcol" set by spell_check()
+  int scw_len;                      ///< length returned by spell_check()
+  hlf_T scw_attr;                   ///< highlight, HLF_COUNT for a good word
+} spellcache_word_T;
+
+/// Cached spell_check() results for the text of one line.
+typedef struct spellcache_S {
+  int sc_tick;                      ///< value of "spell_cache_tick" when filled
+  hash_T sc_hash;                   ///< hash of sc_line and sc_next
+  char *sc_line;                    ///< text of the line
+  char *sc_next;                    ///< start of the next line, see win_line()
+  size_t sc_idx;                    ///< where to start looking in sc_words
+  kvec_t(spellcache_word_T) sc_words;
+} spellcache_T;
+
 // Remember what "z?" replaced.
 extern char *repl_from;
 extern char *repl_to;
@@ -76,6 +76,8 @@ typedef struct suginfo_S {
   char su_sal_badword[MAXWLEN];    ///< su_badword soundfolded
   hashtab_T su_banned;             ///< table with banned words
   slang_T *su_sallang;             ///< default language for sound folding
+  proftime_T su_time_limit;        ///< when to stop searching, "timeout:"
+  bool su_timed_out;               ///< stopped searching at su_time_limit
 } suginfo_T;
 
 /// One word suggestion.  Used in "si_ga".
@@ -725,6 +727,12 @@ static void spell_find_suggest(char *badptr, int badlen, suginfo_T *su, int maxc
   su->su_maxcount = maxcount;
   su->su_maxscore = SCORE_MAXINIT;
 
+  // Searching may take an indefinite amount of time.  Stop after some time
+  // for all the steps together and use the suggestions found so far.
+  if (spell_suggest_timeout > 0) {
+    su->su_time_limit = profile_setlimit(spell_suggest_timeout);
+  }
+
   if (su->su_badlen >= MAXWLEN) {
     su->su_badlen = MAXWLEN - 1;        // just in case
   }
@@ -1188,19 +1196,12 @@ static void suggest_trie_walk(suginfo_T *su, langp_T *lp, char *fword, bool soun
     }
   }
 
-  // The loop may take an indefinite amount of time. Break out after some
-  // time.
-  proftime_T time_limit = 0;
-  if (spell_suggest_timeout > 0) {
-    time_limit = profile_setlimit(spell_suggest_timeout);
-  }
-
   // Loop to find all suggestions.  At each round we either:
   // - For the current state try one operation, advance "ts_curi",
   //   increase "depth".
   // - When a state is done go to the next, set "ts_state".
   // - When all states are tried decrease "depth".
-  while (depth >= 0 && !got_int) {
+  while (depth >= 0 && !got_int && !su->su_timed_out) {
     sp = &stack[depth];
     switch (sp->ts_state) {
     case STATE_START:
@@ -2322,8 +2323,8 @@ static void suggest_trie_walk(suginfo_T *su, langp_T *lp, char *fword, bool soun
       if (--breakcheckcount == 0) {
         os_breakcheck();
         breakcheckcount = 1000;
-        if (spell_suggest_timeout > 0 && profile_passed_limit(time_limit)) {
-          got_int = true;
+        if (spell_suggest_timeout > 0 && profile_passed_limit(su->su_time_limit)) {
+          su->su_timed_out = true;
         }
       }
     }
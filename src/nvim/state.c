@@ -19,6 +19,8 @@
 #include "nvim/option.h"
 #include "nvim/option_vars.h"
 #include "nvim/os/input.h"
+#include "nvim/os/time.h"
+#include "nvim/profile.h"
 #include "nvim/state.h"
 #include "nvim/strings.h"
 #include "nvim/types.h"
@@ -108,6 +110,7 @@ getkey:
 /// otherwise bursts of events can block break checking indefinitely.
 void state_handle_k_event(void)
 {
+  const uint64_t start_time = os_hrtime();
   while (true) {
     Event event = multiqueue_get(main_loop.events);
     if (event.handler) {
@@ -117,16 +120,17 @@ void state_handle_k_event(void)
     if (multiqueue_empty(main_loop.events)) {
       // don't breakcheck before return, caller should return to main-loop
       // and handle input already.
-      return;
+      break;
     }
 
     // TODO(bfredl): as an further micro-optimization, we could check whether
     // event.handler already checked input.
     os_breakcheck();
     if (input_available() || got_int) {
-      return;
+      break;
     }
   }
+  stats_hist_add(&g_stats.event_batch, os_hrtime() - start_time);
 }
 
 /// Return true if in the current mode we need to use virtual.
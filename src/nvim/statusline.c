@@ -400,12 +400,14 @@ static void win_redr_custom(win_T *wp, bool draw_winbar, bool draw_ruler)
   ewp->w_p_crb = false;
 
   // Make a copy, because the statusline may include a function call that
-  // might change the option value and free the memory.
-  stl = xstrdup(stl);
+  // might change the option value and free the memory.  It is taken from an
+  // arena, which reuses freed blocks, as this is done for every redraw.
+  Arena arena = ARENA_EMPTY;
+  stl = arena_memdupz(&arena, stl, strlen(stl));
   build_stl_str_hl(ewp, buf, sizeof(buf), stl, opt_name, opt_scope,
                    fillchar, maxwidth, &hltab, &tabtab, NULL);
 
-  xfree(stl);
+  arena_mem_free(arena_finish(&arena));
   ewp->w_p_crb = p_crb_save;
 
   int len = (int)strlen(buf);
@@ -880,10 +882,12 @@ int build_statuscol_str(win_T *wp, linenr_T lnum, linenr_T relnum, statuscol_T *
   }
 
   StlClickRecord *clickrec;
-  char *stc = xstrdup(wp->w_p_stc);
+  // Copy from an arena: this is done for every drawn line.
+  Arena arena = ARENA_EMPTY;
+  char *stc = arena_memdupz(&arena, wp->w_p_stc, strlen(wp->w_p_stc));
   int width = build_stl_str_hl(wp, stcp->text, MAXPATHL, stc, "statuscolumn", OPT_LOCAL, ' ',
                                stcp->width, &stcp->hlrec, fillclick ? &clickrec : NULL, stcp);
-  xfree(stc);
+  arena_mem_free(arena_finish(&arena));
 
   if (fillclick) {
     stl_clear_click_defs(wp->w_statuscol_click_defs, wp->w_statuscol_click_defs_size);
@@ -971,7 +975,7 @@ int build_stl_str_hl(win_T *wp, char *out, size_t outlen, char *fmt, char *opt_n
     };
     set_var(S_LEN("g:statusline_winid"), &tv, false);
 
-    usefmt = eval_to_string_safe(fmt + 2, use_sandbox);
+    usefmt = eval_to_string_safe(fmt + 2, use_sandbox, true);
     if (usefmt == NULL) {
       usefmt = fmt;
     }
@@ -1447,7 +1451,7 @@ int build_stl_str_hl(win_T *wp, char *out, size_t outlen, char *fmt, char *opt_n
       }
 
       // Note: The result stored in `t` is unused.
-      str = eval_to_string_safe(out_p, use_sandbox);
+      str = eval_to_string_safe(out_p, use_sandbox, true);
 
       curwin = save_curwin;
       curbuf = save_curbuf;
@@ -40,6 +40,7 @@
 #include "nvim/profile.h"
 #include "nvim/regexp.h"
 #include "nvim/runtime.h"
+#include "nvim/spell.h"
 #include "nvim/strings.h"
 #include "nvim/syntax.h"
 #include "nvim/types.h"
@@ -88,6 +89,9 @@ typedef struct syn_pattern {
   int sp_sync_idx;                      // sync item index (syncing only)
   int sp_line_id;                       // ID of last line where tried
   int sp_startcol;                      // next match in sp_line_id line
+  bool sp_can_reuse;                    // sp_match can be used again
+  lpos_T sp_match_start;                // start of match in sp_line_id line
+  lpos_T sp_match_end;                  // end of match in sp_line_id line
   int16_t *sp_cont_list;                // cont. group IDs, if non-zero
   int16_t *sp_next_list;                // next group IDs, if non-zero
   struct sp_syn sp_syn;                 // struct passed to in_id_list()
@@ -271,6 +275,9 @@ static reg_extmatch_T *next_match_extmatch = NULL;
 #define INVALID_STATE(ssp)  ((ssp)->ga_itemsize == 0)
 #define VALID_STATE(ssp)    ((ssp)->ga_itemsize != 0)
 
+// Number of lines syntax_prefetch() parses before checking for typeahead.
+#define SYN_PREFETCH_LINES 20
+
 // The current state (within the line) of the recognition engine.
 // When current_state.ga_itemsize is 0 the current state is invalid.
 static win_T *syn_win;                  // current window for highlighting
@@ -461,6 +468,41 @@ void syntax_start(win_T *wp, linenr_T lnum)
   syn_start_line();
 }
 
+/// Parse the lines below the windows in the current tab page and store their
+/// syntax states, so that scrolling down does not need to parse them while
+/// redrawing.  Called when waiting for a character.  Stops when a character
+/// is available or after 'redrawtime'.
+void syntax_prefetch(void)
+{
+  if (must_redraw != 0) {
+    return;
+  }
+
+  proftime_T tm = profile_setlimit(p_rdt);
+  FOR_ALL_WINDOWS_IN_TAB(wp, curtab) {
+    if (!syntax_present(wp) || wp->w_s->b_syn_error || wp->w_s->b_syn_slow
+        || wp->w_buffer->b_mod_set) {
+      continue;
+    }
+    linenr_T last = MIN(wp->w_botline + wp->w_height_inner,
+                        wp->w_buffer->b_ml.ml_line_count);
+    for (linenr_T lnum = wp->w_botline; lnum < last;) {
+      if (os_char_avail() || profile_passed_limit(tm)) {
+        return;
+      }
+      lnum = MIN(lnum + SYN_PREFETCH_LINES, last);
+      const int save_did_emsg = did_emsg;
+      did_emsg = false;
+      syntax_start(wp, lnum);
+      if (did_emsg) {
+        wp->w_s->b_syn_error = true;
+        break;
+      }
+      did_emsg = save_did_emsg;
+    }
+  }
+}
+
 // We cannot simply discard growarrays full of state_items or buf_states; we
 // have to manually release their extmatch pointers first.
 static void clear_syn_state(synstate_T *p)
@@ -1659,18 +1701,33 @@ static int syn_current_attr(const bool syncing, const bool displaying, bool *con
                   && spp->sp_startcol >= next_match_col) {
                 continue;
               }
-              spp->sp_line_id = current_line_id;
 
               colnr_T lc_col = current_col - spp->sp_offsets[SPO_LC_OFF];
               if (lc_col < 0) {
                 lc_col = 0;
               }
 
-              regmatch.rmm_ic = spp->sp_ic;
-              regmatch.regprog = spp->sp_prog;
-              int r = syn_regexec(&regmatch, current_lnum, lc_col,
-                                  IF_SYN_TIME(&spp->sp_time));
-              spp->sp_prog = regmatch.regprog;
+              int r;
+              if (spp->sp_line_id == current_line_id
+                  && spp->sp_can_reuse
+                  && spp->sp_match_start.col >= lc_col) {
+                // The match found before starts at or after "lc_col",
+                // searching again would find the same one.
+                regmatch.startpos[0] = spp->sp_match_start;
+                regmatch.endpos[0] = spp->sp_match_end;
+                unref_extmatch(re_extmatch_out);
+                re_extmatch_out = NULL;
+                r = true;
+              } else {
+                regmatch.rmm_ic = spp->sp_ic;
+                regmatch.regprog = spp->sp_prog;
+                r = syn_regexec(&regmatch, current_lnum, lc_col,
+                                IF_SYN_TIME(&spp->sp_time));
+                spp->sp_prog = regmatch.regprog;
+                spp->sp_match_start = regmatch.startpos[0];
+                spp->sp_match_end = regmatch.endpos[0];
+              }
+              spp->sp_line_id = current_line_id;
               if (!r) {
                 // no match in this line, try another one
                 spp->sp_startcol = MAXCOL;
@@ -3007,6 +3064,7 @@ void reset_synblock(win_T *wp)
 {
   if (wp->w_s != &wp->w_buffer->b_s) {
     syntax_clear(wp->w_s);
+    spell_cache_free(wp->w_s);
     xfree(wp->w_s);
     wp->w_s = &wp->w_buffer->b_s;
   }
@@ -4736,6 +4794,9 @@ static char *get_syn_pattern(char *arg, synpat_T *ci)
   }
   // store the pattern and compiled regexp program
   ci->sp_pattern = xstrnsave(arg + 1, (size_t)(end - arg) - 1);
+  // With "\zs" the match may start after where the search started and
+  // "\z(" sets external submatches, a previous match can't be reused then.
+  ci->sp_can_reuse = strstr(ci->sp_pattern, "\\z") == NULL;
 
   // Make 'cpoptions' empty, to avoid the 'l' flag
   char *cpo_save = p_cpo;
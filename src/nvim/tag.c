@@ -107,6 +107,8 @@ static char *mt_names[MT_COUNT/2] =
 #define NOTAGFILE       99              // return value for jumpto_tag
 static char *nofile_fname = NULL;       // fname for NOTAGFILE error
 
+#define TAG_LINEAR_BUFSIZE (64 * 1024)  // stdio buffer for a linear search
+
 /// Return values used when reading lines from a tags file.
 typedef enum {
   TAGS_READ_SUCCESS = 1,
@@ -2187,6 +2189,14 @@ static void findtags_in_file(findtags_state_T *st, int flags, char *buf_ffname)
     return;
   }
 
+  // A linear search, which is also used when ignoring case, reads the whole
+  // file.  Use a bigger buffer than the default to need fewer read() calls.
+  char *iobuf = NULL;
+  if (st->linear || st->orgpat->regmatch.rm_ic) {
+    iobuf = xmalloc(TAG_LINEAR_BUFSIZE);
+    setvbuf(st->fp, iobuf, _IOFBF, TAG_LINEAR_BUFSIZE);
+  }
+
   if (p_verbose >= 5) {
     verbose_enter();
     smsg(0, _("Searching tags file %s"), st->tag_fname);
@@ -2203,6 +2213,7 @@ static void findtags_in_file(findtags_state_T *st, int flags, char *buf_ffname)
     fclose(st->fp);
     st->fp = NULL;
   }
+  xfree(iobuf);
   if (st->vimconv.vc_type != CONV_NONE) {
     convert_setup(&st->vimconv, NULL, NULL);
   }
@@ -2445,6 +2456,9 @@ findtag_end:
 }
 
 static garray_T tag_fnames = GA_EMPTY_INIT_VALUE;
+/// runtime_search_path_generation() for which "tag_fnames" was found, -1 when
+/// it has to be found again.
+static int tag_fnames_gen = -1;
 
 // Callback function for finding all "tags" and "tags-??" files in
 // 'runtimepath' doc directories.
@@ -2499,11 +2513,15 @@ int get_tagfname(tagname_T *tnp, int first, char *buf)
     // For help files it's done in a completely different way:
     // Find "doc/tags" and "doc/tags-??" in all directories in
     // 'runtimepath'.
-    if (first) {
+    // The list is kept until 'runtimepath' changes or help tags are
+    // generated, to avoid searching all directories for every query.
+    int gen = runtime_search_path_generation();
+    if (first && gen != tag_fnames_gen) {
       ga_clear_strings(&tag_fnames);
       ga_init(&tag_fnames, (int)sizeof(char *), 10);
       do_in_runtimepath("doc/tags doc/tags-??", DIP_ALL,
                         found_tagfile_cb, NULL);
+      tag_fnames_gen = gen;
     }
 
     if (tnp->tn_hf_idx >= tag_fnames.ga_len) {
@@ -2593,7 +2611,12 @@ void tagname_free(tagname_T *tnp)
   xfree(tnp->tn_tags);
   vim_findfile_cleanup(tnp->tn_search_ctx);
   tnp->tn_search_ctx = NULL;
-  ga_clear_strings(&tag_fnames);
+}
+
+/// Find the help tags files again on the next help tag search.
+void tag_fnames_invalidate(void)
+{
+  tag_fnames_gen = -1;
 }
 
 /// Parse one line from the tags file. Find start/end of tag name, start/end of
@@ -119,7 +119,8 @@ struct terminal {
   //  - receive data from libvterm as a result of key presses.
   char textbuf[0x1fff];
 
-  ScrollbackLine **sb_buffer;       // Scrollback storage.
+  ScrollbackLine **sb_buffer;       // Scrollback storage, a ring buffer (see sb_idx()).
+  size_t sb_start;                  // Index in sb_buffer of the most recent row.
   size_t sb_current;                // Lines stored in sb_buffer.
   size_t sb_size;                   // Capacity of sb_buffer.
   // "virtual index" that points to the first sb_buffer row that we need to
@@ -144,7 +145,9 @@ struct terminal {
 
   // some vterm properties
   bool forward_mouse;
-  int invalid_start, invalid_end;   // invalid rows in libvterm screen
+  int invalid_start, invalid_end;   // range of invalid rows in libvterm screen
+  bool *invalid_rows;               // invalid rows within that range
+  size_t invalid_rows_size;         // allocated size of invalid_rows
   struct {
     int row, col;
     bool visible;
@@ -226,8 +229,9 @@ void terminal_open(Terminal **termpp, buf_T *buf, TerminalOptions opts)
   vterm_output_set_callback(rv->vt, term_output_callback, rv);
   // force a initial refresh of the screen to ensure the buffer will always
   // have as many lines as screen rows when refresh_scrollback is called
-  rv->invalid_start = 0;
-  rv->invalid_end = opts.height;
+  rv->invalid_start = INT_MAX;
+  rv->invalid_end = -1;
+  invalidate_rows(rv, 0, opts.height);
 
   aco_save_T aco;
   aucmd_prepbuf(&aco, buf);
@@ -670,9 +674,10 @@ void terminal_destroy(Terminal **termpp)
       set_del(ptr_t, &invalidated_terminals, term);
     }
     for (size_t i = 0; i < term->sb_current; i++) {
-      xfree(term->sb_buffer[i]);
+      xfree(term->sb_buffer[sb_idx(term, i)]);
     }
     xfree(term->sb_buffer);
+    xfree(term->invalid_rows);
     xfree(term->title);
     vterm_free(term->vt);
     xfree(term);
@@ -989,6 +994,15 @@ static int term_bell(void *data)
   return 1;
 }
 
+/// Gets the index in sb_buffer of scrollback row "i", 0 being the most recent row.
+///
+/// Rows are stored as a ring, so that pushing and popping a row does not need
+/// to move the whole scrollback, which is slow with a large 'scrollback'.
+static inline size_t sb_idx(Terminal *term, size_t i)
+{
+  return (term->sb_start + i) % term->sb_size;
+}
+
 /// Scrollback push handler: called just before a line goes offscreen (and libvterm will forget it),
 /// giving us a chance to store it.
 ///
@@ -1005,20 +1019,13 @@ static int term_sb_push(int cols, const VTermScreenCell *cells, void *data)
   size_t c = (size_t)cols;
   ScrollbackLine *sbrow = NULL;
   if (term->sb_current == term->sb_size) {
-    if (term->sb_buffer[term->sb_current - 1]->cols == c) {
+    ScrollbackLine *oldest = term->sb_buffer[sb_idx(term, term->sb_current - 1)];
+    if (oldest->cols == c) {
       // Recycle old row if it's the right size
-      sbrow = term->sb_buffer[term->sb_current - 1];
+      sbrow = oldest;
     } else {
-      xfree(term->sb_buffer[term->sb_current - 1]);
+      xfree(oldest);
     }
-
-    // Make room at the start by shifting to the right.
-    memmove(term->sb_buffer + 1, term->sb_buffer,
-            sizeof(term->sb_buffer[0]) * (term->sb_current - 1));
-  } else if (term->sb_current > 0) {
-    // Make room at the start by shifting to the right.
-    memmove(term->sb_buffer + 1, term->sb_buffer,
-            sizeof(term->sb_buffer[0]) * term->sb_current);
   }
 
   if (!sbrow) {
@@ -1026,8 +1033,10 @@ static int term_sb_push(int cols, const VTermScreenCell *cells, void *data)
     sbrow->cols = c;
   }
 
-  // New row is added at the start of the storage buffer.
-  term->sb_buffer[0] = sbrow;
+  // New row is added at the start of the storage buffer.  If it is full, this
+  // is the slot of the oldest row.
+  term->sb_start = (term->sb_start + term->sb_size - 1) % term->sb_size;
+  term->sb_buffer[sb_idx(term, 0)] = sbrow;
   if (term->sb_current < term->sb_size) {
     term->sb_current++;
   }
@@ -1059,11 +1068,9 @@ static int term_sb_pop(int cols, VTermScreenCell *cells, void *data)
     term->sb_pending--;
   }
 
-  ScrollbackLine *sbrow = term->sb_buffer[0];
+  ScrollbackLine *sbrow = term->sb_buffer[sb_idx(term, 0)];
   term->sb_current--;
-  // Forget the "popped" row by shifting the rest onto it.
-  memmove(term->sb_buffer, term->sb_buffer + 1,
-          sizeof(term->sb_buffer[0]) * (term->sb_current));
+  term->sb_start = (term->sb_start + 1) % term->sb_size;
 
   size_t cols_to_copy = (size_t)cols;
   if (cols_to_copy > sbrow->cols) {
@@ -1548,7 +1555,7 @@ static void fetch_row(Terminal *term, int row, int end_col)
 static bool fetch_cell(Terminal *term, int row, int col, VTermScreenCell *cell)
 {
   if (row < 0) {
-    ScrollbackLine *sbrow = term->sb_buffer[-row - 1];
+    ScrollbackLine *sbrow = term->sb_buffer[sb_idx(term, (size_t)(-row - 1))];
     if ((size_t)col < sbrow->cols) {
       *cell = sbrow->cells[col];
     } else {
@@ -1566,12 +1573,30 @@ static bool fetch_cell(Terminal *term, int row, int col, VTermScreenCell *cell)
   return true;
 }
 
+/// Marks rows "start_row" to "end_row" (exclusive) for refresh_screen().
+static void invalidate_rows(Terminal *term, int start_row, int end_row)
+{
+  start_row = MAX(start_row, 0);
+  if (start_row >= end_row) {
+    return;
+  }
+  if ((size_t)end_row > term->invalid_rows_size) {
+    size_t new_size = MAX((size_t)end_row, term->invalid_rows_size * 2);
+    term->invalid_rows = xrealloc(term->invalid_rows, new_size * sizeof(bool));
+    memset(term->invalid_rows + term->invalid_rows_size, 0,
+           (new_size - term->invalid_rows_size) * sizeof(bool));
+    term->invalid_rows_size = new_size;
+  }
+  memset(term->invalid_rows + start_row, true, (size_t)(end_row - start_row) * sizeof(bool));
+  term->invalid_start = MIN(term->invalid_start, start_row);
+  term->invalid_end = MAX(term->invalid_end, end_row);
+}
+
 // queue a terminal instance for refresh
 static void invalidate_terminal(Terminal *term, int start_row, int end_row)
 {
   if (start_row != -1 && end_row != -1) {
-    term->invalid_start = MIN(term->invalid_start, start_row);
-    term->invalid_end = MAX(term->invalid_end, end_row);
+    invalidate_rows(term, start_row, end_row);
   }
 
   set_put(ptr_t, &invalidated_terminals, term);
@@ -1633,8 +1658,7 @@ static void refresh_size(Terminal *term, buf_T *buf)
   term->pending_resize = false;
   int width, height;
   vterm_get_size(term->vt, &height, &width);
-  term->invalid_start = 0;
-  term->invalid_end = height;
+  invalidate_rows(term, 0, height);
   term->opts.resize_cb((uint16_t)width, (uint16_t)height, term->opts.data);
 }
 
@@ -1664,15 +1688,20 @@ static void adjust_scrollback(Terminal *term, buf_T *buf)
     for (size_t i = 0; i < diff; i++) {
       ml_delete(1, false);
       term->sb_current--;
-      xfree(term->sb_buffer[term->sb_current]);
+      xfree(term->sb_buffer[sb_idx(term, term->sb_current)]);
     }
     deleted_lines(1, (linenr_T)diff);
   }
 
-  // Resize the scrollback storage.
-  size_t sb_region = sizeof(ScrollbackLine *) * scbk;
+  // Resize the scrollback storage, moving the most recent row to the start.
   if (scbk != term->sb_size) {
-    term->sb_buffer = xrealloc(term->sb_buffer, sb_region);
+    ScrollbackLine **sb_buffer = xmalloc(sizeof(ScrollbackLine *) * scbk);
+    for (size_t i = 0; i < term->sb_current; i++) {
+      sb_buffer[i] = term->sb_buffer[sb_idx(term, i)];
+    }
+    xfree(term->sb_buffer);
+    term->sb_buffer = sb_buffer;
+    term->sb_start = 0;
   }
 
   term->sb_size = scbk;
@@ -1695,21 +1724,36 @@ static void refresh_scrollback(Terminal *term, buf_T *buf)
   }
 
   row_offset -= term->sb_pending;
-  while (term->sb_pending > 0) {
+  if (term->sb_pending > 0) {
     // This means that either the window height has decreased or the screen
-    // became full and libvterm had to push all rows up. Convert the first
-    // pending scrollback row into a string and append it just above the visible
-    // section of the buffer
-    if (((int)buf->b_ml.ml_line_count - height) >= (int)term->sb_size) {
-      // scrollback full, delete lines at the top
+    // became full and libvterm had to push all rows up. Convert the pending
+    // scrollback rows into strings and append them just above the visible
+    // section of the buffer. This is done in one go, as after a burst of
+    // output there can be as many rows as 'scrollback', and updating marks
+    // for each line separately is slow.
+    int count = term->sb_pending;
+    int sb_lines = (int)buf->b_ml.ml_line_count - height;
+    // scrollback full, delete lines at the top
+    int del = MIN(count, MAX(sb_lines + count - (int)term->sb_size, 0));
+    for (int i = 0; i < del; i++) {
       ml_delete(1, false);
-      deleted_lines(1, 1);
     }
-    fetch_row(term, -term->sb_pending - row_offset, width);
+    if (del > 0) {
+      deleted_lines(1, del);
+    }
+
+    Arena arena = ARENA_EMPTY;
+    char **lines = xmalloc((size_t)count * sizeof(char *));
+    for (int i = 0; i < count; i++) {
+      fetch_row(term, -term->sb_pending - row_offset, width);
+      lines[i] = arena_memdupz(&arena, term->textbuf, strlen(term->textbuf));
+      term->sb_pending--;
+    }
     int buf_index = (int)buf->b_ml.ml_line_count - height;
-    ml_append(buf_index, term->textbuf, 0, false);
-    appended_lines(buf_index, 1);
-    term->sb_pending--;
+    ml_append_buf_lines(buf, buf_index, lines, count, false);
+    appended_lines(buf_index, count);
+    xfree(lines);
+    arena_mem_free(arena_finish(&arena));
   }
 
   // Remove extra lines at the bottom
@@ -1727,23 +1771,32 @@ static void refresh_scrollback(Terminal *term, buf_T *buf)
 static void refresh_screen(Terminal *term, buf_T *buf)
 {
   assert(buf == curbuf);  // TODO(bfredl): remove this condition
-  int changed = 0;
-  int added = 0;
   int height;
   int width;
   vterm_get_size(term->vt, &height, &width);
+  int invalid_end = term->invalid_end;
   // Terminal height may have decreased before `invalid_end` reflects it.
   term->invalid_end = MIN(term->invalid_end, height);
 
-  // There are no invalid rows.
-  if (term->invalid_start >= term->invalid_end) {
-    term->invalid_start = INT_MAX;
-    term->invalid_end = -1;
-    return;
-  }
-
+  // Only fetch the rows that were invalidated, a cursor move and a changed
+  // status line at the bottom should not rewrite the whole screen. Each run
+  // of consecutive changed rows is reported with changed_lines().
+  int run_start = 0;
+  int changed = 0;
+  int added = 0;
   for (int r = term->invalid_start, linenr = row_to_linenr(term, r);
        r < term->invalid_end; r++, linenr++) {
+    // The buffer must not get a gap, always append missing rows.
+    if (!term->invalid_rows[r] && linenr <= buf->b_ml.ml_line_count) {
+      if (changed + added > 0) {
+        changed_lines(buf, run_start, 0, run_start + changed, added, true);
+        changed = added = 0;
+      }
+      continue;
+    }
+    if (changed + added == 0) {
+      run_start = linenr;
+    }
     fetch_row(term, r, width);
 
     if (linenr <= buf->b_ml.ml_line_count) {
@@ -1754,10 +1807,14 @@ static void refresh_screen(Terminal *term, buf_T *buf)
       added++;
     }
   }
+  if (changed + added > 0) {
+    changed_lines(buf, run_start, 0, run_start + changed, added, true);
+  }
 
-  int change_start = row_to_linenr(term, term->invalid_start);
-  int change_end = change_start + changed;
-  changed_lines(buf, change_start, 0, change_end, added, true);
+  if (term->invalid_start < invalid_end) {
+    memset(term->invalid_rows + term->invalid_start, false,
+           (size_t)(invalid_end - term->invalid_start) * sizeof(bool));
+  }
   term->invalid_start = INT_MAX;
   term->invalid_end = -1;
 }
@@ -887,7 +887,7 @@ int fex_format(linenr_T lnum, long count, int c)
   if (use_sandbox) {
     sandbox++;
   }
-  int r = (int)eval_to_number(fex);
+  int r = (int)eval_to_number(fex, true);
   if (use_sandbox) {
     sandbox--;
   }
@@ -929,6 +929,8 @@ void format_lines(linenr_T line_count, bool avoid_fex)
 
   // length of a line to force formatting: 3 * 'tw'
   const int max_len = comp_textwidth(true) * 3;
+  // length the joined line must exceed before formatting it again
+  size_t force_len = (size_t)max_len;
 
   // check for 'q', '2', 'n' and 'w' in 'formatoptions'
   const bool do_comments = has_format_option(FO_Q_COMS);  // format comments
@@ -1074,6 +1076,12 @@ void format_lines(linenr_T line_count, bool avoid_fex)
         State = old_State;
         p_smd = smd_save;
         second_indent = -1;
+        // When the line could not be broken (e.g. a very long word), don't
+        // scan it again for every joined line, only after another "max_len"
+        // bytes were added.  This avoids quadratic behavior.
+        size_t len = strlen(get_cursor_line_ptr());
+        force_len = (!is_end_par && len > (size_t)max_len) ? len + (size_t)max_len
+                                                            : (size_t)max_len;
         // at end of par.: need to set indent of next par.
         need_set_indent = is_end_par;
         if (is_end_par) {
@@ -1114,7 +1122,7 @@ void format_lines(linenr_T line_count, bool avoid_fex)
         }
         first_par_line = false;
         // If the line is getting long, format it next time
-        if (strlen(get_cursor_line_ptr()) > (size_t)max_len) {
+        if (strlen(get_cursor_line_ptr()) > force_len) {
           force_format = true;
         } else {
           force_format = false;
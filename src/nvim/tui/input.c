@@ -27,6 +27,9 @@
 
 #define READ_STREAM_SIZE 0xfff
 #define KEY_BUFFER_SIZE 0xfff
+/// Pasted text is sent in chunks of about this size while the terminal keeps
+/// the read buffer full, instead of one nvim_paste call per read.
+#define PASTE_CHUNK_SIZE (1024 * 1024)
 
 static const struct kitty_key_map_entry {
   int key;
@@ -158,6 +161,7 @@ void tinput_destroy(TermInput *input)
 {
   map_destroy(int, &kitty_key_map);
   rbuffer_free(input->key_buffer);
+  kv_destroy(input->paste_buf);
   time_watcher_close(&input->timer_handle, NULL);
   stream_close(&input->read_stream, NULL, NULL);
   termkey_destroy(input->tk);
@@ -184,20 +188,19 @@ static void tinput_done_event(void **argv)
 static void tinput_flush(TermInput *input)
 {
   if (input->paste) {  // produce exactly one paste event
-    const size_t len = rbuffer_size(input->key_buffer);
-    String keys = { .data = xmallocz(len), .size = len };
-    rbuffer_read(input->key_buffer, keys.data, len);
+    tinput_paste_take(input);
+    const size_t len = kv_size(input->paste_buf);
+    String keys = { .data = len ? input->paste_buf.items : "", .size = len };
     MAXSIZE_TEMP_ARRAY(args, 3);
     ADD_C(args, STRING_OBJ(keys));  // 'data'
     ADD_C(args, BOOLEAN_OBJ(true));  // 'crlf'
     ADD_C(args, INTEGER_OBJ(input->paste));  // 'phase'
     rpc_send_event(ui_client_channel_id, "nvim_paste", args);
-    api_free_string(keys);
+    kv_size(input->paste_buf) = 0;
     if (input->paste == 1) {
       // Paste phase: "continue"
       input->paste = 2;
     }
-    rbuffer_reset(input->key_buffer);
   } else {  // enqueue input
     RBUFFER_UNTIL_EMPTY(input->key_buffer, buf, len) {
       const String keys = { .data = buf, .size = len };
@@ -206,19 +209,34 @@ static void tinput_flush(TermInput *input)
       // NOTE: This is non-blocking and won't check partially processed input,
       // but should be fine as all big sends are handled with nvim_paste, not nvim_input
       rpc_send_event(ui_client_channel_id, "nvim_input", args);
+      tui_latency_input(input->tui_data);
       rbuffer_consumed(input->key_buffer, len);
       rbuffer_reset(input->key_buffer);
     }
   }
 }
 
+/// Move pasted text from the key buffer to the paste buffer.
+static void tinput_paste_take(TermInput *input)
+{
+  RBUFFER_UNTIL_EMPTY(input->key_buffer, buf, len) {
+    kv_concat_len(input->paste_buf, buf, len);
+    rbuffer_consumed(input->key_buffer, len);
+  }
+  rbuffer_reset(input->key_buffer);
+}
+
 static void tinput_enqueue(TermInput *input, char *buf, size_t size)
 {
   if (rbuffer_size(input->key_buffer) >
       rbuffer_capacity(input->key_buffer) - 0xff) {
     // don't ever let the buffer get too full or we risk putting incomplete keys
     // into it
-    tinput_flush(input);
+    if (input->paste && kv_size(input->paste_buf) < PASTE_CHUNK_SIZE) {
+      tinput_paste_take(input);
+    } else {
+      tinput_flush(input);
+    }
   }
   rbuffer_write(input->key_buffer, buf, size);
 }
@@ -717,8 +735,17 @@ static void tinput_read_cb(Stream *stream, RBuffer *buf, size_t count_, void *da
     return;
   }
 
+  // A full read buffer means the terminal has more to send.  While pasting,
+  // keep collecting the text then, so that it is sent in large chunks.
+  bool more = rbuffer_space(buf) == 0;
   handle_raw_buffer(input, false);
-  tinput_flush(input);
+  if (!input->paste || !more) {
+    tinput_flush(input);
+  } else if (kv_size(input->paste_buf) + rbuffer_size(input->key_buffer) >= PASTE_CHUNK_SIZE) {
+    tinput_flush(input);
+  } else {
+    tinput_paste_take(input);
+  }
 
   // An incomplete sequence was found. Leave it in the raw buffer and wait for
   // the next input.
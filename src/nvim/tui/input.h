@@ -5,6 +5,7 @@
 #include <termkey.h>
 #include <uv.h>
 
+#include "klib/kvec.h"
 #include "nvim/event/loop.h"
 #include "nvim/event/stream.h"
 #include "nvim/event/time.h"
@@ -37,6 +38,7 @@ typedef struct {
   Loop *loop;
   Stream read_stream;
   RBuffer *key_buffer;
+  kvec_t(char) paste_buf;  ///< pasted text not sent yet, see PASTE_CHUNK_SIZE
   TUIData *tui_data;
 } TermInput;
 
@@ -1,6 +1,7 @@
 // Terminal UI functions. Invoked (by ui_client.c) on the UI process.
 
 #include <assert.h>
+#include <inttypes.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -50,6 +51,12 @@
 #define OUTBUF_SIZE 0xffff
 
 #define TOO_MANY_EVENTS 1000000
+// Minimal time between two flushes in msec, about 60 frames per second.
+// Drawing while waiting is collected and drawn at once.
+#define FRAME_INTERVAL 16
+/// Number of buckets of the input latency histogram, see tui_latency_input().
+/// Bucket "i" counts latencies below 2^i ms, the last one all longer ones.
+#define LATENCY_BUCKETS 12
 #define STARTS_WITH(str, prefix) \
   (strlen(str) >= (sizeof(prefix) - 1) \
    && 0 == memcmp((str), (prefix), sizeof(prefix) - 1))
@@ -87,6 +94,13 @@ struct TUIData {
   bool out_isatty;
   SignalWatcher winch_handle;
   uv_timer_t startup_delay_timer;
+  uv_timer_t flush_timer;
+  uint64_t last_flush;  // time of the last flush, see FRAME_INTERVAL
+  bool flush_pending;   // flush_timer is running, don't draw cells now
+  FILE *latency_log;    // opened $NVIM_TUI_LATENCY_LOG, or NULL
+  uint64_t input_time;  // os_hrtime() of the oldest input not yet drawn, or 0
+  uint64_t latency_hist[LATENCY_BUCKETS];
+  uint64_t latency_max;  // in ms
   UGrid grid;
   kvec_t(Rect) invalid_regions;
   int row, col;
@@ -173,6 +187,13 @@ void tui_start(TUIData **tui_p, int *width, int *height, char **term)
   tui->startup_delay_timer.data = tui;
   uv_timer_start(&tui->startup_delay_timer, after_startup_cb,
                  100, 0);
+  uv_timer_init(&tui->loop->uv, &tui->flush_timer);
+  tui->flush_timer.data = tui;
+
+  const char *latency_log = os_getenv("NVIM_TUI_LATENCY_LOG");
+  if (latency_log != NULL) {
+    tui->latency_log = os_fopen(latency_log, "a");
+  }
 
   *tui_p = tui;
   loop_poll_events(&main_loop, 1);
@@ -502,12 +523,14 @@ void tui_error_exit(TUIData *tui, Integer status)
 
 void tui_stop(TUIData *tui)
 {
+  tui_latency_report(tui);
   tui_terminal_stop(tui);
   stream_set_blocking(tui->input.in_fd, true);   // normalize stream (#2598)
   tinput_destroy(&tui->input);
   tui->stopped = true;
   signal_watcher_close(&tui->winch_handle, NULL);
   uv_close((uv_handle_t *)&tui->startup_delay_timer, NULL);
+  uv_close((uv_handle_t *)&tui->flush_timer, NULL);
 }
 
 /// Returns true if UI `ui` is stopped.
@@ -563,16 +586,57 @@ static bool attrs_differ(TUIData *tui, int id1, int id2, bool rgb)
   }
 }
 
+/// Get the foreground and background colors that `attrs` is drawn with,
+/// or -1 for the terminal default.
+static void attrs_colors(TUIData *tui, HlAttrs attrs, int attr, int *fg, int *bg)
+{
+  if (tui->rgb && !(attr & HL_FG_INDEXED)) {
+    *fg = ((attrs.rgb_fg_color != -1)
+           ? attrs.rgb_fg_color : tui->clear_attrs.rgb_fg_color);
+  } else {
+    *fg = (attrs.cterm_fg_color
+           ? attrs.cterm_fg_color - 1 : (tui->clear_attrs.cterm_fg_color - 1));
+  }
+  if (tui->rgb && !(attr & HL_BG_INDEXED)) {
+    *bg = ((attrs.rgb_bg_color != -1)
+           ? attrs.rgb_bg_color : tui->clear_attrs.rgb_bg_color);
+  } else {
+    *bg = (attrs.cterm_bg_color
+           ? attrs.cterm_bg_color - 1 : (tui->clear_attrs.cterm_bg_color - 1));
+  }
+}
+
 static void update_attrs(TUIData *tui, int attr_id)
 {
   if (!attrs_differ(tui, attr_id, tui->print_attr_id, tui->rgb)) {
     tui->print_attr_id = attr_id;
     return;
   }
+  int prev_attr_id = tui->print_attr_id;
   tui->print_attr_id = attr_id;
   HlAttrs attrs = kv_A(tui->attrs, (size_t)attr_id);
   int attr = tui->rgb ? attrs.rgb_ae_attr : attrs.cterm_ae_attr;
 
+  int fg, bg;
+  attrs_colors(tui, attrs, attr, &fg, &bg);
+
+  // When only the colors change, and none of them goes back to the default,
+  // the attributes already set in the terminal can be kept and only the
+  // changed colors need to be sent.  This is the common case when moving
+  // between syntax groups.
+  int prev_fg = -1;
+  int prev_bg = -1;
+  bool colors_only = false;
+  if (prev_attr_id >= 0) {
+    HlAttrs prev = kv_A(tui->attrs, (size_t)prev_attr_id);
+    int prev_attr = tui->rgb ? prev.rgb_ae_attr : prev.cterm_ae_attr;
+    if (prev_attr == attr
+        && (!(attr & HL_UNDERLINE_MASK) || prev.rgb_sp_color == attrs.rgb_sp_color)) {
+      attrs_colors(tui, prev, prev_attr, &prev_fg, &prev_bg);
+      colors_only = (fg != -1 || prev_fg == -1) && (bg != -1 || prev_bg == -1);
+    }
+  }
+
   bool bold = attr & HL_BOLD;
   bool italic = attr & HL_ITALIC;
   bool reverse = attr & HL_INVERSE;
@@ -603,109 +667,98 @@ static void update_attrs(TUIData *tui, int attr_id)
   bool has_any_underline = undercurl || underline
                            || underdouble || underdotted || underdashed;
 
-  if (unibi_get_str(tui->ut, unibi_set_attributes)) {
-    if (bold || reverse || underline || standout) {
-      UNIBI_SET_NUM_VAR(tui->params[0], standout);
-      UNIBI_SET_NUM_VAR(tui->params[1], underline);
-      UNIBI_SET_NUM_VAR(tui->params[2], reverse);
-      UNIBI_SET_NUM_VAR(tui->params[3], 0);   // blink
-      UNIBI_SET_NUM_VAR(tui->params[4], 0);   // dim
-      UNIBI_SET_NUM_VAR(tui->params[5], bold);
-      UNIBI_SET_NUM_VAR(tui->params[6], 0);   // blank
-      UNIBI_SET_NUM_VAR(tui->params[7], 0);   // protect
-      UNIBI_SET_NUM_VAR(tui->params[8], 0);   // alternate character set
-      unibi_out(tui, unibi_set_attributes);
-    } else if (!tui->default_attr) {
-      unibi_out(tui, unibi_exit_attribute_mode);
+  if (!colors_only) {
+    if (unibi_get_str(tui->ut, unibi_set_attributes)) {
+      if (bold || reverse || underline || standout) {
+        UNIBI_SET_NUM_VAR(tui->params[0], standout);
+        UNIBI_SET_NUM_VAR(tui->params[1], underline);
+        UNIBI_SET_NUM_VAR(tui->params[2], reverse);
+        UNIBI_SET_NUM_VAR(tui->params[3], 0);   // blink
+        UNIBI_SET_NUM_VAR(tui->params[4], 0);   // dim
+        UNIBI_SET_NUM_VAR(tui->params[5], bold);
+        UNIBI_SET_NUM_VAR(tui->params[6], 0);   // blank
+        UNIBI_SET_NUM_VAR(tui->params[7], 0);   // protect
+        UNIBI_SET_NUM_VAR(tui->params[8], 0);   // alternate character set
+        unibi_out(tui, unibi_set_attributes);
+      } else if (!tui->default_attr) {
+        unibi_out(tui, unibi_exit_attribute_mode);
+      }
+    } else {
+      if (!tui->default_attr) {
+        unibi_out(tui, unibi_exit_attribute_mode);
+      }
+      if (bold) {
+        unibi_out(tui, unibi_enter_bold_mode);
+      }
+      if (underline) {
+        unibi_out(tui, unibi_enter_underline_mode);
+      }
+      if (standout) {
+        unibi_out(tui, unibi_enter_standout_mode);
+      }
+      if (reverse) {
+        unibi_out(tui, unibi_enter_reverse_mode);
+      }
     }
-  } else {
-    if (!tui->default_attr) {
-      unibi_out(tui, unibi_exit_attribute_mode);
+    if (italic) {
+      unibi_out(tui, unibi_enter_italics_mode);
     }
-    if (bold) {
-      unibi_out(tui, unibi_enter_bold_mode);
+    if (altfont && tui->unibi_ext.enter_altfont_mode != -1) {
+      unibi_out_ext(tui, tui->unibi_ext.enter_altfont_mode);
     }
-    if (underline) {
-      unibi_out(tui, unibi_enter_underline_mode);
+    if (strikethrough && tui->unibi_ext.enter_strikethrough_mode != -1) {
+      unibi_out_ext(tui, tui->unibi_ext.enter_strikethrough_mode);
     }
-    if (standout) {
-      unibi_out(tui, unibi_enter_standout_mode);
+    if (undercurl && tui->unibi_ext.set_underline_style != -1) {
+      UNIBI_SET_NUM_VAR(tui->params[0], 3);
+      unibi_out_ext(tui, tui->unibi_ext.set_underline_style);
     }
-    if (reverse) {
-      unibi_out(tui, unibi_enter_reverse_mode);
+    if (underdouble && tui->unibi_ext.set_underline_style != -1) {
+      UNIBI_SET_NUM_VAR(tui->params[0], 2);
+      unibi_out_ext(tui, tui->unibi_ext.set_underline_style);
+    }
+    if (underdotted && tui->unibi_ext.set_underline_style != -1) {
+      UNIBI_SET_NUM_VAR(tui->params[0], 4);
+      unibi_out_ext(tui, tui->unibi_ext.set_underline_style);
+    }
+    if (underdashed && tui->unibi_ext.set_underline_style != -1) {
+      UNIBI_SET_NUM_VAR(tui->params[0], 5);
+      unibi_out_ext(tui, tui->unibi_ext.set_underline_style);
     }
-  }
-  if (italic) {
-    unibi_out(tui, unibi_enter_italics_mode);
-  }
-  if (altfont && tui->unibi_ext.enter_altfont_mode != -1) {
-    unibi_out_ext(tui, tui->unibi_ext.enter_altfont_mode);
-  }
-  if (strikethrough && tui->unibi_ext.enter_strikethrough_mode != -1) {
-    unibi_out_ext(tui, tui->unibi_ext.enter_strikethrough_mode);
-  }
-  if (undercurl && tui->unibi_ext.set_underline_style != -1) {
-    UNIBI_SET_NUM_VAR(tui->params[0], 3);
-    unibi_out_ext(tui, tui->unibi_ext.set_underline_style);
-  }
-  if (underdouble && tui->unibi_ext.set_underline_style != -1) {
-    UNIBI_SET_NUM_VAR(tui->params[0], 2);
-    unibi_out_ext(tui, tui->unibi_ext.set_underline_style);
-  }
-  if (underdotted && tui->unibi_ext.set_underline_style != -1) {
-    UNIBI_SET_NUM_VAR(tui->params[0], 4);
-    unibi_out_ext(tui, tui->unibi_ext.set_underline_style);
-  }
-  if (underdashed && tui->unibi_ext.set_underline_style != -1) {
-    UNIBI_SET_NUM_VAR(tui->params[0], 5);
-    unibi_out_ext(tui, tui->unibi_ext.set_underline_style);
-  }
 
-  if (has_any_underline && tui->unibi_ext.set_underline_color != -1) {
-    int color = attrs.rgb_sp_color;
-    if (color != -1) {
-      UNIBI_SET_NUM_VAR(tui->params[0], (color >> 16) & 0xff);  // red
-      UNIBI_SET_NUM_VAR(tui->params[1], (color >> 8) & 0xff);   // green
-      UNIBI_SET_NUM_VAR(tui->params[2], color & 0xff);          // blue
-      unibi_out_ext(tui, tui->unibi_ext.set_underline_color);
+    if (has_any_underline && tui->unibi_ext.set_underline_color != -1) {
+      int color = attrs.rgb_sp_color;
+      if (color != -1) {
+        UNIBI_SET_NUM_VAR(tui->params[0], (color >> 16) & 0xff);  // red
+        UNIBI_SET_NUM_VAR(tui->params[1], (color >> 8) & 0xff);   // green
+        UNIBI_SET_NUM_VAR(tui->params[2], color & 0xff);          // blue
+        unibi_out_ext(tui, tui->unibi_ext.set_underline_color);
+      }
     }
   }
 
-  int fg, bg;
-  if (tui->rgb && !(attr & HL_FG_INDEXED)) {
-    fg = ((attrs.rgb_fg_color != -1)
-          ? attrs.rgb_fg_color : tui->clear_attrs.rgb_fg_color);
-    if (fg != -1) {
-      UNIBI_SET_NUM_VAR(tui->params[0], (fg >> 16) & 0xff);  // red
-      UNIBI_SET_NUM_VAR(tui->params[1], (fg >> 8) & 0xff);   // green
-      UNIBI_SET_NUM_VAR(tui->params[2], fg & 0xff);          // blue
-      unibi_out_ext(tui, tui->unibi_ext.set_rgb_foreground);
-    }
+  if (fg == -1 || (colors_only && fg == prev_fg)) {
+    // nothing to send
+  } else if (tui->rgb && !(attr & HL_FG_INDEXED)) {
+    UNIBI_SET_NUM_VAR(tui->params[0], (fg >> 16) & 0xff);  // red
+    UNIBI_SET_NUM_VAR(tui->params[1], (fg >> 8) & 0xff);   // green
+    UNIBI_SET_NUM_VAR(tui->params[2], fg & 0xff);          // blue
+    unibi_out_ext(tui, tui->unibi_ext.set_rgb_foreground);
   } else {
-    fg = (attrs.cterm_fg_color
-          ? attrs.cterm_fg_color - 1 : (tui->clear_attrs.cterm_fg_color - 1));
-    if (fg != -1) {
-      UNIBI_SET_NUM_VAR(tui->params[0], fg);
-      unibi_out(tui, unibi_set_a_foreground);
-    }
+    UNIBI_SET_NUM_VAR(tui->params[0], fg);
+    unibi_out(tui, unibi_set_a_foreground);
   }
 
-  if (tui->rgb && !(attr & HL_BG_INDEXED)) {
-    bg = ((attrs.rgb_bg_color != -1)
-          ? attrs.rgb_bg_color : tui->clear_attrs.rgb_bg_color);
-    if (bg != -1) {
-      UNIBI_SET_NUM_VAR(tui->params[0], (bg >> 16) & 0xff);  // red
-      UNIBI_SET_NUM_VAR(tui->params[1], (bg >> 8) & 0xff);   // green
-      UNIBI_SET_NUM_VAR(tui->params[2], bg & 0xff);          // blue
-      unibi_out_ext(tui, tui->unibi_ext.set_rgb_background);
-    }
+  if (bg == -1 || (colors_only && bg == prev_bg)) {
+    // nothing to send
+  } else if (tui->rgb && !(attr & HL_BG_INDEXED)) {
+    UNIBI_SET_NUM_VAR(tui->params[0], (bg >> 16) & 0xff);  // red
+    UNIBI_SET_NUM_VAR(tui->params[1], (bg >> 8) & 0xff);   // green
+    UNIBI_SET_NUM_VAR(tui->params[2], bg & 0xff);          // blue
+    unibi_out_ext(tui, tui->unibi_ext.set_rgb_background);
   } else {
-    bg = (attrs.cterm_bg_color
-          ? attrs.cterm_bg_color - 1 : (tui->clear_attrs.cterm_bg_color - 1));
-    if (bg != -1) {
-      UNIBI_SET_NUM_VAR(tui->params[0], bg);
-      unibi_out(tui, unibi_set_a_background);
-    }
+    UNIBI_SET_NUM_VAR(tui->params[0], bg);
+    unibi_out(tui, unibi_set_a_background);
   }
 
   tui->default_attr = fg == -1 && bg == -1
@@ -1240,6 +1293,20 @@ void tui_grid_scroll(TUIData *tui, Integer g, Integer startrow, Integer endrow,
                                 || tui->can_set_left_right_margin)));
 
   if (can_scroll) {
+    // Cells that were not drawn yet are moved by the terminal, they must be
+    // drawn at the new position as well.
+    size_t n = kv_size(tui->invalid_regions);
+    for (size_t i = 0; i < n; i++) {
+      Rect r = kv_A(tui->invalid_regions, i);
+      int r_top = MAX(r.top - (int)rows, (int)startrow);
+      int r_bot = MIN(r.bot - (int)rows, (int)endrow);
+      int r_left = MAX(r.left, (int)startcol);
+      int r_right = MIN(r.right, (int)endcol);
+      if (r_top < r_bot && r_left < r_right) {
+        invalidate(tui, r_top, r_bot, r_left, r_right);
+      }
+    }
+
     // Change terminal scroll region and move cursor to the top
     if (!tui->scroll_region_is_full_screen) {
       set_scroll_region(tui, top, bot, left, right);
@@ -1284,6 +1351,10 @@ void tui_hl_attr_define(TUIData *tui, Integer id, HlAttrs attrs, HlAttrs cterm_a
   attrs.cterm_fg_color = cterm_attrs.cterm_fg_color;
   attrs.cterm_bg_color = cterm_attrs.cterm_bg_color;
   kv_a(tui->attrs, (size_t)id) = attrs;
+  if (id == tui->print_attr_id) {
+    // The terminal state is described by the old definition.
+    tui->print_attr_id = -1;
+  }
 }
 
 void tui_bell(TUIData *tui)
@@ -1344,8 +1415,6 @@ static void tui_flush_end(TUIData *tui)
 
 void tui_flush(TUIData *tui)
 {
-  UGrid *grid = &tui->grid;
-
   size_t nrevents = loop_size(tui->loop);
   if (nrevents > TOO_MANY_EVENTS) {
     WLOG("TUI event-queue flooded (thread_events=%zu); purging", nrevents);
@@ -1358,6 +1427,34 @@ void tui_flush(TUIData *tui)
     tui_busy_stop(tui);  // avoid hidden cursor
   }
 
+  if (tui->flush_pending) {
+    return;
+  }
+  // When flushing faster than the terminal can show it, wait until the
+  // next frame.  Until then cells are only stored in the grid, intermediate
+  // states of a line are never sent.
+  uint64_t since = uv_now(&tui->loop->uv) - tui->last_flush;
+  if (since < FRAME_INTERVAL) {
+    tui->flush_pending = true;
+    uv_timer_start(&tui->flush_timer, flush_timer_cb, FRAME_INTERVAL - since, 0);
+    return;
+  }
+
+  tui_flush_frame(tui);
+}
+
+static void flush_timer_cb(uv_timer_t *handle)
+{
+  TUIData *tui = handle->data;
+  tui->flush_pending = false;
+  tui_flush_frame(tui);
+}
+
+/// Draw the invalid regions and send everything to the terminal.
+static void tui_flush_frame(TUIData *tui)
+{
+  UGrid *grid = &tui->grid;
+
   tui_flush_start(tui);
 
   while (kv_size(tui->invalid_regions)) {
@@ -1390,6 +1487,48 @@ void tui_flush(TUIData *tui)
   tui_flush_end(tui);
 
   flush_buf(tui);
+  tui->last_flush = uv_now(&tui->loop->uv);
+
+  if (tui->input_time != 0) {
+    uint64_t ms = (os_hrtime() - tui->input_time) / 1000000;
+    int i = 0;
+    while (i < LATENCY_BUCKETS - 1 && ms >= ((uint64_t)1 << i)) {
+      i++;
+    }
+    tui->latency_hist[i]++;
+    tui->latency_max = MAX(tui->latency_max, ms);
+    tui->input_time = 0;
+  }
+}
+
+/// Called when keys were sent to the server.  With $NVIM_TUI_LATENCY_LOG the
+/// time until the next frame is written to the terminal is recorded.
+void tui_latency_input(TUIData *tui)
+{
+  if (tui->latency_log != NULL && tui->input_time == 0) {
+    tui->input_time = os_hrtime();
+  }
+}
+
+/// Append the input latency histogram to $NVIM_TUI_LATENCY_LOG.
+static void tui_latency_report(TUIData *tui)
+{
+  if (tui->latency_log == NULL) {
+    return;
+  }
+  uint64_t count = 0;
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    count += tui->latency_hist[i];
+  }
+  fprintf(tui->latency_log, "input latency: %" PRIu64 " samples, max %" PRIu64 " ms\n",
+          count, tui->latency_max);
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    fprintf(tui->latency_log, "  %s %4" PRIu64 " ms: %" PRIu64 "\n",
+            i < LATENCY_BUCKETS - 1 ? "< " : ">=",
+            (uint64_t)1 << (i < LATENCY_BUCKETS - 1 ? i : i - 1), tui->latency_hist[i]);
+  }
+  fclose(tui->latency_log);
+  tui->latency_log = NULL;
 }
 
 /// Dumps termcap info to the messages area, if 'verbose' >= 3.
@@ -1553,6 +1692,18 @@ void tui_raw_line(TUIData *tui, Integer g, Integer linerow, Integer startcol, In
     assert((size_t)attrs[c - startcol] < kv_size(tui->attrs));
     grid->cells[linerow][c].attr = attrs[c - startcol];
   }
+
+  if (tui->flush_pending) {
+    // Drawn with the next frame.
+    if (clearcol > endcol) {
+      ugrid_clear_chunk(grid, (int)linerow, (int)endcol, (int)clearcol,
+                        (sattr_T)clearattr);
+    }
+    invalidate(tui, (int)linerow, (int)linerow + 1, (int)startcol,
+               (int)MAX(endcol, clearcol));
+    return;
+  }
+
   UGRID_FOREACH_CELL(grid, (int)linerow, (int)startcol, (int)endcol, {
     print_cell_at_pos(tui, (int)linerow, curcol, cell,
                       curcol < endcol - 1 && (cell + 1)->data == NUL);
@@ -58,7 +58,7 @@ typedef struct {
   /// guaranteed size available for each new event (so packing of simple events
   /// and the header of grid_line will never fail)
 #define EVENT_BUF_SIZE 256
-  char buf[UI_BUF_SIZE];  ///< buffer of packed but not yet sent msgpack data
+  char *buf;  ///< buffer of UI_BUF_SIZE bytes with packed but not yet sent msgpack data
   char *buf_wptr;  ///< write head of buffer
   const char *cur_event;  ///< name of current event (might get multiple arglists)
   Array call_buf;  ///< buffer for constructing a single arg list (max 16 elements!)
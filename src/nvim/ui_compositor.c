@@ -521,7 +521,13 @@ void ui_comp_raw_line(Integer grid, Integer row, Integer startcol, Integer endco
     endcol = MIN(endcol, clearcol);
   }
 
-  bool covered = curgrid_covered_above((int)row);
+  bool fully;
+  bool covered = curgrid_covered((int)row, (int)row + 1, (int)startcol, (int)clearcol,
+                                 (int)row, &fully);
+  if (fully && !(flags & kLineFlagInvalid)) {
+    // Hidden below a grid that doesn't change.
+    return;
+  }
   // TODO(bfredl): eventually should just fix compose_line to respect clearing
   // and optimize it for uncovered lines.
   if (flags & kLineFlagInvalid || covered || curgrid->blending) {
@@ -587,14 +593,51 @@ void ui_comp_msg_set_pos(Integer grid, Integer row, Boolean scrolled, String sep
   msg_was_scrolled = scrolled;
 }
 
-/// check if curgrid is covered on row or above
+/// Check if an area of curgrid is covered by a grid above it.
+///
+/// When the grids above are elsewhere on the screen, the area can be drawn
+/// directly, no need to compose.
 ///
-/// TODO(bfredl): currently this only handles message row
-static bool curgrid_covered_above(int row)
+/// @param msgrow  the message grid covers the area when this row is not
+///                above the message (and its separator)
+/// @param[out] fully  set to true when one grid above, which doesn't blend,
+///                    covers all of the area.  Then drawing it has no effect.
+static bool curgrid_covered(int startrow, int endrow, int startcol, int endcol, int msgrow,
+                            bool *fully)
 {
-  bool above_msg = (kv_A(layers, kv_size(layers) - 1) == &msg_grid
-                    && row < msg_current_row - (msg_was_scrolled ? 1 : 0));
-  return kv_size(layers) - (above_msg ? 1 : 0) > curgrid->comp_index + 1;
+  bool covered = false;
+  *fully = false;
+  for (size_t i = curgrid->comp_index + 1; i < kv_size(layers); i++) {
+    ScreenGrid *g = kv_A(layers, i);
+    if (g == &msg_grid) {
+      // The message grid goes down to the bottom, the separator line above
+      // it is drawn over other grids.
+      if (msgrow >= msg_current_row - (msg_was_scrolled ? 1 : 0)) {
+        covered = true;
+      }
+      continue;
+    }
+    // Use the largest size for "covered", so that a grid that is being
+    // resized is composed, and the smallest size for "fully".  A grid just
+    // next to the area also counts, one half of a double-width character
+    // may be covered.
+    int rows = MAX(g->rows, g->comp_height);
+    int cols = MAX(g->cols, g->comp_width);
+    if (g->comp_row >= endrow || g->comp_row + rows <= startrow
+        || g->comp_col > endcol || g->comp_col + cols < startcol) {
+      continue;
+    }
+    covered = true;
+    rows = MIN(g->rows, g->comp_height);
+    cols = MIN(g->cols, g->comp_width);
+    if (!g->blending && !g->comp_disabled
+        && g->comp_row <= startrow && g->comp_row + rows >= endrow
+        && g->comp_col <= startcol && g->comp_col + cols >= endcol) {
+      *fully = true;
+      break;
+    }
+  }
+  return covered;
 }
 
 void ui_comp_grid_scroll(Integer grid, Integer top, Integer bot, Integer left, Integer right,
@@ -607,7 +650,9 @@ void ui_comp_grid_scroll(Integer grid, Integer top, Integer bot, Integer left, I
   bot += curgrid->comp_row;
   left += curgrid->comp_col;
   right += curgrid->comp_col;
-  bool covered = curgrid_covered_above((int)(bot - MAX(rows, 0)));
+  bool fully;
+  bool covered = curgrid_covered((int)top, (int)bot, (int)left, (int)right,
+                                 (int)(bot - MAX(rows, 0)), &fully);
 
   if (covered || curgrid->blending) {
     // TODO(bfredl):
@@ -104,6 +104,7 @@
 #include "nvim/globals.h"
 #include "nvim/highlight_defs.h"
 #include "nvim/macros.h"
+#include "nvim/map.h"
 #include "nvim/mark.h"
 #include "nvim/memline.h"
 #include "nvim/memory.h"
@@ -136,6 +137,11 @@ typedef struct {
 # include "undo.c.generated.h"
 #endif
 
+/// Undo headers and entries are allocated from pools: every change creates
+/// them and they are freed again when 'undolevels' is exceeded.
+static Pool u_header_pool = POOL_INIT(u_header_T);
+static Pool u_entry_pool = POOL_INIT(u_entry_T);
+
 static const char e_undo_list_corrupt[]
   = N_("E439: Undo list corrupt");
 static const char e_undo_line_missing[]
@@ -386,7 +392,7 @@ int u_savecommon(buf_T *buf, linenr_T top, linenr_T bot, linenr_T newbot, int re
     if (get_undolevel(buf) >= 0) {
       // Make a new header entry.  Do this first so that we don't mess
       // up the undo info when out of memory.
-      uhp = xmalloc(sizeof(u_header_T));
+      uhp = pool_alloc(&u_header_pool);
       kv_init(uhp->uh_extmark);
 #ifdef U_DEBUG
       uhp->uh_magic = UH_MAGIC;
@@ -557,6 +563,23 @@ int u_savecommon(buf_T *buf, linenr_T top, linenr_T bot, linenr_T newbot, int re
         prev_uep = uep;
         uep = uep->ue_next;
       }
+
+      // When saving the line just below the lines saved last, and the
+      // number of lines didn't change since then, add the line to that
+      // entry.  Saves a lot of memory when a command changes many lines
+      // one by one, e.g. ":%s".  A line in that entry is already saved.
+      uep = u_get_headentry(buf);
+      if (uep != NULL && !reload && newbot == 0
+          && bot <= buf->b_ml.ml_line_count
+          && buf->b_u_newhead->uh_getbot_entry == uep
+          && uep->ue_lcount == buf->b_ml.ml_line_count
+          && top >= uep->ue_top && top <= uep->ue_top + uep->ue_size) {
+        if (top == uep->ue_top + uep->ue_size) {
+          uep->ue_array = xrealloc(uep->ue_array, sizeof(char *) * (size_t)(uep->ue_size + 1));
+          uep->ue_array[uep->ue_size++] = u_save_line_buf(buf, top + 1);
+        }
+        return OK;
+      }
     }
 
     // find line number for ue_bot for previous u_save()
@@ -564,7 +587,7 @@ int u_savecommon(buf_T *buf, linenr_T top, linenr_T bot, linenr_T newbot, int re
   }
 
   // add lines in front of entry list
-  uep = xmalloc(sizeof(u_entry_T));
+  uep = pool_alloc(&u_entry_pool);
   CLEAR_POINTER(uep);
 #ifdef U_DEBUG
   uep->ue_magic = UE_MAGIC;
@@ -767,7 +790,7 @@ static void u_free_uhp(u_header_T *uhp)
     u_freeentry(uep, uep->ue_size);
     uep = nuep;
   }
-  xfree(uhp);
+  pool_free(&u_header_pool, uhp);
 }
 
 /// Writes the undofile header.
@@ -887,7 +910,7 @@ static bool serialize_uhp(bufinfo_T *bi, u_header_T *uhp)
 
 static u_header_T *unserialize_uhp(bufinfo_T *bi, const char *file_name)
 {
-  u_header_T *uhp = xmalloc(sizeof(u_header_T));
+  u_header_T *uhp = pool_alloc(&u_header_pool);
   CLEAR_POINTER(uhp);
 #ifdef U_DEBUG
   uhp->uh_magic = UH_MAGIC;
@@ -899,7 +922,7 @@ static u_header_T *unserialize_uhp(bufinfo_T *bi, const char *file_name)
   uhp->uh_seq = undo_read_4c(bi);
   if (uhp->uh_seq <= 0) {
     corruption_error("uh_seq", file_name);
-    xfree(uhp);
+    pool_free(&u_header_pool, uhp);
     return NULL;
   }
   unserialize_pos(bi, &uhp->uh_cursor);
@@ -1073,7 +1096,7 @@ static bool serialize_uep(bufinfo_T *bi, u_entry_T *uep)
 
 static u_entry_T *unserialize_uep(bufinfo_T *bi, bool *error, const char *file_name)
 {
-  u_entry_T *uep = xmalloc(sizeof(u_entry_T));
+  u_entry_T *uep = pool_alloc(&u_entry_pool);
   CLEAR_POINTER(uep);
 #ifdef U_DEBUG
   uep->ue_magic = UE_MAGIC;
@@ -1553,67 +1576,60 @@ void u_read_undo(char *name, const uint8_t *hash, const char *orig_name FUNC_ATT
   // We have put all of the headers into a table. Now we iterate through the
   // table and swizzle each sequence number we have stored in uh_*_seq into
   // a pointer corresponding to the header with that sequence number.
-  int16_t old_idx = -1, new_idx = -1, cur_idx = -1;
+  // A map from sequence number to (index + 1) keeps this linear, as files
+  // with a long history can have many thousands of headers.
+  Map(int, int) seq_idx = MAP_INIT;
+  for (int i = 0; i < num_head; i++) {
+    if (uhp_table[i] == NULL) {
+      continue;
+    }
+    bool new_item = false;
+    int *idx = map_put_ref(int, int)(&seq_idx, uhp_table[i]->uh_seq, NULL, &new_item);
+    if (!new_item) {
+      map_destroy(int, &seq_idx);
+      corruption_error("duplicate uh_seq", file_name);
+      goto error;
+    }
+    *idx = i + 1;
+  }
+
+  int old_idx = -1, new_idx = -1, cur_idx = -1;
   for (int i = 0; i < num_head; i++) {
     u_header_T *uhp = uhp_table[i];
     if (uhp == NULL) {
       continue;
     }
-    for (int j = 0; j < num_head; j++) {
-      if (uhp_table[j] != NULL && i != j
-          && uhp_table[i]->uh_seq == uhp_table[j]->uh_seq) {
-        corruption_error("duplicate uh_seq", file_name);
-        goto error;
-      }
+    int j;
+    if ((j = map_get(int, int)(&seq_idx, uhp->uh_next.seq) - 1) >= 0) {
+      uhp->uh_next.ptr = uhp_table[j];
+      SET_FLAG(j);
     }
-    for (int j = 0; j < num_head; j++) {
-      if (uhp_table[j] != NULL
-          && uhp_table[j]->uh_seq == uhp->uh_next.seq) {
-        uhp->uh_next.ptr = uhp_table[j];
-        SET_FLAG(j);
-        break;
-      }
-    }
-    for (int j = 0; j < num_head; j++) {
-      if (uhp_table[j] != NULL
-          && uhp_table[j]->uh_seq == uhp->uh_prev.seq) {
-        uhp->uh_prev.ptr = uhp_table[j];
-        SET_FLAG(j);
-        break;
-      }
+    if ((j = map_get(int, int)(&seq_idx, uhp->uh_prev.seq) - 1) >= 0) {
+      uhp->uh_prev.ptr = uhp_table[j];
+      SET_FLAG(j);
     }
-    for (int j = 0; j < num_head; j++) {
-      if (uhp_table[j] != NULL
-          && uhp_table[j]->uh_seq == uhp->uh_alt_next.seq) {
-        uhp->uh_alt_next.ptr = uhp_table[j];
-        SET_FLAG(j);
-        break;
-      }
+    if ((j = map_get(int, int)(&seq_idx, uhp->uh_alt_next.seq) - 1) >= 0) {
+      uhp->uh_alt_next.ptr = uhp_table[j];
+      SET_FLAG(j);
     }
-    for (int j = 0; j < num_head; j++) {
-      if (uhp_table[j] != NULL
-          && uhp_table[j]->uh_seq == uhp->uh_alt_prev.seq) {
-        uhp->uh_alt_prev.ptr = uhp_table[j];
-        SET_FLAG(j);
-        break;
-      }
+    if ((j = map_get(int, int)(&seq_idx, uhp->uh_alt_prev.seq) - 1) >= 0) {
+      uhp->uh_alt_prev.ptr = uhp_table[j];
+      SET_FLAG(j);
     }
     if (old_header_seq > 0 && old_idx < 0 && uhp->uh_seq == old_header_seq) {
-      assert(i <= INT16_MAX);
-      old_idx = (int16_t)i;
+      old_idx = i;
       SET_FLAG(i);
     }
     if (new_header_seq > 0 && new_idx < 0 && uhp->uh_seq == new_header_seq) {
-      assert(i <= INT16_MAX);
-      new_idx = (int16_t)i;
+      new_idx = i;
       SET_FLAG(i);
     }
     if (cur_header_seq > 0 && cur_idx < 0 && uhp->uh_seq == cur_header_seq) {
-      assert(i <= INT16_MAX);
-      cur_idx = (int16_t)i;
+      cur_idx = i;
       SET_FLAG(i);
     }
   }
+  map_destroy(int, &seq_idx);
 
   // Now that we have read the undo info successfully, free the current undo
   // info and use the info from the file.
@@ -2349,16 +2365,19 @@ static void u_undoredo(int undo, bool do_buf_event)
 
     // insert the lines in u_array between top and bot
     if (newsize) {
-      int i;
-      linenr_T lnum;
-      for (lnum = top, i = 0; i < newsize; i++, lnum++) {
-        // If the file is empty, there is an empty line 1 that we
-        // should get rid of, by replacing it with the new line
-        if (empty_buffer && lnum == 0) {
-          ml_replace(1, uep->ue_array[i], true);
-        } else {
-          ml_append(lnum, uep->ue_array[i], 0, false);
-        }
+      int i = 0;
+      // If the file is empty, there is an empty line 1 that we
+      // should get rid of, by replacing it with the new line
+      if (empty_buffer && top == 0) {
+        ml_replace(1, uep->ue_array[0], true);
+        i = 1;
+      }
+      // Append the rest in one go, so that a big block of lines fills new
+      // data blocks instead of being inserted into the same one line by line.
+      if (i < newsize) {
+        ml_append_buf_lines(curbuf, top + i, uep->ue_array + i, newsize - i, false);
+      }
+      for (i = 0; i < newsize; i++) {
         xfree(uep->ue_array[i]);
       }
       xfree(uep->ue_array);
@@ -2859,9 +2878,63 @@ static void u_getbot(buf_T *buf)
     buf->b_u_newhead->uh_getbot_entry = NULL;
   }
 
+  // The entry is complete now, following changes go to a new one.
+  u_trim_headentry(buf);
+
   buf->b_u_synced = true;
 }
 
+/// Drop the saved lines at the start and end of the last undo entry which are
+/// equal to the current text, they don't need to be restored.  Saves a lot of
+/// memory when a command replaces many lines but changes only a few of them,
+/// e.g. re-indenting or formatting the whole buffer.
+///
+/// Only valid for a complete entry: later changes of these lines would not be
+/// undone.
+static void u_trim_headentry(buf_T *buf)
+{
+  u_entry_T *uep = buf->b_u_newhead->uh_entry;
+  if (uep->ue_size == 0) {
+    return;
+  }
+
+  linenr_T bot = uep->ue_bot == 0 ? buf->b_ml.ml_line_count + 1 : uep->ue_bot;
+  linenr_T cursize = bot - uep->ue_top - 1;  // number of lines undo replaces
+
+  linenr_T lead = 0;
+  while (lead < uep->ue_size && lead < cursize
+         && strcmp(uep->ue_array[lead], ml_get_buf(buf, uep->ue_top + 1 + lead)) == 0) {
+    lead++;
+  }
+  linenr_T trail = 0;
+  while (trail < uep->ue_size - lead && trail < cursize - lead
+         && strcmp(uep->ue_array[uep->ue_size - 1 - trail], ml_get_buf(buf, bot - 1 - trail)) == 0) {
+    trail++;
+  }
+  if (lead == 0 && trail == 0) {
+    return;
+  }
+
+  for (linenr_T i = 0; i < lead; i++) {
+    xfree(uep->ue_array[i]);
+  }
+  for (linenr_T i = uep->ue_size - trail; i < uep->ue_size; i++) {
+    xfree(uep->ue_array[i]);
+  }
+  linenr_T size = uep->ue_size - lead - trail;
+  if (size > 0) {
+    memmove(uep->ue_array, uep->ue_array + lead, sizeof(char *) * (size_t)size);
+    uep->ue_array = xrealloc(uep->ue_array, sizeof(char *) * (size_t)size);
+  } else {
+    XFREE_CLEAR(uep->ue_array);
+  }
+  uep->ue_size = size;
+  uep->ue_top += lead;
+  if (trail > 0) {
+    uep->ue_bot = bot - trail;
+  }
+}
+
 /// Free one header "uhp" and its entry list and adjust the pointers.
 ///
 /// @param uhpp  if not NULL reset when freeing this header
@@ -2953,7 +3026,7 @@ static void u_freeentries(buf_T *buf, u_header_T *uhp, u_header_T **uhpp)
 #ifdef U_DEBUG
   uhp->uh_magic = 0;
 #endif
-  xfree(uhp);
+  pool_free(&u_header_pool, uhp);
   buf->b_u_numhead--;
 }
 
@@ -2967,7 +3040,7 @@ static void u_freeentry(u_entry_T *uep, int n)
 #ifdef U_DEBUG
   uep->ue_magic = 0;
 #endif
-  xfree(uep);
+  pool_free(&u_entry_pool, uep);
 }
 
 /// invalidate the undo buffer; called when storage has already been released
@@ -3074,7 +3147,11 @@ static char *u_save_line(linenr_T lnum)
 /// @param buf buffer to copy from
 static char *u_save_line_buf(buf_T *buf, linenr_T lnum)
 {
-  return xstrdup(ml_get_buf(buf, lnum));
+  char *line = ml_get_buf(buf, lnum);
+  AllocTag prev_tag = alloc_tag_push(kAllocTagUndo);
+  char *copy = xstrdup(line);
+  alloc_tag_pop(prev_tag);
+  return copy;
 }
 
 /// Check if the 'modified' flag is set, or 'ff' has changed (only need to
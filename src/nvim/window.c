@@ -1569,12 +1569,8 @@ static bool tabpage_win_valid(const tabpage_T *tp, const win_T *win)
 win_T *win_find_by_handle(handle_T handle)
   FUNC_ATTR_PURE FUNC_ATTR_WARN_UNUSED_RESULT
 {
-  FOR_ALL_WINDOWS_IN_TAB(wp, curtab) {
-    if (wp->handle == handle) {
-      return wp;
-    }
-  }
-  return NULL;
+  win_T *wp = handle_get_window(handle);
+  return wp != NULL && wp->w_tabpage == curtab ? wp : NULL;
 }
 
 /// Check if "win" is a pointer to an existing window in any tabpage.
@@ -3843,6 +3839,7 @@ void win_alloc_first(void)
 
   first_tabpage = alloc_tabpage();
   curtab = first_tabpage;
+  firstwin->w_tabpage = curtab;  // curtab was NULL when it was appended
   unuse_tabpage(first_tabpage);
 }
 
@@ -4916,6 +4913,7 @@ win_T *win_alloc(win_T *after, bool hidden)
   pmap_put(int)(&window_handles, new_wp->handle, new_wp);
 
   grid_assign_handle(&new_wp->w_grid_alloc);
+  grid_win_register(new_wp);
 
   // Init w: variables.
   new_wp->w_vars = tv_dict_alloc();
@@ -5004,6 +5002,7 @@ static void win_free(win_T *wp, tabpage_T *tp)
   }
 
   xfree(wp->w_lines);
+  plines_cache_free(wp);
 
   for (int i = 0; i < wp->w_tagstacklen; i++) {
     xfree(wp->w_tagstack[i].tagname);
@@ -5086,6 +5085,7 @@ void win_free_grid(win_T *wp, bool reinit)
     ui_call_grid_destroy(wp->w_grid_alloc.handle);
   }
   grid_free(&wp->w_grid_alloc);
+  grid_win_unregister(wp);
   if (reinit) {
     // if a float is turned into a split, the grid data structure will be reused
     CLEAR_FIELD(wp->w_grid_alloc);
@@ -5100,6 +5100,7 @@ void win_append(win_T *after, win_T *wp)
 
   wp->w_next = before;
   wp->w_prev = after;
+  wp->w_tabpage = curtab;
   if (after == NULL) {
     firstwin = wp;
   } else {
@@ -5131,6 +5132,7 @@ void win_remove(win_T *wp, tabpage_T *tp)
   } else {
     tp->tp_lastwin = wp->w_prev;
   }
+  wp->w_tabpage = NULL;
 }
 
 // Append frame "frp" in a frame list after frame "after".
@@ -0,0 +1,68 @@
+local helpers = require('test.functional.helpers')(after_each)
+
+local clear = helpers.clear
+local exec_lua = helpers.exec_lua
+
+-- For tuning the marktree, compare the results for builds with different
+-- MT_BRANCH_FACTOR (see src/nvim/marktree.h).
+describe('extmark perf', function()
+  before_each(function()
+    clear()
+
+    exec_lua([[
+      local lines = {}
+      for i = 1, 100000 do
+        lines[i] = 'line ' .. i
+      end
+      vim.api.nvim_buf_set_lines(0, 0, -1, true, lines)
+
+      _G.ns = vim.api.nvim_create_namespace('bench')
+      local marks = {}
+      for i = 0, 99999 do
+        for col = 0, 9, 2 do
+          marks[#marks + 1] = { i, col, { end_row = i, end_col = col + 1 } }
+        end
+      end
+      vim.api.nvim_buf_set_extmarks(0, _G.ns, marks)
+
+      function _G.measure(name, f)
+        local start = vim.uv.hrtime()
+        f()
+        print(string.format('\n%s: %0.3f ms', name, (vim.uv.hrtime() - start) / 1000000))
+      end
+    ]])
+  end)
+
+  it('lookups with 1M marks', function()
+    exec_lua([[
+      _G.measure('get_extmarks() of single lines', function()
+        for i = 0, 99999, 7 do
+          vim.api.nvim_buf_get_extmarks(0, _G.ns, { i, 0 }, { i, -1 }, {})
+        end
+      end)
+    ]])
+  end)
+
+  it('splice with 1M marks', function()
+    exec_lua([[
+      _G.measure('inserting a char on every 100th line', function()
+        for i = 1, 100000, 100 do
+          vim.api.nvim_buf_set_text(0, i - 1, 0, i - 1, 0, { 'x' })
+        end
+      end)
+      _G.measure('pasting 100k lines above all marks', function()
+        local lines = {}
+        for i = 1, 100000 do
+          lines[i] = 'pasted ' .. i
+        end
+        vim.api.nvim_buf_set_lines(0, 0, 0, true, lines)
+      end)
+      vim.api.nvim_buf_set_lines(0, 0, 100000, true, {})
+      _G.measure('deleting every 100th line', function()
+        for i = 99000, 1, -100 do
+          vim.api.nvim_buf_set_lines(0, i - 1, i, true, {})
+        end
+      end)
+    ]])
+  end)
+end)
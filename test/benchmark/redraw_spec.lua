@@ -0,0 +1,128 @@
+-- Per-frame redraw times for a few recorded workloads, with a UI attached.
+--
+-- A frame is one update_screen() call, measured from the on_start to the
+-- on_end callback of a decoration provider.  Compare "scroll plain" with
+-- "scroll treesitter" for the cost of the treesitter decoration provider.
+
+local helpers = require('test.functional.helpers')(after_each)
+local Screen = require('test.functional.ui.screen')
+
+local clear = helpers.clear
+local command = helpers.command
+local exec_lua = helpers.exec_lua
+local feed = helpers.feed
+local poke_eventloop = helpers.poke_eventloop
+
+local function start_frames()
+  exec_lua([[
+    _G.frames = {}
+    local ns = vim.api.nvim_create_namespace('bench_redraw')
+    local frame_start
+    vim.api.nvim_set_decoration_provider(ns, {
+      on_start = function()
+        frame_start = vim.uv.hrtime()
+      end,
+      on_end = function()
+        if frame_start then
+          table.insert(_G.frames, vim.uv.hrtime() - frame_start)
+          frame_start = nil
+        end
+      end,
+    })
+  ]])
+end
+
+local function report(name)
+  local frames = exec_lua('return _G.frames')
+  table.sort(frames)
+  local function pct(p)
+    return frames[math.max(1, math.ceil(#frames * p))] / 1000000
+  end
+  print(
+    string.format(
+      '\n%-20s %4d frames  p50 %7.3f  p90 %7.3f  p99 %7.3f  max %7.3f ms',
+      name,
+      #frames,
+      pct(0.5),
+      pct(0.9),
+      pct(0.99),
+      frames[#frames] / 1000000
+    )
+  )
+end
+
+--- Replays `keys`, one key (or key notation) at a time, waiting for the
+--- redraw after each one.
+local function replay(keys)
+  for _, k in ipairs(keys) do
+    feed(k)
+    poke_eventloop()
+  end
+end
+
+local function rep(key, n)
+  local keys = {}
+  for i = 1, n do
+    keys[i] = key
+  end
+  return keys
+end
+
+describe('redraw perf', function()
+  before_each(function()
+    clear()
+    local screen = Screen.new(120, 50)
+    screen:attach()
+    command('set nofoldenable')
+  end)
+
+  it('scroll plain', function()
+    command('edit ./src/nvim/eval.c')
+    start_frames()
+    replay(rep('<C-d>', 100))
+    replay(rep('<C-u>', 100))
+    report('scroll plain')
+  end)
+
+  it('scroll treesitter', function()
+    command('edit ./src/nvim/eval.c')
+    exec_lua([[
+      local parser = vim.treesitter.get_parser(0, 'c', {})
+      vim.treesitter.highlighter.new(parser)
+    ]])
+    start_frames()
+    replay(rep('<C-d>', 100))
+    replay(rep('<C-u>', 100))
+    report('scroll treesitter')
+  end)
+
+  it('typing with completion popup', function()
+    command('edit ./src/nvim/eval.c')
+    command('set completeopt=menuone,noinsert')
+    start_frames()
+    feed('Go')
+    for _ = 1, 20 do
+      replay({ 'e', 'v', 'a', 'l', '_', '<C-n>', '<C-n>', '<C-n>', '<C-y>', '<CR>' })
+    end
+    feed('<Esc>')
+    report('completion popup')
+  end)
+
+  it('diff mode navigation', function()
+    command('edit ./src/nvim/eval.c')
+    exec_lua([[
+      local lines = vim.api.nvim_buf_get_lines(0, 0, -1, true)
+      for i = 50, #lines, 97 do
+        lines[i] = lines[i] .. ' // changed'
+      end
+      vim.cmd('vnew')
+      vim.api.nvim_buf_set_lines(0, 0, -1, true, lines)
+      vim.cmd('diffthis | wincmd p | diffthis')
+    ]])
+    start_frames()
+    replay(rep(']c', 60))
+    replay(rep('<C-e>', 100))
+    replay(rep('[c', 60))
+    report('diff navigation')
+  end)
+end)
@@ -0,0 +1,32 @@
+local helpers = require('test.functional.helpers')(after_each)
+
+local clear = helpers.clear
+local exec_lua = helpers.exec_lua
+
+describe('undo perf', function()
+  before_each(clear)
+
+  it('undo and redo of a 500k line paste', function()
+    exec_lua([[
+      local lines = {}
+      for i = 1, 500000 do
+        lines[i] = 'pasted line ' .. i
+      end
+      vim.api.nvim_buf_set_lines(0, 0, -1, true, { 'first', 'last' })
+      vim.cmd('let &undolevels = &undolevels')
+      vim.api.nvim_buf_set_lines(0, 1, 1, true, lines)
+
+      local function measure(name, f)
+        local start = vim.uv.hrtime()
+        f()
+        print(string.format('\n%s: %0.3f ms', name, (vim.uv.hrtime() - start) / 1000000))
+      end
+      measure('undo', function()
+        vim.cmd('silent undo')
+      end)
+      measure('redo', function()
+        vim.cmd('silent redo')
+      end)
+    ]])
+  end)
+end)
@@ -14,6 +14,39 @@ before_each(clear)
 
 describe('autocmd api', function()
   describe('nvim_create_autocmd', function()
+    it('debounce', function()
+      meths.buf_set_lines(0, 0, -1, true, { 'a', 'b', 'c', 'd', 'e' })
+      exec_lua [[
+        _G.moved = 0
+        _G.plain = 0
+        vim.api.nvim_create_autocmd('CursorMoved', {
+          debounce = 50,
+          callback = function()
+            _G.moved = _G.moved + 1
+            _G.line = vim.fn.line('.')
+          end,
+        })
+        vim.api.nvim_create_autocmd('CursorMoved', {
+          callback = function()
+            _G.plain = _G.plain + 1
+          end,
+        })
+      ]]
+      helpers.feed('j')
+      helpers.feed('j')
+      helpers.feed('j')
+      helpers.retry(nil, 1000, function()
+        eq(1, exec_lua('return _G.moved'))
+      end)
+      eq(3, exec_lua('return _G.plain'))
+      eq(4, exec_lua('return _G.line'))
+
+      eq("Invalid 'debounce': out of range", pcall_err(meths.create_autocmd, 'CursorMoved', {
+        command = 'echo',
+        debounce = -1,
+      }))
+    end)
+
     it('validation', function()
       eq("Cannot use both 'callback' and 'command'", pcall_err(meths.create_autocmd, 'BufReadPost', {
         pattern = '*.py,*.pyi',
@@ -425,6 +425,26 @@ describe('api/buf', function()
         eq({"xxx", "yyy", "zzz"}, meths.buf_get_lines(0, 0, -1, true))
         eq({''}, meths.buf_get_lines(buf, 0, -1, true))
     end)
+
+    it('inserts many lines in the middle of the buffer', function()
+      exec_lua([[
+        local old = {}
+        for i = 1, 5000 do
+          old[i] = ('old %d'):format(i)
+        end
+        vim.api.nvim_buf_set_lines(0, 0, -1, true, old)
+        local new = {}
+        for i = 1, 20000 do
+          new[i] = ('new %d %s'):format(i, ('x'):rep(i % 50))
+        end
+        vim.api.nvim_buf_set_lines(0, 2500, 2500, true, new)
+      ]])
+      eq(25000, curbufmeths.line_count())
+      eq({'old 2500', 'new 1 x', 'new 2 xx'}, curbufmeths.get_lines(2499, 2502, true))
+      eq({'new 20000 ', 'old 2501'}, curbufmeths.get_lines(22499, 22501, true))
+      eq({'old 5000'}, curbufmeths.get_lines(-2, -1, true))
+      eq(funcs.line2byte(25001) - 1, funcs.wordcount().bytes)
+    end)
   end)
 
   describe('deprecated: {get,set,del}_line', function()
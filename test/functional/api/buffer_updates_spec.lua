@@ -759,6 +759,22 @@ describe('API: buffer events:', function()
     expectn('nvim_buf_changedtick_event', {b, tick})
   end)
 
+  it('sends byte-level updates with bytes=true', function()
+    clear()
+    local b, tick = editoriginal(false)
+    ok(buffer('attach', b, false, {bytes=true}))
+    expectn('nvim_buf_changedtick_event', {b, tick})
+
+    buffer('set_text', b, 0, 9, 0, 13, {'LINE'})
+    expectn('nvim_buf_bytes_event', {b, tick+1, 0, 9, 9, 0, 4, 4, 0, 4, 4, {'LINE'}})
+
+    buffer('set_text', b, 1, 0, 1, 0, {'ab', ''})
+    expectn('nvim_buf_bytes_event', {b, tick+2, 1, 0, 16, 0, 0, 0, 1, 0, 3, {'ab', ''}})
+
+    buffer('set_text', b, 0, 0, 0, 9, {''})
+    expectn('nvim_buf_bytes_event', {b, tick+3, 0, 0, 0, 0, 9, 9, 0, 0, 0, {''}})
+  end)
+
   it('returns a proper error on nonempty options dict', function()
     clear()
     local b = editoriginal(false)
@@ -1663,6 +1663,40 @@ describe('API/extmarks', function()
     feed('vj2ed')
     eq({}, get_extmark_by_id(ns, 4, {}))
   end)
+
+  it('can set many extmarks at once', function()
+    local lines = {}
+    for i = 1, 100 do
+      lines[i] = ('line %d'):format(i)
+    end
+    curbufmeths.set_lines(0, -1, true, lines)
+
+    local items, expected = {}, {}
+    for i = 0, 99 do
+      table.insert(items, {i, 1, i % 2 == 0 and { end_row = i, end_col = 4 } or nil})
+      table.insert(expected, {i + 1, i, 1})
+    end
+    -- an explicit id updates the mark at once
+    table.insert(items, {50, 0, { id = 1 }})
+    table.insert(items, {50, 2})
+
+    local ids = request('nvim_buf_set_extmarks', 0, ns, items)
+    eq(102, #ids)
+    eq(1, ids[101])
+    eq(101, ids[102])
+    local details = get_extmark_by_id(ns, 3, { details = true })[3]
+    eq({2, 4}, {details.end_row, details.end_col})
+    expected[1] = {1, 50, 0}
+    table.insert(expected, {101, 50, 2})
+    table.sort(expected, function(a, b)
+      return a[2] < b[2] or (a[2] == b[2] and a[3] < b[3])
+    end)
+    eq(expected, get_extmarks(ns, 0, -1))
+
+    eq("Invalid 'line': out of range",
+       pcall_err(request, 'nvim_buf_set_extmarks', 0, ns2, { {0, 0}, {200, 0}, {1, 0} }))
+    eq({{1, 0, 0}}, get_extmarks(ns2, 0, -1))
+  end)
 end)
 
 describe('Extmarks buffer api with many marks', function()
@@ -452,6 +452,12 @@ describe('API', function()
       eq({v1 = 'a', v2 = { 1, 2, { v3 = 3 } } }, nvim('eval', 'g:'))
     end)
 
+    it('converts lists of numbers and strings', function()
+      eq({ 1, 'a', 0.5 }, nvim('eval', "[1, 'a', 0.5]"))
+      eq({ { 'x' }, { 1, 2 }, {} }, nvim('eval', "[['x'], [1, 2], []]"))
+      eq({ true, 'a' }, nvim('eval', "[v:true, 'a']"))
+    end)
+
     it('handles NULL-initialized strings correctly', function()
       eq(1, nvim('eval',"matcharg(1) == ['', '']"))
       eq({'', ''}, nvim('eval','matcharg(1)'))
@@ -627,6 +633,21 @@ describe('API', function()
         pcall_err(meths.exec_lua, 'error("did\\nthe\\nfail")', {}))
     end)
 
+    it('runs the same source again', function()
+      for i = 1, 3 do
+        eq(i + 1, meths.exec_lua('n = (n or 0) + 1\nreturn n + ...', {1}))
+        eq([[Error loading lua: [string "<nvim>"]:0: '=' expected near '+']],
+          pcall_err(meths.exec_lua, 'a+*b', {}))
+      end
+      -- more distinct sources than are kept compiled
+      for _ = 1, 2 do
+        for i = 1, 50 do
+          eq(i * 2, meths.exec_lua('return ... * 2 -- ' .. i, {i}))
+        end
+      end
+      eq(5, meths.exec_lua('n = (n or 0) + 1\nreturn n + ...', {1}))
+    end)
+
     it('uses native float values', function()
       eq(2.5, meths.exec_lua("return select(1, ...)", {2.5}))
       eq("2.5", meths.exec_lua("return vim.inspect(...)", {2.5}))
@@ -663,6 +684,53 @@ describe('API', function()
     end)
   end)
 
+  describe('nvim__stats', function()
+    it('has histograms for input, events and redraw', function()
+      local screen = Screen.new(40, 8)
+      screen:attach()
+      feed('ihello<Esc>')
+      screen:expect({ any = 'hello' })
+      local stats = request('nvim__stats')
+      for _, name in ipairs({ 'input_latency', 'event_batch', 'update_screen' }) do
+        local hist = stats[name]
+        eq(20, #hist.buckets, name)
+        local sum = 0
+        for _, n in ipairs(hist.buckets) do
+          sum = sum + n
+        end
+        eq(hist.count, sum, name)
+        ok(hist.total >= hist.max, name)
+      end
+      ok(stats.input_latency.count > 0)
+      ok(stats.update_screen.count > 0)
+    end)
+
+    it('has allocation accounting when enabled', function()
+      eq(nil, request('nvim__stats').alloc)
+      request('nvim__alloc_track', true)
+      exec_lua([[
+        local lines = {}
+        for i = 1, 100 do
+          lines[i] = ('line %d'):format(i)
+        end
+        vim.api.nvim_buf_set_lines(0, 0, -1, true, lines)
+        local ns = vim.api.nvim_create_namespace('alloc')
+        for i = 0, 99 do
+          vim.api.nvim_buf_set_extmark(0, ns, i, 0, {})
+        end
+      ]])
+      local alloc = request('nvim__stats').alloc
+      for _, name in ipairs({ 'other', 'memline', 'undo', 'eval', 'lua', 'extmark', 'rpc' }) do
+        ok(alloc[name].bytes >= 0, name)
+        ok(alloc[name].count >= 0, name)
+      end
+      ok(alloc.undo.bytes > 0)
+      ok(alloc.extmark.count > 0)
+      request('nvim__alloc_track', false)
+      eq(nil, request('nvim__stats').alloc)
+    end)
+  end)
+
   describe('nvim_paste', function()
     it('validation', function()
       eq("Invalid 'phase': -2",
@@ -645,4 +645,24 @@ describe('autocmd', function()
       vim.cmd "tabnew"
     ]]
   end)
+
+  it('"*" and "*.ext" patterns', function()
+    source([[
+      let g:events = []
+      autocmd BufNew * call add(g:events, 'any ' .. expand('<afile>:t'))
+      autocmd BufNew *.Xext call add(g:events, 'ext ' .. expand('<afile>:t'))
+      set nofileignorecase
+      badd foo.Xext
+      badd foo.xext
+      badd Xext
+      set fileignorecase
+      badd bar.xext
+    ]])
+    eq({
+      'any foo.Xext', 'ext foo.Xext',
+      'any foo.xext',
+      'any Xext',
+      'any bar.xext', 'ext bar.xext',
+    }, eval('g:events'))
+  end)
 end)
@@ -162,6 +162,25 @@ describe('jobs', function()
     eq(expected, actual)
   end)
 
+  it('appends output to a buffer with stdout_buffer', function()
+    eq({ 'one', 'two', 'x\0z', 'last' }, exec_lua([[
+      local buf = vim.api.nvim_create_buf(false, true)
+      vim.fn.jobstart({
+        vim.v.progpath, '--clean', '--headless',
+        '+lua io.stdout:write("one\\ntwo\\nx\\0z\\nlast")', '+qa!',
+      }, { stdout_buffer = buf })
+      vim.wait(10000, function()
+        return vim.api.nvim_buf_get_lines(buf, -2, -1, true)[1] == 'last'
+      end)
+      return vim.api.nvim_buf_get_lines(buf, 0, -1, true)
+    ]]))
+
+    matches('E86: Buffer 9999 does not exist',
+      pcall_err(eval, [[jobstart(['true'], {'stdout_buffer': 9999})]]))
+    matches('E475: Invalid argument: stdout_buffer cannot be used with on_stdout',
+      pcall_err(eval, [[jobstart(['true'], {'stdout_buffer': 0, 'on_stdout': 'OnEvent'})]]))
+  end)
+
   it('uses &shell and &shellcmdflag if passed a string', function()
     nvim('command', "let $VAR = 'abc'")
     if is_os('win') then
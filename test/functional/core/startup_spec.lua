@@ -64,6 +64,15 @@ describe('startup', function()
     assert_log("require%('vim%._editor'%)", testfile, 100)
   end)
 
+  it('--startuptime logs autocommands', function()
+    local testfile = 'Xtest_startuptime'
+    finally(function()
+      os.remove(testfile)
+    end)
+    clear({ args = {'--startuptime', testfile, '--cmd', 'autocmd VimEnter * let g:entered = 1'}})
+    assert_log('VimEnter autocommands for', testfile, 100)
+  end)
+
   it('-D does not hang #12647', function()
     clear()
     local screen
@@ -9,6 +9,7 @@ local curbufmeths = helpers.curbufmeths
 local command = helpers.command
 local meths = helpers.meths
 local poke_eventloop = helpers.poke_eventloop
+local write_file = helpers.write_file
 
 describe('completion', function()
   local screen
@@ -1257,4 +1258,31 @@ describe('completion', function()
       {3:-- }{4:match 1 of 2}     |
     ]]}
   end)
+
+  it('completes words from other buffers after they change', function()
+    command('set hidden complete=b')
+    funcs.setline(1, { 'foo bar', 'fob foo', 'food' })
+    command('enew')
+    command('inoremap <F2> <Cmd>let g:words = map(complete_info(["items"]).items, "v:val.word")<CR>')
+    feed('ifo<C-N><F2><Esc>')
+    eq({ 'foo', 'fob', 'food' }, eval('g:words'))
+    funcs.setbufline(1, 2, 'fox foo')
+    feed('ccfo<C-N><F2><Esc>')
+    eq({ 'foo', 'fox', 'food' }, eval('g:words'))
+  end)
+
+  it('completes from a dictionary file after it changes', function()
+    local dict = 'Xcompletion_dict'
+    finally(function()
+      os.remove(dict)
+    end)
+    write_file(dict, 'apple\napricot\nbanana\n')
+    command('set dictionary=' .. dict)
+    command('inoremap <F2> <Cmd>let g:words = map(complete_info(["items"]).items, "v:val.word")<CR>')
+    feed('iap<C-X><C-K><F2><Esc>')
+    eq({ 'apple', 'apricot' }, eval('g:words'))
+    write_file(dict, 'apple\napricot\napex\nbanana\n')
+    feed('ccap<C-X><C-K><F2><Esc>')
+    eq({ 'apple', 'apricot', 'apex' }, eval('g:words'))
+  end)
 end)
@@ -48,6 +48,26 @@ hello]]
     feed[[G3Q]]
     eq({'helloFOOFOO', 'hello', 'helloFOOFOOFOO'}, curbufmeths.get_lines(0, -1, false))
   end)
+
+  it('replays a large multi-line register in order', function()
+    local lines = {}
+    for i = 1, 2000 do
+      lines[i] = 'call append("$", "' .. i .. '")'
+    end
+    funcs.setreg('q', lines, 'l')
+    command('@q')
+    local buf = curbufmeths.get_lines(0, -1, false)
+    eq(2001, #buf)
+    eq({'', '1', '2'}, { buf[1], buf[2], buf[3] })
+    eq('2000', buf[2001])
+  end)
+
+  it('handles line continuation with :@', function()
+    funcs.setreg('q', { 'let g:l = [1,', '\\ 2,', '\\ 3]', 'let g:m = 4' }, 'l')
+    command('@q')
+    eq({1, 2, 3}, meths.get_var('l'))
+    eq(4, meths.get_var('m'))
+  end)
 end)
 
 describe('immediately after a macro has finished executing,', function()
@@ -590,6 +590,25 @@ describe('put command', function()
       )
     )
 
+    it('puts several lines with a count and undoes them at once', function()
+      funcs.setreg('a', {'one', 'two', 'three'}, 'V')
+      feed('"a2p')
+      expect([[
+      Line of words 1
+      one
+      two
+      three
+      one
+      two
+      three
+      Line of words 2]])
+      eq({0, 7, 5, 0}, funcs.getpos("']"))
+      feed('u')
+      expect([[
+      Line of words 1
+      Line of words 2]])
+    end)
+
   end)
 
   describe('blockwise register', function()
@@ -201,3 +201,111 @@ describe(':undo! command', function()
     eq('E5767: Cannot use :undo! to redo or move to a different undo branch', eval('v:errmsg'))
   end)
 end)
+
+describe('undo of a change in many lines', function()
+  before_each(clear)
+
+  it('restores the lines in one step', function()
+    insert([[
+      foo 1
+      bar 2
+      foo 3
+      foo 4
+      bar 5]])
+    command('%s/foo/xyz/')
+    command('2,4s/\\d/&&/')
+    expect([[
+      xyz 1
+      bar 22
+      xyz 33
+      xyz 44
+      bar 5]])
+    feed('u')
+    expect([[
+      xyz 1
+      bar 2
+      xyz 3
+      xyz 4
+      bar 5]])
+    feed('u')
+    expect([[
+      foo 1
+      bar 2
+      foo 3
+      foo 4
+      bar 5]])
+    feed('<C-r><C-r>')
+    expect([[
+      xyz 1
+      bar 22
+      xyz 33
+      xyz 44
+      bar 5]])
+  end)
+
+  it('restores lines when the line count changed', function()
+    insert([[
+      a1
+      a2
+      a3
+      a4]])
+    command('%s/a/b\\rc/')
+    expect([[
+      b
+      c1
+      b
+      c2
+      b
+      c3
+      b
+      c4]])
+    command('g/c/s/$/!/ | s/c/d/')
+    expect([[
+      b
+      d1!
+      b
+      d2!
+      b
+      d3!
+      b
+      d4!]])
+    feed('u')
+    expect([[
+      b
+      c1
+      b
+      c2
+      b
+      c3
+      b
+      c4]])
+    feed('u')
+    expect([[
+      a1
+      a2
+      a3
+      a4]])
+  end)
+
+  it('only restores changed lines when a range was replaced', function()
+    helpers.meths.buf_set_lines(0, 0, -1, true, { 'a', 'b', 'c', 'd', 'e' })
+    command('let &undolevels = &undolevels')
+    helpers.meths.buf_set_lines(0, 0, -1, true, { 'a', 'b', 'X', 'd', 'e' })
+    feed('u')
+    expect([[
+      a
+      b
+      c
+      d
+      e]])
+    eq({ 3, 3 }, { funcs.line("'["), funcs.line("']") })
+    feed('<C-r>')
+    expect([[
+      a
+      b
+      X
+      d
+      e]])
+    eq({ 3, 3 }, { funcs.line("'["), funcs.line("']") })
+  end)
+end)
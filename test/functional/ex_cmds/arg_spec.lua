@@ -28,3 +28,24 @@ describe(":argument", function()
       eq(bufnr_before, bufnr_after)
   end)
 end)
+
+describe(":argadd", function()
+  before_each(function()
+    clear()
+  end)
+
+  it("re-uses existing buffers for many files", function()
+    command("edit Xarg1")
+    command("badd Xold")
+    command("autocmd BufAdd Xarg2 ++once call nvim_buf_set_name(bufnr('Xold'), 'Xarg5')")
+    local files = {}
+    for i = 1, 500 do
+      table.insert(files, "Xarg" .. (i % 250 + 1))
+    end
+    command("argadd " .. table.concat(files, " "))
+    eq(files, funcs.argv())
+    eq(250, #funcs.getbufinfo({ buflisted = 1 }))
+    eq(1, funcs.bufnr("Xarg1"))
+    eq(2, funcs.bufnr("Xarg5"))
+  end)
+end)
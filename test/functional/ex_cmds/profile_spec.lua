@@ -97,4 +97,31 @@ describe(':profile', function()
       matches('Called 1 time', profile)
     end)
   end)
+
+  describe('sample', function()
+    it('writes folded stacks with Vimscript frames', function()
+      helpers.skip(helpers.is_os('win'), 'N/A for Windows')
+      source([[
+        function! BusyLoop()
+          let start = reltime()
+          while reltimefloat(reltime(start)) < 0.3
+          endwhile
+        endfunction
+      ]])
+      command('profile sample start ' .. tempfile)
+      eq('Vim(profile):E5800: Sampling profiler is already running',
+         helpers.pcall_err(command, 'profile sample start ' .. tempfile))
+      command('call BusyLoop()')
+      command('profile sample stop')
+      assert_file_exists(tempfile)
+      -- e.g. "normal;BusyLoop 290"
+      matches('BusyLoop %d+\n', read_file(tempfile))
+      eq(0, eval('v:profiling'))
+    end)
+
+    it('gives an error when not running', function()
+      eq('Vim(profile):E5801: Sampling profiler is not running',
+         helpers.pcall_err(command, 'profile sample stop'))
+    end)
+  end)
 end)
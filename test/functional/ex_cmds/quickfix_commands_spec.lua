@@ -144,3 +144,42 @@ it(':vimgrep can specify Unicode pattern without delimiters', function()
     :vimgrep →^                              |
   ]])
 end)
+
+it("'errorformat' that starts with a character", function()
+  command([[set errorformat=E\ %f:%l:%m,x%#%f:%l:%m,%f:%l:%m]])
+  command([[cgetexpr ['e foo.c:1:one', 'bar.c:2:two', 'xxbaz.c:3:three', 'baz.c:4:four']])
+  local items = {}
+  for _, item in ipairs(funcs.getqflist()) do
+    table.insert(items, { funcs.bufname(item.bufnr), item.lnum, item.text })
+  end
+  eq({
+    { 'foo.c', 1, 'one' },
+    { 'bar.c', 2, 'two' },
+    { 'baz.c', 3, 'three' },
+    { 'baz.c', 4, 'four' },
+  }, items)
+end)
+
+it(':vimgrep with a plain text pattern', function()
+  write_file('Xvimgrep1', 'one\nFoo bar\n')
+  write_file('Xvimgrep2', 'nothing here\n')
+  write_file('Xvimgrep3', 'foo bar and more\n')
+  finally(function()
+    os.remove('Xvimgrep1')
+    os.remove('Xvimgrep2')
+    os.remove('Xvimgrep3')
+  end)
+  command('set ignorecase')
+  command('vimgrep /foo bar/j Xvimgrep1 Xvimgrep2 Xvimgrep3')
+  local items = {}
+  for _, item in ipairs(funcs.getqflist()) do
+    table.insert(items, { funcs.bufname(item.bufnr), item.lnum, item.text })
+  end
+  eq({
+    { 'Xvimgrep1', 2, 'Foo bar' },
+    { 'Xvimgrep3', 1, 'foo bar and more' },
+  }, items)
+  command('set noignorecase')
+  command('vimgrep /foo bar/j Xvimgrep1 Xvimgrep2 Xvimgrep3')
+  eq(1, #funcs.getqflist())
+end)
@@ -0,0 +1,32 @@
+local helpers = require('test.functional.helpers')(after_each)
+local clear = helpers.clear
+local command = helpers.command
+local eq = helpers.eq
+local eval = helpers.eval
+local mkdir_p = helpers.mkdir_p
+local rmdir = helpers.rmdir
+local write_file = helpers.write_file
+
+describe(':runtime', function()
+  before_each(function()
+    clear()
+    mkdir_p('Xruntime/plugin')
+    command('set runtimepath^=Xruntime')
+  end)
+
+  after_each(function()
+    rmdir('Xruntime')
+  end)
+
+  it('finds a directory that was added later', function()
+    command('let g:sourced = 0')
+    command('runtime! ftplugin/Xruntime.vim')
+    eq(0, eval('g:sourced'))
+    mkdir_p('Xruntime/ftplugin')
+    write_file('Xruntime/ftplugin/Xruntime.vim', 'let g:sourced += 1')
+    command('runtime! ftplugin/Xruntime.vim')
+    eq(1, eval('g:sourced'))
+    command('runtime! ftplugin/Xrun*.vim')
+    eq(2, eval('g:sourced'))
+  end)
+end)
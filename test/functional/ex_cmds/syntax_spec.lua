@@ -3,6 +3,9 @@ local helpers = require('test.functional.helpers')(after_each)
 local eq = helpers.eq
 local clear = helpers.clear
 local exc_exec = helpers.exc_exec
+local command = helpers.command
+local exec = helpers.exec
+local funcs = helpers.funcs
 
 describe(':syntax', function()
   before_each(clear)
@@ -14,4 +17,29 @@ describe(':syntax', function()
          exc_exec('syntax keyword \024 foo bar'))
     end)
   end)
+
+  describe('match', function()
+    local function names(line)
+      local result = {}
+      for col = 1, #funcs.getline(line) do
+        local name = funcs.synIDattr(funcs.synID(line, col, 0), 'name')
+        result[#result + 1] = name == '' and '.' or name:sub(1, 1)
+      end
+      return table.concat(result)
+    end
+
+    it('finds patterns that match several times in a line', function()
+      exec([[
+        call setline(1, ['x a1 b2 a3 b4 xy', 'c1c2 yc3'])
+        syntax match Aaa /a\d/
+        syntax match Bbb /b\d/
+        syntax match Ccc /c\d/
+        syntax match Xxx /x\zsy/
+      ]])
+      eq('..AA.BB.AA.BB..X', names(1))
+      eq('CCCC..CC', names(2))
+      command('syntax match Ddd /\s\a/')
+      eq('.DD.DD.DD.DD.DDX', names(1))
+    end)
+  end)
 end)
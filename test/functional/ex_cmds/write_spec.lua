@@ -120,6 +120,17 @@ describe(':write', function()
     end
   end)
 
+  it('writes NUL bytes and CRs in lines longer than the write buffer', function()
+    local long = ('x'):rep(10000)
+    meths.buf_set_lines(0, 0, -1, true, { long .. '\0a\rb' .. long, 'c\rd\0' })
+    command('set fileformat=unix')
+    command('write ' .. fname)
+    eq(long .. '\0a\rb' .. long .. '\nc\rd\0\n', helpers.read_file(fname))
+    command('set fileformat=mac')
+    command('write! ' .. fname)
+    eq(long .. '\0a\nb' .. long .. '\rc\nd\0\r', helpers.read_file(fname))
+  end)
+
   it('errors out correctly', function()
     skip(is_ci('cirrus'))
     command('let $HOME=""')
@@ -17,6 +17,23 @@ describe(':wundo', function()
     command('wundo foo') -- This should not segfault. #1027
     --TODO: check messages for error message
   end)
+
+  it('restores a long history with branches with :rundo', function()
+    helpers.exec([[
+      for i in range(1, 2000)
+        call setline(1, 'line ' .. i)
+        let &undolevels = &undolevels
+      endfor
+      undo 1000
+      call setline(1, 'branch')
+      let &undolevels = &undolevels
+      undo 500
+    ]])
+    local before = eval('undotree()')
+    command('wundo foo')
+    command('rundo foo')
+    helpers.eq(before, eval('undotree()'))
+  end)
 end)
 
 describe('u_* functions', function()
@@ -48,6 +48,17 @@ describe('vim.base64', function()
       eq(v, decode(encode(v)))
     end
 
+    -- Binary data, and enough of it for the 4 characters at a time path
+    eq('\0a\0\255', decode(encode('\0a\0\255')))
+    local long = exec_lua([[
+      local t = {}
+      for i = 0, 1000 do
+        t[#t + 1] = string.char(i % 256)
+      end
+      return table.concat(t)
+    ]])
+    eq(long, decode(encode(long)))
+
     -- Explicitly check encoded output
     eq('VGhlIHF1aWNrIGJyb3duIGZveCBqdW1wcyBvdmVyIHRoZSBsYXp5IGRvZwo=', encode('The quick brown fox jumps over the lazy dog\n'))
 
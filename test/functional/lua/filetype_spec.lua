@@ -78,6 +78,24 @@ describe('vim.filetype', function()
     ]], root))
   end)
 
+  it('works with patterns that end in special items', function()
+    eq({ 'foo_a', 'foo_b', 'foo_b', 'foo_c' }, exec_lua [[
+      vim.filetype.add({
+        pattern = {
+          ['.*/Xfoo%.conf'] = 'foo_a',
+          ['Xfoo%.cfgx?'] = 'foo_b',
+          ['Xfoo[%d]'] = 'foo_c',
+        }
+      })
+      return {
+        vim.filetype.match({ filename = '/a/Xfoo.conf' }),
+        vim.filetype.match({ filename = 'Xfoo.cfg' }),
+        vim.filetype.match({ filename = 'Xfoo.cfgx' }),
+        vim.filetype.match({ filename = 'Xfoo1' }),
+      }
+    ]])
+  end)
+
   it('works with functions', function()
     command('new')
     command('file relevant_to_me')
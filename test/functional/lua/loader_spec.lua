@@ -53,4 +53,30 @@ describe('vim.loader', function()
     eq(1, exec_lua('return loadfile(...)()', tmp1))
     eq(2, exec_lua('return loadfile(...)()', tmp2))
   end)
+
+  it('caches bytecode of modules on the runtimepath', function()
+    local dir = helpers.tmpname()
+    assert(os.remove(dir))
+    assert(helpers.mkdir(dir))
+    assert(helpers.mkdir(dir .. '/lua'))
+    local mod = dir .. '/lua/cachedmod.lua'
+    helpers.write_file(mod, 'return 1', true)
+    vim.uv.fs_utime(mod, 0, 0)
+
+    exec_lua('vim.opt.rtp:prepend(...)', dir)
+    eq(1, exec_lua([[return require('cachedmod')]]))
+    local cname = exec_lua([[
+      local path = vim.api.nvim__get_runtime({ 'lua/cachedmod.lua' }, false, { is_lua = true })[1]
+      return vim.fn.stdpath('cache') .. '/luac/' .. vim.uri_encode(path, 'rfc2396') .. 'c'
+    ]])
+    eq(true, vim.uv.fs_stat(cname) ~= nil)
+
+    -- a changed file is compiled again
+    helpers.write_file(mod, 'return 22', true)
+    vim.uv.fs_utime(mod, 0, 0)
+    eq(22, exec_lua([[
+      package.loaded.cachedmod = nil
+      return require('cachedmod')
+    ]]))
+  end)
 end)
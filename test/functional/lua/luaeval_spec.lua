@@ -142,6 +142,9 @@ describe('luaeval()', function()
     eq({}, funcs.luaeval('_A', {}))
     eq({test=1}, funcs.luaeval('_A', {test=1}))
     eq({4, 2}, funcs.luaeval('_A', {4, 2}))
+    eq({'a', 1, {2, 'b'}, 'c', 1.5}, funcs.luaeval('_A', {'a', 1, {2, 'b'}, 'c', 1.5}))
+    eq({'a', 'b', 3}, eval([[luaeval('{"a", "b", 3}')]]))
+    eq({'a', 1, {}, 'c'}, eval([[luaeval('{"a", 1, {}, "c"}')]]))
     local level = 28
     eq(nested_by_level[level].o, funcs.luaeval('_A', nested_by_level[level].o))
   end)
@@ -531,6 +534,26 @@ describe('v:lua', function()
     eq("hey line", meths.get_current_line())
   end)
 
+  it('works in expr options', function()
+    exec_lua([[
+      function _G.foldlevel()
+        return vim.v.lnum > 1 and '>1' or 0
+      end
+    ]])
+    command([[call setline(1, ['a', 'b', 'c'])]])
+    command('setlocal foldmethod=expr foldexpr=v:lua.foldlevel()')
+    eq({0, 1, 1}, eval('map([1, 2, 3], "foldlevel(v:val)")'))
+
+    -- the function is looked up again when it is redefined
+    exec_lua([[
+      function _G.foldlevel()
+        return 2
+      end
+    ]])
+    command('normal! zx')
+    eq({2, 2, 2}, eval('map([1, 2, 3], "foldlevel(v:val)")'))
+  end)
+
   it('supports packages', function()
     command('set pp+=test/functional/fixtures')
     eq('\tbadval', eval("v:lua.require'leftpad'('badval')"))
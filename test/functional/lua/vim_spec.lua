@@ -204,6 +204,38 @@ describe('lua stdlib', function()
     eq("index out of range", pcall_err(exec_lua, "return vim.str_utfindex(_G.test_text, ...)", len + 1))
   end)
 
+  it("vim.str_utfindex/str_byteindex with a list of indices", function()
+    exec_lua([[_G.test_text = string.rep("xy åäö ɧ 汉语 ↥ 🤦x🦄 å بِيَّ\000ъ", 3)]])
+    eq(true, exec_lua([[
+      local len = #_G.test_text
+      local idx = {}
+      for k = 0, len do
+        idx[#idx + 1] = k
+      end
+      local l32, l16 = vim.str_utfindex(_G.test_text, idx)
+      for k = 0, len do
+        local i32, i16 = vim.str_utfindex(_G.test_text, k)
+        assert(l32[k + 1] == i32 and l16[k + 1] == i16, k)
+      end
+      for _, use_utf16 in ipairs({false, true}) do
+        local n = use_utf16 and l16[#l16] or l32[#l32]
+        local units = {}
+        for i = 0, n do
+          units[i + 1] = i
+        end
+        local bytes = vim.str_byteindex(_G.test_text, units, use_utf16)
+        for i = 0, n do
+          assert(bytes[i + 1] == vim.str_byteindex(_G.test_text, i, use_utf16), i)
+        end
+      end
+      return true
+    ]]))
+    eq({{}, {}}, exec_lua("return {vim.str_utfindex(_G.test_text, {})}"))
+    eq("index out of range", pcall_err(exec_lua, "return vim.str_utfindex(_G.test_text, {1, #_G.test_text + 1})"))
+    eq("index out of range", pcall_err(exec_lua, "return vim.str_byteindex(_G.test_text, {1, 1000})"))
+    eq("index list must contain integers", pcall_err(exec_lua, "return vim.str_byteindex(_G.test_text, {'x'})"))
+  end)
+
   it("vim.str_utf_start", function()
     exec_lua([[_G.test_text = "xy åäö ɧ 汉语 ↥ 🤦x🦄 å بِيَّ"]])
     local expected_positions = {0,0,0,0,-1,0,-1,0,-1,0,0,-1,0,0,-1,-2,0,-1,-2,0,0,-1,-2,0,0,-1,-2,-3,0,0,-1,-2,-3,0,0,0,-1,0,0,-1,0,-1,0,-1,0,-1,0,-1}
@@ -314,10 +346,15 @@ describe('lua stdlib', function()
       { '\n',              '[:\n]', false, true,  {} },
       { '',                'a',     false, false, { '' } },
       { 'x*yz*oo*l',       '*',     true,  false, { 'x', 'yz', 'oo', 'l' } },
+      { 'xaaa',            'aa',    false, false, { 'x', 'a' } },
+      { 'aaa',             'aa',    true,  true,  { 'a' } },
+      { 'a<>b<><>',        '<>',    false, true,  { 'a', 'b' } },
+      { 'a\nb\n',          '\n',    false, false, { 'a', 'b', '' } },
     }
 
     for _, t in ipairs(tests) do
       eq(t[5], vim.split(t[1], t[2], {plain=t[3], trimempty=t[4]}), t[1])
+      eq(t[5], exec_lua('return vim.split(...)', t[1], t[2], {plain=t[3], trimempty=t[4]}), t[1])
     end
 
     -- Test old signature
@@ -339,6 +376,8 @@ describe('lua stdlib', function()
       pcall_err(vim.split, 'string', 1))
     matches('opts: expected table, got number',
       pcall_err(vim.split, 'string', 'string', 1))
+    matches('opts: expected table, got number',
+      pcall_err(exec_lua, 'return vim.split(...)', 'string', 'string', 1))
   end)
 
   it('vim.trim', function()
@@ -489,6 +528,12 @@ describe('lua stdlib', function()
     end
   end)
 
+  it('vim.tbl_flatten', function()
+    eq({}, exec_lua("return vim.tbl_flatten({})"))
+    eq({1, 2, 3, 4, 5}, exec_lua("return vim.tbl_flatten({1, {2, {{3}, {}}}, {4, false, 5}})"))
+    eq({'a', 'b'}, exec_lua("return vim.tbl_flatten({{}, {{'a'}}, 'b', {{}}})"))
+  end)
+
   it('vim.tbl_values', function()
     eq({}, exec_lua("return vim.tbl_values({})"))
     for _, v in pairs(exec_lua("return vim.tbl_values({'a', 'b', 'c'})")) do
@@ -2373,6 +2418,14 @@ describe('lua stdlib', function()
     eq({}, exec_lua[[return {re1:match_line(0, 1, 1, 7)}]])
     eq({0,3}, exec_lua[[return {re1:match_line(0, 1, 0, 7)}]])
 
+    meths.buf_set_lines(0, 0, -1, true, {"abc abbc", "yy", "xabbbc", "héé"})
+    eq({0,0,3, 2,1,6}, exec_lua[[return re1:match_lines(0)]])
+    eq({0,0,3, 0,4,8, 2,1,6}, exec_lua[[return re1:match_lines(0, 0, -1, {all = true})]])
+    eq({2,1,6}, exec_lua[[return re1:match_lines(0, 1, 3, {all = true})]])
+    eq({}, exec_lua[[return re1:match_lines(0, 1, 2)]])
+    eq({3,0,0, 3,1,1, 3,3,3, 3,5,5}, exec_lua[[return vim.regex('x*'):match_lines(0, -2, -1, {all = true})]])
+    matches('invalid end', pcall_err(exec_lua, [[return re1:match_lines(0, 2, 1)]]))
+
     -- vim.regex() error inside :silent! should not crash. #20546
     command([[silent! lua vim.regex('\\z')]])
     assert_alive()
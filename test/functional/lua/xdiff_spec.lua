@@ -92,6 +92,41 @@ describe('xdiff bindings', function()
         exec_lua([[return vim.diff(a2, b2, {result_type = 'indices'})]]))
     end)
 
+    it('with on_done', function()
+      eq({
+        { vim.NIL, '@@ -1 +1 @@\n-Hello\n+Helli\n' },
+        { vim.NIL, { { 1, 1, 1, 1 }, { 3, 1, 3, 2 } } },
+      }, exec_lua([[
+        local res = {}
+        assert(vim.diff(a1, b1, { on_done = function(err, r)
+          res[1] = { err == nil and vim.NIL or err, r }
+        end }) == nil)
+        vim.diff(a2, b2, { result_type = 'indices', on_done = function(err, r)
+          res[2] = { err == nil and vim.NIL or err, r }
+        end })
+        vim.wait(1000, function()
+          return #res == 2
+        end)
+        return res
+      ]]))
+
+      -- a newer diff in the same group cancels the running one
+      eq({ 'second' }, exec_lua([[
+        local res = {}
+        vim.diff(a2, b2, { group = 'g', on_done = function()
+          table.insert(res, 'first')
+        end })
+        vim.diff(a1, b1, { group = 'g', on_done = function()
+          table.insert(res, 'second')
+        end })
+        vim.wait(1000, function()
+          return #res > 0
+        end)
+        vim.wait(50)
+        return res
+      ]]))
+    end)
+
     it('can run different algorithms', function()
       local a = table.concat({
         '.foo1 {',
@@ -152,5 +187,8 @@ describe('xdiff bindings', function()
     eq([[on_hunk is not a function]],
       pcall_err(exec_lua, [[vim.diff('a', 'b', { on_hunk = true })]]))
 
+    eq([[on_hunk cannot be used with on_done]],
+      pcall_err(exec_lua, [[vim.diff('a', 'b', { on_hunk = print, on_done = print })]]))
+
   end)
 end)
@@ -216,6 +216,23 @@ describe('ShaDa support code', function()
     eq(2, nvim_current_line())
   end)
 
+  it('restores local marks and change list of a file given as argument', function()
+    nvim_command('edit ' .. testfilename)
+    nvim_command('normal! Gra')
+    nvim_command('normal! ggrb')
+    nvim_command('2')
+    nvim_command('mark a')
+    expect_exit(nvim_command, 'qall!')
+    reset({ args = { testfilename } })
+    eq(testfilename, funcs.bufname('%'))
+    nvim_command('normal! gg`a')
+    eq(2, nvim_current_line())
+    nvim_command('normal! Gg;')
+    eq(1, nvim_current_line())
+    nvim_command('normal! g;')
+    eq(2, nvim_current_line())
+  end)
+
   -- -c temporary sets lnum to zero to make `+/pat` work, so calling setpcmark()
   -- during -c used to add item with zero lnum to jump list.
   it('does not create incorrect file for non-existent buffers when writing from -c',
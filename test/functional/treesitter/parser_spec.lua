@@ -128,6 +128,27 @@ void ui_refresh(void)
     }, res)
   end)
 
+  it('parses buffer in the background', function()
+    insert(test_text);
+
+    local res = exec_lua([[
+      local parser = vim.treesitter.get_parser(0, "c")
+      local done
+      parser:parse_async(nil, function(err, trees)
+        done = { err = err, trees = trees }
+      end)
+      -- edit while parsing, replayed on the tree once parsing is done
+      vim.api.nvim_buf_set_lines(0, 0, 1, false, { 'static void ui_refresh(void)' })
+      vim.wait(5000, function() return done ~= nil end)
+
+      local text = table.concat(vim.api.nvim_buf_get_lines(0, 0, -1, true), '\n')
+      local expected = vim.treesitter.get_string_parser(text, "c"):parse()[1]
+      return { done.err == nil, done.trees[1]:root():sexpr() == expected:root():sexpr(), parser:is_valid(true) }
+    ]])
+
+    eq({ true, true, true }, res)
+  end)
+
   it('does not get parser for empty filetype', function()
     insert(test_text);
 
@@ -232,6 +253,48 @@ void ui_refresh(void)
     }, res)
   end)
 
+  it('support caching captures', function()
+    insert(test_text)
+
+    local res = exec_lua([[
+      cquery = vim.treesitter.query.parse("c", ...)
+      parser = vim.treesitter.get_parser(0, "c")
+      tree = parser:parse()[1]
+      local function captures(opts, limit)
+        local res = {}
+        for cid, node in cquery:iter_captures(tree:root(), 0, 7, 14, opts) do
+          table.insert(res, {cquery.captures[cid], node:type(), node:range()})
+          if #res == limit then
+            break
+          end
+        end
+        return res
+      end
+      local expected = captures()
+      -- partial iteration is continued by the next one
+      local partial = captures({ cache = true }, 3)
+      return {
+        vim.deep_equal(partial, vim.list_slice(expected, 1, 3)),
+        vim.deep_equal(captures({ cache = true }), expected),
+        vim.deep_equal(captures({ cache = true }), expected),
+      }
+    ]], query)
+
+    eq({ true, true, true }, res)
+
+    -- editing the tree drops the cached captures
+    feed('9Gdd')
+    res = exec_lua([[
+      tree = parser:parse()[1]
+      local res = {}
+      for cid, node in cquery:iter_captures(tree:root(), 0, 7, 14, { cache = true }) do
+        table.insert(res, {cquery.captures[cid], node:type(), node:range()})
+      end
+      return res[1]
+    ]])
+    eq({ "keyword", "for", 8, 2, 8, 5 }, res)
+  end)
+
   it('support query and iter by match', function()
     insert(test_text)
 
@@ -164,6 +164,40 @@ describe('decorations providers', function()
     ]]}
   end)
 
+  it('can set marks for all lines in on_range', function()
+    insert(mulholland)
+    exec_lua [[
+      local api = vim.api
+      local hl = api.nvim_get_hl_id_by_name "ErrorMsg"
+      local test_ns = api.nvim_create_namespace "mulholland"
+      _G.ranges = {}
+      api.nvim_set_decoration_provider(test_ns, {
+        on_range = function(_, win, buf, start_row, end_row)
+          table.insert(_G.ranges, {win, buf, start_row, end_row})
+          for line = start_row, end_row do
+            api.nvim_buf_set_extmark(buf, test_ns, line, line,
+                               { end_line = line, end_col = line+1,
+                                 hl_group = hl,
+                                 ephemeral = true
+                                })
+          end
+        end;
+      })
+    ]]
+
+    screen:expect{grid=[[
+      {2:/}/ just to see if there was an accident |
+      /{2:/} on Mulholland Drive                  |
+      tr{2:y}_start();                            |
+      buf{2:r}ef_T save_buf;                      |
+      swit{2:c}h_buffer(&save_buf, buf);          |
+      posp {2:=} getmark(mark, false);            |
+      restor{2:e}_buffer(&save_buf);^              |
+                                              |
+    ]]}
+    eq({1000, 1, 0, 6}, exec_lua [[ return _G.ranges[1] ]])
+  end)
+
   it('can indicate spellchecked points', function()
     exec [[
     set spell
@@ -2126,6 +2160,62 @@ describe('extmark decorations', function()
                                                         |
     ]]}
   end)
+
+  it('updates width of virtual text when character widths change', function()
+    meths.buf_set_lines(0, 0, -1, true, { 'x' })
+    meths.buf_set_extmark(0, ns, 0, 1, { virt_text = {{ ('Ā'):rep(30) }}, virt_text_pos = 'inline' })
+    eq(1, meths.win_text_height(0, {}).all)
+    funcs.setcellwidths({{ 0x100, 0x100, 2 }})
+    eq(2, meths.win_text_height(0, {}).all)
+    funcs.setcellwidths({})
+    eq(1, meths.win_text_height(0, {}).all)
+  end)
+
+  it('updates highlights in all windows when marks change', function()
+    screen:try_resize(30, 9)
+    command('set noruler')
+    meths.set_hl(0, 'Mark', { bg = 'Yellow' })
+    meths.buf_set_lines(0, 0, -1, true, { 'line1', 'line2', 'line3', 'line4', 'line5', 'line6' })
+    local id = meths.buf_set_extmark(0, ns, 1, 0, { end_row = 3, end_col = 5, hl_group = 'Mark' })
+    command('split')
+    -- both windows start drawing inside the mark
+    command('windo 3 | normal! zt')
+    screen:expect([[
+      {34:line3}                         |
+      {34:line4}                         |
+      line5                         |
+      {40:[No Name] [+]                 }|
+      {34:^line3}                         |
+      {34:line4}                         |
+      line5                         |
+      {41:[No Name] [+]                 }|
+                                    |
+    ]])
+    meths.buf_del_extmark(0, ns, id)
+    screen:expect([[
+      line3                         |
+      line4                         |
+      line5                         |
+      {40:[No Name] [+]                 }|
+      ^line3                         |
+      line4                         |
+      line5                         |
+      {41:[No Name] [+]                 }|
+                                    |
+    ]])
+    meths.buf_set_extmark(0, ns, 1, 0, { end_row = 3, end_col = 5, hl_group = 'Mark' })
+    screen:expect([[
+      {34:line3}                         |
+      {34:line4}                         |
+      line5                         |
+      {40:[No Name] [+]                 }|
+      {34:^line3}                         |
+      {34:line4}                         |
+      line5                         |
+      {41:[No Name] [+]                 }|
+                                    |
+    ]])
+  end)
 end)
 
 describe('decorations: inline virtual text', function()
@@ -10,6 +10,8 @@ local dedent = helpers.dedent
 local exec = helpers.exec
 local eq = helpers.eq
 local meths = helpers.meths
+local funcs = helpers.funcs
+local retry = helpers.retry
 
 describe('Diff mode screen', function()
   local fname = 'Xtest-functional-diff-screen-1'
@@ -1734,3 +1736,60 @@ it('diff mode works properly if file contains NUL bytes vim-patch:8.2.3925', fun
                                             |
   ]])
 end)
+
+describe('diff after changing lines', function()
+  before_each(clear)
+
+  it('is the same as after a complete update', function()
+    exec([[
+      call setline(1, range(1, 30))
+      diffthis
+      vnew
+      call setline(1, range(1, 30))
+      5d
+      call setline(12, 'x')
+      call append(20, ['y', 'z'])
+      diffthis
+    ]])
+    local function diffinfo()
+      local res = {}
+      for lnum = 1, funcs.line('$') + 1 do
+        table.insert(res, { funcs.diff_filler(lnum), funcs.diff_hlID(lnum, 1) })
+      end
+      return res
+    end
+    feed('14GOnew<Esc>')
+    feed('3Gdd')
+    feed('21Gix<Esc>')
+    feed('Go<Esc>')
+    local updated = diffinfo()
+    command('diffupdate')
+    eq(diffinfo(), updated)
+    eq('DiffAdd', funcs.synIDattr(funcs.diff_hlID(13, 1), 'name'))
+  end)
+end)
+
+describe("'diffopt' async", function()
+  before_each(clear)
+
+  it('updates the diff after a change', function()
+    exec([[
+      set diffopt+=async
+      call setline(1, ['a', 'b', 'c'])
+      diffthis
+      vnew
+      call setline(1, ['a', 'b', 'c'])
+      diffthis
+    ]])
+    eq(0, funcs.diff_hlID(2, 1))
+    feed('2Gix<Esc>')
+    retry(nil, nil, function()
+      eq('DiffText', funcs.synIDattr(funcs.diff_hlID(2, 1), 'name'))
+    end)
+    feed('dd')
+    retry(nil, nil, function()
+      eq(1, funcs.diff_filler(2))
+      eq(0, funcs.diff_hlID(2, 1))
+    end)
+  end)
+end)
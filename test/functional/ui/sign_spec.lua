@@ -3,6 +3,8 @@ local Screen = require('test.functional.ui.screen')
 local clear, feed, command = helpers.clear, helpers.feed, helpers.command
 local source = helpers.source
 local meths = helpers.meths
+local funcs = helpers.funcs
+local eq = helpers.eq
 
 describe('Signs', function()
   local screen
@@ -685,4 +687,25 @@ describe('Signs', function()
                                                            |
     ]])
   end)
+
+  it('signcolumn=auto:N counts signs of ranged extmarks on every line', function()
+    local ns = meths.create_namespace('test')
+    local function signcols()
+      command('redraw')
+      return funcs.getwininfo(funcs.win_getid())[1].textoff / 2
+    end
+    meths.buf_set_lines(0, 0, -1, true, {'a', 'b', 'c', 'd', 'e', 'f'})
+    command('set signcolumn=auto:4')
+    meths.buf_set_extmark(0, ns, 0, 0, { end_row = 3, end_col = 0, sign_text = 'R' })
+    meths.buf_set_extmark(0, ns, 2, 0, { sign_text = 'A' })
+    eq(2, signcols())
+    meths.buf_set_extmark(0, ns, 5, 0, { sign_text = 'B' })
+    local id = meths.buf_set_extmark(0, ns, 3, 0, { sign_text = 'C' })
+    meths.buf_set_extmark(0, ns, 3, 0, { sign_text = 'D' })
+    eq(3, signcols())
+    meths.buf_del_extmark(0, ns, id)
+    eq(2, signcols())
+    meths.buf_clear_namespace(0, ns, 0, -1)
+    eq(0, signcols())
+  end)
 end)
@@ -204,6 +204,48 @@ describe("'spell'", function()
     ]])
   end)
 
+  it('updates unchanged lines when spell settings change', function()
+    exec([=[
+      call setline(1, [
+        \"This line has a sepll error. and missing caps.",
+        \"with missing caps here.",
+      \])
+      set spell spelllang=en
+    ]=])
+    screen:expect([[
+      ^This line has a {1:sepll} error. {2:and} missing caps.                                  |
+      {2:with} missing caps here.                                                         |
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+                                                                                      |
+    ]])
+    exec('set spellcapcheck=')
+    screen:expect([[
+      ^This line has a {1:sepll} error. and missing caps.                                  |
+      with missing caps here.                                                         |
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+                                                                                      |
+    ]])
+    exec('spellgood! sepll')
+    screen:expect([[
+      ^This line has a sepll error. and missing caps.                                  |
+      with missing caps here.                                                         |
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+      {0:~                                                                               }|
+                                                                                      |
+    ]])
+  end)
+
   -- oldtest: Test_spell_compatible()
   it([[redraws properly when using "C" and "$" is in 'cpo']], function()
     exec([=[
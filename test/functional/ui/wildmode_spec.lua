@@ -679,3 +679,23 @@ describe('ui/ext_wildmenu', function()
     ]]}
   end)
 end)
+
+describe('file name completion', function()
+  before_each(clear)
+  after_each(function()
+    helpers.rmdir('Xnarrow')
+  end)
+
+  it('narrows the matches when more characters are typed', function()
+    funcs.mkdir('Xnarrow/sub', 'p')
+    for _, name in ipairs({ 'abc', 'abd', 'acx', 'sub/abe' }) do
+      helpers.write_file('Xnarrow/' .. name, '')
+    end
+    command('set wildmenu wildmode=full')
+    command('cnoremap <F2> <Cmd>let g:line = getcmdline()<CR>')
+    feed(':e Xnarrow/a<Tab><BS><C-A><F2><Esc>')
+    eq('e Xnarrow/abc Xnarrow/abd', eval('g:line'))
+    feed(':e Xnarrow/a<Tab><BS><BS><C-A><F2><Esc>')
+    eq('e Xnarrow/abc Xnarrow/abd Xnarrow/acx', eval('g:line'))
+  end)
+end)
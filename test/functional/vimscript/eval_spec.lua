@@ -16,6 +16,7 @@ local mkdir = helpers.mkdir
 local clear = helpers.clear
 local eq = helpers.eq
 local exc_exec = helpers.exc_exec
+local exec = helpers.exec
 local exec_lua = helpers.exec_lua
 local exec_capture = helpers.exec_capture
 local eval = helpers.eval
@@ -278,6 +279,63 @@ describe('listing functions using :function', function()
   end)
 end)
 
+describe('comments in user functions', function()
+  before_each(clear)
+
+  it('are skipped without changing heredocs, line numbers or listing', function()
+    exec([[
+      func Func()
+        " a comment
+
+        let lines =<< trim END
+          " not a comment
+
+        END
+        return [lines, expand('<slnum>')]
+      endfunc
+    ]])
+    eq({ { '" not a comment', '' }, '8' }, eval('Func()'))
+    matches('\n1 +" a comment\n', exec_capture('function Func'))
+  end)
+end)
+
+describe('function calls in "expr" options', function()
+  before_each(clear)
+
+  it('call global and script-local functions', function()
+    exec([[
+      func FoldLevel()
+        return v:lnum > 1 ? '>1' : 0
+      endfunc
+      func s:Indent()
+        return v:lnum * 2
+      endfunc
+      call setline(1, ['a', 'b', 'c'])
+      setlocal foldmethod=expr foldexpr=FoldLevel()
+      let &l:indentexpr = expand('<SID>') .. 'Indent()'
+    ]])
+    eq({ 0, 1, 1 }, eval('map([1, 2, 3], "foldlevel(v:val)")'))
+    command('normal! 3G==')
+    eq(6, eval('indent(3)'))
+  end)
+
+  it('load autoload functions', function()
+    helpers.mkdir_p('Xautoload/autoload')
+    write_file('Xautoload/autoload/xfold.vim', [[
+      func xfold#level()
+        return 2
+      endfunc
+    ]])
+    finally(function()
+      helpers.rmdir('Xautoload')
+    end)
+    command('set rtp+=Xautoload')
+    command('call setline(1, ["a", "b"])')
+    command('setlocal foldmethod=expr foldexpr=xfold#level()')
+    eq(2, eval('foldlevel(1)'))
+  end)
+end)
+
 it('no double-free in garbage collection #16287', function()
   clear()
   -- Don't use exec() here as using a named script reproduces the issue better.
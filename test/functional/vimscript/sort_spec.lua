@@ -41,6 +41,11 @@ describe('sort()', function()
        eval('string(g:list)'))
   end)
 
+  it('sorts items that are not Strings', function()
+    eq({1, 10, 2, {1}, {a=1}}, eval([[sort([10, 2, [1], {'a': 1}, 1])]]))
+    eq({-2, 'x', 'y', 1.5, 3}, eval([[sort(['x', 3, 1.5, -2, 'y'], 'n')]]))
+  end)
+
   it('can yield E702 and stop sorting after that', function()
     command([[
       function Cmp(a, b)
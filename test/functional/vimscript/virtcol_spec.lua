@@ -0,0 +1,131 @@
+local helpers = require('test.functional.helpers')(after_each)
+
+local clear = helpers.clear
+local eq = helpers.eq
+local exec_lua = helpers.exec_lua
+
+describe('virtcol() in a long line', function()
+  before_each(function()
+    clear()
+    exec_lua([[
+      -- Builds a line from {text, cells} pieces, with a tab every 100 bytes,
+      -- and returns it with the virtual column where each character ends, its
+      -- display width and its strwidth().
+      function _G.build(pieces)
+        local parts, ends = {}, {}
+        local byte, vcol, strwidth = 0, 0, 0
+        for _, p in ipairs(pieces) do
+          local text, cells, count = p[1], p[2], p[3]
+          for _ = 1, count do
+            if byte % 100 == 99 then
+              table.insert(parts, '\t')
+              byte = byte + 1
+              vcol = vcol + (8 - vcol % 8)
+              ends[byte] = vcol
+              strwidth = strwidth + 2 -- "^I"
+            end
+            table.insert(parts, text)
+            ends[byte + 1] = vcol + cells
+            byte = byte + #text
+            vcol = vcol + cells
+            strwidth = strwidth + cells
+          end
+        end
+        return table.concat(parts), ends, vcol, strwidth
+      end
+
+      -- Returns the byte columns where virtcol() is not what "ends" says.
+      function _G.check(lnum, ends, cols)
+        local bad = {}
+        for _, col in ipairs(cols) do
+          if ends[col] and vim.fn.virtcol({ lnum, col }) ~= ends[col] then
+            table.insert(bad, col)
+          end
+        end
+        return bad
+      end
+
+      function _G.cols(line)
+        local cols = {}
+        for col = #line, 1, -997 do
+          table.insert(cols, col)
+        end
+        for col = 1, #line, 1013 do
+          table.insert(cols, col)
+        end
+        table.insert(cols, 50000)
+        table.insert(cols, 50001)
+        return vim.tbl_filter(function(c)
+          return c <= #line
+        end, cols)
+      end
+    ]])
+  end)
+
+  it('with tabs and multibyte characters', function()
+    eq(
+      { {}, {}, true, true },
+      exec_lua([[
+        local line, ends, width, strwidth = build({
+          { 'a', 1, 50000 },
+          { 'é', 1, 100 },
+          { '汉', 2, 100 },
+          { 'b', 1, 20000 },
+        })
+        vim.api.nvim_buf_set_lines(0, 0, -1, true, { line })
+        local cols = cols(line)
+        local bad1 = check(1, ends, cols)
+        -- again, using what was cached
+        local bad2 = check(1, ends, cols)
+        return {
+          bad1,
+          bad2,
+          vim.fn.strwidth(line) == strwidth,
+          vim.fn.strdisplaywidth(line) == width,
+        }
+      ]])
+    )
+  end)
+
+  it('after the line is changed or moved', function()
+    eq(
+      { {}, {}, {}, {} },
+      exec_lua([[
+        local line, ends = build({ { 'a', 1, 30000 } })
+        vim.api.nvim_buf_set_lines(0, 0, -1, true, { line })
+        local res = { check(1, ends, cols(line)) }
+
+        -- a wide character near the start
+        line, ends = build({ { 'a', 1, 10 }, { '汉', 2, 1 }, { 'a', 1, 30000 } })
+        vim.api.nvim_buf_set_lines(0, 0, -1, true, { line })
+        table.insert(res, check(1, ends, cols(line)))
+
+        -- a line inserted above
+        vim.api.nvim_buf_set_lines(0, 0, 0, true, { 'x' })
+        table.insert(res, check(2, ends, cols(line)))
+
+        -- 'tabstop' changed
+        vim.bo.tabstop = 4
+        vim.bo.tabstop = 8
+        vim.bo.tabstop = 3
+        local ends3 = {}
+        local vcol = 0
+        for col = 1, #line do
+          local c = line:byte(col)
+          if c == 9 then
+            vcol = vcol + (3 - vcol % 3)
+            ends3[col] = vcol
+          elseif c < 0x80 then
+            vcol = vcol + 1
+            ends3[col] = vcol
+          elseif c >= 0xc0 then
+            vcol = vcol + 2
+            ends3[col] = vcol
+          end
+        end
+        table.insert(res, check(2, ends3, cols(line)))
+        return res
+      ]])
+    )
+  end)
+end)
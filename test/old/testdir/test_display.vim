@@ -489,4 +489,43 @@ func Test_display_cursor_long_line()
   call StopVimInTerminal(buf)
 endfunc
 
+" The number of screen lines of a wrapped line must follow changes to the
+" text and to the options that affect wrapping.
+func Test_display_line_height_changes()
+  new
+  40vsplit
+  resize 10
+  setlocal wrap nonumber nolist tabstop=8
+  call setline(1, repeat([repeat("\t", 9) .. 'x'], 20))
+  normal! gg
+  redraw
+  call assert_equal(5, line('w$'))
+
+  setlocal tabstop=4
+  redraw
+  call assert_equal(10, line('w$'))
+
+  call setline(1, repeat('x', 120))
+  redraw
+  call assert_equal(8, line('w$'))
+
+  1,2delete
+  redraw
+  call assert_equal(10, line('w$'))
+
+  setlocal number
+  redraw
+  call assert_equal(5, line('w$'))
+
+  setlocal list listchars=eol:$
+  redraw
+  call assert_equal(10, line('w$'))
+
+  setlocal listchars=tab:>-,eol:$
+  redraw
+  call assert_equal(5, line('w$'))
+
+  bwipe!
+endfunc
+
 " vim: shiftwidth=2 sts=2 expandtab
@@ -669,4 +669,29 @@ func Test_listchars_foldcolumn()
 endfunc
 
 
+" Scrolling horizontally step by step must show the same as scrolling
+" directly to the same column.
+func Test_listchars_nowrap_leftcol()
+  new
+  setlocal nowrap list listchars=tab:>-,multispace:ab,trail:-
+  call setline(1, repeat("x\tyy   z\t  ", 20))
+  call setline(2, repeat("\t", 30))
+
+  let step_right = []
+  for col in range(0, 120, 3)
+    call winrestview({'leftcol': col})
+    redraw
+    call add(step_right, [Screenline(1), Screenline(2)])
+  endfor
+  let step_left = []
+  for col in range(120, 0, -3)
+    call winrestview({'leftcol': col})
+    redraw
+    call add(step_left, [Screenline(1), Screenline(2)])
+  endfor
+  call assert_equal(step_right, reverse(step_left))
+
+  bwipe!
+endfunc
+
 " vim: shiftwidth=2 sts=2 expandtab
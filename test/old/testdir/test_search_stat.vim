@@ -463,4 +463,41 @@ func Test_search_stat_backwards()
   call StopVimInTerminal(buf)
 endfunc
 
+" The counts must stay right when the buffer is changed between searches.
+func Test_searchcount_after_change()
+  new
+  call setline(1, repeat(['foo bar', 'bar', 'foo foo'], 100))
+  let @/ = 'foo'
+  call cursor(1, 1)
+  call assert_equal(
+    \ #{current: 1, exact_match: 1, total: 300, incomplete: 0, maxcount: 0},
+    \ searchcount(#{maxcount: 0}))
+
+  10,19delete
+  call assert_equal(290, searchcount(#{maxcount: 0}).total)
+  call setline(5, 'foo foo foo')
+  call assert_equal(293, searchcount(#{maxcount: 0}).total)
+  call append(2, ['foo', 'xfoo'])
+  call assert_equal(295, searchcount(#{maxcount: 0}).total)
+  %s/foo foo/foo/
+  call assert_equal(197, searchcount(#{maxcount: 0}).total)
+  call cursor(4, 2)
+  call assert_equal(
+    \ #{current: 3, exact_match: 1, total: 197, incomplete: 0, maxcount: 0},
+    \ searchcount(#{maxcount: 0}))
+  undo
+
+  " counting stops after "maxcount", a change before that must be noticed
+  call assert_equal(
+    \ #{current: 1, exact_match: 1, total: 100, incomplete: 2, maxcount: 99},
+    \ searchcount(#{pos: [1, 1, 0]}))
+  1delete
+  call assert_equal(
+    \ #{current: 0, exact_match: 0, total: 100, incomplete: 2, maxcount: 99},
+    \ searchcount(#{pos: [1, 1, 0]}))
+  call assert_equal(294, searchcount(#{maxcount: 0}).total)
+
+  bwipe!
+endfunc
+
 " vim: shiftwidth=2 sts=2 expandtab
@@ -0,0 +1,109 @@
+-- Micro-benchmarks for core data structures, run in-process through the FFI.
+-- The measured loops live in test/unit/fixtures/bench.c.
+--
+-- Run with:  make unitbenchmark
+-- Use BENCH_RUNS to change the number of runs per benchmark (default 15).
+
+local helpers = require('test.unit.helpers')(after_each)
+local itp = helpers.gen_itp(it)
+
+local ffi = helpers.ffi
+local eq = helpers.eq
+local to_cstr = helpers.to_cstr
+
+local lib = helpers.cimport('./test/unit/fixtures/bench.h', './src/nvim/buffer.h')
+
+local runs = tonumber(os.getenv('BENCH_RUNS')) or 15
+
+--- Call `f` `runs` times (after one warm-up run) and print min, median, mean
+--- and standard deviation of the returned nanoseconds, per iteration.
+--- @param name string
+--- @param iterations integer
+--- @param f fun(): integer
+local function measure(name, iterations, f)
+  f()
+  local times = {}
+  for i = 1, runs do
+    local t = tonumber(f())
+    eq(true, t >= 0, name .. ' failed')
+    times[i] = t / iterations
+  end
+  table.sort(times)
+  local sum = 0
+  for _, t in ipairs(times) do
+    sum = sum + t
+  end
+  local mean = sum / runs
+  local var = 0
+  for _, t in ipairs(times) do
+    var = var + (t - mean) ^ 2
+  end
+  local median = times[math.floor((runs + 1) / 2)]
+  io.stdout:write(
+    string.format(
+      '\n%-32s min %9.1f  median %9.1f  mean %9.1f  stddev %7.1f  ns/iter',
+      name,
+      times[1],
+      median,
+      mean,
+      math.sqrt(var / runs)
+    )
+  )
+end
+
+describe('benchmark', function()
+  itp('map.c String map put + get', function()
+    measure('map put/get (100k)', 100000, function()
+      return lib.ut_bench_map(100000)
+    end)
+  end)
+
+  itp('map.c String map lookup of missing keys', function()
+    measure('map miss (100k)', 100000, function()
+      return lib.ut_bench_map_miss(100000)
+    end)
+  end)
+
+  itp('marktree.c put + iterate', function()
+    local tree = ffi.new('MarkTree[1]')
+    measure('marktree put/iter (100k)', 100000, function()
+      return lib.ut_bench_marktree(tree, 100000)
+    end)
+  end)
+
+  itp('memline.c ml_append + ml_get', function()
+    local count = 0
+    measure('memline append/get (50k)', 50000, function()
+      -- a new buffer for every run, buflist_new() reuses a matching name
+      count = count + 1
+      local fname = to_cstr('Xbench_memline' .. count)
+      local buf = lib.buflist_new(fname, fname, 1, 0)
+      return lib.ut_bench_memline(buf, 50000)
+    end)
+  end)
+
+  for _, engine in ipairs({ 1, 2 }) do
+    itp('regexp.c with regexpengine=' .. engine, function()
+      local text = to_cstr(string.rep('abcdefghij ', 20) .. 'foo_bar123(baz)')
+      measure('regexp literal re=' .. engine, 10000, function()
+        return lib.ut_bench_regexp(to_cstr('foo_bar'), text, engine, 10000)
+      end)
+      measure('regexp class re=' .. engine, 10000, function()
+        return lib.ut_bench_regexp(to_cstr([[\w\+\d\+(\k*)]]), text, engine, 10000)
+      end)
+    end)
+  end
+
+  itp('msgpack_rpc/unpacker.c response', function()
+    -- [1, 0, nil, [0, 1, ..., 99]]
+    local bytes = { '\148\1\0\192\220\0\100' }
+    for i = 0, 99 do
+      bytes[#bytes + 1] = string.char(i)
+    end
+    local data = table.concat(bytes)
+    local cdata = to_cstr(data)
+    measure('unpacker response (100 ints)', 10000, function()
+      return lib.ut_bench_unpacker(cdata, #data, 10000)
+    end)
+  end)
+end)
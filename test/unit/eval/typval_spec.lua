@@ -1351,6 +1351,35 @@ describe('typval.c', function()
 
           alloc_log:check({})
         end)
+        itp('indexes long lists accessed out of order', function()
+          local items = {}
+          for i = 1, 500 do
+            items[i] = int(i)
+          end
+          local l = list(unpack(items))
+          local lis = list_items(l)
+
+          eq(nil, l.lv_items)
+          eq(lis[2], lib.tv_list_find(l, 1))
+          eq(lis[3], lib.tv_list_find(l, 2))
+          eq(nil, l.lv_items)
+          eq(lis[301], lib.tv_list_find(l, 300))
+          neq(nil, l.lv_items)
+          eq(lis[101], lib.tv_list_find(l, 100))
+          eq(lis[500], lib.tv_list_find(l, -1))
+          eq(lis[1], lib.tv_list_find(l, -500))
+          eq(nil, lib.tv_list_find(l, 500))
+
+          lib.tv_list_item_remove(l, lis[1])
+          eq(nil, l.lv_items)
+          eq(lis[302], lib.tv_list_find(l, 300))
+          neq(nil, l.lv_items)
+          eq(lis[2], lib.tv_list_find(l, 0))
+
+          lib.tv_list_append_number(l, 501)
+          eq(nil, l.lv_items)
+          eq(501, lib.tv_list_find_nr(l, 499, nil))
+        end)
       end)
       describe('nr()', function()
         local function tv_list_find_nr(l, n, msg)
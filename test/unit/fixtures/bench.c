@@ -0,0 +1,162 @@
+// Loops for test/unit/bench/, run in C so that the FFI call overhead is not
+// measured.  Each function returns the elapsed time in nanoseconds.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "nvim/api/private/defs.h"
+#include "nvim/map.h"
+#include "nvim/marktree.h"
+#include "nvim/memline.h"
+#include "nvim/memory.h"
+#include "nvim/msgpack_rpc/unpacker.h"
+#include "nvim/option_vars.h"
+#include "nvim/os/time.h"
+#include "nvim/regexp.h"
+
+#include "bench.h"
+
+/// Insert "n" string keys into a map, then look each of them up.
+int64_t ut_bench_map(int n)
+{
+  char **keys = xmalloc((size_t)n * sizeof(char *));
+  for (int i = 0; i < n; i++) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "key_%d", i);
+    keys[i] = xstrdup(buf);
+  }
+
+  Map(String, int) map = MAP_INIT;
+  uint64_t start = os_hrtime();
+  for (int i = 0; i < n; i++) {
+    map_put(String, int)(&map, cstr_as_string(keys[i]), i);
+  }
+  int sum = 0;
+  for (int i = 0; i < n; i++) {
+    sum += map_get(String, int)(&map, cstr_as_string(keys[i]));
+  }
+  uint64_t elapsed = os_hrtime() - start;
+
+  map_destroy(String, &map);
+  for (int i = 0; i < n; i++) {
+    xfree(keys[i]);
+  }
+  xfree(keys);
+  return sum >= 0 ? (int64_t)elapsed : -1;
+}
+
+/// Insert "n" string keys into a map, then look up "n" keys that are not in it.
+int64_t ut_bench_map_miss(int n)
+{
+  char **keys = xmalloc((size_t)n * 2 * sizeof(char *));
+  for (int i = 0; i < n * 2; i++) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "key_%d", i);
+    keys[i] = xstrdup(buf);
+  }
+
+  Map(String, int) map = MAP_INIT;
+  for (int i = 0; i < n; i++) {
+    map_put(String, int)(&map, cstr_as_string(keys[i]), i + 1);
+  }
+  int found = 0;
+  uint64_t start = os_hrtime();
+  for (int i = n; i < n * 2; i++) {
+    found += map_has(String, &map, cstr_as_string(keys[i]));
+  }
+  uint64_t elapsed = os_hrtime() - start;
+
+  map_destroy(String, &map);
+  for (int i = 0; i < n * 2; i++) {
+    xfree(keys[i]);
+  }
+  xfree(keys);
+  return found == 0 ? (int64_t)elapsed : -1;
+}
+
+/// Put "n" marks spread over "n / 4" rows into "tree", then iterate over all
+/// of them.
+int64_t ut_bench_marktree(MarkTree *tree, int n)
+{
+  uint64_t start = os_hrtime();
+  for (int i = 0; i < n; i++) {
+    marktree_put_test(tree, 1, (uint32_t)i + 1, i / 4, (i % 4) * 2, false, -1, -1, false);
+  }
+  MarkTreeIter itr[1];
+  int count = 0;
+  if (marktree_itr_first(tree, itr)) {
+    do {
+      count++;
+    } while (marktree_itr_next(tree, itr));
+  }
+  uint64_t elapsed = os_hrtime() - start;
+  marktree_clear(tree);
+  return count == n ? (int64_t)elapsed : -1;
+}
+
+/// Append "n" lines to the (empty) memline of "buf", then get every line in
+/// order and in a strided order.
+int64_t ut_bench_memline(buf_T *buf, int n)
+{
+  if (buf->b_ml.ml_mfp == NULL && ml_open(buf) == FAIL) {
+    return -1;
+  }
+  char line[64];
+  uint64_t start = os_hrtime();
+  for (int i = 0; i < n; i++) {
+    snprintf(line, sizeof(line), "line %d of the benchmark buffer", i);
+    ml_append_buf(buf, (linenr_T)i, line, 0, false);
+  }
+  size_t total = 0;
+  for (linenr_T lnum = 1; lnum <= n; lnum++) {
+    total += strlen(ml_get_buf(buf, lnum));
+  }
+  for (int i = 0; i < n; i++) {
+    total += strlen(ml_get_buf(buf, (linenr_T)(((int64_t)i * 7919) % n) + 1));
+  }
+  uint64_t elapsed = os_hrtime() - start;
+  return total > 0 ? (int64_t)elapsed : -1;
+}
+
+/// Compile "pat" with 'regexpengine' set to "engine" and match it against
+/// "text" "n" times.
+int64_t ut_bench_regexp(const char *pat, const char *text, int engine, int n)
+{
+  OptInt save_re = p_re;
+  p_re = engine;
+  regmatch_T regmatch = { .rm_ic = false };
+  regmatch.regprog = vim_regcomp(pat, RE_MAGIC);
+  p_re = save_re;
+  if (regmatch.regprog == NULL) {
+    return -1;
+  }
+
+  int matches = 0;
+  uint64_t start = os_hrtime();
+  for (int i = 0; i < n; i++) {
+    matches += vim_regexec(&regmatch, text, 0);
+  }
+  uint64_t elapsed = os_hrtime() - start;
+  vim_regfree(regmatch.regprog);
+  return matches >= 0 ? (int64_t)elapsed : -1;
+}
+
+/// Parse the msgpack-rpc response in "data" "n" times.
+int64_t ut_bench_unpacker(const char *data, size_t size, int n)
+{
+  Unpacker p;
+  uint64_t start = os_hrtime();
+  for (int i = 0; i < n; i++) {
+    memset(&p, 0, sizeof(p));
+    unpacker_init(&p);
+    p.read_ptr = data;
+    p.read_size = size;
+    bool ok = unpacker_advance(&p);
+    unpacker_teardown(&p);
+    if (!ok) {
+      return -1;
+    }
+  }
+  return (int64_t)(os_hrtime() - start);
+}
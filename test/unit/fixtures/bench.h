@@ -0,0 +1,12 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nvim/buffer_defs.h"
+#include "nvim/marktree.h"
+
+int64_t ut_bench_map(int n);
+int64_t ut_bench_map_miss(int n);
+int64_t ut_bench_marktree(MarkTree *tree, int n);
+int64_t ut_bench_memline(buf_T *buf, int n);
+int64_t ut_bench_regexp(const char *pat, const char *text, int engine, int n);
+int64_t ut_bench_unpacker(const char *data, size_t size, int n);
@@ -541,4 +541,106 @@ describe('marktree', function()
       end
     end
   end)
+
+  itp('works with marktree_put_batch', function()
+    local tree = ffi.new("MarkTree[1]") -- zero initialized by luajit
+    local iter = ffi.new("MarkTreeIter[1]")
+    local shadow = {}
+
+    -- some existing marks which the batch is merged with
+    for i = 1,50 do
+      local id = put(tree, i, i, true)
+      shadow[id] = {i, i, true}
+    end
+
+    local size = 2000
+    local batch = ffi.new("MTPair[?]", size)
+    local ids = {}
+    for k = 0, size-1 do
+      last_id = last_id + 1
+      local row, col = (k*7) % 100, (k*13) % 50
+      local p = batch[k]
+      p.start.pos.row, p.start.pos.col = row, col
+      p.start.ns, p.start.id = ns, last_id
+      if k % 3 == 0 then
+        p.start.flags = bit.lshift(1, 14) -- MT_FLAG_RIGHT_GRAVITY
+      end
+      shadow[last_id] = {row, col, k % 3 == 0}
+      if k % 2 == 0 then
+        p.end_pos.row, p.end_pos.col = row + (k % 5), col + 10
+        table.insert(ids, last_id)
+      else
+        p.end_pos.row, p.end_pos.col = -1, -1
+      end
+    end
+
+    lib.marktree_put_batch(tree, batch, size)
+    eq(50 + size + #ids, tonumber(tree[0].n_keys))
+    check_intersections(tree)
+
+    -- end marks are not part of shadow, skip them when comparing order
+    local count = 0
+    ok(lib.marktree_itr_first(tree, iter))
+    repeat
+      local mark = lib.marktree_itr_current(iter)
+      if bit.band(mark.flags, 2) == 0 then -- not MT_FLAG_END
+        local spos = shadow[tonumber(mark.id)]
+        eq({spos[1], spos[2]}, {mark.pos.row, mark.pos.col})
+        count = count + 1
+      end
+    until not lib.marktree_itr_next(tree, iter)
+    eq(50 + size, count)
+
+    -- the bulk-loaded tree still supports edits
+    for i = 1, #ids, 7 do
+      lib.marktree_del_pair_test(tree, ns, ids[i])
+    end
+    check_intersections(tree)
+    lib.marktree_splice(tree, 20, 0, 10, 0, 0, 0)
+    check_intersections(tree)
+  end)
+
+  itp('marktree_itr_next_ns skips other namespaces', function()
+    local tree = ffi.new("MarkTree[1]") -- zero initialized by luajit
+    local iter = ffi.new("MarkTreeIter[1]")
+
+    local expected = {}
+    for i = 1, 3000 do
+      -- namespace 3 only has marks in a few rows, 67 shares its bit
+      local mark_ns = (i % 500 == 0) and 3 or (i % 2 == 0 and 67 or 5)
+      lib.marktree_put_test(tree, mark_ns, i, i, 0, false, -1, -1, false)
+      if mark_ns == 3 then
+        table.insert(expected, i)
+      end
+    end
+    lib.marktree_check(tree)
+
+    local function collect()
+      local found = {}
+      lib.marktree_itr_get(tree, 0, 0, iter)
+      local mark = lib.marktree_itr_current(iter)
+      if mark.pos.row >= 0 and mark.ns == 3 then
+        table.insert(found, tonumber(mark.id))
+      end
+      while lib.marktree_itr_next_ns(tree, iter, 3) do
+        mark = lib.marktree_itr_current(iter)
+        eq(3, tonumber(mark.ns))
+        table.insert(found, tonumber(mark.id))
+      end
+      return found
+    end
+
+    eq(expected, collect())
+
+    -- still correct after deletions have rebalanced the tree
+    for i = 1, 3000, 3 do
+      if i % 500 ~= 0 then
+        local mark_ns = i % 2 == 0 and 67 or 5
+        lib.marktree_lookup_ns(tree, mark_ns, i, false, iter)
+        lib.marktree_del_itr(tree, iter, false)
+      end
+    end
+    lib.marktree_check(tree)
+    eq(expected, collect())
+  end)
 end)
@@ -146,4 +146,44 @@ describe("multiqueue (multi-level event-queue)", function()
     eq('c3i1', get(child3))
     eq('c3i2', get(child3))
   end)
+
+  itp('processes high priority children first', function()
+    multiqueue.multiqueue_set_priority(child3, true)
+    eq('c3i1', get(parent))
+    eq('c3i2', get(parent))
+    eq('c1i1', get(parent))
+    put(child3, 'c3i3')
+    eq('c3i3', get(parent))
+    eq('c1i2', get(parent))
+    multiqueue.multiqueue_set_priority(child3, false)
+    put(child3, 'c3i4')
+    eq('c2i1', get(parent))
+  end)
+
+  itp('moves pending events when priority changes', function()
+    multiqueue.multiqueue_set_priority(child2, true)
+    eq('c2i1', get(parent))
+    eq('c2i2', get(parent))
+    eq('c1i1', get(child1))
+    multiqueue.multiqueue_set_priority(child2, false)
+    eq('c1i2', get(parent))
+    eq('c1i3', get(parent))
+    eq('c3i1', get(parent))
+    eq('c3i2', get(parent))
+    eq('c2i3', get(parent))
+  end)
+
+  itp('does not starve normal priority children', function()
+    multiqueue.multiqueue_set_priority(child3, true)
+    for i = 1, 20 do
+      put(child3, 'h' .. i)
+    end
+    eq('c3i1', get(parent))
+    eq('c3i2', get(parent))
+    for i = 1, 6 do
+      eq('h' .. i, get(parent))
+    end
+    eq('c1i1', get(parent))
+    eq('h7', get(parent))
+  end)
 end)